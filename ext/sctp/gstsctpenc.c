@@ -74,6 +74,7 @@ static GParamSpec *properties[NUM_PROPERTIES];
 #define DEFAULT_USE_SOCK_STREAM FALSE
 
 #define BUFFER_FULL_SLEEP_TIME 100000
+#define MAX_PACKETS_PER_PUSH 64
 
 GType gst_sctp_enc_pad_get_type (void);
 
@@ -143,6 +144,8 @@ static GstPad *gst_sctp_enc_request_new_pad (GstElement * element,
     GstPadTemplate * template, const gchar * name, const GstCaps * caps);
 static void gst_sctp_enc_release_pad (GstElement * element, GstPad * pad);
 static void gst_sctp_enc_srcpad_loop (GstPad * pad);
+static GstFlowReturn gst_sctp_enc_sink_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 static GstFlowReturn gst_sctp_enc_sink_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buffer);
 static gboolean gst_sctp_enc_sink_event (GstPad * pad, GstObject * parent,
@@ -424,6 +427,8 @@ gst_sctp_enc_request_new_pad (GstElement * element, GstPadTemplate * template,
       template->direction, "template", template, NULL);
   gst_pad_set_chain_function (new_pad,
       GST_DEBUG_FUNCPTR (gst_sctp_enc_sink_chain));
+  gst_pad_set_chain_list_function (new_pad,
+      GST_DEBUG_FUNCPTR (gst_sctp_enc_sink_chain_list));
   gst_pad_set_event_function (new_pad,
       GST_DEBUG_FUNCPTR (gst_sctp_enc_sink_event));
 
@@ -515,11 +520,33 @@ gst_sctp_enc_srcpad_loop (GstPad * pad)
 
   if (gst_data_queue_pop (self->outbound_sctp_packet_queue, &item)) {
     GstBuffer *buffer = GST_BUFFER (item->object);
+    GstBufferList *list = NULL;
 
-    GST_DEBUG_OBJECT (self, "Forwarding buffer %" GST_PTR_FORMAT, buffer);
-
-    flow_ret = gst_pad_push (self->src_pad, buffer);
     item->object = NULL;
+    item->destroy (item);
+
+    /* Forward everything that was queued in the meantime in one go, a burst
+     * of messages usually results in several packets produced at once */
+    while ((!list || gst_buffer_list_length (list) < MAX_PACKETS_PER_PUSH) &&
+        !gst_data_queue_is_empty (self->outbound_sctp_packet_queue) &&
+        gst_data_queue_pop (self->outbound_sctp_packet_queue, &item)) {
+      if (!list) {
+        list = gst_buffer_list_new ();
+        gst_buffer_list_add (list, buffer);
+      }
+      gst_buffer_list_add (list, GST_BUFFER (item->object));
+      item->object = NULL;
+      item->destroy (item);
+    }
+
+    if (list) {
+      GST_DEBUG_OBJECT (self, "Forwarding list of %u buffers",
+          gst_buffer_list_length (list));
+      flow_ret = gst_pad_push_list (self->src_pad, list);
+    } else {
+      GST_DEBUG_OBJECT (self, "Forwarding buffer %" GST_PTR_FORMAT, buffer);
+      flow_ret = gst_pad_push (self->src_pad, buffer);
+    }
 
     GST_OBJECT_LOCK (self);
     self->src_ret = flow_ret;
@@ -540,8 +567,6 @@ gst_sctp_enc_srcpad_loop (GstPad * pad)
       gst_data_queue_flush (self->outbound_sctp_packet_queue);
       gst_pad_pause_task (pad);
     }
-
-    item->destroy (item);
   } else {
     GST_OBJECT_LOCK (self);
     self->src_ret = GST_FLOW_FLUSHING;
@@ -553,10 +578,27 @@ gst_sctp_enc_srcpad_loop (GstPad * pad)
 }
 
 static GstFlowReturn
-gst_sctp_enc_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+gst_sctp_enc_get_src_ret (GstSctpEnc * self, GstPad * pad)
 {
-  GstSctpEnc *self = GST_SCTP_ENC (parent);
-  GstSctpEncPad *sctpenc_pad = GST_SCTP_ENC_PAD (pad);
+  GstFlowReturn flow_ret;
+
+  GST_OBJECT_LOCK (self);
+  flow_ret = self->src_ret;
+  GST_OBJECT_UNLOCK (self);
+
+  if (flow_ret != GST_FLOW_OK) {
+    GST_ERROR_OBJECT (pad, "Pushing on source pad failed before: %s",
+        gst_flow_get_name (flow_ret));
+  }
+
+  return flow_ret;
+}
+
+static GstFlowReturn
+gst_sctp_enc_send_buffer (GstSctpEnc * self, GstSctpEncPad * sctpenc_pad,
+    GstBuffer * buffer)
+{
+  GstPad *pad = GST_PAD (sctpenc_pad);
   GstMapInfo map;
   guint32 ppid;
   gboolean ordered;
@@ -569,17 +611,6 @@ gst_sctp_enc_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   const guint8 *data;
   guint32 length;
 
-  GST_OBJECT_LOCK (self);
-  if (self->src_ret != GST_FLOW_OK) {
-    GST_ERROR_OBJECT (pad, "Pushing on source pad failed before: %s",
-        gst_flow_get_name (self->src_ret));
-    flow_ret = self->src_ret;
-    GST_OBJECT_UNLOCK (self);
-    gst_buffer_unref (buffer);
-    return flow_ret;
-  }
-  GST_OBJECT_UNLOCK (self);
-
   ppid = sctpenc_pad->ppid;
   ordered = sctpenc_pad->ordered;
   pr = sctpenc_pad->reliability;
@@ -674,10 +705,62 @@ out:
 
   gst_buffer_unmap (buffer, &map);
 error:
+  return flow_ret;
+}
+
+static GstFlowReturn
+gst_sctp_enc_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstSctpEnc *self = GST_SCTP_ENC (parent);
+  GstFlowReturn flow_ret;
+
+  flow_ret = gst_sctp_enc_get_src_ret (self, pad);
+  if (flow_ret == GST_FLOW_OK)
+    flow_ret = gst_sctp_enc_send_buffer (self, GST_SCTP_ENC_PAD (pad), buffer);
+
   gst_buffer_unref (buffer);
   return flow_ret;
 }
 
+static GstFlowReturn
+gst_sctp_enc_sink_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstSctpEnc *self = GST_SCTP_ENC (parent);
+  GstFlowReturn flow_ret;
+  gboolean corked = FALSE;
+  guint i, len;
+
+  flow_ret = gst_sctp_enc_get_src_ret (self, pad);
+  len = gst_buffer_list_length (list);
+
+  GST_LOG_OBJECT (pad, "Sending list of %u buffers", len);
+
+  /* Let the association bundle the messages into full packets. The socket
+   * is uncorked before the last message, which then flushes everything
+   * queued so far */
+  if (flow_ret == GST_FLOW_OK && len > 1) {
+    gst_sctp_association_set_corked (self->sctp_association, TRUE);
+    corked = TRUE;
+  }
+
+  for (i = 0; i < len && flow_ret == GST_FLOW_OK; i++) {
+    if (corked && i == len - 1) {
+      gst_sctp_association_set_corked (self->sctp_association, FALSE);
+      corked = FALSE;
+    }
+
+    flow_ret = gst_sctp_enc_send_buffer (self, GST_SCTP_ENC_PAD (pad),
+        gst_buffer_list_get (list, i));
+  }
+
+  if (corked)
+    gst_sctp_association_set_corked (self->sctp_association, FALSE);
+
+  gst_buffer_list_unref (list);
+  return flow_ret;
+}
+
 static gboolean
 gst_sctp_enc_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
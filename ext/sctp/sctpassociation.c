@@ -227,6 +227,7 @@ gst_sctp_association_init (GstSctpAssociation * self)
   g_mutex_init (&self->association_mutex);
 
   self->state = GST_SCTP_ASSOCIATION_STATE_NEW;
+  self->cork_count = 0;
 
   self->use_sock_stream = FALSE;
 
@@ -532,6 +533,36 @@ end:
   return flow_ret;
 }
 
+/* While corked, SCTP_NODELAY is disabled on the socket so usrsctp can
+ * bundle the DATA chunks of consecutive small messages into packets of up
+ * to the path MTU instead of sending one packet per message. Uncorking
+ * does not flush by itself: the next message sent goes out immediately
+ * together with everything queued before it. Corking is counted, the
+ * socket only goes back to NODELAY once all callers uncorked it. */
+void
+gst_sctp_association_set_corked (GstSctpAssociation * self, gboolean corked)
+{
+  gboolean changed = FALSE;
+  int value;
+
+  g_mutex_lock (&self->association_mutex);
+  if (corked) {
+    changed = self->cork_count++ == 0;
+  } else if (self->cork_count > 0) {
+    changed = --self->cork_count == 0;
+  }
+
+  if (changed && self->sctp_ass_sock) {
+    value = corked ? 0 : 1;
+    if (usrsctp_setsockopt (self->sctp_ass_sock, IPPROTO_SCTP, SCTP_NODELAY,
+            &value, sizeof (int))) {
+      GST_DEBUG_OBJECT (self, "Could not set SCTP_NODELAY: (%u) %s", errno,
+          g_strerror (errno));
+    }
+  }
+  g_mutex_unlock (&self->association_mutex);
+}
+
 void
 gst_sctp_association_reset_stream (GstSctpAssociation * self, guint16 stream_id)
 {
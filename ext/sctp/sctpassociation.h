@@ -82,6 +82,7 @@ struct _GstSctpAssociation
   GMutex association_mutex;
 
   GstSctpAssociationState state;
+  guint cork_count;
 
   GstSctpAssociationPacketReceivedCb packet_received_cb;
   gpointer packet_received_user_data;
@@ -115,6 +116,8 @@ GstFlowReturn gst_sctp_association_send_data (GstSctpAssociation * self,
     const guint8 * buf, guint32 length, guint16 stream_id, guint32 ppid,
     gboolean ordered, GstSctpAssociationPartialReliability pr,
     guint32 reliability_param, guint32 *bytes_sent);
+void gst_sctp_association_set_corked (GstSctpAssociation * self,
+    gboolean corked);
 void gst_sctp_association_reset_stream (GstSctpAssociation * self,
     guint16 stream_id);
 void gst_sctp_association_force_close (GstSctpAssociation * self);
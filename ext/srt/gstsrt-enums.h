@@ -62,6 +62,21 @@ typedef enum
   GST_SRT_KEY_LENGTH_32 = 32,
 } GstSRTKeyLength;
 
+/**
+ * GstSRTSlowCallerPolicy:
+ * @GST_SRT_SLOW_CALLER_POLICY_DROP_OLDEST: drop the oldest queued buffers
+ * @GST_SRT_SLOW_CALLER_POLICY_DISCONNECT: disconnect the caller
+ *
+ * What to do with a caller whose send queue is full.
+ *
+ * Since: 1.18
+ */
+typedef enum
+{
+  GST_SRT_SLOW_CALLER_POLICY_DROP_OLDEST,
+  GST_SRT_SLOW_CALLER_POLICY_DISCONNECT,
+} GstSRTSlowCallerPolicy;
+
 G_END_DECLS
 
 #endif // __GST_SRT_ENUM_H__
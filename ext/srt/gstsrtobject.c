@@ -49,15 +49,35 @@ enum
   PROP_STATS,
   PROP_WAIT_FOR_CONNECTION,
   PROP_STREAMID,
+  PROP_CALLER_QUEUE_SIZE,
+  PROP_SLOW_CALLER_POLICY,
   PROP_LAST
 };
 
+#define GST_SRT_SENDER_MAX_EVENTS 64
+
+/* How long EOS and closing wait for the callers to get what was queued for
+ * them, and how often the SRT send buffers are checked meanwhile */
+#define GST_SRT_DRAIN_TIMEOUT (2 * G_TIME_SPAN_SECOND)
+#define GST_SRT_DRAIN_POLL_INTERVAL (10 * G_TIME_SPAN_MILLISECOND)
+
 typedef struct
 {
   SRTSOCKET sock;
   gint poll_id;
   GSocketAddress *sockaddr;
   gboolean sent_headers;
+
+  /* Send queue of a listener sink, protected by sock_lock */
+  GQueue queue;
+  guint64 queued_bytes;
+  /* bytes of the head buffer already sent */
+  gsize offset;
+  /* waiting on the sender epoll for the socket to become writable */
+  gboolean blocked;
+
+  guint64 buffers_sent;
+  guint64 buffers_dropped;
 } SRTCaller;
 
 static GstStructure *gst_srt_object_accumulate_stats (GstSRTObject * srtobject,
@@ -70,6 +90,7 @@ srt_caller_new (void)
   caller->sock = SRT_INVALID_SOCK;
   caller->poll_id = SRT_ERROR;
   caller->sent_headers = FALSE;
+  g_queue_init (&caller->queue);
 
   return caller;
 }
@@ -77,10 +98,15 @@ srt_caller_new (void)
 static void
 srt_caller_free (SRTCaller * caller)
 {
+  GstBuffer *buffer;
+
   g_return_if_fail (caller != NULL);
 
   g_clear_object (&caller->sockaddr);
 
+  while ((buffer = g_queue_pop_head (&caller->queue)))
+    gst_buffer_unref (buffer);
+
   if (caller->sock != SRT_INVALID_SOCK) {
     srt_close (caller->sock);
   }
@@ -108,6 +134,19 @@ srt_caller_signal_removed (SRTCaller * caller, GstSRTObject * srtobject)
       caller->sockaddr);
 }
 
+/* called with sock_lock */
+static void
+gst_srt_object_remove_caller (GstSRTObject * srtobject, SRTCaller * caller)
+{
+  srtobject->callers = g_list_remove (srtobject->callers, caller);
+
+  if (caller->blocked && srtobject->sender_poll_id != SRT_ERROR)
+    srt_epoll_remove_usock (srtobject->sender_poll_id, caller->sock);
+
+  srt_caller_signal_removed (caller, srtobject);
+  srt_caller_free (caller);
+}
+
 struct srt_constant_params
 {
   const gchar *name;
@@ -224,6 +263,9 @@ gst_srt_object_new (GstElement * element)
   srtobject->listener_poll_id = SRT_ERROR;
   srtobject->sent_headers = FALSE;
   srtobject->wait_for_connection = GST_SRT_DEFAULT_WAIT_FOR_CONNECTION;
+  srtobject->sender_poll_id = SRT_ERROR;
+  srtobject->caller_queue_size = GST_SRT_DEFAULT_CALLER_QUEUE_SIZE;
+  srtobject->slow_caller_policy = GST_SRT_DEFAULT_SLOW_CALLER_POLICY;
 
   g_cond_init (&srtobject->sock_cond);
   return srtobject;
@@ -294,6 +336,12 @@ gst_srt_object_set_property_helper (GstSRTObject * srtobject,
     case PROP_STREAMID:
       gst_structure_set_value (srtobject->parameters, "streamid", value);
       break;
+    case PROP_CALLER_QUEUE_SIZE:
+      srtobject->caller_queue_size = g_value_get_uint (value);
+      break;
+    case PROP_SLOW_CALLER_POLICY:
+      srtobject->slow_caller_policy = g_value_get_enum (value);
+      break;
     default:
       goto err;
   }
@@ -378,6 +426,12 @@ gst_srt_object_get_property_helper (GstSRTObject * srtobject,
           gst_structure_get_string (srtobject->parameters, "streamid"));
       break;
     }
+    case PROP_CALLER_QUEUE_SIZE:
+      g_value_set_uint (value, srtobject->caller_queue_size);
+      break;
+    case PROP_SLOW_CALLER_POLICY:
+      g_value_set_enum (value, srtobject->slow_caller_policy);
+      break;
     default:
       goto err;
   }
@@ -527,6 +581,36 @@ gst_srt_object_install_properties_helper (GObjectClass * gobject_class)
           "Stream ID for the SRT access control", "",
           G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
           G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstSRTSink:caller-queue-size:
+   *
+   * The maximum number of buffers queued for each caller when `srtsink'
+   * is a listener. Callers are served by a separate sender thread, so a
+   * slow caller only fills its own queue and
+   * #GstSRTSink:slow-caller-policy decides what happens once it is full.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_CALLER_QUEUE_SIZE,
+      g_param_spec_uint ("caller-queue-size", "Caller queue size",
+          "Maximum number of buffers queued per caller (0 = unlimited)",
+          0, G_MAXUINT, GST_SRT_DEFAULT_CALLER_QUEUE_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstSRTSink:slow-caller-policy:
+   *
+   * What to do with a caller whose send queue is full.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_SLOW_CALLER_POLICY,
+      g_param_spec_enum ("slow-caller-policy", "Slow caller policy",
+          "What to do with a caller whose send queue is full",
+          GST_TYPE_SRT_SLOW_CALLER_POLICY, GST_SRT_DEFAULT_SLOW_CALLER_POLICY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  gst_type_mark_as_plugin_api (GST_TYPE_SRT_SLOW_CALLER_POLICY, 0);
 }
 
 static void
@@ -765,6 +849,312 @@ thread_func (gpointer data)
   }
 }
 
+/* called with sock_lock, returns FALSE if the caller has to be dropped */
+static gboolean
+gst_srt_object_send_queued (GstSRTObject * srtobject, SRTCaller * caller)
+{
+  gint payload_size, optlen = sizeof (payload_size);
+  GstBuffer *buffer;
+
+  if (srt_getsockflag (caller->sock, SRTO_PAYLOADSIZE, &payload_size,
+          &optlen)) {
+    GST_WARNING_OBJECT (srtobject->element, "%s", srt_getlasterror_str ());
+    return FALSE;
+  }
+
+  while ((buffer = g_queue_peek_head (&caller->queue))) {
+    GstMapInfo mapinfo;
+
+    if (!gst_buffer_map (buffer, &mapinfo, GST_MAP_READ)) {
+      GST_WARNING_OBJECT (srtobject->element, "Could not map %"
+          GST_PTR_FORMAT, buffer);
+      caller->buffers_dropped++;
+      goto next;
+    }
+
+    while (caller->offset < mapinfo.size) {
+      gint rest = MIN (mapinfo.size - caller->offset, payload_size);
+      gint sent;
+
+      sent = srt_sendmsg2 (caller->sock,
+          (char *) (mapinfo.data + caller->offset), rest, 0);
+      if (sent < 0) {
+        gint flag = SRT_EPOLL_OUT | SRT_EPOLL_ERR;
+
+        gst_buffer_unmap (buffer, &mapinfo);
+
+        if (srt_getlasterror (NULL) != SRT_EASYNCSND) {
+          GST_WARNING_OBJECT (srtobject->element, "Dropping caller %d: %s",
+              caller->sock, srt_getlasterror_str ());
+          return FALSE;
+        }
+
+        /* The SRT send buffer is full, resume once it is writable again */
+        if (srt_epoll_add_usock (srtobject->sender_poll_id, caller->sock,
+                &flag)) {
+          GST_WARNING_OBJECT (srtobject->element, "%s",
+              srt_getlasterror_str ());
+          return FALSE;
+        }
+
+        GST_LOG_OBJECT (srtobject->element, "Caller %d blocked with %u "
+            "buffers queued", caller->sock, caller->queue.length);
+        caller->blocked = TRUE;
+        return TRUE;
+      }
+      caller->offset += sent;
+    }
+
+    gst_buffer_unmap (buffer, &mapinfo);
+    caller->buffers_sent++;
+
+  next:
+    g_queue_pop_head (&caller->queue);
+    caller->queued_bytes -= gst_buffer_get_size (buffer);
+    caller->offset = 0;
+    gst_buffer_unref (buffer);
+  }
+
+  return TRUE;
+}
+
+/* called with sock_lock, resumes the callers that became writable */
+static void
+gst_srt_object_unblock_callers (GstSRTObject * srtobject,
+    const SRTSOCKET * wsocks, gint wsocklen)
+{
+  gint i;
+
+  for (i = 0; i < wsocklen; i++) {
+    GList *item;
+
+    for (item = srtobject->callers; item; item = item->next) {
+      SRTCaller *caller = item->data;
+
+      if (caller->sock != wsocks[i] || !caller->blocked)
+        continue;
+
+      srt_epoll_remove_usock (srtobject->sender_poll_id, caller->sock);
+      caller->blocked = FALSE;
+      break;
+    }
+  }
+}
+
+/* Creates a loopback UDP socket connected to itself. It is polled along
+ * with the blocked callers so that other threads can wake the sender up,
+ * SRT epoll can only poll sockets on every platform. */
+static GSocket *
+gst_srt_object_new_wakeup_socket (GError ** error)
+{
+  GInetAddress *iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  GSocketAddress *addr = g_inet_socket_address_new (iaddr, 0);
+  GSocketAddress *bound = NULL;
+  GSocket *socket;
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, error);
+  if (socket == NULL)
+    goto out;
+
+  if (!g_socket_bind (socket, addr, FALSE, error))
+    goto failed;
+
+  bound = g_socket_get_local_address (socket, error);
+  if (bound == NULL || !g_socket_connect (socket, bound, NULL, error))
+    goto failed;
+
+  g_socket_set_blocking (socket, FALSE);
+
+out:
+  g_clear_object (&bound);
+  g_object_unref (addr);
+  g_object_unref (iaddr);
+
+  return socket;
+
+failed:
+  g_clear_object (&socket);
+  goto out;
+}
+
+/* Wakes up the sender waiting on its epoll */
+static void
+gst_srt_object_wakeup_sender (GstSRTObject * srtobject)
+{
+  const gchar byte = 0;
+  GError *error = NULL;
+
+  if (g_socket_send (srtobject->sender_wakeup, &byte, 1, NULL, &error) < 0) {
+    /* a full socket buffer means the sender has wakeups pending anyway */
+    if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+      GST_WARNING_OBJECT (srtobject->element, "Could not wake up the sender: "
+          "%s", error->message);
+    g_clear_error (&error);
+  }
+}
+
+/* Drains the send queues of all callers. Sends never block: a caller whose
+ * SRT send buffer is full waits on the sender epoll while the others keep
+ * being served. */
+static gpointer
+sender_thread_func (gpointer data)
+{
+  GstSRTObject *srtobject = data;
+  SRTSOCKET wsocks[GST_SRT_SENDER_MAX_EVENTS];
+  gint wsocklen = 0;
+
+  g_mutex_lock (&srtobject->sock_lock);
+
+  while (srtobject->sender_running) {
+    SYSSOCKET lrfds[1];
+    gint lrfdslen = G_N_ELEMENTS (lrfds);
+    GList *item, *next;
+
+    gst_srt_object_unblock_callers (srtobject, wsocks,
+        MIN (wsocklen, (gint) G_N_ELEMENTS (wsocks)));
+
+    for (item = srtobject->callers; item; item = next) {
+      SRTCaller *caller = item->data;
+      next = item->next;
+
+      if (caller->blocked || g_queue_is_empty (&caller->queue))
+        continue;
+
+      if (!gst_srt_object_send_queued (srtobject, caller))
+        gst_srt_object_remove_caller (srtobject, caller);
+    }
+
+    g_mutex_unlock (&srtobject->sock_lock);
+
+    /* Every caller is either drained or blocked now. Wait for a blocked
+     * caller to become writable, or to be woken up for new buffers. */
+    wsocklen = G_N_ELEMENTS (wsocks);
+    if (srt_epoll_wait (srtobject->sender_poll_id, NULL, NULL, wsocks,
+            &wsocklen, -1, lrfds, &lrfdslen, NULL, NULL) < 0) {
+      GST_ELEMENT_ERROR (srtobject->element, RESOURCE, FAILED,
+          ("abort polling: %s", srt_getlasterror_str ()), (NULL));
+      g_mutex_lock (&srtobject->sock_lock);
+      break;
+    }
+
+    if (lrfdslen > 0) {
+      gchar bytes[64];
+
+      while (g_socket_receive (srtobject->sender_wakeup, bytes,
+              sizeof (bytes), NULL, NULL) > 0);
+    }
+
+    g_mutex_lock (&srtobject->sock_lock);
+  }
+
+  g_mutex_unlock (&srtobject->sock_lock);
+
+  return NULL;
+}
+
+/* called with sock_lock */
+static gboolean
+gst_srt_object_start_sender (GstSRTObject * srtobject, GError ** error)
+{
+  gint flag = SRT_EPOLL_IN;
+
+  srtobject->sender_wakeup = gst_srt_object_new_wakeup_socket (error);
+  if (srtobject->sender_wakeup == NULL)
+    return FALSE;
+
+  srtobject->sender_poll_id = srt_epoll_create ();
+  if (srt_epoll_add_ssock (srtobject->sender_poll_id,
+          g_socket_get_fd (srtobject->sender_wakeup), &flag)) {
+    g_set_error (error, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_SETTINGS, "%s",
+        srt_getlasterror_str ());
+    return FALSE;
+  }
+
+  srtobject->sender_running = TRUE;
+  srtobject->sender_thread =
+      g_thread_try_new ("GstSRTObjectSender", sender_thread_func, srtobject,
+      error);
+
+  return srtobject->sender_thread != NULL;
+}
+
+/* called with sock_lock */
+static void
+gst_srt_object_stop_sender (GstSRTObject * srtobject)
+{
+  if (srtobject->sender_thread) {
+    GThread *thread = g_steal_pointer (&srtobject->sender_thread);
+
+    srtobject->sender_running = FALSE;
+    gst_srt_object_wakeup_sender (srtobject);
+
+    g_mutex_unlock (&srtobject->sock_lock);
+    g_thread_join (thread);
+    g_mutex_lock (&srtobject->sock_lock);
+  }
+
+  if (srtobject->sender_poll_id != SRT_ERROR) {
+    srt_epoll_release (srtobject->sender_poll_id);
+    srtobject->sender_poll_id = SRT_ERROR;
+  }
+
+  g_clear_object (&srtobject->sender_wakeup);
+}
+
+/* called with sock_lock. Whether the callers got everything queued for them,
+ * including what SRT still holds in its send buffers */
+static gboolean
+gst_srt_object_callers_drained (GstSRTObject * srtobject)
+{
+  GList *item;
+
+  for (item = srtobject->callers; item; item = item->next) {
+    SRTCaller *caller = item->data;
+    SRT_TRACEBSTATS stats;
+
+    if (!g_queue_is_empty (&caller->queue))
+      return FALSE;
+
+    /* a socket we can't get stats for is broken and won't send anything */
+    if (srt_bstats (caller->sock, &stats, 0) == 0 && stats.pktSndBuf > 0)
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* called with sock_lock */
+static gboolean
+gst_srt_object_drain_locked (GstSRTObject * srtobject,
+    GCancellable * cancellable)
+{
+  gint64 end_time = g_get_monotonic_time () + GST_SRT_DRAIN_TIMEOUT;
+
+  if (srtobject->sender_thread == NULL)
+    return TRUE;
+
+  /* the SRT send buffers only empty as the callers acknowledge the data,
+   * nothing signals that */
+  while (!gst_srt_object_callers_drained (srtobject)) {
+    gint64 now = g_get_monotonic_time ();
+
+    if (g_cancellable_is_cancelled (cancellable))
+      return FALSE;
+
+    if (now >= end_time) {
+      GST_WARNING_OBJECT (srtobject->element, "Timed out waiting for the "
+          "callers to receive the queued data");
+      return FALSE;
+    }
+
+    g_cond_wait_until (&srtobject->sock_cond, &srtobject->sock_lock,
+        MIN (end_time, now + GST_SRT_DRAIN_POLL_INTERVAL));
+  }
+
+  return TRUE;
+}
+
 static gboolean
 gst_srt_object_wait_connect (GstSRTObject * srtobject,
     GCancellable * cancellable, gpointer sa, size_t sa_len, GError ** error)
@@ -837,6 +1227,19 @@ gst_srt_object_wait_connect (GstSRTObject * srtobject,
 
   srtobject->listener_sock = sock;
 
+  if (gst_uri_handler_get_uri_type (GST_URI_HANDLER (srtobject->element)) ==
+      GST_URI_SINK) {
+    gboolean started;
+
+    g_mutex_lock (&srtobject->sock_lock);
+    started = gst_srt_object_start_sender (srtobject, error);
+    g_mutex_unlock (&srtobject->sock_lock);
+
+    if (!started) {
+      goto failed;
+    }
+  }
+
   srtobject->thread =
       g_thread_try_new ("GstSRTObjectListener", thread_func, srtobject, error);
 
@@ -848,6 +1251,10 @@ gst_srt_object_wait_connect (GstSRTObject * srtobject,
 
 failed:
 
+  g_mutex_lock (&srtobject->sock_lock);
+  gst_srt_object_stop_sender (srtobject);
+  g_mutex_unlock (&srtobject->sock_lock);
+
   if (srtobject->listener_poll_id != SRT_ERROR) {
     srt_epoll_release (srtobject->listener_poll_id);
   }
@@ -1091,6 +1498,11 @@ void
 gst_srt_object_close (GstSRTObject * srtobject)
 {
   g_mutex_lock (&srtobject->sock_lock);
+
+  /* give the callers a chance to get what is still queued for them, the
+   * cancellable is already cancelled when stopping */
+  gst_srt_object_drain_locked (srtobject, NULL);
+
   if (srtobject->poll_id != SRT_ERROR) {
     srt_epoll_remove_usock (srtobject->poll_id, srtobject->sock);
   }
@@ -1132,6 +1544,8 @@ gst_srt_object_close (GstSRTObject * srtobject)
     srtobject->listener_sock = SRT_INVALID_SOCK;
   }
 
+  gst_srt_object_stop_sender (srtobject);
+
   if (srtobject->callers) {
     GList *callers = g_steal_pointer (&srtobject->callers);
     g_list_foreach (callers, (GFunc) srt_caller_signal_removed, srtobject);
@@ -1283,6 +1697,21 @@ gst_srt_object_read (GstSRTObject * srtobject,
   return len;
 }
 
+/* Waits for the callers of a listener sink to receive everything queued
+ * for them, up to GST_SRT_DRAIN_TIMEOUT. Returns FALSE on timeout or when
+ * @cancellable is cancelled */
+gboolean
+gst_srt_object_drain (GstSRTObject * srtobject, GCancellable * cancellable)
+{
+  gboolean ret;
+
+  g_mutex_lock (&srtobject->sock_lock);
+  ret = gst_srt_object_drain_locked (srtobject, cancellable);
+  g_mutex_unlock (&srtobject->sock_lock);
+
+  return ret;
+}
+
 void
 gst_srt_object_wakeup (GstSRTObject * srtobject, GCancellable * cancellable)
 {
@@ -1356,63 +1785,100 @@ gst_srt_object_send_headers (GstSRTObject * srtobject, SRTSOCKET sock,
   return TRUE;
 }
 
+/* called with sock_lock, returns FALSE if the caller has to be dropped */
+static gboolean
+gst_srt_object_queue_buffer (GstSRTObject * srtobject, SRTCaller * caller,
+    GstBuffer * buffer, guint max_size, GstSRTSlowCallerPolicy policy)
+{
+  if (max_size > 0 && caller->queue.length >= max_size) {
+    GList *oldest;
+
+    if (policy == GST_SRT_SLOW_CALLER_POLICY_DISCONNECT) {
+      GST_WARNING_OBJECT (srtobject->element, "Dropping slow caller %d, %u "
+          "buffers queued", caller->sock, caller->queue.length);
+      return FALSE;
+    }
+
+    /* Keep the partially sent head buffer and the stream headers */
+    oldest = caller->queue.head;
+    if (oldest && caller->offset > 0)
+      oldest = oldest->next;
+    while (oldest && GST_BUFFER_FLAG_IS_SET (oldest->data,
+            GST_BUFFER_FLAG_HEADER))
+      oldest = oldest->next;
+
+    if (oldest) {
+      GstBuffer *dropped = oldest->data;
+
+      GST_LOG_OBJECT (srtobject->element, "Caller %d is too slow, dropping %"
+          GST_PTR_FORMAT, caller->sock, dropped);
+
+      g_queue_delete_link (&caller->queue, oldest);
+      caller->queued_bytes -= gst_buffer_get_size (dropped);
+      caller->buffers_dropped++;
+      gst_buffer_unref (dropped);
+    }
+  }
+
+  g_queue_push_tail (&caller->queue, gst_buffer_ref (buffer));
+  caller->queued_bytes += gst_buffer_get_size (buffer);
+
+  return TRUE;
+}
+
+/* Only queues the buffers, the sender thread does the actual sending */
 static gssize
 gst_srt_object_write_to_callers (GstSRTObject * srtobject,
     GstBufferList * headers,
-    const GstMapInfo * mapinfo, GCancellable * cancellable, GError ** error)
+    GstBufferList * list, GCancellable * cancellable, GError ** error)
 {
   GList *callers;
+  guint max_size, n_buffers, i;
+  GstSRTSlowCallerPolicy policy;
+
+  GST_OBJECT_LOCK (srtobject->element);
+  max_size = srtobject->caller_queue_size;
+  policy = srtobject->slow_caller_policy;
+  GST_OBJECT_UNLOCK (srtobject->element);
+
+  n_buffers = gst_buffer_list_length (list);
 
   g_mutex_lock (&srtobject->sock_lock);
+
+  if (g_cancellable_is_cancelled (cancellable)) {
+    goto cancelled;
+  }
+
   callers = srtobject->callers;
   while (callers != NULL) {
-    gssize len = 0;
-    const guint8 *msg = mapinfo->data;
-    gint sent;
-    gint payload_size, optlen = 1;
-
     SRTCaller *caller = callers->data;
     callers = callers->next;
 
-    if (g_cancellable_is_cancelled (cancellable)) {
-      goto cancelled;
-    }
-
     if (!caller->sent_headers) {
-      if (!gst_srt_object_send_headers (srtobject, caller->sock, -1,
-              -1, headers, cancellable)) {
-        goto err;
+      guint n_headers = headers ? gst_buffer_list_length (headers) : 0;
+
+      for (i = 0; i < n_headers; i++) {
+        GstBuffer *header = gst_buffer_list_get (headers, i);
+
+        g_queue_push_tail (&caller->queue, gst_buffer_ref (header));
+        caller->queued_bytes += gst_buffer_get_size (header);
       }
       caller->sent_headers = TRUE;
     }
 
-    if (srt_getsockflag (caller->sock, SRTO_PAYLOADSIZE, &payload_size,
-            &optlen)) {
-      GST_WARNING_OBJECT (srtobject->element, "%s", srt_getlasterror_str ());
-      goto err;
-    }
-
-    while (len < mapinfo->size) {
-      gint rest = MIN (mapinfo->size - len, payload_size);
-      sent = srt_sendmsg2 (caller->sock, (char *) (msg + len), rest, 0);
-      if (sent < 0) {
-        GST_WARNING_OBJECT (srtobject->element, "Dropping caller %d: %s",
-            caller->sock, srt_getlasterror_str ());
-        goto err;
+    for (i = 0; i < n_buffers; i++) {
+      if (!gst_srt_object_queue_buffer (srtobject, caller,
+              gst_buffer_list_get (list, i), max_size, policy)) {
+        gst_srt_object_remove_caller (srtobject, caller);
+        break;
       }
-      len += sent;
     }
-
-    continue;
-
-  err:
-    srtobject->callers = g_list_remove (srtobject->callers, caller);
-    srt_caller_signal_removed (caller, srtobject);
-    srt_caller_free (caller);
   }
 
+  gst_srt_object_wakeup_sender (srtobject);
   g_mutex_unlock (&srtobject->sock_lock);
-  return mapinfo->size;
+
+  return gst_buffer_list_calculate_size (list);
 
 cancelled:
   g_mutex_unlock (&srtobject->sock_lock);
@@ -1503,11 +1969,31 @@ gst_srt_object_write_one (GstSRTObject * srtobject,
 gssize
 gst_srt_object_write (GstSRTObject * srtobject,
     GstBufferList * headers,
-    const GstMapInfo * mapinfo, GCancellable * cancellable, GError ** error)
+    GstBuffer * buffer, GCancellable * cancellable, GError ** error)
+{
+  GstBufferList *list;
+  gssize len;
+
+  list = gst_buffer_list_new_sized (1);
+  gst_buffer_list_add (list, gst_buffer_ref (buffer));
+
+  len = gst_srt_object_write_list (srtobject, headers, list, cancellable,
+      error);
+
+  gst_buffer_list_unref (list);
+
+  return len;
+}
+
+gssize
+gst_srt_object_write_list (GstSRTObject * srtobject,
+    GstBufferList * headers,
+    GstBufferList * list, GCancellable * cancellable, GError ** error)
 {
   gssize len = 0;
   GstSRTConnectionMode connection_mode = GST_SRT_CONNECTION_MODE_NONE;
   gboolean wait_for_connection;
+  guint i, n_buffers;
 
   /* Only sink element can write data */
   g_return_val_if_fail (gst_uri_handler_get_uri_type (GST_URI_HANDLER
@@ -1524,13 +2010,32 @@ gst_srt_object_write (GstSRTObject * srtobject,
       if (!gst_srt_object_wait_caller (srtobject, cancellable, error))
         return -1;
     }
-    len =
-        gst_srt_object_write_to_callers (srtobject, headers, mapinfo,
+    return gst_srt_object_write_to_callers (srtobject, headers, list,
         cancellable, error);
-  } else {
-    len =
-        gst_srt_object_write_one (srtobject, headers, mapinfo, cancellable,
-        error);
+  }
+
+  n_buffers = gst_buffer_list_length (list);
+  for (i = 0; i < n_buffers; i++) {
+    GstBuffer *buffer = gst_buffer_list_get (list, i);
+    GstMapInfo mapinfo;
+    gssize sent;
+
+    if (g_cancellable_is_cancelled (cancellable))
+      break;
+
+    if (!gst_buffer_map (buffer, &mapinfo, GST_MAP_READ)) {
+      GST_ELEMENT_ERROR (srtobject->element, RESOURCE, READ,
+          ("Could not map the input stream"), (NULL));
+      return -1;
+    }
+
+    sent = gst_srt_object_write_one (srtobject, headers, &mapinfo,
+        cancellable, error);
+    gst_buffer_unmap (buffer, &mapinfo);
+
+    if (sent < 0)
+      return -1;
+    len += sent;
   }
 
   return len;
@@ -1629,6 +2134,15 @@ gst_srt_object_get_stats (GstSRTObject * srtobject)
 
       tmp = get_stats_for_srtsock (caller->sock, is_sender, &bytes);
 
+      if (is_sender) {
+        gst_structure_set (tmp,
+            "queued-buffers", G_TYPE_UINT, caller->queue.length,
+            "queued-bytes", G_TYPE_UINT64, caller->queued_bytes,
+            "buffers-sent", G_TYPE_UINT64, caller->buffers_sent,
+            "buffers-dropped", G_TYPE_UINT64, caller->buffers_dropped,
+            "blocked", G_TYPE_BOOLEAN, caller->blocked, NULL);
+      }
+
       g_value_array_append (callers_stats, NULL);
       v = g_value_array_get_nth (callers_stats, callers_stats->n_values - 1);
       g_value_init (v, GST_TYPE_STRUCTURE);
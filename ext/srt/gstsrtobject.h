@@ -42,6 +42,8 @@ G_BEGIN_DECLS
 #define GST_SRT_DEFAULT_LATENCY 125
 #define GST_SRT_DEFAULT_MSG_SIZE 1316
 #define GST_SRT_DEFAULT_WAIT_FOR_CONNECTION (TRUE)
+#define GST_SRT_DEFAULT_CALLER_QUEUE_SIZE 1000
+#define GST_SRT_DEFAULT_SLOW_CALLER_POLICY GST_SRT_SLOW_CALLER_POLICY_DROP_OLDEST
 
 typedef struct _GstSRTObject GstSRTObject;
 
@@ -62,15 +64,24 @@ struct _GstSRTObject
 
   GThread                      *thread;
 
-  /* Protects the list of callers */
+  /* Protects the list of callers and their send queues */
   GMutex                        sock_lock;
   GCond                         sock_cond;
 
   GList                        *callers;
 
+  /* Listener sink only: drains the callers send queues. The sender waits
+   * on its epoll for blocked callers and for the wakeup socket. */
+  GThread                      *sender_thread;
+  gint                          sender_poll_id;
+  GSocket                      *sender_wakeup;
+  gboolean                      sender_running;
+
   gchar                        *passphrase;
 
   gboolean                     wait_for_connection;
+  guint                        caller_queue_size;
+  GstSRTSlowCallerPolicy       slow_caller_policy;
 
   guint64                      previous_bytes;
 };
@@ -104,10 +115,19 @@ gssize          gst_srt_object_read     (GstSRTObject * srtobject,
 
 gssize          gst_srt_object_write    (GstSRTObject * srtobject,
                                          GstBufferList * headers,
-                                         const GstMapInfo * mapinfo,
+                                         GstBuffer * buffer,
                                          GCancellable *cancellable,
                                          GError **err);
 
+gssize          gst_srt_object_write_list (GstSRTObject * srtobject,
+                                           GstBufferList * headers,
+                                           GstBufferList * list,
+                                           GCancellable *cancellable,
+                                           GError **err);
+
+gboolean        gst_srt_object_drain    (GstSRTObject * srtobject,
+                                         GCancellable *cancellable);
+
 void            gst_srt_object_wakeup   (GstSRTObject * srtobject,
                                          GCancellable *cancellable);
 
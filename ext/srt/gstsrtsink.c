@@ -36,6 +36,12 @@
  * gst-launch-1.0 -v audiotestsrc ! srtsink uri=srt://:port
  * ]| This pipeline shows how to wait SRT callers.
  *
+ * In listener mode each caller gets its own send queue, drained by a
+ * separate thread, so that a slow caller does not hold back the others.
+ * See #GstSRTSink:caller-queue-size and #GstSRTSink:slow-caller-policy.
+ * On EOS, the sink waits for the callers to receive what was queued for
+ * them, for up to two seconds.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
@@ -152,12 +158,24 @@ gst_srt_sink_stop (GstBaseSink * bsink)
   return TRUE;
 }
 
+static GstFlowReturn
+gst_srt_sink_write_error (GstSRTSink * self, const GError * error)
+{
+  /* writes are interrupted when flushing */
+  if (g_cancellable_is_cancelled (self->cancellable))
+    return GST_FLOW_FLUSHING;
+
+  GST_ELEMENT_ERROR (self, RESOURCE, WRITE, ("Failed to write to SRT socket"),
+      ("%s", error ? error->message : "Unknown error"));
+
+  return GST_FLOW_ERROR;
+}
+
 static GstFlowReturn
 gst_srt_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 {
   GstSRTSink *self = GST_SRT_SINK (sink);
   GstFlowReturn ret = GST_FLOW_OK;
-  GstMapInfo info;
   GError *error = NULL;
 
   if (g_cancellable_is_cancelled (self->cancellable)) {
@@ -170,18 +188,11 @@ gst_srt_sink_render (GstBaseSink * sink, GstBuffer * buffer)
     return GST_FLOW_OK;
   }
 
-  if (!gst_buffer_map (buffer, &info, GST_MAP_READ)) {
-    GST_ELEMENT_ERROR (self, RESOURCE, READ,
-        ("Could not map the input stream"), (NULL));
-    return GST_FLOW_ERROR;
-  }
-
-  if (gst_srt_object_write (self->srtobject, self->headers, &info,
+  if (gst_srt_object_write (self->srtobject, self->headers, buffer,
           self->cancellable, &error) < 0) {
-    ret = GST_FLOW_ERROR;
+    ret = gst_srt_sink_write_error (self, error);
   }
-
-  gst_buffer_unmap (buffer, &info);
+  g_clear_error (&error);
 
   GST_TRACE_OBJECT (self, "sending buffer %p, offset %"
       G_GINT64_FORMAT ", offset_end %" G_GINT64_FORMAT
@@ -196,6 +207,63 @@ gst_srt_sink_render (GstBaseSink * sink, GstBuffer * buffer)
   return ret;
 }
 
+static gboolean
+drop_header_buffer (GstBuffer ** buffer, guint idx, gpointer user_data)
+{
+  if (GST_BUFFER_FLAG_IS_SET (*buffer, GST_BUFFER_FLAG_HEADER))
+    gst_clear_buffer (buffer);
+
+  return TRUE;
+}
+
+static GstFlowReturn
+gst_srt_sink_render_list (GstBaseSink * sink, GstBufferList * list)
+{
+  GstSRTSink *self = GST_SRT_SINK (sink);
+  GstFlowReturn ret = GST_FLOW_OK;
+  GError *error = NULL;
+
+  if (g_cancellable_is_cancelled (self->cancellable)) {
+    return GST_FLOW_FLUSHING;
+  }
+
+  list = gst_buffer_list_ref (list);
+
+  if (self->headers) {
+    list = gst_buffer_list_make_writable (list);
+    gst_buffer_list_foreach (list, drop_header_buffer, NULL);
+  }
+
+  /* In listener mode the whole list is queued for each caller at once */
+  if (gst_srt_object_write_list (self->srtobject, self->headers, list,
+          self->cancellable, &error) < 0) {
+    ret = gst_srt_sink_write_error (self, error);
+  }
+  g_clear_error (&error);
+
+  GST_TRACE_OBJECT (self, "sending list of %u buffers",
+      gst_buffer_list_length (list));
+
+  gst_buffer_list_unref (list);
+
+  return ret;
+}
+
+static gboolean
+gst_srt_sink_event (GstBaseSink * bsink, GstEvent * event)
+{
+  GstSRTSink *self = GST_SRT_SINK (bsink);
+
+  /* In listener mode the callers are served by another thread, only let EOS
+   * through once they received everything */
+  if (GST_EVENT_TYPE (event) == GST_EVENT_EOS &&
+      !gst_srt_object_drain (self->srtobject, self->cancellable)) {
+    GST_WARNING_OBJECT (self, "Not all the data was sent to the callers");
+  }
+
+  return GST_BASE_SINK_CLASS (parent_class)->event (bsink, event);
+}
+
 static gboolean
 gst_srt_sink_unlock (GstBaseSink * bsink)
 {
@@ -315,6 +383,8 @@ gst_srt_sink_class_init (GstSRTSinkClass * klass)
   gstbasesink_class->start = GST_DEBUG_FUNCPTR (gst_srt_sink_start);
   gstbasesink_class->stop = GST_DEBUG_FUNCPTR (gst_srt_sink_stop);
   gstbasesink_class->render = GST_DEBUG_FUNCPTR (gst_srt_sink_render);
+  gstbasesink_class->render_list = GST_DEBUG_FUNCPTR (gst_srt_sink_render_list);
+  gstbasesink_class->event = GST_DEBUG_FUNCPTR (gst_srt_sink_event);
   gstbasesink_class->unlock = GST_DEBUG_FUNCPTR (gst_srt_sink_unlock);
   gstbasesink_class->unlock_stop = GST_DEBUG_FUNCPTR (gst_srt_sink_unlock_stop);
   gstbasesink_class->set_caps = GST_DEBUG_FUNCPTR (gst_srt_sink_set_caps);
@@ -218,6 +218,10 @@ struct _GstSrtpDecSsrcStream
 {
   guint32 ssrc;
 
+  /* every SSRC has its own libsrtp session, which keeps the lookup of the
+   * libsrtp stream constant time however many SSRCs are received */
+  srtp_t session;
+
   guint32 roc;
   GstBuffer *key;
   GstSrtpCipherType rtp_cipher;
@@ -414,7 +418,6 @@ gst_srtp_dec_init (GstSrtpDec * filter)
   gst_element_add_pad (GST_ELEMENT (filter), filter->rtcp_sinkpad);
   gst_element_add_pad (GST_ELEMENT (filter), filter->rtcp_srcpad);
 
-  filter->first_session = TRUE;
 }
 
 static GstStructure *
@@ -429,18 +432,22 @@ gst_srtp_dec_create_stats (GstSrtpDec * filter)
   g_value_init (&va, GST_TYPE_ARRAY);
   g_value_init (&v, GST_TYPE_STRUCTURE);
 
-  if (filter->session) {
+  if (filter->streams) {
     GHashTableIter iter;
-    gpointer key;
+    gpointer key, value;
 
     g_hash_table_iter_init (&iter, filter->streams);
-    while (g_hash_table_iter_next (&iter, &key, NULL)) {
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+      GstSrtpDecSsrcStream *stream = value;
       GstStructure *ss;
       guint32 ssrc = GPOINTER_TO_UINT (key);
       srtp_err_status_t status;
       guint32 roc;
 
-      status = srtp_get_stream_roc (filter->session, ssrc, &roc);
+      if (stream->session == NULL)
+        continue;
+
+      status = srtp_get_stream_roc (stream->session, ssrc, &roc);
       if (status != srtp_err_status_ok) {
         continue;
       }
@@ -512,10 +519,8 @@ gst_srtp_dec_remove_stream (GstSrtpDec * filter, guint ssrc)
 
   stream = g_hash_table_lookup (filter->streams, GUINT_TO_POINTER (ssrc));
 
-  if (stream) {
-    srtp_remove_stream (filter->session, ssrc);
+  if (stream)
     g_hash_table_remove (filter->streams, GUINT_TO_POINTER (ssrc));
-  }
 }
 
 static GstSrtpDecSsrcStream *
@@ -740,13 +745,7 @@ init_session_stream (GstSrtpDec * filter, guint32 ssrc,
   policy.window_size = filter->replay_window_size;
   policy.next = NULL;
 
-  /* If it is the first stream, create the session
-   * If not, add the stream policy to the session
-   */
-  if (filter->first_session)
-    ret = srtp_create (&filter->session, &policy);
-  else
-    ret = srtp_add_stream (filter->session, &policy);
+  ret = srtp_create (&stream->session, &policy);
 
   if (stream->key)
     gst_buffer_unmap (stream->key, &map);
@@ -768,7 +767,7 @@ init_session_stream (GstSrtpDec * filter, guint32 ssrc,
   if (ret == srtp_err_status_ok) {
     srtp_err_status_t status;
 
-    status = srtp_set_stream_roc (filter->session, ssrc, stream->roc);
+    status = srtp_set_stream_roc (stream->session, ssrc, stream->roc);
 #ifdef HAVE_SRTP2
     (void) status;              /* Ignore unused variable */
 #else
@@ -780,7 +779,6 @@ init_session_stream (GstSrtpDec * filter, guint32 ssrc,
     }
 #endif
 
-    filter->first_session = FALSE;
     g_hash_table_insert (filter->streams, GUINT_TO_POINTER (stream->ssrc),
         stream);
   }
@@ -830,6 +828,8 @@ have_ssrc:
 static void
 free_stream (GstSrtpDecSsrcStream * stream)
 {
+  if (stream->session)
+    srtp_dealloc (stream->session);
   if (stream->key)
     gst_buffer_unref (stream->key);
   if (stream->keys)
@@ -958,16 +958,9 @@ gst_srtp_dec_clear_streams (GstSrtpDec * filter)
 
   GST_OBJECT_LOCK (filter);
 
-  if (!filter->first_session) {
-    srtp_dealloc (filter->session);
-    filter->session = NULL;
-  }
-
   if (filter->streams)
     nb = g_hash_table_foreach_remove (filter->streams, remove_yes, NULL);
 
-  filter->first_session = TRUE;
-
   GST_OBJECT_UNLOCK (filter);
 
   GST_DEBUG_OBJECT (filter, "Cleared %d streams", nb);
@@ -1319,6 +1312,7 @@ gst_srtp_dec_decode_buffer (GstSrtpDec * filter, GstPad * pad, GstBuffer * buf,
     gboolean is_rtcp, guint32 ssrc)
 {
   GstMapInfo map;
+  GstSrtpDecSsrcStream *stream;
   srtp_err_status_t err;
   gint size;
 
@@ -1334,16 +1328,20 @@ gst_srtp_dec_decode_buffer (GstSrtpDec * filter, GstPad * pad, GstBuffer * buf,
 
 unprotect:
 
+  stream = find_stream_by_ssrc (filter, ssrc);
+  if (stream == NULL || stream->session == NULL) {
+    GST_WARNING_OBJECT (filter, "Could not find matching stream, dropping");
+    goto err;
+  }
+
   gst_srtp_init_event_reporter ();
 
   if (is_rtcp) {
 #ifdef HAVE_SRTP2
-    GstSrtpDecSsrcStream *stream = find_stream_by_ssrc (filter, ssrc);
-
-    err = srtp_unprotect_rtcp_mki (filter->session, map.data, &size,
-        stream && stream->keys);
+    err = srtp_unprotect_rtcp_mki (stream->session, map.data, &size,
+        stream->keys != NULL);
 #else
-    err = srtp_unprotect_rtcp (filter->session, map.data, &size);
+    err = srtp_unprotect_rtcp (stream->session, map.data, &size);
 #endif
   } else {
 #ifndef HAVE_SRTP2
@@ -1351,11 +1349,11 @@ unprotect:
      * sequence number too. */
     if (g_hash_table_contains (filter->streams_roc_changed,
             GUINT_TO_POINTER (ssrc))) {
-      srtp_stream_t stream;
+      srtp_stream_t srtp_stream;
 
-      stream = srtp_get_stream (filter->session, htonl (ssrc));
+      srtp_stream = srtp_get_stream (stream->session, htonl (ssrc));
 
-      if (stream) {
+      if (srtp_stream) {
         guint16 seqnum = 0;
         GstRTPBuffer rtpbuf = GST_RTP_BUFFER_INIT;
 
@@ -1366,8 +1364,8 @@ unprotect:
 
         /* We finally add the RTP sequence number to the current
          * rollover counter. */
-        stream->rtp_rdbx.index &= ~0xFFFF;
-        stream->rtp_rdbx.index |= seqnum;
+        srtp_stream->rtp_rdbx.index &= ~0xFFFF;
+        srtp_stream->rtp_rdbx.index |= seqnum;
       }
 
       g_hash_table_remove (filter->streams_roc_changed,
@@ -1376,14 +1374,10 @@ unprotect:
 #endif
 
 #ifdef HAVE_SRTP2
-    {
-      GstSrtpDecSsrcStream *stream = find_stream_by_ssrc (filter, ssrc);
-
-      err = srtp_unprotect_mki (filter->session, map.data, &size,
-          stream && stream->keys);
-    }
+    err = srtp_unprotect_mki (stream->session, map.data, &size,
+        stream->keys != NULL);
 #else
-    err = srtp_unprotect (filter->session, map.data, &size);
+    err = srtp_unprotect (stream->session, map.data, &size);
 #endif
   }
 
@@ -1401,15 +1395,6 @@ unprotect:
           "Dropping replayed old packet, probably retransmission");
       goto err;
     case srtp_err_status_key_expired:{
-      GstSrtpDecSsrcStream *stream;
-
-      /* Check we have an existing stream to rekey */
-      stream = find_stream_by_ssrc (filter, ssrc);
-      if (stream == NULL) {
-        GST_WARNING_OBJECT (filter, "Could not find matching stream, dropping");
-        goto err;
-      }
-
       GST_OBJECT_UNLOCK (filter);
       stream = request_key_with_signal (filter, ssrc, SIGNAL_HARD_LIMIT);
       GST_OBJECT_LOCK (filter);
@@ -76,8 +76,6 @@ struct _GstSrtpDec
   GstPad *rtcp_sinkpad, *rtcp_srcpad;
 
   gboolean ask_update;
-  srtp_t session;
-  gboolean first_session;
   GHashTable *streams;
 
   gboolean rtp_has_segment;
@@ -131,6 +131,7 @@ GST_DEBUG_CATEGORY_STATIC (gst_srtp_enc_debug);
 #define DEFAULT_RANDOM_KEY      FALSE
 #define DEFAULT_REPLAY_WINDOW_SIZE 128
 #define DEFAULT_ALLOW_REPEAT_TX FALSE
+#define DEFAULT_N_THREADS 1
 
 #define HAS_CRYPTO(filter) (filter->rtp_cipher != GST_SRTP_CIPHER_NULL || \
       filter->rtcp_cipher != GST_SRTP_CIPHER_NULL ||                      \
@@ -157,17 +158,43 @@ enum
   PROP_REPLAY_WINDOW_SIZE,
   PROP_ALLOW_REPEAT_TX,
   PROP_STATS,
-  PROP_MKI
+  PROP_MKI,
+  PROP_N_THREADS
 };
 
-typedef struct ProcessBufferItData
+/* A libsrtp session for one SSRC. libsrtp contexts are not thread-safe,
+ * each one is protected by its own lock instead of the element lock so
+ * that different streams can be protected concurrently. */
+typedef struct _GstSrtpEncSession
+{
+  gint refcount;
+  GMutex lock;
+  srtp_t session;
+} GstSrtpEncSession;
+
+/* The jobs of one buffer list, several pads can protect lists at once so
+ * this lives on the stack of the streaming thread that waits for them */
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  guint pending;
+} GstSrtpEncBatch;
+
+/* The buffers of one SSRC from a buffer list, protected in order */
+typedef struct
 {
   GstSrtpEnc *filter;
+  GstSrtpEncBatch *batch;
   GstPad *pad;
-  GstBufferList *out_list;
-  GstFlowReturn flowret;
+  GstBufferList *list;
   gboolean is_rtcp;
-} ProcessBufferItData;
+  gboolean in_place;
+  GArray *indices;
+  GstBuffer **outbufs;
+  GstFlowReturn ret;
+  gboolean soft_limit;
+} GstSrtpEncJob;
 
 /* the capabilities of the inputs and outputs.
  *
@@ -206,6 +233,7 @@ G_DEFINE_TYPE (GstSrtpEnc, gst_srtp_enc, GST_TYPE_ELEMENT);
 static guint gst_srtp_enc_signals[LAST_SIGNAL] = { 0 };
 
 static void gst_srtp_enc_dispose (GObject * object);
+static void gst_srtp_enc_finalize (GObject * object);
 
 static void gst_srtp_enc_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
@@ -275,6 +303,7 @@ gst_srtp_enc_class_init (GstSrtpEncClass * klass)
   gobject_class->set_property = gst_srtp_enc_set_property;
   gobject_class->get_property = gst_srtp_enc_get_property;
   gobject_class->dispose = gst_srtp_enc_dispose;
+  gobject_class->finalize = gst_srtp_enc_finalize;
   gstelement_class->request_new_pad =
       GST_DEBUG_FUNCPTR (gst_srtp_enc_request_new_pad);
   gstelement_class->release_pad = GST_DEBUG_FUNCPTR (gst_srtp_enc_release_pad);
@@ -331,6 +360,22 @@ gst_srtp_enc_class_init (GstSrtpEncClass * klass)
           GST_PARAM_MUTABLE_PLAYING));
 #endif
 
+  /**
+   * GstSrtpEnc:n-threads:
+   *
+   * Number of threads used to protect the buffers of a buffer list. The
+   * buffers are split by SSRC and each SSRC is protected in order on one
+   * thread, the output list keeps the order of the input list. 0 uses one
+   * thread per CPU core.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Maximum number of threads used for buffer lists "
+          "(0 = number of CPU cores)", 0, G_MAXINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstSrtpEnc::soft-limit:
    * @gstsrtpenc: the element on which the signal is emitted
@@ -345,6 +390,36 @@ gst_srtp_enc_class_init (GstSrtpEncClass * klass)
 }
 
 
+static GstSrtpEncSession *
+gst_srtp_enc_session_new (srtp_t srtp)
+{
+  GstSrtpEncSession *session = g_slice_new (GstSrtpEncSession);
+
+  session->refcount = 1;
+  g_mutex_init (&session->lock);
+  session->session = srtp;
+
+  return session;
+}
+
+static GstSrtpEncSession *
+gst_srtp_enc_session_ref (GstSrtpEncSession * session)
+{
+  g_atomic_int_inc (&session->refcount);
+  return session;
+}
+
+static void
+gst_srtp_enc_session_unref (GstSrtpEncSession * session)
+{
+  if (!g_atomic_int_dec_and_test (&session->refcount))
+    return;
+
+  srtp_dealloc (session->session);
+  g_mutex_clear (&session->lock);
+  g_slice_free (GstSrtpEncSession, session);
+}
+
 /* initialize the new element
  */
 static void
@@ -359,7 +434,9 @@ gst_srtp_enc_init (GstSrtpEnc * filter)
   filter->rtcp_auth = DEFAULT_RTCP_AUTH;
   filter->replay_window_size = DEFAULT_REPLAY_WINDOW_SIZE;
   filter->allow_repeat_tx = DEFAULT_ALLOW_REPEAT_TX;
-  filter->ssrcs_set = g_hash_table_new (g_direct_hash, g_direct_equal);
+  filter->n_threads = DEFAULT_N_THREADS;
+  filter->sessions = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+      NULL, (GDestroyNotify) gst_srtp_enc_session_unref);
 }
 
 static guint
@@ -378,7 +455,7 @@ max_cipher_key_size (GstSrtpEnc * filter)
  * Should be called with the filter locked
  */
 static srtp_err_status_t
-gst_srtp_enc_create_session (GstSrtpEnc * filter)
+gst_srtp_enc_create_session (GstSrtpEnc * filter, srtp_t * session)
 {
   srtp_err_status_t ret;
   srtp_policy_t policy;
@@ -464,11 +541,7 @@ gst_srtp_enc_create_session (GstSrtpEnc * filter)
   policy.window_size = filter->replay_window_size;
   policy.allow_repeat_tx = filter->allow_repeat_tx;
 
-  /* If it is the first stream, create the session
-   * If not, add the stream to the session
-   */
-  ret = srtp_create (&filter->session, &policy);
-  filter->first_session = FALSE;
+  ret = srtp_create (session, &policy);
 
 #ifdef HAVE_SRTP2
 done:
@@ -489,14 +562,10 @@ done:
 static void
 gst_srtp_enc_reset_no_lock (GstSrtpEnc * filter)
 {
-  if (!filter->first_session) {
-    if (filter->session) {
-      srtp_dealloc (filter->session);
-      filter->session = NULL;
-    }
-
-    g_hash_table_remove_all (filter->ssrcs_set);
-  }
+  /* buffers being protected keep their session alive until they are done */
+  if (!filter->first_session)
+    g_hash_table_remove_all (filter->sessions);
+  g_clear_pointer (&filter->fallback_session, gst_srtp_enc_session_unref);
 
   filter->first_session = TRUE;
   filter->key_changed = FALSE;
@@ -649,13 +718,27 @@ gst_srtp_enc_dispose (GObject * object)
   gst_buffer_replace (&filter->key, NULL);
   gst_buffer_replace (&filter->mki, NULL);
 
-  if (filter->ssrcs_set)
-    g_hash_table_unref (filter->ssrcs_set);
-  filter->ssrcs_set = NULL;
+  if (filter->sessions)
+    g_hash_table_unref (filter->sessions);
+  filter->sessions = NULL;
+  g_clear_pointer (&filter->fallback_session, gst_srtp_enc_session_unref);
+
+  if (filter->pool)
+    g_thread_pool_free (filter->pool, FALSE, TRUE);
+  filter->pool = NULL;
 
   G_OBJECT_CLASS (gst_srtp_enc_parent_class)->dispose (object);
 }
 
+static void
+gst_srtp_enc_finalize (GObject * object)
+{
+  GstSrtpEnc *filter = GST_SRTP_ENC (object);
+
+
+  G_OBJECT_CLASS (gst_srtp_enc_parent_class)->finalize (object);
+}
+
 static GstStructure *
 gst_srtp_enc_create_stats (GstSrtpEnc * filter)
 {
@@ -668,18 +751,21 @@ gst_srtp_enc_create_stats (GstSrtpEnc * filter)
   g_value_init (&va, GST_TYPE_ARRAY);
   g_value_init (&v, GST_TYPE_STRUCTURE);
 
-  if (filter->session) {
+  if (filter->sessions) {
     GHashTableIter iter;
-    gpointer key;
+    gpointer key, value;
 
-    g_hash_table_iter_init (&iter, filter->ssrcs_set);
-    while (g_hash_table_iter_next (&iter, &key, NULL)) {
+    g_hash_table_iter_init (&iter, filter->sessions);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+      GstSrtpEncSession *session = value;
       GstStructure *ss;
       guint32 ssrc = GPOINTER_TO_UINT (key);
       srtp_err_status_t status;
       guint32 roc;
 
-      status = srtp_get_stream_roc (filter->session, ssrc, &roc);
+      g_mutex_lock (&session->lock);
+      status = srtp_get_stream_roc (session->session, ssrc, &roc);
+      g_mutex_unlock (&session->lock);
       if (status != srtp_err_status_ok) {
         continue;
       }
@@ -754,6 +840,10 @@ gst_srtp_enc_set_property (GObject * object, guint prop_id,
       GST_INFO_OBJECT (object, "Set property: mki=[%p]", filter->mki);
       break;
 #endif
+
+    case PROP_N_THREADS:
+      filter->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -798,6 +888,9 @@ gst_srtp_enc_get_property (GObject * object, guint prop_id,
     case PROP_STATS:
       g_value_take_boxed (value, gst_srtp_enc_create_stats (filter));
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, filter->n_threads);
+      break;
 #ifdef HAVE_SRTP2
     case PROP_MKI:
       if (filter->mki)
@@ -820,16 +913,6 @@ get_rtp_other_pad (GstPad * pad)
   return GST_PAD (gst_pad_get_element_private (pad));
 }
 
-static void
-gst_srtp_enc_add_ssrc (GstSrtpEnc * filter, guint ssrc)
-{
-  gboolean is_added =
-      g_hash_table_add (filter->ssrcs_set, GUINT_TO_POINTER (ssrc));
-  if (is_added) {
-    GST_DEBUG_OBJECT (filter, "Added ssrc %u", ssrc);
-  }
-}
-
 /* Release a sink pad and it's linked source pad
  */
 static void
@@ -1079,7 +1162,8 @@ gst_srtp_enc_check_set_caps (GstSrtpEnc * filter, GstPad * pad,
   }
 
   if (filter->first_session) {
-    srtp_err_status_t status = gst_srtp_enc_create_session (filter);
+    srtp_t session = NULL;
+    srtp_err_status_t status = gst_srtp_enc_create_session (filter, &session);
 
     if (status != srtp_err_status_ok) {
       GST_OBJECT_UNLOCK (filter);
@@ -1088,6 +1172,9 @@ gst_srtp_enc_check_set_caps (GstSrtpEnc * filter, GstPad * pad,
           ("Failed to add stream to SRTP encoder (err: %d)", status));
       return GST_FLOW_ERROR;
     }
+
+    filter->fallback_session = gst_srtp_enc_session_new (session);
+    filter->first_session = FALSE;
   }
 
   GST_OBJECT_UNLOCK (filter);
@@ -1107,75 +1194,176 @@ gst_srtp_enc_check_set_caps (GstSrtpEnc * filter, GstPad * pad,
   return GST_FLOW_OK;
 }
 
-static void
-gst_srtp_enc_ensure_ssrc (GstSrtpEnc * filter, GstBuffer * buf)
+/* Returns FALSE and sets @ssrc to 0 if @buf has no SSRC */
+static gboolean
+gst_srtp_enc_get_ssrc (GstBuffer * buf, gboolean is_rtcp, guint32 * ssrc)
 {
-  GstRTPBuffer rtpbuf = GST_RTP_BUFFER_INIT;
-  if (gst_rtp_buffer_map (buf,
-          GST_MAP_READ | GST_RTP_BUFFER_MAP_FLAG_SKIP_PADDING, &rtpbuf)) {
-    guint32 ssrc = gst_rtp_buffer_get_ssrc (&rtpbuf);
-    gst_srtp_enc_add_ssrc (filter, ssrc);
-    gst_rtp_buffer_unmap (&rtpbuf);
+  gboolean ret = FALSE;
+
+  *ssrc = 0;
+
+  if (is_rtcp) {
+    ret = rtcp_buffer_get_ssrc (buf, ssrc);
+  } else {
+    GstRTPBuffer rtpbuf = GST_RTP_BUFFER_INIT;
+
+    if (gst_rtp_buffer_map (buf,
+            GST_MAP_READ | GST_RTP_BUFFER_MAP_FLAG_SKIP_PADDING, &rtpbuf)) {
+      *ssrc = gst_rtp_buffer_get_ssrc (&rtpbuf);
+      gst_rtp_buffer_unmap (&rtpbuf);
+      ret = TRUE;
+    }
   }
+
+  return ret;
 }
 
+/* Returns a new reference to the session of @ssrc, creating it if needed.
+ *
+ * Should be called with the filter locked
+ */
+static GstSrtpEncSession *
+gst_srtp_enc_get_session (GstSrtpEnc * filter, guint32 ssrc)
+{
+  GstSrtpEncSession *session;
+
+  session = g_hash_table_lookup (filter->sessions, GUINT_TO_POINTER (ssrc));
+  if (session == NULL) {
+    srtp_t srtp = NULL;
+    srtp_err_status_t status = gst_srtp_enc_create_session (filter, &srtp);
+
+    if (status != srtp_err_status_ok) {
+      GST_OBJECT_UNLOCK (filter);
+      GST_ELEMENT_ERROR (filter, LIBRARY, INIT,
+          ("Could not initialize SRTP encoder"),
+          ("Failed to create session for SSRC %u (err: %d)", ssrc, status));
+      GST_OBJECT_LOCK (filter);
+      return NULL;
+    }
+
+    session = gst_srtp_enc_session_new (srtp);
+    g_hash_table_insert (filter->sessions, GUINT_TO_POINTER (ssrc), session);
+    GST_DEBUG_OBJECT (filter, "Added ssrc %u", ssrc);
+  }
+
+  return gst_srtp_enc_session_ref (session);
+}
+
+/* Whether @buf can be protected without copying it into a new buffer,
+ * that is it has room for the SRTP trailer. The caller checks that nobody
+ * else can see @buf, a buffer of a shared list is not ours even if the
+ * buffer itself is writable. */
+static gboolean
+gst_srtp_enc_can_protect_in_place (GstBuffer * buf, gsize size_max)
+{
+  GstMemory *mem;
+  gsize offset, maxsize;
+
+  if (!gst_buffer_is_writable (buf) || gst_buffer_n_memory (buf) != 1)
+    return FALSE;
+
+  mem = gst_buffer_peek_memory (buf, 0);
+  if (!gst_memory_is_writable (mem))
+    return FALSE;
+
+  gst_memory_get_sizes (mem, &offset, &maxsize);
+
+  return maxsize - offset >= size_max;
+}
+
+/* Protects @buf into @outbuf_ptr, in place if @buf is @owned by the caller
+ * alone and has room for it */
 static GstFlowReturn
 gst_srtp_enc_process_buffer (GstSrtpEnc * filter, GstPad * pad,
-    GstBuffer * buf, gboolean is_rtcp, GstBuffer ** outbuf_ptr)
+    GstBuffer * buf, gboolean is_rtcp, gboolean owned, GstBuffer ** outbuf_ptr,
+    gboolean * soft_limit)
 {
   GstFlowReturn ret = GST_FLOW_OK;
   gint size_max, size;
   GstBuffer *bufout = NULL;
   GstMapInfo mapout;
+  GstSrtpEncSession *session;
+  gboolean in_place;
+  guint32 ssrc;
+  gboolean has_ssrc;
   srtp_err_status_t err;
+#ifdef HAVE_SRTP2
+  gboolean has_mki;
+#endif
 
-  /* Create a bigger buffer to add protection */
-  size = gst_buffer_get_size (buf);
-  size_max = size + SRTP_MAX_TRAILER_LEN + 10;
-  bufout = gst_buffer_new_allocate (NULL, size_max, NULL);
+  has_ssrc = gst_srtp_enc_get_ssrc (buf, is_rtcp, &ssrc);
 
-  gst_buffer_map (bufout, &mapout, GST_MAP_READWRITE);
+  GST_OBJECT_LOCK (filter);
 
-  gst_buffer_extract (buf, 0, mapout.data, size);
+  if (filter->first_session) {
+    /* The session disappeared (element shutting down) */
+    GST_OBJECT_UNLOCK (filter);
+    return GST_FLOW_FLUSHING;
+  }
 
-  GST_OBJECT_LOCK (filter);
+  if (has_ssrc)
+    session = gst_srtp_enc_get_session (filter, ssrc);
+  else
+    session = gst_srtp_enc_session_ref (filter->fallback_session);
+#ifdef HAVE_SRTP2
+  has_mki = (filter->mki != NULL);
+#endif
 
-  gst_srtp_init_event_reporter ();
+  GST_OBJECT_UNLOCK (filter);
 
-  if (filter->session == NULL) {
-    /* The rtcp session disappeared (element shutting down) */
-    GST_OBJECT_UNLOCK (filter);
-    ret = GST_FLOW_FLUSHING;
-    goto fail;
+  if (session == NULL)
+    return GST_FLOW_ERROR;
+
+  size = gst_buffer_get_size (buf);
+  size_max = size + SRTP_MAX_TRAILER_LEN + 10;
+
+  in_place = owned && gst_srtp_enc_can_protect_in_place (buf, size_max);
+  if (in_place) {
+    /* Grow into the tailroom to add protection */
+    bufout = buf;
+    gst_buffer_set_size (bufout, size_max);
+    gst_buffer_map (bufout, &mapout, GST_MAP_READWRITE);
+  } else {
+    /* Create a bigger buffer to add protection */
+    bufout = gst_buffer_new_allocate (NULL, size_max, NULL);
+    gst_buffer_map (bufout, &mapout, GST_MAP_READWRITE);
+    gst_buffer_extract (buf, 0, mapout.data, size);
   }
 
-  gst_srtp_enc_ensure_ssrc (filter, buf);
+  g_mutex_lock (&session->lock);
+
+  gst_srtp_init_event_reporter ();
 
 #ifdef HAVE_SRTP2
   if (is_rtcp)
-    err = srtp_protect_rtcp_mki (filter->session, mapout.data, &size,
-        (filter->mki != NULL), 0);
+    err = srtp_protect_rtcp_mki (session->session, mapout.data, &size,
+        has_mki, 0);
   else
-    err = srtp_protect_mki (filter->session, mapout.data, &size,
-        (filter->mki != NULL), 0);
+    err = srtp_protect_mki (session->session, mapout.data, &size, has_mki, 0);
 #else
   if (is_rtcp)
-    err = srtp_protect_rtcp (filter->session, mapout.data, &size);
+    err = srtp_protect_rtcp (session->session, mapout.data, &size);
   else
-    err = srtp_protect (filter->session, mapout.data, &size);
+    err = srtp_protect (session->session, mapout.data, &size);
 #endif
 
-  GST_OBJECT_UNLOCK (filter);
+  *soft_limit = gst_srtp_get_soft_limit_reached ();
+
+  g_mutex_unlock (&session->lock);
+  gst_srtp_enc_session_unref (session);
 
   gst_buffer_unmap (bufout, &mapout);
 
   if (err == srtp_err_status_ok) {
     /* Buffer protected */
     gst_buffer_set_size (bufout, size);
-    gst_buffer_copy_into (bufout, buf, GST_BUFFER_COPY_METADATA, 0, -1);
+    if (in_place)
+      gst_buffer_ref (bufout);
+    else
+      gst_buffer_copy_into (bufout, buf, GST_BUFFER_COPY_METADATA, 0, -1);
 
-    GST_LOG_OBJECT (pad, "Encoding %s buffer of size %d",
-        is_rtcp ? "RTCP" : "RTP", size);
+    GST_LOG_OBJECT (pad, "Encoding %s buffer of size %d%s",
+        is_rtcp ? "RTCP" : "RTP", size, in_place ? " in place" : "");
 
   } else if (err == srtp_err_status_key_expired) {
 
@@ -1197,10 +1385,23 @@ gst_srtp_enc_process_buffer (GstSrtpEnc * filter, GstPad * pad,
   return ret;
 
 fail:
-  gst_buffer_unref (bufout);
+  if (!in_place)
+    gst_buffer_unref (bufout);
   return ret;
 }
 
+/* Emits the soft-limit signal after a buffer hit the soft key limit */
+static void
+gst_srtp_enc_handle_soft_limit (GstSrtpEnc * filter)
+{
+  g_signal_emit (filter, gst_srtp_enc_signals[SIGNAL_SOFT_LIMIT], 0);
+
+  GST_OBJECT_LOCK (filter);
+  if (filter->random_key && !filter->key_changed)
+    gst_srtp_enc_replace_random_key (filter);
+  GST_OBJECT_UNLOCK (filter);
+}
+
 static GstFlowReturn
 gst_srtp_enc_chain (GstPad * pad, GstObject * parent, GstBuffer * buf,
     gboolean is_rtcp)
@@ -1209,6 +1410,7 @@ gst_srtp_enc_chain (GstPad * pad, GstObject * parent, GstBuffer * buf,
   GstFlowReturn ret = GST_FLOW_OK;
   GstPad *otherpad;
   GstBuffer *bufout = NULL;
+  gboolean soft_limit = FALSE;
 
   if ((ret = gst_srtp_enc_check_set_caps (filter, pad, is_rtcp)) != GST_FLOW_OK) {
     goto out;
@@ -1224,7 +1426,8 @@ gst_srtp_enc_chain (GstPad * pad, GstObject * parent, GstBuffer * buf,
 
   GST_OBJECT_UNLOCK (filter);
 
-  ret = gst_srtp_enc_process_buffer (filter, pad, buf, is_rtcp, &bufout);
+  ret = gst_srtp_enc_process_buffer (filter, pad, buf, is_rtcp, TRUE,
+      &bufout, &soft_limit);
   if (ret != GST_FLOW_OK)
     goto out;
 
@@ -1236,40 +1439,177 @@ gst_srtp_enc_chain (GstPad * pad, GstObject * parent, GstBuffer * buf,
   if (ret != GST_FLOW_OK)
     goto out;
 
-  GST_OBJECT_LOCK (filter);
-
-  if (gst_srtp_get_soft_limit_reached ()) {
-    GST_OBJECT_UNLOCK (filter);
-    g_signal_emit (filter, gst_srtp_enc_signals[SIGNAL_SOFT_LIMIT], 0);
-    GST_OBJECT_LOCK (filter);
-    if (filter->random_key && !filter->key_changed)
-      gst_srtp_enc_replace_random_key (filter);
-  }
-
-  GST_OBJECT_UNLOCK (filter);
+  if (soft_limit)
+    gst_srtp_enc_handle_soft_limit (filter);
 
 out:
   gst_buffer_unref (buf);
   return ret;
 }
 
-static gboolean
-process_buffer_it (GstBuffer ** buffer, guint index, gpointer user_data)
+static void
+gst_srtp_enc_run_job (GstSrtpEncJob * job)
 {
-  ProcessBufferItData *data = user_data;
-  GstBuffer *bufout;
-  GstFlowReturn ret;
+  guint i;
 
-  ret = gst_srtp_enc_process_buffer (data->filter, data->pad, *buffer,
-      data->is_rtcp, &bufout);
-  if (ret != GST_FLOW_OK) {
-    data->flowret = ret;
-    return FALSE;
+  for (i = 0; i < job->indices->len; i++) {
+    guint idx = g_array_index (job->indices, guint, i);
+    gboolean soft_limit = FALSE;
+
+    job->ret = gst_srtp_enc_process_buffer (job->filter, job->pad,
+        gst_buffer_list_get (job->list, idx), job->is_rtcp, job->in_place,
+        &job->outbufs[idx], &soft_limit);
+    job->soft_limit |= soft_limit;
+    if (job->ret != GST_FLOW_OK)
+      break;
+  }
+}
+
+static void
+gst_srtp_enc_job_func (gpointer data, gpointer user_data)
+{
+  GstSrtpEncJob *job = data;
+  GstSrtpEncBatch *batch = job->batch;
+
+  gst_srtp_enc_run_job (job);
+
+  /* @job and @batch may be freed as soon as the lock is released */
+  g_mutex_lock (&batch->lock);
+  if (--batch->pending == 0)
+    g_cond_signal (&batch->cond);
+  g_mutex_unlock (&batch->lock);
+}
+
+static GstSrtpEncJob *
+gst_srtp_enc_job_new (GstSrtpEnc * filter, GstSrtpEncBatch * batch,
+    GstPad * pad, GstBufferList * list, gboolean is_rtcp, GstBuffer ** outbufs)
+{
+  GstSrtpEncJob *job = g_slice_new0 (GstSrtpEncJob);
+
+  job->filter = filter;
+  job->batch = batch;
+  job->pad = pad;
+  job->list = list;
+  job->is_rtcp = is_rtcp;
+  /* the buffers of a list someone else holds are shared with them */
+  job->in_place = gst_buffer_list_is_writable (list);
+  job->indices = g_array_new (FALSE, FALSE, sizeof (guint));
+  job->outbufs = outbufs;
+  job->ret = GST_FLOW_OK;
+
+  return job;
+}
+
+static void
+gst_srtp_enc_job_free (GstSrtpEncJob * job)
+{
+  g_array_free (job->indices, TRUE);
+  g_slice_free (GstSrtpEncJob, job);
+}
+
+/* Protects all buffers of @list into @outbufs. With more than one thread
+ * the buffers are grouped by SSRC and the groups are protected in
+ * parallel, buffers of the same SSRC are always protected in order. */
+static GstFlowReturn
+gst_srtp_enc_process_list (GstSrtpEnc * filter, GstPad * pad,
+    GstBufferList * list, gboolean is_rtcp, GstBuffer ** outbufs,
+    gboolean * soft_limit)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstSrtpEncBatch batch;
+  GPtrArray *jobs;
+  guint i, len, n_threads;
+
+  len = gst_buffer_list_length (list);
+
+  GST_OBJECT_LOCK (filter);
+  n_threads = filter->n_threads;
+  GST_OBJECT_UNLOCK (filter);
+
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  jobs = g_ptr_array_new_with_free_func ((GDestroyNotify) gst_srtp_enc_job_free);
+
+  if (n_threads == 1 || len < 2) {
+    GstSrtpEncJob *job = gst_srtp_enc_job_new (filter, &batch, pad, list,
+        is_rtcp, outbufs);
+
+    for (i = 0; i < len; i++)
+      g_array_append_val (job->indices, i);
+    g_ptr_array_add (jobs, job);
+  } else {
+    GHashTable *by_ssrc = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    for (i = 0; i < len; i++) {
+      GstSrtpEncJob *job;
+      guint32 ssrc;
+
+      /* packets without an SSRC go with SSRC 0, they only need to be in
+       * the same job as each other */
+      gst_srtp_enc_get_ssrc (gst_buffer_list_get (list, i), is_rtcp, &ssrc);
+
+      job = g_hash_table_lookup (by_ssrc, GUINT_TO_POINTER (ssrc));
+      if (job == NULL) {
+        job = gst_srtp_enc_job_new (filter, &batch, pad, list, is_rtcp,
+            outbufs);
+        g_hash_table_insert (by_ssrc, GUINT_TO_POINTER (ssrc), job);
+        g_ptr_array_add (jobs, job);
+      }
+      g_array_append_val (job->indices, i);
+    }
+    g_hash_table_unref (by_ssrc);
+  }
+
+  if (jobs->len > 1) {
+    GST_OBJECT_LOCK (filter);
+    if (filter->pool == NULL) {
+      filter->pool = g_thread_pool_new (gst_srtp_enc_job_func, filter,
+          n_threads - 1, FALSE, NULL);
+    } else if (g_thread_pool_get_max_threads (filter->pool) !=
+        (gint) n_threads - 1) {
+      g_thread_pool_set_max_threads (filter->pool, n_threads - 1, NULL);
+    }
+    GST_OBJECT_UNLOCK (filter);
   }
 
-  gst_buffer_list_add (data->out_list, bufout);
+  if (jobs->len > 1 && filter->pool) {
+    GST_LOG_OBJECT (pad, "Protecting %u SSRCs on %u threads", jobs->len,
+        n_threads);
 
-  return TRUE;
+    g_mutex_init (&batch.lock);
+    g_cond_init (&batch.cond);
+    batch.pending = jobs->len - 1;
+
+    for (i = 1; i < jobs->len; i++)
+      g_thread_pool_push (filter->pool, g_ptr_array_index (jobs, i), NULL);
+
+    /* the streaming thread takes the first SSRC itself */
+    gst_srtp_enc_run_job (g_ptr_array_index (jobs, 0));
+
+    g_mutex_lock (&batch.lock);
+    while (batch.pending > 0)
+      g_cond_wait (&batch.cond, &batch.lock);
+    g_mutex_unlock (&batch.lock);
+
+    g_cond_clear (&batch.cond);
+    g_mutex_clear (&batch.lock);
+  } else {
+    for (i = 0; i < jobs->len; i++)
+      gst_srtp_enc_run_job (g_ptr_array_index (jobs, i));
+  }
+
+  for (i = 0; i < jobs->len; i++) {
+    GstSrtpEncJob *job = g_ptr_array_index (jobs, i);
+
+    if (ret == GST_FLOW_OK)
+      ret = job->ret;
+    *soft_limit |= job->soft_limit;
+  }
+
+  g_ptr_array_unref (jobs);
+
+  return ret;
 }
 
 static GstFlowReturn
@@ -1280,12 +1620,15 @@ gst_srtp_enc_chain_list (GstPad * pad, GstObject * parent,
   GstFlowReturn ret = GST_FLOW_OK;
   GstPad *otherpad;
   GstBufferList *out_list = NULL;
-  ProcessBufferItData process_data;
+  GstBuffer **outbufs;
+  gboolean soft_limit = FALSE;
+  guint i, len;
 
-  GST_LOG_OBJECT (pad, "Buffer chain with list of %d",
-      gst_buffer_list_length (buf_list));
+  len = gst_buffer_list_length (buf_list);
 
-  if (!gst_buffer_list_length (buf_list))
+  GST_LOG_OBJECT (pad, "Buffer chain with list of %d", len);
+
+  if (!len)
     goto out;
 
   if ((ret = gst_srtp_enc_check_set_caps (filter, pad, is_rtcp)) != GST_FLOW_OK)
@@ -1301,46 +1644,34 @@ gst_srtp_enc_chain_list (GstPad * pad, GstObject * parent,
 
   GST_OBJECT_UNLOCK (filter);
 
-  out_list = gst_buffer_list_new ();
+  outbufs = g_new0 (GstBuffer *, len);
 
-  process_data.filter = filter;
-  process_data.pad = pad;
-  process_data.is_rtcp = is_rtcp;
-  process_data.out_list = out_list;
-  process_data.flowret = GST_FLOW_OK;
+  ret = gst_srtp_enc_process_list (filter, pad, buf_list, is_rtcp, outbufs,
+      &soft_limit);
 
-  if (!gst_buffer_list_foreach (buf_list, process_buffer_it, &process_data)) {
-    ret = process_data.flowret;
+  if (ret != GST_FLOW_OK) {
+    for (i = 0; i < len; i++)
+      gst_clear_buffer (&outbufs[i]);
+    g_free (outbufs);
     goto out;
   }
 
-  if (!gst_buffer_list_length (out_list)) {
-    gst_buffer_list_unref (out_list);
-    ret = GST_FLOW_OK;
-    goto out;
-  }
+  out_list = gst_buffer_list_new_sized (len);
+  for (i = 0; i < len; i++)
+    gst_buffer_list_add (out_list, outbufs[i]);
+  g_free (outbufs);
 
   /* Push buffer to source pad */
   otherpad = get_rtp_other_pad (pad);
-  GST_LOG_OBJECT (pad, "Pushing buffer chain of %d",
-      gst_buffer_list_length (buf_list));
+  GST_LOG_OBJECT (pad, "Pushing buffer chain of %d", len);
   ret = gst_pad_push_list (otherpad, out_list);
 
   if (ret != GST_FLOW_OK) {
     goto out;
   }
 
-  GST_OBJECT_LOCK (filter);
-
-  if (gst_srtp_get_soft_limit_reached ()) {
-    GST_OBJECT_UNLOCK (filter);
-    g_signal_emit (filter, gst_srtp_enc_signals[SIGNAL_SOFT_LIMIT], 0);
-    GST_OBJECT_LOCK (filter);
-    if (filter->random_key && !filter->key_changed)
-      gst_srtp_enc_replace_random_key (filter);
-  }
-
-  GST_OBJECT_UNLOCK (filter);
+  if (soft_limit)
+    gst_srtp_enc_handle_soft_limit (filter);
 
 out:
 
@@ -78,14 +78,20 @@ struct _GstSrtpEnc
   guint rtcp_auth;
   GstBuffer *mki;
 
-  srtp_t session;
+  /* one libsrtp session per SSRC so that independent streams don't
+   * serialize on a single context, see GstSrtpEncSession */
+  GHashTable *sessions;
+  /* used for the packets we can't find an SSRC in, kept out of @sessions
+   * as 0 is a valid SSRC */
+  struct _GstSrtpEncSession *fallback_session;
   gboolean first_session;
   gboolean key_changed;
 
   guint replay_window_size;
   gboolean allow_repeat_tx;
 
-  GHashTable *ssrcs_set;
+  guint n_threads;
+  GThreadPool *pool;
 };
 
 struct _GstSrtpEncClass
@@ -337,6 +337,7 @@ enum
   ON_ICE_CANDIDATE_SIGNAL,
   ON_NEW_TRANSCEIVER_SIGNAL,
   GET_STATS_SIGNAL,
+  GET_STATS_BY_TYPE_SIGNAL,
   ADD_TRANSCEIVER_SIGNAL,
   GET_TRANSCEIVER_SIGNAL,
   GET_TRANSCEIVERS_SIGNAL,
@@ -364,8 +365,13 @@ enum
   PROP_BUNDLE_POLICY,
   PROP_ICE_TRANSPORT_POLICY,
   PROP_ICE_AGENT,
+  PROP_STATS_MAX_AGE,
+  PROP_TRANSPORT_SEND_THREAD,
+  PROP_TRANSPORT_RECEIVE_QUEUE_SIZE,
 };
 
+#define DEFAULT_TRANSPORT_RECEIVE_QUEUE_SIZE DEFAULT_TRANSPORT_QUEUE_SIZE
+
 static guint gst_webrtc_bin_signals[LAST_SIGNAL] = { 0 };
 
 typedef struct
@@ -4882,17 +4888,19 @@ _on_local_ice_candidate_cb (GstWebRTCICE * ice, guint session_id,
 
 /* https://www.w3.org/TR/webrtc/#dfn-stats-selection-algorithm */
 static GstStructure *
-_get_stats_from_selector (GstWebRTCBin * webrtc, gpointer selector)
+_get_stats_from_selector (GstWebRTCBin * webrtc, gpointer selector,
+    GstWebRTCStatsType type)
 {
   if (selector)
     GST_FIXME_OBJECT (webrtc, "Implement stats selection");
 
-  return gst_structure_copy (webrtc->priv->stats);
+  return gst_webrtc_bin_get_stats_snapshot (webrtc, type, -1);
 }
 
 struct get_stats
 {
   GstPad *pad;
+  GstWebRTCStatsType type;
   GstPromise *promise;
 };
 
@@ -4913,7 +4921,7 @@ _get_stats_task (GstWebRTCBin * webrtc, struct get_stats *stats)
   GstStructure *s;
   gpointer selector = NULL;
 
-  gst_webrtc_bin_update_stats (webrtc);
+  gst_webrtc_bin_update_stats (webrtc, stats->type);
 
   if (stats->pad) {
     GstWebRTCBinPad *wpad = GST_WEBRTC_BIN_PAD (stats->pad);
@@ -4927,21 +4935,35 @@ _get_stats_task (GstWebRTCBin * webrtc, struct get_stats *stats)
     }
   }
 
-  s = _get_stats_from_selector (webrtc, selector);
+  s = _get_stats_from_selector (webrtc, selector, stats->type);
   gst_promise_reply (stats->promise, s);
 }
 
 static void
-gst_webrtc_bin_get_stats (GstWebRTCBin * webrtc, GstPad * pad,
+_get_stats (GstWebRTCBin * webrtc, GstPad * pad, GstWebRTCStatsType type,
     GstPromise * promise)
 {
   struct get_stats *stats;
-
-  g_return_if_fail (promise != NULL);
-  g_return_if_fail (pad == NULL || GST_IS_WEBRTC_BIN_PAD (pad));
+  GstStructure *snapshot;
+  gint64 max_age;
+
+  /* Answer from the last snapshot if it is recent enough. This neither
+   * waits for the PC thread nor takes the PC lock */
+  g_mutex_lock (&webrtc->priv->stats_lock);
+  max_age = webrtc->priv->stats_max_age * G_GINT64_CONSTANT (1000);
+  g_mutex_unlock (&webrtc->priv->stats_lock);
+
+  if (max_age > 0
+      && (snapshot =
+          gst_webrtc_bin_get_stats_snapshot (webrtc, type, max_age))) {
+    GST_LOG_OBJECT (webrtc, "replying with cached stats");
+    gst_promise_reply (promise, snapshot);
+    return;
+  }
 
   stats = g_new0 (struct get_stats, 1);
   stats->promise = gst_promise_ref (promise);
+  stats->type = type;
   /* FIXME: check that pad exists in element */
   if (pad)
     stats->pad = gst_object_ref (pad);
@@ -4960,6 +4982,27 @@ gst_webrtc_bin_get_stats (GstWebRTCBin * webrtc, GstPad * pad,
   }
 }
 
+static void
+gst_webrtc_bin_get_stats (GstWebRTCBin * webrtc, GstPad * pad,
+    GstPromise * promise)
+{
+  g_return_if_fail (promise != NULL);
+  g_return_if_fail (pad == NULL || GST_IS_WEBRTC_BIN_PAD (pad));
+
+  _get_stats (webrtc, pad, GST_WEBRTC_STATS_ALL, promise);
+}
+
+static void
+gst_webrtc_bin_get_stats_by_type (GstWebRTCBin * webrtc,
+    GstWebRTCStatsType type, GstPromise * promise)
+{
+  g_return_if_fail (promise != NULL);
+  g_return_if_fail (type >= GST_WEBRTC_STATS_CODEC
+      && type <= GST_WEBRTC_STATS_CERTIFICATE);
+
+  _get_stats (webrtc, NULL, type, promise);
+}
+
 static GstWebRTCRTPTransceiver *
 gst_webrtc_bin_add_transceiver (GstWebRTCBin * webrtc,
     GstWebRTCRTPTransceiverDirection direction, GstCaps * caps)
@@ -5863,6 +5906,21 @@ gst_webrtc_bin_set_property (GObject * object, guint prop_id,
           webrtc->ice_transport_policy ==
           GST_WEBRTC_ICE_TRANSPORT_POLICY_RELAY ? TRUE : FALSE, NULL);
       break;
+    case PROP_STATS_MAX_AGE:
+      g_mutex_lock (&webrtc->priv->stats_lock);
+      webrtc->priv->stats_max_age = g_value_get_uint (value);
+      g_mutex_unlock (&webrtc->priv->stats_lock);
+      break;
+    case PROP_TRANSPORT_SEND_THREAD:
+      PC_LOCK (webrtc);
+      webrtc->priv->transport_send_thread = g_value_get_boolean (value);
+      PC_UNLOCK (webrtc);
+      break;
+    case PROP_TRANSPORT_RECEIVE_QUEUE_SIZE:
+      PC_LOCK (webrtc);
+      webrtc->priv->transport_receive_queue_size = g_value_get_uint (value);
+      PC_UNLOCK (webrtc);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -5930,6 +5988,17 @@ gst_webrtc_bin_get_property (GObject * object, guint prop_id,
     case PROP_ICE_AGENT:
       g_value_set_object (value, webrtc->priv->ice);
       break;
+    case PROP_STATS_MAX_AGE:
+      g_mutex_lock (&webrtc->priv->stats_lock);
+      g_value_set_uint (value, webrtc->priv->stats_max_age);
+      g_mutex_unlock (&webrtc->priv->stats_lock);
+      break;
+    case PROP_TRANSPORT_SEND_THREAD:
+      g_value_set_boolean (value, webrtc->priv->transport_send_thread);
+      break;
+    case PROP_TRANSPORT_RECEIVE_QUEUE_SIZE:
+      g_value_set_uint (value, webrtc->priv->transport_receive_queue_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -6039,10 +6108,14 @@ gst_webrtc_bin_finalize (GObject * object)
     gst_webrtc_session_description_free (webrtc->priv->last_generated_offer);
   webrtc->priv->last_generated_offer = NULL;
 
+  if (webrtc->priv->stats_cache)
+    gst_structure_free (webrtc->priv->stats_cache);
+  webrtc->priv->stats_cache = NULL;
   if (webrtc->priv->stats)
     gst_structure_free (webrtc->priv->stats);
   webrtc->priv->stats = NULL;
 
+  g_mutex_clear (&webrtc->priv->stats_lock);
   g_mutex_clear (ICE_GET_LOCK (webrtc));
   g_mutex_clear (PC_GET_LOCK (webrtc));
   g_cond_clear (PC_GET_COND (webrtc));
@@ -6198,6 +6271,62 @@ gst_webrtc_bin_class_init (GstWebRTCBinClass * klass)
           "The WebRTC ICE agent",
           GST_TYPE_WEBRTC_ICE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstWebRTCBin:stats-max-age:
+   *
+   * Maximum age in milliseconds of the statistics returned by
+   * #GstWebRTCBin::get-stats and #GstWebRTCBin::get-stats-by-type. Requests
+   * are answered directly from the last snapshot while it is younger than
+   * this, without waiting for the webrtcbin thread. 0 always refreshes the
+   * statistics.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_STATS_MAX_AGE,
+      g_param_spec_uint ("stats-max-age", "Stats max age",
+          "Maximum age in milliseconds of returned statistics (0 = always "
+          "refresh)", 0, G_MAXUINT, 0,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstWebRTCBin:transport-send-thread:
+   *
+   * Whether each transport encrypts and sends its RTP and RTCP from its own
+   * streaming thread instead of the thread pushing into webrtcbin. Received
+   * data is always decrypted from a thread per transport. Together with
+   * #GstWebRTCBin:bundle-policy this controls how many threads the
+   * DTLS/SRTP processing of a connection can be spread over.
+   *
+   * Only affects the transports created after it has been set.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_TRANSPORT_SEND_THREAD,
+      g_param_spec_boolean ("transport-send-thread", "Transport send thread",
+          "Whether to encrypt and send from a dedicated thread per transport",
+          FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstWebRTCBin:transport-receive-queue-size:
+   *
+   * Maximum number of bytes queued per transport component between ICE
+   * receive and DTLS/SRTP decryption. Older data is dropped once the queue
+   * is full.
+   *
+   * Only affects the transports created after it has been set.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_TRANSPORT_RECEIVE_QUEUE_SIZE,
+      g_param_spec_uint ("transport-receive-queue-size",
+          "Transport receive queue size",
+          "Maximum number of bytes queued before decryption per transport "
+          "component", 0, G_MAXUINT, DEFAULT_TRANSPORT_RECEIVE_QUEUE_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstWebRTCBin::create-offer:
    * @object: the #webrtcbin
@@ -6334,6 +6463,25 @@ gst_webrtc_bin_class_init (GstWebRTCBinClass * klass)
       G_CALLBACK (gst_webrtc_bin_get_stats), NULL, NULL, NULL,
       G_TYPE_NONE, 2, GST_TYPE_PAD, GST_TYPE_PROMISE);
 
+  /**
+   * GstWebRTCBin::get-stats-by-type:
+   * @object: the #webrtcbin
+   * @type: the #GstWebRTCStatsType to retrieve
+   * @promise: a #GstPromise for the result
+   *
+   * Like #GstWebRTCBin::get-stats but the result only contains the
+   * statistics of @type. Only what is needed for @type is refreshed, e.g.
+   * the RTP sessions are not queried for "candidate-pair" or "transport"
+   * statistics.
+   *
+   * Since: 1.18
+   */
+  gst_webrtc_bin_signals[GET_STATS_BY_TYPE_SIGNAL] =
+      g_signal_new_class_handler ("get-stats-by-type",
+      G_TYPE_FROM_CLASS (klass), G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+      G_CALLBACK (gst_webrtc_bin_get_stats_by_type), NULL, NULL, NULL,
+      G_TYPE_NONE, 2, GST_TYPE_WEBRTC_STATS_TYPE, GST_TYPE_PROMISE);
+
   /**
    * GstWebRTCBin::on-negotiation-needed:
    * @object: the #webrtcbin
@@ -6496,6 +6644,7 @@ gst_webrtc_bin_init (GstWebRTCBin * webrtc)
   g_cond_init (PC_GET_COND (webrtc));
 
   g_mutex_init (ICE_GET_LOCK (webrtc));
+  g_mutex_init (&webrtc->priv->stats_lock);
 
   webrtc->rtpbin = _create_rtpbin (webrtc);
   gst_bin_add (GST_BIN (webrtc), webrtc->rtpbin);
@@ -6528,6 +6677,9 @@ gst_webrtc_bin_init (GstWebRTCBin * webrtc)
   g_array_set_clear_func (webrtc->priv->pending_local_ice_candidates,
       (GDestroyNotify) _clear_ice_candidate_item);
 
+  webrtc->priv->transport_receive_queue_size =
+      DEFAULT_TRANSPORT_RECEIVE_QUEUE_SIZE;
+
   /* we start off closed until we move to READY */
   webrtc->priv->is_closed = TRUE;
 }
@@ -138,7 +138,19 @@ struct _GstWebRTCBinPrivate
   GstWebRTCSessionDescription *last_generated_offer;
   GstWebRTCSessionDescription *last_generated_answer;
 
+  /* stats entries kept across updates, only used from the PC thread */
+  GstStructure *stats_cache;
+
+  /* latest published copy of stats_cache, never modified once published.
+   * Protected by stats_lock along with the other stats_ fields */
+  GMutex stats_lock;
   GstStructure *stats;
+  gint64 stats_update_time[GST_WEBRTC_STATS_CERTIFICATE + 1];
+  guint stats_max_age;
+
+  /* applied to the transports created afterwards, protected by PC_LOCK */
+  gboolean transport_send_thread;
+  guint transport_receive_queue_size;
 };
 
 typedef void (*GstWebRTCBinFunc) (GstWebRTCBin * webrtc, gpointer data);
@@ -314,7 +314,7 @@ _get_stats_from_ice_transport (GstWebRTCBin * webrtc,
 
   id = g_strdup_printf ("ice-candidate-pair_%s", GST_OBJECT_NAME (transport));
   stats = gst_structure_new_empty (id);
-  _set_base_stats (stats, GST_WEBRTC_STATS_TRANSPORT, ts, id);
+  _set_base_stats (stats, GST_WEBRTC_STATS_CANDIDATE_PAIR, ts, id);
 
 /* XXX: RTCIceCandidatePairStats
     DOMString                     transportId;
@@ -428,7 +428,7 @@ _get_stats_from_dtls_transport (GstWebRTCBin * webrtc,
 static void
 _get_stats_from_transport_channel (GstWebRTCBin * webrtc,
     TransportStream * stream, const gchar * codec_id, guint ssrc,
-    GstStructure * s)
+    gboolean with_rtp, GstStructure * s)
 {
   GstWebRTCDTLSTransport *transport;
   GObject *rtp_session;
@@ -446,6 +446,14 @@ _get_stats_from_transport_channel (GstWebRTCBin * webrtc,
   if (!transport)
     return;
 
+  if (!with_rtp) {
+    /* retrieving the RTP session statistics is by far the most expensive
+     * part, skip it when only the transport side was asked for */
+    transport_id = _get_stats_from_dtls_transport (webrtc, transport, s);
+    g_free (transport_id);
+    return;
+  }
+
   g_signal_emit_by_name (webrtc->rtpbin, "get-internal-session",
       stream->session_id, &rtp_session);
   g_object_get (rtp_session, "stats", &rtp_stats, NULL);
@@ -531,60 +539,179 @@ _get_codec_stats_from_pad (GstWebRTCBin * webrtc, GstPad * pad,
     *out_ssrc = ssrc;
 }
 
+struct update_stats
+{
+  GstStructure *s;
+  gboolean with_transport;
+  gboolean with_rtp;
+};
+
 static gboolean
-_get_stats_from_pad (GstWebRTCBin * webrtc, GstPad * pad, GstStructure * s)
+_get_stats_from_pad (GstWebRTCBin * webrtc, GstPad * pad,
+    struct update_stats *data)
 {
   GstWebRTCBinPad *wpad = GST_WEBRTC_BIN_PAD (pad);
   TransportStream *stream;
   gchar *codec_id;
   guint ssrc;
 
-  _get_codec_stats_from_pad (webrtc, pad, s, &codec_id, &ssrc);
+  _get_codec_stats_from_pad (webrtc, pad, data->s, &codec_id, &ssrc);
 
-  if (!wpad->trans)
+  if (!data->with_transport || !wpad->trans)
     goto out;
 
   stream = WEBRTC_TRANSCEIVER (wpad->trans)->stream;
   if (!stream)
     goto out;
 
-  _get_stats_from_transport_channel (webrtc, stream, codec_id, ssrc, s);
+  _get_stats_from_transport_channel (webrtc, stream, codec_id, ssrc,
+      data->with_rtp, data->s);
 
 out:
   g_free (codec_id);
   return TRUE;
 }
 
+static gboolean
+_is_rtp_stats_type (GstWebRTCStatsType type)
+{
+  return type == GST_WEBRTC_STATS_ALL || type == GST_WEBRTC_STATS_INBOUND_RTP
+      || type == GST_WEBRTC_STATS_OUTBOUND_RTP
+      || type == GST_WEBRTC_STATS_REMOTE_INBOUND_RTP
+      || type == GST_WEBRTC_STATS_REMOTE_OUTBOUND_RTP;
+}
+
+/* the types produced by an update that did not query the RTP sessions */
+static const GstWebRTCStatsType transport_stats_types[] = {
+  GST_WEBRTC_STATS_CODEC,
+  GST_WEBRTC_STATS_PEER_CONNECTION,
+  GST_WEBRTC_STATS_TRANSPORT,
+  GST_WEBRTC_STATS_CANDIDATE_PAIR,
+};
+
+/* Refreshes the entries needed for @type in the stats cache and publishes a
+ * copy of it as the new snapshot. Entries of objects that went away, as well
+ * as those of other types, keep their last values. Must be called from the
+ * PC thread. */
 void
-gst_webrtc_bin_update_stats (GstWebRTCBin * webrtc)
+gst_webrtc_bin_update_stats (GstWebRTCBin * webrtc, GstWebRTCStatsType type)
 {
-  GstStructure *s = gst_structure_new_empty ("application/x-webrtc-stats");
+  GstWebRTCBinPrivate *priv = webrtc->priv;
   double ts = monotonic_time_as_double_milliseconds ();
-  GstStructure *pc_stats;
+  struct update_stats data;
+  GstStructure *pc_stats, *snapshot, *old;
+  gint64 now;
+  guint i;
 
   _init_debug ();
 
-  gst_structure_set (s, "timestamp", G_TYPE_DOUBLE, ts, NULL);
+  if (!priv->stats_cache)
+    priv->stats_cache = gst_structure_new_empty ("application/x-webrtc-stats");
+
+  data.s = priv->stats_cache;
+  data.with_rtp = _is_rtp_stats_type (type);
+  data.with_transport = data.with_rtp || type == GST_WEBRTC_STATS_TRANSPORT
+      || type == GST_WEBRTC_STATS_CANDIDATE_PAIR;
+
+  gst_structure_set (data.s, "timestamp", G_TYPE_DOUBLE, ts, NULL);
 
   /* FIXME: better unique IDs */
-  /* FIXME: rate limitting stat updates? */
-  /* FIXME: all stats need to be kept forever */
 
-  GST_DEBUG_OBJECT (webrtc, "updating stats at time %f", ts);
+  GST_DEBUG_OBJECT (webrtc, "updating stats of type %u at time %f", type, ts);
 
   if ((pc_stats = _get_peer_connection_stats (webrtc))) {
     const gchar *id = "peer-connection-stats";
     _set_base_stats (pc_stats, GST_WEBRTC_STATS_PEER_CONNECTION, ts, id);
-    gst_structure_set (s, id, GST_TYPE_STRUCTURE, pc_stats, NULL);
+    gst_structure_set (data.s, id, GST_TYPE_STRUCTURE, pc_stats, NULL);
     gst_structure_free (pc_stats);
   }
 
-  gst_element_foreach_pad (GST_ELEMENT (webrtc),
-      (GstElementForeachPadFunc) _get_stats_from_pad, s);
+  if (type != GST_WEBRTC_STATS_PEER_CONNECTION) {
+    gst_element_foreach_pad (GST_ELEMENT (webrtc),
+        (GstElementForeachPadFunc) _get_stats_from_pad, &data);
+  }
+
+  gst_structure_remove_field (data.s, "timestamp");
+
+  snapshot = gst_structure_copy (data.s);
+  now = g_get_monotonic_time ();
+
+  g_mutex_lock (&priv->stats_lock);
+  old = priv->stats;
+  priv->stats = snapshot;
+  if (data.with_rtp) {
+    for (i = 0; i < G_N_ELEMENTS (priv->stats_update_time); i++)
+      priv->stats_update_time[i] = now;
+  } else if (data.with_transport) {
+    for (i = 0; i < G_N_ELEMENTS (transport_stats_types); i++)
+      priv->stats_update_time[transport_stats_types[i]] = now;
+  } else {
+    priv->stats_update_time[GST_WEBRTC_STATS_PEER_CONNECTION] = now;
+    if (type != GST_WEBRTC_STATS_PEER_CONNECTION)
+      priv->stats_update_time[GST_WEBRTC_STATS_CODEC] = now;
+  }
+  g_mutex_unlock (&priv->stats_lock);
+
+  if (old)
+    gst_structure_free (old);
+}
+
+struct filter_stats
+{
+  GstStructure *s;
+  GstWebRTCStatsType type;
+};
+
+static gboolean
+_filter_stats_foreach (GQuark field_id, const GValue * value,
+    struct filter_stats *data)
+{
+  GstWebRTCStatsType type;
+
+  if (G_VALUE_TYPE (value) == GST_TYPE_STRUCTURE
+      && gst_structure_get (gst_value_get_structure (value), "type",
+          GST_TYPE_WEBRTC_STATS_TYPE, &type, NULL)
+      && type == data->type)
+    gst_structure_id_set_value (data->s, field_id, value);
+
+  return TRUE;
+}
+
+/* Returns a copy of the last published snapshot restricted to @type, or
+ * %NULL if there is none that was updated for @type within the last
+ * @max_age microseconds (-1 for any age). Only takes the stats lock so this
+ * can be called from any thread. */
+GstStructure *
+gst_webrtc_bin_get_stats_snapshot (GstWebRTCBin * webrtc,
+    GstWebRTCStatsType type, gint64 max_age)
+{
+  GstWebRTCBinPrivate *priv = webrtc->priv;
+  GstStructure *ret = NULL;
+
+  g_return_val_if_fail (type < G_N_ELEMENTS (priv->stats_update_time), NULL);
+
+  g_mutex_lock (&priv->stats_lock);
+  if (!priv->stats)
+    goto done;
+
+  if (max_age >= 0
+      && g_get_monotonic_time () - priv->stats_update_time[type] > max_age)
+    goto done;
+
+  if (type == GST_WEBRTC_STATS_ALL) {
+    ret = gst_structure_copy (priv->stats);
+  } else {
+    struct filter_stats data;
+
+    data.s = gst_structure_new_empty (gst_structure_get_name (priv->stats));
+    data.type = type;
+    gst_structure_foreach (priv->stats,
+        (GstStructureForeachFunc) _filter_stats_foreach, &data);
+    ret = data.s;
+  }
 
-  gst_structure_remove_field (s, "timestamp");
+done:
+  g_mutex_unlock (&priv->stats_lock);
 
-  if (webrtc->priv->stats)
-    gst_structure_free (webrtc->priv->stats);
-  webrtc->priv->stats = s;
+  return ret;
 }
@@ -27,8 +27,16 @@
 
 G_BEGIN_DECLS
 
+/* Passed instead of a #GstWebRTCStatsType to update or retrieve everything */
+#define GST_WEBRTC_STATS_ALL 0
+
+G_GNUC_INTERNAL
+void            gst_webrtc_bin_update_stats         (GstWebRTCBin * webrtc,
+                                                     GstWebRTCStatsType type);
 G_GNUC_INTERNAL
-void        gst_webrtc_bin_update_stats         (GstWebRTCBin * webrtc);
+GstStructure *  gst_webrtc_bin_get_stats_snapshot   (GstWebRTCBin * webrtc,
+                                                     GstWebRTCStatsType type,
+                                                     gint64 max_age);
 
 G_END_DECLS
 
@@ -81,8 +81,11 @@ enum
 {
   PROP_0,
   PROP_STREAM,
+  PROP_QUEUE_SIZE,
 };
 
+#define DEFAULT_QUEUE_SIZE DEFAULT_TRANSPORT_QUEUE_SIZE
+
 static const gchar *
 _receive_state_to_string (ReceiveState state)
 {
@@ -189,6 +192,9 @@ transport_receive_bin_set_property (GObject * object, guint prop_id,
       /* XXX: weak-ref this? */
       receive->stream = TRANSPORT_STREAM (g_value_get_object (value));
       break;
+    case PROP_QUEUE_SIZE:
+      receive->queue_size = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -207,6 +213,9 @@ transport_receive_bin_get_property (GObject * object, guint prop_id,
     case PROP_STREAM:
       g_value_set_object (value, receive->stream);
       break;
+    case PROP_QUEUE_SIZE:
+      g_value_set_uint (value, receive->queue_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -317,10 +326,10 @@ transport_receive_bin_constructed (GObject * object)
   g_object_set (capsfilter, "caps", caps, NULL);
   gst_caps_unref (caps);
 
+  /* decrypt from the queue's thread, in parallel with the other transports */
   queue = gst_element_factory_make ("queue", NULL);
-  /* FIXME: make this configurable? */
   g_object_set (queue, "leaky", 2, "max-size-time", (guint64) 0,
-      "max-size-buffers", 0, "max-size-bytes", 5 * 1024 * 1024, NULL);
+      "max-size-buffers", 0, "max-size-bytes", receive->queue_size, NULL);
   g_signal_connect (queue, "overrun", G_CALLBACK (rtp_queue_overrun), receive);
 
   gst_bin_add (GST_BIN (receive), GST_ELEMENT (queue));
@@ -345,10 +354,10 @@ transport_receive_bin_constructed (GObject * object)
   g_object_set (capsfilter, "caps", caps, NULL);
   gst_caps_unref (caps);
 
+  /* decrypt from the queue's thread, in parallel with the other transports */
   queue = gst_element_factory_make ("queue", NULL);
-  /* FIXME: make this configurable? */
   g_object_set (queue, "leaky", 2, "max-size-time", (guint64) 0,
-      "max-size-buffers", 0, "max-size-bytes", 5 * 1024 * 1024, NULL);
+      "max-size-buffers", 0, "max-size-bytes", receive->queue_size, NULL);
   g_signal_connect (queue, "overrun", G_CALLBACK (rtp_queue_overrun), receive);
 
   gst_bin_add (GST_BIN (receive), queue);
@@ -442,6 +451,13 @@ transport_receive_bin_class_init (TransportReceiveBinClass * klass)
           "The TransportStream for this receiving bin",
           transport_stream_get_type (),
           G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class,
+      PROP_QUEUE_SIZE,
+      g_param_spec_uint ("queue-size", "Queue Size",
+          "Maximum number of bytes queued before decryption per component",
+          0, G_MAXUINT, DEFAULT_QUEUE_SIZE,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -43,6 +43,7 @@ struct _TransportReceiveBin
   GstBin                     parent;
 
   TransportStream           *stream;        /* parent transport stream */
+  guint                      queue_size;    /* bytes in each receive queue */
 
   GstPad                    *rtp_src;
   gulong                     rtp_src_probe_id;
@@ -40,6 +40,11 @@
  *
  * outputselecter is used to switch between rtcp-mux and no rtcp-mux
  *
+ * With threaded=TRUE a queue is placed after the rtp_sink and rtcp_sink
+ * ghost pads so that encryption and sending run in a thread of our own.
+ * Data is then blocked in front of the queues until the DTLS keys are set
+ * so that they do not fill up with data that cannot be sent yet.
+ *
  * FIXME: Do we need a valve drop=TRUE for the no RTCP case?
  */
 
@@ -74,6 +79,7 @@ enum
   PROP_0,
   PROP_STREAM,
   PROP_RTCP_MUX,
+  PROP_THREADED,
 };
 
 #define TSB_GET_LOCK(tsb) (&tsb->lock)
@@ -115,6 +121,9 @@ transport_send_bin_set_property (GObject * object, guint prop_id,
     case PROP_RTCP_MUX:
       _set_rtcp_mux (send, g_value_get_boolean (value));
       break;
+    case PROP_THREADED:
+      send->threaded = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -136,6 +145,9 @@ transport_send_bin_get_property (GObject * object, guint prop_id,
     case PROP_RTCP_MUX:
       g_value_set_boolean (value, send->rtcp_mux);
       break;
+    case PROP_THREADED:
+      g_value_set_boolean (value, send->threaded);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -213,7 +225,10 @@ transport_send_bin_change_state (GstElement * element,
       /* RTP */
       /* unblock the encoder once the key is set, this should also be automatic */
       elem = send->stream->transport->dtlssrtpenc;
-      send->rtp_ctx.rtp_block = block_peer_pad (elem, "rtp_sink_0");
+      if (send->rtp_queue)
+        send->rtp_ctx.rtp_block = block_peer_pad (send->rtp_queue, "sink");
+      else
+        send->rtp_ctx.rtp_block = block_peer_pad (elem, "rtp_sink_0");
       /* Also block the RTCP pad on the RTP encoder, in case we mux RTCP */
       send->rtp_ctx.rtcp_block = block_peer_pad (elem, "rtcp_sink_0");
       /* unblock ice sink once a connection is made, this should also be automatic */
@@ -227,6 +242,10 @@ transport_send_bin_change_state (GstElement * element,
       /* unblock ice sink once a connection is made, this should also be automatic */
       elem = send->stream->rtcp_transport->transport->sink;
       send->rtcp_ctx.nice_block = block_peer_pad (elem, "sink");
+
+      /* the blocks on the encoders above still apply once this one is gone */
+      if (send->rtcp_queue)
+        send->rtcp_queue_block = block_peer_pad (send->rtcp_queue, "sink");
       TSB_UNLOCK (send);
       break;
     }
@@ -296,6 +315,9 @@ _on_dtls_enc_key_set (GstElement * dtlssrtpenc, TransportSendBin * send)
   _free_pad_block (ctx->rtp_block);
   _free_pad_block (ctx->rtcp_block);
   ctx->rtp_block = ctx->rtcp_block = NULL;
+  /* RTCP goes to either encoder depending on rtcp-mux */
+  _free_pad_block (send->rtcp_queue_block);
+  send->rtcp_queue_block = NULL;
 
 done:
   TSB_UNLOCK (send);
@@ -390,6 +412,28 @@ tsb_setup_ctx (TransportSendBin * send, TransportSendBinDTLSContext * ctx,
     g_warn_if_reached ();
 }
 
+/* Returns a new queue in front of @pad, so that everything downstream of
+ * it, SRTP/DTLS encryption and sending, runs in the queue's streaming
+ * thread instead of the thread of the upstream element */
+static GstElement *
+_add_send_queue (TransportSendBin * send, GstPad * pad)
+{
+  GstElement *queue;
+  GstPad *queue_pad;
+
+  queue = gst_element_factory_make ("queue", NULL);
+  g_object_set (queue, "max-size-time", (guint64) 0, "max-size-buffers", 0,
+      "max-size-bytes", DEFAULT_TRANSPORT_QUEUE_SIZE, NULL);
+  gst_bin_add (GST_BIN (send), queue);
+
+  queue_pad = gst_element_get_static_pad (queue, "src");
+  if (gst_pad_link (queue_pad, pad) != GST_PAD_LINK_OK)
+    g_warn_if_reached ();
+  gst_object_unref (queue_pad);
+
+  return queue;
+}
+
 static void
 transport_send_bin_constructed (GObject * object)
 {
@@ -416,6 +460,11 @@ transport_send_bin_constructed (GObject * object)
       GST_PAD_SINK, GST_PAD_REQUEST, "rtp_sink_%d");
   pad = gst_element_request_pad (transport->dtlssrtpenc, templ, "rtp_sink_0",
       NULL);
+  if (send->threaded) {
+    send->rtp_queue = _add_send_queue (send, pad);
+    gst_object_unref (pad);
+    pad = gst_element_get_static_pad (send->rtp_queue, "sink");
+  }
 
   if (!gst_element_link_pads (GST_ELEMENT (send->outputselector), "src_0",
           GST_ELEMENT (transport->dtlssrtpenc), "rtcp_sink_0"))
@@ -447,6 +496,11 @@ transport_send_bin_constructed (GObject * object)
     g_warn_if_reached ();
 
   pad = gst_element_get_static_pad (send->outputselector, "sink");
+  if (send->threaded) {
+    send->rtcp_queue = _add_send_queue (send, pad);
+    gst_object_unref (pad);
+    pad = gst_element_get_static_pad (send->rtcp_queue, "sink");
+  }
 
   ghost = gst_ghost_pad_new ("rtcp_sink", pad);
   gst_element_add_pad (GST_ELEMENT (send), ghost);
@@ -479,6 +533,11 @@ cleanup_blocks (TransportSendBin * send)
 {
   cleanup_ctx_blocks (&send->rtp_ctx);
   cleanup_ctx_blocks (&send->rtcp_ctx);
+
+  if (send->rtcp_queue_block) {
+    _free_pad_block (send->rtcp_queue_block);
+    send->rtcp_queue_block = NULL;
+  }
 }
 
 static void
@@ -629,6 +688,13 @@ transport_send_bin_class_init (TransportSendBinClass * klass)
       g_param_spec_boolean ("rtcp-mux", "RTCP Mux",
           "Whether RTCP packets are muxed with RTP packets",
           FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class,
+      PROP_THREADED,
+      g_param_spec_boolean ("threaded", "Threaded",
+          "Whether to encrypt and send from a dedicated thread per component",
+          FALSE, G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+          G_PARAM_STATIC_STRINGS));
 }
 
 static void
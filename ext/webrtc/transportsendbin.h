@@ -55,8 +55,15 @@ struct _TransportSendBin
 
   TransportStream           *stream;        /* parent transport stream */
   gboolean                   rtcp_mux;
+  gboolean                   threaded;      /* encrypt and send from our own threads */
 
   GstElement                *outputselector;
+  /* with threaded=TRUE, the queues in front of the RTP encoder and the
+   * output selector */
+  GstElement                *rtp_queue;
+  GstElement                *rtcp_queue;
+  /* Block in front of the RTCP queue, if any */
+  struct pad_block          *rtcp_queue_block;
 
   TransportSendBinDTLSContext rtp_ctx;
   TransportSendBinDTLSContext rtcp_ctx;
@@ -249,10 +249,11 @@ transport_stream_constructed (GObject * object)
   gst_object_unref (ice_trans);
 
   stream->send_bin = g_object_new (transport_send_bin_get_type (), "stream",
-      stream, NULL);
+      stream, "threaded", webrtc->priv->transport_send_thread, NULL);
   gst_object_ref_sink (stream->send_bin);
   stream->receive_bin = g_object_new (transport_receive_bin_get_type (),
-      "stream", stream, NULL);
+      "stream", stream, "queue-size",
+      webrtc->priv->transport_receive_queue_size, NULL);
   gst_object_ref_sink (stream->receive_bin);
 
   gst_object_unref (webrtc);
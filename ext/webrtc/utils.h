@@ -29,6 +29,9 @@ G_BEGIN_DECLS
 #define GST_WEBRTC_BIN_ERROR gst_webrtc_bin_error_quark ()
 GQuark gst_webrtc_bin_error_quark (void);
 
+/* bytes held by each queue in front of the SRTP/DTLS encoders and decoders */
+#define DEFAULT_TRANSPORT_QUEUE_SIZE (5 * 1024 * 1024)
+
 typedef enum
 {
   GST_WEBRTC_BIN_ERROR_FAILED,
@@ -312,6 +312,9 @@ _close_sctp_stream (WebRTCDataChannel * channel, gpointer user_data)
   _transport_closed (channel);
 }
 
+static GstFlowReturn _data_channel_push_buffer (WebRTCDataChannel * channel,
+    GstBuffer * buffer);
+
 static void
 _close_procedure (WebRTCDataChannel * channel, gpointer user_data)
 {
@@ -442,11 +445,7 @@ _parse_control_packet (WebRTCDataChannel * channel, guint8 * data,
     GST_INFO_OBJECT (channel, "Sending channel ack");
     buffer = construct_ack_packet (channel);
 
-    GST_WEBRTC_DATA_CHANNEL_LOCK (channel);
-    channel->parent.buffered_amount += gst_buffer_get_size (buffer);
-    GST_WEBRTC_DATA_CHANNEL_UNLOCK (channel);
-
-    ret = gst_app_src_push_buffer (GST_APP_SRC (channel->appsrc), buffer);
+    ret = _data_channel_push_buffer (channel, buffer);
     if (ret != GST_FLOW_OK) {
       g_set_error (error, GST_WEBRTC_BIN_ERROR,
           GST_WEBRTC_BIN_ERROR_DATA_CHANNEL_FAILURE,
@@ -649,6 +648,83 @@ on_sink_sample (GstAppSink * sink, gpointer user_data)
   return ret;
 }
 
+static void
+_emit_high_threshold (WebRTCDataChannel * channel, gpointer user_data)
+{
+  gst_webrtc_data_channel_on_buffered_amount_high (GST_WEBRTC_DATA_CHANNEL
+      (channel));
+}
+
+/* Messages sent while the appsrc streaming thread is busy forwarding the
+ * previous ones are collected here and handed over as a single buffer list
+ * the next time it runs dry, so that bursts of small messages reach sctpenc
+ * together and can be bundled into full SCTP packets. */
+static GstFlowReturn
+_data_channel_push_buffer (WebRTCDataChannel * channel, GstBuffer * buffer)
+{
+  guint64 prev_amount;
+  gboolean push;
+
+  GST_WEBRTC_DATA_CHANNEL_LOCK (channel);
+  prev_amount = channel->parent.buffered_amount;
+  channel->parent.buffered_amount += gst_buffer_get_size (buffer);
+  if (channel->parent.buffered_amount_high_threshold > 0
+      && prev_amount < channel->parent.buffered_amount_high_threshold
+      && channel->parent.buffered_amount >=
+      channel->parent.buffered_amount_high_threshold) {
+    _channel_enqueue_task (channel, (ChannelTask) _emit_high_threshold, NULL,
+        NULL);
+  }
+
+  push = channel->appsrc_idle;
+  if (push) {
+    channel->appsrc_idle = FALSE;
+  } else {
+    if (!channel->pending_buffers)
+      channel->pending_buffers = gst_buffer_list_new ();
+    gst_buffer_list_add (channel->pending_buffers, buffer);
+  }
+  GST_WEBRTC_DATA_CHANNEL_UNLOCK (channel);
+
+  if (!push)
+    return GST_FLOW_OK;
+
+  return gst_app_src_push_buffer (GST_APP_SRC (channel->appsrc), buffer);
+}
+
+static void
+on_appsrc_need_data (GstAppSrc * appsrc, guint length, gpointer user_data)
+{
+  WebRTCDataChannel *channel = user_data;
+  GstBufferList *list;
+
+  GST_WEBRTC_DATA_CHANNEL_LOCK (channel);
+  list = channel->pending_buffers;
+  channel->pending_buffers = NULL;
+  channel->appsrc_idle = (list == NULL);
+  GST_WEBRTC_DATA_CHANNEL_UNLOCK (channel);
+
+  if (!list)
+    return;
+
+  GST_LOG_OBJECT (channel, "Pushing %u pending buffers",
+      gst_buffer_list_length (list));
+
+  if (gst_app_src_push_buffer_list (appsrc, list) != GST_FLOW_OK) {
+    GError *error = NULL;
+    g_set_error (&error, GST_WEBRTC_BIN_ERROR,
+        GST_WEBRTC_BIN_ERROR_DATA_CHANNEL_FAILURE, "Failed to send data");
+    _channel_store_error (channel, error);
+    _channel_enqueue_task (channel, (ChannelTask) _close_procedure, NULL, NULL);
+  }
+}
+
+static GstAppSrcCallbacks src_callbacks = {
+  on_appsrc_need_data,
+  NULL,
+  NULL,
+};
+
 static GstAppSinkCallbacks sink_callbacks = {
   on_sink_eos,
   on_sink_preroll,
@@ -671,12 +747,7 @@ webrtc_data_channel_start_negotiation (WebRTCDataChannel * channel)
       channel->parent.label, channel->parent.protocol,
       channel->parent.ordered ? "true" : "false");
 
-  GST_WEBRTC_DATA_CHANNEL_LOCK (channel);
-  channel->parent.buffered_amount += gst_buffer_get_size (buffer);
-  GST_WEBRTC_DATA_CHANNEL_UNLOCK (channel);
-
-  if (gst_app_src_push_buffer (GST_APP_SRC (channel->appsrc),
-          buffer) == GST_FLOW_OK) {
+  if (_data_channel_push_buffer (channel, buffer) == GST_FLOW_OK) {
     channel->opened = TRUE;
     _channel_enqueue_task (channel, (ChannelTask) _emit_on_open, NULL, NULL);
   } else {
@@ -754,11 +825,7 @@ webrtc_data_channel_send_data (GstWebRTCDataChannel * base_channel,
   GST_LOG_OBJECT (channel, "Sending data using buffer %" GST_PTR_FORMAT,
       buffer);
 
-  GST_WEBRTC_DATA_CHANNEL_LOCK (channel);
-  channel->parent.buffered_amount += gst_buffer_get_size (buffer);
-  GST_WEBRTC_DATA_CHANNEL_UNLOCK (channel);
-
-  ret = gst_app_src_push_buffer (GST_APP_SRC (channel->appsrc), buffer);
+  ret = _data_channel_push_buffer (channel, buffer);
 
   if (ret != GST_FLOW_OK) {
     GError *error = NULL;
@@ -815,11 +882,7 @@ webrtc_data_channel_send_string (GstWebRTCDataChannel * base_channel,
   GST_TRACE_OBJECT (channel, "Sending string using buffer %" GST_PTR_FORMAT,
       buffer);
 
-  GST_WEBRTC_DATA_CHANNEL_LOCK (channel);
-  channel->parent.buffered_amount += gst_buffer_get_size (buffer);
-  GST_WEBRTC_DATA_CHANNEL_UNLOCK (channel);
-
-  ret = gst_app_src_push_buffer (GST_APP_SRC (channel->appsrc), buffer);
+  ret = _data_channel_push_buffer (channel, buffer);
 
   if (ret != GST_FLOW_OK) {
     GError *error = NULL;
@@ -916,6 +979,8 @@ gst_webrtc_data_channel_constructed (GObject * object)
 
   channel->src_probe = gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_DATA_BOTH,
       (GstPadProbeCallback) on_appsrc_data, channel, NULL);
+  gst_app_src_set_callbacks (GST_APP_SRC (channel->appsrc), &src_callbacks,
+      channel, NULL);
 
   channel->appsink = gst_element_factory_make ("appsink", NULL);
   gst_object_ref_sink (channel->appsink);
@@ -944,6 +1009,10 @@ gst_webrtc_data_channel_finalize (GObject * object)
     g_signal_handlers_disconnect_by_data (channel->sctp_transport, channel);
   g_clear_object (&channel->sctp_transport);
 
+  if (channel->pending_buffers)
+    gst_buffer_list_unref (channel->pending_buffers);
+  channel->pending_buffers = NULL;
+
   g_clear_object (&channel->appsrc);
   g_clear_object (&channel->appsink);
 
@@ -968,6 +1037,7 @@ webrtc_data_channel_class_init (WebRTCDataChannelClass * klass)
 static void
 webrtc_data_channel_init (WebRTCDataChannel * channel)
 {
+  channel->appsrc_idle = TRUE;
 }
 
 static void
@@ -52,6 +52,9 @@ struct _WebRTCDataChannel
   gulong                            src_probe;
   GError                           *stored_error;
 
+  GstBufferList                    *pending_buffers;
+  gboolean                          appsrc_idle;
+
   gpointer                          _padding[GST_PADDING];
 };
 
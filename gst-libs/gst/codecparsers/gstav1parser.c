@@ -4274,9 +4274,13 @@ gst_av1_parse_tile_group (GstAV1Parser * parser, GstBitReader * br,
       if (retval != GST_AV1_PARSER_OK)
         goto error;
       tile_size = tile_size_minus_1 + 1;
-      sz -= tile_size - parser->state.tile_size_bytes;
+      sz -= tile_size + parser->state.tile_size_bytes;
     }
 
+    /* The tile size fields are byte aligned, so is the tile data */
+    tile_group->entry[tile_num].tile_offset = gst_bit_reader_get_pos (br) / 8;
+    tile_group->entry[tile_num].tile_size = tile_size;
+
     tile_group->entry[tile_num].mi_row_start =
         parser->state.mi_row_starts[tile_row];
     tile_group->entry[tile_num].mi_row_end =
@@ -4292,7 +4296,7 @@ gst_av1_parse_tile_group (GstAV1Parser * parser, GstBitReader * br,
      */
 
     /* Skip the real data to the next one */
-    if (!gst_bit_reader_skip (br, tile_size)) {
+    if (!gst_bit_reader_skip (br, tile_size * 8)) {
       retval = GST_AV1_PARSER_NO_MORE_DATA;
       goto error;
     }
@@ -4323,6 +4327,15 @@ error:
  * Parse one tile group @obu based on the @parser context, store the result
  * in the @tile_group.
  *
+ * The tile group with the last tile of the frame ends the frame, and a new
+ * frame header is expected after it. The parser context is only read for
+ * the other tile groups, so once the frame header is parsed, the tile group
+ * OBUs of a frame but the last can be parsed concurrently from several
+ * threads with the same @parser, and the last one after them, as long as
+ * no other OBU is parsed with it meanwhile. The entries from @tg_start to
+ * @tg_end of every @tile_group then give the location of all the tiles of
+ * the frame.
+ *
  * Returns: The #GstAV1ParserResult.
  *
  * Since: 1.18
@@ -4347,6 +4360,10 @@ gst_av1_parser_parse_tile_group_obu (GstAV1Parser * parser, GstAV1OBU * obu,
 
   gst_bit_reader_init (&bit_reader, obu->data, obu->obu_size);
   ret = gst_av1_parse_tile_group (parser, &bit_reader, tile_group);
+  if (ret == GST_AV1_PARSER_OK
+      && tile_group->tg_end == tile_group->num_tiles - 1)
+    parser->state.seen_frame_header = 0;
+
   return ret;
 }
 
@@ -1663,7 +1663,12 @@ struct _GstAV1TileListOBU {
  * @mi_row_end: end position in mi rows
  * @mi_col_start: start position in mi cols
  * @mi_col_end: end position in mi cols
+ * @tile_offset: offset in bytes of the tile data in the OBU data. Since: 1.18
+ * @tile_size: size in bytes of the tile data. Since: 1.18
  * @num_tiles: specifies the total number of tiles in the frame.
+ *
+ * The tile entries are indexed by tile number, only the ones from @tg_start
+ * to @tg_end are set.
  */
 struct _GstAV1TileGroupOBU {
   gboolean tile_start_and_end_present_flag;
@@ -1675,6 +1680,9 @@ struct _GstAV1TileGroupOBU {
     guint32 mi_row_end; /* MiRowEnd */
     guint32 mi_col_start; /* MiColStart */
     guint32 mi_col_end; /* MiColEnd */
+    /* Just refer to obu's data, no copy of the tile data is made */
+    guint32 tile_offset;
+    guint32 tile_size; /* tileSize */
   } entry[GST_AV1_MAX_TILE_COUNT];
 
   guint32 num_tiles; /* NumTiles */
@@ -1405,6 +1405,54 @@ gst_h264_nal_parser_free (GstH264NalParser * nalparser)
   nalparser = NULL;
 }
 
+/**
+ * gst_h264_nal_parser_copy:
+ * @nalparser: the #GstH264NalParser to copy
+ *
+ * Creates a new #GstH264NalParser with the same parameter sets as
+ * @nalparser. The copy can then be fed independently of @nalparser, for
+ * example to parse from an IDR picture onwards in another thread while
+ * @nalparser continues. Only the valid parameter sets are copied.
+ *
+ * Returns: a new #GstH264NalParser, free with gst_h264_nal_parser_free()
+ *
+ * Since: 1.18
+ */
+GstH264NalParser *
+gst_h264_nal_parser_copy (const GstH264NalParser * nalparser)
+{
+  GstH264NalParser *copy;
+  guint i;
+
+  g_return_val_if_fail (nalparser != NULL, NULL);
+
+  copy = gst_h264_nal_parser_new ();
+
+  for (i = 0; i < GST_H264_MAX_SPS_COUNT; i++) {
+    if (nalparser->sps[i].valid)
+      gst_h264_sps_copy (&copy->sps[i], &nalparser->sps[i]);
+  }
+
+  for (i = 0; i < GST_H264_MAX_PPS_COUNT; i++) {
+    const GstH264PPS *pps = &nalparser->pps[i];
+
+    if (!pps->valid)
+      continue;
+
+    gst_h264_pps_copy (&copy->pps[i], pps);
+    /* Point to the SPS of the copy, not to the one of @nalparser */
+    if (pps->sequence)
+      copy->pps[i].sequence = &copy->sps[pps->sequence - nalparser->sps];
+  }
+
+  if (nalparser->last_sps)
+    copy->last_sps = &copy->sps[nalparser->last_sps - nalparser->sps];
+  if (nalparser->last_pps)
+    copy->last_pps = &copy->pps[nalparser->last_pps - nalparser->pps];
+
+  return copy;
+}
+
 /**
  * gst_h264_parser_identify_nalu_unchecked:
  * @nalparser: a #GstH264NalParser
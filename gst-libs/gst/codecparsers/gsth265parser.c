@@ -1373,6 +1373,68 @@ gst_h265_parser_free (GstH265Parser * parser)
   parser = NULL;
 }
 
+/**
+ * gst_h265_parser_copy:
+ * @parser: the #GstH265Parser to copy
+ *
+ * Creates a new #GstH265Parser with the same parameter sets as @parser.
+ * The copy can then be fed independently of @parser, for example to parse
+ * from an IRAP picture onwards in another thread while @parser continues.
+ * Only the valid parameter sets are copied.
+ *
+ * Returns: a new #GstH265Parser, free with gst_h265_parser_free()
+ *
+ * Since: 1.18
+ */
+GstH265Parser *
+gst_h265_parser_copy (const GstH265Parser * parser)
+{
+  GstH265Parser *copy;
+  guint i;
+
+  g_return_val_if_fail (parser != NULL, NULL);
+
+  copy = gst_h265_parser_new ();
+
+  /* The parameter sets refer to each other within the tables of @parser,
+   * make them refer to the tables of the copy instead */
+  for (i = 0; i < GST_H265_MAX_VPS_COUNT; i++) {
+    if (parser->vps[i].valid)
+      copy->vps[i] = parser->vps[i];
+  }
+
+  for (i = 0; i < GST_H265_MAX_SPS_COUNT; i++) {
+    const GstH265SPS *sps = &parser->sps[i];
+
+    if (!sps->valid)
+      continue;
+
+    copy->sps[i] = *sps;
+    if (sps->vps)
+      copy->sps[i].vps = &copy->vps[sps->vps - parser->vps];
+  }
+
+  for (i = 0; i < GST_H265_MAX_PPS_COUNT; i++) {
+    const GstH265PPS *pps = &parser->pps[i];
+
+    if (!pps->valid)
+      continue;
+
+    copy->pps[i] = *pps;
+    if (pps->sps)
+      copy->pps[i].sps = &copy->sps[pps->sps - parser->sps];
+  }
+
+  if (parser->last_vps)
+    copy->last_vps = &copy->vps[parser->last_vps - parser->vps];
+  if (parser->last_sps)
+    copy->last_sps = &copy->sps[parser->last_sps - parser->sps];
+  if (parser->last_pps)
+    copy->last_pps = &copy->pps[parser->last_pps - parser->pps];
+
+  return copy;
+}
+
 /**
  * gst_h265_parser_identify_nalu_unchecked:
  * @parser: a #GstH265Parser
@@ -1697,6 +1697,9 @@ GstH265ParserResult gst_h265_parser_update_pps      (GstH265Parser   * parser,
 GST_CODEC_PARSERS_API
 void                gst_h265_parser_free            (GstH265Parser  * parser);
 
+GST_CODEC_PARSERS_API
+GstH265Parser *     gst_h265_parser_copy            (const GstH265Parser * parser);
+
 GST_CODEC_PARSERS_API
 GstH265ParserResult gst_h265_parse_vps              (GstH265NalUnit * nalu,
                                                      GstH265VPS     * vps);
@@ -51,6 +51,7 @@ enum
   SIGNAL_ON_MESSAGE_DATA,
   SIGNAL_ON_MESSAGE_STRING,
   SIGNAL_ON_BUFFERED_AMOUNT_LOW,
+  SIGNAL_ON_BUFFERED_AMOUNT_HIGH,
   SIGNAL_SEND_DATA,
   SIGNAL_SEND_STRING,
   SIGNAL_CLOSE,
@@ -71,6 +72,7 @@ enum
   PROP_READY_STATE,
   PROP_BUFFERED_AMOUNT,
   PROP_BUFFERED_AMOUNT_LOW_THRESHOLD,
+  PROP_BUFFERED_AMOUNT_HIGH_THRESHOLD,
 };
 
 static guint gst_webrtc_data_channel_signals[LAST_SIGNAL] = { 0 };
@@ -110,6 +112,9 @@ gst_webrtc_data_channel_set_property (GObject * object, guint prop_id,
     case PROP_BUFFERED_AMOUNT_LOW_THRESHOLD:
       channel->buffered_amount_low_threshold = g_value_get_uint64 (value);
       break;
+    case PROP_BUFFERED_AMOUNT_HIGH_THRESHOLD:
+      channel->buffered_amount_high_threshold = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -158,6 +163,9 @@ gst_webrtc_data_channel_get_property (GObject * object, guint prop_id,
     case PROP_BUFFERED_AMOUNT_LOW_THRESHOLD:
       g_value_set_uint64 (value, channel->buffered_amount_low_threshold);
       break;
+    case PROP_BUFFERED_AMOUNT_HIGH_THRESHOLD:
+      g_value_set_uint64 (value, channel->buffered_amount_high_threshold);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -274,6 +282,25 @@ gst_webrtc_data_channel_class_init (GstWebRTCDataChannelClass * klass)
           "the buffered-amount-low signal is emitted",
           0, G_MAXUINT64, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstWebRTCDataChannel:buffered-amount-high-threshold:
+   *
+   * The threshold at which the buffered amount is considered high and the
+   * #GstWebRTCDataChannel::on-buffered-amount-high signal is emitted.
+   * Together with #GstWebRTCDataChannel::on-buffered-amount-low this allows
+   * applications to stop and resume sending without polling the buffered
+   * amount. 0 disables the signal.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_BUFFERED_AMOUNT_HIGH_THRESHOLD,
+      g_param_spec_uint64 ("buffered-amount-high-threshold",
+          "Buffered Amount High Threshold",
+          "The threshold at which the buffered amount is considered high and "
+          "the buffered-amount-high signal is emitted (0 = disabled)",
+          0, G_MAXUINT64, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstWebRTCDataChannel::on-open:
    * @object: the #GstWebRTCDataChannel
@@ -325,6 +352,19 @@ gst_webrtc_data_channel_class_init (GstWebRTCDataChannelClass * klass)
       g_signal_new ("on-buffered-amount-low", G_TYPE_FROM_CLASS (klass),
       G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL, G_TYPE_NONE, 0);
 
+  /**
+   * GstWebRTCDataChannel::on-buffered-amount-high:
+   * @object: the #GstWebRTCDataChannel
+   *
+   * Emitted when sending made the buffered amount reach
+   * #GstWebRTCDataChannel:buffered-amount-high-threshold.
+   *
+   * Since: 1.18
+   */
+  gst_webrtc_data_channel_signals[SIGNAL_ON_BUFFERED_AMOUNT_HIGH] =
+      g_signal_new ("on-buffered-amount-high", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL, G_TYPE_NONE, 0);
+
   /**
    * GstWebRTCDataChannel::send-data:
    * @object: the #GstWebRTCDataChannel
@@ -501,6 +541,25 @@ gst_webrtc_data_channel_on_buffered_amount_low (GstWebRTCDataChannel * channel)
       gst_webrtc_data_channel_signals[SIGNAL_ON_BUFFERED_AMOUNT_LOW], 0);
 }
 
+/**
+ * gst_webrtc_data_channel_on_buffered_amount_high:
+ * @channel: a #GstWebRTCDataChannel
+ *
+ * Signal that the data channel reached a high buffered amount. Should only be used by subclasses.
+ *
+ * Since: 1.18
+ */
+void
+gst_webrtc_data_channel_on_buffered_amount_high (GstWebRTCDataChannel *
+    channel)
+{
+  g_return_if_fail (GST_IS_WEBRTC_DATA_CHANNEL (channel));
+
+  GST_LOG_OBJECT (channel, "High threshold reached");
+  g_signal_emit (channel,
+      gst_webrtc_data_channel_signals[SIGNAL_ON_BUFFERED_AMOUNT_HIGH], 0);
+}
+
 /**
  * gst_webrtc_data_channel_send_data:
  * @channel: a #GstWebRTCDataChannel
@@ -135,6 +135,7 @@ static void gst_audio_mix_matrix_set_property (GObject * object, guint prop_id,
 static void gst_audio_mix_matrix_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 static void gst_audio_mix_matrix_dispose (GObject * object);
+static void gst_audio_mix_matrix_free_kernels (GstAudioMixMatrix * self);
 static gboolean gst_audio_mix_matrix_get_unit_size (GstBaseTransform * trans,
     GstCaps * caps, gsize * size);
 static gboolean gst_audio_mix_matrix_set_caps (GstBaseTransform * trans,
@@ -227,8 +228,15 @@ gst_audio_mix_matrix_init (GstAudioMixMatrix * self)
   self->out_channels = 0;
   self->matrix = NULL;
   self->channel_mask = 0;
+  self->f32_conv_matrix = NULL;
+  self->f64_conv_matrix = NULL;
   self->s16_conv_matrix = NULL;
   self->s32_conv_matrix = NULL;
+  self->kernel = GST_AUDIO_MIX_MATRIX_KERNEL_DENSE;
+  self->routing = NULL;
+  self->sparse_n = NULL;
+  self->sparse_in = NULL;
+  self->accum = NULL;
   self->mode = GST_AUDIO_MIX_MATRIX_MODE_MANUAL;
 }
 
@@ -242,13 +250,15 @@ gst_audio_mix_matrix_dispose (GObject * object)
     self->matrix = NULL;
   }
 
+  gst_audio_mix_matrix_free_kernels (self);
+
   G_OBJECT_CLASS (gst_audio_mix_matrix_parent_class)->dispose (object);
 }
 
 static void
 gst_audio_mix_matrix_convert_s16_matrix (GstAudioMixMatrix * self)
 {
-  gint i;
+  gint in, out;
 
   /* converted bits - input bits - sign - bits needed for channel */
   self->shift_bytes = 32 - 16 - 1 - ceil (log (self->in_channels) / log (2));
@@ -257,16 +267,19 @@ gst_audio_mix_matrix_convert_s16_matrix (GstAudioMixMatrix * self)
     g_free (self->s16_conv_matrix);
   self->s16_conv_matrix =
       g_new (gint32, self->in_channels * self->out_channels);
-  for (i = 0; i < self->in_channels * self->out_channels; i++) {
-    self->s16_conv_matrix[i] =
-        (gint32) ((self->matrix[i]) * (1 << self->shift_bytes));
+  for (out = 0; out < self->out_channels; out++) {
+    for (in = 0; in < self->in_channels; in++) {
+      self->s16_conv_matrix[in * self->out_channels + out] =
+          (gint32) ((self->matrix[out * self->in_channels + in]) *
+          (1 << self->shift_bytes));
+    }
   }
 }
 
 static void
 gst_audio_mix_matrix_convert_s32_matrix (GstAudioMixMatrix * self)
 {
-  gint i;
+  gint in, out;
 
   /* converted bits - input bits - sign - bits needed for channel */
   self->shift_bytes = 64 - 32 - 1 - (gint) (log (self->in_channels) / log (2));
@@ -275,12 +288,128 @@ gst_audio_mix_matrix_convert_s32_matrix (GstAudioMixMatrix * self)
     g_free (self->s32_conv_matrix);
   self->s32_conv_matrix =
       g_new (gint64, self->in_channels * self->out_channels);
-  for (i = 0; i < self->in_channels * self->out_channels; i++) {
-    self->s32_conv_matrix[i] =
-        (gint64) ((self->matrix[i]) * (1 << self->shift_bytes));
+  for (out = 0; out < self->out_channels; out++) {
+    for (in = 0; in < self->in_channels; in++) {
+      self->s32_conv_matrix[in * self->out_channels + out] =
+          (gint64) ((self->matrix[out * self->in_channels + in]) *
+          ((gint64) 1 << self->shift_bytes));
+    }
+  }
+}
+
+static void
+gst_audio_mix_matrix_convert_float_matrix (GstAudioMixMatrix * self)
+{
+  gint in, out;
+
+  g_free (self->f32_conv_matrix);
+  g_free (self->f64_conv_matrix);
+  self->f32_conv_matrix =
+      g_new (gfloat, self->in_channels * self->out_channels);
+  self->f64_conv_matrix =
+      g_new (gdouble, self->in_channels * self->out_channels);
+  for (out = 0; out < self->out_channels; out++) {
+    for (in = 0; in < self->in_channels; in++) {
+      gdouble coefficient = self->matrix[out * self->in_channels + in];
+
+      self->f32_conv_matrix[in * self->out_channels + out] = coefficient;
+      self->f64_conv_matrix[in * self->out_channels + out] = coefficient;
+    }
   }
 }
 
+static void
+gst_audio_mix_matrix_free_kernels (GstAudioMixMatrix * self)
+{
+  g_clear_pointer (&self->f32_conv_matrix, g_free);
+  g_clear_pointer (&self->f64_conv_matrix, g_free);
+  g_clear_pointer (&self->s16_conv_matrix, g_free);
+  g_clear_pointer (&self->s32_conv_matrix, g_free);
+  g_clear_pointer (&self->routing, g_free);
+  g_clear_pointer (&self->sparse_n, g_free);
+  g_clear_pointer (&self->sparse_in, g_free);
+  g_clear_pointer (&self->accum, g_free);
+  self->kernel = GST_AUDIO_MIX_MATRIX_KERNEL_DENSE;
+}
+
+/* Look at the non-zero coefficients of the matrix to pick the cheapest
+ * transform loop: a plain copy for the identity matrix, per-channel copies
+ * when every output is either silent or a single input at unity gain, and
+ * a loop over the non-zero coefficients only when there are few of them. */
+static void
+gst_audio_mix_matrix_analyze_matrix (GstAudioMixMatrix * self)
+{
+  guint in, out, n, n_total = 0;
+  guint inchannels = self->in_channels;
+  guint outchannels = self->out_channels;
+  gboolean routing = TRUE;
+  gboolean identity = (inchannels == outchannels);
+
+  g_free (self->routing);
+  g_free (self->sparse_n);
+  g_free (self->sparse_in);
+  g_free (self->accum);
+  self->routing = g_new (gint, outchannels);
+  self->sparse_n = g_new (guint, outchannels);
+  self->sparse_in = g_new (guint, inchannels * outchannels);
+  self->accum = g_new (gint64, outchannels);
+
+  for (out = 0; out < outchannels; out++) {
+    guint *sparse_in = self->sparse_in + out * inchannels;
+
+    n = 0;
+    for (in = 0; in < inchannels; in++) {
+      if (self->matrix[out * inchannels + in] != 0)
+        sparse_in[n++] = in;
+    }
+    self->sparse_n[out] = n;
+    n_total += n;
+
+    if (n > 1 || (n == 1 && self->matrix[out * inchannels + sparse_in[0]] != 1))
+      routing = FALSE;
+    self->routing[out] = (n == 1) ? sparse_in[0] : -1;
+    if (self->routing[out] != (gint) out)
+      identity = FALSE;
+  }
+
+  if (routing && identity)
+    self->kernel = GST_AUDIO_MIX_MATRIX_KERNEL_IDENTITY;
+  else if (routing)
+    self->kernel = GST_AUDIO_MIX_MATRIX_KERNEL_ROUTING;
+  else if (n_total * 4 <= inchannels * outchannels)
+    self->kernel = GST_AUDIO_MIX_MATRIX_KERNEL_SPARSE;
+  else
+    self->kernel = GST_AUDIO_MIX_MATRIX_KERNEL_DENSE;
+
+  GST_DEBUG_OBJECT (self, "%u of %u coefficients are non-zero, using kernel %d",
+      n_total, inchannels * outchannels, self->kernel);
+}
+
+/* convert the matrix for the negotiated format and pick the kernel */
+static void
+gst_audio_mix_matrix_prepare_matrix (GstAudioMixMatrix * self)
+{
+  switch (self->format) {
+    case GST_AUDIO_FORMAT_S16LE:
+    case GST_AUDIO_FORMAT_S16BE:
+      gst_audio_mix_matrix_convert_s16_matrix (self);
+      break;
+    case GST_AUDIO_FORMAT_S32LE:
+    case GST_AUDIO_FORMAT_S32BE:
+      gst_audio_mix_matrix_convert_s32_matrix (self);
+      break;
+    case GST_AUDIO_FORMAT_F32LE:
+    case GST_AUDIO_FORMAT_F32BE:
+    case GST_AUDIO_FORMAT_F64LE:
+    case GST_AUDIO_FORMAT_F64BE:
+      gst_audio_mix_matrix_convert_float_matrix (self);
+      break;
+    default:
+      break;
+  }
+
+  gst_audio_mix_matrix_analyze_matrix (self);
+}
 
 static void
 gst_audio_mix_matrix_set_property (GObject * object, guint prop_id,
@@ -291,17 +420,13 @@ gst_audio_mix_matrix_set_property (GObject * object, guint prop_id,
   switch (prop_id) {
     case PROP_IN_CHANNELS:
       self->in_channels = g_value_get_uint (value);
-      if (self->matrix) {
-        gst_audio_mix_matrix_convert_s16_matrix (self);
-        gst_audio_mix_matrix_convert_s32_matrix (self);
-      }
+      if (self->matrix)
+        gst_audio_mix_matrix_prepare_matrix (self);
       break;
     case PROP_OUT_CHANNELS:
       self->out_channels = g_value_get_uint (value);
-      if (self->matrix) {
-        gst_audio_mix_matrix_convert_s16_matrix (self);
-        gst_audio_mix_matrix_convert_s32_matrix (self);
-      }
+      if (self->matrix)
+        gst_audio_mix_matrix_prepare_matrix (self);
       break;
     case PROP_MATRIX:{
       gint in, out;
@@ -324,8 +449,7 @@ gst_audio_mix_matrix_set_property (GObject * object, guint prop_id,
           self->matrix[out * self->in_channels + in] = coefficient;
         }
       }
-      gst_audio_mix_matrix_convert_s16_matrix (self);
-      gst_audio_mix_matrix_convert_s32_matrix (self);
+      gst_audio_mix_matrix_prepare_matrix (self);
       break;
     }
     case PROP_CHANNEL_MASK:
@@ -396,32 +520,130 @@ gst_audio_mix_matrix_change_state (GstElement * element,
   s = GST_ELEMENT_CLASS (gst_audio_mix_matrix_parent_class)->change_state
       (element, transition);
 
-  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY) {
-    if (self->s16_conv_matrix) {
-      g_free (self->s16_conv_matrix);
-      self->s16_conv_matrix = NULL;
-    }
-
-    if (self->s32_conv_matrix) {
-      g_free (self->s32_conv_matrix);
-      self->s32_conv_matrix = NULL;
-    }
-  }
+  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY)
+    gst_audio_mix_matrix_free_kernels (self);
 
   return s;
 }
 
 
+/* The dense loops add up one input channel at a time into the accumulators
+ * of all output channels of a frame. With the coefficients stored
+ * input-major, the inner loop runs over contiguous memory and the compiler
+ * can vectorize it. The sparse loop only visits non-zero coefficients and
+ * the routing loop only copies samples. */
+#define FLOAT_STORE(acc, shift) (acc)
+#define INT_STORE(acc, shift) ((acc) >> (shift))
+
+#define DEFINE_MIX_FUNCS(name, type, ctype, atype, STORE)                     \
+static void                                                                   \
+gst_audio_mix_matrix_dense_##name (GstAudioMixMatrix * self,                  \
+    const type * inarray, type * outarray, const ctype * matrix,              \
+    guint n_samples)                                                          \
+{                                                                             \
+  guint inchannels = self->in_channels;                                       \
+  guint outchannels = self->out_channels;                                     \
+  atype *accum = self->accum;                                                 \
+  guint in, out, sample;                                                      \
+                                                                              \
+  for (sample = 0; sample < n_samples; sample++) {                            \
+    for (out = 0; out < outchannels; out++)                                   \
+      accum[out] = 0;                                                         \
+    for (in = 0; in < inchannels; in++) {                                     \
+      const ctype *row = matrix + in * outchannels;                           \
+      atype inval = inarray[in];                                              \
+                                                                              \
+      for (out = 0; out < outchannels; out++)                                 \
+        accum[out] += inval * row[out];                                       \
+    }                                                                         \
+    for (out = 0; out < outchannels; out++)                                   \
+      outarray[out] = (type) STORE (accum[out], self->shift_bytes);           \
+    inarray += inchannels;                                                    \
+    outarray += outchannels;                                                  \
+  }                                                                           \
+}                                                                             \
+                                                                              \
+static void                                                                   \
+gst_audio_mix_matrix_sparse_##name (GstAudioMixMatrix * self,                 \
+    const type * inarray, type * outarray, const ctype * matrix,              \
+    guint n_samples)                                                          \
+{                                                                             \
+  guint inchannels = self->in_channels;                                       \
+  guint outchannels = self->out_channels;                                     \
+  guint i, out, sample;                                                       \
+                                                                              \
+  for (sample = 0; sample < n_samples; sample++) {                            \
+    for (out = 0; out < outchannels; out++) {                                 \
+      const guint *sparse_in = self->sparse_in + out * inchannels;            \
+      atype outval = 0;                                                       \
+                                                                              \
+      for (i = 0; i < self->sparse_n[out]; i++) {                             \
+        guint in = sparse_in[i];                                              \
+                                                                              \
+        outval += (atype) inarray[in] * matrix[in * outchannels + out];       \
+      }                                                                       \
+      outarray[out] = (type) STORE (outval, self->shift_bytes);               \
+    }                                                                         \
+    inarray += inchannels;                                                    \
+    outarray += outchannels;                                                  \
+  }                                                                           \
+}                                                                             \
+                                                                              \
+static void                                                                   \
+gst_audio_mix_matrix_routing_##name (GstAudioMixMatrix * self,                \
+    const type * inarray, type * outarray, guint n_samples)                   \
+{                                                                             \
+  guint inchannels = self->in_channels;                                       \
+  guint outchannels = self->out_channels;                                     \
+  const gint *routing = self->routing;                                        \
+  guint out, sample;                                                          \
+                                                                              \
+  for (sample = 0; sample < n_samples; sample++) {                            \
+    for (out = 0; out < outchannels; out++)                                   \
+      outarray[out] = routing[out] >= 0 ? inarray[routing[out]] : 0;          \
+    inarray += inchannels;                                                    \
+    outarray += outchannels;                                                  \
+  }                                                                           \
+}
+
+DEFINE_MIX_FUNCS (f32, gfloat, gfloat, gfloat, FLOAT_STORE)
+DEFINE_MIX_FUNCS (f64, gdouble, gdouble, gdouble, FLOAT_STORE)
+DEFINE_MIX_FUNCS (s16, gint16, gint32, gint32, INT_STORE)
+DEFINE_MIX_FUNCS (s32, gint32, gint64, gint64, INT_STORE)
+
+#define MIX_MATRIX(name, type, matrix)                                        \
+G_STMT_START {                                                                \
+  const type *inarray = (const type *) inmap.data;                            \
+  type *outarray = (type *) outmap.data;                                      \
+  guint n_samples = outmap.size / (sizeof (type) * self->out_channels);      \
+                                                                              \
+  switch (self->kernel) {                                                     \
+    case GST_AUDIO_MIX_MATRIX_KERNEL_IDENTITY:                                \
+      memcpy (outarray, inarray, n_samples * sizeof (type) *                  \
+          self->out_channels);                                                \
+      break;                                                                  \
+    case GST_AUDIO_MIX_MATRIX_KERNEL_ROUTING:                                 \
+      gst_audio_mix_matrix_routing_##name (self, inarray, outarray,           \
+          n_samples);                                                         \
+      break;                                                                  \
+    case GST_AUDIO_MIX_MATRIX_KERNEL_SPARSE:                                  \
+      gst_audio_mix_matrix_sparse_##name (self, inarray, outarray, matrix,    \
+          n_samples);                                                         \
+      break;                                                                  \
+    case GST_AUDIO_MIX_MATRIX_KERNEL_DENSE:                                   \
+    default:                                                                  \
+      gst_audio_mix_matrix_dense_##name (self, inarray, outarray, matrix,     \
+          n_samples);                                                         \
+      break;                                                                  \
+  }                                                                           \
+} G_STMT_END
+
 static GstFlowReturn
 gst_audio_mix_matrix_transform (GstBaseTransform * vfilter,
     GstBuffer * inbuf, GstBuffer * outbuf)
 {
   GstMapInfo inmap, outmap;
   GstAudioMixMatrix *self = GST_AUDIO_MIX_MATRIX (vfilter);
-  gint in, out, sample;
-  guint inchannels = self->in_channels;
-  guint outchannels = self->out_channels;
-  gdouble *matrix = self->matrix;
 
   if (!gst_buffer_map (inbuf, &inmap, GST_MAP_READ)) {
     return GST_FLOW_ERROR;
@@ -433,95 +655,21 @@ gst_audio_mix_matrix_transform (GstBaseTransform * vfilter,
 
   switch (self->format) {
     case GST_AUDIO_FORMAT_F32LE:
-    case GST_AUDIO_FORMAT_F32BE:{
-      const gfloat *inarray;
-      gfloat *outarray;
-      guint n_samples = outmap.size / (sizeof (gfloat) * outchannels);
-
-      inarray = (gfloat *) inmap.data;
-      outarray = (gfloat *) outmap.data;
-
-      for (sample = 0; sample < n_samples; sample++) {
-        for (out = 0; out < outchannels; out++) {
-          gfloat outval = 0;
-          for (in = 0; in < inchannels; in++) {
-            outval +=
-                inarray[sample * inchannels +
-                in] * matrix[out * inchannels + in];
-          }
-          outarray[sample * outchannels + out] = outval;
-        }
-      }
+    case GST_AUDIO_FORMAT_F32BE:
+      MIX_MATRIX (f32, gfloat, self->f32_conv_matrix);
       break;
-    }
     case GST_AUDIO_FORMAT_F64LE:
-    case GST_AUDIO_FORMAT_F64BE:{
-      const gdouble *inarray;
-      gdouble *outarray;
-      guint n_samples = outmap.size / (sizeof (gdouble) * outchannels);
-
-      inarray = (gdouble *) inmap.data;
-      outarray = (gdouble *) outmap.data;
-
-      for (sample = 0; sample < n_samples; sample++) {
-        for (out = 0; out < outchannels; out++) {
-          gdouble outval = 0;
-          for (in = 0; in < inchannels; in++) {
-            outval +=
-                inarray[sample * inchannels +
-                in] * matrix[out * inchannels + in];
-          }
-          outarray[sample * outchannels + out] = outval;
-        }
-      }
+    case GST_AUDIO_FORMAT_F64BE:
+      MIX_MATRIX (f64, gdouble, self->f64_conv_matrix);
       break;
-    }
     case GST_AUDIO_FORMAT_S16LE:
-    case GST_AUDIO_FORMAT_S16BE:{
-      const gint16 *inarray;
-      gint16 *outarray;
-      guint n_samples = outmap.size / (sizeof (gint16) * outchannels);
-      guint n = self->shift_bytes;
-      gint32 *conv_matrix = self->s16_conv_matrix;
-
-      inarray = (gint16 *) inmap.data;
-      outarray = (gint16 *) outmap.data;
-
-      for (sample = 0; sample < n_samples; sample++) {
-        for (out = 0; out < outchannels; out++) {
-          gint32 outval = 0;
-          for (in = 0; in < inchannels; in++) {
-            outval += (gint32) (inarray[sample * inchannels + in] *
-                conv_matrix[out * inchannels + in]);
-          }
-          outarray[sample * outchannels + out] = (gint16) (outval >> n);
-        }
-      }
+    case GST_AUDIO_FORMAT_S16BE:
+      MIX_MATRIX (s16, gint16, self->s16_conv_matrix);
       break;
-    }
     case GST_AUDIO_FORMAT_S32LE:
-    case GST_AUDIO_FORMAT_S32BE:{
-      const gint32 *inarray;
-      gint32 *outarray;
-      guint n_samples = outmap.size / (sizeof (gint32) * outchannels);
-      guint n = self->shift_bytes;
-      gint64 *conv_matrix = self->s32_conv_matrix;
-
-      inarray = (gint32 *) inmap.data;
-      outarray = (gint32 *) outmap.data;
-
-      for (sample = 0; sample < n_samples; sample++) {
-        for (out = 0; out < outchannels; out++) {
-          gint64 outval = 0;
-          for (in = 0; in < inchannels; in++) {
-            outval += (gint64) (inarray[sample * inchannels + in] *
-                conv_matrix[out * inchannels + in]);
-          }
-          outarray[sample * outchannels + out] = (gint32) (outval >> n);
-        }
-      }
+    case GST_AUDIO_FORMAT_S32BE:
+      MIX_MATRIX (s32, gint32, self->s32_conv_matrix);
       break;
-    }
     default:
       gst_buffer_unmap (inbuf, &inmap);
       gst_buffer_unmap (outbuf, &outmap);
@@ -584,20 +732,8 @@ gst_audio_mix_matrix_set_caps (GstBaseTransform * trans, GstCaps * incaps,
     return FALSE;
   }
 
-  switch (self->format) {
-    case GST_AUDIO_FORMAT_S16LE:
-    case GST_AUDIO_FORMAT_S16BE:{
-      gst_audio_mix_matrix_convert_s16_matrix (self);
-      break;
-    }
-    case GST_AUDIO_FORMAT_S32LE:
-    case GST_AUDIO_FORMAT_S32BE:{
-      gst_audio_mix_matrix_convert_s32_matrix (self);
-      break;
-    }
-    default:
-      break;
-  }
+  gst_audio_mix_matrix_prepare_matrix (self);
+
   return TRUE;
 }
 
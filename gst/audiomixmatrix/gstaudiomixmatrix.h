@@ -43,6 +43,15 @@ typedef enum _GstAudioMixMatrixMode
   GST_AUDIO_MIX_MATRIX_MODE_FIRST_CHANNELS = 1
 } GstAudioMixMatrixMode;
 
+/* which transform loop to use, picked from the matrix layout */
+typedef enum _GstAudioMixMatrixKernel
+{
+  GST_AUDIO_MIX_MATRIX_KERNEL_DENSE = 0,
+  GST_AUDIO_MIX_MATRIX_KERNEL_SPARSE,
+  GST_AUDIO_MIX_MATRIX_KERNEL_ROUTING,
+  GST_AUDIO_MIX_MATRIX_KERNEL_IDENTITY
+} GstAudioMixMatrixKernel;
+
 /**
  * GstAudioMixMatrix:
  *
@@ -58,10 +67,19 @@ struct _GstAudioMixMatrix
   gdouble *matrix;
   guint64 channel_mask;
   GstAudioMixMatrixMode mode;
+  /* converted matrices are stored input-major: [in * out_channels + out] */
+  gfloat *f32_conv_matrix;
+  gdouble *f64_conv_matrix;
   gint32 *s16_conv_matrix;
   gint64 *s32_conv_matrix;
   gint shift_bytes;
 
+  GstAudioMixMatrixKernel kernel;
+  gint *routing;        /* input channel per output channel, -1 for silence */
+  guint *sparse_n;      /* non-zero coefficients per output channel */
+  guint *sparse_in;     /* their input channels, in_channels per output */
+  gpointer accum;       /* out_channels accumulators for the dense loops */
+
   GstAudioFormat format;
 };
 
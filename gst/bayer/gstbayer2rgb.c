@@ -26,6 +26,12 @@
  * @title: bayer2rgb
  *
  * Decodes raw camera bayer (fourcc BA81) to RGB.
+ *
+ * Besides 8 bit bayer, 10, 12, 14 and 16 bit little and big endian input is
+ * accepted, which is reduced to 8 bits per component during the decode. The
+ * output can be packed RGB or directly I420/NV12, and the frame can be
+ * decoded in horizontal bands on several threads with the
+ * #GstBayer2RGB:n-threads property.
  */
 
 /*
@@ -111,6 +117,10 @@ typedef struct _GstBayer2RGBClass GstBayer2RGBClass;
 
 typedef void (*GstBayer2RGBProcessFunc) (GstBayer2RGB *, guint8 *, guint);
 
+typedef void (*process_func) (guint8 * d0, const guint8 * s0, const guint8 * s1,
+    const guint8 * s2, const guint8 * s3, const guint8 * s4, const guint8 * s5,
+    int n);
+
 struct _GstBayer2RGB
 {
   GstBaseTransform basetransform;
@@ -123,6 +133,22 @@ struct _GstBayer2RGB
   int g_off;                    /* offset for green */
   int b_off;                    /* offset for blue */
   int format;
+  int bits;                     /* bits per input sample */
+  gboolean big_endian;          /* byte order of > 8 bit input samples */
+  int src_stride;
+  process_func merge[2];
+
+  /* RGB to YUV coefficients for I420/NV12 output, 16 bit fixed point */
+  gint y_coef[3], u_coef[3], v_coef[3];
+  gint y_offset;
+
+  /* properties */
+  guint n_threads;
+
+  GThreadPool *pool;
+  GMutex band_lock;
+  GCond band_cond;
+  gint bands_pending;
 };
 
 struct _GstBayer2RGBClass
@@ -131,14 +157,24 @@ struct _GstBayer2RGBClass
 };
 
 #define	SRC_CAPS                                 \
-  GST_VIDEO_CAPS_MAKE ("{ RGBx, xRGB, BGRx, xBGR, RGBA, ARGB, BGRA, ABGR }")
+  GST_VIDEO_CAPS_MAKE ("{ RGBx, xRGB, BGRx, xBGR, RGBA, ARGB, BGRA, ABGR, " \
+      "I420, NV12 }")
+
+#define BAYER_FORMATS(order) \
+  order "," order "10le," order "10be," order "12le," order "12be," \
+  order "14le," order "14be," order "16le," order "16be"
 
-#define SINK_CAPS "video/x-bayer,format=(string){bggr,grbg,gbrg,rggb}," \
+#define SINK_CAPS "video/x-bayer,format=(string){" BAYER_FORMATS ("bggr") "," \
+  BAYER_FORMATS ("grbg") "," BAYER_FORMATS ("gbrg") "," \
+  BAYER_FORMATS ("rggb") "}," \
   "width=(int)[1,MAX],height=(int)[1,MAX],framerate=(fraction)[0/1,MAX]"
 
+#define DEFAULT_N_THREADS 1
+
 enum
 {
-  PROP_0
+  PROP_0,
+  PROP_N_THREADS
 };
 
 GType gst_bayer2rgb_get_type (void);
@@ -160,6 +196,7 @@ static GstCaps *gst_bayer2rgb_transform_caps (GstBaseTransform * base,
     GstPadDirection direction, GstCaps * caps, GstCaps * filter);
 static gboolean gst_bayer2rgb_get_unit_size (GstBaseTransform * base,
     GstCaps * caps, gsize * size);
+static void gst_bayer2rgb_finalize (GObject * object);
 
 
 static void
@@ -173,6 +210,21 @@ gst_bayer2rgb_class_init (GstBayer2RGBClass * klass)
 
   gobject_class->set_property = gst_bayer2rgb_set_property;
   gobject_class->get_property = gst_bayer2rgb_get_property;
+  gobject_class->finalize = gst_bayer2rgb_finalize;
+
+  /**
+   * GstBayer2RGB:n-threads:
+   *
+   * Number of threads the frame is split between, 0 uses one thread per
+   * CPU core.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Maximum number of threads to use (0 = number of CPU cores)",
+          0, G_MAXINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_set_static_metadata (gstelement_class,
       "Bayer to RGB decoder for cameras", "Filter/Converter/Video",
@@ -202,17 +254,39 @@ gst_bayer2rgb_class_init (GstBayer2RGBClass * klass)
 static void
 gst_bayer2rgb_init (GstBayer2RGB * filter)
 {
+  filter->n_threads = DEFAULT_N_THREADS;
+  g_mutex_init (&filter->band_lock);
+  g_cond_init (&filter->band_cond);
+
   gst_bayer2rgb_reset (filter);
   gst_base_transform_set_in_place (GST_BASE_TRANSFORM (filter), TRUE);
 }
 
-/* No properties are implemented, so only a warning is produced */
+static void
+gst_bayer2rgb_finalize (GObject * object)
+{
+  GstBayer2RGB *filter = GST_BAYER2RGB (object);
+
+  if (filter->pool)
+    g_thread_pool_free (filter->pool, FALSE, TRUE);
+  g_mutex_clear (&filter->band_lock);
+  g_cond_clear (&filter->band_cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_bayer2rgb_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
 {
+  GstBayer2RGB *filter = GST_BAYER2RGB (object);
 
   switch (prop_id) {
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (filter);
+      filter->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (filter);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -223,14 +297,152 @@ static void
 gst_bayer2rgb_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec)
 {
+  GstBayer2RGB *filter = GST_BAYER2RGB (object);
 
   switch (prop_id) {
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (filter);
+      g_value_set_uint (value, filter->n_threads);
+      GST_OBJECT_UNLOCK (filter);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+/* Parses a bayer format string like "bggr" or "rggb12le" */
+static gboolean
+gst_bayer2rgb_parse_format (const char *format, int *order, int *bits,
+    gboolean * big_endian)
+{
+  if (format == NULL)
+    return FALSE;
+
+  if (g_str_has_prefix (format, "bggr")) {
+    *order = GST_BAYER_2_RGB_FORMAT_BGGR;
+  } else if (g_str_has_prefix (format, "gbrg")) {
+    *order = GST_BAYER_2_RGB_FORMAT_GBRG;
+  } else if (g_str_has_prefix (format, "grbg")) {
+    *order = GST_BAYER_2_RGB_FORMAT_GRBG;
+  } else if (g_str_has_prefix (format, "rggb")) {
+    *order = GST_BAYER_2_RGB_FORMAT_RGGB;
+  } else {
+    return FALSE;
+  }
+
+  format += 4;
+  if (*format == '\0') {
+    *bits = 8;
+    *big_endian = FALSE;
+    return TRUE;
+  }
+
+  if (strlen (format) != 4 || !g_ascii_isdigit (format[0]) ||
+      !g_ascii_isdigit (format[1]))
+    return FALSE;
+
+  *bits = (format[0] - '0') * 10 + (format[1] - '0');
+  if (*bits != 10 && *bits != 12 && *bits != 14 && *bits != 16)
+    return FALSE;
+
+  if (g_str_equal (format + 2, "le"))
+    *big_endian = FALSE;
+  else if (g_str_equal (format + 2, "be"))
+    *big_endian = TRUE;
+  else
+    return FALSE;
+
+  return TRUE;
+}
+
+static int
+gst_bayer2rgb_get_stride (int width, int bits)
+{
+  return GST_ROUND_UP_4 (width) * (bits > 8 ? 2 : 1);
+}
+
+static gboolean
+gst_bayer2rgb_setup_merge (GstBayer2RGB * bayer2rgb)
+{
+  process_func merge[2] = { NULL, NULL };
+  int r_off, g_off, b_off;
+
+  /* We exploit some symmetry in the functions here.  The base functions
+   * are all named for the BGGR arrangement.  For RGGB, we swap the
+   * red offset and blue offset in the output.  For GRBG, we swap the
+   * order of the merge functions.  For GBRG, do both. */
+  r_off = bayer2rgb->r_off;
+  g_off = bayer2rgb->g_off;
+  b_off = bayer2rgb->b_off;
+  if (bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_RGGB ||
+      bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_GBRG) {
+    r_off = bayer2rgb->b_off;
+    b_off = bayer2rgb->r_off;
+  }
+
+  if (r_off == 2 && g_off == 1 && b_off == 0) {
+    merge[0] = bayer_orc_merge_bg_bgra;
+    merge[1] = bayer_orc_merge_gr_bgra;
+  } else if (r_off == 3 && g_off == 2 && b_off == 1) {
+    merge[0] = bayer_orc_merge_bg_abgr;
+    merge[1] = bayer_orc_merge_gr_abgr;
+  } else if (r_off == 1 && g_off == 2 && b_off == 3) {
+    merge[0] = bayer_orc_merge_bg_argb;
+    merge[1] = bayer_orc_merge_gr_argb;
+  } else if (r_off == 0 && g_off == 1 && b_off == 2) {
+    merge[0] = bayer_orc_merge_bg_rgba;
+    merge[1] = bayer_orc_merge_gr_rgba;
+  }
+  if (bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_GRBG ||
+      bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_GBRG) {
+    process_func tmp = merge[0];
+    merge[0] = merge[1];
+    merge[1] = tmp;
+  }
+
+  bayer2rgb->merge[0] = merge[0];
+  bayer2rgb->merge[1] = merge[1];
+
+  return merge[0] != NULL;
+}
+
+/* Sets up the RGB to YUV matrix for the colorimetry of the output caps */
+static void
+gst_bayer2rgb_setup_yuv (GstBayer2RGB * bayer2rgb)
+{
+  GstVideoColorimetry *cinfo = &GST_VIDEO_INFO_COLORIMETRY (&bayer2rgb->info);
+  gdouble Kr, Kb, Kg, y_scale, c_scale;
+  int y_base;
+
+  if (!gst_video_color_matrix_get_Kr_Kb (cinfo->matrix, &Kr, &Kb))
+    gst_video_color_matrix_get_Kr_Kb (GST_VIDEO_COLOR_MATRIX_BT601, &Kr, &Kb);
+  Kg = 1.0 - Kr - Kb;
+
+  if (cinfo->range == GST_VIDEO_COLOR_RANGE_0_255) {
+    y_base = 0;
+    y_scale = 1.0;
+    c_scale = 1.0;
+  } else {
+    y_base = 16;
+    y_scale = 219.0 / 255.0;
+    c_scale = 224.0 / 255.0;
+  }
+
+#define FIXED(v) ((gint) ((v) * 65536.0 + ((v) < 0 ? -0.5 : 0.5)))
+  bayer2rgb->y_coef[0] = FIXED (y_scale * Kr);
+  bayer2rgb->y_coef[1] = FIXED (y_scale * Kg);
+  bayer2rgb->y_coef[2] = FIXED (y_scale * Kb);
+  bayer2rgb->u_coef[0] = FIXED (-c_scale * Kr / (2.0 * (1.0 - Kb)));
+  bayer2rgb->u_coef[1] = FIXED (-c_scale * Kg / (2.0 * (1.0 - Kb)));
+  bayer2rgb->u_coef[2] = FIXED (c_scale / 2.0);
+  bayer2rgb->v_coef[0] = FIXED (c_scale / 2.0);
+  bayer2rgb->v_coef[1] = FIXED (-c_scale * Kg / (2.0 * (1.0 - Kr)));
+  bayer2rgb->v_coef[2] = FIXED (-c_scale * Kb / (2.0 * (1.0 - Kr)));
+#undef FIXED
+  bayer2rgb->y_offset = (y_base << 16) + (1 << 15);
+}
+
 static gboolean
 gst_bayer2rgb_set_caps (GstBaseTransform * base, GstCaps * incaps,
     GstCaps * outcaps)
@@ -249,27 +461,32 @@ gst_bayer2rgb_set_caps (GstBaseTransform * base, GstCaps * incaps,
   gst_structure_get_int (structure, "height", &bayer2rgb->height);
 
   format = gst_structure_get_string (structure, "format");
-  if (g_str_equal (format, "bggr")) {
-    bayer2rgb->format = GST_BAYER_2_RGB_FORMAT_BGGR;
-  } else if (g_str_equal (format, "gbrg")) {
-    bayer2rgb->format = GST_BAYER_2_RGB_FORMAT_GBRG;
-  } else if (g_str_equal (format, "grbg")) {
-    bayer2rgb->format = GST_BAYER_2_RGB_FORMAT_GRBG;
-  } else if (g_str_equal (format, "rggb")) {
-    bayer2rgb->format = GST_BAYER_2_RGB_FORMAT_RGGB;
-  } else {
+  if (!gst_bayer2rgb_parse_format (format, &bayer2rgb->format,
+          &bayer2rgb->bits, &bayer2rgb->big_endian)) {
     return FALSE;
   }
+  bayer2rgb->src_stride =
+      gst_bayer2rgb_get_stride (bayer2rgb->width, bayer2rgb->bits);
 
   /* To cater for different RGB formats, we need to set params for later */
-  gst_video_info_from_caps (&info, outcaps);
-  bayer2rgb->r_off = GST_VIDEO_INFO_COMP_OFFSET (&info, 0);
-  bayer2rgb->g_off = GST_VIDEO_INFO_COMP_OFFSET (&info, 1);
-  bayer2rgb->b_off = GST_VIDEO_INFO_COMP_OFFSET (&info, 2);
+  if (!gst_video_info_from_caps (&info, outcaps))
+    return FALSE;
 
   bayer2rgb->info = info;
 
-  return TRUE;
+  if (GST_VIDEO_INFO_IS_YUV (&info)) {
+    /* decode into RGBA lines that are converted to YUV afterwards */
+    bayer2rgb->r_off = 0;
+    bayer2rgb->g_off = 1;
+    bayer2rgb->b_off = 2;
+    gst_bayer2rgb_setup_yuv (bayer2rgb);
+  } else {
+    bayer2rgb->r_off = GST_VIDEO_INFO_COMP_OFFSET (&info, 0);
+    bayer2rgb->g_off = GST_VIDEO_INFO_COMP_OFFSET (&info, 1);
+    bayer2rgb->b_off = GST_VIDEO_INFO_COMP_OFFSET (&info, 2);
+  }
+
+  return gst_bayer2rgb_setup_merge (bayer2rgb);
 }
 
 static void
@@ -280,6 +497,10 @@ gst_bayer2rgb_reset (GstBayer2RGB * filter)
   filter->r_off = 0;
   filter->g_off = 0;
   filter->b_off = 0;
+  filter->bits = 8;
+  filter->big_endian = FALSE;
+  filter->src_stride = 0;
+  filter->merge[0] = filter->merge[1] = NULL;
   gst_video_info_init (&filter->info);
 }
 
@@ -334,12 +555,22 @@ gst_bayer2rgb_get_unit_size (GstBaseTransform * base, GstCaps * caps,
     name = gst_structure_get_name (structure);
     /* Our name must be either video/x-bayer video/x-raw */
     if (strcmp (name, "video/x-raw")) {
-      *size = GST_ROUND_UP_4 (width) * height;
+      int order, bits;
+      gboolean big_endian;
+
+      if (!gst_bayer2rgb_parse_format (gst_structure_get_string (structure,
+                  "format"), &order, &bits, &big_endian))
+        bits = 8;
+      *size = gst_bayer2rgb_get_stride (width, bits) * height;
       return TRUE;
     } else {
-      /* For output, calculate according to format (always 32 bits) */
-      *size = width * height * 4;
-      return TRUE;
+      GstVideoInfo info;
+
+      /* For output, calculate according to format */
+      if (gst_video_info_from_caps (&info, caps)) {
+        *size = GST_VIDEO_INFO_SIZE (&info);
+        return TRUE;
+      }
     }
 
   }
@@ -377,78 +608,239 @@ gst_bayer2rgb_split_and_upsample_horiz (guint8 * dest0, guint8 * dest1,
   }
 }
 
-typedef void (*process_func) (guint8 * d0, const guint8 * s0, const guint8 * s1,
-    const guint8 * s2, const guint8 * s3, const guint8 * s4, const guint8 * s5,
-    int n);
+/* Returns input row @row as 8 bit samples, converting into @line8 for
+ * deeper input. Rows outside the frame are mirrored so that they keep the
+ * bayer phase of the row they stand in for. */
+static const guint8 *
+gst_bayer2rgb_get_line (GstBayer2RGB * bayer2rgb, const guint8 * src,
+    int row, guint8 * line8)
+{
+  const guint8 *line;
+  int shift, i;
+
+  if (row < 0)
+    row = MIN (1, bayer2rgb->height - 1);
+  else if (row >= bayer2rgb->height)
+    row = MAX (bayer2rgb->height - 2, 0);
+
+  line = src + row * bayer2rgb->src_stride;
+  if (bayer2rgb->bits == 8)
+    return line;
+
+  shift = bayer2rgb->bits - 8;
+  if (bayer2rgb->big_endian) {
+    for (i = 0; i < bayer2rgb->width; i++)
+      line8[i] = MIN (GST_READ_UINT16_BE (line + 2 * i) >> shift, 255);
+  } else {
+    for (i = 0; i < bayer2rgb->width; i++)
+      line8[i] = MIN (GST_READ_UINT16_LE (line + 2 * i) >> shift, 255);
+  }
+
+  return line8;
+}
 
+/* Converts two RGBA lines to the YUV lines @y and @y + 1 of @frame. When
+ * @rgba0 and @rgba1 are the same only line @y is written. */
 static void
-gst_bayer2rgb_process (GstBayer2RGB * bayer2rgb, uint8_t * dest,
-    int dest_stride, uint8_t * src, int src_stride)
+gst_bayer2rgb_rgba_to_yuv (GstBayer2RGB * bayer2rgb, GstVideoFrame * frame,
+    const guint8 * rgba0, const guint8 * rgba1, int y)
 {
-  int j;
-  guint8 *tmp;
-  process_func merge[2] = { NULL, NULL };
-  int r_off, g_off, b_off;
-
-  /* We exploit some symmetry in the functions here.  The base functions
-   * are all named for the BGGR arrangement.  For RGGB, we swap the
-   * red offset and blue offset in the output.  For GRBG, we swap the
-   * order of the merge functions.  For GBRG, do both. */
-  r_off = bayer2rgb->r_off;
-  g_off = bayer2rgb->g_off;
-  b_off = bayer2rgb->b_off;
-  if (bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_RGGB ||
-      bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_GBRG) {
-    r_off = bayer2rgb->b_off;
-    b_off = bayer2rgb->r_off;
+  const gint *yc = bayer2rgb->y_coef;
+  const gint *uc = bayer2rgb->u_coef;
+  const gint *vc = bayer2rgb->v_coef;
+  gint y_offset = bayer2rgb->y_offset;
+  gint c_offset = (128 << 18) + (1 << 17);
+  int width = bayer2rgb->width;
+  guint8 *y0, *y1, *u, *v;
+  int x, cx, c_width, u_pstride;
+
+  y0 = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (frame, 0) +
+      y * GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
+  y1 = y0 + GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
+  u = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (frame, 1) +
+      (y >> 1) * GST_VIDEO_FRAME_COMP_STRIDE (frame, 1);
+  v = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (frame, 2) +
+      (y >> 1) * GST_VIDEO_FRAME_COMP_STRIDE (frame, 2);
+  u_pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (frame, 1);
+  c_width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 1);
+
+  for (x = 0; x < width; x++) {
+    const guint8 *p = rgba0 + 4 * x;
+
+    y0[x] = CLAMP ((yc[0] * p[0] + yc[1] * p[1] + yc[2] * p[2] +
+            y_offset) >> 16, 0, 255);
   }
+  if (rgba1 != rgba0) {
+    for (x = 0; x < width; x++) {
+      const guint8 *p = rgba1 + 4 * x;
 
-  if (r_off == 2 && g_off == 1 && b_off == 0) {
-    merge[0] = bayer_orc_merge_bg_bgra;
-    merge[1] = bayer_orc_merge_gr_bgra;
-  } else if (r_off == 3 && g_off == 2 && b_off == 1) {
-    merge[0] = bayer_orc_merge_bg_abgr;
-    merge[1] = bayer_orc_merge_gr_abgr;
-  } else if (r_off == 1 && g_off == 2 && b_off == 3) {
-    merge[0] = bayer_orc_merge_bg_argb;
-    merge[1] = bayer_orc_merge_gr_argb;
-  } else if (r_off == 0 && g_off == 1 && b_off == 2) {
-    merge[0] = bayer_orc_merge_bg_rgba;
-    merge[1] = bayer_orc_merge_gr_rgba;
+      y1[x] = CLAMP ((yc[0] * p[0] + yc[1] * p[1] + yc[2] * p[2] +
+              y_offset) >> 16, 0, 255);
+    }
   }
-  if (bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_GRBG ||
-      bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_GBRG) {
-    process_func tmp = merge[0];
-    merge[0] = merge[1];
-    merge[1] = tmp;
+
+  for (cx = 0; cx < c_width; cx++) {
+    int x0 = 2 * cx;
+    int x1 = MIN (x0 + 1, width - 1);
+    int r, g, b;
+
+    r = rgba0[4 * x0 + 0] + rgba0[4 * x1 + 0] + rgba1[4 * x0 + 0] +
+        rgba1[4 * x1 + 0];
+    g = rgba0[4 * x0 + 1] + rgba0[4 * x1 + 1] + rgba1[4 * x0 + 1] +
+        rgba1[4 * x1 + 1];
+    b = rgba0[4 * x0 + 2] + rgba0[4 * x1 + 2] + rgba1[4 * x0 + 2] +
+        rgba1[4 * x1 + 2];
+
+    u[cx * u_pstride] =
+        CLAMP ((uc[0] * r + uc[1] * g + uc[2] * b + c_offset) >> 18, 0, 255);
+    v[cx * u_pstride] =
+        CLAMP ((vc[0] * r + vc[1] * g + vc[2] * b + c_offset) >> 18, 0, 255);
   }
+}
+
+/* Decodes output lines [@y_start, @y_end). The lines just outside the band
+ * are read from the input as well, so bands can be processed independently
+ * and give the same result as a single pass over the frame. */
+static void
+gst_bayer2rgb_process (GstBayer2RGB * bayer2rgb, GstVideoFrame * frame,
+    const guint8 * src, int y_start, int y_end)
+{
+  int j;
+  int width = bayer2rgb->width;
+  guint8 *tmp, *line8 = NULL, *rgba = NULL;
+  guint8 *dest;
+  int dest_stride;
+  gboolean yuv = GST_VIDEO_INFO_IS_YUV (&bayer2rgb->info);
 
-  tmp = g_malloc (2 * 4 * bayer2rgb->width);
-#define LINE(x) (tmp + ((x)&7) * bayer2rgb->width)
+  dest = GST_VIDEO_FRAME_PLANE_DATA (frame, 0);
+  dest_stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
 
-  gst_bayer2rgb_split_and_upsample_horiz (LINE (3 * 2 + 0), LINE (3 * 2 + 1),
-      src + 1 * src_stride, bayer2rgb->width);
-  j = 0;
-  gst_bayer2rgb_split_and_upsample_horiz (LINE (j * 2 + 0), LINE (j * 2 + 1),
-      src + j * src_stride, bayer2rgb->width);
+  tmp = g_malloc (2 * 4 * width);
+  if (bayer2rgb->bits > 8)
+    line8 = g_malloc (width);
+  if (yuv)
+    rgba = g_malloc (2 * 4 * width);
 
-  for (j = 0; j < bayer2rgb->height; j++) {
-    if (j < bayer2rgb->height - 1) {
-      gst_bayer2rgb_split_and_upsample_horiz (LINE ((j + 1) * 2 + 0),
-          LINE ((j + 1) * 2 + 1), src + (j + 1) * src_stride, bayer2rgb->width);
-    }
+#define LINE(x) (tmp + ((x)&7) * width)
+#define UPSAMPLE(j) \
+  gst_bayer2rgb_split_and_upsample_horiz (LINE ((j) * 2 + 0), \
+      LINE ((j) * 2 + 1), \
+      gst_bayer2rgb_get_line (bayer2rgb, src, (j), line8), width)
+
+  UPSAMPLE (y_start - 1);
+  UPSAMPLE (y_start);
 
-    merge[j & 1] (dest + j * dest_stride,
+  for (j = y_start; j < y_end; j++) {
+    guint8 *out;
+
+    UPSAMPLE (j + 1);
+
+    if (yuv)
+      out = rgba + (j & 1) * 4 * width;
+    else
+      out = dest + j * dest_stride;
+
+    bayer2rgb->merge[j & 1] (out,
         LINE (j * 2 - 2), LINE (j * 2 - 1),
         LINE (j * 2 + 0), LINE (j * 2 + 1),
-        LINE (j * 2 + 2), LINE (j * 2 + 3), bayer2rgb->width >> 1);
+        LINE (j * 2 + 2), LINE (j * 2 + 3), width >> 1);
+
+    /* bands start on even lines so both lines of a chroma line are
+     * decoded by the same band */
+    if (yuv && (j & 1))
+      gst_bayer2rgb_rgba_to_yuv (bayer2rgb, frame, rgba, rgba + 4 * width,
+          j - 1);
+    else if (yuv && j == bayer2rgb->height - 1)
+      gst_bayer2rgb_rgba_to_yuv (bayer2rgb, frame, rgba, rgba, j);
   }
+#undef UPSAMPLE
+#undef LINE
 
+  g_free (rgba);
+  g_free (line8);
   g_free (tmp);
 }
 
+typedef struct
+{
+  GstBayer2RGB *bayer2rgb;
+  GstVideoFrame *frame;
+  const guint8 *src;
+  int y_start;
+  int y_end;
+} GstBayer2RGBBand;
+
+static void
+gst_bayer2rgb_band_func (gpointer data, gpointer user_data)
+{
+  GstBayer2RGBBand *band = data;
+  GstBayer2RGB *bayer2rgb = user_data;
+
+  gst_bayer2rgb_process (bayer2rgb, band->frame, band->src, band->y_start,
+      band->y_end);
+
+  g_mutex_lock (&bayer2rgb->band_lock);
+  if (--bayer2rgb->bands_pending == 0)
+    g_cond_signal (&bayer2rgb->band_cond);
+  g_mutex_unlock (&bayer2rgb->band_lock);
+}
+
+static void
+gst_bayer2rgb_process_frame (GstBayer2RGB * bayer2rgb, GstVideoFrame * frame,
+    const guint8 * src)
+{
+  GstBayer2RGBBand *bands;
+  int i, n_bands;
+
+  GST_OBJECT_LOCK (bayer2rgb);
+  n_bands = bayer2rgb->n_threads;
+  GST_OBJECT_UNLOCK (bayer2rgb);
+
+  if (n_bands == 0)
+    n_bands = g_get_num_processors ();
+  /* every band reads two extra input lines, don't make them too small */
+  n_bands = CLAMP (n_bands, 1, MAX (bayer2rgb->height / 32, 1));
+
+  if (n_bands > 1 && bayer2rgb->pool == NULL) {
+    bayer2rgb->pool = g_thread_pool_new (gst_bayer2rgb_band_func, bayer2rgb,
+        n_bands - 1, FALSE, NULL);
+  } else if (n_bands > 1 &&
+      g_thread_pool_get_max_threads (bayer2rgb->pool) != n_bands - 1) {
+    g_thread_pool_set_max_threads (bayer2rgb->pool, n_bands - 1, NULL);
+  }
+
+  if (n_bands == 1 || bayer2rgb->pool == NULL) {
+    gst_bayer2rgb_process (bayer2rgb, frame, src, 0, bayer2rgb->height);
+    return;
+  }
 
+  bands = g_newa (GstBayer2RGBBand, n_bands);
+
+  g_mutex_lock (&bayer2rgb->band_lock);
+  bayer2rgb->bands_pending = n_bands - 1;
+  g_mutex_unlock (&bayer2rgb->band_lock);
+
+  for (i = 0; i < n_bands; i++) {
+    bands[i].bayer2rgb = bayer2rgb;
+    bands[i].frame = frame;
+    bands[i].src = src;
+    /* keep the bayer phase and the chroma lines aligned */
+    bands[i].y_start = (bayer2rgb->height * i / n_bands) & ~1;
+    bands[i].y_end = i == n_bands - 1 ? bayer2rgb->height :
+        (bayer2rgb->height * (i + 1) / n_bands) & ~1;
+    if (i > 0)
+      g_thread_pool_push (bayer2rgb->pool, &bands[i], NULL);
+  }
 
+  /* the streaming thread decodes the first band itself */
+  gst_bayer2rgb_process (bayer2rgb, frame, src, bands[0].y_start,
+      bands[0].y_end);
+
+  g_mutex_lock (&bayer2rgb->band_lock);
+  while (bayer2rgb->bands_pending > 0)
+    g_cond_wait (&bayer2rgb->band_cond, &bayer2rgb->band_lock);
+  g_mutex_unlock (&bayer2rgb->band_lock);
+}
 
 static GstFlowReturn
 gst_bayer2rgb_transform (GstBaseTransform * base, GstBuffer * inbuf,
@@ -456,7 +848,6 @@ gst_bayer2rgb_transform (GstBaseTransform * base, GstBuffer * inbuf,
 {
   GstBayer2RGB *filter = GST_BAYER2RGB (base);
   GstMapInfo map;
-  uint8_t *output;
   GstVideoFrame frame;
 
   GST_DEBUG ("transforming buffer");
@@ -469,9 +860,7 @@ gst_bayer2rgb_transform (GstBaseTransform * base, GstBuffer * inbuf,
     goto map_failed;
   }
 
-  output = GST_VIDEO_FRAME_PLANE_DATA (&frame, 0);
-  gst_bayer2rgb_process (filter, output, frame.info.stride[0],
-      map.data, GST_ROUND_UP_4 (filter->width));
+  gst_bayer2rgb_process_frame (filter, &frame, map.data);
 
   gst_video_frame_unmap (&frame);
   gst_buffer_unmap (inbuf, &map);
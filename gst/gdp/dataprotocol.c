@@ -132,29 +132,31 @@ G_STMT_START {							\
 #define POLY       0x1021
 #define CRC_INIT   0xFFFF
 
+/* pre-initialised buffer packet headers, indexed by GstDPHeaderFlag */
+static guint8 gst_dp_buffer_header_template[4][GST_DP_HEADER_LENGTH];
+
+static void gst_dp_init_tables (void);
 static guint16 gst_dp_crc (const guint8 * buffer, guint length);
 static guint16 gst_dp_crc_from_memory_maps (const GstMapInfo * maps,
     guint n_maps);
 
 /* payloading functions */
 
-GstBuffer *
-gst_dp_payload_buffer (GstBuffer * buffer, GstDPHeaderFlag flags)
+/* Fill in a complete buffer packet header for @buffer at @h, starting from
+ * the pre-initialised template for @flags */
+static void
+gst_dp_write_buffer_header (guint8 * h, GstBuffer * buffer,
+    GstDPHeaderFlag flags)
 {
-  GstBuffer *ret_buf;
-  GstMapInfo map;
-  GstMemory *mem;
-  guint8 *h;
   guint16 flags_mask;
   guint16 header_crc = 0, crc = 0;
   gsize buffer_size;
 
-  mem = gst_allocator_alloc (NULL, GST_DP_HEADER_LENGTH, NULL);
-  gst_memory_map (mem, &map, GST_MAP_READWRITE);
-  h = memset (map.data, 0, map.size);
+  gst_dp_init_tables ();
 
   /* version, flags, type */
-  GST_DP_INIT_HEADER (h, GST_DP_VERSION_1_0, flags, GST_DP_PAYLOAD_BUFFER);
+  memcpy (h, gst_dp_buffer_header_template[flags & GST_DP_HEADER_FLAG_CRC],
+      GST_DP_HEADER_LENGTH);
 
   if ((flags & GST_DP_HEADER_FLAG_CRC_PAYLOAD)) {
     GstMapInfo *maps;
@@ -213,6 +215,18 @@ gst_dp_payload_buffer (GstBuffer * buffer, GstDPHeaderFlag flags)
   GST_WRITE_UINT16_BE (h + 60, crc);
 
   GST_MEMDUMP ("payload header for buffer", h, GST_DP_HEADER_LENGTH);
+}
+
+GstBuffer *
+gst_dp_payload_buffer (GstBuffer * buffer, GstDPHeaderFlag flags)
+{
+  GstBuffer *ret_buf;
+  GstMapInfo map;
+  GstMemory *mem;
+
+  mem = gst_allocator_alloc (NULL, GST_DP_HEADER_LENGTH, NULL);
+  gst_memory_map (mem, &map, GST_MAP_WRITE);
+  gst_dp_write_buffer_header (map.data, buffer, flags);
   gst_memory_unmap (mem, &map);
 
   ret_buf = gst_buffer_new ();
@@ -224,6 +238,55 @@ gst_dp_payload_buffer (GstBuffer * buffer, GstDPHeaderFlag flags)
   return gst_buffer_append (ret_buf, gst_buffer_ref (buffer));
 }
 
+/**
+ * gst_dp_payload_buffer_list:
+ * @list: a #GstBufferList
+ * @flags: the #GstDPHeaderFlag to use for the headers
+ *
+ * Payloads all buffers in @list, as gst_dp_payload_buffer() would. The
+ * headers of all packets are written into a single memory block, each
+ * returned buffer referencing its own slice of it followed by the payload
+ * data of the corresponding input buffer.
+ *
+ * Returns: (transfer full): a new #GstBufferList with one GDP buffer for
+ * every buffer in @list.
+ */
+GstBufferList *
+gst_dp_payload_buffer_list (GstBufferList * list, GstDPHeaderFlag flags)
+{
+  GstBufferList *ret_list;
+  GstMapInfo map;
+  GstMemory *mem;
+  guint i, len;
+
+  len = gst_buffer_list_length (list);
+  ret_list = gst_buffer_list_new_sized (len);
+  if (len == 0)
+    return ret_list;
+
+  mem = gst_allocator_alloc (NULL, len * GST_DP_HEADER_LENGTH, NULL);
+  gst_memory_map (mem, &map, GST_MAP_WRITE);
+  for (i = 0; i < len; i++) {
+    gst_dp_write_buffer_header (map.data + i * GST_DP_HEADER_LENGTH,
+        gst_buffer_list_get (list, i), flags);
+  }
+  gst_memory_unmap (mem, &map);
+
+  for (i = 0; i < len; i++) {
+    GstBuffer *ret_buf;
+
+    ret_buf = gst_buffer_new ();
+    gst_buffer_append_memory (ret_buf,
+        gst_memory_share (mem, i * GST_DP_HEADER_LENGTH, GST_DP_HEADER_LENGTH));
+    ret_buf = gst_buffer_append (ret_buf,
+        gst_buffer_ref (gst_buffer_list_get (list, i)));
+    gst_buffer_list_add (ret_list, ret_buf);
+  }
+  gst_memory_unref (mem);
+
+  return ret_list;
+}
+
 GstBuffer *
 gst_dp_payload_caps (const GstCaps * caps, GstDPHeaderFlag flags)
 {
@@ -365,6 +428,64 @@ static const guint16 gst_dp_crc_table[256] = {
   0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0
 };
 
+/* the same table extended for processing four bytes per iteration
+ * ("slicing-by-4"), entry [k][x] is the CRC of byte x followed by k zero
+ * bytes. Filled in by gst_dp_init_tables() from gst_dp_crc_table. */
+static guint16 gst_dp_crc_slice_table[4][256];
+
+static inline guint16
+gst_dp_crc_update (guint16 crc_register, const guint8 * buffer, gsize length)
+{
+  while (length >= 4) {
+    crc_register = gst_dp_crc_slice_table[3][(crc_register >> 8) ^ buffer[0]] ^
+        gst_dp_crc_slice_table[2][(crc_register & 0xff) ^ buffer[1]] ^
+        gst_dp_crc_slice_table[1][buffer[2]] ^
+        gst_dp_crc_slice_table[0][buffer[3]];
+    buffer += 4;
+    length -= 4;
+  }
+
+  while (length-- > 0) {
+    crc_register = (guint16) ((crc_register << 8) ^
+        gst_dp_crc_table[((crc_register >> 8) & 0x00ff) ^ *buffer++]);
+  }
+
+  return crc_register;
+}
+
+/* fill in the CRC slice table and the buffer header templates; cheap to
+ * call repeatedly */
+static void
+gst_dp_init_tables (void)
+{
+  static gsize initialized = 0;
+
+  if (g_once_init_enter (&initialized)) {
+    guint i, k, flags;
+
+    for (i = 0; i < 256; i++)
+      gst_dp_crc_slice_table[0][i] = gst_dp_crc_table[i];
+
+    for (k = 1; k < 4; k++) {
+      for (i = 0; i < 256; i++) {
+        guint16 prev = gst_dp_crc_slice_table[k - 1][i];
+
+        gst_dp_crc_slice_table[k][i] =
+            (guint16) ((prev << 8) ^ gst_dp_crc_table[prev >> 8]);
+      }
+    }
+
+    for (flags = 0; flags <= GST_DP_HEADER_FLAG_CRC; flags++) {
+      guint8 *h = gst_dp_buffer_header_template[flags];
+
+      memset (h, 0, GST_DP_HEADER_LENGTH);
+      GST_DP_INIT_HEADER (h, GST_DP_VERSION_1_0, flags, GST_DP_PAYLOAD_BUFFER);
+    }
+
+    g_once_init_leave (&initialized, 1);
+  }
+}
+
 /**
  * gst_dp_crc:
  * @buffer: array of bytes
@@ -379,18 +500,18 @@ static const guint16 gst_dp_crc_table[256] = {
 static guint16
 gst_dp_crc (const guint8 * buffer, guint length)
 {
-  guint16 crc_register = CRC_INIT;
+  guint16 crc_register;
 
   if (length == 0)
     return 0;
 
   g_assert (buffer != NULL);
 
+  gst_dp_init_tables ();
+
   /* calc CRC */
-  for (; length--;) {
-    crc_register = (guint16) ((crc_register << 8) ^
-        gst_dp_crc_table[((crc_register >> 8) & 0x00ff) ^ *buffer++]);
-  }
+  crc_register = gst_dp_crc_update (CRC_INIT, buffer, length);
+
   return (0xffff ^ crc_register);
 }
 
@@ -405,17 +526,12 @@ gst_dp_crc_from_memory_maps (const GstMapInfo * maps, guint n_maps)
 
   g_assert (maps != NULL);
 
+  gst_dp_init_tables ();
+
   /* calc CRC */
   while (n_maps > 0) {
-    guint8 *buffer = maps->data;
-    gsize length = maps->size;
-
-    total_length += length;
-
-    while (length-- > 0) {
-      crc_register = (guint16) ((crc_register << 8) ^
-          gst_dp_crc_table[((crc_register >> 8) & 0x00ff) ^ *buffer++]);
-    }
+    total_length += maps->size;
+    crc_register = gst_dp_crc_update (crc_register, maps->data, maps->size);
     --n_maps;
     ++maps;
   }
@@ -439,6 +555,8 @@ gst_dp_init (void)
 {
   GST_DEBUG_CATEGORY_INIT (data_protocol_debug, "gdp", 0,
       "GStreamer Data Protocol");
+
+  gst_dp_init_tables ();
 }
 
 /**
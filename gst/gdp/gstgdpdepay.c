@@ -39,13 +39,17 @@
 #include <string.h>
 
 #include "dataprotocol.h"
+#include "dp-private.h"
 
 #include "gstgdpdepay.h"
 
+#define DEFAULT_VALIDATE_CRC TRUE
+
 enum
 {
   PROP_0,
-  PROP_TS_OFFSET
+  PROP_TS_OFFSET,
+  PROP_VALIDATE_CRC
 };
 
 static GstStaticPadTemplate gdp_depay_sink_template =
@@ -77,6 +81,8 @@ static gboolean gst_gdp_depay_src_event (GstPad * pad, GstObject * parent,
 
 static GstFlowReturn gst_gdp_depay_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buffer);
+static GstFlowReturn gst_gdp_depay_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 
 static GstStateChangeReturn gst_gdp_depay_change_state (GstElement *
     element, GstStateChange transition);
@@ -106,6 +112,20 @@ gst_gdp_depay_class_init (GstGDPDepayClass * klass)
           G_MININT64, G_MAXINT64, 0,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstGDPDepay:validate-crc:
+   *
+   * Whether to validate the header and payload CRC checksums of incoming
+   * packets, if the sender included them. Disabling this saves a pass over
+   * every packet on trusted links.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_VALIDATE_CRC,
+      g_param_spec_boolean ("validate-crc", "Validate CRC",
+          "Validate the CRC checksums of incoming packets when present",
+          DEFAULT_VALIDATE_CRC, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (gstelement_class,
       "GDP Depayloader", "GDP/Depayloader",
       "Depayloads GStreamer Data Protocol buffers",
@@ -128,6 +148,8 @@ gst_gdp_depay_init (GstGDPDepay * gdpdepay)
       gst_pad_new_from_static_template (&gdp_depay_sink_template, "sink");
   gst_pad_set_chain_function (gdpdepay->sinkpad,
       GST_DEBUG_FUNCPTR (gst_gdp_depay_chain));
+  gst_pad_set_chain_list_function (gdpdepay->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_gdp_depay_chain_list));
   gst_pad_set_event_function (gdpdepay->sinkpad,
       GST_DEBUG_FUNCPTR (gst_gdp_depay_sink_event));
   gst_element_add_pad (GST_ELEMENT (gdpdepay), gdpdepay->sinkpad);
@@ -141,6 +163,7 @@ gst_gdp_depay_init (GstGDPDepay * gdpdepay)
   gst_element_add_pad (GST_ELEMENT (gdpdepay), gdpdepay->srcpad);
 
   gdpdepay->adapter = gst_adapter_new ();
+  gdpdepay->validate_crc = DEFAULT_VALIDATE_CRC;
 
   gdpdepay->allocator = NULL;
   gst_allocation_params_init (&gdpdepay->allocation_params);
@@ -175,6 +198,9 @@ gst_gdp_depay_set_property (GObject * object, guint prop_id,
     case PROP_TS_OFFSET:
       this->ts_offset = g_value_get_int64 (value);
       break;
+    case PROP_VALIDATE_CRC:
+      this->validate_crc = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -193,6 +219,9 @@ gst_gdp_depay_get_property (GObject * object, guint prop_id,
     case PROP_TS_OFFSET:
       g_value_set_int64 (value, this->ts_offset);
       break;
+    case PROP_VALIDATE_CRC:
+      g_value_set_boolean (value, this->validate_crc);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -259,18 +288,33 @@ gst_gdp_depay_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
   return res;
 }
 
+/* push out the buffers collected while handling a buffer list */
 static GstFlowReturn
-gst_gdp_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+gst_gdp_depay_push_pending (GstGDPDepay * this)
+{
+  GstBufferList *list;
+
+  if (this->pending == NULL || gst_buffer_list_length (this->pending) == 0)
+    return GST_FLOW_OK;
+
+  list = this->pending;
+  this->pending = gst_buffer_list_new ();
+
+  GST_LOG_OBJECT (this, "pushing list of %u depayloaded buffers",
+      gst_buffer_list_length (list));
+
+  return gst_pad_push_list (this->srcpad, list);
+}
+
+static GstFlowReturn
+gst_gdp_depay_process (GstGDPDepay * this, GstBuffer * buffer)
 {
-  GstGDPDepay *this;
   GstFlowReturn ret = GST_FLOW_OK;
   GstCaps *caps;
   GstBuffer *buf;
   GstEvent *event;
   guint available;
 
-  this = GST_GDP_DEPAY (parent);
-
   if (gst_pad_check_reconfigure (this->srcpad)) {
     gst_gdp_depay_decide_allocation (this);
   }
@@ -298,7 +342,8 @@ gst_gdp_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 
         GST_LOG_OBJECT (this, "reading GDP header from adapter");
         header = gst_adapter_take (this->adapter, GST_DP_HEADER_LENGTH);
-        if (!gst_dp_validate_header (GST_DP_HEADER_LENGTH, header)) {
+        if (this->validate_crc
+            && !gst_dp_validate_header (GST_DP_HEADER_LENGTH, header)) {
           g_free (header);
           goto header_validate_error;
         }
@@ -340,7 +385,11 @@ gst_gdp_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
           goto wrong_type;
         }
 
-        if (this->payload_length) {
+        /* only map the payload if there is a CRC to check, mapping may
+         * need to merge the memory in the adapter */
+        if (this->payload_length && this->validate_crc
+            && (GST_DP_HEADER_FLAGS (this->header) &
+                GST_DP_HEADER_FLAG_CRC_PAYLOAD)) {
           const guint8 *data;
           gboolean res;
 
@@ -399,7 +448,10 @@ gst_gdp_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
             GST_TIME_ARGS (GST_BUFFER_DURATION (buf)),
             GST_BUFFER_OFFSET (buf), GST_BUFFER_OFFSET_END (buf),
             gst_buffer_get_size (buf), GST_BUFFER_FLAGS (buf));
-        ret = gst_pad_push (this->srcpad, buf);
+        if (this->pending)
+          gst_buffer_list_add (this->pending, buf);
+        else
+          ret = gst_pad_push (this->srcpad, buf);
         if (ret != GST_FLOW_OK)
           goto push_error;
 
@@ -411,6 +463,11 @@ gst_gdp_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
       {
         guint8 *payload;
 
+        /* buffers collected so far were negotiated with the old caps */
+        ret = gst_gdp_depay_push_pending (this);
+        if (ret != GST_FLOW_OK)
+          goto push_error;
+
         /* take the payload of the caps */
         GST_LOG_OBJECT (this, "reading GDP caps from adapter");
         payload = gst_adapter_take (this->adapter, this->payload_length);
@@ -421,6 +478,7 @@ gst_gdp_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
           goto caps_failed;
 
         GST_DEBUG_OBJECT (this, "deserialized caps %" GST_PTR_FORMAT, caps);
+
         gst_caps_replace (&(this->caps), caps);
         gst_pad_set_caps (this->srcpad, caps);
         gst_gdp_depay_decide_allocation (this);
@@ -435,6 +493,11 @@ gst_gdp_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
       {
         guint8 *payload;
 
+        /* keep events in order with the buffers collected so far */
+        ret = gst_gdp_depay_push_pending (this);
+        if (ret != GST_FLOW_OK)
+          goto push_error;
+
         GST_LOG_OBJECT (this, "reading GDP event from adapter");
 
         /* adapter doesn't like 0 length payload */
@@ -450,6 +513,7 @@ gst_gdp_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 
         GST_DEBUG_OBJECT (this, "deserialized event %p of type %s, pushing",
             event, gst_event_type_get_name (event->type));
+
         gst_pad_push_event (this->srcpad, event);
 
         GST_LOG_OBJECT (this, "switching to state HEADER");
@@ -519,6 +583,42 @@ event_failed:
   }
 }
 
+static GstFlowReturn
+gst_gdp_depay_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  return gst_gdp_depay_process (GST_GDP_DEPAY (parent), buffer);
+}
+
+/* all buffers depayloaded from a list are pushed downstream as a list too,
+ * unless a caps or event packet needs to go out in between */
+static GstFlowReturn
+gst_gdp_depay_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstGDPDepay *this = GST_GDP_DEPAY (parent);
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint i, len;
+
+  this->pending = gst_buffer_list_new ();
+
+  len = gst_buffer_list_length (list);
+  for (i = 0; i < len; i++) {
+    ret = gst_gdp_depay_process (this,
+        gst_buffer_ref (gst_buffer_list_get (list, i)));
+    if (ret != GST_FLOW_OK)
+      break;
+  }
+  gst_buffer_list_unref (list);
+
+  if (ret == GST_FLOW_OK)
+    ret = gst_gdp_depay_push_pending (this);
+
+  gst_buffer_list_unref (this->pending);
+  this->pending = NULL;
+
+  return ret;
+}
+
 static GstStateChangeReturn
 gst_gdp_depay_change_state (GstElement * element, GstStateChange transition)
 {
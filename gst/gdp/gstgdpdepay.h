@@ -68,6 +68,10 @@ struct _GstGDPDepay
   GstDPPayloadType payload_type;
 
   gint64 ts_offset;
+  gboolean validate_crc;
+
+  /* depayloaded buffers not pushed yet while handling a buffer list */
+  GstBufferList *pending;
 
   GstAllocator *allocator;
   GstAllocationParams allocation_params;
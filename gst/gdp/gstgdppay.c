@@ -76,6 +76,8 @@ static void gst_gdp_pay_reset (GstGDPPay * this);
 
 static GstFlowReturn gst_gdp_pay_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buffer);
+static GstFlowReturn gst_gdp_pay_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list);
 static gboolean gst_gdp_pay_src_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
 static gboolean gst_gdp_pay_sink_event (GstPad * pad, GstObject * parent,
@@ -132,6 +134,8 @@ gst_gdp_pay_init (GstGDPPay * gdppay)
       gst_pad_new_from_static_template (&gdp_pay_sink_template, "sink");
   gst_pad_set_chain_function (gdppay->sinkpad,
       GST_DEBUG_FUNCPTR (gst_gdp_pay_chain));
+  gst_pad_set_chain_list_function (gdppay->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_gdp_pay_chain_list));
   gst_pad_set_event_function (gdppay->sinkpad,
       GST_DEBUG_FUNCPTR (gst_gdp_pay_sink_event));
   gst_element_add_pad (GST_ELEMENT (gdppay), gdppay->sinkpad);
@@ -177,6 +181,7 @@ gst_gdp_pay_reset (GstGDPPay * this)
     gst_caps_unref (this->caps);
     this->caps = NULL;
   }
+  gst_buffer_replace (&this->caps_buf, NULL);
   this->have_caps = FALSE;
   this->have_segment = FALSE;
   this->have_streamstartid = FALSE;
@@ -194,10 +199,29 @@ gst_gdp_stamp_buffer (GstGDPPay * this, GstBuffer * buffer)
   this->offset = GST_BUFFER_OFFSET_END (buffer);
 }
 
+/* the serialized version of our current caps is kept around so that it
+ * doesn't need to be redone every time the streamheader is updated */
 static GstBuffer *
 gst_gdp_buffer_from_caps (GstGDPPay * this, GstCaps * caps)
 {
-  return gst_dp_payload_caps (caps, this->header_flag);
+  GstBuffer *buf;
+  gboolean current;
+
+  current = this->caps != NULL && gst_caps_is_equal (this->caps, caps);
+
+  if (current && this->caps_buf != NULL
+      && this->caps_buf_flag == this->header_flag)
+    return gst_buffer_copy (this->caps_buf);
+
+  buf = gst_dp_payload_caps (caps, this->header_flag);
+  if (buf == NULL || !current)
+    return buf;
+
+  gst_buffer_replace (&this->caps_buf, buf);
+  this->caps_buf_flag = this->header_flag;
+  gst_buffer_unref (buf);
+
+  return gst_buffer_copy (this->caps_buf);
 }
 
 static GstBuffer *
@@ -507,6 +531,53 @@ no_buffer:
   }
 }
 
+static GstFlowReturn
+gst_gdp_pay_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  GstGDPPay *this;
+  GstBufferList *outlist;
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint i, len;
+
+  this = GST_GDP_PAY (parent);
+
+  len = gst_buffer_list_length (list);
+
+  /* until the streamheader is out, or when it needs updating, take the
+   * regular path for each buffer so that queueing keeps working */
+  if (!this->have_segment || !this->caps || !this->sent_streamheader
+      || this->reset_streamheader) {
+    for (i = 0; i < len; i++) {
+      ret = gst_gdp_pay_chain (pad, parent,
+          gst_buffer_ref (gst_buffer_list_get (list, i)));
+      if (ret != GST_FLOW_OK)
+        break;
+    }
+    gst_buffer_list_unref (list);
+    return ret;
+  }
+
+  /* payload the whole list at once, all headers end up in one memory */
+  outlist = gst_dp_payload_buffer_list (list, this->header_flag);
+
+  for (i = 0; i < len; i++) {
+    GstBuffer *buffer = gst_buffer_list_get (list, i);
+    GstBuffer *outbuffer = gst_buffer_list_get (outlist, i);
+
+    if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_HEADER))
+      GST_BUFFER_FLAG_SET (outbuffer, GST_BUFFER_FLAG_HEADER);
+
+    gst_gdp_stamp_buffer (this, outbuffer);
+    GST_BUFFER_TIMESTAMP (outbuffer) = GST_BUFFER_TIMESTAMP (buffer);
+    GST_BUFFER_DURATION (outbuffer) = GST_BUFFER_DURATION (buffer);
+  }
+  gst_buffer_list_unref (list);
+
+  GST_LOG_OBJECT (this, "Pushing list of %u GDP buffers", len);
+
+  return gst_pad_push_list (this->srcpad, outlist);
+}
+
 static gboolean
 gst_gdp_pay_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
@@ -546,6 +617,7 @@ gst_gdp_pay_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       if (this->caps == NULL || !gst_caps_is_equal (this->caps, caps)) {
         GST_INFO_OBJECT (pad, "caps changed to %" GST_PTR_FORMAT, caps);
         gst_caps_replace (&this->caps, caps);
+        gst_buffer_replace (&this->caps_buf, NULL);
         outbuffer = gst_gdp_buffer_from_caps (this, caps);
         if (outbuffer == NULL)
           goto no_buffer_from_caps;
@@ -51,6 +51,8 @@ struct _GstGDPPay
   GstPad *srcpad;
 
   GstCaps *caps; /* incoming caps */
+  GstBuffer *caps_buf; /* GDP serialization of caps */
+  GstDPHeaderFlag caps_buf_flag; /* header flags caps_buf was made with */
 
   gboolean  have_streamstartid;
   gboolean  have_caps;
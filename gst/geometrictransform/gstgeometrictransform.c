@@ -24,6 +24,7 @@
 #include "gstgeometrictransform.h"
 #include "geometricmath.h"
 #include <string.h>
+#include <math.h>
 
 GST_DEBUG_CATEGORY_STATIC (geometric_transform_debug);
 #define GST_CAT_DEFAULT geometric_transform_debug
@@ -33,7 +34,8 @@ GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("{ ARGB, BGR, BGRA, BGRx, RGB, "
-            "RGBA, RGBx, AYUV, xBGR, xRGB, GRAY8, GRAY16_BE, GRAY16_LE }"))
+            "RGBA, RGBx, AYUV, xBGR, xRGB, GRAY8, GRAY16_BE, GRAY16_LE, "
+            "I420, YV12, Y41B, Y42B, Y444, NV12, NV21 }"))
     );
 
 static GstStaticPadTemplate gst_geometric_transform_sink_template =
@@ -41,7 +43,8 @@ GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("{ ARGB, BGR, BGRA, BGRx, RGB, "
-            "RGBA, RGBx, AYUV, xBGR, xRGB, GRAY8, GRAY16_BE, GRAY16_LE }"))
+            "RGBA, RGBx, AYUV, xBGR, xRGB, GRAY8, GRAY16_BE, GRAY16_LE, "
+            "I420, YV12, Y41B, Y42B, Y444, NV12, NV21 }"))
     );
 
 static GstVideoFilterClass *parent_class = NULL;
@@ -49,7 +52,9 @@ static GstVideoFilterClass *parent_class = NULL;
 enum
 {
   PROP_0,
-  PROP_OFF_EDGE_PIXELS
+  PROP_OFF_EDGE_PIXELS,
+  PROP_INTERPOLATION,
+  PROP_N_THREADS
 };
 
 #define GST_GT_OFF_EDGES_PIXELS_METHOD_TYPE ( \
@@ -74,7 +79,50 @@ gst_geometric_transform_off_edges_pixels_method_get_type (void)
   return method_type;
 }
 
+#define GST_GT_INTERPOLATION_METHOD_TYPE ( \
+    gst_geometric_transform_interpolation_method_get_type())
+static GType
+gst_geometric_transform_interpolation_method_get_type (void)
+{
+  static GType method_type = 0;
+
+  static const GEnumValue method_types[] = {
+    {GST_GT_INTERPOLATION_NEAREST, "Nearest neighbour", "nearest"},
+    {GST_GT_INTERPOLATION_BILINEAR, "Bilinear", "bilinear"},
+    {0, NULL, NULL}
+  };
+
+  if (!method_type) {
+    method_type =
+        g_enum_register_static ("GstGeometricTransformInterpolationMethod",
+        method_types);
+  }
+  return method_type;
+}
+
 #define DEFAULT_OFF_EDGE_PIXELS GST_GT_OFF_EDGES_PIXELS_IGNORE
+#define DEFAULT_INTERPOLATION GST_GT_INTERPOLATION_NEAREST
+#define DEFAULT_N_THREADS 1
+
+/*
+ * One entry per output pixel: the source pixel (-1 when it is off the edges
+ * and must be left black), the offset to the right and bottom neighbours
+ * used for bilinear filtering and the 8 bit fractional weights.
+ */
+typedef struct
+{
+  gint32 x, y;
+  gint16 dx, dy;
+  guint8 fx, fy;
+} GstGeometricTransformSample;
+
+typedef struct
+{
+  GstVideoFrame *in_frame;
+  GstVideoFrame *out_frame;
+  gint slice;
+  gint n_slices;
+} GstGeometricTransformSlice;
 
 /* must be called with the object lock */
 static gboolean
@@ -88,19 +136,18 @@ gst_geometric_transform_generate_map (GstGeometricTransform * gt)
 
   GST_INFO_OBJECT (gt, "Generating new transform map");
 
-  /* cleanup old map */
-  g_free (gt->map);
-  gt->map = NULL;
-
   klass = GST_GEOMETRIC_TRANSFORM_GET_CLASS (gt);
 
   /* subclass must have defined the map_func */
   g_return_val_if_fail (klass->map_func, FALSE);
 
   /*
-   * (x,y) pairs of the inverse mapping
+   * (x,y) pairs of the inverse mapping. The map is only reallocated when the
+   * size changes, subclasses without a precalculated map refill it for
+   * every frame
    */
-  gt->map = g_malloc0 (sizeof (gdouble) * gt->width * gt->height * 2);
+  if (gt->map == NULL)
+    gt->map = g_malloc (sizeof (gdouble) * gt->width * gt->height * 2);
   ptr = gt->map;
 
   for (y = 0; y < gt->height; y++) {
@@ -122,11 +169,167 @@ end:
     GST_WARNING_OBJECT (gt, "Generating transform map failed");
     g_free (gt->map);
     gt->map = NULL;
-  } else
+  } else {
     gt->needs_remap = FALSE;
+    gt->needs_resample = TRUE;
+  }
   return ret;
 }
 
+static gint
+gst_geometric_transform_plane_comp (const GstVideoFormatInfo * finfo,
+    gint plane)
+{
+  gint i;
+
+  for (i = 0; i < GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo); i++) {
+    if (GST_VIDEO_FORMAT_INFO_PLANE (finfo, i) == plane)
+      return i;
+  }
+  return 0;
+}
+
+static void
+gst_geometric_transform_free_samples (GstGeometricTransform * gt)
+{
+  gint i, j;
+
+  for (i = GST_VIDEO_MAX_PLANES - 1; i >= 0; i--) {
+    for (j = 0; j < i; j++) {
+      if (gt->samples[j] == gt->samples[i])
+        break;
+    }
+    /* only free tables that are not shared with a previous plane */
+    if (j == i)
+      g_free (gt->samples[i]);
+    gt->samples[i] = NULL;
+  }
+}
+
+/* resolves one source coordinate according to the off edge pixels mode,
+ * returns FALSE if the pixel falls off the edges */
+static inline gboolean
+gst_geometric_transform_resolve_coord (gint off_edge_pixels,
+    gboolean bilinear, gdouble in, gint size, gint32 * pos, gint16 * delta,
+    guint8 * frac)
+{
+  gint i, next;
+  gdouble f;
+
+  switch (off_edge_pixels) {
+    case GST_GT_OFF_EDGES_PIXELS_CLAMP:
+      in = CLAMP (in, 0, size - 1);
+      break;
+
+    case GST_GT_OFF_EDGES_PIXELS_WRAP:
+      in = gst_gm_mod_float (in, size);
+      if (in < 0)
+        in += size;
+      break;
+
+    default:
+      break;
+  }
+
+  if (bilinear) {
+    f = floor (in);
+    i = (gint) f;
+    f = in - f;
+  } else {
+    i = (gint) in;
+    f = 0;
+  }
+
+  /* rounding can push a wrapped coordinate onto the edge */
+  if (i >= size && off_edge_pixels == GST_GT_OFF_EDGES_PIXELS_WRAP)
+    i -= size;
+  if (i < 0 || i >= size)
+    return FALSE;
+
+  next = i + 1;
+  if (next >= size) {
+    /* the delta is 16 bits, sizes that don't fit just repeat the edge */
+    if (off_edge_pixels == GST_GT_OFF_EDGES_PIXELS_WRAP && size <= 32768)
+      next = 0;
+    else
+      next = i;
+  }
+
+  *pos = i;
+  *delta = bilinear ? next - i : 0;
+  *frac = (guint8) (f * 256.0);
+  return TRUE;
+}
+
+static void
+gst_geometric_transform_fill_samples (GstGeometricTransform * gt,
+    GstGeometricTransformSample * samples, gint width, gint height,
+    gint w_sub, gint h_sub)
+{
+  GstGeometricTransformSample *s = samples;
+  gboolean bilinear = gt->interpolation == GST_GT_INTERPOLATION_BILINEAR;
+  gdouble x_scale = 1.0 / (1 << w_sub);
+  gdouble y_scale = 1.0 / (1 << h_sub);
+  gint x, y;
+
+  for (y = 0; y < height; y++) {
+    gint map_y = MIN (y << h_sub, gt->height - 1);
+
+    for (x = 0; x < width; x++) {
+      gint map_x = MIN (x << w_sub, gt->width - 1);
+      gdouble *ptr = gt->map + (map_y * gt->width + map_x) * 2;
+
+      if (!gst_geometric_transform_resolve_coord (gt->off_edge_pixels,
+              bilinear, ptr[0] * x_scale, width, &s->x, &s->dx, &s->fx) ||
+          !gst_geometric_transform_resolve_coord (gt->off_edge_pixels,
+              bilinear, ptr[1] * y_scale, height, &s->y, &s->dy, &s->fy)) {
+        s->x = s->y = -1;
+      }
+      s++;
+    }
+  }
+}
+
+/* Fills the sampling tables from the map, allocating them the first time
+ * after caps were set. Must be called with the object lock */
+static void
+gst_geometric_transform_generate_samples (GstGeometricTransform * gt,
+    const GstVideoInfo * info)
+{
+  const GstVideoFormatInfo *finfo = info->finfo;
+  gint p, q;
+
+  GST_DEBUG_OBJECT (gt, "Generating sampling tables");
+
+  for (p = 0; p < GST_VIDEO_INFO_N_PLANES (info); p++) {
+    gint comp = gst_geometric_transform_plane_comp (finfo, p);
+    gint w_sub = GST_VIDEO_FORMAT_INFO_W_SUB (finfo, comp);
+    gint h_sub = GST_VIDEO_FORMAT_INFO_H_SUB (finfo, comp);
+
+    for (q = 0; q < p; q++) {
+      gint qcomp = gst_geometric_transform_plane_comp (finfo, q);
+
+      if (GST_VIDEO_FORMAT_INFO_W_SUB (finfo, qcomp) == w_sub &&
+          GST_VIDEO_FORMAT_INFO_H_SUB (finfo, qcomp) == h_sub)
+        break;
+    }
+
+    if (q < p) {
+      gt->samples[p] = gt->samples[q];
+    } else {
+      gint width = GST_VIDEO_INFO_COMP_WIDTH (info, comp);
+      gint height = GST_VIDEO_INFO_COMP_HEIGHT (info, comp);
+
+      if (gt->samples[p] == NULL)
+        gt->samples[p] = g_new (GstGeometricTransformSample, width * height);
+      gst_geometric_transform_fill_samples (gt, gt->samples[p], width, height,
+          w_sub, h_sub);
+    }
+  }
+
+  gt->needs_resample = FALSE;
+}
+
 static gboolean
 gst_geometric_transform_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
     GstVideoInfo * in_info, GstCaps * outcaps, GstVideoInfo * out_info)
@@ -150,8 +353,14 @@ gst_geometric_transform_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
 
   /* regenerate the map */
   GST_OBJECT_LOCK (gt);
+  /* the format can change the table layout even with the same size */
+  gst_geometric_transform_free_samples (gt);
+  gt->needs_resample = TRUE;
   if (gt->map == NULL || old_width == 0 || old_height == 0
       || gt->width != old_width || gt->height != old_height) {
+    g_free (gt->map);
+    gt->map = NULL;
+
     if (klass->prepare_func)
       if (!klass->prepare_func (gt)) {
         GST_OBJECT_UNLOCK (gt);
@@ -164,46 +373,257 @@ gst_geometric_transform_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
   return ret;
 }
 
+/* the pixel value left for off edge pixels */
 static void
-gst_geometric_transform_do_map (GstGeometricTransform * gt, guint8 * in_data,
-    guint8 * out_data, gint x, gint y, gdouble in_x, gdouble in_y)
+gst_geometric_transform_black_pixel (const GstVideoFormatInfo * finfo,
+    gint plane, guint8 * black)
 {
-  gint in_offset;
-  gint out_offset;
+  gint i;
+
+  memset (black, 0, 8);
+
+  /* in YUV black is not just all zeros:
+   * 0x10 is black for Y,
+   * 0x80 is black for Cr and Cb */
+  if (!GST_VIDEO_FORMAT_INFO_IS_YUV (finfo))
+    return;
+
+  for (i = 0; i < GST_VIDEO_FORMAT_INFO_N_COMPONENTS (finfo); i++) {
+    guint8 val;
+
+    if (GST_VIDEO_FORMAT_INFO_PLANE (finfo, i) != plane)
+      continue;
+
+    switch (i) {
+      case GST_VIDEO_COMP_Y:
+        val = 0x10;
+        break;
+      case GST_VIDEO_COMP_A:
+        val = 0xff;
+        break;
+      default:
+        val = 0x80;
+        break;
+    }
+    black[GST_VIDEO_FORMAT_INFO_POFFSET (finfo, i)] = val;
+  }
+}
 
-  out_offset = y * gt->row_stride + x * gt->pixel_stride;
+static void
+gst_geometric_transform_nearest_row (const GstGeometricTransformSample * s,
+    gint width, const guint8 * in, gint in_stride, guint8 * out, gint pstride,
+    const guint8 * black)
+{
+  gint x;
 
-  /* operate on out of edge pixels */
-  switch (gt->off_edge_pixels) {
-    case GST_GT_OFF_EDGES_PIXELS_CLAMP:
-      in_x = CLAMP (in_x, 0, gt->width - 1);
-      in_y = CLAMP (in_y, 0, gt->height - 1);
+  switch (pstride) {
+    case 1:
+      for (x = 0; x < width; x++, s++)
+        out[x] = s->x < 0 ? black[0] : in[s->y * in_stride + s->x];
       break;
-
-    case GST_GT_OFF_EDGES_PIXELS_WRAP:
-      in_x = gst_gm_mod_float (in_x, gt->width);
-      in_y = gst_gm_mod_float (in_y, gt->height);
-      if (in_x < 0)
-        in_x += gt->width;
-      if (in_y < 0)
-        in_y += gt->height;
+    case 4:
+      for (x = 0; x < width; x++, s++, out += 4) {
+        if (s->x < 0)
+          memcpy (out, black, 4);
+        else
+          memcpy (out, in + s->y * in_stride + s->x * 4, 4);
+      }
       break;
-
     default:
+      for (x = 0; x < width; x++, s++, out += pstride) {
+        if (s->x < 0)
+          memcpy (out, black, pstride);
+        else
+          memcpy (out, in + s->y * in_stride + s->x * pstride, pstride);
+      }
       break;
   }
+}
+
+static void
+gst_geometric_transform_bilinear_row (const GstGeometricTransformSample * s,
+    gint width, const guint8 * in, gint in_stride, guint8 * out, gint pstride,
+    const guint8 * black)
+{
+  gint x, c;
+
+  for (x = 0; x < width; x++, s++, out += pstride) {
+    const guint8 *p0, *p1, *p2, *p3;
+    guint wx1, wx0, wy1, wy0;
+
+    if (s->x < 0) {
+      memcpy (out, black, pstride);
+      continue;
+    }
+
+    p0 = in + s->y * in_stride + s->x * pstride;
+    p1 = p0 + s->dx * pstride;
+    p2 = p0 + s->dy * in_stride;
+    p3 = p2 + s->dx * pstride;
+    wx1 = s->fx;
+    wx0 = 256 - wx1;
+    wy1 = s->fy;
+    wy0 = 256 - wy1;
+
+    for (c = 0; c < pstride; c++) {
+      guint top = p0[c] * wx0 + p1[c] * wx1;
+      guint bottom = p2[c] * wx0 + p3[c] * wx1;
+
+      out[c] = (top * wy0 + bottom * wy1 + 32768) >> 16;
+    }
+  }
+}
+
+#define DEFINE_BILINEAR_ROW_16(endian) \
+static void \
+gst_geometric_transform_bilinear_row_16##endian ( \
+    const GstGeometricTransformSample * s, gint width, const guint8 * in, \
+    gint in_stride, guint8 * out, gint pstride, const guint8 * black) \
+{ \
+  gint x; \
+\
+  for (x = 0; x < width; x++, s++, out += 2) { \
+    const guint8 *p0, *p1, *p2, *p3; \
+    guint32 wx1, wx0, wy1, wy0, top, bottom; \
+\
+    if (s->x < 0) { \
+      memcpy (out, black, 2); \
+      continue; \
+    } \
+\
+    p0 = in + s->y * in_stride + s->x * 2; \
+    p1 = p0 + s->dx * 2; \
+    p2 = p0 + s->dy * in_stride; \
+    p3 = p2 + s->dx * 2; \
+    wx1 = s->fx; \
+    wx0 = 256 - wx1; \
+    wy1 = s->fy; \
+    wy0 = 256 - wy1; \
+\
+    top = GST_READ_UINT16_##endian (p0) * wx0 + \
+        GST_READ_UINT16_##endian (p1) * wx1; \
+    bottom = GST_READ_UINT16_##endian (p2) * wx0 + \
+        GST_READ_UINT16_##endian (p3) * wx1; \
+    GST_WRITE_UINT16_##endian (out, (top * wy0 + bottom * wy1 + 32768) >> 16); \
+  } \
+}
+
+DEFINE_BILINEAR_ROW_16 (LE)
+DEFINE_BILINEAR_ROW_16 (BE)
+
+typedef void (*GstGeometricTransformRowFunc) (const GstGeometricTransformSample
+    * s, gint width, const guint8 * in, gint in_stride, guint8 * out,
+    gint pstride, const guint8 * black);
+
+/* Maps rows [slice * height / n_slices, (slice + 1) * height / n_slices)
+ * of every plane. Does not take the object lock, the caller holds it for
+ * the whole frame */
+static void
+gst_geometric_transform_process_slice (GstGeometricTransform * gt,
+    GstVideoFrame * in_frame, GstVideoFrame * out_frame, gint slice,
+    gint n_slices)
+{
+  const GstVideoFormatInfo *finfo = out_frame->info.finfo;
+  gint p, y;
+
+  for (p = 0; p < GST_VIDEO_FRAME_N_PLANES (out_frame); p++) {
+    const GstGeometricTransformSample *samples = gt->samples[p];
+    gint comp = gst_geometric_transform_plane_comp (finfo, p);
+    gint width = GST_VIDEO_FRAME_COMP_WIDTH (out_frame, comp);
+    gint height = GST_VIDEO_FRAME_COMP_HEIGHT (out_frame, comp);
+    gint pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (out_frame, comp);
+    const guint8 *in_data = GST_VIDEO_FRAME_PLANE_DATA (in_frame, p);
+    gint in_stride = GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, p);
+    guint8 *out_data = GST_VIDEO_FRAME_PLANE_DATA (out_frame, p);
+    gint out_stride = GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, p);
+    gint y_start = height * slice / n_slices;
+    gint y_end = height * (slice + 1) / n_slices;
+    GstGeometricTransformRowFunc row_func;
+    guint8 black[8];
+
+    gst_geometric_transform_black_pixel (finfo, p, black);
+
+    if (gt->interpolation == GST_GT_INTERPOLATION_NEAREST)
+      row_func = gst_geometric_transform_nearest_row;
+    else if (GST_VIDEO_FORMAT_INFO_DEPTH (finfo, comp) <= 8)
+      row_func = gst_geometric_transform_bilinear_row;
+    else if (GST_VIDEO_FORMAT_INFO_IS_LE (finfo))
+      row_func = gst_geometric_transform_bilinear_row_16LE;
+    else
+      row_func = gst_geometric_transform_bilinear_row_16BE;
+
+    for (y = y_start; y < y_end; y++) {
+      row_func (samples + y * width, width, in_data, in_stride,
+          out_data + y * out_stride, pstride, black);
+    }
+  }
+}
+
+static void
+gst_geometric_transform_slice_func (gpointer data, gpointer user_data)
+{
+  GstGeometricTransformSlice *slice = data;
+  GstGeometricTransform *gt = user_data;
+
+  gst_geometric_transform_process_slice (gt, slice->in_frame,
+      slice->out_frame, slice->slice, slice->n_slices);
 
-  {
-    gint trunc_x = (gint) in_x;
-    gint trunc_y = (gint) in_y;
-    /* only set the values if the values are valid */
-    if (trunc_x >= 0 && trunc_x < gt->width && trunc_y >= 0 &&
-        trunc_y < gt->height) {
-      in_offset = trunc_y * gt->row_stride + trunc_x * gt->pixel_stride;
+  g_mutex_lock (&gt->slice_lock);
+  if (--gt->slices_pending == 0)
+    g_cond_signal (&gt->slice_cond);
+  g_mutex_unlock (&gt->slice_lock);
+}
 
-      memcpy (out_data + out_offset, in_data + in_offset, gt->pixel_stride);
+/* must be called with the object lock */
+static void
+gst_geometric_transform_process_frame (GstGeometricTransform * gt,
+    GstVideoFrame * in_frame, GstVideoFrame * out_frame)
+{
+  GstGeometricTransformSlice *slices;
+  gint i, n_slices;
+
+  n_slices = gt->n_threads == 0 ? g_get_num_processors () : gt->n_threads;
+  n_slices = CLAMP (n_slices, 1, MAX (gt->height / 16, 1));
+
+  if (n_slices == 1) {
+    gst_geometric_transform_process_slice (gt, in_frame, out_frame, 0, 1);
+    return;
+  }
+
+  if (gt->pool == NULL) {
+    gt->pool = g_thread_pool_new (gst_geometric_transform_slice_func, gt,
+        n_slices - 1, FALSE, NULL);
+    if (gt->pool == NULL) {
+      gst_geometric_transform_process_slice (gt, in_frame, out_frame, 0, 1);
+      return;
     }
+  } else if (g_thread_pool_get_max_threads (gt->pool) != n_slices - 1) {
+    g_thread_pool_set_max_threads (gt->pool, n_slices - 1, NULL);
   }
+
+  slices = g_newa (GstGeometricTransformSlice, n_slices);
+
+  g_mutex_lock (&gt->slice_lock);
+  gt->slices_pending = n_slices - 1;
+  g_mutex_unlock (&gt->slice_lock);
+
+  for (i = 0; i < n_slices; i++) {
+    slices[i].in_frame = in_frame;
+    slices[i].out_frame = out_frame;
+    slices[i].slice = i;
+    slices[i].n_slices = n_slices;
+    if (i > 0)
+      g_thread_pool_push (gt->pool, &slices[i], NULL);
+  }
+
+  /* the streaming thread takes the first slice itself */
+  gst_geometric_transform_process_slice (gt, in_frame, out_frame, 0,
+      n_slices);
+
+  g_mutex_lock (&gt->slice_lock);
+  while (gt->slices_pending > 0)
+    g_cond_wait (&gt->slice_cond, &gt->slice_lock);
+  g_mutex_unlock (&gt->slice_lock);
 }
 
 static void
@@ -229,64 +649,40 @@ gst_geometric_transform_transform_frame (GstVideoFilter * vfilter,
 {
   GstGeometricTransform *gt;
   GstGeometricTransformClass *klass;
-  gint x, y, i;
   GstFlowReturn ret = GST_FLOW_OK;
-  gdouble *ptr;
-  guint8 *in_data;
-  guint8 *out_data;
 
   gt = GST_GEOMETRIC_TRANSFORM_CAST (vfilter);
   klass = GST_GEOMETRIC_TRANSFORM_GET_CLASS (gt);
 
-  in_data = GST_VIDEO_FRAME_PLANE_DATA (in_frame, 0);
-  out_data = GST_VIDEO_FRAME_PLANE_DATA (out_frame, 0);
-
-  if (GST_VIDEO_FRAME_FORMAT (out_frame) == GST_VIDEO_FORMAT_AYUV) {
-    /* in AYUV black is not just all zeros:
-     * 0x10 is black for Y,
-     * 0x80 is black for Cr and Cb */
-    for (i = 0; i < out_frame->map[0].size; i += 4)
-      GST_WRITE_UINT32_BE (out_data + i, 0xff108080);
-  } else {
-    memset (out_data, 0, out_frame->map[0].size);
-  }
-
   GST_OBJECT_LOCK (gt);
   if (gt->precalc_map) {
     if (gt->needs_remap) {
       if (klass->prepare_func)
         if (!klass->prepare_func (gt)) {
-          ret = FALSE;
+          ret = GST_FLOW_ERROR;
           goto end;
         }
       gst_geometric_transform_generate_map (gt);
     }
-    g_return_val_if_fail (gt->map, GST_FLOW_ERROR);
-    ptr = gt->map;
-    for (y = 0; y < gt->height; y++) {
-      for (x = 0; x < gt->width; x++) {
-        /* do the mapping */
-        gst_geometric_transform_do_map (gt, in_data, out_data, x, y, ptr[0],
-            ptr[1]);
-        ptr += 2;
-      }
-    }
   } else {
-    for (y = 0; y < gt->height; y++) {
-      for (x = 0; x < gt->width; x++) {
-        gdouble in_x, in_y;
-
-        if (klass->map_func (gt, x, y, &in_x, &in_y)) {
-          gst_geometric_transform_do_map (gt, in_data, out_data, x, y, in_x,
-              in_y);
-        } else {
-          GST_WARNING_OBJECT (gt, "Failed to do mapping for %d %d", x, y);
-          ret = GST_FLOW_ERROR;
-          goto end;
-        }
-      }
+    /* the subclass gives a different mapping for every frame */
+    if (!gst_geometric_transform_generate_map (gt)) {
+      ret = GST_FLOW_ERROR;
+      goto end;
     }
   }
+
+  if (gt->map == NULL) {
+    GST_WARNING_OBJECT (gt, "No transform map");
+    ret = GST_FLOW_ERROR;
+    goto end;
+  }
+
+  if (gt->needs_resample)
+    gst_geometric_transform_generate_samples (gt, &in_frame->info);
+
+  gst_geometric_transform_process_frame (gt, in_frame, out_frame);
+
 end:
   GST_OBJECT_UNLOCK (gt);
   return ret;
@@ -301,9 +697,31 @@ gst_geometric_transform_set_property (GObject * object, guint prop_id,
   gt = GST_GEOMETRIC_TRANSFORM_CAST (object);
 
   switch (prop_id) {
-    case PROP_OFF_EDGE_PIXELS:
+    case PROP_OFF_EDGE_PIXELS:{
+      gint off_edge_pixels = g_value_get_enum (value);
+
+      GST_OBJECT_LOCK (gt);
+      if (off_edge_pixels != gt->off_edge_pixels) {
+        gt->off_edge_pixels = off_edge_pixels;
+        gt->needs_resample = TRUE;
+      }
+      GST_OBJECT_UNLOCK (gt);
+      break;
+    }
+    case PROP_INTERPOLATION:{
+      gint interpolation = g_value_get_enum (value);
+
+      GST_OBJECT_LOCK (gt);
+      if (interpolation != gt->interpolation) {
+        gt->interpolation = interpolation;
+        gt->needs_resample = TRUE;
+      }
+      GST_OBJECT_UNLOCK (gt);
+      break;
+    }
+    case PROP_N_THREADS:
       GST_OBJECT_LOCK (gt);
-      gt->off_edge_pixels = g_value_get_enum (value);
+      gt->n_threads = g_value_get_uint (value);
       GST_OBJECT_UNLOCK (gt);
       break;
     default:
@@ -324,6 +742,12 @@ gst_geometric_transform_get_property (GObject * object, guint prop_id,
     case PROP_OFF_EDGE_PIXELS:
       g_value_set_enum (value, gt->off_edge_pixels);
       break;
+    case PROP_INTERPOLATION:
+      g_value_set_enum (value, gt->interpolation);
+      break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, gt->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -341,12 +765,31 @@ gst_geometric_transform_stop (GstBaseTransform * trans)
   gt->width = 0;
   gt->height = 0;
 
+  GST_OBJECT_LOCK (gt);
   g_free (gt->map);
   gt->map = NULL;
+  gst_geometric_transform_free_samples (gt);
+  GST_OBJECT_UNLOCK (gt);
+
+  if (gt->pool) {
+    g_thread_pool_free (gt->pool, FALSE, TRUE);
+    gt->pool = NULL;
+  }
 
   return TRUE;
 }
 
+static void
+gst_geometric_transform_finalize (GObject * object)
+{
+  GstGeometricTransform *gt = GST_GEOMETRIC_TRANSFORM_CAST (object);
+
+  g_mutex_clear (&gt->slice_lock);
+  g_cond_clear (&gt->slice_cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_geometric_transform_base_init (gpointer g_class)
 {
@@ -373,6 +816,7 @@ gst_geometric_transform_class_init (gpointer klass, gpointer class_data)
 
   obj_class->set_property = gst_geometric_transform_set_property;
   obj_class->get_property = gst_geometric_transform_get_property;
+  obj_class->finalize = gst_geometric_transform_finalize;
 
   trans_class->stop = GST_DEBUG_FUNCPTR (gst_geometric_transform_stop);
   trans_class->before_transform =
@@ -389,7 +833,35 @@ gst_geometric_transform_class_init (gpointer klass, gpointer class_data)
           GST_GT_OFF_EDGES_PIXELS_METHOD_TYPE, DEFAULT_OFF_EDGE_PIXELS,
           GST_PARAM_CONTROLLABLE | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstGeometricTransform:interpolation:
+   *
+   * How to sample the input frame at the mapped position.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (obj_class, PROP_INTERPOLATION,
+      g_param_spec_enum ("interpolation", "Interpolation",
+          "Interpolation method used to sample the input pixels",
+          GST_GT_INTERPOLATION_METHOD_TYPE, DEFAULT_INTERPOLATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstGeometricTransform:n-threads:
+   *
+   * Number of threads the frame is split between, 0 uses one thread per
+   * CPU core.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (obj_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Maximum number of threads to use (0 = number of CPU cores)",
+          0, G_MAXINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_type_mark_as_plugin_api (GST_GT_OFF_EDGES_PIXELS_METHOD_TYPE, 0);
+  gst_type_mark_as_plugin_api (GST_GT_INTERPOLATION_METHOD_TYPE, 0);
   gst_type_mark_as_plugin_api (GST_TYPE_GEOMETRIC_TRANSFORM, 0);
 }
 
@@ -399,8 +871,13 @@ gst_geometric_transform_init (GTypeInstance * instance, gpointer g_class)
   GstGeometricTransform *gt = GST_GEOMETRIC_TRANSFORM_CAST (instance);
 
   gt->off_edge_pixels = DEFAULT_OFF_EDGE_PIXELS;
+  gt->interpolation = DEFAULT_INTERPOLATION;
+  gt->n_threads = DEFAULT_N_THREADS;
   gt->precalc_map = TRUE;
   gt->needs_remap = TRUE;
+  gt->needs_resample = TRUE;
+  g_mutex_init (&gt->slice_lock);
+  g_cond_init (&gt->slice_cond);
 }
 
 GType
@@ -46,6 +46,12 @@ enum
   GST_GT_OFF_EDGES_PIXELS_WRAP
 };
 
+enum
+{
+  GST_GT_INTERPOLATION_NEAREST = 0,
+  GST_GT_INTERPOLATION_BILINEAR
+};
+
 typedef struct _GstGeometricTransform GstGeometricTransform;
 typedef struct _GstGeometricTransformClass GstGeometricTransformClass;
 
@@ -99,8 +105,20 @@ struct _GstGeometricTransform {
 
   /* properties */
   gint off_edge_pixels;
+  gint interpolation;
+  guint n_threads;
 
   gdouble *map;
+
+  /* fixed-point sampling tables derived from the map, one per plane.
+   * Planes with the same subsampling share their table */
+  gpointer samples[GST_VIDEO_MAX_PLANES];
+  gboolean needs_resample;
+
+  GThreadPool *pool;
+  GMutex slice_lock;
+  GCond slice_cond;
+  gint slices_pending;
 };
 
 struct _GstGeometricTransformClass {
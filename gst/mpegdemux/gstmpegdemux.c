@@ -92,10 +92,20 @@ enum
 {
   PROP_0,
   PROP_IGNORE_SCR,
+  PROP_INDEX_SCAN,
+  PROP_INDEX,
   /* FILL ME */
 };
 
 #define DEFAULT_IGNORE_SCR FALSE
+#define DEFAULT_INDEX_SCAN FALSE
+
+/* minimum SCR distance between index entries without keyframe */
+#define INDEX_SCR_INTERVAL CLOCK_FREQ
+/* how far back to look for a keyframe before a seek target */
+#define INDEX_MAX_KEYFRAME_DISTANCE (10 * CLOCK_FREQ)
+/* how much of a video PES payload is checked for a keyframe */
+#define INDEX_KEYFRAME_SCAN_SIZE 64
 
 static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
@@ -179,6 +189,11 @@ static inline void gst_ps_demux_clear_times (GstPsDemux * demux);
 static void gst_ps_demux_reset_psm (GstPsDemux * demux);
 static void gst_ps_demux_flush (GstPsDemux * demux);
 
+static void gst_ps_demux_index_clear (GstPsDemux * demux);
+static GBytes *gst_ps_demux_index_export (GstPsDemux * demux);
+static void gst_ps_demux_index_import (GstPsDemux * demux, GBytes * bytes);
+static void gst_ps_demux_index_scan (GstPsDemux * demux, guint64 pts);
+
 static GstElementClass *parent_class = NULL;
 
 static void gst_segment_set_position (GstSegment * segment, GstFormat format,
@@ -272,6 +287,41 @@ gst_ps_demux_class_init (GstPsDemuxClass * klass)
           "Ignore SCR data for timing", DEFAULT_IGNORE_SCR,
           G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
           G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstPsDemux:index-scan:
+   *
+   * In pull mode, scan the stream forward from the end of the index when
+   * seeking to a position it doesn't cover yet, instead of estimating the
+   * byte offset by bisection. Every later seek into the scanned range is
+   * then served from the index.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_INDEX_SCAN,
+      g_param_spec_boolean ("index-scan", "Index scan",
+          "Scan the stream to extend the index when seeking",
+          DEFAULT_INDEX_SCAN, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstPsDemux:index:
+   *
+   * Serialized seek index of the stream. While demuxing, the element
+   * records the SCR of a pack about every second and the position of
+   * video keyframes, and seeks inside the indexed range go straight to the
+   * keyframe before the target.
+   *
+   * The index can be read in PAUSED or PLAYING and set again in READY
+   * before playing the same stream later, which allows accurate seeking
+   * right away. An index that was created for a stream of another size
+   * is dropped.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_INDEX,
+      g_param_spec_boxed ("index", "Index", "Serialized seek index",
+          G_TYPE_BYTES, G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -300,10 +350,12 @@ gst_ps_demux_init (GstPsDemux * demux)
   demux->adapter = gst_adapter_new ();
   demux->rev_adapter = gst_adapter_new ();
   demux->flowcombiner = gst_flow_combiner_new ();
+  demux->index = g_array_new (FALSE, FALSE, sizeof (GstPsDemuxIndexEntry));
 
   gst_ps_demux_reset (demux);
 
   demux->ignore_scr = DEFAULT_IGNORE_SCR;
+  demux->index_scan = DEFAULT_INDEX_SCAN;
 }
 
 static void
@@ -316,6 +368,7 @@ gst_ps_demux_finalize (GstPsDemux * demux)
   gst_flow_combiner_free (demux->flowcombiner);
   g_object_unref (demux->adapter);
   g_object_unref (demux->rev_adapter);
+  g_array_free (demux->index, TRUE);
 
   G_OBJECT_CLASS (parent_class)->finalize (G_OBJECT (demux));
 }
@@ -330,6 +383,12 @@ gst_ps_demux_set_property (GObject * object, guint prop_id,
     case PROP_IGNORE_SCR:
       demux->ignore_scr = g_value_get_boolean (value);
       break;
+    case PROP_INDEX_SCAN:
+      demux->index_scan = g_value_get_boolean (value);
+      break;
+    case PROP_INDEX:
+      gst_ps_demux_index_import (demux, g_value_get_boxed (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
   }
@@ -345,6 +404,12 @@ gst_ps_demux_get_property (GObject * object, guint prop_id,
     case PROP_IGNORE_SCR:
       g_value_set_boolean (value, demux->ignore_scr);
       break;
+    case PROP_INDEX_SCAN:
+      g_value_set_boolean (value, demux->index_scan);
+      break;
+    case PROP_INDEX:
+      g_value_take_boxed (value, gst_ps_demux_index_export (demux));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
   }
@@ -398,6 +463,7 @@ gst_ps_demux_reset (GstPsDemux * demux)
   gst_segment_init (&demux->sink_segment, GST_FORMAT_UNDEFINED);
   gst_segment_init (&demux->src_segment, GST_FORMAT_TIME);
   gst_ps_demux_flush (demux);
+  gst_ps_demux_index_clear (demux);
   demux->have_group_id = FALSE;
   demux->group_id = G_MAXUINT;
 }
@@ -973,6 +1039,9 @@ gst_ps_demux_flush (GstPsDemux * demux)
   demux->adapter_offset = G_MAXUINT64;
   demux->current_scr = G_MAXUINT64;
   demux->bytes_since_scr = 0;
+  GST_OBJECT_LOCK (demux);
+  demux->index_contiguous = FALSE;
+  GST_OBJECT_UNLOCK (demux);
 }
 
 static inline void
@@ -1125,6 +1194,345 @@ gst_ps_demux_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
   return res;
 }
 
+/* Checks if the video PES payload at @offset of @buffer starts with a
+ * random access point */
+static gboolean
+gst_ps_demux_is_keyframe (gint stream_type, GstBuffer * buffer, gsize offset)
+{
+  guint8 data[INDEX_KEYFRAME_SCAN_SIZE];
+  guint32 code = 0xffffffff;
+  guint8 nal_type;
+  gsize i, size;
+
+  switch (stream_type) {
+    case ST_VIDEO_MPEG1:
+    case ST_VIDEO_MPEG2:
+    case ST_GST_VIDEO_MPEG1_OR_2:
+    case ST_VIDEO_MPEG4:
+    case ST_VIDEO_H264:
+    case ST_VIDEO_H265:
+      break;
+    default:
+      return FALSE;
+  }
+
+  size = gst_buffer_extract (buffer, offset, data, sizeof (data));
+
+  for (i = 0; i < size; i++) {
+    code = (code << 8) | data[i];
+    if ((code & 0xffffff00) != 0x00000100)
+      continue;
+
+    switch (stream_type) {
+      case ST_VIDEO_MPEG4:
+        /* visual object sequence or GOV */
+        if (code == 0x000001b0 || code == 0x000001b3)
+          return TRUE;
+        break;
+      case ST_VIDEO_H264:
+        /* IDR or SPS */
+        nal_type = code & 0x1f;
+        if (nal_type == 5 || nal_type == 7)
+          return TRUE;
+        break;
+      case ST_VIDEO_H265:
+        /* IRAP, VPS or SPS */
+        nal_type = (code >> 1) & 0x3f;
+        if ((nal_type >= 16 && nal_type <= 21) || nal_type == 32
+            || nal_type == 33)
+          return TRUE;
+        break;
+      default:
+        /* sequence header or GOP */
+        if (code == 0x000001b3 || code == 0x000001b8)
+          return TRUE;
+        break;
+    }
+  }
+
+  return FALSE;
+}
+
+static void
+gst_ps_demux_index_clear (GstPsDemux * demux)
+{
+  GST_OBJECT_LOCK (demux);
+  g_array_set_size (demux->index, 0);
+  demux->index_complete = FALSE;
+  demux->index_size = 0;
+  demux->index_contiguous = FALSE;
+  demux->index_end = 0;
+  demux->index_end_scr = 0;
+  GST_OBJECT_UNLOCK (demux);
+}
+
+static void
+gst_ps_demux_index_add (GstPsDemux * demux, guint64 offset, guint64 scr,
+    guint64 pts, gboolean keyframe)
+{
+  GstPsDemuxIndexEntry entry, *last = NULL;
+
+  GST_OBJECT_LOCK (demux);
+  if (!demux->index_contiguous || demux->index_complete)
+    goto done;
+
+  if (demux->index->len > 0)
+    last = &g_array_index (demux->index, GstPsDemuxIndexEntry,
+        demux->index->len - 1);
+
+  if (last && last->offset == offset) {
+    /* keyframe in the pack that got an SCR entry */
+    if (keyframe && !last->keyframe) {
+      last->keyframe = TRUE;
+      last->pts = pts;
+    }
+    goto done;
+  }
+
+  if (last && (offset < last->offset || scr < last->scr))
+    goto done;
+  if (!keyframe && last && scr < last->scr + INDEX_SCR_INTERVAL)
+    goto done;
+
+  entry.offset = offset;
+  entry.scr = scr;
+  entry.pts = keyframe ? pts : G_MAXUINT64;
+  entry.keyframe = keyframe;
+  g_array_append_val (demux->index, entry);
+
+  GST_LOG_OBJECT (demux, "index entry %u at offset %" G_GUINT64_FORMAT
+      " SCR %" G_GUINT64_FORMAT " keyframe %d PTS %" G_GUINT64_FORMAT,
+      demux->index->len - 1, offset, scr, keyframe, entry.pts);
+
+done:
+  GST_OBJECT_UNLOCK (demux);
+}
+
+/* Called for every pack. The index is only extended while demuxing goes on
+ * from inside of what it covers already, so that it has no holes */
+static void
+gst_ps_demux_index_pack (GstPsDemux * demux, guint64 scr)
+{
+  guint64 offset = demux->adapter_offset;
+  gboolean add = FALSE;
+
+  demux->cur_pack_offset = offset;
+  demux->cur_pack_scr = scr;
+
+  GST_OBJECT_LOCK (demux);
+  if (offset == G_MAXUINT64 || demux->sink_segment.rate < 0.0) {
+    demux->index_contiguous = FALSE;
+    goto done;
+  }
+
+  if (!demux->index_contiguous && (demux->index->len == 0
+          || offset <= demux->index_end))
+    demux->index_contiguous = TRUE;
+
+  if (!demux->index_contiguous || offset <= demux->index_end)
+    goto done;
+
+  demux->index_end = offset;
+  demux->index_end_scr = scr;
+  add = TRUE;
+
+done:
+  GST_OBJECT_UNLOCK (demux);
+
+  if (add)
+    gst_ps_demux_index_add (demux, offset, scr, G_MAXUINT64, FALSE);
+}
+
+/* Whether entries are currently added to the index while demuxing */
+static gboolean
+gst_ps_demux_index_is_growing (GstPsDemux * demux)
+{
+  gboolean ret;
+
+  GST_OBJECT_LOCK (demux);
+  ret = demux->index_contiguous && !demux->index_complete;
+  GST_OBJECT_UNLOCK (demux);
+
+  return ret;
+}
+
+/* Drops an imported index if it was created for a stream of another size */
+static void
+gst_ps_demux_index_validate (GstPsDemux * demux)
+{
+  guint64 index_size;
+  gint64 size;
+
+  GST_OBJECT_LOCK (demux);
+  index_size = demux->index_size;
+  demux->index_size = 0;
+  GST_OBJECT_UNLOCK (demux);
+
+  if (index_size == 0)
+    return;
+
+  if (gst_pad_peer_query_duration (demux->sinkpad, GST_FORMAT_BYTES, &size)
+      && size > 0 && (guint64) size != index_size) {
+    GST_WARNING_OBJECT (demux, "Imported index is for a stream of %"
+        G_GUINT64_FORMAT " bytes, not %" G_GINT64_FORMAT, index_size, size);
+    gst_ps_demux_index_clear (demux);
+  }
+}
+
+/* Looks up the last keyframe presented at or before @pts. Fails if the
+ * index doesn't reach past @pts yet. Without keyframes nearby the last
+ * entry before @pts is returned */
+static gboolean
+gst_ps_demux_index_lookup (GstPsDemux * demux, guint64 pts,
+    GstPsDemuxIndexEntry * entry)
+{
+  GstPsDemuxIndexEntry *e;
+  guint lo = 0, hi, i;
+  gboolean ret = FALSE;
+
+  GST_OBJECT_LOCK (demux);
+  if (demux->index->len == 0 ||
+      (!demux->index_complete && demux->index_end_scr <= pts))
+    goto done;
+
+  /* a frame is always delivered before it is presented, so its keyframe
+   * is in a pack with a smaller SCR */
+  hi = demux->index->len;
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+
+    if (g_array_index (demux->index, GstPsDemuxIndexEntry, mid).scr <= pts)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo == 0)
+    goto done;
+
+  for (i = lo; i > 0; i--) {
+    e = &g_array_index (demux->index, GstPsDemuxIndexEntry, i - 1);
+    if (e->keyframe && e->pts <= pts) {
+      *entry = *e;
+      ret = TRUE;
+      goto done;
+    }
+    if (e->scr + INDEX_MAX_KEYFRAME_DISTANCE < pts)
+      break;
+  }
+
+  *entry = g_array_index (demux->index, GstPsDemuxIndexEntry, lo - 1);
+  if (entry->keyframe && entry->pts > pts)
+    entry->keyframe = FALSE;
+  ret = TRUE;
+
+done:
+  GST_OBJECT_UNLOCK (demux);
+
+  return ret;
+}
+
+#define INDEX_MAGIC 0x50534958       /* "PSIX" */
+#define INDEX_HEADER_SIZE 24
+#define INDEX_ENTRY_SIZE 25
+#define INDEX_VERSION 1
+
+/* Serializes the index as big endian "PSIX" magic, version, stream size,
+ * flags and number of entries, followed by offset, SCR, PTS and keyframe
+ * flag for every entry */
+static GBytes *
+gst_ps_demux_index_export (GstPsDemux * demux)
+{
+  gint64 size = 0;
+  guint8 *data, *p;
+  gsize len;
+  guint i;
+
+  gst_pad_peer_query_duration (demux->sinkpad, GST_FORMAT_BYTES, &size);
+
+  GST_OBJECT_LOCK (demux);
+  len = INDEX_HEADER_SIZE + demux->index->len * INDEX_ENTRY_SIZE;
+  p = data = g_malloc (len);
+  GST_WRITE_UINT32_BE (p, INDEX_MAGIC);
+  GST_WRITE_UINT32_BE (p + 4, INDEX_VERSION);
+  GST_WRITE_UINT64_BE (p + 8, MAX (size, 0));
+  GST_WRITE_UINT32_BE (p + 16, demux->index_complete ? 1 : 0);
+  GST_WRITE_UINT32_BE (p + 20, demux->index->len);
+  p += INDEX_HEADER_SIZE;
+
+  for (i = 0; i < demux->index->len; i++) {
+    GstPsDemuxIndexEntry *e =
+        &g_array_index (demux->index, GstPsDemuxIndexEntry, i);
+
+    GST_WRITE_UINT64_BE (p, e->offset);
+    GST_WRITE_UINT64_BE (p + 8, e->scr);
+    GST_WRITE_UINT64_BE (p + 16, e->pts);
+    GST_WRITE_UINT8 (p + 24, e->keyframe ? 1 : 0);
+    p += INDEX_ENTRY_SIZE;
+  }
+  GST_OBJECT_UNLOCK (demux);
+
+  return g_bytes_new_take (data, len);
+}
+
+static void
+gst_ps_demux_index_import (GstPsDemux * demux, GBytes * bytes)
+{
+  const guint8 *data;
+  gsize size;
+  guint n, i;
+
+  gst_ps_demux_index_clear (demux);
+
+  if (bytes == NULL)
+    return;
+
+  data = g_bytes_get_data (bytes, &size);
+  if (size < INDEX_HEADER_SIZE
+      || GST_READ_UINT32_BE (data) != INDEX_MAGIC
+      || GST_READ_UINT32_BE (data + 4) != INDEX_VERSION)
+    goto invalid;
+
+  n = GST_READ_UINT32_BE (data + 20);
+  if ((size - INDEX_HEADER_SIZE) / INDEX_ENTRY_SIZE < n)
+    goto invalid;
+
+  GST_OBJECT_LOCK (demux);
+  demux->index_size = GST_READ_UINT64_BE (data + 8);
+  demux->index_complete = (GST_READ_UINT32_BE (data + 16) & 1) != 0;
+  data += INDEX_HEADER_SIZE;
+  for (i = 0; i < n; i++) {
+    GstPsDemuxIndexEntry e;
+
+    e.offset = GST_READ_UINT64_BE (data);
+    e.scr = GST_READ_UINT64_BE (data + 8);
+    e.pts = GST_READ_UINT64_BE (data + 16);
+    e.keyframe = GST_READ_UINT8 (data + 24) != 0;
+    data += INDEX_ENTRY_SIZE;
+
+    if (demux->index->len > 0 && e.offset <= g_array_index (demux->index,
+            GstPsDemuxIndexEntry, demux->index->len - 1).offset) {
+      GST_OBJECT_UNLOCK (demux);
+      goto invalid;
+    }
+    g_array_append_val (demux->index, e);
+  }
+  if (n > 0) {
+    demux->index_end = g_array_index (demux->index, GstPsDemuxIndexEntry,
+        n - 1).offset;
+    demux->index_end_scr = g_array_index (demux->index, GstPsDemuxIndexEntry,
+        n - 1).scr;
+  }
+  GST_OBJECT_UNLOCK (demux);
+
+  GST_DEBUG_OBJECT (demux, "Imported index with %u entries", n);
+
+  return;
+
+invalid:
+  GST_WARNING_OBJECT (demux, "Ignoring invalid index");
+  gst_ps_demux_index_clear (demux);
+}
+
 static gboolean
 gst_ps_demux_handle_seek_push (GstPsDemux * demux, GstEvent * event)
 {
@@ -1136,6 +1544,7 @@ gst_ps_demux_handle_seek_push (GstPsDemux * demux, GstEvent * event)
   gint64 start, stop;
   gint64 bstart, bstop;
   GstEvent *bevent;
+  GstPsDemuxIndexEntry entry;
 
   gst_event_parse_seek (event, &rate, &format, &flags, &start_type, &start,
       &stop_type, &stop);
@@ -1168,9 +1577,17 @@ gst_ps_demux_handle_seek_push (GstPsDemux * demux, GstEvent * event)
     goto not_supported;
   }
 
-  GST_DEBUG_OBJECT (demux, "try with scr_rate interpolation");
-
-  bstart = GSTTIME_TO_BYTES ((guint64) start);
+  gst_ps_demux_index_validate (demux);
+  if (start_type == GST_SEEK_TYPE_SET && demux->base_time != G_MAXUINT64 &&
+      gst_ps_demux_index_lookup (demux,
+          GSTTIME_TO_MPEGTIME ((guint64) start + demux->base_time), &entry)) {
+    GST_DEBUG_OBJECT (demux, "using index entry at offset %" G_GUINT64_FORMAT,
+        entry.offset);
+    bstart = entry.offset;
+  } else {
+    GST_DEBUG_OBJECT (demux, "try with scr_rate interpolation");
+    bstart = GSTTIME_TO_BYTES ((guint64) start);
+  }
   bstop = GSTTIME_TO_BYTES ((guint64) stop);
 
   GST_DEBUG_OBJECT (demux, "in bytes bstart %" G_GINT64_FORMAT " bstop %"
@@ -1231,11 +1648,39 @@ find_offset (GstPsDemux * demux, guint64 scr,
 }
 
 static inline gboolean
-gst_ps_demux_do_seek (GstPsDemux * demux, GstSegment * seeksegment)
+gst_ps_demux_do_seek (GstPsDemux * demux, GstSegment * seeksegment,
+    GstSeekFlags flags)
 {
   gboolean found;
   guint64 fscr, offset;
   guint64 scr = GSTTIME_TO_MPEGTIME (seeksegment->position + demux->base_time);
+  GstPsDemuxIndexEntry entry;
+
+  gst_ps_demux_index_validate (demux);
+  if (demux->index_scan)
+    gst_ps_demux_index_scan (demux, scr);
+
+  if (seeksegment->rate > 0.0 &&
+      gst_ps_demux_index_lookup (demux, scr, &entry)) {
+    GST_INFO_OBJECT (demux, "seeking to index entry at offset %"
+        G_GUINT64_FORMAT " SCR %" G_GUINT64_FORMAT " keyframe %d",
+        entry.offset, entry.scr, entry.keyframe);
+
+    if ((flags & GST_SEEK_FLAG_KEY_UNIT) && entry.keyframe) {
+      GstClockTime kf_time = MPEGTIME_TO_GSTTIME (entry.pts);
+
+      kf_time = kf_time > demux->base_time ? kf_time - demux->base_time : 0;
+      GST_DEBUG_OBJECT (demux, "snapping to keyframe at %" GST_TIME_FORMAT,
+          GST_TIME_ARGS (kf_time));
+      seeksegment->start = seeksegment->time = seeksegment->position =
+          kf_time;
+    }
+
+    gst_segment_set_position (&demux->sink_segment, GST_FORMAT_BYTES,
+        entry.offset);
+
+    return TRUE;
+  }
 
   /* In some clips the PTS values are completely unaligned with SCR values.
    * To improve the seek in that situation we apply a factor considering the
@@ -1307,7 +1752,6 @@ gst_ps_demux_handle_seek_pull (GstPsDemux * demux, GstEvent * event)
     goto no_scr_rate;
 
   flush = flags & GST_SEEK_FLAG_FLUSH;
-  /* keyframe = flags & GST_SEEK_FLAG_KEY_UNIT; *//* FIXME */
 
   if (flush) {
     /* Flush start up and downstream to make sure data flow and loops are
@@ -1345,7 +1789,7 @@ gst_ps_demux_handle_seek_pull (GstPsDemux * demux, GstEvent * event)
 
   if (flush || seeksegment.position != demux->src_segment.position) {
     /* Do the actual seeking */
-    if (!gst_ps_demux_do_seek (demux, &seeksegment)) {
+    if (!gst_ps_demux_do_seek (demux, &seeksegment, flags)) {
       return FALSE;
     }
   }
@@ -1926,6 +2370,8 @@ gst_ps_demux_parse_pack_start (GstPsDemux * demux)
       MPEGTIME_TO_GSTTIME (demux->current_scr - demux->first_scr));
 
 out:
+  gst_ps_demux_index_pack (demux, scr);
+
   gst_adapter_unmap (demux->adapter);
   gst_adapter_flush (demux->adapter, length);
   ADAPTER_OFFSET_FLUSH (length);
@@ -2300,11 +2746,15 @@ gst_ps_demux_data_cb (GstPESFilter * filter, gboolean first,
   gint stream_type;
   guint32 start_code;
   guint8 id;
-  GstMapInfo map;
+  guint8 hdr_data[4];
   gsize datalen;
   guint offset = 0;
-  gst_buffer_map (buffer, &map, GST_MAP_READ);
-  datalen = map.size;
+
+  /* Only the first bytes are looked at, don't map the payload as that would
+   * merge it into a single memory if it spans several input buffers */
+  datalen = gst_buffer_get_size (buffer);
+  if (first)
+    gst_buffer_extract (buffer, 0, hdr_data, MIN (datalen, sizeof (hdr_data)));
   start_code = filter->start_code;
   id = filter->id;
   if (first) {
@@ -2317,7 +2767,7 @@ gst_ps_demux_data_cb (GstPESFilter * filter, gboolean first,
         /* VDR writes A52 streams without any header bytes
          * (see ftp://ftp.mplayerhq.hu/MPlayer/samples/MPEG-VOB/vdr-AC3) */
         if (datalen >= 4) {
-          guint hdr = GST_READ_UINT32_BE (map.data);
+          guint hdr = GST_READ_UINT32_BE (hdr_data);
           if (G_UNLIKELY ((hdr & 0xffff0000) == AC3_SYNC_WORD)) {
             id = 0x80;
             stream_type = demux->psm[id] = ST_GST_AUDIO_RAWA52;
@@ -2327,7 +2777,7 @@ gst_ps_demux_data_cb (GstPESFilter * filter, gboolean first,
 
         if (G_LIKELY (stream_type == -1)) {
           /* new id is in the first byte */
-          id = map.data[offset++];
+          id = hdr_data[offset++];
           datalen--;
           /* and remap */
           stream_type = demux->psm[id];
@@ -2338,7 +2788,7 @@ gst_ps_demux_data_cb (GstPESFilter * filter, gboolean first,
             /* Number of audio frames in this packet */
 #ifndef GST_DISABLE_GST_DEBUG
             guint8 nframes;
-            nframes = map.data[offset];
+            nframes = hdr_data[offset];
             GST_LOG_OBJECT (demux, "private type 0x%02x, %d frames", id,
                 nframes);
 #endif
@@ -2354,7 +2804,7 @@ gst_ps_demux_data_cb (GstPESFilter * filter, gboolean first,
         goto unknown_stream_type;
     } else if (stream_type == ST_AUDIO_MPEG1 || stream_type == ST_AUDIO_MPEG2) {
       if (datalen >= 2) {
-        guint hdr = GST_READ_UINT16_BE (map.data);
+        guint hdr = GST_READ_UINT16_BE (hdr_data);
         if ((hdr & 0xfff0) == 0xfff0) {
           switch (hdr & 0x06) {
             case 0x6:
@@ -2389,6 +2839,11 @@ gst_ps_demux_data_cb (GstPESFilter * filter, gboolean first,
 
     demux->current_stream =
         gst_ps_demux_get_stream (demux, id, stream_type, layer);
+
+    if (filter->pts != -1 && gst_ps_demux_index_is_growing (demux)
+        && gst_ps_demux_is_keyframe (stream_type, buffer, offset))
+      gst_ps_demux_index_add (demux, demux->cur_pack_offset,
+          demux->cur_pack_scr, filter->pts, TRUE);
   }
 
   if (G_UNLIKELY (demux->current_stream == NULL)) {
@@ -2423,7 +2878,6 @@ gst_ps_demux_data_cb (GstPESFilter * filter, gboolean first,
   }
 
 done:
-  gst_buffer_unmap (buffer, &map);
   gst_buffer_unref (buffer);
   return ret;
   /* ERRORS */
@@ -2924,6 +3378,161 @@ beach:
   return res;
 }
 
+/* Finds the payload of the first PES packet after the pack header at @pos
+ * of @data. Returns 0 if it is not complete in @data */
+static gsize
+gst_ps_demux_index_find_payload (const guint8 * data, gsize size, gsize pos,
+    guint8 * id)
+{
+  guint32 code;
+
+  if (pos + 14 > size)
+    return 0;
+
+  /* pack header */
+  if ((data[pos + 4] & 0xc0) == 0x40)
+    pos += 14 + (data[pos + 13] & 0x07);
+  else
+    pos += 12;
+
+  /* optional system header */
+  if (pos + 6 > size)
+    return 0;
+  if (GST_READ_UINT32_BE (data + pos) == ID_PS_SYSTEM_HEADER_START_CODE)
+    pos += 6 + GST_READ_UINT16_BE (data + pos + 4);
+
+  /* PES header */
+  if (pos + 9 > size)
+    return 0;
+  code = GST_READ_UINT32_BE (data + pos);
+  if (!gst_ps_demux_is_pes_sync (code))
+    return 0;
+  *id = code & 0xff;
+  pos += 6;
+
+  if ((data[pos] & 0xc0) == 0x80)
+    return pos + 3 + data[pos + 2];
+
+  /* MPEG-1: stuffing, STD buffer size and timestamps */
+  while (pos < size && data[pos] == 0xff)
+    pos++;
+  if (pos < size && (data[pos] & 0xc0) == 0x40)
+    pos += 2;
+  if (pos >= size)
+    return 0;
+  if ((data[pos] & 0xf0) == 0x20)
+    pos += 5;
+  else if ((data[pos] & 0xf0) == 0x30)
+    pos += 10;
+  else
+    pos++;
+
+  return pos < size ? pos : 0;
+}
+
+/* Extends the index in pull mode by scanning the packs from its end up to
+ * the first one with an SCR after @pts */
+static void
+gst_ps_demux_index_scan (GstPsDemux * demux, guint64 pts)
+{
+  guint64 offset, stop = demux->sink_segment.stop;
+  gboolean contiguous;
+  gboolean done = FALSE;
+
+  if (GST_PAD_MODE (demux->sinkpad) != GST_PAD_MODE_PULL
+      || stop == (guint64) - 1)
+    return;
+
+  GST_OBJECT_LOCK (demux);
+  if (demux->index_complete
+      || (demux->index->len > 0 && demux->index_end_scr > pts)) {
+    GST_OBJECT_UNLOCK (demux);
+    return;
+  }
+  offset = demux->index->len > 0 ? demux->index_end :
+      demux->sink_segment.start;
+
+  /* the streaming thread is stopped, add entries as if demuxing */
+  contiguous = demux->index_contiguous;
+  demux->index_contiguous = TRUE;
+  GST_OBJECT_UNLOCK (demux);
+
+  GST_DEBUG_OBJECT (demux, "scanning for index from offset %"
+      G_GUINT64_FORMAT " up to PTS %" G_GUINT64_FORMAT, offset, pts);
+
+  while (!done && offset < stop) {
+    GstBuffer *buffer = NULL;
+    GstMapInfo map;
+    gsize cursor, end_scan, payload;
+    gboolean eos;
+    guint64 scr, pack_pts, pack_offset;
+    guint8 id;
+
+    if (gst_pad_pull_range (demux->sinkpad, offset, MIN (BLOCK_SZ,
+                stop - offset), &buffer) != GST_FLOW_OK)
+      break;
+
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    eos = offset + map.size >= stop;
+
+    /* leave enough room after a pack start to parse the first PES and check
+     * it for a keyframe, except at the end of the stream */
+    if (eos && map.size >= SCAN_SCR_SZ)
+      end_scan = map.size - SCAN_SCR_SZ + 1;
+    else if (!eos && map.size > SCAN_PTS_SZ + 512)
+      end_scan = map.size - SCAN_PTS_SZ - 512;
+    else
+      end_scan = 0;
+
+    for (cursor = 0; cursor < end_scan; cursor++) {
+      if (GST_READ_UINT32_BE (map.data + cursor) != ID_PS_PACK_START_CODE ||
+          !gst_ps_demux_scan_ts (demux, map.data + cursor, SCAN_SCR, &scr,
+              map.data + map.size))
+        continue;
+
+      pack_offset = offset + cursor;
+      GST_OBJECT_LOCK (demux);
+      if (demux->index->len == 0 || pack_offset > demux->index_end) {
+        demux->index_end = pack_offset;
+        demux->index_end_scr = scr;
+        GST_OBJECT_UNLOCK (demux);
+        gst_ps_demux_index_add (demux, pack_offset, scr, G_MAXUINT64, FALSE);
+      } else {
+        GST_OBJECT_UNLOCK (demux);
+      }
+
+      payload = gst_ps_demux_index_find_payload (map.data, map.size, cursor,
+          &id);
+      if (payload && gst_ps_demux_scan_ts (demux, map.data + cursor,
+              SCAN_PTS, &pack_pts, map.data + map.size)
+          && gst_ps_demux_is_keyframe (demux->psm[id], buffer, payload))
+        gst_ps_demux_index_add (demux, pack_offset, scr, pack_pts, TRUE);
+
+      if (scr > pts) {
+        done = TRUE;
+        break;
+      }
+    }
+
+    gst_buffer_unmap (buffer, &map);
+    gst_buffer_unref (buffer);
+
+    if (end_scan == 0)
+      break;
+    offset = eos && !done ? stop : offset + cursor;
+  }
+
+  GST_OBJECT_LOCK (demux);
+  if (offset >= stop)
+    demux->index_complete = TRUE;
+  demux->index_contiguous = contiguous;
+
+  GST_DEBUG_OBJECT (demux, "index has %u entries up to offset %"
+      G_GUINT64_FORMAT "%s", demux->index->len, demux->index_end,
+      demux->index_complete ? ", complete" : "");
+  GST_OBJECT_UNLOCK (demux);
+}
+
 static inline GstFlowReturn
 gst_ps_demux_pull_block (GstPad * pad, GstPsDemux * demux,
     guint64 offset, guint size)
@@ -2986,6 +3595,12 @@ gst_ps_demux_loop (GstPad * pad)
           GST_TIME_ARGS (demux->src_segment.position),
           GST_TIME_ARGS (demux->src_segment.stop),
           demux->sink_segment.position, demux->sink_segment.stop);
+      if (demux->sink_segment.position >= demux->sink_segment.stop) {
+        GST_OBJECT_LOCK (demux);
+        if (demux->index_contiguous)
+          demux->index_complete = TRUE;
+        GST_OBJECT_UNLOCK (demux);
+      }
       ret = GST_FLOW_EOS;
       goto pause;
     }
@@ -3171,8 +3786,15 @@ gst_ps_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
         GST_BUFFER_OFFSET (buffer));
   }
 
-  /* We keep the offset to interpolate SCR */
-  demux->adapter_offset = GST_BUFFER_OFFSET (buffer);
+  /* We keep the offset of the start of the adapter to interpolate SCR and
+   * to index the packs. Without a discont it still holds the end of the
+   * previous buffer */
+  avail = gst_adapter_available (demux->adapter);
+  if (!discont && GST_BUFFER_OFFSET_IS_VALID (buffer)
+      && GST_BUFFER_OFFSET (buffer) >= avail)
+    demux->adapter_offset = GST_BUFFER_OFFSET (buffer) - avail;
+  else
+    demux->adapter_offset = GST_BUFFER_OFFSET (buffer);
   gst_adapter_push (demux->adapter, buffer);
   demux->bytes_since_scr += gst_buffer_get_size (buffer);
   avail = gst_adapter_available (demux->rev_adapter);
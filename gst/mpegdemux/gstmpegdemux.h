@@ -84,6 +84,16 @@ typedef enum
   STATE_PS_DEMUX_NEED_MORE_DATA,
 } GstPsDemuxState;
 
+/* Entry of the seek index, for a pack with a video keyframe or one every
+ * now and then with only its SCR */
+typedef struct
+{
+  guint64 offset;
+  guint64 scr;
+  guint64 pts;                  /* of the keyframe, or G_MAXUINT64 */
+  gboolean keyframe;
+} GstPsDemuxIndexEntry;
+
 /* Information associated with a single FluPS stream. */
 struct _GstPsStream
 {
@@ -157,8 +167,25 @@ struct _GstPsDemux
   /* Indicates an MPEG-2 stream */
   gboolean is_mpeg2_pack;
 
+  /* seek index sorted by offset, it and the index_* fields below are
+   * protected by the object lock */
+  GArray *index;
+  /* the index reaches the end of the stream */
+  gboolean index_complete;
+  /* stream size an imported index was created for, or 0 */
+  guint64 index_size;
+  /* demuxing continues from inside of what the index covers */
+  gboolean index_contiguous;
+  /* last pack the index covers */
+  guint64 index_end;
+  guint64 index_end_scr;
+  /* pack the current data belongs to */
+  guint64 cur_pack_offset;
+  guint64 cur_pack_scr;
+
   /* properties */
   gboolean ignore_scr;
+  gboolean index_scan;
 };
 
 struct _GstPsDemuxClass
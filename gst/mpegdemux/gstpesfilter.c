@@ -56,6 +56,11 @@ static GstFlowReturn gst_pes_filter_data_push (GstPESFilter * filter,
 
 #define ADAPTER_OFFSET_FLUSH(_bytes_)  if (filter->adapter_offset) *filter->adapter_offset = *filter->adapter_offset + (_bytes_)
 
+/* Start code and length followed by the largest possible header: 3 bytes of
+ * MPEG-2 flags and up to 255 bytes of optional fields. MPEG-1 headers with
+ * stuffing are always shorter */
+#define PES_HEADER_MAX_SIZE (6 + 3 + 255)
+
 /* May pass null for adapter to have the filter create one */
 void
 gst_pes_filter_init (GstPESFilter * filter, GstAdapter * adapter,
@@ -116,7 +121,7 @@ gst_pes_filter_parse (GstPESFilter * filter)
   gboolean STD_buffer_bound_scale G_GNUC_UNUSED;
   guint16 STD_buffer_size_bound;
   const guint8 *data;
-  gint avail, datalen;
+  gint avail, datalen, header_len;
   gboolean have_size = FALSE;
 
   avail = gst_adapter_available (filter->adapter);
@@ -176,16 +181,19 @@ gst_pes_filter_parse (GstPESFilter * filter)
 
   gst_adapter_unmap (filter->adapter);
 
-  /* read more data, either the whole packet if there is a length
-   * or whatever we have available if this in an unbounded packet. */
-  data = gst_adapter_map (filter->adapter, avail);
+  /* Only map what can contain the header. The payload, either the rest of
+   * the packet if there is a length or whatever we have available if this
+   * is an unbounded packet, is taken from the adapter later without merging
+   * it into a single memory */
+  header_len = MIN (avail, PES_HEADER_MAX_SIZE);
+  data = gst_adapter_map (filter->adapter, header_len);
 
   /* This will make us flag LOST_SYNC if we run out of data from here onward */
   have_size = TRUE;
 
   /* skip start code and length */
   data += 6;
-  datalen = avail - 6;
+  datalen = header_len - 6;
 
   GST_DEBUG ("datalen %d", datalen);
 
@@ -459,27 +467,29 @@ gst_pes_filter_parse (GstPESFilter * filter)
 push_out:
   {
     GstBuffer *out;
-#ifndef GST_DISABLE_GST_DEBUG
-    guint16 consumed;
+    gint consumed, payload;
 
-    consumed = avail - 6 - datalen;
-#endif
+    consumed = header_len - 6 - datalen;
+    payload = datalen < 0 ? 0 : avail - 6 - consumed;
 
     if (filter->unbounded_packet == FALSE) {
       filter->length -= avail - 6;
       GST_DEBUG ("pushing %d, need %d more, consumed %d",
-          datalen, filter->length, consumed);
+          payload, filter->length, consumed);
     } else {
       GST_DEBUG ("pushing %d, unbounded packet, consumed %d",
-          datalen, consumed);
+          payload, consumed);
     }
 
-    if (datalen > 0) {
-      out = gst_buffer_new_allocate (NULL, datalen, NULL);
-      gst_buffer_fill (out, 0, data, datalen);
+    gst_adapter_unmap (filter->adapter);
+
+    if (payload > 0) {
+      gst_adapter_flush (filter->adapter, avail - payload);
+      out = gst_adapter_take_buffer_fast (filter->adapter, payload);
       ret = gst_pes_filter_data_push (filter, TRUE, out);
       filter->first = FALSE;
     } else {
+      gst_adapter_flush (filter->adapter, avail);
       GST_LOG ("first being set to TRUE");
       filter->first = TRUE;
       ret = GST_FLOW_OK;
@@ -489,8 +499,6 @@ push_out:
       filter->state = STATE_DATA_PUSH;
   }
 
-  gst_adapter_unmap (filter->adapter);
-  gst_adapter_flush (filter->adapter, avail);
   ADAPTER_OFFSET_FLUSH (avail);
 
   return ret;
@@ -620,7 +628,7 @@ gst_pes_filter_process (GstPESFilter * filter)
         } else {
           GstBuffer *out;
 
-          out = gst_adapter_take_buffer (filter->adapter, avail);
+          out = gst_adapter_take_buffer_fast (filter->adapter, avail);
 
           ret = gst_pes_filter_data_push (filter, filter->first, out);
           filter->first = FALSE;
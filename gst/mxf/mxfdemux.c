@@ -78,7 +78,8 @@ static GstFlowReturn
 gst_mxf_demux_handle_index_table_segment (GstMXFDemux * demux,
     const MXFUL * key, GstBuffer * buffer, guint64 offset);
 
-static void collect_index_table_segments (GstMXFDemux * demux);
+static void collect_index_table_segments (GstMXFDemux * demux,
+    GstClockTime until);
 
 GType gst_mxf_demux_pad_get_type (void);
 G_DEFINE_TYPE (GstMXFDemuxPad, gst_mxf_demux_pad, GST_TYPE_PAD);
@@ -116,9 +117,16 @@ enum
   PROP_0,
   PROP_PACKAGE,
   PROP_MAX_DRIFT,
-  PROP_STRUCTURE
+  PROP_STRUCTURE,
+  PROP_FAST_OPEN,
+  PROP_GROWING,
+  PROP_GROWING_POLL_INTERVAL
 };
 
+#define DEFAULT_FAST_OPEN FALSE
+#define DEFAULT_GROWING FALSE
+#define DEFAULT_GROWING_POLL_INTERVAL (500 * GST_MSECOND)
+
 static gboolean gst_mxf_demux_sink_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
 static gboolean gst_mxf_demux_src_event (GstPad * pad, GstObject * parent,
@@ -166,6 +174,7 @@ gst_mxf_demux_reset_mxf_state (GstMXFDemux * demux)
   demux->partitions = NULL;
 
   demux->current_partition = NULL;
+  demux->metadata_partition = NULL;
 
   for (i = 0; i < demux->essence_tracks->len; i++) {
     GstMXFDemuxEssenceTrack *t =
@@ -227,6 +236,7 @@ gst_mxf_demux_reset_metadata (GstMXFDemux * demux)
     g_hash_table_destroy (demux->metadata);
   }
   demux->metadata = mxf_metadata_hash_table_new ();
+  g_array_set_size (demux->deferred_descriptive_metadata, 0);
 
   if (demux->tags) {
     gst_tag_list_unref (demux->tags);
@@ -246,6 +256,10 @@ gst_mxf_demux_reset (GstMXFDemux * demux)
   demux->footer_partition_pack_offset = 0;
   demux->offset = 0;
 
+  demux->growing_finished = FALSE;
+  demux->growing_size = 0;
+  demux->growing_scan_offset = 0;
+
   demux->pull_footer_metadata = TRUE;
 
   demux->run_in = -1;
@@ -285,7 +299,7 @@ gst_mxf_demux_reset (GstMXFDemux * demux)
 
     for (l = demux->index_tables; l; l = l->next) {
       GstMXFDemuxIndexTable *t = l->data;
-      g_array_free (t->offsets, TRUE);
+      g_array_free (t->segments, TRUE);
       g_free (t);
     }
     g_list_free (demux->index_tables);
@@ -293,6 +307,7 @@ gst_mxf_demux_reset (GstMXFDemux * demux)
   }
 
   demux->index_table_segments_collected = FALSE;
+  demux->index_partitions_collected = 0;
 
   gst_mxf_demux_reset_mxf_state (demux);
   gst_mxf_demux_reset_metadata (demux);
@@ -425,6 +440,13 @@ gst_mxf_demux_handle_partition_pack (GstMXFDemux * demux, const MXFUL * key,
   if (partition.type == MXF_PARTITION_PACK_HEADER)
     demux->footer_partition_pack_offset = partition.footer_partition;
 
+  /* A growing file is finished once the footer or the final header was
+   * written */
+  if (partition.type == MXF_PARTITION_PACK_FOOTER ||
+      (partition.type == MXF_PARTITION_PACK_HEADER && partition.closed
+          && partition.complete))
+    demux->growing_finished = TRUE;
+
   for (l = demux->partitions; l; l = l->next) {
     GstMXFDemuxPartition *tmp = l->data;
 
@@ -1432,42 +1454,25 @@ gst_mxf_demux_handle_metadata (GstMXFDemux * demux, const MXFUL * key,
   return ret;
 }
 
+/* Parses a descriptive metadata set found at @offset and adds it to the
+ * metadata. With @relink the tracks will be updated from the new metadata,
+ * otherwise it only extends the already linked metadata */
 static GstFlowReturn
-gst_mxf_demux_handle_descriptive_metadata (GstMXFDemux * demux,
-    const MXFUL * key, GstBuffer * buffer)
+gst_mxf_demux_add_descriptive_metadata (GstMXFDemux * demux,
+    const MXFUL * key, GstBuffer * buffer, const MXFPrimerPack * primer,
+    guint64 offset, gboolean relink)
 {
   guint32 type;
   guint8 scheme;
   GstMapInfo map;
-  GstFlowReturn ret = GST_FLOW_OK;
   MXFDescriptiveMetadata *m = NULL, *old = NULL;
 
   scheme = GST_READ_UINT8 (key->u + 12);
   type = GST_READ_UINT24_BE (key->u + 13);
 
-  GST_DEBUG_OBJECT (demux,
-      "Handling descriptive metadata of size %" G_GSIZE_FORMAT " at offset %"
-      G_GUINT64_FORMAT " with scheme 0x%02x and type 0x%06x",
-      gst_buffer_get_size (buffer), demux->offset, scheme, type);
-
-  if (G_UNLIKELY (!demux->current_partition)) {
-    GST_ERROR_OBJECT (demux, "Partition pack doesn't exist");
-    return GST_FLOW_ERROR;
-  }
-
-  if (G_UNLIKELY (!demux->current_partition->primer.mappings)) {
-    GST_ERROR_OBJECT (demux, "Primer pack doesn't exists");
-    return GST_FLOW_ERROR;
-  }
-
-  if (demux->current_partition->parsed_metadata) {
-    GST_DEBUG_OBJECT (demux, "Metadata of this partition was already parsed");
-    return GST_FLOW_OK;
-  }
-
   gst_buffer_map (buffer, &map, GST_MAP_READ);
-  m = mxf_descriptive_metadata_new (scheme, type,
-      &demux->current_partition->primer, demux->offset, map.data, map.size);
+  m = mxf_descriptive_metadata_new (scheme, type, primer, offset, map.data,
+      map.size);
   gst_buffer_unmap (buffer, &map);
 
   if (!m) {
@@ -1509,15 +1514,95 @@ gst_mxf_demux_handle_descriptive_metadata (GstMXFDemux * demux,
 
   g_rw_lock_writer_lock (&demux->metadata_lock);
 
-  demux->update_metadata = TRUE;
-  gst_mxf_demux_reset_linked_metadata (demux);
+  if (relink) {
+    demux->update_metadata = TRUE;
+    gst_mxf_demux_reset_linked_metadata (demux);
+  }
 
   g_hash_table_replace (demux->metadata, &MXF_METADATA_BASE (m)->instance_uid,
       m);
 
   g_rw_lock_writer_unlock (&demux->metadata_lock);
 
-  return ret;
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+gst_mxf_demux_handle_descriptive_metadata (GstMXFDemux * demux,
+    const MXFUL * key, GstBuffer * buffer)
+{
+  GST_DEBUG_OBJECT (demux,
+      "Handling descriptive metadata of size %" G_GSIZE_FORMAT " at offset %"
+      G_GUINT64_FORMAT " with scheme 0x%02x and type 0x%06x",
+      gst_buffer_get_size (buffer), demux->offset, GST_READ_UINT8 (key->u + 12),
+      GST_READ_UINT24_BE (key->u + 13));
+
+  if (G_UNLIKELY (!demux->current_partition)) {
+    GST_ERROR_OBJECT (demux, "Partition pack doesn't exist");
+    return GST_FLOW_ERROR;
+  }
+
+  if (G_UNLIKELY (!demux->current_partition->primer.mappings)) {
+    GST_ERROR_OBJECT (demux, "Primer pack doesn't exists");
+    return GST_FLOW_ERROR;
+  }
+
+  if (demux->current_partition->parsed_metadata) {
+    GST_DEBUG_OBJECT (demux, "Metadata of this partition was already parsed");
+    return GST_FLOW_OK;
+  }
+
+  /* Descriptive metadata is not needed for playback, only remember where it
+   * is and parse it when the structure is requested */
+  if (demux->fast_open && demux->random_access) {
+    GstMXFDemuxDeferredMetadata deferred;
+
+    GST_DEBUG_OBJECT (demux, "Deferring descriptive metadata");
+    deferred.offset = demux->offset;
+    deferred.partition = demux->current_partition;
+    g_array_append_val (demux->deferred_descriptive_metadata, deferred);
+    return GST_FLOW_OK;
+  }
+
+  return gst_mxf_demux_add_descriptive_metadata (demux, key, buffer,
+      &demux->current_partition->primer, demux->offset, TRUE);
+}
+
+/* Called from the streaming thread */
+static void
+gst_mxf_demux_parse_deferred_descriptive_metadata (GstMXFDemux * demux)
+{
+  guint i;
+  gboolean added = FALSE;
+
+  GST_DEBUG_OBJECT (demux, "Parsing %u deferred descriptive metadata sets",
+      demux->deferred_descriptive_metadata->len);
+
+  for (i = 0; i < demux->deferred_descriptive_metadata->len; i++) {
+    GstMXFDemuxDeferredMetadata *deferred =
+        &g_array_index (demux->deferred_descriptive_metadata,
+        GstMXFDemuxDeferredMetadata, i);
+    GstBuffer *buffer = NULL;
+    MXFUL key;
+
+    if (gst_mxf_demux_pull_klv_packet (demux, deferred->offset, &key, &buffer,
+            NULL) != GST_FLOW_OK)
+      continue;
+
+    if (mxf_is_descriptive_metadata (&key) &&
+        gst_mxf_demux_add_descriptive_metadata (demux, &key, buffer,
+            &deferred->partition->primer, deferred->offset,
+            FALSE) == GST_FLOW_OK)
+      added = TRUE;
+
+    gst_buffer_unref (buffer);
+  }
+  g_array_set_size (demux->deferred_descriptive_metadata, 0);
+
+  /* A pending update resolves everything anyway */
+  if (added && demux->preface && demux->metadata_resolved
+      && !demux->update_metadata)
+    gst_mxf_demux_resolve_references (demux);
 }
 
 static GstFlowReturn
@@ -1683,6 +1768,378 @@ gst_mxf_demux_pad_set_component (GstMXFDemux * demux, GstMXFDemuxPad * pad,
   return ret;
 }
 
+static void
+gst_mxf_demux_index_segment_clear (GstMXFDemuxIndexSegment * segment)
+{
+  g_free (segment->entries);
+  segment->entries = NULL;
+}
+
+#define INDEX_ENTRY_IS_KEYFRAME(e) \
+    (((e)->flags & 0x80) || (e)->key_frame_offset == 0)
+
+static GstMXFDemuxIndexTable *
+gst_mxf_demux_find_index_table (GstMXFDemux * demux, guint32 body_sid,
+    guint32 index_sid)
+{
+  GList *l;
+
+  for (l = demux->index_tables; l; l = l->next) {
+    GstMXFDemuxIndexTable *t = l->data;
+
+    if (t->body_sid == body_sid && t->index_sid == index_sid)
+      return t;
+  }
+
+  return NULL;
+}
+
+/* Number of edit units of @segment the index knows about */
+static gint64
+gst_mxf_demux_index_segment_get_covered (const GstMXFDemuxIndexSegment *
+    segment)
+{
+  if (segment->n_entries > 0)
+    return MIN (segment->n_entries, segment->duration);
+  else if (segment->edit_unit_byte_count > 0)
+    return segment->duration;
+  else
+    return 0;
+}
+
+/* Returns the segment containing edit unit @position, or with @closest the
+ * last one starting before it */
+static GstMXFDemuxIndexSegment *
+gst_mxf_demux_index_table_find_segment (GstMXFDemuxIndexTable * table,
+    gint64 position, gboolean closest)
+{
+  GstMXFDemuxIndexSegment *segment;
+  guint lo = 0, hi = table->segments->len;
+
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+
+    segment = &g_array_index (table->segments, GstMXFDemuxIndexSegment, mid);
+    if (segment->start <= position)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if (lo == 0)
+    return NULL;
+
+  segment = &g_array_index (table->segments, GstMXFDemuxIndexSegment, lo - 1);
+  if (!closest && position >= segment->start +
+      gst_mxf_demux_index_segment_get_covered (segment))
+    return NULL;
+
+  return segment;
+}
+
+/* Fills @entry for the edit unit stored at @position, CBR essence gets
+ * entries made up from its edit unit byte count */
+static gboolean
+gst_mxf_demux_index_table_lookup (GstMXFDemuxIndexTable * table,
+    gint64 position, GstMXFDemuxIndexEntry * entry)
+{
+  GstMXFDemuxIndexSegment *segment;
+
+  if (position < 0)
+    return FALSE;
+
+  segment = gst_mxf_demux_index_table_find_segment (table, position, FALSE);
+  if (!segment)
+    return FALSE;
+
+  if (segment->n_entries > 0) {
+    *entry = segment->entries[position - segment->start];
+  } else {
+    entry->stream_offset = position * segment->edit_unit_byte_count;
+    entry->temporal_offset = 0;
+    entry->key_frame_offset = 0;
+    entry->flags = 0x80;
+  }
+
+  return TRUE;
+}
+
+/* Returns the presentation position of the edit unit stored at @position
+ * or G_MAXUINT64 if it is presented in stored order */
+static guint64
+gst_mxf_demux_index_table_get_pts (GstMXFDemuxIndexTable * table,
+    gint64 position)
+{
+  GstMXFDemuxIndexEntry entry;
+  gint delta;
+
+  /* The entry of each edit unit tells where the edit unit presented at its
+   * position is stored, so look for the one pointing at us. Temporal offsets
+   * are at most 128 edit units */
+  if (!gst_mxf_demux_index_table_lookup (table, position, &entry)
+      || entry.temporal_offset == 0)
+    return G_MAXUINT64;
+
+  for (delta = 1; delta <= 128; delta++) {
+    if (gst_mxf_demux_index_table_lookup (table, position - delta, &entry)
+        && entry.temporal_offset == delta)
+      return position - delta;
+    if (gst_mxf_demux_index_table_lookup (table, position + delta, &entry)
+        && entry.temporal_offset == -delta)
+      return position + delta;
+  }
+
+  return G_MAXUINT64;
+}
+
+/* Returns the edit unit containing @stream_offset or -1 */
+static gint64
+gst_mxf_demux_index_table_find_position (GstMXFDemuxIndexTable * table,
+    guint64 stream_offset)
+{
+  GstMXFDemuxIndexSegment *segment;
+  guint lo = 0, hi = table->segments->len;
+
+  /* Edit units are stored in order, so stream offsets increase with the
+   * position across all segments */
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+    guint64 first;
+
+    segment = &g_array_index (table->segments, GstMXFDemuxIndexSegment, mid);
+    if (segment->n_entries > 0)
+      first = segment->entries[0].stream_offset;
+    else
+      first = segment->start * segment->edit_unit_byte_count;
+
+    if (first <= stream_offset)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if (lo == 0)
+    return -1;
+
+  segment = &g_array_index (table->segments, GstMXFDemuxIndexSegment, lo - 1);
+  if (segment->n_entries == 0) {
+    gint64 position = stream_offset / segment->edit_unit_byte_count;
+
+    return position < segment->start + segment->duration ? position : -1;
+  }
+
+  lo = 0;
+  hi = gst_mxf_demux_index_segment_get_covered (segment);
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+
+    if (segment->entries[mid].stream_offset <= stream_offset)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo > 0 ? segment->start + lo - 1 : -1;
+}
+
+/* Returns the offset of @stream_offset of the essence container @body_sid
+ * relative to the run-in, or -1 if not inside any known partition */
+static guint64
+gst_mxf_demux_find_stream_offset (GstMXFDemux * demux, guint32 body_sid,
+    guint64 stream_offset)
+{
+  GstMXFDemuxPartition *offset_partition = NULL, *next_partition = NULL;
+  guint64 offset;
+  GList *l;
+
+  for (l = demux->partitions; l; l = l->next) {
+    GstMXFDemuxPartition *partition = l->data;
+
+    if (!next_partition && offset_partition)
+      next_partition = partition;
+
+    if (partition->partition.body_sid != body_sid)
+      continue;
+    if (partition->partition.body_offset > stream_offset)
+      break;
+
+    offset_partition = partition;
+    next_partition = NULL;
+  }
+
+  if (!offset_partition
+      || stream_offset < offset_partition->partition.body_offset)
+    return -1;
+
+  offset =
+      offset_partition->partition.this_partition +
+      offset_partition->essence_container_offset + (stream_offset -
+      offset_partition->partition.body_offset);
+
+  if (next_partition && offset >= next_partition->partition.this_partition) {
+    GST_ERROR_OBJECT (demux,
+        "Invalid index table segment going into next unrelated partition");
+    return -1;
+  }
+
+  return offset;
+}
+
+/* Returns the offset of the closest edit unit at or before @position, or of
+ * the closest keyframe, and updates @position to it */
+static guint64
+gst_mxf_demux_index_table_find_closest (GstMXFDemux * demux,
+    GstMXFDemuxIndexTable * table, gint64 * position, gboolean keyframe)
+{
+  gint64 current_position = *position;
+
+  while (current_position >= 0) {
+    GstMXFDemuxIndexSegment *segment;
+    GstMXFDemuxIndexEntry entry;
+    gint64 covered;
+    guint64 offset;
+
+    segment =
+        gst_mxf_demux_index_table_find_segment (table, current_position, TRUE);
+    if (!segment)
+      break;
+
+    covered = gst_mxf_demux_index_segment_get_covered (segment);
+    if (current_position >= segment->start + covered) {
+      current_position = segment->start + covered - 1;
+      continue;
+    }
+
+    gst_mxf_demux_index_table_lookup (table, current_position, &entry);
+    if (keyframe && !INDEX_ENTRY_IS_KEYFRAME (&entry)) {
+      /* Jump to the keyframe this edit unit depends on */
+      if (entry.key_frame_offset < 0)
+        current_position += entry.key_frame_offset;
+      else
+        current_position--;
+      continue;
+    }
+
+    offset =
+        gst_mxf_demux_find_stream_offset (demux, table->body_sid,
+        entry.stream_offset);
+    if (offset == -1) {
+      current_position--;
+      continue;
+    }
+
+    *position = current_position;
+    return offset;
+  }
+
+  return -1;
+}
+
+/* Inserts @segment sorted by start position. Segments can be repeated in
+ * multiple partitions, in which case the most complete copy is kept */
+static void
+gst_mxf_demux_index_table_add_segment (GstMXFDemuxIndexTable * table,
+    GstMXFDemuxIndexSegment * segment)
+{
+  GstMXFDemuxIndexSegment *prev;
+  guint lo = 0, hi = table->segments->len;
+
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+
+    if (g_array_index (table->segments, GstMXFDemuxIndexSegment,
+            mid).start <= segment->start)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if (lo > 0) {
+    prev = &g_array_index (table->segments, GstMXFDemuxIndexSegment, lo - 1);
+    if (prev->start == segment->start) {
+      if (gst_mxf_demux_index_segment_get_covered (segment) >
+          gst_mxf_demux_index_segment_get_covered (prev)) {
+        gst_mxf_demux_index_segment_clear (prev);
+        *prev = *segment;
+      } else {
+        gst_mxf_demux_index_segment_clear (segment);
+      }
+      return;
+    }
+  }
+
+  g_array_insert_val (table->segments, lo, *segment);
+}
+
+/* Moves all pending index table segments into their index tables */
+static void
+gst_mxf_demux_merge_index_table_segments (GstMXFDemux * demux)
+{
+  GList *l;
+  guint i;
+
+  for (l = demux->pending_index_table_segments; l; l = l->next) {
+    MXFIndexTableSegment *segment = l->data;
+    GstMXFDemuxIndexTable *t;
+    GstMXFDemuxIndexSegment s = { 0, };
+
+    s.start = segment->index_start_position;
+    s.duration = segment->index_duration;
+    s.edit_unit_byte_count = segment->edit_unit_byte_count;
+    s.n_entries = segment->n_index_entries;
+
+    /* A CBR segment with a duration of 0 covers the rest of the essence
+     * container */
+    if (s.start >= 0 && s.duration == 0 && s.n_entries == 0
+        && s.edit_unit_byte_count > 0)
+      s.duration = G_MAXINT64 - s.start;
+
+    if (s.start < 0 || s.duration <= 0 || s.start > G_MAXINT64 - s.duration
+        || (s.n_entries == 0 && s.edit_unit_byte_count == 0)) {
+      GST_DEBUG_OBJECT (demux, "Skipping index table segment without entries");
+      continue;
+    }
+
+    t = gst_mxf_demux_find_index_table (demux, segment->body_sid,
+        segment->index_sid);
+    if (!t) {
+      t = g_new0 (GstMXFDemuxIndexTable, 1);
+      t->body_sid = segment->body_sid;
+      t->index_sid = segment->index_sid;
+      t->segments =
+          g_array_new (FALSE, FALSE, sizeof (GstMXFDemuxIndexSegment));
+      g_array_set_clear_func (t->segments,
+          (GDestroyNotify) gst_mxf_demux_index_segment_clear);
+      demux->index_tables = g_list_prepend (demux->index_tables, t);
+    }
+
+    if (s.n_entries > 0) {
+      s.entries = g_new (GstMXFDemuxIndexEntry, s.n_entries);
+      for (i = 0; i < s.n_entries; i++) {
+        s.entries[i].stream_offset = segment->index_entries[i].stream_offset;
+        s.entries[i].temporal_offset =
+            segment->index_entries[i].temporal_offset;
+        s.entries[i].key_frame_offset =
+            segment->index_entries[i].key_frame_offset;
+        s.entries[i].flags = segment->index_entries[i].flags;
+      }
+    }
+
+    gst_mxf_demux_index_table_add_segment (t, &s);
+
+    GST_DEBUG_OBJECT (demux, "Index table for body SID %u index SID %u has "
+        "%u segments", t->body_sid, t->index_sid, t->segments->len);
+  }
+
+  for (l = demux->pending_index_table_segments; l; l = l->next) {
+    MXFIndexTableSegment *s = l->data;
+    mxf_index_table_segment_reset (s);
+    g_free (s);
+  }
+  g_list_free (demux->pending_index_table_segments);
+  demux->pending_index_table_segments = NULL;
+}
+
 static GstFlowReturn
 gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
     const MXFUL * key, GstBuffer * buffer, gboolean peek)
@@ -1693,9 +2150,9 @@ gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
   GstBuffer *inbuf = NULL;
   GstBuffer *outbuf = NULL;
   GstMXFDemuxEssenceTrack *etrack = NULL;
+  GstMXFDemuxIndexTable *index_table;
   gboolean keyframe = TRUE;
-  /* As in GstMXFDemuxIndex */
-  guint64 pts = G_MAXUINT64, dts = G_MAXUINT64;
+  guint64 pts = G_MAXUINT64;
 
   GST_DEBUG_OBJECT (demux,
       "Handling generic container essence element of size %" G_GSIZE_FORMAT
@@ -1746,10 +2203,25 @@ gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
     return GST_FLOW_OK;
   }
 
+  index_table =
+      gst_mxf_demux_find_index_table (demux, etrack->body_sid,
+      etrack->index_sid);
+
   if (etrack->position == -1) {
     GST_DEBUG_OBJECT (demux,
         "Unknown essence track position, looking into index");
-    if (etrack->offsets) {
+    if (index_table && demux->current_partition->partition.body_sid ==
+        etrack->body_sid) {
+      GstMXFDemuxPartition *p = demux->current_partition;
+      guint64 stream_offset =
+          demux->offset - demux->run_in - p->partition.this_partition -
+          p->essence_container_offset + p->partition.body_offset;
+
+      etrack->position =
+          gst_mxf_demux_index_table_find_position (index_table, stream_offset);
+    }
+
+    if (etrack->position == -1 && etrack->offsets) {
       for (i = 0; i < etrack->offsets->len; i++) {
         GstMXFDemuxIndex *idx =
             &g_array_index (etrack->offsets, GstMXFDemuxIndex, i);
@@ -1773,10 +2245,6 @@ gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
         &g_array_index (etrack->offsets, GstMXFDemuxIndex, etrack->position);
     if (index->initialized && index->offset != 0)
       keyframe = index->keyframe;
-    if (index->initialized && index->pts != G_MAXUINT64)
-      pts = index->pts;
-    if (index->initialized && index->dts != G_MAXUINT64)
-      dts = index->dts;
   }
 
   /* Create subbuffer to be able to change metadata */
@@ -1812,39 +2280,21 @@ gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
     keyframe = !GST_BUFFER_FLAG_IS_SET (outbuf, GST_BUFFER_FLAG_DELTA_UNIT);
 
   /* Prefer keyframe information from index tables over everything else */
-  if (demux->index_tables) {
-    GList *l;
-    GstMXFDemuxIndexTable *index_table = NULL;
+  if (index_table) {
+    GstMXFDemuxIndexEntry entry;
 
-    for (l = demux->index_tables; l; l = l->next) {
-      GstMXFDemuxIndexTable *tmp = l->data;
+    if (gst_mxf_demux_index_table_lookup (index_table, etrack->position,
+            &entry)) {
+      keyframe = INDEX_ENTRY_IS_KEYFRAME (&entry);
 
-      if (tmp->body_sid == etrack->body_sid
-          && tmp->index_sid == etrack->index_sid) {
-        index_table = tmp;
-        break;
-      }
-    }
-
-    if (index_table && index_table->offsets->len > etrack->position) {
-      GstMXFDemuxIndex *index =
-          &g_array_index (index_table->offsets, GstMXFDemuxIndex,
-          etrack->position);
-      if (index->initialized && index->offset != 0) {
-        keyframe = index->keyframe;
-
-        if (outbuf) {
-          if (keyframe)
-            GST_BUFFER_FLAG_UNSET (outbuf, GST_BUFFER_FLAG_DELTA_UNIT);
-          else
-            GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DELTA_UNIT);
-        }
+      if (outbuf) {
+        if (keyframe)
+          GST_BUFFER_FLAG_UNSET (outbuf, GST_BUFFER_FLAG_DELTA_UNIT);
+        else
+          GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DELTA_UNIT);
       }
 
-      if (index->initialized && index->pts != G_MAXUINT64)
-        pts = index->pts;
-      if (index->initialized && index->dts != G_MAXUINT64)
-        dts = index->dts;
+      pts = gst_mxf_demux_index_table_get_pts (index_table, etrack->position);
     }
   }
 
@@ -1858,16 +2308,12 @@ gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
 
       index->offset = demux->offset - demux->run_in;
       index->initialized = TRUE;
-      index->pts = pts;
-      index->dts = dts;
       index->keyframe = keyframe;
     } else if (etrack->position < G_MAXINT) {
       GstMXFDemuxIndex index;
 
       index.offset = demux->offset - demux->run_in;
       index.initialized = TRUE;
-      index.pts = pts;
-      index.dts = dts;
       index.keyframe = keyframe;
       if (etrack->offsets->len < etrack->position)
         g_array_set_size (etrack->offsets, etrack->position + 1);
@@ -2270,17 +2716,22 @@ gst_mxf_demux_handle_index_table_segment (GstMXFDemux * demux,
   demux->pending_index_table_segments =
       g_list_prepend (demux->pending_index_table_segments, segment);
 
+  /* Growing files have no complete index at the end, so use every segment
+   * right away */
+  if (demux->growing && demux->random_access)
+    gst_mxf_demux_merge_index_table_segments (demux);
+
   return GST_FLOW_OK;
 }
 
+/* Reads the key and the length of the KLV packet at @offset, @data_offset
+ * is set to the size of both */
 static GstFlowReturn
-gst_mxf_demux_pull_klv_packet (GstMXFDemux * demux, guint64 offset, MXFUL * key,
-    GstBuffer ** outbuf, guint * read)
+gst_mxf_demux_pull_klv_header (GstMXFDemux * demux, guint64 offset,
+    MXFUL * key, guint * data_offset, guint64 * length)
 {
   GstBuffer *buffer = NULL;
   const guint8 *data;
-  guint64 data_offset = 0;
-  guint64 length;
   GstFlowReturn ret = GST_FLOW_OK;
   GstMapInfo map;
 #ifndef GST_DISABLE_GST_DEBUG
@@ -2303,12 +2754,12 @@ gst_mxf_demux_pull_klv_packet (GstMXFDemux * demux, guint64 offset, MXFUL * key,
 
   /* Decode BER encoded packet length */
   if ((map.data[16] & 0x80) == 0) {
-    length = map.data[16];
-    data_offset = 17;
+    *length = map.data[16];
+    *data_offset = 17;
   } else {
     guint slen = map.data[16] & 0x7f;
 
-    data_offset = 16 + 1 + slen;
+    *data_offset = 16 + 1 + slen;
 
     gst_buffer_unmap (buffer, &map);
     gst_buffer_unref (buffer);
@@ -2329,9 +2780,9 @@ gst_mxf_demux_pull_klv_packet (GstMXFDemux * demux, guint64 offset, MXFUL * key,
     gst_buffer_map (buffer, &map, GST_MAP_READ);
 
     data = map.data;
-    length = 0;
+    *length = 0;
     while (slen) {
-      length = (length << 8) | *data;
+      *length = (*length << 8) | *data;
       data++;
       slen--;
     }
@@ -2343,31 +2794,45 @@ gst_mxf_demux_pull_klv_packet (GstMXFDemux * demux, guint64 offset, MXFUL * key,
 
   /* GStreamer's buffer sizes are stored in a guint so we
    * limit ourself to G_MAXUINT large buffers */
-  if (length > G_MAXUINT) {
+  if (*length > G_MAXUINT) {
     GST_ERROR_OBJECT (demux,
-        "Unsupported KLV packet length: %" G_GUINT64_FORMAT, length);
+        "Unsupported KLV packet length: %" G_GUINT64_FORMAT, *length);
     ret = GST_FLOW_ERROR;
     goto beach;
   }
 
   GST_DEBUG_OBJECT (demux, "KLV packet with key %s has length "
-      "%" G_GUINT64_FORMAT, mxf_ul_to_string (key, str), length);
+      "%" G_GUINT64_FORMAT, mxf_ul_to_string (key, str), *length);
+
+beach:
+  if (buffer)
+    gst_buffer_unref (buffer);
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_mxf_demux_pull_klv_packet (GstMXFDemux * demux, guint64 offset, MXFUL * key,
+    GstBuffer ** outbuf, guint * read)
+{
+  guint data_offset = 0;
+  guint64 length = 0;
+  GstFlowReturn ret;
+
+  ret = gst_mxf_demux_pull_klv_header (demux, offset, key, &data_offset,
+      &length);
+  if (ret != GST_FLOW_OK)
+    return ret;
 
   /* Pull the complete KLV packet */
   if ((ret = gst_mxf_demux_pull_range (demux, offset + data_offset, length,
-              &buffer)) != GST_FLOW_OK)
-    goto beach;
+              outbuf)) != GST_FLOW_OK)
+    return ret;
 
-  *outbuf = buffer;
-  buffer = NULL;
   if (read)
     *read = data_offset + length;
 
-beach:
-  if (buffer)
-    gst_buffer_unref (buffer);
-
-  return ret;
+  return GST_FLOW_OK;
 }
 
 static void
@@ -2438,9 +2903,10 @@ gst_mxf_demux_pull_random_index_pack (GstMXFDemux * demux)
   gst_buffer_unref (buffer);
   demux->offset = old_offset;
 
-  if (flow_ret == GST_FLOW_OK && !demux->index_table_segments_collected) {
-    collect_index_table_segments (demux);
-    demux->index_table_segments_collected = TRUE;
+  /* In fast-open mode the index is only collected once needed for seeking */
+  if (flow_ret == GST_FLOW_OK && !demux->index_table_segments_collected
+      && !demux->fast_open) {
+    collect_index_table_segments (demux, GST_CLOCK_TIME_NONE);
   }
 }
 
@@ -2602,6 +3068,8 @@ next_try:
     goto next_try;
   }
 
+  demux->metadata_partition = demux->current_partition;
+
 out:
   if (buffer)
     gst_buffer_unref (buffer);
@@ -2610,6 +3078,42 @@ out:
   demux->current_partition = old_partition;
 }
 
+/* Takes the metadata from the last partition containing some before reading
+ * anything else, so that the metadata of the earlier partitions, which was
+ * superseded, can be skipped completely */
+static void
+gst_mxf_demux_fast_open (GstMXFDemux * demux)
+{
+  /* Without random index pack only the header partition pack tells where
+   * the footer is */
+  if (!demux->random_index_pack) {
+    GstBuffer *buffer = NULL;
+    MXFUL key;
+
+    if (gst_mxf_demux_pull_klv_packet (demux, demux->offset, &key, &buffer,
+            NULL) != GST_FLOW_OK)
+      return;
+
+    if (mxf_is_partition_pack (&key))
+      gst_mxf_demux_handle_partition_pack (demux, &key, buffer);
+    gst_buffer_unref (buffer);
+    demux->current_partition = NULL;
+
+    if (demux->footer_partition_pack_offset == 0) {
+      GST_DEBUG_OBJECT (demux, "No footer partition, using header metadata");
+      return;
+    }
+  }
+
+  gst_mxf_demux_parse_footer_metadata (demux);
+
+  if (demux->metadata_partition) {
+    GST_DEBUG_OBJECT (demux, "Using metadata of partition at offset %"
+        G_GUINT64_FORMAT, demux->metadata_partition->partition.this_partition);
+    demux->pull_footer_metadata = FALSE;
+  }
+}
+
 static GstFlowReturn
 gst_mxf_demux_handle_klv_packet (GstMXFDemux * demux, const MXFUL * key,
     GstBuffer * buffer, gboolean peek)
@@ -2646,6 +3150,12 @@ gst_mxf_demux_handle_klv_packet (GstMXFDemux * demux, const MXFUL * key,
   } else if (mxf_is_partition_pack (key)) {
     ret = gst_mxf_demux_handle_partition_pack (demux, key, buffer);
 
+    /* Metadata up to the partition used on opening is outdated */
+    if (ret == GST_FLOW_OK && demux->fast_open && demux->metadata_partition
+        && demux->current_partition->partition.this_partition <=
+        demux->metadata_partition->partition.this_partition)
+      demux->current_partition->parsed_metadata = TRUE;
+
     /* If this partition contains the start of an essence container
      * set the positions of all essence streams to 0
      */
@@ -2682,9 +3192,8 @@ gst_mxf_demux_handle_klv_packet (GstMXFDemux * demux, const MXFUL * key,
     ret = gst_mxf_demux_handle_random_index_pack (demux, key, buffer);
 
     if (ret == GST_FLOW_OK && demux->random_access
-        && !demux->index_table_segments_collected) {
-      collect_index_table_segments (demux);
-      demux->index_table_segments_collected = TRUE;
+        && !demux->index_table_segments_collected && !demux->fast_open) {
+      collect_index_table_segments (demux, GST_CLOCK_TIME_NONE);
     }
   } else if (mxf_is_index_table_segment (key)) {
     ret =
@@ -2827,19 +3336,9 @@ gst_mxf_demux_find_essence_element (GstMXFDemux * demux,
       " of track %u with body_sid %u (keyframe %d)", *position,
       etrack->track_number, etrack->body_sid, keyframe);
 
-  if (demux->index_tables) {
-    GList *l;
-
-    for (l = demux->index_tables; l; l = l->next) {
-      GstMXFDemuxIndexTable *tmp = l->data;
-
-      if (tmp->body_sid == etrack->body_sid
-          && tmp->index_sid == etrack->index_sid) {
-        index_table = tmp;
-        break;
-      }
-    }
-  }
+  index_table =
+      gst_mxf_demux_find_index_table (demux, etrack->body_sid,
+      etrack->index_sid);
 
 from_index:
 
@@ -2870,7 +3369,9 @@ from_index:
     }
 
     if (index_table) {
-      offset = find_closest_offset (index_table->offsets, position, keyframe);
+      offset =
+          gst_mxf_demux_index_table_find_closest (demux, index_table,
+          position, keyframe);
       if (offset != -1) {
         GST_DEBUG_OBJECT (demux,
             "Starting with edit unit %" G_GINT64_FORMAT " for %" G_GINT64_FORMAT
@@ -2899,7 +3400,9 @@ from_index:
     if (index_table) {
       gint64 tmp_position = *position;
 
-      offset = find_closest_offset (index_table->offsets, &tmp_position, TRUE);
+      offset =
+          gst_mxf_demux_index_table_find_closest (demux, index_table,
+          &tmp_position, TRUE);
       if (offset != -1 && tmp_position > index_start_position) {
         demux->offset = offset + demux->run_in;
         index_start_position = tmp_position;
@@ -2994,6 +3497,167 @@ from_index:
   return -1;
 }
 
+/* Updates the durations of the essence tracks from the index tables and
+ * the essence that was already played */
+static void
+gst_mxf_demux_growing_update_durations (GstMXFDemux * demux)
+{
+  gboolean changed = FALSE;
+  guint i;
+
+  for (i = 0; i < demux->essence_tracks->len; i++) {
+    GstMXFDemuxEssenceTrack *t =
+        &g_array_index (demux->essence_tracks, GstMXFDemuxEssenceTrack, i);
+    GstMXFDemuxIndexTable *table;
+    gint64 duration = t->position;
+
+    table = gst_mxf_demux_find_index_table (demux, t->body_sid, t->index_sid);
+    if (table && table->segments->len > 0) {
+      GstMXFDemuxIndexSegment *last = &g_array_index (table->segments,
+          GstMXFDemuxIndexSegment, table->segments->len - 1);
+
+      /* Unbounded CBR segments say nothing about the duration */
+      if (last->n_entries > 0 || last->start + last->duration < G_MAXINT64)
+        duration = MAX (duration, last->start +
+            gst_mxf_demux_index_segment_get_covered (last));
+    }
+
+    if (duration > t->duration) {
+      GST_DEBUG_OBJECT (demux, "Essence track %u grew to %" G_GINT64_FORMAT
+          " edit units", t->track_number, duration);
+      t->duration = duration;
+      changed = TRUE;
+    }
+  }
+
+  if (changed)
+    gst_element_post_message (GST_ELEMENT_CAST (demux),
+        gst_message_new_duration_changed (GST_OBJECT_CAST (demux)));
+}
+
+/* Looks at all complete KLV packets written since the last scan for new
+ * partitions and index table segments, without pulling the essence */
+static void
+gst_mxf_demux_growing_scan (GstMXFDemux * demux)
+{
+  guint64 old_offset = demux->offset;
+  GstMXFDemuxPartition *old_partition = demux->current_partition;
+  guint64 offset = MAX (demux->growing_scan_offset, demux->run_in);
+
+  gst_mxf_demux_set_partition_for_offset (demux, offset);
+
+  while (!demux->growing_finished) {
+    GstBuffer *buffer = NULL;
+    guint data_offset;
+    guint64 length;
+    MXFUL key;
+
+    if (gst_mxf_demux_pull_klv_header (demux, offset, &key, &data_offset,
+            &length) != GST_FLOW_OK)
+      break;
+
+    /* Still being written */
+    if (offset + data_offset + length > demux->growing_size)
+      break;
+
+    if (mxf_is_partition_pack (&key) || mxf_is_index_table_segment (&key)) {
+      if (gst_mxf_demux_pull_range (demux, offset + data_offset, length,
+              &buffer) != GST_FLOW_OK)
+        break;
+
+      demux->offset = offset;
+      if (mxf_is_partition_pack (&key))
+        gst_mxf_demux_handle_partition_pack (demux, &key, buffer);
+      else
+        gst_mxf_demux_handle_index_table_segment (demux, &key, buffer,
+            offset);
+      gst_buffer_unref (buffer);
+    } else if (demux->current_partition
+        && demux->current_partition->essence_container_offset == 0
+        && (mxf_is_generic_container_system_item (&key)
+            || mxf_is_generic_container_essence_element (&key)
+            || mxf_is_avid_essence_container_essence_element (&key))) {
+      demux->current_partition->essence_container_offset =
+          offset - demux->current_partition->partition.this_partition -
+          demux->run_in;
+    }
+
+    offset += data_offset + length;
+  }
+
+  GST_DEBUG_OBJECT (demux, "Scanned growing file up to offset %"
+      G_GUINT64_FORMAT, offset);
+
+  demux->growing_scan_offset = offset;
+  demux->offset = old_offset;
+  demux->current_partition = old_partition;
+
+  gst_mxf_demux_merge_index_table_segments (demux);
+  gst_mxf_demux_growing_update_durations (demux);
+}
+
+/* Returns TRUE if the file grew since the last call */
+static gboolean
+gst_mxf_demux_growing_poll (GstMXFDemux * demux)
+{
+  gint64 size;
+
+  if (!gst_pad_peer_query_duration (demux->sinkpad, GST_FORMAT_BYTES, &size)
+      || size <= 0 || (guint64) size <= demux->growing_size)
+    return FALSE;
+
+  GST_DEBUG_OBJECT (demux, "File grew to %" G_GINT64_FORMAT " bytes", size);
+  demux->growing_size = size;
+  gst_mxf_demux_growing_scan (demux);
+
+  return TRUE;
+}
+
+/* Waits until the file grew or the poll interval passed. Returns
+ * GST_FLOW_FLUSHING if interrupted by a seek or deactivation */
+static GstFlowReturn
+gst_mxf_demux_growing_wait (GstMXFDemux * demux)
+{
+  gint64 end_time;
+  gboolean wakeup;
+
+  if (gst_mxf_demux_growing_poll (demux))
+    return GST_FLOW_OK;
+
+  GST_LOG_OBJECT (demux, "Waiting for more data at offset %" G_GUINT64_FORMAT,
+      demux->offset);
+
+  end_time =
+      g_get_monotonic_time () + demux->growing_poll_interval / GST_USECOND;
+
+  g_mutex_lock (&demux->growing_lock);
+  while (!demux->growing_wakeup
+      && g_cond_wait_until (&demux->growing_cond, &demux->growing_lock,
+          end_time));
+  wakeup = demux->growing_wakeup;
+  demux->growing_wakeup = FALSE;
+  g_mutex_unlock (&demux->growing_lock);
+
+  if (wakeup)
+    return GST_FLOW_FLUSHING;
+
+  gst_mxf_demux_growing_poll (demux);
+
+  return GST_FLOW_OK;
+}
+
+/* Interrupts gst_mxf_demux_growing_wait(), or clears a pending
+ * interruption once the streaming thread is stopped */
+static void
+gst_mxf_demux_growing_interrupt (GstMXFDemux * demux, gboolean interrupt)
+{
+  g_mutex_lock (&demux->growing_lock);
+  demux->growing_wakeup = interrupt;
+  if (interrupt)
+    g_cond_signal (&demux->growing_cond);
+  g_mutex_unlock (&demux->growing_lock);
+}
+
 static GstFlowReturn
 gst_mxf_demux_pull_and_handle_klv_packet (GstMXFDemux * demux)
 {
@@ -3014,6 +3678,13 @@ gst_mxf_demux_pull_and_handle_klv_packet (GstMXFDemux * demux)
       gst_mxf_demux_pull_klv_packet (demux, demux->offset, &key, &buffer,
       &read);
 
+  /* Wait for the writer instead of going EOS, the packet is pulled again
+   * once it is complete */
+  if (ret == GST_FLOW_EOS && demux->growing && !demux->growing_finished) {
+    ret = gst_mxf_demux_growing_wait (demux);
+    goto beach;
+  }
+
   if (ret == GST_FLOW_EOS && demux->src->len > 0) {
     guint i;
     GstMXFDemuxPad *p = NULL;
@@ -3077,6 +3748,17 @@ gst_mxf_demux_pull_and_handle_klv_packet (GstMXFDemux * demux)
   ret = gst_mxf_demux_handle_klv_packet (demux, &key, buffer, FALSE);
   demux->offset += read;
 
+  /* Skip over all header metadata of partitions that were already parsed,
+   * the header byte count includes the primer pack */
+  if (ret == GST_FLOW_OK && demux->fast_open && mxf_is_primer_pack (&key)
+      && demux->current_partition->parsed_metadata
+      && demux->current_partition->partition.header_byte_count) {
+    demux->offset = demux->current_partition->primer.offset +
+        demux->current_partition->partition.header_byte_count;
+    GST_DEBUG_OBJECT (demux, "Skipping parsed header metadata to offset %"
+        G_GUINT64_FORMAT, demux->offset);
+  }
+
   if (ret == GST_FLOW_OK && demux->src->len > 0
       && demux->essence_tracks->len > 0) {
     GstMXFDemuxPad *earliest = NULL;
@@ -3176,6 +3858,19 @@ gst_mxf_demux_loop (GstPad * pad)
 
     /* First of all pull&parse the random index pack at EOF */
     gst_mxf_demux_pull_random_index_pack (demux);
+
+    if (demux->fast_open)
+      gst_mxf_demux_fast_open (demux);
+
+    if (demux->growing)
+      gst_mxf_demux_growing_poll (demux);
+  }
+
+  if (g_atomic_int_compare_and_exchange
+      (&demux->deferred_descriptive_metadata_requested, TRUE, FALSE)
+      && demux->deferred_descriptive_metadata->len > 0) {
+    gst_mxf_demux_parse_deferred_descriptive_metadata (demux);
+    g_object_notify (G_OBJECT (demux), "structure");
   }
 
   /* Now actually do something */
@@ -3665,149 +4360,81 @@ no_new_offset:
   }
 }
 
-static void
-collect_index_table_segments (GstMXFDemux * demux)
+/* TRUE if the index tables of all essence tracks cover @time */
+static gboolean
+gst_mxf_demux_index_covers (GstMXFDemux * demux, GstClockTime time)
 {
-  GList *l;
   guint i;
+
+  for (i = 0; i < demux->essence_tracks->len; i++) {
+    GstMXFDemuxEssenceTrack *t =
+        &g_array_index (demux->essence_tracks, GstMXFDemuxEssenceTrack, i);
+    GstMXFDemuxIndexTable *table;
+    gint64 position;
+
+    if (!t->source_track || t->source_track->edit_rate.n <= 0
+        || t->source_track->edit_rate.d <= 0)
+      continue;
+
+    table = gst_mxf_demux_find_index_table (demux, t->body_sid, t->index_sid);
+    if (!table)
+      return FALSE;
+
+    position = gst_util_uint64_scale (time, t->source_track->edit_rate.n,
+        t->source_track->edit_rate.d * GST_SECOND);
+    if (t->duration > 0)
+      position = MIN (position, t->duration - 1);
+
+    if (!gst_mxf_demux_index_table_find_segment (table, position, FALSE))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Collects the index table segments of the partitions in the random index
+ * pack, in order, until the index covers @until. Partitions that were
+ * already handled are not read again, so every seek only loads what it
+ * needs. Must be called from the streaming thread or with the stream lock */
+static void
+collect_index_table_segments (GstMXFDemux * demux, GstClockTime until)
+{
   guint64 old_offset = demux->offset;
   GstMXFDemuxPartition *old_partition = demux->current_partition;
 
   if (!demux->random_index_pack)
     return;
 
-  for (i = 0; i < demux->random_index_pack->len; i++) {
+  while (demux->index_partitions_collected < demux->random_index_pack->len) {
     MXFRandomIndexPackEntry *e =
-        &g_array_index (demux->random_index_pack, MXFRandomIndexPackEntry, i);
+        &g_array_index (demux->random_index_pack, MXFRandomIndexPackEntry,
+        demux->index_partitions_collected);
+
+    if (GST_CLOCK_TIME_IS_VALID (until)
+        && gst_mxf_demux_index_covers (demux, until))
+      break;
 
     if (e->offset < demux->run_in) {
       GST_ERROR_OBJECT (demux, "Invalid random index pack entry");
-      return;
+      demux->index_partitions_collected = demux->random_index_pack->len;
+      break;
     }
 
     demux->offset = e->offset;
     read_partition_header (demux);
+    gst_mxf_demux_merge_index_table_segments (demux);
+    demux->index_partitions_collected++;
   }
 
-  demux->offset = old_offset;
-  demux->current_partition = old_partition;
-
-  for (l = demux->pending_index_table_segments; l; l = l->next) {
-    MXFIndexTableSegment *segment = l->data;
-    GstMXFDemuxIndexTable *t = NULL;
-    GList *k;
-    guint64 start, end;
-
-    for (k = demux->index_tables; k; k = k->next) {
-      GstMXFDemuxIndexTable *tmp = k->data;
-
-      if (tmp->body_sid == segment->body_sid
-          && tmp->index_sid == segment->index_sid) {
-        t = tmp;
-        break;
-      }
-    }
-
-    if (!t) {
-      t = g_new0 (GstMXFDemuxIndexTable, 1);
-      t->body_sid = segment->body_sid;
-      t->index_sid = segment->index_sid;
-      t->offsets = g_array_new (FALSE, TRUE, sizeof (GstMXFDemuxIndex));
-      demux->index_tables = g_list_prepend (demux->index_tables, t);
-    }
-
-    start = segment->index_start_position;
-    end = start + segment->index_duration;
-    if (end > G_MAXINT / sizeof (GstMXFDemuxIndex)) {
-      demux->index_tables = g_list_remove (demux->index_tables, t);
-      g_array_free (t->offsets, TRUE);
-      g_free (t);
-      continue;
-    }
-
-    if (t->offsets->len < end)
-      g_array_set_size (t->offsets, end);
-
-    for (i = 0; i < segment->n_index_entries && start + i < t->offsets->len;
-        i++) {
-      guint64 offset = segment->index_entries[i].stream_offset;
-      GList *m;
-      GstMXFDemuxPartition *offset_partition = NULL, *next_partition = NULL;
-
-      for (m = demux->partitions; m; m = m->next) {
-        GstMXFDemuxPartition *partition = m->data;
-
-        if (!next_partition && offset_partition)
-          next_partition = partition;
-
-        if (partition->partition.body_sid != t->body_sid)
-          continue;
-        if (partition->partition.body_offset > offset)
-          break;
-
-        offset_partition = partition;
-        next_partition = NULL;
-      }
-
-      if (offset_partition && offset >= offset_partition->partition.body_offset) {
-        offset =
-            offset_partition->partition.this_partition +
-            offset_partition->essence_container_offset + (offset -
-            offset_partition->partition.body_offset);
-
-        if (next_partition
-            && offset >= next_partition->partition.this_partition) {
-          GST_ERROR_OBJECT (demux,
-              "Invalid index table segment going into next unrelated partition");
-        } else {
-          GstMXFDemuxIndex *index;
-          gint8 temporal_offset = segment->index_entries[i].temporal_offset;
-          guint64 pts_i = G_MAXUINT64;
-
-          if (temporal_offset > 0 ||
-              (temporal_offset < 0 && start + i >= -(gint) temporal_offset)) {
-            pts_i = start + i + temporal_offset;
-
-            if (t->offsets->len < pts_i)
-              g_array_set_size (t->offsets, pts_i + 1);
-
-            index = &g_array_index (t->offsets, GstMXFDemuxIndex, pts_i);
-            if (!index->initialized) {
-              index->initialized = TRUE;
-              index->offset = 0;
-              index->pts = G_MAXUINT64;
-              index->dts = G_MAXUINT64;
-              index->keyframe = FALSE;
-            }
-
-            index->pts = start + i;
-          }
-
-          index = &g_array_index (t->offsets, GstMXFDemuxIndex, start + i);
-          if (!index->initialized) {
-            index->initialized = TRUE;
-            index->offset = 0;
-            index->pts = G_MAXUINT64;
-            index->dts = G_MAXUINT64;
-            index->keyframe = FALSE;
-          }
+  GST_DEBUG_OBJECT (demux, "Collected index table segments of %u of %u "
+      "partitions", demux->index_partitions_collected,
+      demux->random_index_pack->len);
 
-          index->offset = offset;
-          index->keyframe = ! !(segment->index_entries[i].flags & 0x80)
-              || (segment->index_entries[i].key_frame_offset == 0);
-          index->dts = pts_i;
-        }
-      }
-    }
-  }
+  if (demux->index_partitions_collected == demux->random_index_pack->len)
+    demux->index_table_segments_collected = TRUE;
 
-  for (l = demux->pending_index_table_segments; l; l = l->next) {
-    MXFIndexTableSegment *s = l->data;
-    mxf_index_table_segment_reset (s);
-    g_free (s);
-  }
-  g_list_free (demux->pending_index_table_segments);
-  demux->pending_index_table_segments = NULL;
+  demux->offset = old_offset;
+  demux->current_partition = old_partition;
 }
 
 static gboolean
@@ -3840,11 +4467,6 @@ gst_mxf_demux_seek_pull (GstMXFDemux * demux, GstEvent * event)
 
   keyunit_ts = start;
 
-  if (!demux->index_table_segments_collected) {
-    collect_index_table_segments (demux);
-    demux->index_table_segments_collected = TRUE;
-  }
-
   if (flush) {
     GstEvent *e;
 
@@ -3859,9 +4481,13 @@ gst_mxf_demux_seek_pull (GstMXFDemux * demux, GstEvent * event)
     gst_pad_pause_task (demux->sinkpad);
   }
 
+  gst_mxf_demux_growing_interrupt (demux, TRUE);
+
   /* Take the stream lock */
   GST_PAD_STREAM_LOCK (demux->sinkpad);
 
+  gst_mxf_demux_growing_interrupt (demux, FALSE);
+
   if (flush) {
     GstEvent *e;
 
@@ -3871,6 +4497,10 @@ gst_mxf_demux_seek_pull (GstMXFDemux * demux, GstEvent * event)
     gst_pad_push_event (demux->sinkpad, e);
   }
 
+  /* Everything written so far can be seeked to */
+  if (demux->growing && !demux->growing_finished)
+    gst_mxf_demux_growing_poll (demux);
+
   /* Work on a copy until we are sure the seek succeeded. */
   memcpy (&seeksegment, &demux->segment, sizeof (GstSegment));
 
@@ -3894,6 +4524,10 @@ gst_mxf_demux_seek_pull (GstMXFDemux * demux, GstEvent * event)
       }
     }
 
+    /* In fast-open mode, only load the index up to the seek target */
+    if (!demux->index_table_segments_collected)
+      collect_index_table_segments (demux, start);
+
     /* Do the actual seeking */
     for (i = 0; i < demux->src->len; i++) {
       MXFMetadataTrackType track_type = MXF_METADATA_TRACK_UNKNOWN;
@@ -4112,6 +4746,22 @@ gst_mxf_demux_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
       if (duration <= -1)
         duration = -1;
 
+      /* The metadata of growing files is only updated at the very end */
+      if (demux->growing && mxfpad->current_essence_track
+          && mxfpad->current_essence_track->source_track
+          && mxfpad->current_essence_track->duration > 0) {
+        GstMXFDemuxEssenceTrack *etrack = mxfpad->current_essence_track;
+        gint64 essence_duration;
+
+        essence_duration =
+            gst_util_uint64_scale (etrack->duration,
+            mxfpad->material_track->edit_rate.n *
+            etrack->source_track->edit_rate.d,
+            mxfpad->material_track->edit_rate.d *
+            etrack->source_track->edit_rate.n);
+        duration = MAX (duration, essence_duration);
+      }
+
       if (duration != -1 && format == GST_FORMAT_TIME) {
         if (mxfpad->material_track->edit_rate.n == 0 ||
             mxfpad->material_track->edit_rate.d == 0) {
@@ -4238,10 +4888,12 @@ gst_mxf_demux_sink_activate_mode (GstPad * sinkpad, GstObject * parent,
   } else {
     if (active) {
       demux->random_access = TRUE;
+      gst_mxf_demux_growing_interrupt (demux, FALSE);
       return gst_pad_start_task (sinkpad, (GstTaskFunction) gst_mxf_demux_loop,
           sinkpad, NULL);
     } else {
       demux->random_access = FALSE;
+      gst_mxf_demux_growing_interrupt (demux, TRUE);
       return gst_pad_stop_task (sinkpad);
     }
   }
@@ -4551,6 +5203,15 @@ gst_mxf_demux_set_property (GObject * object, guint prop_id,
     case PROP_MAX_DRIFT:
       demux->max_drift = g_value_get_uint64 (value);
       break;
+    case PROP_FAST_OPEN:
+      demux->fast_open = g_value_get_boolean (value);
+      break;
+    case PROP_GROWING:
+      demux->growing = g_value_get_boolean (value);
+      break;
+    case PROP_GROWING_POLL_INTERVAL:
+      demux->growing_poll_interval = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -4573,6 +5234,13 @@ gst_mxf_demux_get_property (GObject * object, guint prop_id,
     case PROP_STRUCTURE:{
       GstStructure *s;
 
+      /* Taking the stream lock here would block until the streaming thread
+       * is done, which never happens while it waits for preroll. Let it
+       * parse the deferred descriptive metadata on its next iteration */
+      if (demux->fast_open)
+        g_atomic_int_set (&demux->deferred_descriptive_metadata_requested,
+            TRUE);
+
       g_rw_lock_reader_lock (&demux->metadata_lock);
       if (demux->preface &&
           MXF_METADATA_BASE (demux->preface)->resolved ==
@@ -4589,6 +5257,15 @@ gst_mxf_demux_get_property (GObject * object, guint prop_id,
       g_rw_lock_reader_unlock (&demux->metadata_lock);
       break;
     }
+    case PROP_FAST_OPEN:
+      g_value_set_boolean (value, demux->fast_open);
+      break;
+    case PROP_GROWING:
+      g_value_set_boolean (value, demux->growing);
+      break;
+    case PROP_GROWING_POLL_INTERVAL:
+      g_value_set_uint64 (value, demux->growing_poll_interval);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -4626,10 +5303,14 @@ gst_mxf_demux_finalize (GObject * object)
   demux->src = NULL;
   g_array_free (demux->essence_tracks, TRUE);
   demux->essence_tracks = NULL;
+  g_array_free (demux->deferred_descriptive_metadata, TRUE);
+  demux->deferred_descriptive_metadata = NULL;
 
   g_hash_table_destroy (demux->metadata);
 
   g_rw_lock_clear (&demux->metadata_lock);
+  g_mutex_clear (&demux->growing_lock);
+  g_cond_clear (&demux->growing_cond);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -4664,6 +5345,54 @@ gst_mxf_demux_class_init (GstMXFDemuxClass * klass)
           "Structural metadata of the MXF file",
           GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstMXFDemux:fast-open:
+   *
+   * In pull mode, take the metadata from the footer partition before reading
+   * anything else and skip the outdated metadata of the earlier partitions.
+   * Index table segments are only collected when seeking, up to the seek
+   * target. Descriptive metadata is only parsed by the streaming thread
+   * after the #GstMXFDemux:structure property was read, which is then
+   * notified again, and is not part of the structure tag.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_FAST_OPEN,
+      g_param_spec_boolean ("fast-open", "Fast open",
+          "Read the metadata from the footer first and load the index and "
+          "descriptive metadata only when needed", DEFAULT_FAST_OPEN,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstMXFDemux:growing:
+   *
+   * In pull mode, play a file that is still being written. Instead of going
+   * EOS at the end of the file the demuxer waits for more data until the
+   * footer partition is written. New partitions and index table segments
+   * are picked up as they appear, which makes everything written so far
+   * seekable and updates the duration.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_GROWING,
+      g_param_spec_boolean ("growing", "Growing",
+          "Wait for more data at the end of a file that is still being written",
+          DEFAULT_GROWING, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstMXFDemux:growing-poll-interval:
+   *
+   * How often the size of a growing file is checked while waiting for more
+   * data.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_GROWING_POLL_INTERVAL,
+      g_param_spec_uint64 ("growing-poll-interval", "Growing poll interval",
+          "Interval in nanoseconds for checking the size of a growing file",
+          GST_MSECOND, G_MAXUINT64, DEFAULT_GROWING_POLL_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_mxf_demux_change_state);
   gstelement_class->query = GST_DEBUG_FUNCPTR (gst_mxf_demux_query);
@@ -4695,14 +5424,21 @@ gst_mxf_demux_init (GstMXFDemux * demux)
   gst_element_add_pad (GST_ELEMENT (demux), demux->sinkpad);
 
   demux->max_drift = 500 * GST_MSECOND;
+  demux->fast_open = DEFAULT_FAST_OPEN;
+  demux->growing = DEFAULT_GROWING;
+  demux->growing_poll_interval = DEFAULT_GROWING_POLL_INTERVAL;
 
   demux->adapter = gst_adapter_new ();
   demux->flowcombiner = gst_flow_combiner_new ();
   g_rw_lock_init (&demux->metadata_lock);
+  g_mutex_init (&demux->growing_lock);
+  g_cond_init (&demux->growing_cond);
 
   demux->src = g_ptr_array_new ();
   demux->essence_tracks =
       g_array_new (FALSE, FALSE, sizeof (GstMXFDemuxEssenceTrack));
+  demux->deferred_descriptive_metadata =
+      g_array_new (FALSE, FALSE, sizeof (GstMXFDemuxDeferredMetadata));
 
   gst_segment_init (&demux->segment, GST_FORMAT_TIME);
 
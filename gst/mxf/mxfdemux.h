@@ -57,6 +57,13 @@ typedef struct
   guint64 essence_container_offset;
 } GstMXFDemuxPartition;
 
+typedef struct
+{
+  /* offset of the KLV packet and the partition containing it */
+  guint64 offset;
+  GstMXFDemuxPartition *partition;
+} GstMXFDemuxDeferredMetadata;
+
 typedef struct
 {
   guint32 body_sid;
@@ -84,28 +91,49 @@ typedef struct
   gboolean intra_only;
 } GstMXFDemuxEssenceTrack;
 
+/* Offset of an essence element seen during playback. Timestamps and
+ * keyframe information of the index table are looked up when needed */
 typedef struct
 {
   /* 0 if uninitialized */
   guint64 offset;
 
-  /* PTS edit unit number or G_MAXUINT64 */
-  guint64 pts;
+  guint8 keyframe;
+  guint8 initialized;
+} GstMXFDemuxIndex;
 
-  /* DTS edit unit number if we got here via PTS */
-  guint64 dts;
+typedef struct
+{
+  /* offset inside the essence container */
+  guint64 stream_offset;
+  gint8 temporal_offset;
+  gint8 key_frame_offset;
+  guint8 flags;
+} GstMXFDemuxIndexEntry;
 
-  gboolean keyframe;
-  gboolean initialized;
-} GstMXFDemuxIndex;
+typedef struct
+{
+  /* edit units covered by this segment, in stored order. Unbounded CBR
+   * segments end at G_MAXINT64 */
+  gint64 start;
+  gint64 duration;
+
+  /* for CBR essence the size of each edit unit, without entries */
+  guint32 edit_unit_byte_count;
+
+  /* for VBR essence one entry per edit unit */
+  guint32 n_entries;
+  GstMXFDemuxIndexEntry *entries;
+} GstMXFDemuxIndexSegment;
 
 typedef struct
 {
   guint32 body_sid;
   guint32 index_sid;
 
-  /* offsets indexed by DTS */
-  GArray *offsets;
+  /* GstMXFDemuxIndexSegment sorted by start position, offsets are
+   * computed from them when needed */
+  GArray *segments;
 } GstMXFDemuxIndexTable;
 
 struct _GstMXFDemuxPad
@@ -181,15 +209,28 @@ struct _GstMXFDemux
   /* MXF file state */
   GList *partitions;
   GstMXFDemuxPartition *current_partition;
+  /* partition the metadata was taken from when parsed from the footer */
+  GstMXFDemuxPartition *metadata_partition;
 
   GArray *essence_tracks;
 
   GList *pending_index_table_segments;
   GList *index_tables; /* one per BodySID / IndexSID */
   gboolean index_table_segments_collected;
+  /* random index pack entries whose index table segments were collected */
+  guint index_partitions_collected;
 
   GArray *random_index_pack;
 
+  /* Growing file state, the scan offset is the next KLV packet to look at
+   * for new partitions and index table segments */
+  gboolean growing_finished;
+  guint64 growing_size;
+  guint64 growing_scan_offset;
+  GMutex growing_lock;
+  GCond growing_cond;
+  gboolean growing_wakeup;
+
   /* Metadata */
   GRWLock metadata_lock;
   gboolean update_metadata;
@@ -198,6 +239,11 @@ struct _GstMXFDemux
   gboolean metadata_resolved;
   MXFMetadataPreface *preface;
   GHashTable *metadata;
+  /* descriptive metadata only parsed once needed in fast-open mode */
+  GArray *deferred_descriptive_metadata;
+  /* set when the structure was read, the streaming thread then parses the
+   * deferred descriptive metadata */
+  gint deferred_descriptive_metadata_requested;
 
   MXFUMID current_package_uid;
   MXFMetadataGenericPackage *current_package;
@@ -208,6 +254,9 @@ struct _GstMXFDemux
   /* Properties */
   gchar *requested_package_string;
   GstClockTime max_drift;
+  gboolean fast_open;
+  gboolean growing;
+  GstClockTime growing_poll_interval;
 };
 
 struct _GstMXFDemuxClass
@@ -115,13 +115,29 @@ static GstStaticPadTemplate src_templ = GST_STATIC_PAD_TEMPLATE ("src",
 
 enum
 {
-  PROP_0
+  PROP_0,
+  PROP_PARTITION_INTERVAL
 };
 
+#define DEFAULT_PARTITION_INTERVAL 0
+
+/* Fill reserved after the header metadata so that it can be rewritten in
+ * place with the final values at EOS */
+#define HEADER_METADATA_RESERVE 4096
+
+/* Size of a fill item with a 4 byte BER length and no payload */
+#define FILL_MIN_SIZE 20
+
+#define MAX_INDEX_SEGMENT_SIZE (G_MAXUINT16 / 11)
+
 #define gst_mxf_mux_parent_class parent_class
 G_DEFINE_TYPE (GstMXFMux, gst_mxf_mux, GST_TYPE_AGGREGATOR);
 
 static void gst_mxf_mux_finalize (GObject * object);
+static void gst_mxf_mux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_mxf_mux_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 static GstFlowReturn gst_mxf_mux_aggregate (GstAggregator * aggregator,
     gboolean timeout);
@@ -163,6 +179,25 @@ gst_mxf_mux_class_init (GstMXFMuxClass * klass)
   gstaggregator_class = (GstAggregatorClass *) klass;
 
   gobject_class->finalize = gst_mxf_mux_finalize;
+  gobject_class->set_property = gst_mxf_mux_set_property;
+  gobject_class->get_property = gst_mxf_mux_get_property;
+
+  /**
+   * GstMXFMux:partition-interval:
+   *
+   * Start a new body partition at the first keyframe of the first stream
+   * after this many nanoseconds. Each body partition carries the index
+   * table segments of the previous ones, which makes the file indexable
+   * while it is still being written. If 0, all essence is written into a
+   * single body partition and the index only into the footer.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_PARTITION_INTERVAL,
+      g_param_spec_uint64 ("partition-interval", "Partition interval",
+          "Interval in nanoseconds between body partitions (0 = single "
+          "body partition)", 0, G_MAXUINT64, DEFAULT_PARTITION_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstaggregator_class->create_new_pad =
       GST_DEBUG_FUNCPTR (gst_mxf_mux_create_new_pad);
@@ -193,6 +228,9 @@ static void
 gst_mxf_mux_init (GstMXFMux * mux)
 {
   mux->index_table = g_array_new (FALSE, FALSE, sizeof (MXFIndexTableSegment));
+  mux->body_partitions =
+      g_array_new (FALSE, FALSE, sizeof (GstMXFMuxPartition));
+  mux->partition_interval = DEFAULT_PARTITION_INTERVAL;
   gst_mxf_mux_reset (mux);
 }
 
@@ -219,9 +257,43 @@ gst_mxf_mux_finalize (GObject * object)
     mux->index_table = NULL;
   }
 
+  g_array_free (mux->body_partitions, TRUE);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static void
+gst_mxf_mux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstMXFMux *mux = GST_MXF_MUX (object);
+
+  switch (prop_id) {
+    case PROP_PARTITION_INTERVAL:
+      mux->partition_interval = g_value_get_uint64 (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_mxf_mux_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstMXFMux *mux = GST_MXF_MUX (object);
+
+  switch (prop_id) {
+    case PROP_PARTITION_INTERVAL:
+      g_value_set_uint64 (value, mux->partition_interval);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static void
 gst_mxf_mux_reset (GstMXFMux * mux)
 {
@@ -270,6 +342,14 @@ gst_mxf_mux_reset (GstMXFMux * mux)
   g_array_set_size (mux->index_table, 0);
   mux->current_index_pos = 0;
   mux->last_keyframe_pos = 0;
+  memset (mux->pending_temporal_offsets, 0,
+      sizeof (mux->pending_temporal_offsets));
+  mux->next_index_pos = 0;
+  mux->first_dirty_index_pos = G_MAXUINT;
+
+  g_array_set_size (mux->body_partitions, 0);
+  mux->partition_start = 0;
+  mux->header_byte_count = 0;
 }
 
 static gboolean
@@ -1153,29 +1233,75 @@ gst_mxf_mux_init_partition_pack (GstMXFMux * mux)
   return GST_FLOW_OK;
 }
 
+/* Creates a fill item of exactly @size bytes. The length is always BER
+ * encoded with 4 bytes so that any size from FILL_MIN_SIZE on is possible */
+static GstBuffer *
+gst_mxf_mux_create_fill (guint size)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+
+  g_return_val_if_fail (size >= FILL_MIN_SIZE, NULL);
+
+  buf = gst_buffer_new_and_alloc (size);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memcpy (map.data, MXF_UL (FILL), 16);
+  GST_WRITE_UINT8 (map.data + 16, 0x83);
+  GST_WRITE_UINT24_BE (map.data + 17, size - FILL_MIN_SIZE);
+  memset (map.data + FILL_MIN_SIZE, 0, size - FILL_MIN_SIZE);
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+/* Writes the partition pack followed by the primer pack and the header
+ * metadata. @reserve bytes of fill are appended to the metadata, or if
+ * @header_byte_count is not 0 the metadata is padded with fill to exactly
+ * that size. Returns GST_FLOW_NOT_SUPPORTED without writing anything if the
+ * metadata does not fit */
 static GstFlowReturn
-gst_mxf_mux_write_header_metadata (GstMXFMux * mux)
+gst_mxf_mux_write_header_metadata (GstMXFMux * mux, guint64 header_byte_count,
+    guint reserve)
 {
   GstFlowReturn ret = GST_FLOW_OK;
   GstBuffer *buf;
   GList *buffers = NULL;
   GList *l;
   MXFMetadataBase *m;
-  guint64 header_byte_count = 0;
+  guint64 metadata_byte_count = 0;
 
   for (l = mux->metadata_list; l; l = l->next) {
     m = l->data;
     buf = mxf_metadata_base_to_buffer (m, &mux->primer);
-    header_byte_count += gst_buffer_get_size (buf);
+    metadata_byte_count += gst_buffer_get_size (buf);
     buffers = g_list_prepend (buffers, buf);
   }
 
   buffers = g_list_reverse (buffers);
   buf = mxf_primer_pack_to_buffer (&mux->primer);
-  header_byte_count += gst_buffer_get_size (buf);
+  metadata_byte_count += gst_buffer_get_size (buf);
   buffers = g_list_prepend (buffers, buf);
 
-  mux->partition.header_byte_count = header_byte_count;
+  if (header_byte_count != 0) {
+    if (metadata_byte_count > header_byte_count ||
+        (metadata_byte_count < header_byte_count &&
+            header_byte_count - metadata_byte_count < FILL_MIN_SIZE)) {
+      GST_WARNING_OBJECT (mux, "Header metadata of %" G_GUINT64_FORMAT
+          " bytes doesn't fit into %" G_GUINT64_FORMAT " bytes",
+          metadata_byte_count, header_byte_count);
+      g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+      g_list_free (buffers);
+      return GST_FLOW_NOT_SUPPORTED;
+    }
+    reserve = header_byte_count - metadata_byte_count;
+  } else if (reserve > 0) {
+    reserve = MAX (reserve, FILL_MIN_SIZE);
+  }
+
+  if (reserve > 0)
+    buffers = g_list_append (buffers, gst_mxf_mux_create_fill (reserve));
+
+  mux->partition.header_byte_count = metadata_byte_count + reserve;
   buf = mxf_partition_pack_to_buffer (&mux->partition);
   if ((ret = gst_mxf_mux_push (mux, buf)) != GST_FLOW_OK) {
     GST_ERROR_OBJECT (mux, "Failed pushing partition: %s",
@@ -1202,6 +1328,142 @@ gst_mxf_mux_write_header_metadata (GstMXFMux * mux)
   return ret;
 }
 
+static void
+gst_mxf_mux_add_index_table_segment (GstMXFMux * mux,
+    const MXFFraction * edit_rate)
+{
+  MXFIndexTableSegment s;
+
+  memset (&s, 0, sizeof (s));
+
+  mxf_uuid_init (&s.instance_id, mux->metadata);
+  memcpy (&s.index_edit_rate, edit_rate, sizeof (s.index_edit_rate));
+  if (mux->index_table->len > 0) {
+    const MXFIndexTableSegment *last =
+        &g_array_index (mux->index_table, MXFIndexTableSegment,
+        mux->index_table->len - 1);
+
+    s.index_start_position = last->index_start_position + last->index_duration;
+  }
+  s.index_sid =
+      mux->preface->content_storage->essence_container_data[0]->index_sid;
+  s.body_sid =
+      mux->preface->content_storage->essence_container_data[0]->body_sid;
+  s.index_entries = g_new0 (MXFIndexEntry, MAX_INDEX_SEGMENT_SIZE);
+  g_array_append_val (mux->index_table, s);
+
+  mux->current_index_pos = mux->index_table->len - 1;
+}
+
+/* Returns the already created index entry for @position, marking its
+ * segment as modified if it was written into a body partition before */
+static MXFIndexEntry *
+gst_mxf_mux_get_index_entry (GstMXFMux * mux, guint64 position)
+{
+  guint i;
+
+  for (i = mux->index_table->len; i > 0; i--) {
+    MXFIndexTableSegment *segment =
+        &g_array_index (mux->index_table, MXFIndexTableSegment, i - 1);
+
+    if (position < segment->index_start_position)
+      continue;
+    if (position - segment->index_start_position >= segment->n_index_entries)
+      return NULL;
+
+    if (i - 1 < mux->next_index_pos)
+      mux->first_dirty_index_pos = MIN (mux->first_dirty_index_pos, i - 1);
+
+    return &segment->index_entries[position - segment->index_start_position];
+  }
+
+  return NULL;
+}
+
+static void
+gst_mxf_mux_set_body_partition_pack (GstMXFMux * mux,
+    const GstMXFMuxPartition * p, guint64 footer_partition)
+{
+  mux->partition.type = MXF_PARTITION_PACK_BODY;
+  mux->partition.closed = TRUE;
+  mux->partition.complete = TRUE;
+  mux->partition.this_partition = p->this_partition;
+  mux->partition.prev_partition = p->prev_partition;
+  mux->partition.footer_partition = footer_partition;
+  mux->partition.header_byte_count = 0;
+  mux->partition.index_byte_count = p->index_byte_count;
+  mux->partition.index_sid = p->index_sid;
+  mux->partition.body_offset = p->body_offset;
+  mux->partition.body_sid = p->body_sid;
+}
+
+/* Starts a new body partition. The index table segments of the previous
+ * body partitions that were not written yet are put in front of the
+ * essence, and a new segment is started for the new partition */
+static GstFlowReturn
+gst_mxf_mux_write_body_partition (GstMXFMux * mux)
+{
+  MXFMetadataEssenceContainerData *ecd =
+      mux->preface->content_storage->essence_container_data[0];
+  GstMXFMuxPartition p;
+  GList *index_buffers = NULL, *l;
+  guint64 index_byte_count = 0;
+  GstFlowReturn ret;
+  GstBuffer *buf;
+  guint i;
+
+  if (mux->index_table->len > 0 &&
+      g_array_index (mux->index_table, MXFIndexTableSegment,
+          mux->current_index_pos).n_index_entries > 0) {
+    MXFFraction edit_rate = g_array_index (mux->index_table,
+        MXFIndexTableSegment, mux->current_index_pos).index_edit_rate;
+
+    gst_mxf_mux_add_index_table_segment (mux, &edit_rate);
+  }
+
+  for (i = mux->next_index_pos; i < mux->current_index_pos; i++) {
+    buf =
+        mxf_index_table_segment_to_buffer (&g_array_index (mux->index_table,
+            MXFIndexTableSegment, i));
+    index_byte_count += gst_buffer_get_size (buf);
+    index_buffers = g_list_prepend (index_buffers, buf);
+  }
+  index_buffers = g_list_reverse (index_buffers);
+  mux->next_index_pos = mux->current_index_pos;
+
+  p.this_partition = mux->offset;
+  p.prev_partition = mux->body_partitions->len > 0 ?
+      g_array_index (mux->body_partitions, GstMXFMuxPartition,
+      mux->body_partitions->len - 1).this_partition : 0;
+  p.index_byte_count = index_byte_count;
+  p.body_offset = mux->partition.body_offset;
+  p.index_sid = index_byte_count > 0 ? ecd->index_sid : 0;
+  p.body_sid = ecd->body_sid;
+  g_array_append_val (mux->body_partitions, p);
+
+  GST_DEBUG_OBJECT (mux, "Writing body partition at offset %" G_GUINT64_FORMAT
+      " with %" G_GUINT64_FORMAT " bytes of index", p.this_partition,
+      index_byte_count);
+
+  gst_mxf_mux_set_body_partition_pack (mux, &p, 0);
+  buf = mxf_partition_pack_to_buffer (&mux->partition);
+  if ((ret = gst_mxf_mux_push (mux, buf)) != GST_FLOW_OK) {
+    g_list_foreach (index_buffers, (GFunc) gst_mini_object_unref, NULL);
+    g_list_free (index_buffers);
+    return ret;
+  }
+
+  for (l = index_buffers; l; l = l->next) {
+    if ((ret = gst_mxf_mux_push (mux, l->data)) != GST_FLOW_OK) {
+      g_list_foreach (l->next, (GFunc) gst_mini_object_unref, NULL);
+      break;
+    }
+  }
+  g_list_free (index_buffers);
+
+  return ret;
+}
+
 static const guint8 _gc_essence_element_ul[] = {
   0x06, 0x0e, 0x2b, 0x34, 0x01, 0x02, 0x01, 0x01,
   0x0d, 0x01, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00
@@ -1270,53 +1532,47 @@ gst_mxf_mux_handle_buffer (GstMXFMux * mux, GstMXFMuxPad * pad)
   /* We currently only index the first essence stream */
   if (pad == (GstMXFMuxPad *) GST_ELEMENT_CAST (mux)->sinkpads->data) {
     MXFIndexTableSegment *segment;
-    const gint max_segment_size = G_MAXUINT16 / 11;
+    MXFIndexEntry *entry;
+    guint slot = pad->pos % G_N_ELEMENTS (mux->pending_temporal_offsets);
+
+    /* Start a new body partition at the first keyframe after the interval */
+    if (mux->partition_interval > 0 && is_keyframe && pad->pos > 0 &&
+        pad->last_timestamp >= mux->partition_start + mux->partition_interval) {
+      if ((ret = gst_mxf_mux_write_body_partition (mux)) != GST_FLOW_OK) {
+        GST_ERROR_OBJECT (mux, "Failed writing body partition: %s",
+            gst_flow_get_name (ret));
+        gst_buffer_unref (buf);
+        return ret;
+      }
+      mux->partition_start = pad->last_timestamp;
+    }
 
     if (mux->index_table->len == 0 ||
         g_array_index (mux->index_table, MXFIndexTableSegment,
-            mux->current_index_pos).index_duration >= max_segment_size) {
-
-      if (mux->index_table->len > 0)
-        mux->current_index_pos++;
-
-      if (mux->index_table->len <= mux->current_index_pos) {
-        MXFIndexTableSegment s;
-
-        memset (&segment, 0, sizeof (segment));
-
-        mxf_uuid_init (&s.instance_id, mux->metadata);
-        memcpy (&s.index_edit_rate, &pad->source_track->edit_rate,
-            sizeof (s.index_edit_rate));
-        if (mux->index_table->len > 0)
-          s.index_start_position =
-              g_array_index (mux->index_table, MXFIndexTableSegment,
-              mux->index_table->len - 1).index_start_position;
-        else
-          s.index_start_position = 0;
-        s.index_duration = 0;
-        s.edit_unit_byte_count = 0;
-        s.index_sid =
-            mux->preface->content_storage->essence_container_data[0]->index_sid;
-        s.body_sid =
-            mux->preface->content_storage->essence_container_data[0]->body_sid;
-        s.slice_count = 0;
-        s.pos_table_count = 0;
-        s.n_delta_entries = 0;
-        s.delta_entries = NULL;
-        s.n_index_entries = 0;
-        s.index_entries = g_new0 (MXFIndexEntry, max_segment_size);
-        g_array_append_val (mux->index_table, s);
-      }
-    }
+            mux->current_index_pos).n_index_entries >= MAX_INDEX_SEGMENT_SIZE)
+      gst_mxf_mux_add_index_table_segment (mux,
+          &pad->source_track->edit_rate);
     segment =
         &g_array_index (mux->index_table, MXFIndexTableSegment,
         mux->current_index_pos);
 
+    if (is_keyframe)
+      mux->last_keyframe_pos = pad->pos;
+
+    entry = &segment->index_entries[segment->n_index_entries];
+    entry->temporal_offset = mux->pending_temporal_offsets[slot];
+    mux->pending_temporal_offsets[slot] = 0;
+    entry->key_frame_offset =
+        -(gint) MIN (pad->pos - mux->last_keyframe_pos, 128);
+    entry->flags = is_keyframe ? 0x80 : 0x20;   /* FIXME: Need to distinguish all the cases */
+    entry->stream_offset = mux->partition.body_offset;
+
+    segment->n_index_entries++;
+    segment->index_duration++;
+
     if (dts != GST_CLOCK_TIME_NONE && pts != GST_CLOCK_TIME_NONE) {
       guint64 pts_pos;
-      guint64 pts_index_pos, pts_segment_pos;
       gint64 index_pos_diff;
-      MXFIndexTableSegment *pts_segment;
 
       pts =
           gst_segment_to_running_time (&pad->parent.segment, GST_FORMAT_TIME,
@@ -1325,79 +1581,23 @@ gst_mxf_mux_handle_buffer (GstMXFMux * mux, GstMXFMuxPad * pad)
           gst_util_uint64_scale_round (pts, pad->source_track->edit_rate.n,
           pad->source_track->edit_rate.d * GST_SECOND);
 
+      /* The entry of the edit unit presented now points at the one stored
+       * now. Entries after the current one are not created yet, their
+       * temporal offsets are kept until then */
       index_pos_diff = pts_pos - pad->pos;
-      pts_index_pos = mux->current_index_pos;
-      pts_segment_pos = segment->n_index_entries;
-      if (index_pos_diff >= 0) {
-        while (pts_segment_pos + index_pos_diff >= max_segment_size) {
-          index_pos_diff -= max_segment_size - pts_segment_pos;
-          pts_segment_pos = 0;
-          pts_index_pos++;
-
-          if (pts_index_pos >= mux->index_table->len) {
-            MXFIndexTableSegment s;
-
-            memset (&segment, 0, sizeof (segment));
-
-            mxf_uuid_init (&s.instance_id, mux->metadata);
-            memcpy (&s.index_edit_rate, &pad->source_track->edit_rate,
-                sizeof (s.index_edit_rate));
-            if (mux->index_table->len > 0)
-              s.index_start_position =
-                  g_array_index (mux->index_table, MXFIndexTableSegment,
-                  mux->index_table->len - 1).index_start_position;
-            else
-              s.index_start_position = 0;
-            s.index_duration = 0;
-            s.edit_unit_byte_count = 0;
-            s.index_sid =
-                mux->preface->content_storage->
-                essence_container_data[0]->index_sid;
-            s.body_sid =
-                mux->preface->content_storage->
-                essence_container_data[0]->body_sid;
-            s.slice_count = 0;
-            s.pos_table_count = 0;
-            s.n_delta_entries = 0;
-            s.delta_entries = NULL;
-            s.n_index_entries = 0;
-            s.index_entries = g_new0 (MXFIndexEntry, max_segment_size);
-            g_array_append_val (mux->index_table, s);
-          }
-        }
+      if (index_pos_diff <= -128 || index_pos_diff >= 128) {
+        GST_WARNING_OBJECT (pad, "Can't index reordering by %" G_GINT64_FORMAT
+            " edit units", index_pos_diff);
+      } else if (index_pos_diff > 0) {
+        mux->pending_temporal_offsets[pts_pos %
+            G_N_ELEMENTS (mux->pending_temporal_offsets)] = -index_pos_diff;
       } else {
-        while (pts_segment_pos + index_pos_diff <= 0) {
-          if (pts_index_pos == 0) {
-            pts_index_pos = G_MAXUINT64;
-            break;
-          }
-          index_pos_diff += pts_segment_pos;
-          pts_segment_pos = max_segment_size;
-          pts_index_pos--;
-        }
-      }
-      if (pts_index_pos != G_MAXUINT64) {
-        g_assert (index_pos_diff < 127 && index_pos_diff >= -127);
-        pts_segment =
-            &g_array_index (mux->index_table, MXFIndexTableSegment,
-            pts_index_pos);
-        pts_segment->index_entries[pts_segment_pos +
-            index_pos_diff].temporal_offset = -index_pos_diff;
+        MXFIndexEntry *pts_entry = gst_mxf_mux_get_index_entry (mux, pts_pos);
+
+        if (pts_entry)
+          pts_entry->temporal_offset = -index_pos_diff;
       }
     }
-
-    /* Leave temporal offset initialized at 0, above code will set it as necessary */
-    ;
-    if (is_keyframe)
-      mux->last_keyframe_pos = pad->pos;
-    segment->index_entries[segment->n_index_entries].key_frame_offset =
-        MIN (pad->pos - mux->last_keyframe_pos, 127);
-    segment->index_entries[segment->n_index_entries].flags = is_keyframe ? 0x80 : 0x20; /* FIXME: Need to distinguish all the cases */
-    segment->index_entries[segment->n_index_entries].stream_offset =
-        mux->partition.body_offset;
-
-    segment->n_index_entries++;
-    segment->index_duration++;
   }
 
   buf_size = gst_buffer_get_size (buf);
@@ -1430,26 +1630,21 @@ gst_mxf_mux_handle_buffer (GstMXFMux * mux, GstMXFMuxPad * pad)
   return ret;
 }
 
-static GstFlowReturn
-gst_mxf_mux_write_body_partition (GstMXFMux * mux)
+/* Makes downstream continue writing at @offset */
+static gboolean
+gst_mxf_mux_seek (GstMXFMux * mux, guint64 offset)
 {
-  GstBuffer *buf;
+  GstSegment segment;
 
-  mux->partition.type = MXF_PARTITION_PACK_BODY;
-  mux->partition.closed = TRUE;
-  mux->partition.complete = TRUE;
-  mux->partition.this_partition = mux->offset;
-  mux->partition.prev_partition = 0;
-  mux->partition.footer_partition = 0;
-  mux->partition.header_byte_count = 0;
-  mux->partition.index_byte_count = 0;
-  mux->partition.index_sid = 0;
-  mux->partition.body_offset = 0;
-  mux->partition.body_sid =
-      mux->preface->content_storage->essence_container_data[0]->body_sid;
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  segment.start = segment.time = segment.position = offset;
+  if (!gst_pad_push_event (GST_AGGREGATOR_SRC_PAD (mux),
+          gst_event_new_segment (&segment)))
+    return FALSE;
 
-  buf = mxf_partition_pack_to_buffer (&mux->partition);
-  return gst_mxf_mux_push (mux, buf);
+  mux->offset = offset;
+
+  return TRUE;
 }
 
 static GstFlowReturn
@@ -1566,23 +1761,27 @@ gst_mxf_mux_handle_eos (GstMXFMux * mux)
   }
 
   {
-    guint64 body_partition = mux->partition.this_partition;
-    guint32 body_sid = mux->partition.body_sid;
     guint64 footer_partition = mux->offset;
     GArray *rip;
     GstFlowReturn ret;
-    GstSegment segment;
     MXFRandomIndexPackEntry entry;
     GList *index_entries = NULL, *l;
     guint index_byte_count = 0;
     guint i;
     GstBuffer *buf;
 
-    for (i = 0; i < mux->index_table->len; i++) {
+    /* Index table segments that were already written into body partitions
+     * are only repeated if their temporal offsets changed afterwards */
+    for (i = MIN (mux->next_index_pos, mux->first_dirty_index_pos);
+        i < mux->index_table->len; i++) {
       MXFIndexTableSegment *segment =
           &g_array_index (mux->index_table, MXFIndexTableSegment, i);
-      GstBuffer *segment_buffer = mxf_index_table_segment_to_buffer (segment);
+      GstBuffer *segment_buffer;
+
+      if (segment->n_index_entries == 0)
+        continue;
 
+      segment_buffer = mxf_index_table_segment_to_buffer (segment);
       index_byte_count += gst_buffer_get_size (segment_buffer);
       index_entries = g_list_prepend (index_entries, segment_buffer);
     }
@@ -1591,7 +1790,9 @@ gst_mxf_mux_handle_eos (GstMXFMux * mux)
     mux->partition.closed = TRUE;
     mux->partition.complete = TRUE;
     mux->partition.this_partition = mux->offset;
-    mux->partition.prev_partition = body_partition;
+    mux->partition.prev_partition =
+        g_array_index (mux->body_partitions, GstMXFMuxPartition,
+        mux->body_partitions->len - 1).this_partition;
     mux->partition.footer_partition = mux->offset;
     mux->partition.header_byte_count = 0;
     mux->partition.index_byte_count = index_byte_count;
@@ -1600,7 +1801,7 @@ gst_mxf_mux_handle_eos (GstMXFMux * mux)
     mux->partition.body_offset = 0;
     mux->partition.body_sid = 0;
 
-    gst_mxf_mux_write_header_metadata (mux);
+    gst_mxf_mux_write_header_metadata (mux, 0, 0);
 
     index_entries = g_list_reverse (index_entries);
     for (l = index_entries; l; l = l->next) {
@@ -1610,13 +1811,19 @@ gst_mxf_mux_handle_eos (GstMXFMux * mux)
     }
     g_list_free (index_entries);
 
-    rip = g_array_sized_new (FALSE, FALSE, sizeof (MXFRandomIndexPackEntry), 3);
+    rip = g_array_sized_new (FALSE, FALSE, sizeof (MXFRandomIndexPackEntry),
+        mux->body_partitions->len + 2);
     entry.offset = 0;
     entry.body_sid = 0;
     g_array_append_val (rip, entry);
-    entry.offset = body_partition;
-    entry.body_sid = body_sid;
-    g_array_append_val (rip, entry);
+    for (i = 0; i < mux->body_partitions->len; i++) {
+      const GstMXFMuxPartition *p =
+          &g_array_index (mux->body_partitions, GstMXFMuxPartition, i);
+
+      entry.offset = p->this_partition;
+      entry.body_sid = p->body_sid;
+      g_array_append_val (rip, entry);
+    }
     entry.offset = footer_partition;
     entry.body_sid = 0;
     g_array_append_val (rip, entry);
@@ -1627,11 +1834,9 @@ gst_mxf_mux_handle_eos (GstMXFMux * mux)
     }
     g_array_free (rip, TRUE);
 
-    /* Rewrite header partition with updated values */
-    gst_segment_init (&segment, GST_FORMAT_BYTES);
-    if (gst_pad_push_event (GST_AGGREGATOR_SRC_PAD (mux),
-            gst_event_new_segment (&segment))) {
-      mux->offset = 0;
+    /* Rewrite header partition with updated values. The header metadata
+     * was written with fill after it, so it can be replaced in place */
+    if (gst_mxf_mux_seek (mux, 0)) {
       mux->partition.type = MXF_PARTITION_PACK_HEADER;
       mux->partition.closed = TRUE;
       mux->partition.complete = TRUE;
@@ -1644,32 +1849,33 @@ gst_mxf_mux_handle_eos (GstMXFMux * mux)
       mux->partition.body_offset = 0;
       mux->partition.body_sid = 0;
 
-      ret = gst_mxf_mux_write_header_metadata (mux);
-      if (ret != GST_FLOW_OK) {
+      ret = gst_mxf_mux_write_header_metadata (mux, mux->header_byte_count, 0);
+      if (ret == GST_FLOW_NOT_SUPPORTED) {
+        GST_WARNING_OBJECT (mux, "Can't rewrite header partition in place");
+        return GST_FLOW_OK;
+      } else if (ret != GST_FLOW_OK) {
         GST_ERROR_OBJECT (mux, "Rewriting header partition failed");
         return ret;
       }
 
-      g_assert (mux->offset == body_partition);
+      /* Let all body partitions point to the footer */
+      for (i = 0; i < mux->body_partitions->len; i++) {
+        const GstMXFMuxPartition *p =
+            &g_array_index (mux->body_partitions, GstMXFMuxPartition, i);
 
-      mux->partition.type = MXF_PARTITION_PACK_BODY;
-      mux->partition.closed = TRUE;
-      mux->partition.complete = TRUE;
-      mux->partition.this_partition = mux->offset;
-      mux->partition.prev_partition = 0;
-      mux->partition.footer_partition = footer_partition;
-      mux->partition.header_byte_count = 0;
-      mux->partition.index_byte_count = 0;
-      mux->partition.index_sid = 0;
-      mux->partition.body_offset = 0;
-      mux->partition.body_sid =
-          mux->preface->content_storage->essence_container_data[0]->body_sid;
+        if (mux->offset != p->this_partition
+            && !gst_mxf_mux_seek (mux, p->this_partition)) {
+          GST_WARNING_OBJECT (mux, "Can't rewrite body partition");
+          break;
+        }
 
-      buf = mxf_partition_pack_to_buffer (&mux->partition);
-      ret = gst_mxf_mux_push (mux, buf);
-      if (ret != GST_FLOW_OK) {
-        GST_ERROR_OBJECT (mux, "Rewriting body partition failed");
-        return ret;
+        gst_mxf_mux_set_body_partition_pack (mux, p, footer_partition);
+        buf = mxf_partition_pack_to_buffer (&mux->partition);
+        ret = gst_mxf_mux_push (mux, buf);
+        if (ret != GST_FLOW_OK) {
+          GST_ERROR_OBJECT (mux, "Rewriting body partition failed");
+          return ret;
+        }
       }
     } else {
       GST_WARNING_OBJECT (mux, "Can't rewrite header partition");
@@ -1750,8 +1956,10 @@ gst_mxf_mux_aggregate (GstAggregator * aggregator, gboolean timeout)
     if ((ret = gst_mxf_mux_init_partition_pack (mux)) != GST_FLOW_OK)
       goto error;
 
-    if ((ret = gst_mxf_mux_write_header_metadata (mux)) != GST_FLOW_OK)
+    if ((ret = gst_mxf_mux_write_header_metadata (mux, 0,
+                HEADER_METADATA_RESERVE)) != GST_FLOW_OK)
       goto error;
+    mux->header_byte_count = mux->partition.header_byte_count;
 
     /* Sort pads, we will always write in that order */
     GST_OBJECT_LOCK (mux);
@@ -47,6 +47,16 @@ typedef enum
   GST_MXF_MUX_STATE_ERROR
 } GstMXFMuxState;
 
+typedef struct
+{
+  guint64 this_partition;
+  guint64 prev_partition;
+  guint64 index_byte_count;
+  guint64 body_offset;
+  guint32 index_sid;
+  guint32 body_sid;
+} GstMXFMuxPartition;
+
 typedef struct _GstMXFMux {
   GstAggregator parent;
 
@@ -72,6 +82,20 @@ typedef struct _GstMXFMux {
   GArray *index_table;
   guint current_index_pos;
   guint64 last_keyframe_pos;
+  /* temporal offsets for index entries that were not created yet */
+  gint8 pending_temporal_offsets[128];
+  /* index table segments before this one were written in body partitions */
+  guint next_index_pos;
+  /* first written segment that was modified afterwards, or G_MAXUINT */
+  guint first_dirty_index_pos;
+
+  /* GstMXFMuxPartition for all body partitions written so far */
+  GArray *body_partitions;
+  GstClockTime partition_start;
+  guint64 header_byte_count;
+
+  /* properties */
+  GstClockTime partition_interval;
 } GstMXFMux;
 
 typedef struct _GstMXFMuxClass {
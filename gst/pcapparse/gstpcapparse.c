@@ -26,8 +26,17 @@
  * #GstPcapParse:src-port and #GstPcapParse:dst-port to restrict which packets
  * should be included.
  *
- * The supported data format is the classical
+ * The supported data formats are the classical
  * [libpcap file format](https://wiki.wireshark.org/Development/LibpcapFileFormat)
+ * and the [pcapng file format](https://wiki.wireshark.org/Development/PcapNg).
+ *
+ * With #GstPcapParse:split-flows, every UDP or TCP flow matching the filters
+ * is output on its own src_%u pad instead of all of them on the src pad.
+ *
+ * The output buffers are timestamped with the capture time, so that a sink
+ * synchronizing on the clock replays the packets at their original pace.
+ * In pull mode, the file is read in big blocks and the payloads are output
+ * without copying them.
  *
  * ## Example pipelines
  * |[
@@ -35,6 +44,13 @@
  * ! ffdec_h264 ! fakesink
  * ]| Read from a pcap dump file using filesrc, extract the raw UDP packets,
  * depayload and decode them.
+ * |[
+ * gst-launch-1.0 filesrc location=multicast.pcapng ! pcapparse split-flows=true
+ *   caps="video/mpeg,mpegversion=2,systemstream=true" name=p
+ *   p. ! queue ! udpsink host=239.1.1.1 port=5000
+ *   p. ! queue ! udpsink host=239.1.1.2 port=5000
+ * ]| Replay the first two flows of a capture of multicast transport streams
+ * in real time.
  *
  */
 
@@ -64,6 +80,48 @@ const guint GST_PCAPPARSE_MAGIC_NANOSECOND_NO_SWAP_ENDIAN = 0xa1b23c4d;
 const guint GST_PCAPPARSE_MAGIC_MILLISECOND_SWAP_ENDIAN = 0xd4c3b2a1;
 const guint GST_PCAPPARSE_MAGIC_NANOSECOND_SWAP_ENDIAN = 0x4d3cb2a1;
 
+#define PCAPNG_BLOCK_SHB 0x0a0d0d0a
+#define PCAPNG_BLOCK_IDB 0x00000001
+#define PCAPNG_BLOCK_PB  0x00000002
+#define PCAPNG_BLOCK_SPB 0x00000003
+#define PCAPNG_BLOCK_EPB 0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1a2b3c4d
+
+#define PCAPNG_OPT_END_OF_OPT 0
+#define PCAPNG_OPT_IF_TSRESOL 9
+#define PCAPNG_OPT_IF_TSOFFSET 14
+
+/* enough for the pcap global header and all record and block headers */
+#define RECORD_HEADER_PEEK_SIZE 24
+
+/* the largest snaplen of libpcap, no record captures more than that */
+#define PCAP_MAX_CAPTURE_LENGTH (256 * 1024)
+
+/* amount of data pulled at once, one buffer list is pushed per block */
+#define PULL_BLOCK_SIZE (64 * 1024)
+
+#define DEFAULT_SPLIT_FLOWS FALSE
+
+typedef struct
+{
+  GstPcapParseLinktype linktype;
+  guint32 snaplen;
+  /* timestamp units per second */
+  guint64 ts_rate;
+  gint64 ts_offset;
+} GstPcapParseInterface;
+
+typedef struct
+{
+  /* captured packet in the record, if any */
+  guint packet_offset;
+  guint packet_size;
+  GstPcapParseLinktype linktype;
+  GstClockTime ts;
+} GstPcapParseRecord;
+
+#define GST_PCAP_PARSE_FLOW_NEED_DATA GST_FLOW_CUSTOM_SUCCESS
+
 
 enum
 {
@@ -73,7 +131,8 @@ enum
   PROP_SRC_PORT,
   PROP_DST_PORT,
   PROP_CAPS,
-  PROP_TS_OFFSET
+  PROP_TS_OFFSET,
+  PROP_SPLIT_FLOWS
 };
 
 GST_DEBUG_CATEGORY_STATIC (gst_pcap_parse_debug);
@@ -89,6 +148,12 @@ static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS_ANY);
 
+static GstStaticPadTemplate flow_src_template =
+GST_STATIC_PAD_TEMPLATE ("src_%u",
+    GST_PAD_SRC,
+    GST_PAD_SOMETIMES,
+    GST_STATIC_CAPS_ANY);
+
 static void gst_pcap_parse_finalize (GObject * object);
 static void gst_pcap_parse_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
@@ -98,16 +163,49 @@ static GstStateChangeReturn
 gst_pcap_parse_change_state (GstElement * element, GstStateChange transition);
 
 static void gst_pcap_parse_reset (GstPcapParse * self);
+static void gst_pcap_parse_remove_flows (GstPcapParse * self);
 
 static GstFlowReturn gst_pcap_parse_chain (GstPad * pad,
     GstObject * parent, GstBuffer * buffer);
 static gboolean gst_pcap_sink_event (GstPad * pad,
     GstObject * parent, GstEvent * event);
+static gboolean gst_pcap_parse_sink_activate (GstPad * sinkpad,
+    GstObject * parent);
+static gboolean gst_pcap_parse_sink_activate_mode (GstPad * pad,
+    GstObject * parent, GstPadMode mode, gboolean active);
+static void gst_pcap_parse_loop (GstPad * pad);
 
 
 #define parent_class gst_pcap_parse_parent_class
 G_DEFINE_TYPE (GstPcapParse, gst_pcap_parse, GST_TYPE_ELEMENT);
 
+static guint
+gst_pcap_parse_flow_hash (gconstpointer key)
+{
+  const GstPcapParseFlow *flow = key;
+
+  return flow->src_ip ^ (flow->dst_ip * 31) ^
+      ((flow->src_port << 16) | flow->dst_port) ^ flow->proto;
+}
+
+static gboolean
+gst_pcap_parse_flow_equal (gconstpointer a, gconstpointer b)
+{
+  const GstPcapParseFlow *flow_a = a, *flow_b = b;
+
+  return flow_a->src_ip == flow_b->src_ip && flow_a->dst_ip == flow_b->dst_ip
+      && flow_a->src_port == flow_b->src_port
+      && flow_a->dst_port == flow_b->dst_port && flow_a->proto == flow_b->proto;
+}
+
+static void
+gst_pcap_parse_flow_free (GstPcapParseFlow * flow)
+{
+  if (flow->list)
+    gst_buffer_list_unref (flow->list);
+  g_free (flow);
+}
+
 static void
 gst_pcap_parse_class_init (GstPcapParseClass * klass)
 {
@@ -148,8 +246,27 @@ gst_pcap_parse_class_init (GstPcapParseClass * klass)
           "Relative timestamp offset (ns) to apply (-1 = use absolute packet time)",
           -1, G_MAXINT64, -1, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstPcapParse:split-flows:
+   *
+   * Output every UDP or TCP flow, identified by its addresses, ports and
+   * protocol, on its own src_%u pad. The pads are added when the first
+   * packet of a flow is found and all of them get the caps of
+   * #GstPcapParse:caps. The stream-id of a pad contains the flow, for
+   * example "udp/192.168.0.2:4321/239.1.1.1:5000".
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_SPLIT_FLOWS,
+      g_param_spec_boolean ("split-flows", "Split flows",
+          "Output every flow on its own pad", DEFAULT_SPLIT_FLOWS,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_static_pad_template (element_class, &sink_template);
   gst_element_class_add_static_pad_template (element_class, &src_template);
+  gst_element_class_add_static_pad_template (element_class,
+      &flow_src_template);
 
   element_class->change_state = gst_pcap_parse_change_state;
 
@@ -170,6 +287,10 @@ gst_pcap_parse_init (GstPcapParse * self)
   gst_pad_use_fixed_caps (self->sink_pad);
   gst_pad_set_event_function (self->sink_pad,
       GST_DEBUG_FUNCPTR (gst_pcap_sink_event));
+  gst_pad_set_activate_function (self->sink_pad,
+      GST_DEBUG_FUNCPTR (gst_pcap_parse_sink_activate));
+  gst_pad_set_activatemode_function (self->sink_pad,
+      GST_DEBUG_FUNCPTR (gst_pcap_parse_sink_activate_mode));
   gst_element_add_pad (GST_ELEMENT (self), self->sink_pad);
 
   self->src_pad = gst_pad_new_from_static_template (&src_template, "src");
@@ -181,8 +302,18 @@ gst_pcap_parse_init (GstPcapParse * self)
   self->src_port = -1;
   self->dst_port = -1;
   self->offset = -1;
+  self->split_flows = DEFAULT_SPLIT_FLOWS;
 
   self->adapter = gst_adapter_new ();
+  self->interfaces = g_array_new (FALSE, FALSE,
+      sizeof (GstPcapParseInterface));
+  self->src_flow.pad = self->src_pad;
+  self->flows = g_hash_table_new_full (gst_pcap_parse_flow_hash,
+      gst_pcap_parse_flow_equal, NULL,
+      (GDestroyNotify) gst_pcap_parse_flow_free);
+  self->flowcombiner = gst_flow_combiner_new ();
+
+  self->group_id = G_MAXUINT;
 
   gst_pcap_parse_reset (self);
 }
@@ -193,6 +324,11 @@ gst_pcap_parse_finalize (GObject * object)
   GstPcapParse *self = GST_PCAP_PARSE (object);
 
   g_object_unref (self->adapter);
+  g_array_free (self->interfaces, TRUE);
+  g_hash_table_unref (self->flows);
+  gst_flow_combiner_free (self->flowcombiner);
+  if (self->src_flow.list)
+    gst_buffer_list_unref (self->src_flow.list);
   if (self->caps)
     gst_caps_unref (self->caps);
 
@@ -254,6 +390,10 @@ gst_pcap_parse_get_property (GObject * object, guint prop_id,
       g_value_set_int64 (value, self->offset);
       break;
 
+    case PROP_SPLIT_FLOWS:
+      g_value_set_boolean (value, self->split_flows);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -308,27 +448,74 @@ gst_pcap_parse_set_property (GObject * object, guint prop_id,
       self->offset = g_value_get_int64 (value);
       break;
 
+    case PROP_SPLIT_FLOWS:
+      self->split_flows = g_value_get_boolean (value);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static void
+gst_pcap_parse_reset_flow (GstPcapParseFlow * flow)
+{
+  flow->segment_sent = FALSE;
+  flow->first_packet = TRUE;
+  if (flow->list) {
+    gst_buffer_list_unref (flow->list);
+    flow->list = NULL;
+  }
+}
+
 static void
 gst_pcap_parse_reset (GstPcapParse * self)
 {
+  GHashTableIter iter;
+  gpointer flow;
+
   self->initialized = FALSE;
   self->swap_endian = FALSE;
   self->nanosecond_timestamp = FALSE;
   self->cur_packet_size = -1;
   self->cur_ts = GST_CLOCK_TIME_NONE;
   self->base_ts = GST_CLOCK_TIME_NONE;
-  self->newsegment_sent = FALSE;
-  self->first_packet = TRUE;
+  self->pcapng = FALSE;
+  g_array_set_size (self->interfaces, 0);
+  self->pull_offset = 0;
+
+  gst_pcap_parse_reset_flow (&self->src_flow);
+  g_hash_table_iter_init (&iter, self->flows);
+  while (g_hash_table_iter_next (&iter, &flow, NULL))
+    gst_pcap_parse_reset_flow (flow);
+  gst_flow_combiner_reset (self->flowcombiner);
 
   gst_adapter_clear (self->adapter);
 }
 
+static void
+gst_pcap_parse_remove_flows (GstPcapParse * self)
+{
+  GHashTableIter iter;
+  GstPcapParseFlow *flow;
+
+  g_hash_table_iter_init (&iter, self->flows);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & flow, NULL)) {
+    gst_flow_combiner_remove_pad (self->flowcombiner, flow->pad);
+    gst_element_remove_pad (GST_ELEMENT_CAST (self), flow->pad);
+  }
+  g_hash_table_remove_all (self->flows);
+}
+
+static guint16
+gst_pcap_parse_read_uint16 (GstPcapParse * self, const guint8 * p)
+{
+  guint16 val = *((guint16 *) p);
+
+  return self->swap_endian ? GUINT16_SWAP_LE_BE (val) : val;
+}
+
 static guint32
 gst_pcap_parse_read_uint32 (GstPcapParse * self, const guint8 * p)
 {
@@ -345,6 +532,14 @@ gst_pcap_parse_read_uint32 (GstPcapParse * self, const guint8 * p)
   }
 }
 
+static guint64
+gst_pcap_parse_read_uint64 (GstPcapParse * self, const guint8 * p)
+{
+  guint64 val = *((guint64 *) p);
+
+  return self->swap_endian ? GUINT64_SWAP_LE_BE (val) : val;
+}
+
 #define ETH_MAC_ADDRESSES_LEN    12
 #define ETH_HEADER_LEN    14
 #define ETH_VLAN_HEADER_LEN    4
@@ -358,8 +553,9 @@ gst_pcap_parse_read_uint32 (GstPcapParse * self, const guint8 * p)
 
 static gboolean
 gst_pcap_parse_scan_frame (GstPcapParse * self,
-    const guint8 * buf,
-    gint buf_size, const guint8 ** payload, gint * payload_size)
+    GstPcapParseLinktype linktype, const guint8 * buf,
+    gint buf_size, const guint8 ** payload, gint * payload_size,
+    GstPcapParseFlow * flow)
 {
   const guint8 *buf_ip = 0;
   const guint8 *buf_proto;
@@ -376,7 +572,7 @@ gst_pcap_parse_scan_frame (GstPcapParse * self,
   guint16 len;
   guint16 ip_packet_len;
 
-  switch (self->linktype) {
+  switch (linktype) {
     case LINKTYPE_ETHER:
       if (buf_size < ETH_HEADER_LEN + IP_HEADER_MIN_LEN + UDP_HEADER_LEN)
         return FALSE;
@@ -417,7 +613,7 @@ gst_pcap_parse_scan_frame (GstPcapParse * self,
   if (eth_type != 0x800) {
     GST_ERROR_OBJECT (self,
         "Link type %d: Ethernet type %d is not supported; only type 0x800",
-        (gint) self->linktype, (gint) eth_type);
+        (gint) linktype, (gint) eth_type);
     return FALSE;
   }
 
@@ -488,195 +684,748 @@ gst_pcap_parse_scan_frame (GstPcapParse * self,
   if (self->dst_port >= 0 && dst_port != self->dst_port)
     return FALSE;
 
+  flow->src_ip = ip_src_addr;
+  flow->dst_ip = ip_dst_addr;
+  flow->src_port = src_port;
+  flow->dst_port = dst_port;
+  flow->proto = ip_protocol;
+
   return TRUE;
 }
 
+/* Gets the size of the record starting with the @avail bytes of @data,
+ * which are at least RECORD_HEADER_PEEK_SIZE unless the data ends */
+static GstFlowReturn
+gst_pcap_parse_record_size (GstPcapParse * self, const guint8 * data,
+    guint avail, guint * size)
+{
+  if (!self->initialized || self->pcapng) {
+    if (avail < 4)
+      return GST_PCAP_PARSE_FLOW_NEED_DATA;
+
+    /* the block type of a section header reads the same in both byte
+     * orders, its length only after checking the byte order magic */
+    if (*((guint32 *) data) == PCAPNG_BLOCK_SHB) {
+      guint32 magic;
+
+      if (avail < 12)
+        return GST_PCAP_PARSE_FLOW_NEED_DATA;
+
+      magic = *((guint32 *) (data + 8));
+      *size = *((guint32 *) (data + 4));
+      if (magic == GUINT32_SWAP_LE_BE (PCAPNG_BYTE_ORDER_MAGIC)) {
+        *size = GUINT32_SWAP_LE_BE (*size);
+      } else if (magic != PCAPNG_BYTE_ORDER_MAGIC) {
+        GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+            ("File is not a pcapng file, byte order magic is %X", magic));
+        return GST_FLOW_ERROR;
+      }
+    } else if (!self->initialized) {
+      /* sizeof(pcap_hdr_t) == 24 */
+      if (avail < 24)
+        return GST_PCAP_PARSE_FLOW_NEED_DATA;
+      *size = 24;
+      return GST_FLOW_OK;
+    } else {
+      if (avail < 8)
+        return GST_PCAP_PARSE_FLOW_NEED_DATA;
+      *size = gst_pcap_parse_read_uint32 (self, data + 4);
+    }
+
+    if (*size < 12 || *size % 4 != 0) {
+      GST_ELEMENT_ERROR (self, STREAM, DECODE, (NULL),
+          ("Invalid pcapng block length %u", *size));
+      return GST_FLOW_ERROR;
+    }
+  } else {
+    guint32 incl_len;
+
+    /* sizeof(pcaprec_hdr_t) == 16 */
+    if (avail < 16)
+      return GST_PCAP_PARSE_FLOW_NEED_DATA;
+
+    incl_len = gst_pcap_parse_read_uint32 (self, data + 8);
+    if (incl_len > PCAP_MAX_CAPTURE_LENGTH) {
+      GST_ELEMENT_ERROR (self, STREAM, DECODE, (NULL),
+          ("Invalid pcap record length %u", incl_len));
+      return GST_FLOW_ERROR;
+    }
+    *size = 16 + incl_len;
+  }
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+gst_pcap_parse_read_global_header (GstPcapParse * self, const guint8 * data)
+{
+  guint32 magic;
+  guint32 linktype;
+  guint16 major_version;
+
+  magic = *((guint32 *) data);
+  major_version = *((guint16 *) (data + 4));
+  linktype = *((guint32 *) (data + 20));
+
+  if (magic == GST_PCAPPARSE_MAGIC_MILLISECOND_NO_SWAP_ENDIAN ||
+      magic == GST_PCAPPARSE_MAGIC_NANOSECOND_NO_SWAP_ENDIAN) {
+    self->swap_endian = FALSE;
+    if (magic == GST_PCAPPARSE_MAGIC_NANOSECOND_NO_SWAP_ENDIAN)
+      self->nanosecond_timestamp = TRUE;
+  } else if (magic == GST_PCAPPARSE_MAGIC_MILLISECOND_SWAP_ENDIAN ||
+      magic == GST_PCAPPARSE_MAGIC_NANOSECOND_SWAP_ENDIAN) {
+    self->swap_endian = TRUE;
+    if (magic == GST_PCAPPARSE_MAGIC_NANOSECOND_SWAP_ENDIAN)
+      self->nanosecond_timestamp = TRUE;
+    major_version = GUINT16_SWAP_LE_BE (major_version);
+    linktype = GUINT32_SWAP_LE_BE (linktype);
+  } else {
+    GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+        ("File is not a libpcap file, magic is %X", magic));
+    return GST_FLOW_ERROR;
+  }
+
+  if (major_version != 2) {
+    GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+        ("File is not a libpcap major version 2, but %u", major_version));
+    return GST_FLOW_ERROR;
+  }
+
+  if (linktype != LINKTYPE_ETHER && linktype != LINKTYPE_SLL &&
+      linktype != LINKTYPE_RAW) {
+    GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+        ("Only dumps of type Ethernet, raw IP or Linux Cooked (SLL) "
+            "understood; type %d unknown", linktype));
+    return GST_FLOW_ERROR;
+  }
+
+  GST_DEBUG_OBJECT (self, "linktype %u", linktype);
+  self->linktype = linktype;
+  self->initialized = TRUE;
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+gst_pcap_parse_read_section_header (GstPcapParse * self, const guint8 * data,
+    guint size)
+{
+  guint16 major_version;
+
+  if (size < 28)
+    goto invalid;
+
+  self->swap_endian = *((guint32 *) (data + 8)) != PCAPNG_BYTE_ORDER_MAGIC;
+  major_version = gst_pcap_parse_read_uint16 (self, data + 12);
+  if (major_version != 1) {
+    GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+        ("File is not a pcapng major version 1, but %u", major_version));
+    return GST_FLOW_ERROR;
+  }
+
+  GST_DEBUG_OBJECT (self, "pcapng section, swap endian %d",
+      self->swap_endian);
+
+  /* interfaces are numbered per section */
+  g_array_set_size (self->interfaces, 0);
+  self->pcapng = TRUE;
+  self->initialized = TRUE;
+
+  return GST_FLOW_OK;
+
+invalid:
+  GST_ELEMENT_ERROR (self, STREAM, DECODE, (NULL),
+      ("Invalid pcapng section header"));
+  return GST_FLOW_ERROR;
+}
+
+static void
+gst_pcap_parse_read_interface (GstPcapParse * self, const guint8 * data,
+    guint size)
+{
+  GstPcapParseInterface iface;
+  guint pos = 16;
+
+  iface.linktype = gst_pcap_parse_read_uint16 (self, data + 8);
+  iface.snaplen = gst_pcap_parse_read_uint32 (self, data + 12);
+  iface.ts_rate = 1000000;
+  iface.ts_offset = 0;
+
+  while (pos + 4 <= size - 4) {
+    guint16 code = gst_pcap_parse_read_uint16 (self, data + pos);
+    guint16 len = gst_pcap_parse_read_uint16 (self, data + pos + 2);
+    const guint8 *value = data + pos + 4;
+
+    if (code == PCAPNG_OPT_END_OF_OPT || pos + 4 + len > size - 4)
+      break;
+
+    if (code == PCAPNG_OPT_IF_TSRESOL && len >= 1) {
+      guint8 resol = value[0];
+
+      /* negative power of 2 or of 10 */
+      if (resol & 0x80) {
+        if ((resol & 0x7f) < 64)
+          iface.ts_rate = G_GUINT64_CONSTANT (1) << (resol & 0x7f);
+      } else if (resol <= 19) {
+        iface.ts_rate = 1;
+        while (resol--)
+          iface.ts_rate *= 10;
+      }
+    } else if (code == PCAPNG_OPT_IF_TSOFFSET && len >= 8) {
+      iface.ts_offset = gst_pcap_parse_read_uint64 (self, value);
+    }
+
+    pos += 4 + GST_ROUND_UP_4 (len);
+  }
+
+  GST_DEBUG_OBJECT (self, "interface %u: linktype %u, %" G_GUINT64_FORMAT
+      " timestamp units per second", self->interfaces->len, iface.linktype,
+      iface.ts_rate);
+
+  g_array_append_val (self->interfaces, iface);
+}
+
+static GstFlowReturn
+gst_pcap_parse_read_block (GstPcapParse * self, const guint8 * data,
+    guint size, GstPcapParseRecord * rec)
+{
+  GstPcapParseInterface *iface;
+  guint32 block_type, iface_id, caplen;
+  guint64 ts;
+
+  block_type = gst_pcap_parse_read_uint32 (self, data);
+
+  switch (block_type) {
+    case PCAPNG_BLOCK_IDB:
+      if (size < 20)
+        goto invalid;
+      gst_pcap_parse_read_interface (self, data, size);
+      break;
+    case PCAPNG_BLOCK_EPB:
+    case PCAPNG_BLOCK_PB:
+      if (size < 32)
+        goto invalid;
+
+      if (block_type == PCAPNG_BLOCK_EPB)
+        iface_id = gst_pcap_parse_read_uint32 (self, data + 8);
+      else
+        iface_id = gst_pcap_parse_read_uint16 (self, data + 8);
+      caplen = gst_pcap_parse_read_uint32 (self, data + 20);
+      if (caplen > size - 32)
+        goto invalid;
+
+      if (iface_id >= self->interfaces->len) {
+        GST_WARNING_OBJECT (self, "Packet for unknown interface %u", iface_id);
+        break;
+      }
+      iface = &g_array_index (self->interfaces, GstPcapParseInterface,
+          iface_id);
+
+      ts = ((guint64) gst_pcap_parse_read_uint32 (self, data + 12) << 32) |
+          gst_pcap_parse_read_uint32 (self, data + 16);
+      rec->ts = gst_util_uint64_scale (ts, GST_SECOND, iface->ts_rate);
+      if (iface->ts_offset >= 0)
+        rec->ts += iface->ts_offset * GST_SECOND;
+      else if (rec->ts > -iface->ts_offset * GST_SECOND)
+        rec->ts -= -iface->ts_offset * GST_SECOND;
+      else
+        rec->ts = 0;
+
+      rec->linktype = iface->linktype;
+      rec->packet_offset = 28;
+      rec->packet_size = caplen;
+      break;
+    case PCAPNG_BLOCK_SPB:
+      if (size < 16)
+        goto invalid;
+
+      /* always from the first interface, and without timestamp */
+      if (self->interfaces->len == 0) {
+        GST_WARNING_OBJECT (self, "Simple packet without interface");
+        break;
+      }
+      iface = &g_array_index (self->interfaces, GstPcapParseInterface, 0);
+
+      caplen = MIN (gst_pcap_parse_read_uint32 (self, data + 8), size - 16);
+      if (iface->snaplen > 0)
+        caplen = MIN (caplen, iface->snaplen);
+
+      rec->linktype = iface->linktype;
+      rec->packet_offset = 12;
+      rec->packet_size = caplen;
+      break;
+    default:
+      GST_LOG_OBJECT (self, "skipping block of type 0x%08x", block_type);
+      break;
+  }
+
+  return GST_FLOW_OK;
+
+invalid:
+  GST_ELEMENT_ERROR (self, STREAM, DECODE, (NULL),
+      ("Invalid pcapng block of type 0x%08x", block_type));
+  return GST_FLOW_ERROR;
+}
+
+/* Parses a complete record of @size bytes, and returns where the captured
+ * packet is in it, if any */
+static GstFlowReturn
+gst_pcap_parse_read_record (GstPcapParse * self, const guint8 * data,
+    guint size, GstPcapParseRecord * rec)
+{
+  guint32 ts_sec;
+  guint32 ts_usec;
+
+  rec->packet_offset = 0;
+  rec->packet_size = 0;
+  rec->linktype = self->linktype;
+  rec->ts = GST_CLOCK_TIME_NONE;
+
+  if ((!self->initialized || self->pcapng) &&
+      *((guint32 *) data) == PCAPNG_BLOCK_SHB)
+    return gst_pcap_parse_read_section_header (self, data, size);
+
+  if (!self->initialized)
+    return gst_pcap_parse_read_global_header (self, data);
+
+  if (self->pcapng)
+    return gst_pcap_parse_read_block (self, data, size, rec);
+
+  /* Parse the Record (Packet) Header */
+  ts_sec = gst_pcap_parse_read_uint32 (self, data + 0);
+  ts_usec = gst_pcap_parse_read_uint32 (self, data + 4);
+  /* incl_len = gst_pcap_parse_read_uint32 (self, data + 8); */
+  /* orig_len = gst_pcap_parse_read_uint32 (self, data + 12); */
+
+  rec->ts = ts_sec * GST_SECOND +
+      ts_usec * (self->nanosecond_timestamp ? 1 : GST_USECOND);
+  rec->packet_offset = 16;
+  rec->packet_size = size - 16;
+
+  return GST_FLOW_OK;
+}
+
+static GstPcapParseFlow *
+gst_pcap_parse_get_flow (GstPcapParse * self, const GstPcapParseFlow * key)
+{
+  GstPcapParseFlow *flow;
+  const guint8 *src, *dst;
+  gchar *name, *stream_id;
+  GstEvent *event;
+
+  if (!self->split_flows)
+    return &self->src_flow;
+
+  flow = g_hash_table_lookup (self->flows, key);
+  if (G_LIKELY (flow))
+    return flow;
+
+  flow = g_new0 (GstPcapParseFlow, 1);
+  flow->src_ip = key->src_ip;
+  flow->dst_ip = key->dst_ip;
+  flow->src_port = key->src_port;
+  flow->dst_port = key->dst_port;
+  flow->proto = key->proto;
+  flow->first_packet = TRUE;
+
+  name = g_strdup_printf ("src_%u", g_hash_table_size (self->flows));
+  flow->pad = gst_pad_new_from_static_template (&flow_src_template, name);
+  g_free (name);
+  gst_pad_use_fixed_caps (flow->pad);
+  gst_pad_set_active (flow->pad, TRUE);
+
+  src = (const guint8 *) &flow->src_ip;
+  dst = (const guint8 *) &flow->dst_ip;
+  stream_id = gst_pad_create_stream_id_printf (flow->pad,
+      GST_ELEMENT_CAST (self), "%s/%u.%u.%u.%u:%u/%u.%u.%u.%u:%u",
+      flow->proto == IP_PROTO_UDP ? "udp" : "tcp", src[0], src[1], src[2],
+      src[3], flow->src_port, dst[0], dst[1], dst[2], dst[3], flow->dst_port);
+  GST_DEBUG_OBJECT (self, "new flow %s on pad %s", stream_id,
+      GST_PAD_NAME (flow->pad));
+
+  if (self->group_id == G_MAXUINT)
+    self->group_id = gst_util_group_id_next ();
+  event = gst_event_new_stream_start (stream_id);
+  gst_event_set_group_id (event, self->group_id);
+  gst_pad_push_event (flow->pad, event);
+  g_free (stream_id);
+
+  if (self->caps)
+    gst_pad_set_caps (flow->pad, self->caps);
+
+  g_hash_table_add (self->flows, flow);
+  gst_flow_combiner_add_pad (self->flowcombiner, flow->pad);
+  gst_element_add_pad (GST_ELEMENT_CAST (self), flow->pad);
+
+  return flow;
+}
+
+static void
+gst_pcap_parse_queue_buffer (GstPcapParse * self, GstPcapParseFlow * flow,
+    GstBuffer * out_buf, GstClockTime ts)
+{
+  /* only first packet should have DISCONT flag */
+  if (G_LIKELY (!flow->first_packet)) {
+    GST_BUFFER_FLAG_UNSET (out_buf, GST_BUFFER_FLAG_DISCONT);
+  } else {
+    GST_BUFFER_FLAG_SET (out_buf, GST_BUFFER_FLAG_DISCONT);
+    flow->first_packet = FALSE;
+  }
+
+  self->cur_ts = ts;
+  if (GST_CLOCK_TIME_IS_VALID (self->cur_ts)) {
+    if (!GST_CLOCK_TIME_IS_VALID (self->base_ts))
+      self->base_ts = self->cur_ts;
+    if (self->offset >= 0) {
+      self->cur_ts -= self->base_ts;
+      self->cur_ts += self->offset;
+    }
+  }
+  GST_BUFFER_TIMESTAMP (out_buf) = self->cur_ts;
+
+  if (flow->list == NULL)
+    flow->list = gst_buffer_list_new ();
+  gst_buffer_list_add (flow->list, out_buf);
+}
+
+static GstFlowReturn
+gst_pcap_parse_push_flow (GstPcapParse * self, GstPcapParseFlow * flow)
+{
+  GstBufferList *list = flow->list;
+
+  if (!flow->segment_sent) {
+    GstSegment segment;
+
+    if (flow->pad == self->src_pad) {
+      GstEvent *event;
+
+      /* upstream doesn't send one in pull mode */
+      event = gst_pad_get_sticky_event (flow->pad, GST_EVENT_STREAM_START, 0);
+      if (event) {
+        gst_event_unref (event);
+      } else {
+        gchar *stream_id;
+
+        stream_id = gst_pad_create_stream_id (flow->pad,
+            GST_ELEMENT_CAST (self), NULL);
+        event = gst_event_new_stream_start (stream_id);
+        if (self->group_id == G_MAXUINT)
+          self->group_id = gst_util_group_id_next ();
+        gst_event_set_group_id (event, self->group_id);
+        gst_pad_push_event (flow->pad, event);
+        g_free (stream_id);
+      }
+
+      if (self->caps)
+        gst_pad_set_caps (flow->pad, self->caps);
+    }
+
+    gst_segment_init (&segment, GST_FORMAT_TIME);
+    if (GST_CLOCK_TIME_IS_VALID (self->base_ts))
+      segment.start = self->base_ts;
+    gst_pad_push_event (flow->pad, gst_event_new_segment (&segment));
+    flow->segment_sent = TRUE;
+  }
+
+  flow->list = NULL;
+
+  return gst_pad_push_list (flow->pad, list);
+}
+
+static void
+gst_pcap_parse_clear_lists (GstPcapParse * self)
+{
+  GHashTableIter iter;
+  GstPcapParseFlow *flow;
+
+  if (self->src_flow.list) {
+    gst_buffer_list_unref (self->src_flow.list);
+    self->src_flow.list = NULL;
+  }
+
+  g_hash_table_iter_init (&iter, self->flows);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & flow, NULL)) {
+    if (flow->list) {
+      gst_buffer_list_unref (flow->list);
+      flow->list = NULL;
+    }
+  }
+}
+
+/* Pushes the packets collected from the last input on their pads */
+static GstFlowReturn
+gst_pcap_parse_push_lists (GstPcapParse * self)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GHashTableIter iter;
+  GstPcapParseFlow *flow;
+
+  if (!self->split_flows) {
+    if (self->src_flow.list)
+      ret = gst_pcap_parse_push_flow (self, &self->src_flow);
+    return ret;
+  }
+
+  g_hash_table_iter_init (&iter, self->flows);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & flow, NULL)) {
+    if (flow->list) {
+      ret = gst_flow_combiner_update_pad_flow (self->flowcombiner, flow->pad,
+          gst_pcap_parse_push_flow (self, flow));
+      if (ret != GST_FLOW_OK)
+        break;
+    }
+  }
+
+  if (ret != GST_FLOW_OK)
+    gst_pcap_parse_clear_lists (self);
+
+  return ret;
+}
+
 static GstFlowReturn
 gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 {
   GstPcapParse *self = GST_PCAP_PARSE (parent);
   GstFlowReturn ret = GST_FLOW_OK;
-  GstBufferList *list = NULL;
 
   gst_adapter_push (self->adapter, buffer);
 
   while (ret == GST_FLOW_OK) {
-    gint avail;
+    GstPcapParseRecord rec;
+    GstPcapParseFlow key;
     const guint8 *data;
+    const guint8 *payload_data;
+    gint payload_size;
+    guint avail, size;
 
     avail = gst_adapter_available (self->adapter);
 
-    if (self->initialized) {
-      if (self->cur_packet_size >= 0) {
-        /* Parse the Packet Data */
-        if (avail < self->cur_packet_size)
-          break;
-
-        if (self->cur_packet_size > 0) {
-          const guint8 *payload_data;
-          gint payload_size;
-
-          data = gst_adapter_map (self->adapter, self->cur_packet_size);
-
-          GST_LOG_OBJECT (self, "examining packet size %" G_GINT64_FORMAT,
-              self->cur_packet_size);
-
-          if (gst_pcap_parse_scan_frame (self, data, self->cur_packet_size,
-                  &payload_data, &payload_size)) {
-            GstBuffer *out_buf;
-            guintptr offset = payload_data - data;
-
-            gst_adapter_unmap (self->adapter);
-            gst_adapter_flush (self->adapter, offset);
-            /* we don't use _take_buffer_fast() on purpose here, we need a
-             * buffer with a single memory, since the RTP depayloaders expect
-             * the complete RTP header to be in the first memory if there are
-             * multiple ones and we can't guarantee that with _fast() */
-            if (payload_size > 0) {
-              out_buf = gst_adapter_take_buffer (self->adapter, payload_size);
-            } else {
-              out_buf = gst_buffer_new ();
-            }
-
-            /* only first packet should have DISCONT flag */
-            if (G_LIKELY (!self->first_packet)) {
-              GST_BUFFER_FLAG_UNSET (out_buf, GST_BUFFER_FLAG_DISCONT);
-            } else {
-              GST_BUFFER_FLAG_SET (out_buf, GST_BUFFER_FLAG_DISCONT);
-              self->first_packet = FALSE;
-            }
-
-            gst_adapter_flush (self->adapter,
-                self->cur_packet_size - offset - payload_size);
-
-            if (GST_CLOCK_TIME_IS_VALID (self->cur_ts)) {
-              if (!GST_CLOCK_TIME_IS_VALID (self->base_ts))
-                self->base_ts = self->cur_ts;
-              if (self->offset >= 0) {
-                self->cur_ts -= self->base_ts;
-                self->cur_ts += self->offset;
-              }
-            }
-            GST_BUFFER_TIMESTAMP (out_buf) = self->cur_ts;
-
-
-            if (list == NULL)
-              list = gst_buffer_list_new ();
-            gst_buffer_list_add (list, out_buf);
-          } else {
-            gst_adapter_unmap (self->adapter);
-            gst_adapter_flush (self->adapter, self->cur_packet_size);
-          }
-        }
-
-        self->cur_packet_size = -1;
-      } else {
-        /* Parse the Record (Packet) Header */
-        guint32 ts_sec;
-        guint32 ts_usec;
-        guint32 incl_len;
+    if (self->cur_packet_size < 0) {
+      /* Find out the size of the next record from its header */
+      size = MIN (avail, RECORD_HEADER_PEEK_SIZE);
+      if (size == 0)
+        break;
+
+      data = gst_adapter_map (self->adapter, size);
+      ret = gst_pcap_parse_record_size (self, data, size, &size);
+      gst_adapter_unmap (self->adapter);
 
-        /* sizeof(pcaprec_hdr_t) == 16 */
-        if (avail < 16)
-          break;
+      if (ret != GST_FLOW_OK)
+        break;
+      self->cur_packet_size = size;
+    }
 
-        data = gst_adapter_map (self->adapter, 16);
+    /* Parse the whole record */
+    if (avail < self->cur_packet_size)
+      break;
 
-        ts_sec = gst_pcap_parse_read_uint32 (self, data + 0);
-        ts_usec = gst_pcap_parse_read_uint32 (self, data + 4);
-        incl_len = gst_pcap_parse_read_uint32 (self, data + 8);
-        /* orig_len = gst_pcap_parse_read_uint32 (self, data + 12); */
+    size = self->cur_packet_size;
+    self->cur_packet_size = -1;
 
-        gst_adapter_unmap (self->adapter);
-        gst_adapter_flush (self->adapter, 16);
+    data = gst_adapter_map (self->adapter, size);
+    ret = gst_pcap_parse_read_record (self, data, size, &rec);
 
-        self->cur_ts =
-            ts_sec * GST_SECOND +
-            ts_usec * (self->nanosecond_timestamp ? 1 : GST_USECOND);
-        self->cur_packet_size = incl_len;
+    GST_LOG_OBJECT (self, "examining record size %u, packet size %u", size,
+        rec.packet_size);
+
+    if (ret == GST_FLOW_OK && rec.packet_size > 0 &&
+        gst_pcap_parse_scan_frame (self, rec.linktype,
+            data + rec.packet_offset, rec.packet_size, &payload_data,
+            &payload_size, &key)) {
+      GstBuffer *out_buf;
+      guintptr offset = payload_data - data;
+
+      gst_adapter_unmap (self->adapter);
+      gst_adapter_flush (self->adapter, offset);
+      /* we don't use _take_buffer_fast() on purpose here, we need a
+       * buffer with a single memory, since the RTP depayloaders expect
+       * the complete RTP header to be in the first memory if there are
+       * multiple ones and we can't guarantee that with _fast() */
+      if (payload_size > 0) {
+        out_buf = gst_adapter_take_buffer (self->adapter, payload_size);
+      } else {
+        out_buf = gst_buffer_new ();
       }
+      gst_adapter_flush (self->adapter, size - offset - payload_size);
+
+      gst_pcap_parse_queue_buffer (self,
+          gst_pcap_parse_get_flow (self, &key), out_buf, rec.ts);
     } else {
-      /* Parse the Global Header */
-      guint32 magic;
-      guint32 linktype;
-      guint16 major_version;
+      gst_adapter_unmap (self->adapter);
+      gst_adapter_flush (self->adapter, size);
+    }
+  }
 
-      /* sizeof(pcap_hdr_t) == 24 */
-      if (avail < 24)
-        break;
+  if (ret == GST_PCAP_PARSE_FLOW_NEED_DATA)
+    ret = GST_FLOW_OK;
 
-      data = gst_adapter_map (self->adapter, 24);
+  if (ret == GST_FLOW_OK)
+    ret = gst_pcap_parse_push_lists (self);
+  else
+    gst_pcap_parse_clear_lists (self);
 
-      magic = *((guint32 *) data);
-      major_version = *((guint16 *) (data + 4));
-      linktype = *((guint32 *) (data + 20));
-      gst_adapter_unmap (self->adapter);
+  return ret;
+}
+
+static void
+gst_pcap_parse_push_event (GstPcapParse * self, GstEvent * event)
+{
+  GHashTableIter iter;
+  GstPcapParseFlow *flow;
+
+  g_hash_table_iter_init (&iter, self->flows);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & flow, NULL))
+    gst_pad_push_event (flow->pad, gst_event_ref (event));
+
+  gst_pad_push_event (self->src_pad, event);
+}
+
+static void
+gst_pcap_parse_loop (GstPad * pad)
+{
+  GstPcapParse *self = GST_PCAP_PARSE (GST_PAD_PARENT (pad));
+  GstFlowReturn ret, push_ret;
+  GstBuffer *block = NULL;
+  GstMapInfo map;
+  guint to_read, pos = 0;
+
+  /* a record bigger than a block is pulled at once */
+  to_read = MAX (PULL_BLOCK_SIZE, self->cur_packet_size);
+  self->cur_packet_size = -1;
+
+  ret = gst_pad_pull_range (pad, self->pull_offset, to_read, &block);
+  if (ret != GST_FLOW_OK)
+    goto pause;
+
+  gst_buffer_map (block, &map, GST_MAP_READ);
+
+  while (TRUE) {
+    GstPcapParseRecord rec;
+    GstPcapParseFlow key;
+    const guint8 *data = map.data + pos;
+    const guint8 *payload_data;
+    gint payload_size;
+    guint avail = map.size - pos, size;
+
+    ret = gst_pcap_parse_record_size (self, data,
+        MIN (avail, RECORD_HEADER_PEEK_SIZE), &size);
+    if (ret != GST_FLOW_OK)
+      break;
+
+    if (avail < size) {
+      self->cur_packet_size = size;
+      ret = GST_PCAP_PARSE_FLOW_NEED_DATA;
+      break;
+    }
+
+    ret = gst_pcap_parse_read_record (self, data, size, &rec);
+    if (ret != GST_FLOW_OK)
+      break;
 
-      if (magic == GST_PCAPPARSE_MAGIC_MILLISECOND_NO_SWAP_ENDIAN ||
-          magic == GST_PCAPPARSE_MAGIC_NANOSECOND_NO_SWAP_ENDIAN) {
-        self->swap_endian = FALSE;
-        if (magic == GST_PCAPPARSE_MAGIC_NANOSECOND_NO_SWAP_ENDIAN)
-          self->nanosecond_timestamp = TRUE;
-      } else if (magic == GST_PCAPPARSE_MAGIC_MILLISECOND_SWAP_ENDIAN ||
-          magic == GST_PCAPPARSE_MAGIC_NANOSECOND_SWAP_ENDIAN) {
-        self->swap_endian = TRUE;
-        if (magic == GST_PCAPPARSE_MAGIC_NANOSECOND_SWAP_ENDIAN)
-          self->nanosecond_timestamp = TRUE;
-        major_version = GUINT16_SWAP_LE_BE (major_version);
-        linktype = GUINT32_SWAP_LE_BE (linktype);
+    if (rec.packet_size > 0 && gst_pcap_parse_scan_frame (self, rec.linktype,
+            data + rec.packet_offset, rec.packet_size, &payload_data,
+            &payload_size, &key)) {
+      GstBuffer *out_buf;
+
+      /* the block has a single memory, so has the sub-buffer */
+      if (payload_size > 0) {
+        out_buf = gst_buffer_copy_region (block, GST_BUFFER_COPY_MEMORY,
+            payload_data - map.data, payload_size);
       } else {
-        GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
-            ("File is not a libpcap file, magic is %X", magic));
-        ret = GST_FLOW_ERROR;
-        goto out;
+        out_buf = gst_buffer_new ();
       }
 
-      if (major_version != 2) {
-        GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
-            ("File is not a libpcap major version 2, but %u", major_version));
-        ret = GST_FLOW_ERROR;
-        goto out;
-      }
+      gst_pcap_parse_queue_buffer (self,
+          gst_pcap_parse_get_flow (self, &key), out_buf, rec.ts);
+    }
 
-      if (linktype != LINKTYPE_ETHER && linktype != LINKTYPE_SLL &&
-          linktype != LINKTYPE_RAW) {
-        GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
-            ("Only dumps of type Ethernet, raw IP or Linux Cooked (SLL) "
-                "understood; type %d unknown", linktype));
-        ret = GST_FLOW_ERROR;
-        goto out;
-      }
+    pos += size;
+  }
 
-      GST_DEBUG_OBJECT (self, "linktype %u", linktype);
-      self->linktype = linktype;
+  /* no complete record left before the end of the stream */
+  if (ret == GST_PCAP_PARSE_FLOW_NEED_DATA)
+    ret = (pos == 0 && map.size < to_read) ? GST_FLOW_EOS : GST_FLOW_OK;
 
-      gst_adapter_flush (self->adapter, 24);
-      self->initialized = TRUE;
-    }
+  gst_buffer_unmap (block, &map);
+  gst_buffer_unref (block);
+  self->pull_offset += pos;
+
+  if (ret == GST_FLOW_OK || ret == GST_FLOW_EOS) {
+    push_ret = gst_pcap_parse_push_lists (self);
+    if (ret == GST_FLOW_OK)
+      ret = push_ret;
+  } else {
+    gst_pcap_parse_clear_lists (self);
   }
 
-  if (list) {
-    if (!self->newsegment_sent && GST_CLOCK_TIME_IS_VALID (self->cur_ts)) {
-      GstSegment segment;
+  if (ret != GST_FLOW_OK)
+    goto pause;
 
-      if (self->caps)
-        gst_pad_set_caps (self->src_pad, self->caps);
-      gst_segment_init (&segment, GST_FORMAT_TIME);
-      segment.start = self->base_ts;
-      gst_pad_push_event (self->src_pad, gst_event_new_segment (&segment));
-      self->newsegment_sent = TRUE;
+  return;
+
+pause:
+  {
+    GST_LOG_OBJECT (self, "pausing task, reason %s", gst_flow_get_name (ret));
+    gst_pad_pause_task (pad);
+
+    if (ret == GST_FLOW_EOS) {
+      gst_pcap_parse_push_event (self, gst_event_new_eos ());
+    } else if (ret == GST_FLOW_NOT_LINKED || ret < GST_FLOW_EOS) {
+      GST_ELEMENT_FLOW_ERROR (self, ret);
+      gst_pcap_parse_push_event (self, gst_event_new_eos ());
     }
+  }
+}
 
-    ret = gst_pad_push_list (self->src_pad, list);
-    list = NULL;
+static gboolean
+gst_pcap_parse_sink_activate (GstPad * sinkpad, GstObject * parent)
+{
+  GstQuery *query;
+  gboolean pull_mode;
+
+  query = gst_query_new_scheduling ();
+
+  if (!gst_pad_peer_query (sinkpad, query)) {
+    gst_query_unref (query);
+    goto activate_push;
   }
 
-out:
+  pull_mode = gst_query_has_scheduling_mode_with_flags (query,
+      GST_PAD_MODE_PULL, GST_SCHEDULING_FLAG_SEEKABLE);
+  gst_query_unref (query);
 
-  if (list)
-    gst_buffer_list_unref (list);
+  if (!pull_mode)
+    goto activate_push;
 
-  return ret;
+  GST_DEBUG_OBJECT (sinkpad, "activating pull");
+  return gst_pad_activate_mode (sinkpad, GST_PAD_MODE_PULL, TRUE);
+
+activate_push:
+  {
+    GST_DEBUG_OBJECT (sinkpad, "activating push");
+    return gst_pad_activate_mode (sinkpad, GST_PAD_MODE_PUSH, TRUE);
+  }
+}
+
+static gboolean
+gst_pcap_parse_sink_activate_mode (GstPad * pad, GstObject * parent,
+    GstPadMode mode, gboolean active)
+{
+  GstPcapParse *self = GST_PCAP_PARSE (parent);
+
+  switch (mode) {
+    case GST_PAD_MODE_PUSH:
+      return TRUE;
+    case GST_PAD_MODE_PULL:
+      if (active) {
+        self->pull_offset = 0;
+        return gst_pad_start_task (pad, (GstTaskFunction) gst_pcap_parse_loop,
+            pad, NULL);
+      }
+      return gst_pad_stop_task (pad);
+    default:
+      return FALSE;
+  }
 }
 
 static gboolean
@@ -694,6 +1443,10 @@ gst_pcap_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       gst_pcap_parse_reset (self);
       /* Push event down the pipeline so that other elements stop flushing */
       /* fall through */
+    case GST_EVENT_FLUSH_START:
+    case GST_EVENT_EOS:
+      gst_pcap_parse_push_event (self, event);
+      break;
     default:
       ret = gst_pad_push_event (self->src_pad, event);
       break;
@@ -713,6 +1466,8 @@ gst_pcap_parse_change_state (GstElement * element, GstStateChange transition)
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       gst_pcap_parse_reset (self);
+      gst_pcap_parse_remove_flows (self);
+      self->group_id = G_MAXUINT;
       break;
     default:
       break;
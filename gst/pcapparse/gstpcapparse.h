@@ -22,6 +22,7 @@
 
 #include <gst/gst.h>
 #include <gst/base/gstadapter.h>
+#include <gst/base/gstflowcombiner.h>
 
 G_BEGIN_DECLS
 
@@ -52,6 +53,21 @@ typedef enum
   LINKTYPE_SLL = 113
 } GstPcapParseLinktype;
 
+typedef struct
+{
+  /* 5-tuple, addresses in network byte order */
+  guint32 src_ip;
+  guint32 dst_ip;
+  guint16 src_port;
+  guint16 dst_port;
+  guint8 proto;
+
+  GstPad *pad;
+  gboolean segment_sent;
+  gboolean first_packet;
+  GstBufferList *list;
+} GstPcapParseFlow;
+
 /**
  * GstPcapParse:
  *
@@ -73,6 +89,7 @@ struct _GstPcapParse
   gint32 dst_port;
   GstCaps *caps;
   gint64 offset;
+  gboolean split_flows;
 
   /* state */
   GstAdapter * adapter;
@@ -84,8 +101,19 @@ struct _GstPcapParse
   GstClockTime base_ts;
   GstPcapParseLinktype linktype;
 
-  gboolean newsegment_sent;
-  gboolean first_packet;
+  /* pcapng interfaces of the current section */
+  gboolean pcapng;
+  GArray *interfaces;
+
+  /* next offset to pull from in pull mode */
+  guint64 pull_offset;
+
+  /* all packets when not splitting flows */
+  GstPcapParseFlow src_flow;
+  /* GstPcapParseFlow -> itself, when splitting flows */
+  GHashTable *flows;
+  GstFlowCombiner *flowcombiner;
+  guint group_id;
 };
 
 struct _GstPcapParseClass
@@ -0,0 +1,615 @@
+/* GStreamer RIST plugin
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:element-ristdispatcher
+ * @title: ristdispatcher
+ * @see_also: ristsink, roundrobin
+ *
+ * This element distributes incoming RTP packets over multiple src pads,
+ * like roundrobin, but gives each link a share of the traffic that depends
+ * on how well it performs. Each link is scored from its round trip time and
+ * its packet loss, so that slow or lossy links carry less traffic while
+ * every link still keeps a minimal share (see "min-weight") so that it
+ * can be probed and recover.
+ *
+ * The measurements are fed back by the application, usually ristsink,
+ * using two action signals. "update-link" passes the latest round trip
+ * time of a link and closes its measurement window. "report-lost" passes
+ * the sequence number of a packet the receiver reported as lost (NACKed).
+ * The element remembers which link carried each sequence number, so that
+ * losses are accounted to the right link even if all the NACKs arrive on a
+ * single link.
+ *
+ * Per link measurements and the resulting weights are available through
+ * the "stats" property.
+ *
+ * Since: 1.18
+ */
+
+/* using GValueArray, which has not replacement */
+#define GLIB_DISABLE_DEPRECATION_WARNINGS
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "gstrist.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_rist_dispatcher_debug);
+#define GST_CAT_DEFAULT gst_rist_dispatcher_debug
+
+#define DEFAULT_MIN_WEIGHT 0.02
+
+/* Loss is a strong indication of congestion, so the score drops quickly
+ * with it: 10% loss gives 0.66, 30% loss 0.24 */
+#define LOSS_EXPONENT 4.0
+
+/* Windows with fewer packets are merged with the next one to avoid
+ * reacting to a single lost packet */
+#define MIN_WINDOW_PACKETS 16
+
+/* Degradations are tracked faster than recoveries, so that traffic moves
+ * away from a failing link within a couple of reports, but only comes back
+ * once it behaved well for a while */
+#define ALPHA_DEGRADE 0.5
+#define ALPHA_RECOVER 0.125
+
+#define NO_LINK G_MAXUINT8
+
+enum
+{
+  PROP_MIN_WEIGHT = 1,
+  PROP_STATS
+};
+
+enum
+{
+  SIGNAL_UPDATE_LINK,
+  SIGNAL_REPORT_LOST,
+  LAST_SIGNAL
+};
+
+static guint gst_rist_dispatcher_signals[LAST_SIGNAL] = { 0 };
+
+static GstStaticPadTemplate sink_templ = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstStaticPadTemplate src_templ = GST_STATIC_PAD_TEMPLATE ("src_%u",
+    GST_PAD_SRC,
+    GST_PAD_REQUEST,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+typedef struct
+{
+  GstPad *pad;
+  guint id;
+
+  /* Share of the traffic, the weights of all links sum up to 1 */
+  gdouble weight;
+  /* Smooth weighted round robin credit */
+  gdouble credit;
+
+  /* Smoothed measurements */
+  GstClockTime rtt;
+  gdouble loss;
+  gdouble throughput;           /* in bytes per second */
+
+  guint64 sent_packets;
+  guint64 sent_bytes;
+  guint64 lost_packets;
+
+  /* Since the last update */
+  guint window_sent;
+  guint window_lost;
+  guint64 window_bytes;
+  GstClockTime window_start;
+} RistDispatcherLink;
+
+struct _GstRistDispatcher
+{
+  GstElement parent;
+
+  GstPad *sinkpad;
+
+  /* Protected by object lock */
+  gdouble min_weight;
+  GPtrArray *links;             /* RistDispatcherLink indexed by link id */
+  guint n_links;
+  /* Link that carried each RTP seqnum, or NO_LINK */
+  guint8 seqnum_link[G_MAXUINT16 + 1];
+};
+
+G_DEFINE_TYPE_WITH_CODE (GstRistDispatcher, gst_rist_dispatcher,
+    GST_TYPE_ELEMENT, GST_DEBUG_CATEGORY_INIT (gst_rist_dispatcher_debug,
+        "ristdispatcher", 0, "RIST Weighted Dispatcher"));
+
+static gdouble
+ewma (gdouble current, gdouble sample)
+{
+  gdouble alpha = sample > current ? ALPHA_DEGRADE : ALPHA_RECOVER;
+
+  return current + alpha * (sample - current);
+}
+
+/* called with object lock */
+static void
+gst_rist_dispatcher_update_weights (GstRistDispatcher * disp)
+{
+  GstClockTime min_rtt = GST_CLOCK_TIME_NONE;
+  gdouble total = 0.0, min_weight;
+  guint i;
+
+  if (disp->n_links == 0)
+    return;
+
+  for (i = 0; i < disp->links->len; i++) {
+    RistDispatcherLink *link = g_ptr_array_index (disp->links, i);
+
+    if (link && GST_CLOCK_TIME_IS_VALID (link->rtt) && link->rtt > 0)
+      min_rtt = MIN (min_rtt, link->rtt);
+  }
+
+  /* The score is relative to the best link, links without RTT measurement
+   * yet are assumed as fast as the best one so that they get probed */
+  for (i = 0; i < disp->links->len; i++) {
+    RistDispatcherLink *link = g_ptr_array_index (disp->links, i);
+    gdouble score;
+
+    if (!link)
+      continue;
+
+    score = pow (1.0 - link->loss, LOSS_EXPONENT);
+    if (GST_CLOCK_TIME_IS_VALID (min_rtt) && GST_CLOCK_TIME_IS_VALID (link->rtt)
+        && link->rtt > 0)
+      score *= (gdouble) min_rtt / link->rtt;
+
+    link->weight = score;
+    total += score;
+  }
+
+  min_weight = MIN (disp->min_weight, 1.0 / disp->n_links);
+
+  for (i = 0; i < disp->links->len; i++) {
+    RistDispatcherLink *link = g_ptr_array_index (disp->links, i);
+
+    if (!link)
+      continue;
+
+    if (total > 0.0)
+      link->weight /= total;
+    else
+      link->weight = 1.0 / disp->n_links;
+
+    link->weight = min_weight + (1.0 - disp->n_links * min_weight) *
+        link->weight;
+
+    GST_LOG_OBJECT (disp, "link %u: rtt %" GST_TIME_FORMAT " loss %.3f "
+        "throughput %.0f B/s weight %.3f", link->id, GST_TIME_ARGS (link->rtt),
+        link->loss, link->throughput, link->weight);
+  }
+}
+
+static void
+gst_rist_dispatcher_update_link (GstRistDispatcher * disp, guint id,
+    guint64 rtt)
+{
+  RistDispatcherLink *link;
+  GstClockTime now;
+
+  GST_OBJECT_LOCK (disp);
+  if (id >= disp->links->len || !(link = g_ptr_array_index (disp->links, id))) {
+    GST_OBJECT_UNLOCK (disp);
+    GST_WARNING_OBJECT (disp, "Update for unknown link %u", id);
+    return;
+  }
+
+  if (rtt > 0) {
+    if (GST_CLOCK_TIME_IS_VALID (link->rtt))
+      link->rtt = ewma (link->rtt, rtt);
+    else
+      link->rtt = rtt;
+  }
+
+  if (link->window_sent >= MIN_WINDOW_PACKETS) {
+    gdouble loss = MIN (1.0, (gdouble) link->window_lost / link->window_sent);
+
+    link->loss = ewma (link->loss, loss);
+    link->window_sent = 0;
+    link->window_lost = 0;
+  }
+
+  now = gst_util_get_timestamp ();
+  if (GST_CLOCK_TIME_IS_VALID (link->window_start) && now > link->window_start) {
+    gdouble throughput = gst_util_uint64_scale (link->window_bytes, GST_SECOND,
+        now - link->window_start);
+
+    /* throughput is not a quality indication, so track it symmetrically */
+    link->throughput += ALPHA_DEGRADE * (throughput - link->throughput);
+  }
+  link->window_bytes = 0;
+  link->window_start = now;
+
+  gst_rist_dispatcher_update_weights (disp);
+  GST_OBJECT_UNLOCK (disp);
+}
+
+static void
+gst_rist_dispatcher_report_lost (GstRistDispatcher * disp, guint seqnum)
+{
+  RistDispatcherLink *link = NULL;
+  guint id;
+
+  GST_OBJECT_LOCK (disp);
+  id = disp->seqnum_link[seqnum & G_MAXUINT16];
+
+  /* Only account each packet once, NACKs are often repeated */
+  disp->seqnum_link[seqnum & G_MAXUINT16] = NO_LINK;
+
+  if (id < disp->links->len)
+    link = g_ptr_array_index (disp->links, id);
+
+  if (link) {
+    link->window_lost++;
+    link->lost_packets++;
+  }
+  GST_OBJECT_UNLOCK (disp);
+}
+
+/* called with object lock */
+static RistDispatcherLink *
+gst_rist_dispatcher_pick_link (GstRistDispatcher * disp)
+{
+  RistDispatcherLink *best = NULL;
+  guint i;
+
+  /* Smooth weighted round robin: every link earns its weight as credit and
+   * the richest one sends. This interleaves links evenly instead of sending
+   * bursts on the heaviest one. */
+  for (i = 0; i < disp->links->len; i++) {
+    RistDispatcherLink *link = g_ptr_array_index (disp->links, i);
+
+    if (!link)
+      continue;
+
+    link->credit += link->weight;
+    if (!best || link->credit > best->credit)
+      best = link;
+  }
+
+  if (best)
+    best->credit -= 1.0;
+
+  return best;
+}
+
+static GstFlowReturn
+gst_rist_dispatcher_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstRistDispatcher *disp = GST_RIST_DISPATCHER (parent);
+  RistDispatcherLink *link;
+  GstPad *src_pad = NULL;
+  guint8 data[2];
+  GstFlowReturn ret;
+
+  GST_OBJECT_LOCK (disp);
+  link = gst_rist_dispatcher_pick_link (disp);
+
+  if (link) {
+    src_pad = gst_object_ref (link->pad);
+
+    if (gst_buffer_extract (buffer, 2, data, 2) == 2)
+      disp->seqnum_link[GST_READ_UINT16_BE (data)] = link->id;
+
+    link->sent_packets++;
+    link->sent_bytes += gst_buffer_get_size (buffer);
+    link->window_sent++;
+    link->window_bytes += gst_buffer_get_size (buffer);
+  }
+  GST_OBJECT_UNLOCK (disp);
+
+  if (!src_pad) {
+    /* no pad, that's fine */
+    gst_buffer_unref (buffer);
+    return GST_FLOW_OK;
+  }
+
+  ret = gst_pad_push (src_pad, buffer);
+  gst_object_unref (src_pad);
+
+  return ret;
+}
+
+static GstPad *
+gst_rist_dispatcher_request_new_pad (GstElement * element,
+    GstPadTemplate * templ, const gchar * name, const GstCaps * caps)
+{
+  GstRistDispatcher *disp = GST_RIST_DISPATCHER (element);
+  RistDispatcherLink *link;
+  GstPad *pad;
+  gchar *pad_name = NULL;
+  guint id;
+
+  GST_OBJECT_LOCK (disp);
+  if (name) {
+    if (sscanf (name, "src_%u", &id) != 1)
+      goto invalid_name;
+  } else {
+    for (id = 0; id < disp->links->len; id++)
+      if (!g_ptr_array_index (disp->links, id))
+        break;
+  }
+
+  if (id >= NO_LINK)
+    goto too_many_links;
+
+  if (id < disp->links->len && g_ptr_array_index (disp->links, id))
+    goto pad_exists;
+
+  if (id >= disp->links->len)
+    g_ptr_array_set_size (disp->links, id + 1);
+
+  pad_name = g_strdup_printf ("src_%u", id);
+  pad = gst_pad_new_from_template (templ, pad_name);
+  g_free (pad_name);
+
+  link = g_slice_new0 (RistDispatcherLink);
+  link->pad = pad;
+  link->id = id;
+  link->rtt = GST_CLOCK_TIME_NONE;
+  link->window_start = GST_CLOCK_TIME_NONE;
+  g_ptr_array_index (disp->links, id) = link;
+  disp->n_links++;
+  gst_pad_set_element_private (pad, link);
+
+  gst_rist_dispatcher_update_weights (disp);
+  GST_OBJECT_UNLOCK (disp);
+
+  gst_pad_set_active (pad, TRUE);
+  gst_element_add_pad (element, pad);
+
+  return pad;
+
+invalid_name:
+  GST_OBJECT_UNLOCK (disp);
+  GST_WARNING_OBJECT (disp, "Invalid pad name %s", name);
+  return NULL;
+too_many_links:
+  GST_OBJECT_UNLOCK (disp);
+  GST_WARNING_OBJECT (disp, "Only up to %u links are supported", NO_LINK);
+  return NULL;
+pad_exists:
+  GST_OBJECT_UNLOCK (disp);
+  GST_WARNING_OBJECT (disp, "Pad %s already exists", name);
+  return NULL;
+}
+
+static void
+gst_rist_dispatcher_release_pad (GstElement * element, GstPad * pad)
+{
+  GstRistDispatcher *disp = GST_RIST_DISPATCHER (element);
+  RistDispatcherLink *link;
+  guint i;
+
+  GST_OBJECT_LOCK (disp);
+  link = gst_pad_get_element_private (pad);
+  g_ptr_array_index (disp->links, link->id) = NULL;
+
+  /* a link requested later may reuse the id, don't blame it for the
+   * losses of this one */
+  for (i = 0; i < G_N_ELEMENTS (disp->seqnum_link); i++)
+    if (disp->seqnum_link[i] == link->id)
+      disp->seqnum_link[i] = NO_LINK;
+
+  disp->n_links--;
+  g_slice_free (RistDispatcherLink, link);
+  gst_rist_dispatcher_update_weights (disp);
+  GST_OBJECT_UNLOCK (disp);
+
+  gst_pad_set_active (pad, FALSE);
+  gst_element_remove_pad (element, pad);
+}
+
+static GstStructure *
+gst_rist_dispatcher_create_stats (GstRistDispatcher * disp)
+{
+  GstStructure *ret;
+  GValueArray *link_stats;
+  guint i;
+
+  ret = gst_structure_new_empty ("rist/x-dispatcher-stats");
+
+  GST_OBJECT_LOCK (disp);
+  link_stats = g_value_array_new (disp->n_links);
+
+  for (i = 0; i < disp->links->len; i++) {
+    RistDispatcherLink *link = g_ptr_array_index (disp->links, i);
+    GValue value = G_VALUE_INIT;
+    GstStructure *stats;
+
+    if (!link)
+      continue;
+
+    stats = gst_structure_new ("rist/x-dispatcher-link-stats",
+        "link-id", G_TYPE_UINT, link->id,
+        "weight", G_TYPE_DOUBLE, link->weight,
+        "round-trip-time", G_TYPE_UINT64,
+        GST_CLOCK_TIME_IS_VALID (link->rtt) ? link->rtt : 0,
+        "loss-fraction", G_TYPE_DOUBLE, link->loss,
+        "throughput", G_TYPE_UINT64, (guint64) link->throughput,
+        "sent-packets", G_TYPE_UINT64, link->sent_packets,
+        "sent-bytes", G_TYPE_UINT64, link->sent_bytes,
+        "lost-packets", G_TYPE_UINT64, link->lost_packets, NULL);
+
+    g_value_init (&value, GST_TYPE_STRUCTURE);
+    g_value_take_boxed (&value, stats);
+    g_value_array_append (link_stats, &value);
+    g_value_unset (&value);
+  }
+  GST_OBJECT_UNLOCK (disp);
+
+  gst_structure_set (ret, "link-stats", G_TYPE_VALUE_ARRAY, link_stats, NULL);
+  g_value_array_free (link_stats);
+
+  return ret;
+}
+
+static void
+gst_rist_dispatcher_init (GstRistDispatcher * disp)
+{
+  disp->sinkpad = gst_pad_new_from_static_template (&sink_templ, "sink");
+  GST_PAD_SET_PROXY_CAPS (disp->sinkpad);
+  GST_PAD_SET_PROXY_SCHEDULING (disp->sinkpad);
+  /* do not proxy allocation, it requires special handling like tee does */
+  gst_pad_set_chain_function (disp->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rist_dispatcher_chain));
+  gst_element_add_pad (GST_ELEMENT (disp), disp->sinkpad);
+
+  disp->min_weight = DEFAULT_MIN_WEIGHT;
+  disp->links = g_ptr_array_new ();
+  memset (disp->seqnum_link, NO_LINK, sizeof (disp->seqnum_link));
+}
+
+static void
+gst_rist_dispatcher_finalize (GObject * object)
+{
+  GstRistDispatcher *disp = GST_RIST_DISPATCHER (object);
+  guint i;
+
+  for (i = 0; i < disp->links->len; i++) {
+    RistDispatcherLink *link = g_ptr_array_index (disp->links, i);
+
+    if (link)
+      g_slice_free (RistDispatcherLink, link);
+  }
+  g_ptr_array_free (disp->links, TRUE);
+
+  G_OBJECT_CLASS (gst_rist_dispatcher_parent_class)->finalize (object);
+}
+
+static void
+gst_rist_dispatcher_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRistDispatcher *disp = GST_RIST_DISPATCHER (object);
+
+  switch (prop_id) {
+    case PROP_MIN_WEIGHT:
+      GST_OBJECT_LOCK (disp);
+      g_value_set_double (value, disp->min_weight);
+      GST_OBJECT_UNLOCK (disp);
+      break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_rist_dispatcher_create_stats (disp));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rist_dispatcher_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRistDispatcher *disp = GST_RIST_DISPATCHER (object);
+
+  switch (prop_id) {
+    case PROP_MIN_WEIGHT:
+      GST_OBJECT_LOCK (disp);
+      disp->min_weight = g_value_get_double (value);
+      gst_rist_dispatcher_update_weights (disp);
+      GST_OBJECT_UNLOCK (disp);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rist_dispatcher_class_init (GstRistDispatcherClass * klass)
+{
+  GstElementClass *element_class = (GstElementClass *) klass;
+  GObjectClass *object_class = (GObjectClass *) klass;
+
+  gst_element_class_set_metadata (element_class,
+      "RIST Weighted Dispatcher", "Filter/Network",
+      "Distributes RTP packets over links according to their quality",
+      "GStreamer maintainers <gstreamer-devel@lists.freedesktop.org>");
+
+  gst_element_class_add_static_pad_template (element_class, &sink_templ);
+  gst_element_class_add_static_pad_template (element_class, &src_templ);
+
+  element_class->request_new_pad =
+      GST_DEBUG_FUNCPTR (gst_rist_dispatcher_request_new_pad);
+  element_class->release_pad =
+      GST_DEBUG_FUNCPTR (gst_rist_dispatcher_release_pad);
+
+  object_class->finalize = gst_rist_dispatcher_finalize;
+  object_class->get_property = gst_rist_dispatcher_get_property;
+  object_class->set_property = gst_rist_dispatcher_set_property;
+
+  g_object_class_install_property (object_class, PROP_MIN_WEIGHT,
+      g_param_spec_double ("min-weight", "Minimum Weight",
+          "Minimum share of the traffic sent on each link, so that degraded "
+          "links keep being probed", 0.0, 1.0, DEFAULT_MIN_WEIGHT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_PLAYING));
+
+  g_object_class_install_property (object_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Statistic in a GstStructure named 'rist/x-dispatcher-stats'",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRistDispatcher::update-link:
+   * @disp: the #GstRistDispatcher
+   * @link: the link id, as in the src_%u pad name
+   * @rtt: the last measured round trip time in nanoseconds, or 0 if unknown
+   *
+   * Feeds back the latest round trip time of @link and closes its current
+   * measurement window, which updates its loss and throughput estimates and
+   * recomputes the weights of all links. This is meant to be called for
+   * every RTCP receiver report.
+   */
+  gst_rist_dispatcher_signals[SIGNAL_UPDATE_LINK] =
+      g_signal_new_class_handler ("update-link", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+      G_CALLBACK (gst_rist_dispatcher_update_link), NULL, NULL, NULL,
+      G_TYPE_NONE, 2, G_TYPE_UINT, G_TYPE_UINT64);
+
+  /**
+   * GstRistDispatcher::report-lost:
+   * @disp: the #GstRistDispatcher
+   * @seqnum: the RTP sequence number of a lost packet
+   *
+   * Accounts a lost packet to the link that carried @seqnum.
+   */
+  gst_rist_dispatcher_signals[SIGNAL_REPORT_LOST] =
+      g_signal_new_class_handler ("report-lost", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+      G_CALLBACK (gst_rist_dispatcher_report_lost), NULL, NULL, NULL,
+      G_TYPE_NONE, 1, G_TYPE_UINT);
+}
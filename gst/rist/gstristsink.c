@@ -51,13 +51,18 @@
  * mapped to its own RTP session. RTX request are only replied to on the
  * link the NACK was received from.
  *
- * There are currently two bonding methods in place: "broadcast" and "round-robin".
+ * There are currently three bonding methods in place: "broadcast",
+ * "round-robin" and "weighted".
  * In "broadcast" mode, all the packets are duplicated over all sessions.
- * While in "round-robin" mode, packets are evenly distributed over the links. One
- * can also implement its own dispatcher element and configure it using the
- * "dispatcher" property. As a reference, "broadcast" mode is implemented with
- * the "tee" element, while "round-robin" mode is implemented with the
- * "round-robin" element.
+ * While in "round-robin" mode, packets are evenly distributed over the links.
+ * In "weighted" mode, each link gets a share of the packets that depends on
+ * its round trip time and on the losses reported by the receiver, so that
+ * traffic moves away from slow or degrading links. The per link measurements
+ * are added to the session statistics. One can also implement its own
+ * dispatcher element and configure it using the "dispatcher" property. As a
+ * reference, "broadcast" mode is implemented with the "tee" element,
+ * "round-robin" mode with the "roundrobin" element and "weighted" mode with
+ * the "ristdispatcher" element.
  *
  * ## Example gst-launch line for bonding
  * |[
@@ -101,13 +106,16 @@ enum
   PROP_BONDING_METHOD,
   PROP_DISPATCHER,
   PROP_DROP_NULL_TS_PACKETS,
-  PROP_SEQUENCE_NUMBER_EXTENSION
+  PROP_SEQUENCE_NUMBER_EXTENSION,
+  PROP_BATCH_SIZE,
+  PROP_BATCH_LATENCY
 };
 
 typedef enum
 {
   GST_RIST_BONDING_METHOD_BROADCAST,
   GST_RIST_BONDING_METHOD_ROUND_ROBIN,
+  GST_RIST_BONDING_METHOD_WEIGHTED,
 } GstRistBondingMethod;
 
 static GstStaticPadTemplate sink_templ = GST_STATIC_PAD_TEMPLATE ("sink",
@@ -126,6 +134,7 @@ typedef struct
   GstElement *rtcp_sink;
   GstElement *rtx_send;
   GstElement *rtx_queue;
+  GstElement *rtp_batch;
   guint32 rtcp_ssrc;
 } RistSenderBond;
 
@@ -147,6 +156,8 @@ struct _GstRistSink
   GstClockTime min_rtcp_interval;
   gdouble max_rtcp_bandwidth;
   GstRistBondingMethod bonding_method;
+  guint batch_size;
+  GstClockTime batch_latency;
 
   /* Bonds */
   GPtrArray *bonds;
@@ -175,6 +186,8 @@ gst_rist_bonding_method_get_type (void)
         "GST_RIST_BONDING_METHOD_BROADCAST", "broadcast"},
     {GST_RIST_BONDING_METHOD_ROUND_ROBIN,
         "GST_RIST_BONDING_METHOD_ROUND_ROBIN", "round-robin"},
+    {GST_RIST_BONDING_METHOD_WEIGHTED,
+        "GST_RIST_BONDING_METHOD_WEIGHTED", "weighted"},
     {0, NULL, NULL}
   };
 
@@ -707,6 +720,149 @@ dns_resolve_failed:
   return GST_STATE_CHANGE_FAILURE;
 }
 
+/* Places an rtpbatch in front of the bond's RTP udpsink, so that packets are
+ * sent as buffer lists with one sendmmsg() call per list */
+static void
+gst_rist_sink_setup_batching (GstRistSink * sink, RistSenderBond * bond)
+{
+  GstPad *sinkpad, *peer, *pad;
+  gchar name[32];
+
+  if (sink->batch_size <= 1 || bond->rtp_batch)
+    return;
+
+  g_snprintf (name, 32, "rist_rtp_batch%u", bond->session);
+  bond->rtp_batch = gst_element_factory_make ("rtpbatch", name);
+  if (!bond->rtp_batch) {
+    GST_WARNING_OBJECT (sink, "rtpbatch from the 'rtpmanagerbad' plugin is "
+        "not available, sending unbatched");
+    return;
+  }
+
+  g_object_set (bond->rtp_batch, "max-packets", sink->batch_size,
+      "max-latency", sink->batch_latency, NULL);
+  gst_bin_add (GST_BIN (sink), bond->rtp_batch);
+
+  sinkpad = gst_element_get_static_pad (bond->rtp_sink, "sink");
+  peer = gst_pad_get_peer (sinkpad);
+  gst_pad_unlink (peer, sinkpad);
+
+  pad = gst_element_get_static_pad (bond->rtp_batch, "sink");
+  gst_pad_link (peer, pad);
+  gst_object_unref (pad);
+  pad = gst_element_get_static_pad (bond->rtp_batch, "src");
+  gst_pad_link (pad, sinkpad);
+  gst_object_unref (pad);
+
+  gst_object_unref (peer);
+  gst_object_unref (sinkpad);
+
+  gst_element_sync_state_with_parent (bond->rtp_batch);
+}
+
+/* Accounts the NACKed packets to the link that carried them, the NACKs
+ * themselves may arrive on any link */
+static void
+gst_rist_sink_on_link_feedback (GObject * session, GstBuffer * buffer,
+    GstRistSink * sink)
+{
+  GstRTCPBuffer rtcp = GST_RTCP_BUFFER_INIT;
+  GstRTCPPacket packet;
+  gboolean more;
+
+  if (!gst_rtcp_buffer_map (buffer, GST_MAP_READ, &rtcp))
+    return;
+
+  for (more = gst_rtcp_buffer_get_first_packet (&rtcp, &packet); more;
+      more = gst_rtcp_packet_move_to_next (&packet)) {
+    guint8 *data;
+    guint len, i;
+
+    switch (gst_rtcp_packet_get_type (&packet)) {
+      case GST_RTCP_TYPE_RTPFB:
+        if (gst_rtcp_packet_fb_get_type (&packet) != GST_RTCP_RTPFB_TYPE_NACK)
+          break;
+
+        data = gst_rtcp_packet_fb_get_fci (&packet);
+        len = gst_rtcp_packet_fb_get_fci_length (&packet);
+
+        /* each FCI is a seqnum and a bitmask of the 16 following ones */
+        for (i = 0; i < len; i++, data += 4) {
+          guint16 seqnum = GST_READ_UINT16_BE (data);
+          guint16 blp = GST_READ_UINT16_BE (data + 2);
+          guint j;
+
+          g_signal_emit_by_name (sink->dispatcher, "report-lost",
+              (guint) seqnum);
+          for (j = 0; j < 16; j++)
+            if (blp & (1 << j))
+              g_signal_emit_by_name (sink->dispatcher, "report-lost",
+                  (guint) (guint16) (seqnum + j + 1));
+        }
+        break;
+      case GST_RTCP_TYPE_APP:
+        if (memcmp (gst_rtcp_packet_app_get_name (&packet), "RIST", 4) != 0 ||
+            gst_rtcp_packet_app_get_subtype (&packet) != 0)
+          break;
+
+        data = gst_rtcp_packet_app_get_data (&packet);
+        len = gst_rtcp_packet_app_get_data_length (&packet);
+
+        /* range NACKs, the count is inclusive as in on_app_rtcp() */
+        for (i = 0; i < len; i++, data += 4) {
+          guint16 seqnum = GST_READ_UINT16_BE (data);
+          guint16 num = GST_READ_UINT16_BE (data + 2);
+          guint j;
+
+          for (j = 0; j <= num; j++)
+            g_signal_emit_by_name (sink->dispatcher, "report-lost",
+                (guint) (guint16) (seqnum + j));
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  gst_rtcp_buffer_unmap (&rtcp);
+}
+
+/* Called for every RTCP packet received, feeds the round trip time reported
+ * by the receiver on that link to the weighted dispatcher */
+static void
+gst_rist_sink_on_ssrc_active (GstRistSink * sink, guint session_id,
+    guint ssrc, GstElement * rtpbin)
+{
+  GObject *session = NULL, *source = NULL;
+  GstStructure *sstats = NULL;
+  gboolean internal = TRUE, have_rb = FALSE;
+  guint rb_rtt = 0;
+
+  g_signal_emit_by_name (rtpbin, "get-internal-session", session_id, &session);
+  if (!session)
+    return;
+
+  g_signal_emit_by_name (session, "get-source-by-ssrc", ssrc, &source);
+  g_object_unref (session);
+  if (!source)
+    return;
+
+  g_object_get (source, "stats", &sstats, NULL);
+  g_object_unref (source);
+
+  gst_structure_get_boolean (sstats, "internal", &internal);
+  gst_structure_get_boolean (sstats, "have-rb", &have_rb);
+  gst_structure_get_uint (sstats, "rb-round-trip", &rb_rtt);
+  gst_structure_free (sstats);
+
+  if (internal || !have_rb)
+    return;
+
+  /* rb_rtt is in Q16 in NTP time */
+  g_signal_emit_by_name (sink->dispatcher, "update-link", session_id,
+      gst_util_uint64_scale (rb_rtt, GST_SECOND, 65536));
+}
+
 static GstStateChangeReturn
 gst_rist_sink_start (GstRistSink * sink)
 {
@@ -729,6 +885,11 @@ gst_rist_sink_start (GstRistSink * sink)
             "rist_dispatcher");
         g_assert (sink->dispatcher);
         break;
+      case GST_RIST_BONDING_METHOD_WEIGHTED:
+        sink->dispatcher = gst_element_factory_make ("ristdispatcher",
+            "rist_dispatcher");
+        g_assert (sink->dispatcher);
+        break;
     }
   }
 
@@ -748,6 +909,10 @@ gst_rist_sink_start (GstRistSink * sink)
   gst_bin_add (GST_BIN (sink->rtxbin), sink->dispatcher);
   gst_element_link (sink->rtpext, sink->dispatcher);
 
+  if (GST_IS_RIST_DISPATCHER (sink->dispatcher))
+    g_signal_connect_swapped (sink->rtpbin, "on-ssrc-active",
+        G_CALLBACK (gst_rist_sink_on_ssrc_active), sink);
+
   for (i = 0; i < sink->bonds->len; i++) {
     RistSenderBond *bond = g_ptr_array_index (sink->bonds, i);
     GObject *session = NULL;
@@ -759,6 +924,15 @@ gst_rist_sink_start (GstRistSink * sink)
         "rtcp-fraction", sink->max_rtcp_bandwidth, NULL);
     g_object_unref (session);
 
+    if (GST_IS_RIST_DISPATCHER (sink->dispatcher)) {
+      g_signal_emit_by_name (sink->rtpbin, "get-internal-session", i,
+          &session);
+      g_object_set_qdata (session, session_id_quark, GUINT_TO_POINTER (i));
+      g_signal_connect (session, "on-receiving-rtcp",
+          (GCallback) gst_rist_sink_on_link_feedback, sink);
+      g_object_unref (session);
+    }
+
     g_snprintf (name, 32, "src_%u", bond->session);
     pad = gst_element_get_request_pad (sink->dispatcher, name);
     gst_element_link_pads (sink->dispatcher, name, bond->rtx_queue, "sink");
@@ -766,24 +940,61 @@ gst_rist_sink_start (GstRistSink * sink)
 
     if (!gst_rist_sink_setup_rtcp_socket (sink, bond))
       return GST_STATE_CHANGE_FAILURE;
+
+    gst_rist_sink_setup_batching (sink, bond);
   }
 
   return GST_STATE_CHANGE_SUCCESS;
 }
 
 
+static void
+gst_rist_sink_add_link_stats (GstStructure * stats, GValueArray * link_stats,
+    guint link_id)
+{
+  guint i;
+
+  for (i = 0; i < link_stats->n_values; i++) {
+    const GstStructure *s =
+        g_value_get_boxed (g_value_array_get_nth (link_stats, i));
+    guint id;
+
+    if (!gst_structure_get_uint (s, "link-id", &id) || id != link_id)
+      continue;
+
+    gst_structure_set_value (stats, "weight",
+        gst_structure_get_value (s, "weight"));
+    gst_structure_set_value (stats, "loss-fraction",
+        gst_structure_get_value (s, "loss-fraction"));
+    gst_structure_set_value (stats, "throughput",
+        gst_structure_get_value (s, "throughput"));
+    gst_structure_set_value (stats, "lost-packets",
+        gst_structure_get_value (s, "lost-packets"));
+    break;
+  }
+}
+
 static GstStructure *
 gst_rist_sink_create_stats (GstRistSink * sink)
 {
   RistSenderBond *bond;
   GstStructure *ret;
-  GValueArray *session_stats;
+  GValueArray *session_stats, *link_stats = NULL;
   guint64 total_pkt_sent = 0, total_rtx_sent = 0;
   gint i;
 
   ret = gst_structure_new_empty ("rist/x-sender-stats");
   session_stats = g_value_array_new (sink->bonds->len);
 
+  if (sink->dispatcher && GST_IS_RIST_DISPATCHER (sink->dispatcher)) {
+    GstStructure *dstats;
+
+    g_object_get (sink->dispatcher, "stats", &dstats, NULL);
+    link_stats = g_value_array_copy (g_value_get_boxed (gst_structure_get_value
+            (dstats, "link-stats")));
+    gst_structure_free (dstats);
+  }
+
   for (i = 0; i < sink->bonds->len; i++) {
     GObject *session = NULL, *source = NULL;
     GstStructure *sstats = NULL, *stats;
@@ -827,6 +1038,9 @@ gst_rist_sink_create_stats (GstRistSink * sink)
         "sent-retransmitted-packets", G_TYPE_UINT64, rtx_sent,
         "round-trip-time", G_TYPE_UINT64, rtt, NULL);
 
+    if (link_stats)
+      gst_rist_sink_add_link_stats (stats, link_stats, bond->session);
+
     g_value_init (&value, GST_TYPE_STRUCTURE);
     g_value_take_boxed (&value, stats);
     g_value_array_append (session_stats, &value);
@@ -841,6 +1055,8 @@ gst_rist_sink_create_stats (GstRistSink * sink)
       "sent-retransmitted-packets", G_TYPE_UINT64, total_rtx_sent,
       "session-stats", G_TYPE_VALUE_ARRAY, session_stats, NULL);
   g_value_array_free (session_stats);
+  if (link_stats)
+    g_value_array_free (link_stats);
 
   return ret;
 }
@@ -1167,6 +1383,14 @@ gst_rist_sink_get_property (GObject * object, guint prop_id,
           "sequence-number-extension", value);
       break;
 
+    case PROP_BATCH_SIZE:
+      g_value_set_uint (value, sink->batch_size);
+      break;
+
+    case PROP_BATCH_LATENCY:
+      g_value_set_uint64 (value, sink->batch_latency);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1280,6 +1504,14 @@ gst_rist_sink_set_property (GObject * object, guint prop_id,
           "sequence-number-extension", value);
       break;
 
+    case PROP_BATCH_SIZE:
+      sink->batch_size = g_value_get_uint (value);
+      break;
+
+    case PROP_BATCH_LATENCY:
+      sink->batch_latency = g_value_get_uint64 (value);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1423,5 +1655,35 @@ gst_rist_sink_class_init (GstRistSinkClass * klass)
           "Add sequence number extension to packets.", FALSE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT));
 
+  /**
+   * GstRistSink:batch-size:
+   *
+   * Maximum number of RTP packets sent with one sendmmsg() system call on
+   * each bond. Values larger than 1 require the rtpbatch element.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (object_class, PROP_BATCH_SIZE,
+      g_param_spec_uint ("batch-size", "Batch size",
+          "Maximum number of RTP packets sent with one system call "
+          "(1 = no batching)", 1, 1024, 1,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstRistSink:batch-latency:
+   *
+   * Maximum time in nanoseconds an RTP packet is held back waiting for its
+   * batch to fill up.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (object_class, PROP_BATCH_LATENCY,
+      g_param_spec_uint64 ("batch-latency", "Batch latency",
+          "Maximum time in nanoseconds a packet waits for its batch to fill",
+          0, G_MAXUINT64, GST_MSECOND,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT |
+          GST_PARAM_MUTABLE_READY));
+
   gst_type_mark_as_plugin_api (gst_rist_bonding_method_get_type (), 0);
 }
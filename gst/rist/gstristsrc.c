@@ -47,6 +47,14 @@
  * support, one need to configure the list of addresses through
  * "bonding-addresses" properties.
  *
+ * When the same packets are received over several links, duplicates are
+ * dropped before reaching the jitterbuffer. Retransmission requests are only
+ * sent over the link that answered previous requests best, moving to the
+ * next best link when the request has to be repeated. The state for this
+ * is kept for the 16 most recently received SSRCs, and forgotten when their
+ * sender leaves or times out. The per link statistics are part of the
+ * "stats" property.
+ *
  * ## Example gst-launch line for bonding
  * |[
  * gst-launch-1.0 ristsrc bonding-addresses="10.0.0.1:5004,11.0.0.1:5006" ! rtpmp2tdepay ! udpsink
@@ -65,8 +73,9 @@
 #include <gst/net/net.h>
 #include <gst/rtp/rtp.h>
 
-/* for strtol() */
+/* for strtol() and qsort() */
 #include <stdlib.h>
+#include <string.h>
 
 #ifdef HAVE_SYS_SOCKET_H
 #include <sys/socket.h>
@@ -92,7 +101,8 @@ enum
   PROP_MULTICAST_LOOPBACK,
   PROP_MULTICAST_IFACE,
   PROP_MULTICAST_TTL,
-  PROP_BONDING_ADDRESSES
+  PROP_BONDING_ADDRESSES,
+  PROP_BATCH_SIZE
 };
 
 static GstStaticPadTemplate src_templ = GST_STATIC_PAD_TEMPLATE ("src",
@@ -100,9 +110,48 @@ static GstStaticPadTemplate src_templ = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("application/x-rtp"));
 
+/* Number of sequence numbers tracked for duplicate suppression and for
+ * matching retransmissions with their request, a power of 2 */
+#define LINK_WINDOW_SIZE 4096
+
+/* A link that did not receive anything for that long is not asked for
+ * retransmissions */
+#define LINK_TIMEOUT GST_SECOND
+
+/* The retransmission success counters are halved past that many requests
+ * so that they follow the current link conditions */
+#define LINK_RTX_HISTORY 64
+
+/* Number of SSRCs tracked at once, a window takes about 100 KB. Any packet
+ * that reaches the sockets gets one, so past that many the least recently
+ * used window is dropped */
+#define LINK_MAX_SSRCS 16
+
+typedef struct _RistReceiverBond RistReceiverBond;
+
+typedef struct
+{
+  RistReceiverBond *bond;
+  guint16 seqnum;
+  GstClockTime time;
+} RistNackRecord;
 
+/* Per SSRC state, retransmission requests are matched on SSRC and seqnum as
+ * several streams can use the same sequence numbers */
 typedef struct
 {
+  guint32 extseqnum;
+  guint32 max_extseqnum;
+  gboolean have_max;
+  guint64 seen[LINK_WINDOW_SIZE / 64];
+  RistNackRecord nacks[LINK_WINDOW_SIZE];
+  /* value of the use counter when last used */
+  guint64 last_use;
+} RistSsrcWindow;
+
+struct _RistReceiverBond
+{
+  GstRistSrc *src;
   guint session;
   gchar *address;
   gchar *multicast_iface;
@@ -110,13 +159,32 @@ typedef struct
 
   GstElement *rtcp_src;
   GstElement *rtp_src;
+  GstElement *rtp_batch_src;
   GstElement *rtcp_sink;
   GstElement *rtx_receive;
   gulong rtcp_recv_probe;
   gulong rtcp_send_probe;
   GSocketAddress *rtcp_send_addr;
 
-} RistReceiverBond;
+  /* Link statistics, protected by links_lock */
+  guint64 packets;
+  guint64 bytes;
+  guint64 duplicates;
+  guint64 rtx_requests;
+  guint64 recovered;
+  guint rtx_window_requests;
+  guint rtx_window_answers;
+  GstClockTime rtt;
+  GstClockTime last_arrival;
+  guint64 stats_bytes;
+  GstClockTime stats_time;
+};
+
+typedef struct
+{
+  gdouble score;
+  RistReceiverBond *bond;
+} RistLinkCandidate;
 
 struct _GstRistSrc
 {
@@ -138,6 +206,7 @@ struct _GstRistSrc
   gdouble max_rtcp_bandwidth;
   gint multicast_loopback;
   gint multicast_ttl;
+  guint batch_size;
 
   /* Bonds */
   GPtrArray *bonds;
@@ -152,6 +221,17 @@ struct _GstRistSrc
   GstClockID stats_cid;
   GstElement *jitterbuffer;
 
+  /* Duplicate suppression and retransmission routing across bonds */
+  GMutex links_lock;
+  GHashTable *ssrc_windows;
+  guint64 window_uses;
+  guint64 duplicates;
+  /* The same retransmission request is offered to every bond in turn */
+  guint32 routed_ssrc;
+  guint routed_seqnum;
+  guint routed_retry;
+  RistReceiverBond *routed_bond;
+
   /* This is set whenever there is a pipeline construction failure, and used
    * to fail state changes later */
   gboolean construct_failed;
@@ -164,6 +244,327 @@ G_DEFINE_TYPE_WITH_CODE (GstRistSrc, gst_rist_src, GST_TYPE_BIN,
     G_IMPLEMENT_INTERFACE (GST_TYPE_URI_HANDLER, gst_rist_src_uri_init);
     GST_DEBUG_CATEGORY_INIT (gst_rist_src_debug, "ristsrc", 0, "RIST Source"));
 
+/* called with links lock */
+static RistSsrcWindow *
+gst_rist_src_get_ssrc_window (GstRistSrc * src, guint32 ssrc)
+{
+  RistSsrcWindow *window;
+
+  window = g_hash_table_lookup (src->ssrc_windows, GUINT_TO_POINTER (ssrc));
+  if (!window) {
+    if (g_hash_table_size (src->ssrc_windows) >= LINK_MAX_SSRCS) {
+      GHashTableIter iter;
+      gpointer key, value, oldest_key = NULL;
+      guint64 oldest_use = G_MAXUINT64;
+
+      g_hash_table_iter_init (&iter, src->ssrc_windows);
+      while (g_hash_table_iter_next (&iter, &key, &value)) {
+        RistSsrcWindow *w = value;
+
+        if (w->last_use < oldest_use) {
+          oldest_use = w->last_use;
+          oldest_key = key;
+        }
+      }
+
+      GST_DEBUG_OBJECT (src, "Forgetting SSRC %u to track SSRC %u",
+          GPOINTER_TO_UINT (oldest_key), ssrc);
+      g_hash_table_remove (src->ssrc_windows, oldest_key);
+    }
+
+    window = g_slice_new0 (RistSsrcWindow);
+    window->extseqnum = -1;
+    g_hash_table_insert (src->ssrc_windows, GUINT_TO_POINTER (ssrc), window);
+  }
+
+  window->last_use = ++src->window_uses;
+
+  return window;
+}
+
+/* called with links lock, returns TRUE if the packet was already received */
+static gboolean
+gst_rist_src_dedup (RistSsrcWindow * window, guint16 seqnum)
+{
+  guint32 extseqnum;
+  guint idx;
+  guint64 bit;
+
+  extseqnum = gst_rist_rtp_ext_seq (&window->extseqnum, seqnum);
+
+  if (!window->have_max) {
+    window->max_extseqnum = extseqnum;
+    window->have_max = TRUE;
+  } else if (extseqnum > window->max_extseqnum) {
+    guint32 i;
+
+    /* forget the sequence numbers leaving the window */
+    if (extseqnum - window->max_extseqnum >= LINK_WINDOW_SIZE) {
+      memset (window->seen, 0, sizeof (window->seen));
+    } else {
+      for (i = window->max_extseqnum + 1; i <= extseqnum; i++) {
+        idx = i % LINK_WINDOW_SIZE;
+        window->seen[idx / 64] &= ~(G_GUINT64_CONSTANT (1) << (idx % 64));
+      }
+    }
+    window->max_extseqnum = extseqnum;
+  } else if (window->max_extseqnum - extseqnum >= LINK_WINDOW_SIZE) {
+    /* too old to tell, the jitterbuffer will drop it anyway */
+    return FALSE;
+  }
+
+  idx = extseqnum % LINK_WINDOW_SIZE;
+  bit = G_GUINT64_CONSTANT (1) << (idx % 64);
+  if (window->seen[idx / 64] & bit)
+    return TRUE;
+
+  window->seen[idx / 64] |= bit;
+  return FALSE;
+}
+
+/* Accounts a packet received on @bond, returns FALSE if it must be dropped
+ * as it was already received on another link, or as a retransmission */
+static gboolean
+gst_rist_src_link_receive (GstRistSrc * src, RistReceiverBond * bond,
+    GstBuffer * buffer, GstClockTime now)
+{
+  RistSsrcWindow *window;
+  guint8 header[12];
+  guint32 ssrc;
+  guint16 seqnum;
+  gboolean duplicate;
+
+  if (gst_buffer_extract (buffer, 0, header, 12) != 12)
+    return TRUE;
+
+  seqnum = GST_READ_UINT16_BE (header + 2);
+  ssrc = GST_READ_UINT32_BE (header + 8);
+
+  g_mutex_lock (&src->links_lock);
+  bond->packets++;
+  bond->bytes += gst_buffer_get_size (buffer);
+  bond->last_arrival = now;
+
+  window = gst_rist_src_get_ssrc_window (src, ssrc);
+
+  /* A retransmission answers its request even if the original packet made
+   * it through another link in the meantime, so match it before dropping
+   * duplicates */
+  if (GST_BUFFER_FLAG_IS_SET (buffer, GST_RTP_BUFFER_FLAG_RETRANSMISSION)) {
+    RistNackRecord *nack = &window->nacks[seqnum % LINK_WINDOW_SIZE];
+
+    /* the retransmission is sent back on the link that was asked */
+    if (nack->bond && nack->seqnum == seqnum) {
+      GstClockTime rtt = now - nack->time;
+
+      nack->bond->rtx_window_answers++;
+      if (GST_CLOCK_TIME_IS_VALID (nack->bond->rtt))
+        nack->bond->rtt = (3 * nack->bond->rtt + rtt) / 4;
+      else
+        nack->bond->rtt = rtt;
+      nack->bond = NULL;
+    }
+  }
+
+  duplicate = gst_rist_src_dedup (window, seqnum);
+  if (duplicate) {
+    bond->duplicates++;
+    src->duplicates++;
+  } else if (GST_BUFFER_FLAG_IS_SET (buffer,
+          GST_RTP_BUFFER_FLAG_RETRANSMISSION)) {
+    bond->recovered++;
+  }
+  g_mutex_unlock (&src->links_lock);
+
+  if (duplicate)
+    GST_LOG_OBJECT (src, "Dropping duplicate seqnum %u ssrc %u on session %u",
+        seqnum, ssrc, bond->session);
+
+  return !duplicate;
+}
+
+static gint
+gst_rist_src_compare_link_score (gconstpointer a, gconstpointer b)
+{
+  const RistLinkCandidate *ca = a, *cb = b;
+
+  /* best first */
+  if (ca->score > cb->score)
+    return -1;
+  if (ca->score < cb->score)
+    return 1;
+  return 0;
+}
+
+/* called with links lock. Picks the bond most likely to deliver a
+ * retransmission, or the next ones when the request is retried. Returns NULL
+ * if no bond is alive, in which case every bond is asked */
+static RistReceiverBond *
+gst_rist_src_pick_nack_bond (GstRistSrc * src, guint retry, GstClockTime now)
+{
+  RistLinkCandidate *candidates;
+  guint i, n = 0;
+  RistReceiverBond *ret = NULL;
+
+  candidates = g_newa (RistLinkCandidate, src->bonds->len);
+
+  for (i = 0; i < src->bonds->len; i++) {
+    RistReceiverBond *bond = g_ptr_array_index (src->bonds, i);
+    gdouble success, rtt_ms;
+
+    if (!GST_CLOCK_TIME_IS_VALID (bond->last_arrival) ||
+        now - bond->last_arrival > LINK_TIMEOUT)
+      continue;
+
+    success = (bond->rtx_window_answers + 1.0) /
+        (bond->rtx_window_requests + 1.0);
+    rtt_ms = GST_CLOCK_TIME_IS_VALID (bond->rtt) ?
+        (gdouble) bond->rtt / GST_MSECOND : 0.0;
+
+    candidates[n].score = success / (1.0 + rtt_ms);
+    candidates[n].bond = bond;
+    n++;
+  }
+
+  if (n > 0) {
+    qsort (candidates, n, sizeof (*candidates),
+        gst_rist_src_compare_link_score);
+    ret = candidates[retry % n].bond;
+  }
+
+  return ret;
+}
+
+static GstPadProbeReturn
+gst_rist_src_on_rtx_request (GstRistSrc * src, RistReceiverBond * bond,
+    GstEvent * event)
+{
+  const GstStructure *s = gst_event_get_structure (event);
+  RistReceiverBond *routed;
+  guint seqnum = 0, ssrc = 0, retry = 0;
+
+  if (!gst_structure_get_uint (s, "seqnum", &seqnum) ||
+      !gst_structure_get_uint (s, "ssrc", &ssrc))
+    return GST_PAD_PROBE_OK;
+  gst_structure_get_uint (s, "retry", &retry);
+
+  g_mutex_lock (&src->links_lock);
+  if (src->routed_ssrc != ssrc || src->routed_seqnum != seqnum ||
+      src->routed_retry != retry) {
+    GstClockTime now = gst_util_get_timestamp ();
+    RistReceiverBond *picked = gst_rist_src_pick_nack_bond (src, retry, now);
+
+    src->routed_ssrc = ssrc;
+    src->routed_seqnum = seqnum;
+    src->routed_retry = retry;
+    src->routed_bond = picked;
+
+    if (picked) {
+      RistSsrcWindow *window = gst_rist_src_get_ssrc_window (src, ssrc);
+      RistNackRecord *nack = &window->nacks[seqnum % LINK_WINDOW_SIZE];
+
+      nack->bond = picked;
+      nack->seqnum = seqnum;
+      nack->time = now;
+
+      picked->rtx_requests++;
+      if (++picked->rtx_window_requests > LINK_RTX_HISTORY) {
+        picked->rtx_window_requests /= 2;
+        picked->rtx_window_answers /= 2;
+      }
+
+      GST_LOG_OBJECT (src, "Routing retransmission request for seqnum %u "
+          "(retry %u) to session %u", seqnum, retry, picked->session);
+    }
+  }
+  routed = src->routed_bond;
+  g_mutex_unlock (&src->links_lock);
+
+  if (routed && routed != bond)
+    return GST_PAD_PROBE_DROP;
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+gst_rist_src_link_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  RistReceiverBond *bond = user_data;
+  GstRistSrc *src = bond->src;
+  GstClockTime now;
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_EVENT_UPSTREAM) {
+    GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+
+    if (GST_EVENT_TYPE (event) == GST_EVENT_CUSTOM_UPSTREAM &&
+        gst_event_has_name (event, "GstRTPRetransmissionRequest"))
+      return gst_rist_src_on_rtx_request (src, bond, event);
+
+    return GST_PAD_PROBE_OK;
+  }
+
+  now = gst_util_get_timestamp ();
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER) {
+    if (!gst_rist_src_link_receive (src, bond, GST_PAD_PROBE_INFO_BUFFER (info),
+            now))
+      return GST_PAD_PROBE_DROP;
+  } else if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+    GstBufferList *list = GST_PAD_PROBE_INFO_BUFFER_LIST (info);
+    guint i = 0;
+
+    while (i < gst_buffer_list_length (list)) {
+      if (gst_rist_src_link_receive (src, bond,
+              gst_buffer_list_get (list, i), now)) {
+        i++;
+        continue;
+      }
+
+      list = gst_buffer_list_make_writable (list);
+      gst_buffer_list_remove (list, i, 1);
+    }
+
+    info->data = list;
+    if (gst_buffer_list_length (list) == 0)
+      return GST_PAD_PROBE_DROP;
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+gst_rist_src_reset_links (GstRistSrc * src)
+{
+  gint i;
+
+  g_mutex_lock (&src->links_lock);
+  for (i = 0; i < src->bonds->len; i++) {
+    RistReceiverBond *bond = g_ptr_array_index (src->bonds, i);
+
+    bond->packets = bond->bytes = bond->duplicates = 0;
+    bond->rtx_requests = bond->recovered = 0;
+    bond->rtx_window_requests = bond->rtx_window_answers = 0;
+    bond->rtt = GST_CLOCK_TIME_NONE;
+    bond->last_arrival = GST_CLOCK_TIME_NONE;
+    bond->stats_bytes = 0;
+    bond->stats_time = GST_CLOCK_TIME_NONE;
+  }
+
+  g_hash_table_remove_all (src->ssrc_windows);
+  src->window_uses = 0;
+  src->duplicates = 0;
+  src->routed_bond = NULL;
+  src->routed_seqnum = G_MAXUINT;
+  g_mutex_unlock (&src->links_lock);
+}
+
+static void
+gst_rist_src_free_ssrc_window (gpointer data)
+{
+  g_slice_free (RistSsrcWindow, data);
+}
+
 /* called with bonds lock */
 static RistReceiverBond *
 gst_rist_src_add_bond (GstRistSrc * src)
@@ -172,8 +573,12 @@ gst_rist_src_add_bond (GstRistSrc * src)
   GstPad *pad, *gpad;
   gchar name[32];
 
+  bond->src = src;
   bond->session = src->bonds->len;
   bond->address = g_strdup ("0.0.0.0");
+  bond->rtt = GST_CLOCK_TIME_NONE;
+  bond->last_arrival = GST_CLOCK_TIME_NONE;
+  bond->stats_time = GST_CLOCK_TIME_NONE;
 
   g_snprintf (name, 32, "rist_rtx_receive%u", bond->session);
   bond->rtx_receive = gst_element_factory_make ("ristrtxreceive", name);
@@ -182,6 +587,12 @@ gst_rist_src_add_bond (GstRistSrc * src)
   g_snprintf (name, 32, "sink_%u", bond->session);
   gst_element_link_pads (bond->rtx_receive, "src", src->rtx_funnel, name);
 
+  pad = gst_element_get_static_pad (bond->rtx_receive, "src");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+      GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_EVENT_UPSTREAM,
+      gst_rist_src_link_probe, bond, NULL);
+  gst_object_unref (pad);
+
   g_snprintf (name, 32, "sink_%u", bond->session);
   pad = gst_element_get_static_pad (bond->rtx_receive, "sink");
   gpad = gst_ghost_pad_new (name, pad);
@@ -373,6 +784,16 @@ gst_rist_src_on_new_ssrc (GstRistSrc * src, guint session_id, guint ssrc,
   g_object_unref (session);
 }
 
+/* The sender of @ssrc left or timed out on one of the links */
+static void
+gst_rist_src_on_ssrc_gone (GstRistSrc * src, guint session_id, guint ssrc,
+    GstElement * rtpbin)
+{
+  g_mutex_lock (&src->links_lock);
+  g_hash_table_remove (src->ssrc_windows, GUINT_TO_POINTER (ssrc));
+  g_mutex_unlock (&src->links_lock);
+}
+
 static void
 gst_rist_src_new_jitterbuffer (GstRistSrc * src, GstElement * jitterbuffer,
     guint session, guint ssrc, GstElement * rtpbin)
@@ -405,6 +826,11 @@ gst_rist_src_init (GstRistSrc * src)
   g_mutex_init (&src->bonds_lock);
   src->bonds = g_ptr_array_new ();
 
+  g_mutex_init (&src->links_lock);
+  src->ssrc_windows = g_hash_table_new_full (NULL, NULL, NULL,
+      gst_rist_src_free_ssrc_window);
+  src->routed_seqnum = G_MAXUINT;
+
   /* Construct the RIST RTP receiver pipeline.
    *
    * udpsrc -> [recv_rtp_sink_%u]  --------  [recv_rtp_src_%u_%u_%u]
@@ -458,6 +884,10 @@ gst_rist_src_init (GstRistSrc * src)
       G_CALLBACK (gst_rist_src_pad_added), src);
   g_signal_connect_swapped (src->rtpbin, "on-new-ssrc",
       G_CALLBACK (gst_rist_src_on_new_ssrc), src);
+  g_signal_connect_swapped (src->rtpbin, "on-bye-ssrc",
+      G_CALLBACK (gst_rist_src_on_ssrc_gone), src);
+  g_signal_connect_swapped (src->rtpbin, "on-timeout",
+      G_CALLBACK (gst_rist_src_on_ssrc_gone), src);
   g_signal_connect_swapped (src->rtpbin, "new-jitterbuffer",
       G_CALLBACK (gst_rist_src_new_jitterbuffer), src);
 
@@ -638,6 +1068,80 @@ gst_rist_src_setup_rtcp_socket (GstRistSrc * src, RistReceiverBond * bond)
   return GST_STATE_CHANGE_SUCCESS;
 }
 
+/* Replaces the bond's RTP udpsrc by an rtpbatchsrc reading the same socket
+ * with recvmmsg(). The udpsrc stays in READY to keep the socket bound. */
+static void
+gst_rist_src_setup_batching (GstRistSrc * src, RistReceiverBond * bond)
+{
+  GSocket *socket = NULL;
+  GstCaps *caps = NULL;
+  GstPad *pad, *peer;
+  gchar name[32];
+
+  if (src->batch_size <= 1)
+    return;
+
+  g_object_get (bond->rtp_src, "used-socket", &socket, "caps", &caps, NULL);
+  if (!socket)
+    goto done;
+
+  g_snprintf (name, 32, "rist_rtp_batchsrc%u", bond->session);
+  bond->rtp_batch_src = gst_element_factory_make ("rtpbatchsrc", name);
+  if (!bond->rtp_batch_src) {
+    GST_WARNING_OBJECT (src, "rtpbatchsrc from the 'rtpmanagerbad' plugin "
+        "is not available, receiving unbatched");
+    goto done;
+  }
+
+  g_object_set (bond->rtp_batch_src, "socket", socket, "caps", caps,
+      "max-packets", src->batch_size, NULL);
+  gst_element_set_locked_state (bond->rtp_src, TRUE);
+
+  pad = gst_element_get_static_pad (bond->rtp_src, "src");
+  peer = gst_pad_get_peer (pad);
+  gst_pad_unlink (pad, peer);
+  gst_object_unref (pad);
+
+  gst_bin_add (GST_BIN (src), bond->rtp_batch_src);
+  pad = gst_element_get_static_pad (bond->rtp_batch_src, "src");
+  gst_pad_link (pad, peer);
+  gst_object_unref (pad);
+  gst_object_unref (peer);
+
+  gst_element_sync_state_with_parent (bond->rtp_batch_src);
+
+done:
+  g_clear_object (&socket);
+  if (caps)
+    gst_caps_unref (caps);
+}
+
+static void
+gst_rist_src_teardown_batching (GstRistSrc * src, RistReceiverBond * bond)
+{
+  GstPad *pad, *peer;
+
+  if (!bond->rtp_batch_src)
+    return;
+
+  pad = gst_element_get_static_pad (bond->rtp_batch_src, "src");
+  peer = gst_pad_get_peer (pad);
+  gst_pad_unlink (pad, peer);
+  gst_object_unref (pad);
+
+  gst_element_set_state (bond->rtp_batch_src, GST_STATE_NULL);
+  gst_bin_remove (GST_BIN (src), bond->rtp_batch_src);
+  bond->rtp_batch_src = NULL;
+
+  pad = gst_element_get_static_pad (bond->rtp_src, "src");
+  gst_pad_link (pad, peer);
+  gst_object_unref (pad);
+  gst_object_unref (peer);
+
+  gst_element_set_locked_state (bond->rtp_src, FALSE);
+  gst_element_set_state (bond->rtp_src, GST_STATE_NULL);
+}
+
 static GstStateChangeReturn
 gst_rist_src_start (GstRistSrc * src)
 {
@@ -650,6 +1154,8 @@ gst_rist_src_start (GstRistSrc * src)
     return GST_STATE_CHANGE_FAILURE;
   }
 
+  gst_rist_src_reset_links (src);
+
   for (i = 0; i < src->bonds->len; i++) {
     RistReceiverBond *bond = g_ptr_array_index (src->bonds, i);
     GObject *session = NULL;
@@ -661,6 +1167,8 @@ gst_rist_src_start (GstRistSrc * src)
 
     if (!gst_rist_src_setup_rtcp_socket (src, bond))
       return GST_STATE_CHANGE_FAILURE;
+
+    gst_rist_src_setup_batching (src, bond);
   }
 
   return GST_STATE_CHANGE_SUCCESS;
@@ -672,7 +1180,9 @@ gst_rist_src_create_stats (GstRistSrc * src)
   GstStructure *ret;
   GValueArray *session_stats;
   guint64 total_dropped = 0, total_received = 0, recovered = 0, lost = 0;
-  guint64 duplicates = 0, rtx_sent = 0, rtt = 0;
+  guint64 duplicates = 0, rtx_sent = 0, rtt = 0, link_duplicates;
+  guint link_ssrcs;
+  GstClockTime now = gst_util_get_timestamp ();
   gint i;
 
   ret = gst_structure_new_empty ("rist/x-receiver-stats");
@@ -685,12 +1195,37 @@ gst_rist_src_create_stats (GstRistSrc * src)
     guint64 dropped = 0, received = 0;
     GValue value = G_VALUE_INIT;
 
+    RistReceiverBond *bond = g_ptr_array_index (src->bonds, i);
+    guint64 bitrate = 0;
+    gdouble rtx_loss = 0.0;
+
     g_signal_emit_by_name (src->rtpbin, "get-internal-session", i, &session);
     if (!session)
       continue;
 
     stats = gst_structure_new_empty ("rist/x-receiver-session-stats");
 
+    g_mutex_lock (&src->links_lock);
+    if (GST_CLOCK_TIME_IS_VALID (bond->stats_time) && now > bond->stats_time)
+      bitrate = gst_util_uint64_scale (bond->bytes - bond->stats_bytes,
+          8 * GST_SECOND, now - bond->stats_time);
+    bond->stats_bytes = bond->bytes;
+    bond->stats_time = now;
+
+    if (bond->rtx_window_requests > 0)
+      rtx_loss = 1.0 - MIN (1.0, (gdouble) bond->rtx_window_answers /
+          bond->rtx_window_requests);
+
+    gst_structure_set (stats,
+        "duplicates", G_TYPE_UINT64, bond->duplicates,
+        "bitrate", G_TYPE_UINT64, bitrate,
+        "round-trip-time", G_TYPE_UINT64,
+        GST_CLOCK_TIME_IS_VALID (bond->rtt) ? bond->rtt : 0,
+        "retransmission-requests-sent", G_TYPE_UINT64, bond->rtx_requests,
+        "recovered", G_TYPE_UINT64, bond->recovered,
+        "rtx-loss-fraction", G_TYPE_DOUBLE, rtx_loss, NULL);
+    g_mutex_unlock (&src->links_lock);
+
     g_signal_emit_by_name (session, "get-source-by-ssrc", src->rtp_ssrc,
         &source);
     if (source) {
@@ -735,11 +1270,18 @@ gst_rist_src_create_stats (GstRistSrc * src)
     gst_structure_free (stats);
   }
 
+  g_mutex_lock (&src->links_lock);
+  link_duplicates = src->duplicates;
+  link_ssrcs = g_hash_table_size (src->ssrc_windows);
+  g_mutex_unlock (&src->links_lock);
+
   gst_structure_set (ret, "dropped", G_TYPE_UINT64, total_dropped,
       "received", G_TYPE_UINT64, total_received,
       "recovered", G_TYPE_UINT64, recovered,
       "permanently-lost", G_TYPE_UINT64, lost,
       "duplicates", G_TYPE_UINT64, duplicates,
+      "bonding-duplicates", G_TYPE_UINT64, link_duplicates,
+      "bonding-ssrcs", G_TYPE_UINT, link_ssrcs,
       "retransmission-requests-sent", G_TYPE_UINT64, rtx_sent,
       "rtx-roundtrip-time", G_TYPE_UINT64, rtt,
       "session-stats", G_TYPE_VALUE_ARRAY, session_stats, NULL);
@@ -813,6 +1355,8 @@ gst_rist_src_stop (GstRistSrc * src)
       bond->rtcp_send_probe = 0;
       gst_object_unref (pad);
     }
+
+    gst_rist_src_teardown_batching (src, bond);
   }
 }
 
@@ -1074,6 +1618,10 @@ gst_rist_src_get_property (GObject * object, guint prop_id,
       g_value_take_string (value, gst_rist_src_get_bonds (src));
       break;
 
+    case PROP_BATCH_SIZE:
+      g_value_set_uint (value, src->batch_size);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1174,6 +1722,10 @@ gst_rist_src_set_property (GObject * object, guint prop_id,
       gst_rist_src_set_bonds (src, g_value_get_string (value));
       break;
 
+    case PROP_BATCH_SIZE:
+      src->batch_size = g_value_get_uint (value);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1204,6 +1756,9 @@ gst_rist_src_finalize (GObject * object)
   g_mutex_unlock (&src->bonds_lock);
   g_mutex_clear (&src->bonds_lock);
 
+  g_hash_table_unref (src->ssrc_windows);
+  g_mutex_clear (&src->links_lock);
+
   G_OBJECT_CLASS (gst_rist_src_parent_class)->finalize (object);
 }
 
@@ -1302,6 +1857,23 @@ gst_rist_src_class_init (GstRistSrcClass * klass)
           "Comma (,) separated list of <address>:<port> to receive from. "
           "Only used if 'enable-bonding' is set.", NULL,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRistSrc:batch-size:
+   *
+   * Maximum number of RTP packets received with one recvmmsg() system call
+   * on each bond. Only packets already queued on the socket are batched, so
+   * this does not add latency. Values larger than 1 require the rtpbatchsrc
+   * element.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (object_class, PROP_BATCH_SIZE,
+      g_param_spec_uint ("batch-size", "Batch size",
+          "Maximum number of RTP packets received with one system call "
+          "(1 = no batching)", 1, 1024, 1,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT |
+          GST_PARAM_MUTABLE_READY));
 }
 
 static GstURIType
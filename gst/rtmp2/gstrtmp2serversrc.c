@@ -0,0 +1,969 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:element-rtmp2serversrc
+ *
+ * The rtmp2serversrc element listens for RTMP connections and accepts
+ * streams published by clients such as rtmp2sink.
+ *
+ * Every published stream is exposed on its own "src_%u" pad carrying FLV,
+ * like the output of rtmp2src. The stream-start event's stream ID ends with
+ * "application/stream" as requested by the publisher. When the publisher
+ * stops or disconnects, EOS is pushed and the pad is removed.
+ *
+ * All connections are served from a single main loop thread. Each pad
+ * pushes from its own streaming thread, so a slow downstream branch does
+ * not hold back the other publishers. Once #GstRtmp2ServerSrc:max-queue-bytes
+ * are waiting to be pushed on a pad, the server stops reading from that
+ * publisher until half of them were pushed. Nothing is dropped, the
+ * publisher is slowed down by TCP flow control instead.
+ *
+ * <refsect2>
+ * <title>Example launch line</title>
+ * |[
+ * gst-launch-1.0 rtmp2serversrc port=1935 ! queue ! flvdemux ! decodebin ! autovideosink
+ * ]| Receives the first stream published to rtmp://localhost/any/name
+ * </refsect2>
+ *
+ * Since: 1.18
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstrtmp2serversrc.h"
+
+#include "rtmp/rtmpmessage.h"
+#include "rtmp/rtmpserver.h"
+
+#include <string.h>
+
+GST_DEBUG_CATEGORY_STATIC (gst_rtmp2_server_src_debug_category);
+#define GST_CAT_DEFAULT gst_rtmp2_server_src_debug_category
+
+/* prototypes */
+#define GST_RTMP2_SERVER_SRC(obj)   (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_RTMP2_SERVER_SRC,GstRtmp2ServerSrc))
+#define GST_IS_RTMP2_SERVER_SRC(obj)   (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_RTMP2_SERVER_SRC))
+
+typedef struct
+{
+  GstElement parent_instance;
+
+  /* properties */
+  gchar *host;
+  guint port;
+  guint current_port;
+  guint max_queue_bytes;
+
+  /* protects running and sessions */
+  GMutex lock;
+  gboolean running;
+  GList *sessions;
+  guint pad_count;
+
+  GstTask *task;
+  GRecMutex task_lock;
+
+  GMainLoop *loop;
+  GMainContext *context;
+  GSocketListener *listener;
+  GCancellable *cancellable;
+} GstRtmp2ServerSrc;
+
+typedef struct
+{
+  GstElementClass parent_class;
+} GstRtmp2ServerSrcClass;
+
+/* A published stream and its pad. The connection is only touched from the
+ * main loop thread, the queue is shared with the pad's streaming thread. */
+typedef struct
+{
+  GstRtmp2ServerSrc *self;
+  GstRtmpConnection *connection;
+  GstPad *pad;
+  gchar *name;
+  guint32 stream_id;
+  gboolean sent_header;
+
+  /* protected by self->lock */
+  GCond cond;
+  GQueue queue;
+  gsize queued_bytes, max_queued_bytes;
+  gboolean input_paused, resuming;
+  gboolean eos, flushing, removing;
+} ServerSession;
+
+/* GObject virtual functions */
+static void gst_rtmp2_server_src_set_property (GObject * object,
+    guint property_id, const GValue * value, GParamSpec * pspec);
+static void gst_rtmp2_server_src_get_property (GObject * object,
+    guint property_id, GValue * value, GParamSpec * pspec);
+static void gst_rtmp2_server_src_finalize (GObject * object);
+
+/* GstElement virtual functions */
+static GstStateChangeReturn gst_rtmp2_server_src_change_state (GstElement *
+    element, GstStateChange transition);
+
+/* Internal API */
+static void gst_rtmp2_server_src_task_func (gpointer user_data);
+static void accept_done (GObject * source, GAsyncResult * result,
+    gpointer user_data);
+static void server_accept_done (GObject * source, GAsyncResult * result,
+    gpointer user_data);
+
+enum
+{
+  PROP_0,
+  PROP_HOST,
+  PROP_PORT,
+  PROP_CURRENT_PORT,
+  PROP_MAX_QUEUE_BYTES,
+};
+
+#define DEFAULT_HOST "0.0.0.0"
+#define DEFAULT_PORT 1935
+#define DEFAULT_MAX_QUEUE_BYTES (4 * 1024 * 1024)
+
+/* pad templates */
+
+static GstStaticPadTemplate gst_rtmp2_server_src_src_template =
+GST_STATIC_PAD_TEMPLATE ("src_%u",
+    GST_PAD_SRC,
+    GST_PAD_SOMETIMES,
+    GST_STATIC_CAPS ("video/x-flv")
+    );
+
+/* class initialization */
+
+G_DEFINE_TYPE (GstRtmp2ServerSrc, gst_rtmp2_server_src, GST_TYPE_ELEMENT);
+
+static void
+gst_rtmp2_server_src_class_init (GstRtmp2ServerSrcClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+
+  gst_element_class_add_static_pad_template (element_class,
+      &gst_rtmp2_server_src_src_template);
+
+  gst_element_class_set_static_metadata (element_class,
+      "RTMP server source element", "Source/Network",
+      "Accepts streams published to an RTMP server",
+      "Make.TV, Inc. <info@make.tv>");
+
+  gobject_class->set_property = gst_rtmp2_server_src_set_property;
+  gobject_class->get_property = gst_rtmp2_server_src_get_property;
+  gobject_class->finalize = gst_rtmp2_server_src_finalize;
+
+  element_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_rtmp2_server_src_change_state);
+
+  g_object_class_install_property (gobject_class, PROP_HOST,
+      g_param_spec_string ("host", "Host", "Address to listen on",
+          DEFAULT_HOST, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_PORT,
+      g_param_spec_uint ("port", "Port",
+          "Port to listen on (0 = pick a random port)", 0, 65535,
+          DEFAULT_PORT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_CURRENT_PORT,
+      g_param_spec_uint ("current-port", "Current port",
+          "The port number the server is listening on, once started", 0, 65535,
+          0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtmp2ServerSrc:max-queue-bytes:
+   *
+   * The maximum number of bytes queued on a pad before the server stops
+   * reading from its publisher. Applies to streams published after it was
+   * set.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_QUEUE_BYTES,
+      g_param_spec_uint ("max-queue-bytes", "Max queue bytes",
+          "Bytes queued per publisher before reading from it stops "
+          "(0 = unlimited)", 0, G_MAXUINT, DEFAULT_MAX_QUEUE_BYTES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  GST_DEBUG_CATEGORY_INIT (gst_rtmp2_server_src_debug_category,
+      "rtmp2serversrc", 0, "debug category for rtmp2serversrc element");
+}
+
+static void
+gst_rtmp2_server_src_init (GstRtmp2ServerSrc * self)
+{
+  self->host = g_strdup (DEFAULT_HOST);
+  self->port = DEFAULT_PORT;
+  self->max_queue_bytes = DEFAULT_MAX_QUEUE_BYTES;
+
+  g_mutex_init (&self->lock);
+
+  self->task = gst_task_new (gst_rtmp2_server_src_task_func, self, NULL);
+  g_rec_mutex_init (&self->task_lock);
+  gst_task_set_lock (self->task, &self->task_lock);
+}
+
+static void
+gst_rtmp2_server_src_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtmp2ServerSrc *self = GST_RTMP2_SERVER_SRC (object);
+
+  switch (property_id) {
+    case PROP_HOST:
+      GST_OBJECT_LOCK (self);
+      g_free (self->host);
+      self->host = g_value_dup_string (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_PORT:
+      GST_OBJECT_LOCK (self);
+      self->port = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MAX_QUEUE_BYTES:
+      GST_OBJECT_LOCK (self);
+      self->max_queue_bytes = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtmp2_server_src_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtmp2ServerSrc *self = GST_RTMP2_SERVER_SRC (object);
+
+  switch (property_id) {
+    case PROP_HOST:
+      GST_OBJECT_LOCK (self);
+      g_value_set_string (value, self->host);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_PORT:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->port);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_CURRENT_PORT:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->current_port);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MAX_QUEUE_BYTES:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->max_queue_bytes);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtmp2_server_src_finalize (GObject * object)
+{
+  GstRtmp2ServerSrc *self = GST_RTMP2_SERVER_SRC (object);
+
+  g_free (self->host);
+
+  g_clear_object (&self->task);
+  g_rec_mutex_clear (&self->task_lock);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (gst_rtmp2_server_src_parent_class)->finalize (object);
+}
+
+static ServerSession *
+server_session_new (GstRtmp2ServerSrc * self, GstRtmpConnection * connection,
+    const gchar * application, const gchar * stream, guint32 stream_id)
+{
+  ServerSession *session = g_slice_new0 (ServerSession);
+
+  session->self = self;
+  session->connection = connection;
+  session->name = g_strdup_printf ("%s/%s", application, stream);
+  session->stream_id = stream_id;
+  g_cond_init (&session->cond);
+  g_queue_init (&session->queue);
+
+  GST_OBJECT_LOCK (self);
+  session->max_queued_bytes = self->max_queue_bytes;
+  GST_OBJECT_UNLOCK (self);
+
+  return session;
+}
+
+/* Called from the main loop thread once the session left self->sessions */
+static void
+server_session_free (ServerSession * session)
+{
+  GstRtmp2ServerSrc *self = session->self;
+
+  GST_DEBUG_OBJECT (self, "Removing session '%s'", session->name);
+
+  if (session->pad) {
+    g_mutex_lock (&self->lock);
+    session->flushing = TRUE;
+    g_cond_signal (&session->cond);
+    g_mutex_unlock (&self->lock);
+
+    /* deactivates the pad, which also stops its task */
+    gst_element_remove_pad (GST_ELEMENT (self), session->pad);
+  }
+
+  g_signal_handlers_disconnect_by_data (session->connection, session);
+  gst_rtmp_connection_set_input_handler (session->connection, NULL, NULL,
+      NULL);
+  gst_rtmp_connection_close_and_unref (session->connection);
+
+  while (!g_queue_is_empty (&session->queue)) {
+    gst_buffer_unref (g_queue_pop_head (&session->queue));
+  }
+
+  g_cond_clear (&session->cond);
+  g_free (session->name);
+  g_slice_free (ServerSession, session);
+}
+
+/* Unlike g_main_context_invoke(), never runs @func from the calling thread,
+ * even if the loop is not running (yet) */
+static void
+invoke_in_loop (GstRtmp2ServerSrc * self, GSourceFunc func, gpointer data)
+{
+  GSource *source = g_idle_source_new ();
+
+  g_source_set_callback (source, func, data, NULL);
+  g_source_attach (source, self->context);
+  g_source_unref (source);
+}
+
+static gboolean
+remove_session (gpointer user_data)
+{
+  ServerSession *session = user_data;
+  GstRtmp2ServerSrc *self = session->self;
+  GList *l;
+
+  g_mutex_lock (&self->lock);
+  l = g_list_find (self->sessions, session);
+  if (l) {
+    self->sessions = g_list_delete_link (self->sessions, l);
+  }
+  g_mutex_unlock (&self->lock);
+
+  if (l) {
+    server_session_free (session);
+  }
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Must be called with self->lock */
+static void
+schedule_remove_session (ServerSession * session)
+{
+  GstRtmp2ServerSrc *self = session->self;
+
+  if (!self->running || session->removing) {
+    return;
+  }
+
+  session->removing = TRUE;
+  invoke_in_loop (self, remove_session, session);
+}
+
+static gboolean
+resume_session_input (gpointer user_data)
+{
+  ServerSession *session = user_data;
+  GstRtmp2ServerSrc *self = session->self;
+  gboolean resume = FALSE;
+
+  g_mutex_lock (&self->lock);
+  if (g_list_find (self->sessions, session) && !session->removing) {
+    session->resuming = FALSE;
+    session->input_paused = FALSE;
+    resume = TRUE;
+  }
+  g_mutex_unlock (&self->lock);
+
+  /* may read queued messages right away */
+  if (resume) {
+    GST_DEBUG_OBJECT (self, "Resuming input of '%s'", session->name);
+    gst_rtmp_connection_set_input_paused (session->connection, FALSE);
+  }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+server_session_set_eos (ServerSession * session)
+{
+  GstRtmp2ServerSrc *self = session->self;
+
+  g_mutex_lock (&self->lock);
+  if (!session->eos) {
+    GST_INFO_OBJECT (self, "Stream '%s' went EOS", session->name);
+    session->eos = TRUE;
+    g_cond_signal (&session->cond);
+  }
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+server_session_loop (gpointer user_data)
+{
+  ServerSession *session = user_data;
+  GstRtmp2ServerSrc *self = session->self;
+  GstBuffer *buffer;
+  GstFlowReturn ret;
+
+  g_mutex_lock (&self->lock);
+
+  while (g_queue_is_empty (&session->queue) && !session->eos &&
+      !session->flushing) {
+    g_cond_wait (&session->cond, &self->lock);
+  }
+
+  if (session->flushing) {
+    g_mutex_unlock (&self->lock);
+    gst_pad_pause_task (session->pad);
+    return;
+  }
+
+  buffer = g_queue_pop_head (&session->queue);
+  if (buffer) {
+    session->queued_bytes -= gst_buffer_get_size (buffer);
+
+    if (session->input_paused && !session->resuming &&
+        session->queued_bytes <= session->max_queued_bytes / 2) {
+      session->resuming = TRUE;
+      invoke_in_loop (self, resume_session_input, session);
+    }
+  }
+  g_mutex_unlock (&self->lock);
+
+  if (!buffer) {
+    gst_pad_push_event (session->pad, gst_event_new_eos ());
+    goto done;
+  }
+
+  ret = gst_pad_push (session->pad, buffer);
+  if (ret == GST_FLOW_OK) {
+    return;
+  }
+
+  if (ret == GST_FLOW_FLUSHING) {
+    GST_DEBUG_OBJECT (self, "Pad for '%s' is flushing", session->name);
+    gst_pad_pause_task (session->pad);
+    return;
+  }
+
+  /* Only this publisher is dropped, the others keep streaming */
+  GST_INFO_OBJECT (self, "Dropping '%s', flow %s", session->name,
+      gst_flow_get_name (ret));
+
+  if (ret < GST_FLOW_EOS && ret != GST_FLOW_NOT_LINKED) {
+    GST_ELEMENT_FLOW_ERROR (self, ret);
+  }
+
+  gst_pad_push_event (session->pad, gst_event_new_eos ());
+
+done:
+  gst_pad_pause_task (session->pad);
+
+  g_mutex_lock (&self->lock);
+  schedule_remove_session (session);
+  g_mutex_unlock (&self->lock);
+}
+
+static GstBuffer *
+message_to_flv_tag (GstBuffer * message, gsize offset, gboolean with_header)
+{
+  static const guint8 flv_header_data[] = {
+    0x46, 0x4c, 0x56, 0x01, 0x01, 0x00, 0x00, 0x00,
+    0x09, 0x00, 0x00, 0x00, 0x00,
+  };
+
+  GstRtmpMeta *meta = gst_buffer_get_rtmp_meta (message);
+  guint32 timestamp = 0, size = meta->size - offset;
+  GstBuffer *buffer;
+
+  if (GST_BUFFER_DTS_IS_VALID (message)) {
+    timestamp = GST_BUFFER_DTS (message) / GST_MSECOND;
+  }
+
+  buffer = gst_buffer_copy_region (message, GST_BUFFER_COPY_MEMORY, offset,
+      size);
+
+  {
+    guint8 *tag_header = g_malloc (11);
+    GstMemory *memory =
+        gst_memory_new_wrapped (0, tag_header, 11, 0, 11, tag_header, g_free);
+    GST_WRITE_UINT8 (tag_header, meta->type);
+    GST_WRITE_UINT24_BE (tag_header + 1, size);
+    GST_WRITE_UINT24_BE (tag_header + 4, timestamp);
+    GST_WRITE_UINT8 (tag_header + 7, timestamp >> 24);
+    GST_WRITE_UINT24_BE (tag_header + 8, 0);
+    gst_buffer_prepend_memory (buffer, memory);
+  }
+
+  {
+    guint8 *tag_footer = g_malloc (4);
+    GstMemory *memory =
+        gst_memory_new_wrapped (0, tag_footer, 4, 0, 4, tag_footer, g_free);
+    GST_WRITE_UINT32_BE (tag_footer, size + 11);
+    gst_buffer_append_memory (buffer, memory);
+  }
+
+  if (with_header) {
+    GstMemory *memory = gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY,
+        (guint8 *) flv_header_data, sizeof flv_header_data, 0,
+        sizeof flv_header_data, NULL, NULL);
+    gst_buffer_prepend_memory (buffer, memory);
+  }
+
+  return buffer;
+}
+
+static void
+server_session_got_message (GstRtmpConnection * connection,
+    GstBuffer * message, gpointer user_data)
+{
+  ServerSession *session = user_data;
+  GstRtmp2ServerSrc *self = session->self;
+  GstRtmpMeta *meta = gst_buffer_get_rtmp_meta (message);
+  guint32 min_size = 1;
+  gsize offset = 0;
+  GstBuffer *buffer;
+
+  /* rtmp2sink and most encoders wrap the metadata in this command, which
+   * is not part of a FLV script tag */
+  static const guint8 set_data_frame[] = {
+    0x02, 0x00, 0x0d, '@', 's', 'e', 't', 'D', 'a', 't', 'a',
+    'F', 'r', 'a', 'm', 'e',
+  };
+
+  g_return_if_fail (meta);
+
+  if (meta->type == GST_RTMP_MESSAGE_TYPE_COMMAND_AMF0) {
+    if (gst_rtmp_server_is_unpublish (message, session->stream_id)) {
+      server_session_set_eos (session);
+    }
+    return;
+  }
+
+  if (meta->mstream != session->stream_id) {
+    GST_DEBUG_OBJECT (self, "Ignoring %s message with stream %" G_GUINT32_FORMAT
+        " != %" G_GUINT32_FORMAT, gst_rtmp_message_type_get_nick (meta->type),
+        meta->mstream, session->stream_id);
+    return;
+  }
+
+  switch (meta->type) {
+    case GST_RTMP_MESSAGE_TYPE_VIDEO:
+      min_size = 6;
+      break;
+
+    case GST_RTMP_MESSAGE_TYPE_AUDIO:
+      min_size = 2;
+      break;
+
+    case GST_RTMP_MESSAGE_TYPE_DATA_AMF0:
+      if (meta->size > sizeof set_data_frame &&
+          gst_buffer_memcmp (message, 0, set_data_frame,
+              sizeof set_data_frame) == 0) {
+        offset = sizeof set_data_frame;
+      }
+      break;
+
+    default:
+      GST_DEBUG_OBJECT (self, "Ignoring %s message, wrong type",
+          gst_rtmp_message_type_get_nick (meta->type));
+      return;
+  }
+
+  if (meta->size < min_size) {
+    GST_DEBUG_OBJECT (self, "Ignoring too small %s message (%" G_GUINT32_FORMAT
+        " < %" G_GUINT32_FORMAT ")",
+        gst_rtmp_message_type_get_nick (meta->type), meta->size, min_size);
+    return;
+  }
+
+  buffer = message_to_flv_tag (message, offset, !session->sent_header);
+  session->sent_header = TRUE;
+
+  g_mutex_lock (&self->lock);
+  if (session->eos) {
+    g_mutex_unlock (&self->lock);
+    gst_buffer_unref (buffer);
+    return;
+  }
+  g_queue_push_tail (&session->queue, buffer);
+  session->queued_bytes += gst_buffer_get_size (buffer);
+  g_cond_signal (&session->cond);
+
+  if (session->max_queued_bytes > 0 && !session->input_paused &&
+      session->queued_bytes >= session->max_queued_bytes) {
+    GST_DEBUG_OBJECT (self, "Queue of '%s' is full, pausing input (%"
+        G_GSIZE_FORMAT " bytes)", session->name, session->queued_bytes);
+    session->input_paused = TRUE;
+    g_mutex_unlock (&self->lock);
+
+    gst_rtmp_connection_set_input_paused (connection, TRUE);
+    return;
+  }
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+server_session_error (GstRtmpConnection * connection, ServerSession * session)
+{
+  GST_INFO_OBJECT (session->self, "Connection of '%s' closed", session->name);
+  server_session_set_eos (session);
+}
+
+static void
+server_session_start (ServerSession * session, guint pad_index)
+{
+  GstRtmp2ServerSrc *self = session->self;
+  GstPadTemplate *templ;
+  GstSegment segment;
+  GstCaps *caps;
+  gchar *pad_name, *stream_id;
+
+  templ = gst_static_pad_template_get (&gst_rtmp2_server_src_src_template);
+  pad_name = g_strdup_printf ("src_%u", pad_index);
+  session->pad = gst_pad_new_from_template (templ, pad_name);
+  gst_object_unref (templ);
+  g_free (pad_name);
+
+  gst_pad_use_fixed_caps (session->pad);
+  gst_pad_set_active (session->pad, TRUE);
+
+  stream_id = gst_pad_create_stream_id (session->pad, GST_ELEMENT (self),
+      session->name);
+  gst_pad_push_event (session->pad, gst_event_new_stream_start (stream_id));
+  g_free (stream_id);
+
+  caps = gst_static_pad_template_get_caps (&gst_rtmp2_server_src_src_template);
+  gst_pad_set_caps (session->pad, caps);
+  gst_caps_unref (caps);
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (session->pad, gst_event_new_segment (&segment));
+
+  gst_rtmp_connection_set_input_handler (session->connection,
+      server_session_got_message, session, NULL);
+  g_signal_connect (session->connection, "error",
+      G_CALLBACK (server_session_error), session);
+
+  gst_element_add_pad (GST_ELEMENT (self), session->pad);
+  gst_pad_start_task (session->pad, server_session_loop, session, NULL);
+}
+
+static void
+accept_done (GObject * source, GAsyncResult * result, gpointer user_data)
+{
+  GstRtmp2ServerSrc *self = GST_RTMP2_SERVER_SRC (user_data);
+  GSocketConnection *socket_connection;
+  GError *error = NULL;
+
+  socket_connection = g_socket_listener_accept_finish (self->listener, result,
+      NULL, &error);
+  if (!socket_connection) {
+    if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      GST_DEBUG_OBJECT (self, "Accept was cancelled");
+      g_error_free (error);
+      return;
+    }
+
+    GST_WARNING_OBJECT (self, "Failed to accept: %s", error->message);
+    g_error_free (error);
+  } else {
+    GST_DEBUG_OBJECT (self, "Accepted connection");
+    gst_rtmp_server_accept_async (socket_connection, self->cancellable,
+        server_accept_done, self);
+    g_object_unref (socket_connection);
+  }
+
+  g_socket_listener_accept_async (self->listener, self->cancellable,
+      accept_done, self);
+}
+
+static void
+server_accept_done (GObject * source, GAsyncResult * result,
+    gpointer user_data)
+{
+  GstRtmp2ServerSrc *self = GST_RTMP2_SERVER_SRC (user_data);
+  GstRtmpConnection *connection;
+  ServerSession *session;
+  gchar *application = NULL, *stream = NULL;
+  guint stream_id, pad_index;
+  GError *error = NULL;
+
+  connection = gst_rtmp_server_accept_finish (result, &application, &stream,
+      &stream_id, &error);
+  if (!connection) {
+    if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      GST_DEBUG_OBJECT (self, "Session setup was cancelled");
+    } else {
+      GST_WARNING_OBJECT (self, "Rejected connection: %s", error->message);
+    }
+    g_error_free (error);
+    return;
+  }
+
+  session = server_session_new (self, connection, application, stream,
+      stream_id);
+  g_free (application);
+  g_free (stream);
+
+  g_mutex_lock (&self->lock);
+  if (!self->running) {
+    g_mutex_unlock (&self->lock);
+    server_session_free (session);
+    return;
+  }
+  self->sessions = g_list_append (self->sessions, session);
+  pad_index = self->pad_count++;
+  g_mutex_unlock (&self->lock);
+
+  GST_INFO_OBJECT (self, "Stream '%s' published on src_%u", session->name,
+      pad_index);
+
+  server_session_start (session, pad_index);
+}
+
+static gboolean
+quit_loop (gpointer user_data)
+{
+  g_main_loop_quit (user_data);
+  return G_SOURCE_REMOVE;
+}
+
+/* Mainloop task */
+static void
+gst_rtmp2_server_src_task_func (gpointer user_data)
+{
+  GstRtmp2ServerSrc *self = GST_RTMP2_SERVER_SRC (user_data);
+  GList *sessions;
+
+  GST_DEBUG_OBJECT (self, "gst_rtmp2_server_src task starting");
+
+  g_main_context_push_thread_default (self->context);
+
+  g_socket_listener_accept_async (self->listener, self->cancellable,
+      accept_done, self);
+
+  g_main_loop_run (self->loop);
+
+  /* Run loop cleanup; lets pending accepts see the cancellation */
+  while (g_main_context_pending (self->context)) {
+    GST_DEBUG_OBJECT (self, "iterating main context to clean up");
+    g_main_context_iteration (self->context, FALSE);
+  }
+
+  g_mutex_lock (&self->lock);
+  sessions = self->sessions;
+  self->sessions = NULL;
+  g_mutex_unlock (&self->lock);
+
+  g_list_free_full (sessions, (GDestroyNotify) server_session_free);
+
+  g_socket_listener_close (self->listener);
+
+  g_main_context_pop_thread_default (self->context);
+
+  GST_DEBUG_OBJECT (self, "gst_rtmp2_server_src task exiting");
+}
+
+static GInetAddress *
+resolve_host (GstRtmp2ServerSrc * self, const gchar * host, GError ** error)
+{
+  GInetAddress *addr;
+  GResolver *resolver;
+  GList *results;
+
+  addr = g_inet_address_new_from_string (host);
+  if (addr) {
+    return addr;
+  }
+
+  resolver = g_resolver_get_default ();
+  results = g_resolver_lookup_by_name (resolver, host, NULL, error);
+  g_object_unref (resolver);
+
+  if (!results) {
+    return NULL;
+  }
+
+  addr = g_object_ref (results->data);
+  g_resolver_free_addresses (results);
+  return addr;
+}
+
+static gboolean
+gst_rtmp2_server_src_start (GstRtmp2ServerSrc * self)
+{
+  GSocketAddress *saddr, *effective = NULL;
+  GInetAddress *addr;
+  GError *error = NULL;
+  gchar *host;
+  guint port;
+
+  GST_OBJECT_LOCK (self);
+  host = g_strdup (self->host);
+  port = self->port;
+  GST_OBJECT_UNLOCK (self);
+
+  addr = resolve_host (self, host, &error);
+  if (!addr) {
+    GST_ELEMENT_ERROR (self, RESOURCE, NOT_FOUND,
+        ("Could not resolve host '%s'", host), ("%s", error->message));
+    g_error_free (error);
+    g_free (host);
+    return FALSE;
+  }
+
+  saddr = g_inet_socket_address_new (addr, port);
+  g_object_unref (addr);
+
+  self->listener = g_socket_listener_new ();
+  if (!g_socket_listener_add_address (self->listener, saddr,
+          G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_TCP, NULL, &effective,
+          &error)) {
+    GST_ELEMENT_ERROR (self, RESOURCE, OPEN_READ,
+        ("Could not listen on %s:%u", host, port), ("%s", error->message));
+    g_error_free (error);
+    g_object_unref (saddr);
+    g_clear_object (&self->listener);
+    g_free (host);
+    return FALSE;
+  }
+  g_object_unref (saddr);
+
+  GST_OBJECT_LOCK (self);
+  self->current_port =
+      g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (effective));
+  GST_OBJECT_UNLOCK (self);
+  g_object_unref (effective);
+  g_object_notify (G_OBJECT (self), "current-port");
+
+  GST_INFO_OBJECT (self, "Listening on %s:%u", host, self->current_port);
+  g_free (host);
+
+  self->context = g_main_context_new ();
+  self->loop = g_main_loop_new (self->context, FALSE);
+  self->cancellable = g_cancellable_new ();
+
+  g_mutex_lock (&self->lock);
+  self->running = TRUE;
+  self->pad_count = 0;
+  g_mutex_unlock (&self->lock);
+
+  gst_task_start (self->task);
+
+  return TRUE;
+}
+
+static void
+gst_rtmp2_server_src_stop (GstRtmp2ServerSrc * self)
+{
+  GList *l;
+
+  if (!self->listener) {
+    return;
+  }
+
+  /* Wake up all pad tasks before the pads get deactivated */
+  g_mutex_lock (&self->lock);
+  self->running = FALSE;
+  for (l = self->sessions; l; l = g_list_next (l)) {
+    ServerSession *session = l->data;
+    session->flushing = TRUE;
+    g_cond_signal (&session->cond);
+  }
+  g_mutex_unlock (&self->lock);
+
+  g_cancellable_cancel (self->cancellable);
+  gst_task_stop (self->task);
+  invoke_in_loop (self, quit_loop, self->loop);
+  gst_task_join (self->task);
+
+  g_clear_object (&self->cancellable);
+  g_clear_object (&self->listener);
+  g_clear_pointer (&self->loop, g_main_loop_unref);
+  g_clear_pointer (&self->context, g_main_context_unref);
+
+  GST_OBJECT_LOCK (self);
+  self->current_port = 0;
+  GST_OBJECT_UNLOCK (self);
+}
+
+static GstStateChangeReturn
+gst_rtmp2_server_src_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GstRtmp2ServerSrc *self = GST_RTMP2_SERVER_SRC (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      if (!gst_rtmp2_server_src_start (self)) {
+        return GST_STATE_CHANGE_FAILURE;
+      }
+      break;
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_rtmp2_server_src_stop (self);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (gst_rtmp2_server_src_parent_class)->change_state
+      (element, transition);
+  if (ret == GST_STATE_CHANGE_FAILURE) {
+    if (transition == GST_STATE_CHANGE_READY_TO_PAUSED) {
+      gst_rtmp2_server_src_stop (self);
+    }
+    return ret;
+  }
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+    case GST_STATE_CHANGE_PLAYING_TO_PAUSED:
+      /* live source */
+      ret = GST_STATE_CHANGE_NO_PREROLL;
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
@@ -666,21 +666,28 @@ gst_rtmp_chunk_stream_serialize_next (GstRtmpChunkStream * cstream,
   return serialize_next (cstream, chunk_size, CHUNK_TYPE_3);
 }
 
-GstBuffer *
+/* Appends the chunks of @buffer to @list. Each chunk is a small header
+ * memory followed by a slice of the message memory, so no payload is
+ * copied. */
+gboolean
 gst_rtmp_chunk_stream_serialize_all (GstRtmpChunkStream * cstream,
-    GstBuffer * buffer, guint32 chunk_size)
+    GstBuffer * buffer, guint32 chunk_size, GstBufferList * list)
 {
-  GstBuffer *outbuf, *nextbuf;
+  GstBuffer *chunk;
+
+  g_return_val_if_fail (list, FALSE);
 
-  outbuf = gst_rtmp_chunk_stream_serialize_start (cstream, buffer, chunk_size);
-  nextbuf = gst_rtmp_chunk_stream_serialize_next (cstream, chunk_size);
+  chunk = gst_rtmp_chunk_stream_serialize_start (cstream, buffer, chunk_size);
+  if (!chunk) {
+    return FALSE;
+  }
 
-  while (nextbuf) {
-    outbuf = gst_buffer_append (outbuf, nextbuf);
-    nextbuf = gst_rtmp_chunk_stream_serialize_next (cstream, chunk_size);
+  while (chunk) {
+    gst_buffer_list_add (list, chunk);
+    chunk = gst_rtmp_chunk_stream_serialize_next (cstream, chunk_size);
   }
 
-  return outbuf;
+  return TRUE;
 }
 
 GstRtmpChunkStreams *
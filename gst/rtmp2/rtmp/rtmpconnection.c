@@ -300,15 +300,10 @@ gst_rtmp_connection_get_socket (GstRtmpConnection * sc)
 }
 
 static void
-gst_rtmp_connection_set_socket_connection (GstRtmpConnection * sc,
-    GSocketConnection * connection)
+gst_rtmp_connection_start_input_source (GstRtmpConnection * sc)
 {
   GInputStream *is;
 
-  sc->thread = g_thread_ref (g_thread_self ());
-  sc->main_context = g_main_context_ref_thread_default ();
-  sc->connection = g_object_ref (connection);
-
   /* refs the socket because it's creating an input stream, which holds a ref */
   is = g_io_stream_get_input_stream (G_IO_STREAM (sc->connection));
   /* refs the socket because it's creating a socket source */
@@ -322,6 +317,17 @@ gst_rtmp_connection_set_socket_connection (GstRtmpConnection * sc,
   g_source_attach (sc->input_source, sc->main_context);
 }
 
+static void
+gst_rtmp_connection_set_socket_connection (GstRtmpConnection * sc,
+    GSocketConnection * connection)
+{
+  sc->thread = g_thread_ref (g_thread_self ());
+  sc->main_context = g_main_context_ref_thread_default ();
+  sc->connection = g_object_ref (connection);
+
+  gst_rtmp_connection_start_input_source (sc);
+}
+
 GstRtmpConnection *
 gst_rtmp_connection_new (GSocketConnection * connection)
 {
@@ -419,6 +425,39 @@ gst_rtmp_connection_set_output_handler (GstRtmpConnection * sc,
   sc->output_handler_user_data_destroy = user_data_destroy;
 }
 
+/* Stops reading from the socket, the peer then blocks once the socket
+ * buffers are full. Messages already read are only handled after resuming. */
+void
+gst_rtmp_connection_set_input_paused (GstRtmpConnection * sc,
+    gboolean paused)
+{
+  if (sc->thread != g_thread_self ()) {
+    GST_ERROR_OBJECT (sc, "Called from wrong thread");
+  }
+
+  if (sc->input_paused == paused) {
+    return;
+  }
+
+  GST_DEBUG_OBJECT (sc, "%s input", paused ? "pausing" : "resuming");
+  sc->input_paused = paused;
+
+  if (paused) {
+    if (sc->input_source) {
+      g_source_destroy (sc->input_source);
+      g_clear_pointer (&sc->input_source, g_source_unref);
+    }
+    return;
+  }
+
+  if (g_cancellable_is_cancelled (sc->cancellable) || sc->error) {
+    return;
+  }
+
+  gst_rtmp_connection_start_input_source (sc);
+  gst_rtmp_connection_try_read (sc);
+}
+
 static gboolean
 gst_rtmp_connection_input_ready (GInputStream * is, gpointer user_data)
 {
@@ -473,34 +512,28 @@ gst_rtmp_connection_input_ready (GInputStream * is, gpointer user_data)
   return G_SOURCE_CONTINUE;
 }
 
-static void
-gst_rtmp_connection_start_write (GstRtmpConnection * self)
+/* Upper bound for the messages serialized into a single write */
+#define MAX_WRITE_BATCH_SIZE (256 * 1024)
+
+/* Returns TRUE if @message was serialized into @chunks */
+static gboolean
+gst_rtmp_connection_serialize_message (GstRtmpConnection * self,
+    GstBuffer * message, GstBufferList * chunks)
 {
-  GOutputStream *os;
-  GstBuffer *message, *chunks;
   GstRtmpMeta *meta;
   GstRtmpChunkStream *cstream;
 
-  if (self->writing) {
-    return;
-  }
-
-  message = g_async_queue_try_pop (self->output_queue);
-  if (!message) {
-    return;
-  }
-
   meta = gst_buffer_get_rtmp_meta (message);
   if (!meta) {
     GST_ERROR_OBJECT (self, "No RTMP meta on %" GST_PTR_FORMAT, message);
-    goto out;
+    return FALSE;
   }
 
   if (gst_rtmp_message_is_protocol_control (message)) {
     if (!gst_rtmp_connection_prepare_protocol_control (self, message)) {
       GST_ERROR_OBJECT (self,
           "Failed to prepare protocol control %" GST_PTR_FORMAT, message);
-      goto out;
+      return FALSE;
     }
   }
 
@@ -508,30 +541,70 @@ gst_rtmp_connection_start_write (GstRtmpConnection * self)
   if (!cstream) {
     GST_ERROR_OBJECT (self, "Failed to get chunk stream for %" GST_PTR_FORMAT,
         message);
-    goto out;
+    return FALSE;
   }
 
-  chunks = gst_rtmp_chunk_stream_serialize_all (cstream, message,
-      self->out_chunk_size);
-  if (!chunks) {
+  if (!gst_rtmp_chunk_stream_serialize_all (cstream, message,
+          self->out_chunk_size, chunks)) {
     GST_ERROR_OBJECT (self, "Failed to serialize %" GST_PTR_FORMAT, message);
-    goto out;
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static void
+gst_rtmp_connection_start_write (GstRtmpConnection * self)
+{
+  GOutputStream *os;
+  GstBuffer *message;
+  GstBufferList *chunks;
+  gsize batch_size = 0;
+  guint n_messages = 0;
+
+  if (self->writing) {
+    return;
+  }
+
+  chunks = gst_buffer_list_new ();
+
+  /* Everything queued so far goes out in one vectored write */
+  while (batch_size < MAX_WRITE_BATCH_SIZE &&
+      (message = g_async_queue_try_pop (self->output_queue))) {
+    gboolean protocol_control = gst_rtmp_message_is_protocol_control (message);
+
+    if (gst_rtmp_connection_serialize_message (self, message, chunks)) {
+      batch_size += gst_buffer_get_size (message);
+      n_messages++;
+    }
+
+    gst_buffer_unref (message);
+
+    /* A new chunk size only applies once the message has been written */
+    if (protocol_control) {
+      break;
+    }
   }
 
+  if (gst_buffer_list_length (chunks) == 0) {
+    gst_buffer_list_unref (chunks);
+    return;
+  }
+
+  GST_LOG_OBJECT (self, "writing %u messages in %u chunks", n_messages,
+      gst_buffer_list_length (chunks));
+
   self->writing = TRUE;
   if (self->output_handler) {
     self->output_handler (self, self->output_handler_user_data);
   }
 
   os = g_io_stream_get_output_stream (G_IO_STREAM (self->connection));
-  gst_rtmp_output_stream_write_all_buffer_async (os, chunks, G_PRIORITY_DEFAULT,
-      self->cancellable, gst_rtmp_connection_write_buffer_done,
-      g_object_ref (self));
+  gst_rtmp_output_stream_write_all_buffer_list_async (os, chunks,
+      G_PRIORITY_DEFAULT, self->cancellable,
+      gst_rtmp_connection_write_buffer_done, g_object_ref (self));
 
-  gst_buffer_unref (chunks);
-
-out:
-  gst_buffer_unref (message);
+  gst_buffer_list_unref (chunks);
 }
 
 static void
@@ -561,7 +634,7 @@ gst_rtmp_connection_write_buffer_done (GObject * obj,
 
   self->writing = FALSE;
 
-  res = gst_rtmp_output_stream_write_all_buffer_finish (os, result,
+  res = gst_rtmp_output_stream_write_all_buffer_list_finish (os, result,
       &bytes_written, &error);
 
   self->out_bytes_total += bytes_written;
@@ -604,6 +677,11 @@ gst_rtmp_connection_try_read (GstRtmpConnection * connection)
   guint need = connection->input_needed_bytes,
       len = connection->input_bytes->len;
 
+  if (connection->input_paused) {
+    GST_TRACE_OBJECT (connection, "input paused");
+    return;
+  }
+
   if (len < need) {
     GST_TRACE_OBJECT (connection, "got %u < %u bytes, need more", len, need);
     return;
@@ -672,6 +750,10 @@ gst_rtmp_connection_do_read (GstRtmpConnection * sc)
       GstBuffer *buffer = gst_rtmp_chunk_stream_parse_finish (cstream);
       gst_rtmp_connection_handle_message (sc, buffer);
       gst_buffer_unref (buffer);
+
+      if (sc->input_paused) {
+        break;
+      }
     }
   }
 
@@ -913,7 +995,8 @@ gst_rtmp_connection_handle_cm (GstRtmpConnection * sc, GstBuffer * buffer)
     GST_WARNING_OBJECT (sc,
         "Server sent command \"%s\" with extreme transaction ID %.0f",
         GST_STR_NULL (command_name), transaction_id);
-  } else if (transaction_id > sc->transaction_count) {
+  } else if (is_command_response (command_name) &&
+      transaction_id > sc->transaction_count) {
     GST_WARNING_OBJECT (sc,
         "Server sent command \"%s\" with unused transaction ID (%.0f > %u)",
         GST_STR_NULL (command_name), transaction_id, sc->transaction_count);
@@ -950,11 +1033,6 @@ gst_rtmp_connection_handle_cm (GstRtmpConnection * sc, GstBuffer * buffer)
   } else {
     GList *l;
 
-    if (transaction_id != 0) {
-      GST_FIXME_OBJECT (sc, "Server sent command \"%s\" expecting reply",
-          GST_STR_NULL (command_name));
-    }
-
     for (l = sc->expected_commands; l; l = g_list_next (l)) {
       ExpectedCommand *ec = l->data;
 
@@ -973,6 +1051,17 @@ gst_rtmp_connection_handle_cm (GstRtmpConnection * sc, GstBuffer * buffer)
       g_list_free_full (l, expected_command_free);
       break;
     }
+
+    if (!l) {
+      if (sc->input_handler) {
+        /* Commands nobody waits for are requests from the peer; let the
+         * input handler (e.g. the server side) answer them */
+        sc->input_handler (sc, buffer, sc->input_handler_user_data);
+      } else if (transaction_id != 0) {
+        GST_FIXME_OBJECT (sc, "Server sent command \"%s\" expecting reply",
+            GST_STR_NULL (command_name));
+      }
+    }
   }
 
   g_free (command_name);
@@ -1004,18 +1093,34 @@ gst_rtmp_connection_get_num_queued (GstRtmpConnection * connection)
   return g_async_queue_length (connection->output_queue);
 }
 
+static void
+gst_rtmp_connection_send_command_valist (GstRtmpConnection * connection,
+    gdouble transaction_id, guint32 stream_id, const gchar * command_name,
+    const GstAmfNode * argument, va_list ap)
+{
+  GstBuffer *buffer;
+  GBytes *payload;
+  guint8 *data;
+  gsize size;
+
+  payload = gst_amf_serialize_command_valist (transaction_id,
+      command_name, argument, ap);
+
+  data = g_bytes_unref_to_data (payload, &size);
+  buffer = gst_rtmp_message_new_wrapped (GST_RTMP_MESSAGE_TYPE_COMMAND_AMF0,
+      3, stream_id, data, size);
+
+  gst_rtmp_connection_queue_message (connection, buffer);
+}
+
 guint
 gst_rtmp_connection_send_command (GstRtmpConnection * connection,
     GstRtmpCommandCallback response_command, gpointer user_data,
     guint32 stream_id, const gchar * command_name, const GstAmfNode * argument,
     ...)
 {
-  GstBuffer *buffer;
   gdouble transaction_id = 0;
   va_list ap;
-  GBytes *payload;
-  guint8 *data;
-  gsize size;
 
   g_return_val_if_fail (GST_IS_RTMP_CONNECTION (connection), 0);
 
@@ -1041,18 +1146,37 @@ gst_rtmp_connection_send_command (GstRtmpConnection * connection,
   }
 
   va_start (ap, argument);
-  payload = gst_amf_serialize_command_valist (transaction_id,
-      command_name, argument, ap);
+  gst_rtmp_connection_send_command_valist (connection, transaction_id,
+      stream_id, command_name, argument, ap);
   va_end (ap);
 
-  data = g_bytes_unref_to_data (payload, &size);
-  buffer = gst_rtmp_message_new_wrapped (GST_RTMP_MESSAGE_TYPE_COMMAND_AMF0,
-      3, stream_id, data, size);
-
-  gst_rtmp_connection_queue_message (connection, buffer);
   return transaction_id;
 }
 
+void
+gst_rtmp_connection_send_response (GstRtmpConnection * connection,
+    gdouble transaction_id, guint32 stream_id, const gchar * command_name,
+    const GstAmfNode * argument, ...)
+{
+  va_list ap;
+
+  g_return_if_fail (GST_IS_RTMP_CONNECTION (connection));
+  g_return_if_fail (is_command_response (command_name));
+
+  if (connection->thread != g_thread_self ()) {
+    GST_ERROR_OBJECT (connection, "Called from wrong thread");
+  }
+
+  GST_DEBUG_OBJECT (connection,
+      "Sending response '%s' for transid %.0f on stream id %"
+      G_GUINT32_FORMAT, command_name, transaction_id, stream_id);
+
+  va_start (ap, argument);
+  gst_rtmp_connection_send_command_valist (connection, transaction_id,
+      stream_id, command_name, argument, ap);
+  va_end (ap);
+}
+
 void
 gst_rtmp_connection_expect_command (GstRtmpConnection * connection,
     GstRtmpCommandCallback response_command, gpointer user_data,
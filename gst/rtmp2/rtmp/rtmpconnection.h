@@ -66,6 +66,9 @@ void gst_rtmp_connection_set_output_handler (GstRtmpConnection * connection,
     GstRtmpConnectionFunc callback, gpointer user_data,
     GDestroyNotify user_data_destroy);
 
+void gst_rtmp_connection_set_input_paused (GstRtmpConnection * connection,
+    gboolean paused);
+
 void gst_rtmp_connection_queue_bytes (GstRtmpConnection *self,
     GBytes * bytes);
 void gst_rtmp_connection_queue_message (GstRtmpConnection * connection,
@@ -77,6 +80,10 @@ guint gst_rtmp_connection_send_command (GstRtmpConnection * connection,
     guint32 stream_id, const gchar * command_name, const GstAmfNode * argument,
     ...) G_GNUC_NULL_TERMINATED;
 
+void gst_rtmp_connection_send_response (GstRtmpConnection * connection,
+    gdouble transaction_id, guint32 stream_id, const gchar * command_name,
+    const GstAmfNode * argument, ...) G_GNUC_NULL_TERMINATED;
+
 void gst_rtmp_connection_expect_command (GstRtmpConnection * connection,
     GstRtmpCommandCallback response_command, gpointer user_data,
     guint32 stream_id, const gchar * command_name);
@@ -0,0 +1,487 @@
+/* GStreamer RTMP Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+#include <gio/gio.h>
+#include <string.h>
+#include "rtmpserver.h"
+#include "rtmphandshake.h"
+#include "rtmpmessage.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_rtmp_server_debug_category);
+#define GST_CAT_DEFAULT gst_rtmp_server_debug_category
+
+static void got_message (GstRtmpConnection * connection, GstBuffer * buffer,
+    gpointer user_data);
+
+static void
+init_debug (void)
+{
+  static volatile gsize done = 0;
+  if (g_once_init_enter (&done)) {
+    GST_DEBUG_CATEGORY_INIT (gst_rtmp_server_debug_category,
+        "rtmpserver", 0, "debug category for the rtmp server");
+    GST_DEBUG_REGISTER_FUNCPTR (got_message);
+    g_once_init_leave (&done, 1);
+  }
+}
+
+typedef struct
+{
+  GstRtmpConnection *connection;
+  gulong error_handler_id;
+  GSource *cancel_source;
+  gchar *application;
+  gchar *stream;
+  guint32 last_stream_id;
+  guint32 stream_id;
+} AcceptTaskData;
+
+static AcceptTaskData *
+accept_task_data_new (void)
+{
+  return g_slice_new0 (AcceptTaskData);
+}
+
+static void
+accept_task_data_free (gpointer ptr)
+{
+  AcceptTaskData *data = ptr;
+  if (data->cancel_source) {
+    g_source_destroy (data->cancel_source);
+    g_source_unref (data->cancel_source);
+  }
+  if (data->error_handler_id) {
+    g_signal_handler_disconnect (data->connection, data->error_handler_id);
+  }
+  g_clear_pointer (&data->connection, gst_rtmp_connection_close_and_unref);
+  g_clear_pointer (&data->application, g_free);
+  g_clear_pointer (&data->stream, g_free);
+  g_slice_free (AcceptTaskData, data);
+}
+
+/* Stops listening to the connection before the task returns; the task
+ * itself is released by the caller */
+static void
+accept_task_detach (GTask * task)
+{
+  AcceptTaskData *data = g_task_get_task_data (task);
+
+  if (data->cancel_source) {
+    g_source_destroy (data->cancel_source);
+    g_clear_pointer (&data->cancel_source, g_source_unref);
+  }
+
+  if (data->error_handler_id) {
+    g_signal_handler_disconnect (data->connection, data->error_handler_id);
+    data->error_handler_id = 0;
+  }
+
+  gst_rtmp_connection_set_input_handler (data->connection, NULL, NULL, NULL);
+}
+
+static void
+accept_task_return_error (GTask * task, GError * error)
+{
+  accept_task_detach (task);
+  g_task_return_error (task, error);
+  g_object_unref (task);
+}
+
+static void handshake_done (GObject * source, GAsyncResult * result,
+    gpointer user_data);
+
+void
+gst_rtmp_server_accept_async (GSocketConnection * socket_connection,
+    GCancellable * cancellable, GAsyncReadyCallback callback,
+    gpointer user_data)
+{
+  GTask *task;
+
+  g_return_if_fail (G_IS_SOCKET_CONNECTION (socket_connection));
+
+  init_debug ();
+
+  task = g_task_new (NULL, cancellable, callback, user_data);
+  g_task_set_task_data (task, accept_task_data_new (), accept_task_data_free);
+
+  gst_rtmp_server_handshake (G_IO_STREAM (socket_connection), FALSE,
+      cancellable, handshake_done, task);
+}
+
+static void
+connection_error (GstRtmpConnection * connection, gpointer user_data)
+{
+  GTask *task = user_data;
+
+  accept_task_return_error (task, g_error_new (G_IO_ERROR, G_IO_ERROR_FAILED,
+          "error while waiting for publish"));
+}
+
+static gboolean
+accept_cancelled (GCancellable * cancellable, gpointer user_data)
+{
+  GTask *task = user_data;
+
+  accept_task_return_error (task, g_error_new (G_IO_ERROR,
+          G_IO_ERROR_CANCELLED, "accept was cancelled"));
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+handshake_done (GObject * source, GAsyncResult * result, gpointer user_data)
+{
+  GIOStream *stream = G_IO_STREAM (source);
+  GSocketConnection *socket_connection = G_SOCKET_CONNECTION (stream);
+  GTask *task = user_data;
+  AcceptTaskData *data = g_task_get_task_data (task);
+  GCancellable *cancellable = g_task_get_cancellable (task);
+  GError *error = NULL;
+  gboolean res;
+
+  res = gst_rtmp_server_handshake_finish (stream, result, &error);
+  if (!res) {
+    g_io_stream_close_async (stream, G_PRIORITY_DEFAULT, NULL, NULL, NULL);
+    g_task_return_error (task, error);
+    g_object_unref (task);
+    return;
+  }
+
+  data->connection = gst_rtmp_connection_new (socket_connection);
+  data->error_handler_id = g_signal_connect (data->connection,
+      "error", G_CALLBACK (connection_error), task);
+  gst_rtmp_connection_set_input_handler (data->connection, got_message, task,
+      NULL);
+
+  /* The peer may never publish, so make cancellation reach us through the
+   * connection's main context */
+  if (cancellable) {
+    data->cancel_source = g_cancellable_source_new (cancellable);
+    g_source_set_callback (data->cancel_source, (GSourceFunc) accept_cancelled,
+        task, NULL);
+    g_source_attach (data->cancel_source, g_task_get_context (task));
+  }
+}
+
+static void
+send_connect_result (GstRtmpConnection * connection, gdouble transaction_id)
+{
+  GstAmfNode *properties, *info;
+
+  properties = gst_amf_node_new_object ();
+  gst_amf_node_append_field_string (properties, "fmsVer", "FMS/3,0,1,123", -1);
+  gst_amf_node_append_field_number (properties, "capabilities", 31);
+
+  info = gst_amf_node_new_object ();
+  gst_amf_node_append_field_string (info, "level", "status", -1);
+  gst_amf_node_append_field_string (info, "code",
+      "NetConnection.Connect.Success", -1);
+  gst_amf_node_append_field_string (info, "description",
+      "Connection succeeded.", -1);
+  gst_amf_node_append_field_number (info, "objectEncoding", 0);
+
+  /* Matches nginx-rtmp */
+  gst_rtmp_connection_request_window_size (connection,
+      GST_RTMP_DEFAULT_WINDOW_ACK_SIZE);
+  gst_rtmp_connection_send_response (connection, transaction_id, 0, "_result",
+      properties, info, NULL);
+
+  gst_amf_node_free (properties);
+  gst_amf_node_free (info);
+}
+
+static void
+send_result (GstRtmpConnection * connection, gdouble transaction_id,
+    const GstAmfNode * value)
+{
+  GstAmfNode *command_object = gst_amf_node_new_null ();
+
+  gst_rtmp_connection_send_response (connection, transaction_id, 0, "_result",
+      command_object, value, NULL);
+
+  gst_amf_node_free (command_object);
+}
+
+static void
+send_error (GstRtmpConnection * connection, gdouble transaction_id,
+    const gchar * code, const gchar * description)
+{
+  GstAmfNode *command_object, *info;
+
+  command_object = gst_amf_node_new_null ();
+  info = gst_amf_node_new_object ();
+  gst_amf_node_append_field_string (info, "level", "error", -1);
+  gst_amf_node_append_field_string (info, "code", code, -1);
+  gst_amf_node_append_field_string (info, "description", description, -1);
+
+  gst_rtmp_connection_send_response (connection, transaction_id, 0, "_error",
+      command_object, info, NULL);
+
+  gst_amf_node_free (command_object);
+  gst_amf_node_free (info);
+}
+
+static void
+send_publish_start (GstRtmpConnection * connection, guint32 stream_id,
+    const gchar * stream)
+{
+  GstRtmpUserControl uc = {
+    .type = GST_RTMP_USER_CONTROL_TYPE_STREAM_BEGIN,
+    .param = stream_id,
+  };
+  GstAmfNode *command_object, *info;
+
+  gst_rtmp_connection_queue_message (connection,
+      gst_rtmp_message_new_user_control (&uc));
+
+  command_object = gst_amf_node_new_null ();
+  info = gst_amf_node_new_object ();
+  gst_amf_node_append_field_string (info, "level", "status", -1);
+  gst_amf_node_append_field_string (info, "code", "NetStream.Publish.Start",
+      -1);
+  gst_amf_node_append_field_take_string (info, "description",
+      g_strdup_printf ("%s is now published.", stream), -1);
+
+  gst_rtmp_connection_send_command (connection, NULL, NULL, stream_id,
+      "onStatus", command_object, info, NULL);
+
+  gst_amf_node_free (command_object);
+  gst_amf_node_free (info);
+}
+
+static void
+handle_connect (GTask * task, gdouble transaction_id, GPtrArray * args)
+{
+  AcceptTaskData *data = g_task_get_task_data (task);
+  const GstAmfNode *node = NULL;
+
+  if (args->len > 0) {
+    node = gst_amf_node_get_field (g_ptr_array_index (args, 0), "app");
+  }
+
+  if (!node || gst_amf_node_get_type (node) != GST_AMF_TYPE_STRING) {
+    send_error (data->connection, transaction_id,
+        "NetConnection.Connect.Rejected", "Missing application name");
+    accept_task_return_error (task, g_error_new (G_IO_ERROR,
+            G_IO_ERROR_INVALID_DATA, "connect without application name"));
+    return;
+  }
+
+  g_free (data->application);
+  data->application = gst_amf_node_get_string (node, NULL);
+  GST_INFO ("Peer connected to application '%s'", data->application);
+
+  send_connect_result (data->connection, transaction_id);
+}
+
+static void
+handle_create_stream (GTask * task, gdouble transaction_id)
+{
+  AcceptTaskData *data = g_task_get_task_data (task);
+  GstAmfNode *stream_id;
+
+  data->last_stream_id++;
+  GST_INFO ("Created stream %" G_GUINT32_FORMAT, data->last_stream_id);
+
+  stream_id = gst_amf_node_new_number (data->last_stream_id);
+  send_result (data->connection, transaction_id, stream_id);
+  gst_amf_node_free (stream_id);
+}
+
+static void
+handle_publish (GTask * task, guint32 stream_id, GPtrArray * args)
+{
+  AcceptTaskData *data = g_task_get_task_data (task);
+  GstRtmpConnection *connection;
+  const GstAmfNode *node = NULL;
+
+  if (!data->application) {
+    accept_task_return_error (task, g_error_new (G_IO_ERROR,
+            G_IO_ERROR_INVALID_DATA, "publish before connect"));
+    return;
+  }
+
+  if (stream_id == 0 || stream_id > data->last_stream_id) {
+    accept_task_return_error (task, g_error_new (G_IO_ERROR,
+            G_IO_ERROR_INVALID_DATA, "publish on unknown stream %"
+            G_GUINT32_FORMAT, stream_id));
+    return;
+  }
+
+  if (args->len > 1) {
+    node = g_ptr_array_index (args, 1);
+  }
+
+  if (!node || gst_amf_node_get_type (node) != GST_AMF_TYPE_STRING) {
+    accept_task_return_error (task, g_error_new (G_IO_ERROR,
+            G_IO_ERROR_INVALID_DATA, "publish without stream name"));
+    return;
+  }
+
+  data->stream = gst_amf_node_get_string (node, NULL);
+  data->stream_id = stream_id;
+
+  GST_INFO ("Peer publishing '%s/%s' on stream %" G_GUINT32_FORMAT,
+      data->application, data->stream, stream_id);
+
+  send_publish_start (data->connection, stream_id, data->stream);
+
+  /* We are dispatched from the connection's own source, so the task
+   * completes synchronously and the caller installs its input handler
+   * before the first media message is parsed */
+  accept_task_detach (task);
+  connection = data->connection;
+  data->connection = NULL;
+  g_task_return_pointer (task, connection, gst_rtmp_connection_close_and_unref);
+  g_object_unref (task);
+}
+
+static void
+got_message (GstRtmpConnection * connection, GstBuffer * buffer,
+    gpointer user_data)
+{
+  GTask *task = user_data;
+  AcceptTaskData *data = g_task_get_task_data (task);
+  GstRtmpMeta *meta = gst_buffer_get_rtmp_meta (buffer);
+  gdouble transaction_id;
+  gchar *command_name;
+  GPtrArray *args;
+
+  g_return_if_fail (meta);
+
+  if (meta->type != GST_RTMP_MESSAGE_TYPE_COMMAND_AMF0) {
+    GST_DEBUG ("Ignoring %s message before publish",
+        gst_rtmp_message_type_get_nick (meta->type));
+    return;
+  }
+
+  {
+    GstMapInfo map;
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    args = gst_amf_parse_command (map.data, map.size, &transaction_id,
+        &command_name);
+    gst_buffer_unmap (buffer, &map);
+  }
+
+  if (!args) {
+    return;
+  }
+
+  GST_DEBUG ("Got command '%s' transaction %.0f on stream %" G_GUINT32_FORMAT,
+      GST_STR_NULL (command_name), transaction_id, meta->mstream);
+
+  if (g_strcmp0 (command_name, "connect") == 0) {
+    handle_connect (task, transaction_id, args);
+  } else if (g_strcmp0 (command_name, "createStream") == 0) {
+    handle_create_stream (task, transaction_id);
+  } else if (g_strcmp0 (command_name, "publish") == 0) {
+    handle_publish (task, meta->mstream, args);
+  } else if (g_strcmp0 (command_name, "play") == 0) {
+    send_error (data->connection, transaction_id,
+        "NetStream.Play.Failed", "Playback is not supported");
+    accept_task_return_error (task, g_error_new (G_IO_ERROR,
+            G_IO_ERROR_NOT_SUPPORTED, "peer attempted to play"));
+  } else if (transaction_id != 0) {
+    /* releaseStream, FCPublish and friends; nothing to do for us */
+    GstAmfNode *null = gst_amf_node_new_null ();
+    send_result (data->connection, transaction_id, null);
+    gst_amf_node_free (null);
+  }
+
+  g_free (command_name);
+  g_ptr_array_unref (args);
+}
+
+GstRtmpConnection *
+gst_rtmp_server_accept_finish (GAsyncResult * result, gchar ** application,
+    gchar ** stream, guint * stream_id, GError ** error)
+{
+  GTask *task;
+  AcceptTaskData *data;
+  GstRtmpConnection *connection;
+
+  g_return_val_if_fail (g_task_is_valid (result, NULL), NULL);
+
+  task = G_TASK (result);
+  data = g_task_get_task_data (task);
+
+  connection = g_task_propagate_pointer (task, error);
+  if (!connection) {
+    return NULL;
+  }
+
+  if (application) {
+    *application = g_strdup (data->application);
+  }
+
+  if (stream) {
+    *stream = g_strdup (data->stream);
+  }
+
+  if (stream_id) {
+    *stream_id = data->stream_id;
+  }
+
+  return connection;
+}
+
+gboolean
+gst_rtmp_server_is_unpublish (GstBuffer * message, guint stream_id)
+{
+  GstRtmpMeta *meta = gst_buffer_get_rtmp_meta (message);
+  gchar *command_name = NULL;
+  gboolean ret = FALSE;
+  GPtrArray *args;
+
+  g_return_val_if_fail (meta, FALSE);
+
+  if (meta->type != GST_RTMP_MESSAGE_TYPE_COMMAND_AMF0) {
+    return FALSE;
+  }
+
+  {
+    GstMapInfo map;
+    gst_buffer_map (message, &map, GST_MAP_READ);
+    args = gst_amf_parse_command (map.data, map.size, NULL, &command_name);
+    gst_buffer_unmap (message, &map);
+  }
+
+  if (!args) {
+    return FALSE;
+  }
+
+  if (g_strcmp0 (command_name, "FCUnpublish") == 0) {
+    ret = TRUE;
+  } else if (g_strcmp0 (command_name, "closeStream") == 0) {
+    ret = meta->mstream == stream_id;
+  } else if (g_strcmp0 (command_name, "deleteStream") == 0 && args->len > 1) {
+    const GstAmfNode *node = g_ptr_array_index (args, 1);
+
+    ret = gst_amf_node_get_type (node) == GST_AMF_TYPE_NUMBER &&
+        gst_amf_node_get_number (node) == stream_id;
+  }
+
+  g_free (command_name);
+  g_ptr_array_unref (args);
+  return ret;
+}
@@ -0,0 +1,36 @@
+/* GStreamer RTMP Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _GST_RTMP_SERVER_H_
+#define _GST_RTMP_SERVER_H_
+
+#include "rtmpconnection.h"
+
+G_BEGIN_DECLS
+
+void gst_rtmp_server_accept_async (GSocketConnection * socket_connection,
+    GCancellable * cancellable, GAsyncReadyCallback callback,
+    gpointer user_data);
+GstRtmpConnection *gst_rtmp_server_accept_finish (GAsyncResult * result,
+    gchar ** application, gchar ** stream, guint * stream_id, GError ** error);
+
+gboolean gst_rtmp_server_is_unpublish (GstBuffer * message,
+    guint stream_id);
+
+G_END_DECLS
+#endif
@@ -0,0 +1,529 @@
+/* GStreamer RTP packet batching
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:element-rtpbatch
+ * @title: rtpbatch
+ *
+ * rtpbatch collects incoming packets into #GstBufferList batches of up to
+ * #GstRtpBatch:max-packets packets, waiting at most
+ * #GstRtpBatch:max-latency for a batch to fill up. Placed in front of
+ * udpsink, this lets the sink send a whole batch with a single
+ * sendmmsg() call instead of one system call per packet.
+ *
+ * Batches are pushed from a separate streaming thread, so that a partially
+ * filled batch is still sent once its latency budget expires even if no
+ * other packet arrives. Serialized events flush the current batch before
+ * they are forwarded, so ordering with the data flow is preserved.
+ *
+ * This element is used internally by rtpsink and ristsink when their
+ * batch-size property is larger than 1.
+ *
+ * Since: 1.18
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "gstrtpbatch.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_rtp_batch_debug);
+#define GST_CAT_DEFAULT gst_rtp_batch_debug
+
+#define DEFAULT_PROP_MAX_PACKETS      32
+#define DEFAULT_PROP_MAX_LATENCY      (1 * GST_MSECOND)
+
+/* number of complete batches that may wait for the streaming thread before
+ * upstream is blocked */
+#define MAX_QUEUED_LISTS              2
+
+enum
+{
+  PROP_0,
+
+  PROP_MAX_PACKETS,
+  PROP_MAX_LATENCY,
+
+  PROP_LAST
+};
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+#define gst_rtp_batch_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstRtpBatch, gst_rtp_batch, GST_TYPE_ELEMENT,
+    GST_DEBUG_CATEGORY_INIT (gst_rtp_batch_debug, "rtpbatch", 0,
+        "RTP packet batching"));
+
+#define GST_RTP_BATCH_LOCK(obj) (g_mutex_lock (&((GstRtpBatch*)(obj))->lock))
+#define GST_RTP_BATCH_UNLOCK(obj) (g_mutex_unlock (&((GstRtpBatch*)(obj))->lock))
+
+static void gst_rtp_batch_loop (GstRtpBatch * self);
+
+static void
+gst_rtp_batch_clear_queue (GstRtpBatch * self)
+{
+  GstMiniObject *item;
+
+  while ((item = g_queue_pop_head (&self->queue)))
+    gst_mini_object_unref (item);
+  self->queued_lists = 0;
+
+  if (self->pending) {
+    gst_buffer_list_unref (self->pending);
+    self->pending = NULL;
+  }
+}
+
+/* must be called with the lock */
+static void
+gst_rtp_batch_close_pending (GstRtpBatch * self)
+{
+  if (self->pending == NULL)
+    return;
+
+  g_queue_push_tail (&self->queue, self->pending);
+  self->queued_lists++;
+  self->pending = NULL;
+  g_cond_broadcast (&self->cond);
+}
+
+/* must be called with the lock, takes ownership of @buffer */
+static void
+gst_rtp_batch_add_buffer (GstRtpBatch * self, GstBuffer * buffer)
+{
+  if (self->pending == NULL) {
+    self->pending = gst_buffer_list_new_sized (self->max_packets);
+    self->pending_deadline = g_get_monotonic_time () +
+        self->max_latency / GST_USECOND;
+    /* wake up the streaming thread so it starts waiting on the deadline */
+    g_cond_broadcast (&self->cond);
+  }
+
+  gst_buffer_list_add (self->pending, buffer);
+  if (gst_buffer_list_length (self->pending) >= self->max_packets)
+    gst_rtp_batch_close_pending (self);
+}
+
+/* must be called with the lock */
+static GstFlowReturn
+gst_rtp_batch_wait_space (GstRtpBatch * self)
+{
+  while (!self->flushing && self->srcresult == GST_FLOW_OK &&
+      self->queued_lists >= MAX_QUEUED_LISTS)
+    g_cond_wait (&self->cond, &self->lock);
+
+  if (self->flushing)
+    return GST_FLOW_FLUSHING;
+
+  return self->srcresult;
+}
+
+static GstFlowReturn
+gst_rtp_batch_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstRtpBatch *self = GST_RTP_BATCH (parent);
+  GstFlowReturn ret;
+
+  GST_RTP_BATCH_LOCK (self);
+  ret = gst_rtp_batch_wait_space (self);
+  if (ret == GST_FLOW_OK)
+    gst_rtp_batch_add_buffer (self, buffer);
+  else
+    gst_buffer_unref (buffer);
+  GST_RTP_BATCH_UNLOCK (self);
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_rtp_batch_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstRtpBatch *self = GST_RTP_BATCH (parent);
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint i, len;
+
+  len = gst_buffer_list_length (list);
+
+  GST_RTP_BATCH_LOCK (self);
+  for (i = 0; i < len; i++) {
+    ret = gst_rtp_batch_wait_space (self);
+    if (ret != GST_FLOW_OK)
+      break;
+
+    gst_rtp_batch_add_buffer (self,
+        gst_buffer_ref (gst_buffer_list_get (list, i)));
+  }
+  GST_RTP_BATCH_UNLOCK (self);
+
+  gst_buffer_list_unref (list);
+
+  return ret;
+}
+
+static gboolean
+gst_rtp_batch_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstRtpBatch *self = GST_RTP_BATCH (parent);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_FLUSH_START:
+      GST_RTP_BATCH_LOCK (self);
+      self->flushing = TRUE;
+      g_cond_broadcast (&self->cond);
+      GST_RTP_BATCH_UNLOCK (self);
+
+      gst_pad_push_event (self->srcpad, event);
+      gst_pad_pause_task (self->srcpad);
+      return TRUE;
+    case GST_EVENT_FLUSH_STOP:
+      gst_pad_push_event (self->srcpad, event);
+
+      GST_RTP_BATCH_LOCK (self);
+      gst_rtp_batch_clear_queue (self);
+      self->flushing = FALSE;
+      self->srcresult = GST_FLOW_OK;
+      GST_RTP_BATCH_UNLOCK (self);
+
+      return gst_pad_start_task (self->srcpad,
+          (GstTaskFunction) gst_rtp_batch_loop, self, NULL);
+    default:
+      break;
+  }
+
+  if (!GST_EVENT_IS_SERIALIZED (event))
+    return gst_pad_event_default (pad, parent, event);
+
+  /* serialized events terminate the current batch and are pushed in order
+   * with the data by the streaming thread */
+  GST_RTP_BATCH_LOCK (self);
+  if (self->flushing) {
+    GST_RTP_BATCH_UNLOCK (self);
+    gst_event_unref (event);
+    return FALSE;
+  }
+  gst_rtp_batch_close_pending (self);
+  g_queue_push_tail (&self->queue, event);
+  g_cond_broadcast (&self->cond);
+  GST_RTP_BATCH_UNLOCK (self);
+
+  return TRUE;
+}
+
+static gboolean
+gst_rtp_batch_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstRtpBatch *self = GST_RTP_BATCH (parent);
+
+  if (GST_QUERY_IS_SERIALIZED (query)) {
+    gboolean flushing;
+
+    /* drain everything before the query so it is answered in order */
+    GST_RTP_BATCH_LOCK (self);
+    gst_rtp_batch_close_pending (self);
+    while (!self->flushing && self->srcresult == GST_FLOW_OK &&
+        (self->pushing || !g_queue_is_empty (&self->queue)))
+      g_cond_wait (&self->cond, &self->lock);
+    flushing = self->flushing;
+    GST_RTP_BATCH_UNLOCK (self);
+
+    if (flushing)
+      return FALSE;
+  }
+
+  return gst_pad_query_default (pad, parent, query);
+}
+
+static gboolean
+gst_rtp_batch_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstRtpBatch *self = GST_RTP_BATCH (parent);
+  gboolean ret;
+
+  ret = gst_pad_query_default (pad, parent, query);
+
+  if (ret && GST_QUERY_TYPE (query) == GST_QUERY_LATENCY) {
+    GstClockTime min, max;
+    gboolean live;
+
+    gst_query_parse_latency (query, &live, &min, &max);
+
+    GST_RTP_BATCH_LOCK (self);
+    min += self->max_latency;
+    if (GST_CLOCK_TIME_IS_VALID (max))
+      max += self->max_latency;
+    GST_RTP_BATCH_UNLOCK (self);
+
+    gst_query_set_latency (query, live, min, max);
+  }
+
+  return ret;
+}
+
+static void
+gst_rtp_batch_loop (GstRtpBatch * self)
+{
+  GstMiniObject *item = NULL;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  GST_RTP_BATCH_LOCK (self);
+  while (!self->flushing) {
+    item = g_queue_pop_head (&self->queue);
+    if (item) {
+      if (GST_IS_BUFFER_LIST (item))
+        self->queued_lists--;
+      break;
+    }
+
+    if (self->pending) {
+      if (g_get_monotonic_time () >= self->pending_deadline) {
+        item = GST_MINI_OBJECT_CAST (self->pending);
+        self->pending = NULL;
+        break;
+      }
+      g_cond_wait_until (&self->cond, &self->lock, self->pending_deadline);
+    } else {
+      g_cond_wait (&self->cond, &self->lock);
+    }
+  }
+
+  if (self->flushing)
+    goto flushing;
+
+  self->pushing = TRUE;
+  g_cond_broadcast (&self->cond);
+  GST_RTP_BATCH_UNLOCK (self);
+
+  if (GST_IS_BUFFER_LIST (item)) {
+    GstBufferList *list = GST_BUFFER_LIST_CAST (item);
+
+    GST_LOG_OBJECT (self, "pushing batch of %u packets",
+        gst_buffer_list_length (list));
+    ret = gst_pad_push_list (self->srcpad, list);
+  } else {
+    gst_pad_push_event (self->srcpad, GST_EVENT_CAST (item));
+  }
+
+  GST_RTP_BATCH_LOCK (self);
+  self->pushing = FALSE;
+  if (ret != GST_FLOW_OK)
+    self->srcresult = ret;
+  g_cond_broadcast (&self->cond);
+  GST_RTP_BATCH_UNLOCK (self);
+
+  if (ret == GST_FLOW_OK)
+    return;
+
+  GST_DEBUG_OBJECT (self, "pausing task, reason %s", gst_flow_get_name (ret));
+  gst_pad_pause_task (self->srcpad);
+
+  if (ret == GST_FLOW_NOT_LINKED || ret < GST_FLOW_EOS) {
+    GST_ELEMENT_FLOW_ERROR (self, ret);
+    gst_pad_push_event (self->srcpad, gst_event_new_eos ());
+  }
+  return;
+
+flushing:
+  {
+    GST_RTP_BATCH_UNLOCK (self);
+    GST_DEBUG_OBJECT (self, "pausing task, flushing");
+    gst_pad_pause_task (self->srcpad);
+    return;
+  }
+}
+
+static gboolean
+gst_rtp_batch_src_activate_mode (GstPad * pad, GstObject * parent,
+    GstPadMode mode, gboolean active)
+{
+  GstRtpBatch *self = GST_RTP_BATCH (parent);
+  gboolean ret;
+
+  if (mode != GST_PAD_MODE_PUSH)
+    return FALSE;
+
+  if (active) {
+    GST_RTP_BATCH_LOCK (self);
+    self->flushing = FALSE;
+    self->srcresult = GST_FLOW_OK;
+    GST_RTP_BATCH_UNLOCK (self);
+
+    ret = gst_pad_start_task (pad, (GstTaskFunction) gst_rtp_batch_loop, self,
+        NULL);
+  } else {
+    GST_RTP_BATCH_LOCK (self);
+    self->flushing = TRUE;
+    g_cond_broadcast (&self->cond);
+    GST_RTP_BATCH_UNLOCK (self);
+
+    ret = gst_pad_stop_task (pad);
+
+    GST_RTP_BATCH_LOCK (self);
+    gst_rtp_batch_clear_queue (self);
+    GST_RTP_BATCH_UNLOCK (self);
+  }
+
+  return ret;
+}
+
+static void
+gst_rtp_batch_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpBatch *self = GST_RTP_BATCH (object);
+
+  switch (prop_id) {
+    case PROP_MAX_PACKETS:
+      GST_RTP_BATCH_LOCK (self);
+      self->max_packets = g_value_get_uint (value);
+      GST_RTP_BATCH_UNLOCK (self);
+      break;
+    case PROP_MAX_LATENCY:
+      GST_RTP_BATCH_LOCK (self);
+      self->max_latency = g_value_get_uint64 (value);
+      GST_RTP_BATCH_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_batch_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpBatch *self = GST_RTP_BATCH (object);
+
+  switch (prop_id) {
+    case PROP_MAX_PACKETS:
+      GST_RTP_BATCH_LOCK (self);
+      g_value_set_uint (value, self->max_packets);
+      GST_RTP_BATCH_UNLOCK (self);
+      break;
+    case PROP_MAX_LATENCY:
+      GST_RTP_BATCH_LOCK (self);
+      g_value_set_uint64 (value, self->max_latency);
+      GST_RTP_BATCH_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_batch_finalize (GObject * object)
+{
+  GstRtpBatch *self = GST_RTP_BATCH (object);
+
+  gst_rtp_batch_clear_queue (self);
+  g_mutex_clear (&self->lock);
+  g_cond_clear (&self->cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_rtp_batch_class_init (GstRtpBatchClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+
+  gobject_class->set_property = gst_rtp_batch_set_property;
+  gobject_class->get_property = gst_rtp_batch_get_property;
+  gobject_class->finalize = gst_rtp_batch_finalize;
+
+  /**
+   * GstRtpBatch:max-packets:
+   *
+   * Maximum number of packets collected in one batch.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_PACKETS,
+      g_param_spec_uint ("max-packets", "Max packets",
+          "Maximum number of packets collected in one batch", 1, 1024,
+          DEFAULT_PROP_MAX_PACKETS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpBatch:max-latency:
+   *
+   * Maximum time the first packet of a batch waits for the batch to fill
+   * up, in nanoseconds. This is added to the reported latency.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_LATENCY,
+      g_param_spec_uint64 ("max-latency", "Max latency",
+          "Maximum time in nanoseconds a packet waits for its batch to fill",
+          0, G_MAXUINT64, DEFAULT_PROP_MAX_LATENCY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_static_pad_template (gstelement_class,
+      &sink_template);
+  gst_element_class_add_static_pad_template (gstelement_class, &src_template);
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "RTP packet batcher", "Generic",
+      "Collects packets into buffer lists for batched sending",
+      "GStreamer maintainers <gstreamer-devel@lists.freedesktop.org>");
+}
+
+static void
+gst_rtp_batch_init (GstRtpBatch * self)
+{
+  self->sinkpad = gst_pad_new_from_static_template (&sink_template, "sink");
+  gst_pad_set_chain_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_batch_chain));
+  gst_pad_set_chain_list_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_batch_chain_list));
+  gst_pad_set_event_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_batch_sink_event));
+  gst_pad_set_query_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_batch_sink_query));
+  GST_PAD_SET_PROXY_CAPS (self->sinkpad);
+  GST_PAD_SET_PROXY_ALLOCATION (self->sinkpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
+
+  self->srcpad = gst_pad_new_from_static_template (&src_template, "src");
+  gst_pad_set_activatemode_function (self->srcpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_batch_src_activate_mode));
+  gst_pad_set_query_function (self->srcpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_batch_src_query));
+  GST_PAD_SET_PROXY_CAPS (self->srcpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
+
+  self->max_packets = DEFAULT_PROP_MAX_PACKETS;
+  self->max_latency = DEFAULT_PROP_MAX_LATENCY;
+
+  g_mutex_init (&self->lock);
+  g_cond_init (&self->cond);
+  g_queue_init (&self->queue);
+  self->srcresult = GST_FLOW_FLUSHING;
+  self->flushing = TRUE;
+}
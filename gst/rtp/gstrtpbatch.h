@@ -0,0 +1,72 @@
+/* GStreamer RTP packet batching
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_RTP_BATCH_H__
+#define __GST_RTP_BATCH_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+#define GST_TYPE_RTP_BATCH \
+  (gst_rtp_batch_get_type())
+#define GST_RTP_BATCH(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST ((obj), GST_TYPE_RTP_BATCH, GstRtpBatch))
+#define GST_RTP_BATCH_CAST(obj) \
+  ((GstRtpBatch *) obj)
+#define GST_RTP_BATCH_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST ((klass), GST_TYPE_RTP_BATCH, GstRtpBatchClass))
+#define GST_IS_RTP_BATCH(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GST_TYPE_RTP_BATCH))
+#define GST_IS_RTP_BATCH_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE ((klass), GST_TYPE_RTP_BATCH))
+
+typedef struct _GstRtpBatch GstRtpBatch;
+typedef struct _GstRtpBatchClass GstRtpBatchClass;
+
+struct _GstRtpBatch
+{
+  GstElement parent;
+
+  GstPad *sinkpad;
+  GstPad *srcpad;
+
+  /* Properties */
+  guint max_packets;
+  GstClockTime max_latency;
+
+  /* Protected by lock */
+  GMutex lock;
+  GCond cond;
+  GQueue queue;                 /* complete GstBufferList or GstEvent */
+  guint queued_lists;
+  GstBufferList *pending;
+  gint64 pending_deadline;
+  gboolean pushing;
+  gboolean flushing;
+  GstFlowReturn srcresult;
+};
+
+struct _GstRtpBatchClass
+{
+  GstElementClass parent;
+};
+
+GType gst_rtp_batch_get_type (void);
+
+G_END_DECLS
+#endif /* __GST_RTP_BATCH_H__ */
@@ -0,0 +1,523 @@
+/* GStreamer RTP packet batching
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:element-rtpbatchsrc
+ * @title: rtpbatchsrc
+ *
+ * rtpbatchsrc reads datagrams from an already bound #GSocket and pushes
+ * everything that is pending on the socket as one #GstBufferList, receiving
+ * up to #GstRtpBatchSrc:max-packets datagrams with a single recvmmsg() call.
+ * It never waits for more packets than are already queued in the kernel, so
+ * batching does not add latency.
+ *
+ * This element is used internally by rtpsrc and ristsrc when their
+ * batch-size property is larger than 1. The socket is opened, bound and
+ * joined to any multicast group by their udpsrc, which is then kept in the
+ * READY state.
+ *
+ * Since: 1.18
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <gst/net/net.h>
+
+#include "gstrtpbatchsrc.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_rtp_batch_src_debug);
+#define GST_CAT_DEFAULT gst_rtp_batch_src_debug
+
+#define DEFAULT_PROP_MAX_PACKETS      32
+#define DEFAULT_PROP_MTU              1500
+
+enum
+{
+  PROP_0,
+
+  PROP_SOCKET,
+  PROP_CAPS,
+  PROP_MAX_PACKETS,
+  PROP_MTU,
+
+  PROP_LAST
+};
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+#define gst_rtp_batch_src_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstRtpBatchSrc, gst_rtp_batch_src, GST_TYPE_PUSH_SRC,
+    GST_DEBUG_CATEGORY_INIT (gst_rtp_batch_src_debug, "rtpbatchsrc", 0,
+        "RTP batched socket source"));
+
+static void
+gst_rtp_batch_src_free_messages (GstRtpBatchSrc * self)
+{
+  guint i;
+
+  for (i = 0; i < self->n_allocated; i++)
+    gst_clear_buffer (&self->buffers[i]);
+
+  g_clear_pointer (&self->buffers, g_free);
+  g_clear_pointer (&self->maps, g_free);
+  g_clear_pointer (&self->vectors, g_free);
+  g_clear_pointer (&self->messages, g_free);
+  g_clear_pointer (&self->addresses, g_free);
+  self->n_allocated = 0;
+}
+
+/* Maps one mtu sized buffer per message; buffers that did not receive
+ * anything are kept for the next call */
+static void
+gst_rtp_batch_src_map_messages (GstRtpBatchSrc * self)
+{
+  guint i;
+
+  for (i = 0; i < self->n_allocated; i++) {
+    GInputMessage *msg = &self->messages[i];
+
+    if (self->buffers[i] == NULL)
+      self->buffers[i] = gst_buffer_new_allocate (NULL, self->mtu, NULL);
+
+    gst_buffer_map (self->buffers[i], &self->maps[i], GST_MAP_WRITE);
+    self->vectors[i].buffer = self->maps[i].data;
+    self->vectors[i].size = self->maps[i].size;
+    self->addresses[i] = NULL;
+
+    msg->address = &self->addresses[i];
+    msg->vectors = &self->vectors[i];
+    msg->num_vectors = 1;
+    msg->bytes_received = 0;
+    msg->flags = 0;
+    msg->control_messages = NULL;
+    msg->num_control_messages = NULL;
+  }
+}
+
+static void
+gst_rtp_batch_src_unmap_messages (GstRtpBatchSrc * self)
+{
+  guint i;
+
+  for (i = 0; i < self->n_allocated; i++) {
+    gst_buffer_unmap (self->buffers[i], &self->maps[i]);
+    g_clear_object (&self->addresses[i]);
+  }
+}
+
+/* Returns the number of received messages, or -1 with @err set */
+static gint
+gst_rtp_batch_src_receive (GstRtpBatchSrc * self, GError ** err)
+{
+#if GLIB_CHECK_VERSION(2,48,0)
+  return g_socket_receive_messages (self->socket, self->messages,
+      self->n_allocated, 0, self->cancellable, err);
+#else
+  gint i;
+
+  /* No recvmmsg() wrapper, still drain the socket into a single list */
+  for (i = 0; i < self->n_allocated; i++) {
+    GInputMessage *msg = &self->messages[i];
+    GError *tmp_err = NULL;
+    gint flags = 0;
+    gssize ret;
+
+    ret = g_socket_receive_message (self->socket, msg->address, msg->vectors,
+        msg->num_vectors, NULL, NULL, &flags, self->cancellable, &tmp_err);
+    if (ret < 0) {
+      if (i > 0 && g_error_matches (tmp_err, G_IO_ERROR,
+              G_IO_ERROR_WOULD_BLOCK)) {
+        g_error_free (tmp_err);
+        break;
+      }
+      g_propagate_error (err, tmp_err);
+      return -1;
+    }
+    msg->bytes_received = ret;
+  }
+
+  return i;
+#endif
+}
+
+static GstBuffer *
+gst_rtp_batch_src_take_buffer (GstRtpBatchSrc * self, guint i,
+    GstClockTime timestamp)
+{
+  GstBuffer *buffer = self->buffers[i];
+
+  self->buffers[i] = NULL;
+  gst_buffer_unmap (buffer, &self->maps[i]);
+  gst_buffer_resize (buffer, 0, self->messages[i].bytes_received);
+
+  if (self->messages[i].bytes_received == self->mtu)
+    GST_WARNING_OBJECT (self, "packet of %u bytes fills the whole buffer and "
+        "may have been truncated, consider increasing mtu", self->mtu);
+
+  if (self->addresses[i]) {
+    gst_buffer_add_net_address_meta (buffer, self->addresses[i]);
+    g_clear_object (&self->addresses[i]);
+  }
+
+  GST_BUFFER_PTS (buffer) = timestamp;
+  GST_BUFFER_DTS (buffer) = timestamp;
+
+  return buffer;
+}
+
+static GstClockTime
+gst_rtp_batch_src_get_running_time (GstRtpBatchSrc * self)
+{
+  GstClock *clock;
+  GstClockTime base_time, now;
+
+  GST_OBJECT_LOCK (self);
+  clock = GST_ELEMENT_CLOCK (self);
+  if (clock == NULL) {
+    GST_OBJECT_UNLOCK (self);
+    return GST_CLOCK_TIME_NONE;
+  }
+  gst_object_ref (clock);
+  base_time = GST_ELEMENT_CAST (self)->base_time;
+  GST_OBJECT_UNLOCK (self);
+
+  now = gst_clock_get_time (clock);
+  gst_object_unref (clock);
+
+  return now > base_time ? now - base_time : 0;
+}
+
+static GstFlowReturn
+gst_rtp_batch_src_create (GstPushSrc * psrc, GstBuffer ** buf)
+{
+  GstRtpBatchSrc *self = GST_RTP_BATCH_SRC (psrc);
+  GstClockTime timestamp;
+  GError *err = NULL;
+  gint i, n;
+
+retry:
+  if (!g_socket_condition_timed_wait (self->socket, G_IO_IN | G_IO_PRI, -1,
+          self->cancellable, &err)) {
+    if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED) ||
+        g_error_matches (err, G_IO_ERROR, G_IO_ERROR_BUSY))
+      goto stopped;
+    goto receive_error;
+  }
+
+  gst_rtp_batch_src_map_messages (self);
+  n = gst_rtp_batch_src_receive (self, &err);
+  if (n <= 0) {
+    gst_rtp_batch_src_unmap_messages (self);
+
+    if (n == 0 || g_error_matches (err, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK) ||
+        g_error_matches (err, G_IO_ERROR, G_IO_ERROR_HOST_UNREACHABLE) ||
+        g_error_matches (err, G_IO_ERROR, G_IO_ERROR_NETWORK_UNREACHABLE) ||
+        g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CONNECTION_REFUSED)) {
+      /* spurious wakeup or ICMP error from a previous send, ignore */
+      GST_DEBUG_OBJECT (self, "ignoring receive error: %s",
+          err ? err->message : "no data");
+      g_clear_error (&err);
+      goto retry;
+    }
+    if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      goto stopped;
+    goto receive_error;
+  }
+
+  timestamp = gst_rtp_batch_src_get_running_time (self);
+
+  GST_LOG_OBJECT (self, "received %d packets", n);
+
+  if (n == 1) {
+    *buf = gst_rtp_batch_src_take_buffer (self, 0, timestamp);
+  } else {
+    GstBufferList *list = gst_buffer_list_new_sized (n);
+
+    for (i = 0; i < n; i++)
+      gst_buffer_list_add (list, gst_rtp_batch_src_take_buffer (self, i,
+              timestamp));
+    gst_base_src_submit_buffer_list (GST_BASE_SRC (self), list);
+  }
+
+  /* the remaining buffers are kept for the next receive */
+  for (i = n; i < self->n_allocated; i++)
+    gst_buffer_unmap (self->buffers[i], &self->maps[i]);
+
+  return GST_FLOW_OK;
+
+stopped:
+  {
+    GST_DEBUG_OBJECT (self, "stop called");
+    g_clear_error (&err);
+    return GST_FLOW_FLUSHING;
+  }
+receive_error:
+  {
+    GST_ELEMENT_ERROR (self, RESOURCE, READ, (NULL),
+        ("receive error: %s", err->message));
+    g_clear_error (&err);
+    return GST_FLOW_ERROR;
+  }
+}
+
+static GstCaps *
+gst_rtp_batch_src_get_caps (GstBaseSrc * src, GstCaps * filter)
+{
+  GstRtpBatchSrc *self = GST_RTP_BATCH_SRC (src);
+  GstCaps *caps, *result;
+
+  GST_OBJECT_LOCK (self);
+  if (self->caps)
+    caps = gst_caps_ref (self->caps);
+  else
+    caps = gst_caps_new_any ();
+  GST_OBJECT_UNLOCK (self);
+
+  if (filter) {
+    result = gst_caps_intersect_full (filter, caps, GST_CAPS_INTERSECT_FIRST);
+    gst_caps_unref (caps);
+  } else {
+    result = caps;
+  }
+
+  return result;
+}
+
+static gboolean
+gst_rtp_batch_src_start (GstBaseSrc * src)
+{
+  GstRtpBatchSrc *self = GST_RTP_BATCH_SRC (src);
+
+  if (self->socket == NULL) {
+    GST_ELEMENT_ERROR (self, RESOURCE, OPEN_READ, (NULL),
+        ("No socket configured"));
+    return FALSE;
+  }
+
+  /* readiness is waited for with g_socket_condition_timed_wait(), the
+   * receive itself must only return what is already queued */
+  g_socket_set_blocking (self->socket, FALSE);
+
+  self->n_allocated = self->max_packets;
+  self->buffers = g_new0 (GstBuffer *, self->n_allocated);
+  self->maps = g_new0 (GstMapInfo, self->n_allocated);
+  self->vectors = g_new0 (GInputVector, self->n_allocated);
+  self->messages = g_new0 (GInputMessage, self->n_allocated);
+  self->addresses = g_new0 (GSocketAddress *, self->n_allocated);
+
+  return TRUE;
+}
+
+static gboolean
+gst_rtp_batch_src_stop (GstBaseSrc * src)
+{
+  GstRtpBatchSrc *self = GST_RTP_BATCH_SRC (src);
+
+  gst_rtp_batch_src_free_messages (self);
+
+  return TRUE;
+}
+
+static gboolean
+gst_rtp_batch_src_unlock (GstBaseSrc * src)
+{
+  GstRtpBatchSrc *self = GST_RTP_BATCH_SRC (src);
+
+  g_cancellable_cancel (self->cancellable);
+
+  return TRUE;
+}
+
+static gboolean
+gst_rtp_batch_src_unlock_stop (GstBaseSrc * src)
+{
+  GstRtpBatchSrc *self = GST_RTP_BATCH_SRC (src);
+
+  g_object_unref (self->cancellable);
+  self->cancellable = g_cancellable_new ();
+
+  return TRUE;
+}
+
+static void
+gst_rtp_batch_src_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpBatchSrc *self = GST_RTP_BATCH_SRC (object);
+
+  switch (prop_id) {
+    case PROP_SOCKET:
+      GST_OBJECT_LOCK (self);
+      g_clear_object (&self->socket);
+      self->socket = g_value_dup_object (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_CAPS:
+      GST_OBJECT_LOCK (self);
+      gst_caps_replace (&self->caps, gst_value_get_caps (value));
+      GST_OBJECT_UNLOCK (self);
+      gst_pad_mark_reconfigure (GST_BASE_SRC_PAD (self));
+      break;
+    case PROP_MAX_PACKETS:
+      self->max_packets = g_value_get_uint (value);
+      break;
+    case PROP_MTU:
+      self->mtu = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_batch_src_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpBatchSrc *self = GST_RTP_BATCH_SRC (object);
+
+  switch (prop_id) {
+    case PROP_SOCKET:
+      GST_OBJECT_LOCK (self);
+      g_value_set_object (value, self->socket);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_CAPS:
+      GST_OBJECT_LOCK (self);
+      gst_value_set_caps (value, self->caps);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MAX_PACKETS:
+      g_value_set_uint (value, self->max_packets);
+      break;
+    case PROP_MTU:
+      g_value_set_uint (value, self->mtu);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_batch_src_finalize (GObject * object)
+{
+  GstRtpBatchSrc *self = GST_RTP_BATCH_SRC (object);
+
+  gst_rtp_batch_src_free_messages (self);
+  g_clear_object (&self->socket);
+  gst_caps_replace (&self->caps, NULL);
+  g_object_unref (self->cancellable);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_rtp_batch_src_class_init (GstRtpBatchSrcClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+  GstBaseSrcClass *gstbasesrc_class = GST_BASE_SRC_CLASS (klass);
+  GstPushSrcClass *gstpushsrc_class = GST_PUSH_SRC_CLASS (klass);
+
+  gobject_class->set_property = gst_rtp_batch_src_set_property;
+  gobject_class->get_property = gst_rtp_batch_src_get_property;
+  gobject_class->finalize = gst_rtp_batch_src_finalize;
+
+  gstbasesrc_class->get_caps = GST_DEBUG_FUNCPTR (gst_rtp_batch_src_get_caps);
+  gstbasesrc_class->start = GST_DEBUG_FUNCPTR (gst_rtp_batch_src_start);
+  gstbasesrc_class->stop = GST_DEBUG_FUNCPTR (gst_rtp_batch_src_stop);
+  gstbasesrc_class->unlock = GST_DEBUG_FUNCPTR (gst_rtp_batch_src_unlock);
+  gstbasesrc_class->unlock_stop =
+      GST_DEBUG_FUNCPTR (gst_rtp_batch_src_unlock_stop);
+
+  gstpushsrc_class->create = GST_DEBUG_FUNCPTR (gst_rtp_batch_src_create);
+
+  /**
+   * GstRtpBatchSrc:socket:
+   *
+   * The bound socket to receive from.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_SOCKET,
+      g_param_spec_object ("socket", "Socket",
+          "Bound socket to receive datagrams from", G_TYPE_SOCKET,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpBatchSrc:caps:
+   *
+   * The caps of the outgoing stream.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_CAPS,
+      g_param_spec_boxed ("caps", "Caps",
+          "The caps of the source pad", GST_TYPE_CAPS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpBatchSrc:max-packets:
+   *
+   * Maximum number of datagrams received with a single system call.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_PACKETS,
+      g_param_spec_uint ("max-packets", "Max packets",
+          "Maximum number of datagrams received in one batch", 1, 1024,
+          DEFAULT_PROP_MAX_PACKETS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpBatchSrc:mtu:
+   *
+   * Size of the buffer allocated for each datagram. Larger datagrams are
+   * truncated.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_MTU,
+      g_param_spec_uint ("mtu", "MTU",
+          "Maximum expected datagram size", 1, G_MAXUINT16,
+          DEFAULT_PROP_MTU, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_static_pad_template (gstelement_class,
+      &src_template);
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "RTP batched socket source", "Source/Network",
+      "Receives datagrams from a socket in batches",
+      "GStreamer maintainers <gstreamer-devel@lists.freedesktop.org>");
+}
+
+static void
+gst_rtp_batch_src_init (GstRtpBatchSrc * self)
+{
+  self->max_packets = DEFAULT_PROP_MAX_PACKETS;
+  self->mtu = DEFAULT_PROP_MTU;
+  self->cancellable = g_cancellable_new ();
+
+  gst_base_src_set_live (GST_BASE_SRC (self), TRUE);
+  gst_base_src_set_format (GST_BASE_SRC (self), GST_FORMAT_TIME);
+}
@@ -0,0 +1,72 @@
+/* GStreamer RTP packet batching
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_RTP_BATCH_SRC_H__
+#define __GST_RTP_BATCH_SRC_H__
+
+#include <gst/gst.h>
+#include <gst/base/gstpushsrc.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+#define GST_TYPE_RTP_BATCH_SRC \
+  (gst_rtp_batch_src_get_type())
+#define GST_RTP_BATCH_SRC(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST ((obj), GST_TYPE_RTP_BATCH_SRC, GstRtpBatchSrc))
+#define GST_RTP_BATCH_SRC_CAST(obj) \
+  ((GstRtpBatchSrc *) obj)
+#define GST_RTP_BATCH_SRC_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST ((klass), GST_TYPE_RTP_BATCH_SRC, GstRtpBatchSrcClass))
+#define GST_IS_RTP_BATCH_SRC(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GST_TYPE_RTP_BATCH_SRC))
+#define GST_IS_RTP_BATCH_SRC_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE ((klass), GST_TYPE_RTP_BATCH_SRC))
+
+typedef struct _GstRtpBatchSrc GstRtpBatchSrc;
+typedef struct _GstRtpBatchSrcClass GstRtpBatchSrcClass;
+
+struct _GstRtpBatchSrc
+{
+  GstPushSrc parent;
+
+  /* Properties */
+  GSocket *socket;
+  GstCaps *caps;
+  guint max_packets;
+  guint mtu;
+
+  GCancellable *cancellable;
+
+  /* Receive state, only used from the streaming thread */
+  GstBuffer **buffers;
+  GstMapInfo *maps;
+  GInputVector *vectors;
+  GInputMessage *messages;
+  GSocketAddress **addresses;
+  guint n_allocated;
+};
+
+struct _GstRtpBatchSrcClass
+{
+  GstPushSrcClass parent;
+};
+
+GType gst_rtp_batch_src_get_type (void);
+
+G_END_DECLS
+#endif /* __GST_RTP_BATCH_SRC_H__ */
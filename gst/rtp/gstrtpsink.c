@@ -39,6 +39,11 @@
  * This element also implements the URI scheme `rtp://` allowing to send
  * data on the network by bins that allow use the URI to determine the sink.
  * The RTP URI handler also allows setting properties through the URI query.
+ *
+ * With #GstRtpSink:batch-size larger than 1, RTP packets are collected into
+ * buffer lists which udpsink sends with one sendmmsg() call per list. This
+ * reduces the per packet system call overhead for high packet rates at the
+ * cost of up to #GstRtpSink:batch-latency extra latency.
  */
 #ifdef HAVE_CONFIG_H
 #include <config.h>
@@ -59,6 +64,8 @@ GST_DEBUG_CATEGORY_STATIC (gst_rtp_sink_debug);
 #define DEFAULT_PROP_PORT             5004
 #define DEFAULT_PROP_URI              "rtp://"DEFAULT_PROP_ADDRESS":"G_STRINGIFY(DEFAULT_PROP_PORT)
 #define DEFAULT_PROP_MULTICAST_IFACE  NULL
+#define DEFAULT_PROP_BATCH_SIZE       1
+#define DEFAULT_PROP_BATCH_LATENCY    (1 * GST_MSECOND)
 
 enum
 {
@@ -70,6 +77,8 @@ enum
   PROP_TTL,
   PROP_TTL_MC,
   PROP_MULTICAST_IFACE,
+  PROP_BATCH_SIZE,
+  PROP_BATCH_LATENCY,
 
   PROP_LAST
 };
@@ -159,6 +168,17 @@ gst_rtp_sink_set_property (GObject * object, guint prop_id,
       else
         self->multi_iface = g_value_dup_string (value);
       break;
+    case PROP_BATCH_SIZE:
+      self->batch_size = g_value_get_uint (value);
+      if (self->rtp_batch)
+        g_object_set (self->rtp_batch, "max-packets", self->batch_size, NULL);
+      break;
+    case PROP_BATCH_LATENCY:
+      self->batch_latency = g_value_get_uint64 (value);
+      if (self->rtp_batch)
+        g_object_set (self->rtp_batch, "max-latency", self->batch_latency,
+            NULL);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -195,6 +215,12 @@ gst_rtp_sink_get_property (GObject * object, guint prop_id,
     case PROP_MULTICAST_IFACE:
       g_value_set_string (value, self->multi_iface);
       break;
+    case PROP_BATCH_SIZE:
+      g_value_set_uint (value, self->batch_size);
+      break;
+    case PROP_BATCH_LATENCY:
+      g_value_set_uint64 (value, self->batch_latency);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -356,6 +382,35 @@ gst_rtp_sink_class_init (GstRtpSinkClass * klass)
           DEFAULT_PROP_MULTICAST_IFACE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRtpSink:batch-size:
+   *
+   * Maximum number of RTP packets sent with a single system call. With
+   * the default of 1 packets are sent one by one as they arrive. Takes
+   * effect when the element goes to READY.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_BATCH_SIZE,
+      g_param_spec_uint ("batch-size", "Batch size",
+          "Maximum number of RTP packets sent with one system call "
+          "(1 = no batching)", 1, 1024, DEFAULT_PROP_BATCH_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpSink:batch-latency:
+   *
+   * Maximum time in nanoseconds an RTP packet is held back waiting for its
+   * batch to fill up when #GstRtpSink:batch-size is larger than 1.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_BATCH_LATENCY,
+      g_param_spec_uint64 ("batch-latency", "Batch latency",
+          "Maximum time in nanoseconds a packet waits for its batch to fill",
+          0, G_MAXUINT64, DEFAULT_PROP_BATCH_LATENCY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&sink_template));
 
@@ -436,6 +491,30 @@ gst_rtp_sink_rtpbin_pad_removed_cb (GstElement * element, GstPad * pad,
       pad);
 }
 
+static gboolean
+gst_rtp_sink_setup_batching (GstRtpSink * self)
+{
+  if (self->batch_size <= 1 || self->rtp_batch)
+    return TRUE;
+
+  self->rtp_batch = gst_element_factory_make ("rtpbatch", "rtp_rtp_batch0");
+  if (self->rtp_batch == NULL) {
+    GST_WARNING_OBJECT (self, "rtpbatch not available, sending unbatched");
+    return FALSE;
+  }
+
+  g_object_set (self->rtp_batch, "max-packets", self->batch_size,
+      "max-latency", self->batch_latency, NULL);
+
+  /* funnel -> rtpbatch -> udpsink, udpsink sends each list with sendmmsg() */
+  gst_bin_add (GST_BIN (self), self->rtp_batch);
+  gst_element_unlink (self->funnel_rtp, self->rtp_sink);
+  gst_element_link_many (self->funnel_rtp, self->rtp_batch, self->rtp_sink,
+      NULL);
+
+  return gst_element_sync_state_with_parent (self->rtp_batch);
+}
+
 static gboolean
 gst_rtp_sink_start (GstRtpSink * self)
 {
@@ -502,6 +581,8 @@ gst_rtp_sink_start (GstRtpSink * self)
   gst_element_set_locked_state (self->rtcp_sink, FALSE);
   gst_element_sync_state_with_parent (self->rtcp_sink);
 
+  gst_rtp_sink_setup_batching (self);
+
   return TRUE;
 
 dns_resolve_failed:
@@ -564,6 +645,7 @@ gst_rtp_sink_init (GstRtpSink * self)
   self->funnel_rtp = NULL;
   self->funnel_rtcp = NULL;
   self->rtp_sink = NULL;
+  self->rtp_batch = NULL;
   self->rtcp_src = NULL;
   self->rtcp_sink = NULL;
 
@@ -571,6 +653,8 @@ gst_rtp_sink_init (GstRtpSink * self)
   self->ttl = DEFAULT_PROP_TTL;
   self->ttl_mc = DEFAULT_PROP_TTL_MC;
   self->multi_iface = g_strdup (DEFAULT_PROP_MULTICAST_IFACE);
+  self->batch_size = DEFAULT_PROP_BATCH_SIZE;
+  self->batch_latency = DEFAULT_PROP_BATCH_LATENCY;
 
   g_mutex_init (&self->lock);
 
@@ -50,12 +50,15 @@ struct _GstRtpSink
   gint ttl;
   gint ttl_mc;
   gchar *multi_iface;
+  guint batch_size;
+  GstClockTime batch_latency;
 
   /* Internal elements */
   GstElement *rtpbin;
   GstElement *funnel_rtp;
   GstElement *funnel_rtcp;
   GstElement *rtp_sink;
+  GstElement *rtp_batch;
   GstElement *rtcp_src;
   GstElement *rtcp_sink;
 
@@ -40,6 +40,11 @@
  * This element also implements the URI scheme `rtp://` allowing to render
  * RTP streams in GStreamer based media players. The RTP URI handler also
  * allows setting properties through the URI query.
+ *
+ * With #GstRtpSrc:batch-size larger than 1, the RTP socket is read with
+ * recvmmsg() and all packets pending on it are pushed as one buffer list.
+ * Only packets that are already queued in the kernel are batched, so this
+ * does not add latency.
  */
 #ifdef HAVE_CONFIG_H
 #include <config.h>
@@ -63,6 +68,7 @@ GST_DEBUG_CATEGORY_STATIC (gst_rtp_src_debug);
 #define DEFAULT_PROP_PORT             5004
 #define DEFAULT_PROP_URI              "rtp://"DEFAULT_PROP_ADDRESS":"G_STRINGIFY(DEFAULT_PROP_PORT)
 #define DEFAULT_PROP_MULTICAST_IFACE  NULL
+#define DEFAULT_PROP_BATCH_SIZE       1
 
 enum
 {
@@ -76,6 +82,7 @@ enum
   PROP_ENCODING_NAME,
   PROP_LATENCY,
   PROP_MULTICAST_IFACE,
+  PROP_BATCH_SIZE,
 
   PROP_LAST
 };
@@ -223,6 +230,8 @@ gst_rtp_src_set_property (GObject * object, guint prop_id,
       if (self->rtp_src) {
         caps = gst_rtp_src_rtpbin_request_pt_map_cb (NULL, 0, 96, self);
         g_object_set (G_OBJECT (self->rtp_src), "caps", caps, NULL);
+        if (self->rtp_batch_src)
+          g_object_set (G_OBJECT (self->rtp_batch_src), "caps", caps, NULL);
         gst_caps_unref (caps);
       }
       break;
@@ -237,6 +246,9 @@ gst_rtp_src_set_property (GObject * object, guint prop_id,
       else
         self->multi_iface = g_value_dup_string (value);
       break;
+    case PROP_BATCH_SIZE:
+      self->batch_size = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -279,6 +291,9 @@ gst_rtp_src_get_property (GObject * object, guint prop_id,
     case PROP_MULTICAST_IFACE:
       g_value_set_string (value, self->multi_iface);
       break;
+    case PROP_BATCH_SIZE:
+      g_value_set_uint (value, self->batch_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -401,6 +416,21 @@ gst_rtp_src_class_init (GstRtpSrcClass * klass)
           DEFAULT_PROP_MULTICAST_IFACE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRtpSrc:batch-size:
+   *
+   * Maximum number of RTP packets received with a single system call. With
+   * the default of 1 packets are received one by one. Takes effect when the
+   * element goes to READY.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_BATCH_SIZE,
+      g_param_spec_uint ("batch-size", "Batch size",
+          "Maximum number of RTP packets received with one system call "
+          "(1 = no batching)", 1, 1024, DEFAULT_PROP_BATCH_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&src_template));
 
@@ -550,6 +580,85 @@ gst_rtp_src_on_send_rtcp (GstPad * pad, GstPadProbeInfo * info,
   return GST_PAD_PROBE_OK;
 }
 
+static gboolean
+gst_rtp_src_setup_batching (GstRtpSrc * self)
+{
+  GSocket *socket = NULL;
+  GstCaps *caps = NULL;
+  GstPad *pad, *peer;
+
+  if (self->batch_size <= 1)
+    return TRUE;
+
+  g_object_get (self->rtp_src, "used-socket", &socket, "caps", &caps, NULL);
+  if (!G_IS_SOCKET (socket)) {
+    GST_WARNING_OBJECT (self, "Could not retrieve RTP src socket.");
+    goto done;
+  }
+
+  self->rtp_batch_src =
+      gst_element_factory_make ("rtpbatchsrc", "rtp_rtp_batchsrc0");
+  if (self->rtp_batch_src == NULL) {
+    GST_WARNING_OBJECT (self, "rtpbatchsrc not available, "
+        "receiving unbatched");
+    goto done;
+  }
+
+  g_object_set (self->rtp_batch_src, "socket", socket, "caps", caps,
+      "max-packets", self->batch_size, NULL);
+
+  /* udpsrc keeps the socket bound and the multicast group joined, but stays
+   * in READY and never reads from it */
+  gst_element_set_locked_state (self->rtp_src, TRUE);
+
+  pad = gst_element_get_static_pad (self->rtp_src, "src");
+  peer = gst_pad_get_peer (pad);
+  gst_pad_unlink (pad, peer);
+  gst_object_unref (pad);
+
+  gst_bin_add (GST_BIN (self), self->rtp_batch_src);
+  pad = gst_element_get_static_pad (self->rtp_batch_src, "src");
+  gst_pad_link (pad, peer);
+  gst_object_unref (pad);
+  gst_object_unref (peer);
+
+  gst_element_sync_state_with_parent (self->rtp_batch_src);
+
+done:
+  g_clear_object (&socket);
+  if (caps)
+    gst_caps_unref (caps);
+
+  return self->rtp_batch_src != NULL;
+}
+
+static void
+gst_rtp_src_teardown_batching (GstRtpSrc * self)
+{
+  GstPad *pad, *peer;
+
+  if (self->rtp_batch_src == NULL)
+    return;
+
+  pad = gst_element_get_static_pad (self->rtp_batch_src, "src");
+  peer = gst_pad_get_peer (pad);
+  gst_pad_unlink (pad, peer);
+  gst_object_unref (pad);
+
+  gst_element_set_state (self->rtp_batch_src, GST_STATE_NULL);
+  gst_bin_remove (GST_BIN (self), self->rtp_batch_src);
+  self->rtp_batch_src = NULL;
+
+  pad = gst_element_get_static_pad (self->rtp_src, "src");
+  gst_pad_link (pad, peer);
+  gst_object_unref (pad);
+  gst_object_unref (peer);
+
+  /* the bin skipped the locked udpsrc when going to NULL */
+  gst_element_set_locked_state (self->rtp_src, FALSE);
+  gst_element_set_state (self->rtp_src, GST_STATE_NULL);
+}
+
 static gboolean
 gst_rtp_src_start (GstRtpSrc * self)
 {
@@ -607,6 +716,8 @@ gst_rtp_src_start (GstRtpSrc * self)
   gst_element_set_locked_state (self->rtcp_sink, FALSE);
   gst_element_sync_state_with_parent (self->rtcp_sink);
 
+  gst_rtp_src_setup_batching (self);
+
   return TRUE;
 }
 
@@ -626,6 +737,8 @@ gst_rtp_src_stop (GstRtpSrc * self)
   gst_pad_remove_probe (pad, self->rtcp_send_probe);
   self->rtcp_send_probe = 0;
   gst_object_unref (pad);
+
+  gst_rtp_src_teardown_batching (self);
 }
 
 static GstStateChangeReturn
@@ -671,9 +784,11 @@ gst_rtp_src_init (GstRtpSrc * self)
 
   self->rtpbin = NULL;
   self->rtp_src = NULL;
+  self->rtp_batch_src = NULL;
   self->rtcp_src = NULL;
   self->rtcp_sink = NULL;
   self->multi_iface = g_strdup (DEFAULT_PROP_MULTICAST_IFACE);
+  self->batch_size = DEFAULT_PROP_BATCH_SIZE;
 
   self->uri = gst_uri_from_string (DEFAULT_PROP_URI);
   self->ttl = DEFAULT_PROP_TTL;
@@ -51,10 +51,12 @@ struct _GstRtpSrc
   gint ttl_mc;
   gchar *encoding_name;
   gchar *multi_iface;
+  guint batch_size;
 
   /* Internal elements */
   GstElement *rtpbin;
   GstElement *rtp_src;
+  GstElement *rtp_batch_src;
   GstElement *rtcp_src;
   GstElement *rtcp_sink;
 
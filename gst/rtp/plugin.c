@@ -4,6 +4,8 @@
 
 #include "gstrtpsink.h"
 #include "gstrtpsrc.h"
+#include "gstrtpbatch.h"
+#include "gstrtpbatchsrc.h"
 
 
 static gboolean
@@ -18,6 +20,12 @@ plugin_init (GstPlugin * plugin)
   ret |= gst_element_register (plugin, "rtpsink",
       GST_RANK_PRIMARY + 1, GST_TYPE_RTP_SINK);
 
+  ret |= gst_element_register (plugin, "rtpbatch",
+      GST_RANK_NONE, GST_TYPE_RTP_BATCH);
+
+  ret |= gst_element_register (plugin, "rtpbatchsrc",
+      GST_RANK_NONE, GST_TYPE_RTP_BATCH_SRC);
+
   return ret;
 }
 
@@ -27,6 +27,11 @@
  * gst-launch-1.0 -v filesrc location=file.y4m ! y4mdec ! xvimagesink
  * ]|
  *
+ * In pull mode, the offset of every frame is computed from its index, so
+ * seeking is frame accurate, and frames are read directly into buffers
+ * of a pool without copying them if downstream supports #GstVideoMeta or
+ * the frame layout matches the default one.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
@@ -41,6 +46,9 @@
 #include <string.h>
 
 #define MAX_SIZE 32768
+#define MAX_HEADER_LENGTH 80
+/* "FRAME\n", frame parameters are not expected */
+#define FRAME_HEADER_SIZE 6
 
 GST_DEBUG_CATEGORY (y4mdec_debug);
 #define GST_CAT_DEFAULT y4mdec_debug
@@ -59,6 +67,11 @@ static GstFlowReturn gst_y4m_dec_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buffer);
 static gboolean gst_y4m_dec_sink_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
+static gboolean gst_y4m_dec_sink_activate (GstPad * sinkpad,
+    GstObject * parent);
+static gboolean gst_y4m_dec_sink_activate_mode (GstPad * pad,
+    GstObject * parent, GstPadMode mode, gboolean active);
+static void gst_y4m_dec_loop (GstPad * pad);
 
 static gboolean gst_y4m_dec_src_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
@@ -127,6 +140,10 @@ gst_y4m_dec_init (GstY4mDec * y4mdec)
       GST_DEBUG_FUNCPTR (gst_y4m_dec_sink_event));
   gst_pad_set_chain_function (y4mdec->sinkpad,
       GST_DEBUG_FUNCPTR (gst_y4m_dec_chain));
+  gst_pad_set_activate_function (y4mdec->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_y4m_dec_sink_activate));
+  gst_pad_set_activatemode_function (y4mdec->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_y4m_dec_sink_activate_mode));
   gst_element_add_pad (GST_ELEMENT (y4mdec), y4mdec->sinkpad);
 
   y4mdec->srcpad = gst_pad_new_from_static_template (&gst_y4m_dec_src_template,
@@ -225,6 +242,13 @@ gst_y4m_dec_change_state (GstElement * element, GstStateChange transition)
         gst_object_unref (y4mdec->pool);
       }
       y4mdec->pool = NULL;
+      if (y4mdec->read_pool) {
+        gst_buffer_pool_set_active (y4mdec->read_pool, FALSE);
+        gst_object_unref (y4mdec->read_pool);
+      }
+      y4mdec->read_pool = NULL;
+      y4mdec->have_header = FALSE;
+      gst_adapter_clear (y4mdec->adapter);
       break;
     case GST_STATE_CHANGE_READY_TO_NULL:
       break;
@@ -248,11 +272,19 @@ gst_y4m_dec_frames_to_timestamp (GstY4mDec * y4mdec, gint64 frame_index)
 static gint64
 gst_y4m_dec_timestamp_to_frames (GstY4mDec * y4mdec, GstClockTime timestamp)
 {
+  gint64 frame_index;
+
   if (timestamp == -1)
     return -1;
 
-  return gst_util_uint64_scale (timestamp, y4mdec->info.fps_n,
+  /* frame timestamps are rounded down, so the timestamp of a frame can
+   * scale to just before it */
+  frame_index = gst_util_uint64_scale (timestamp, y4mdec->info.fps_n,
       GST_SECOND * y4mdec->info.fps_d);
+  if (gst_y4m_dec_frames_to_timestamp (y4mdec, frame_index + 1) <= timestamp)
+    frame_index++;
+
+  return frame_index;
 }
 
 static gint64
@@ -263,7 +295,8 @@ gst_y4m_dec_bytes_to_frames (GstY4mDec * y4mdec, gint64 bytes)
 
   if (bytes < y4mdec->header_size)
     return 0;
-  return (bytes - y4mdec->header_size) / (y4mdec->info.size + 6);
+  return (bytes - y4mdec->header_size) / (y4mdec->info.size +
+      FRAME_HEADER_SIZE);
 }
 
 static guint64
@@ -272,7 +305,8 @@ gst_y4m_dec_frames_to_bytes (GstY4mDec * y4mdec, gint64 frame_index)
   if (frame_index == -1)
     return -1;
 
-  return y4mdec->header_size + (y4mdec->info.size + 6) * frame_index;
+  return y4mdec->header_size + (y4mdec->info.size + FRAME_HEADER_SIZE) *
+      frame_index;
 }
 
 static GstClockTime
@@ -481,13 +515,199 @@ error:
   return FALSE;
 }
 
+/* Parses the stream header in @header and configures the src pad and the
+ * pools from it */
+static GstFlowReturn
+gst_y4m_dec_handle_header (GstY4mDec * y4mdec, char *header)
+{
+  gboolean ret;
+  GstCaps *caps;
+  GstQuery *query;
+  GstAllocator *allocator = NULL;
+  GstAllocationParams params;
+  int i;
+
+  header[MAX_HEADER_LENGTH - 1] = 0;
+  for (i = 0; i < MAX_HEADER_LENGTH; i++) {
+    if (header[i] == 0x0a)
+      header[i] = 0;
+  }
+
+  ret = gst_y4m_dec_parse_header (y4mdec, header);
+  if (!ret) {
+    GST_ELEMENT_ERROR (y4mdec, STREAM, DECODE,
+        ("Failed to parse YUV4MPEG header"), (NULL));
+    return GST_FLOW_ERROR;
+  }
+
+  y4mdec->header_size = strlen (header) + 1;
+
+  caps = gst_video_info_to_caps (&y4mdec->info);
+  ret = gst_pad_set_caps (y4mdec->srcpad, caps);
+
+  query = gst_query_new_allocation (caps, FALSE);
+  y4mdec->video_meta = FALSE;
+  gst_allocation_params_init (&params);
+
+  if (y4mdec->pool) {
+    gst_buffer_pool_set_active (y4mdec->pool, FALSE);
+    gst_object_unref (y4mdec->pool);
+  }
+  y4mdec->pool = NULL;
+
+  if (y4mdec->read_pool) {
+    gst_buffer_pool_set_active (y4mdec->read_pool, FALSE);
+    gst_object_unref (y4mdec->read_pool);
+  }
+  y4mdec->read_pool = NULL;
+
+  if (gst_pad_peer_query (y4mdec->srcpad, query)) {
+    y4mdec->video_meta =
+        gst_query_find_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
+
+    if (gst_query_get_n_allocation_params (query) > 0)
+      gst_query_parse_nth_allocation_param (query, 0, &allocator, &params);
+
+    /* We only need a pool if we need to do stride conversion for downstream */
+    if (!y4mdec->video_meta && memcmp (&y4mdec->info, &y4mdec->out_info,
+            sizeof (y4mdec->info)) != 0) {
+      GstBufferPool *pool = NULL;
+      GstStructure *config;
+      guint size, min, max;
+
+      if (gst_query_get_n_allocation_pools (query) > 0) {
+        gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min,
+            &max);
+        size = MAX (size, y4mdec->out_info.size);
+      } else {
+        pool = NULL;
+        size = y4mdec->out_info.size;
+        min = max = 0;
+      }
+
+      if (pool == NULL) {
+        pool = gst_video_buffer_pool_new ();
+      }
+
+      config = gst_buffer_pool_get_config (pool);
+      gst_buffer_pool_config_set_params (config, caps, size, min, max);
+      gst_buffer_pool_config_set_allocator (config, allocator, &params);
+      gst_buffer_pool_set_config (pool, config);
+
+      y4mdec->pool = pool;
+    }
+  } else if (memcmp (&y4mdec->info, &y4mdec->out_info,
+          sizeof (y4mdec->info)) != 0) {
+    GstBufferPool *pool;
+    GstStructure *config;
+
+    /* No pool, create our own if we need to do stride conversion */
+    pool = gst_video_buffer_pool_new ();
+    config = gst_buffer_pool_get_config (pool);
+    gst_buffer_pool_config_set_params (config, caps, y4mdec->out_info.size, 0,
+        0);
+    gst_buffer_pool_set_config (pool, config);
+    y4mdec->pool = pool;
+  }
+  if (y4mdec->pool) {
+    gst_buffer_pool_set_active (y4mdec->pool, TRUE);
+  } else if (GST_PAD_MODE (y4mdec->sinkpad) == GST_PAD_MODE_PULL) {
+    GstStructure *config;
+
+    /* Frames are output as read, pull them with their header into buffers
+     * from downstream's allocator and skip the header afterwards */
+    y4mdec->read_pool = gst_buffer_pool_new ();
+    config = gst_buffer_pool_get_config (y4mdec->read_pool);
+    gst_buffer_pool_config_set_params (config, NULL,
+        FRAME_HEADER_SIZE + y4mdec->info.size, 0, 0);
+    gst_buffer_pool_config_set_allocator (config, allocator, &params);
+    gst_buffer_pool_set_config (y4mdec->read_pool, config);
+    gst_buffer_pool_set_active (y4mdec->read_pool, TRUE);
+  }
+  if (allocator)
+    gst_object_unref (allocator);
+  gst_query_unref (query);
+  gst_caps_unref (caps);
+  if (!ret) {
+    GST_DEBUG_OBJECT (y4mdec, "Couldn't set caps on src pad");
+    return GST_FLOW_ERROR;
+  }
+
+  y4mdec->have_header = TRUE;
+
+  return GST_FLOW_OK;
+}
+
+/* Timestamps and pushes the frame in @buffer, which has the layout of the
+ * YUV4MPEG stream */
+static GstFlowReturn
+gst_y4m_dec_push_frame (GstY4mDec * y4mdec, GstBuffer * buffer)
+{
+  GST_BUFFER_TIMESTAMP (buffer) =
+      gst_y4m_dec_frames_to_timestamp (y4mdec, y4mdec->frame_index);
+  GST_BUFFER_DURATION (buffer) =
+      gst_y4m_dec_frames_to_timestamp (y4mdec, y4mdec->frame_index + 1) -
+      GST_BUFFER_TIMESTAMP (buffer);
+
+  y4mdec->frame_index++;
+
+  if (y4mdec->video_meta) {
+    gst_buffer_add_video_meta_full (buffer, 0, y4mdec->info.finfo->format,
+        y4mdec->info.width, y4mdec->info.height, y4mdec->info.finfo->n_planes,
+        y4mdec->info.offset, y4mdec->info.stride);
+  } else if (memcmp (&y4mdec->info, &y4mdec->out_info,
+          sizeof (y4mdec->info)) != 0) {
+    GstBuffer *outbuf;
+    GstVideoFrame iframe, oframe;
+    GstFlowReturn flow_ret;
+    gint i, j;
+    gint w, h, istride, ostride;
+    guint8 *src, *dest;
+
+    /* Allocate a new buffer and do stride conversion */
+    g_assert (y4mdec->pool != NULL);
+
+    flow_ret = gst_buffer_pool_acquire_buffer (y4mdec->pool, &outbuf, NULL);
+    if (flow_ret != GST_FLOW_OK) {
+      gst_buffer_unref (buffer);
+      return flow_ret;
+    }
+
+    gst_video_frame_map (&iframe, &y4mdec->info, buffer, GST_MAP_READ);
+    gst_video_frame_map (&oframe, &y4mdec->out_info, outbuf, GST_MAP_WRITE);
+
+    for (i = 0; i < 3; i++) {
+      w = GST_VIDEO_FRAME_COMP_WIDTH (&iframe, i);
+      h = GST_VIDEO_FRAME_COMP_HEIGHT (&iframe, i);
+      istride = GST_VIDEO_FRAME_COMP_STRIDE (&iframe, i);
+      ostride = GST_VIDEO_FRAME_COMP_STRIDE (&oframe, i);
+      src = GST_VIDEO_FRAME_COMP_DATA (&iframe, i);
+      dest = GST_VIDEO_FRAME_COMP_DATA (&oframe, i);
+
+      for (j = 0; j < h; j++) {
+        memcpy (dest, src, w);
+
+        dest += ostride;
+        src += istride;
+      }
+    }
+
+    gst_video_frame_unmap (&iframe);
+    gst_video_frame_unmap (&oframe);
+    gst_buffer_copy_into (outbuf, buffer, GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+    gst_buffer_unref (buffer);
+    buffer = outbuf;
+  }
+
+  return gst_pad_push (y4mdec->srcpad, buffer);
+}
+
 static GstFlowReturn
 gst_y4m_dec_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 {
   GstY4mDec *y4mdec;
   int n_avail;
   GstFlowReturn flow_ret = GST_FLOW_OK;
-#define MAX_HEADER_LENGTH 80
   char header[MAX_HEADER_LENGTH];
   int i;
   int len;
@@ -505,111 +725,16 @@ gst_y4m_dec_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   n_avail = gst_adapter_available (y4mdec->adapter);
 
   if (!y4mdec->have_header) {
-    gboolean ret;
-    GstCaps *caps;
-    GstQuery *query;
-
     if (n_avail < MAX_HEADER_LENGTH)
       return GST_FLOW_OK;
 
     gst_adapter_copy (y4mdec->adapter, (guint8 *) header, 0, MAX_HEADER_LENGTH);
 
-    header[MAX_HEADER_LENGTH - 1] = 0;
-    for (i = 0; i < MAX_HEADER_LENGTH; i++) {
-      if (header[i] == 0x0a)
-        header[i] = 0;
-    }
-
-    ret = gst_y4m_dec_parse_header (y4mdec, header);
-    if (!ret) {
-      GST_ELEMENT_ERROR (y4mdec, STREAM, DECODE,
-          ("Failed to parse YUV4MPEG header"), (NULL));
-      return GST_FLOW_ERROR;
-    }
+    flow_ret = gst_y4m_dec_handle_header (y4mdec, header);
+    if (flow_ret != GST_FLOW_OK)
+      return flow_ret;
 
-    y4mdec->header_size = strlen (header) + 1;
     gst_adapter_flush (y4mdec->adapter, y4mdec->header_size);
-
-    caps = gst_video_info_to_caps (&y4mdec->info);
-    ret = gst_pad_set_caps (y4mdec->srcpad, caps);
-
-    query = gst_query_new_allocation (caps, FALSE);
-    y4mdec->video_meta = FALSE;
-
-    if (y4mdec->pool) {
-      gst_buffer_pool_set_active (y4mdec->pool, FALSE);
-      gst_object_unref (y4mdec->pool);
-    }
-    y4mdec->pool = NULL;
-
-    if (gst_pad_peer_query (y4mdec->srcpad, query)) {
-      y4mdec->video_meta =
-          gst_query_find_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
-
-      /* We only need a pool if we need to do stride conversion for downstream */
-      if (!y4mdec->video_meta && memcmp (&y4mdec->info, &y4mdec->out_info,
-              sizeof (y4mdec->info)) != 0) {
-        GstBufferPool *pool = NULL;
-        GstAllocator *allocator = NULL;
-        GstAllocationParams params;
-        GstStructure *config;
-        guint size, min, max;
-
-        if (gst_query_get_n_allocation_params (query) > 0) {
-          gst_query_parse_nth_allocation_param (query, 0, &allocator, &params);
-        } else {
-          allocator = NULL;
-          gst_allocation_params_init (&params);
-        }
-
-        if (gst_query_get_n_allocation_pools (query) > 0) {
-          gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min,
-              &max);
-          size = MAX (size, y4mdec->out_info.size);
-        } else {
-          pool = NULL;
-          size = y4mdec->out_info.size;
-          min = max = 0;
-        }
-
-        if (pool == NULL) {
-          pool = gst_video_buffer_pool_new ();
-        }
-
-        config = gst_buffer_pool_get_config (pool);
-        gst_buffer_pool_config_set_params (config, caps, size, min, max);
-        gst_buffer_pool_config_set_allocator (config, allocator, &params);
-        gst_buffer_pool_set_config (pool, config);
-
-        if (allocator)
-          gst_object_unref (allocator);
-
-        y4mdec->pool = pool;
-      }
-    } else if (memcmp (&y4mdec->info, &y4mdec->out_info,
-            sizeof (y4mdec->info)) != 0) {
-      GstBufferPool *pool;
-      GstStructure *config;
-
-      /* No pool, create our own if we need to do stride conversion */
-      pool = gst_video_buffer_pool_new ();
-      config = gst_buffer_pool_get_config (pool);
-      gst_buffer_pool_config_set_params (config, caps, y4mdec->out_info.size, 0,
-          0);
-      gst_buffer_pool_set_config (pool, config);
-      y4mdec->pool = pool;
-    }
-    if (y4mdec->pool) {
-      gst_buffer_pool_set_active (y4mdec->pool, TRUE);
-    }
-    gst_query_unref (query);
-    gst_caps_unref (caps);
-    if (!ret) {
-      GST_DEBUG_OBJECT (y4mdec, "Couldn't set caps on src pad");
-      return GST_FLOW_ERROR;
-    }
-
-    y4mdec->have_header = TRUE;
   }
 
   if (y4mdec->have_new_segment) {
@@ -668,69 +793,307 @@ gst_y4m_dec_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 
     buffer = gst_adapter_take_buffer (y4mdec->adapter, y4mdec->info.size);
 
-    GST_BUFFER_TIMESTAMP (buffer) =
-        gst_y4m_dec_frames_to_timestamp (y4mdec, y4mdec->frame_index);
-    GST_BUFFER_DURATION (buffer) =
-        gst_y4m_dec_frames_to_timestamp (y4mdec, y4mdec->frame_index + 1) -
-        GST_BUFFER_TIMESTAMP (buffer);
+    flow_ret = gst_y4m_dec_push_frame (y4mdec, buffer);
+    if (flow_ret != GST_FLOW_OK)
+      break;
+  }
 
-    y4mdec->frame_index++;
+  GST_DEBUG ("returning %d", flow_ret);
 
-    if (y4mdec->video_meta) {
-      gst_buffer_add_video_meta_full (buffer, 0, y4mdec->info.finfo->format,
-          y4mdec->info.width, y4mdec->info.height, y4mdec->info.finfo->n_planes,
-          y4mdec->info.offset, y4mdec->info.stride);
-    } else if (memcmp (&y4mdec->info, &y4mdec->out_info,
-            sizeof (y4mdec->info)) != 0) {
-      GstBuffer *outbuf;
-      GstVideoFrame iframe, oframe;
-      gint i, j;
-      gint w, h, istride, ostride;
-      guint8 *src, *dest;
-
-      /* Allocate a new buffer and do stride conversion */
-      g_assert (y4mdec->pool != NULL);
-
-      flow_ret = gst_buffer_pool_acquire_buffer (y4mdec->pool, &outbuf, NULL);
-      if (flow_ret != GST_FLOW_OK) {
-        gst_buffer_unref (buffer);
-        break;
-      }
+  return flow_ret;
+}
+
+static GstFlowReturn
+gst_y4m_dec_pull_header (GstY4mDec * y4mdec)
+{
+  GstBuffer *buffer = NULL;
+  GstFlowReturn ret;
+  char header[MAX_HEADER_LENGTH];
+  gchar *stream_id;
+  GstEvent *event;
+  gsize size;
+
+  ret = gst_pad_pull_range (y4mdec->sinkpad, 0, MAX_HEADER_LENGTH, &buffer);
+  if (ret != GST_FLOW_OK)
+    return ret;
+
+  memset (header, 0, MAX_HEADER_LENGTH);
+  size = gst_buffer_extract (buffer, 0, header, MAX_HEADER_LENGTH);
+  gst_buffer_unref (buffer);
+  if (size < MAX_HEADER_LENGTH && memchr (header, 0x0a, size) == NULL)
+    return GST_FLOW_EOS;
+
+  /* upstream doesn't send it in pull mode, and it goes before the caps */
+  stream_id = gst_pad_create_stream_id (y4mdec->srcpad,
+      GST_ELEMENT_CAST (y4mdec), NULL);
+  event = gst_event_new_stream_start (stream_id);
+  gst_event_set_group_id (event, gst_util_group_id_next ());
+  gst_pad_push_event (y4mdec->srcpad, event);
+  g_free (stream_id);
+
+  ret = gst_y4m_dec_handle_header (y4mdec, header);
+  if (ret != GST_FLOW_OK)
+    return ret;
+
+  y4mdec->offset = gst_y4m_dec_frames_to_bytes (y4mdec, y4mdec->frame_index);
+
+  return GST_FLOW_OK;
+}
+
+/* Reads the frame at the current offset. Frames with parameters in their
+ * header are read separately from it, and break the frame offset
+ * computations for seeking */
+static GstFlowReturn
+gst_y4m_dec_pull_frame (GstY4mDec * y4mdec, GstBuffer ** buffer)
+{
+  guint size = FRAME_HEADER_SIZE + y4mdec->info.size;
+  GstBuffer *buf = NULL;
+  GstFlowReturn ret;
+  char header[MAX_HEADER_LENGTH];
+  int len;
 
-      gst_video_frame_map (&iframe, &y4mdec->info, buffer, GST_MAP_READ);
-      gst_video_frame_map (&oframe, &y4mdec->out_info, outbuf, GST_MAP_WRITE);
+  if (y4mdec->read_pool) {
+    ret = gst_buffer_pool_acquire_buffer (y4mdec->read_pool, &buf, NULL);
+    if (ret != GST_FLOW_OK)
+      return ret;
+  }
 
-      for (i = 0; i < 3; i++) {
-        w = GST_VIDEO_FRAME_COMP_WIDTH (&iframe, i);
-        h = GST_VIDEO_FRAME_COMP_HEIGHT (&iframe, i);
-        istride = GST_VIDEO_FRAME_COMP_STRIDE (&iframe, i);
-        ostride = GST_VIDEO_FRAME_COMP_STRIDE (&oframe, i);
-        src = GST_VIDEO_FRAME_COMP_DATA (&iframe, i);
-        dest = GST_VIDEO_FRAME_COMP_DATA (&oframe, i);
+  ret = gst_pad_pull_range (y4mdec->sinkpad, y4mdec->offset, size, &buf);
+  if (ret != GST_FLOW_OK)
+    goto error;
 
-        for (j = 0; j < h; j++) {
-          memcpy (dest, src, w);
+  if (gst_buffer_get_size (buf) < size) {
+    GST_DEBUG_OBJECT (y4mdec, "incomplete last frame");
+    ret = GST_FLOW_EOS;
+    goto error;
+  }
 
-          dest += ostride;
-          src += istride;
-        }
-      }
+  gst_buffer_extract (buf, 0, header, FRAME_HEADER_SIZE);
+  if (memcmp (header, "FRAME\n", FRAME_HEADER_SIZE) == 0) {
+    gst_buffer_resize (buf, FRAME_HEADER_SIZE, y4mdec->info.size);
+    y4mdec->offset += size;
+    *buffer = buf;
+    return GST_FLOW_OK;
+  }
+  gst_buffer_unref (buf);
+  buf = NULL;
+
+  memset (header, 0, MAX_HEADER_LENGTH);
+  ret = gst_pad_pull_range (y4mdec->sinkpad, y4mdec->offset,
+      MAX_HEADER_LENGTH, &buf);
+  if (ret != GST_FLOW_OK)
+    return ret;
+  gst_buffer_extract (buf, 0, header, MAX_HEADER_LENGTH - 1);
+  gst_buffer_unref (buf);
+  buf = NULL;
+
+  if (memcmp (header, "FRAME", 5) != 0 || strchr (header, 0x0a) == NULL) {
+    GST_ELEMENT_ERROR (y4mdec, STREAM, DECODE,
+        ("Failed to parse YUV4MPEG frame"), (NULL));
+    return GST_FLOW_ERROR;
+  }
+  len = strchr (header, 0x0a) - header;
+  GST_DEBUG_OBJECT (y4mdec, "frame header with parameters of length %d", len);
+
+  ret = gst_pad_pull_range (y4mdec->sinkpad, y4mdec->offset + len + 1,
+      y4mdec->info.size, &buf);
+  if (ret != GST_FLOW_OK)
+    return ret;
+
+  if (gst_buffer_get_size (buf) < y4mdec->info.size) {
+    GST_DEBUG_OBJECT (y4mdec, "incomplete last frame");
+    ret = GST_FLOW_EOS;
+    goto error;
+  }
 
-      gst_video_frame_unmap (&iframe);
-      gst_video_frame_unmap (&oframe);
-      gst_buffer_copy_into (outbuf, buffer, GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
-      gst_buffer_unref (buffer);
-      buffer = outbuf;
+  y4mdec->offset += len + 1 + y4mdec->info.size;
+  *buffer = buf;
+
+  return GST_FLOW_OK;
+
+error:
+  if (buf)
+    gst_buffer_unref (buf);
+  return ret;
+}
+
+static void
+gst_y4m_dec_loop (GstPad * pad)
+{
+  GstY4mDec *y4mdec = GST_Y4M_DEC (GST_PAD_PARENT (pad));
+  GstBuffer *buffer = NULL;
+  GstFlowReturn ret;
+
+  if (!y4mdec->have_header) {
+    ret = gst_y4m_dec_pull_header (y4mdec);
+    if (ret != GST_FLOW_OK)
+      goto pause;
+  }
+
+  if (y4mdec->have_new_segment) {
+    gst_pad_push_event (y4mdec->srcpad,
+        gst_event_new_segment (&y4mdec->segment));
+    y4mdec->have_new_segment = FALSE;
+  }
+
+  if (GST_CLOCK_TIME_IS_VALID (y4mdec->segment.stop) &&
+      gst_y4m_dec_frames_to_timestamp (y4mdec, y4mdec->frame_index) >=
+      y4mdec->segment.stop) {
+    ret = GST_FLOW_EOS;
+    goto pause;
+  }
+
+  ret = gst_y4m_dec_pull_frame (y4mdec, &buffer);
+  if (ret != GST_FLOW_OK)
+    goto pause;
+
+  y4mdec->segment.position =
+      gst_y4m_dec_frames_to_timestamp (y4mdec, y4mdec->frame_index);
+
+  ret = gst_y4m_dec_push_frame (y4mdec, buffer);
+  if (ret != GST_FLOW_OK)
+    goto pause;
+
+  return;
+
+pause:
+  {
+    GST_DEBUG_OBJECT (y4mdec, "pausing task, reason %s",
+        gst_flow_get_name (ret));
+    gst_pad_pause_task (pad);
+
+    if (ret == GST_FLOW_EOS) {
+      if (y4mdec->segment.flags & GST_SEGMENT_FLAG_SEGMENT) {
+        GstClockTime stop = y4mdec->segment.stop;
+
+        if (!GST_CLOCK_TIME_IS_VALID (stop))
+          stop = gst_y4m_dec_frames_to_timestamp (y4mdec,
+              y4mdec->frame_index);
+        gst_element_post_message (GST_ELEMENT_CAST (y4mdec),
+            gst_message_new_segment_done (GST_OBJECT_CAST (y4mdec),
+                GST_FORMAT_TIME, stop));
+        gst_pad_push_event (y4mdec->srcpad,
+            gst_event_new_segment_done (GST_FORMAT_TIME, stop));
+      } else {
+        gst_pad_push_event (y4mdec->srcpad, gst_event_new_eos ());
+      }
+    } else if (ret == GST_FLOW_NOT_LINKED || ret < GST_FLOW_EOS) {
+      GST_ELEMENT_FLOW_ERROR (y4mdec, ret);
+      gst_pad_push_event (y4mdec->srcpad, gst_event_new_eos ());
     }
+  }
+}
 
-    flow_ret = gst_pad_push (y4mdec->srcpad, buffer);
-    if (flow_ret != GST_FLOW_OK)
-      break;
+static gboolean
+gst_y4m_dec_sink_activate (GstPad * sinkpad, GstObject * parent)
+{
+  GstQuery *query;
+  gboolean pull_mode;
+
+  query = gst_query_new_scheduling ();
+
+  if (!gst_pad_peer_query (sinkpad, query)) {
+    gst_query_unref (query);
+    goto activate_push;
   }
 
-  GST_DEBUG ("returning %d", flow_ret);
+  pull_mode = gst_query_has_scheduling_mode_with_flags (query,
+      GST_PAD_MODE_PULL, GST_SCHEDULING_FLAG_SEEKABLE);
+  gst_query_unref (query);
 
-  return flow_ret;
+  if (!pull_mode)
+    goto activate_push;
+
+  GST_DEBUG_OBJECT (sinkpad, "activating pull");
+  return gst_pad_activate_mode (sinkpad, GST_PAD_MODE_PULL, TRUE);
+
+activate_push:
+  {
+    GST_DEBUG_OBJECT (sinkpad, "activating push");
+    return gst_pad_activate_mode (sinkpad, GST_PAD_MODE_PUSH, TRUE);
+  }
+}
+
+static gboolean
+gst_y4m_dec_sink_activate_mode (GstPad * pad, GstObject * parent,
+    GstPadMode mode, gboolean active)
+{
+  GstY4mDec *y4mdec = GST_Y4M_DEC (parent);
+
+  switch (mode) {
+    case GST_PAD_MODE_PUSH:
+      return TRUE;
+    case GST_PAD_MODE_PULL:
+      if (active) {
+        y4mdec->frame_index = 0;
+        gst_segment_init (&y4mdec->segment, GST_FORMAT_TIME);
+        y4mdec->have_new_segment = TRUE;
+        return gst_pad_start_task (pad, (GstTaskFunction) gst_y4m_dec_loop,
+            pad, NULL);
+      }
+      return gst_pad_stop_task (pad);
+    default:
+      return FALSE;
+  }
+}
+
+static gboolean
+gst_y4m_dec_handle_seek_pull (GstY4mDec * y4mdec, GstEvent * event)
+{
+  gdouble rate;
+  GstFormat format;
+  GstSeekFlags flags;
+  GstSeekType start_type, stop_type;
+  gint64 start, stop;
+  gboolean flush;
+  GstSegment seeksegment;
+
+  gst_event_parse_seek (event, &rate, &format, &flags, &start_type,
+      &start, &stop_type, &stop);
+  gst_event_unref (event);
+
+  if (format != GST_FORMAT_TIME || rate <= 0.0 || !y4mdec->have_header) {
+    GST_DEBUG_OBJECT (y4mdec, "unsupported seek");
+    return FALSE;
+  }
+
+  flush = flags & GST_SEEK_FLAG_FLUSH;
+
+  if (flush)
+    gst_pad_push_event (y4mdec->srcpad, gst_event_new_flush_start ());
+  else
+    gst_pad_pause_task (y4mdec->sinkpad);
+
+  GST_PAD_STREAM_LOCK (y4mdec->sinkpad);
+
+  if (flush)
+    gst_pad_push_event (y4mdec->srcpad, gst_event_new_flush_stop (TRUE));
+
+  seeksegment = y4mdec->segment;
+  gst_segment_do_seek (&seeksegment, rate, format, flags, start_type, start,
+      stop_type, stop, NULL);
+
+  /* every frame is a keyframe, start from the one at the position */
+  y4mdec->frame_index =
+      gst_y4m_dec_timestamp_to_frames (y4mdec, seeksegment.position);
+  y4mdec->offset = gst_y4m_dec_frames_to_bytes (y4mdec, y4mdec->frame_index);
+  GST_DEBUG_OBJECT (y4mdec, "seeking to frame %d at offset %" G_GUINT64_FORMAT,
+      y4mdec->frame_index, y4mdec->offset);
+
+  y4mdec->segment = seeksegment;
+  y4mdec->have_new_segment = TRUE;
+
+  if (seeksegment.flags & GST_SEGMENT_FLAG_SEGMENT)
+    gst_element_post_message (GST_ELEMENT_CAST (y4mdec),
+        gst_message_new_segment_start (GST_OBJECT_CAST (y4mdec),
+            GST_FORMAT_TIME, seeksegment.position));
+
+  gst_pad_start_task (y4mdec->sinkpad, (GstTaskFunction) gst_y4m_dec_loop,
+      y4mdec->sinkpad, NULL);
+
+  GST_PAD_STREAM_UNLOCK (y4mdec->sinkpad);
+
+  return TRUE;
 }
 
 static gboolean
@@ -800,6 +1163,11 @@ gst_y4m_dec_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
       gint64 framenum;
       guint64 byte;
 
+      if (GST_PAD_MODE (y4mdec->sinkpad) == GST_PAD_MODE_PULL) {
+        res = gst_y4m_dec_handle_seek_pull (y4mdec, event);
+        break;
+      }
+
       gst_event_parse_seek (event, &rate, &format, &flags, &start_type,
           &start, &stop_type, &stop);
 
@@ -882,6 +1250,20 @@ gst_y4m_dec_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
       gst_query_unref (peer_query);
       break;
     }
+    case GST_QUERY_SEEKING:
+    {
+      GstFormat format;
+
+      if (GST_PAD_MODE (y4mdec->sinkpad) != GST_PAD_MODE_PULL) {
+        res = gst_pad_query_default (pad, parent, query);
+        break;
+      }
+
+      gst_query_parse_seeking (query, &format, NULL, NULL, NULL);
+      gst_query_set_seeking (query, format, format == GST_FORMAT_TIME, 0, -1);
+      res = TRUE;
+      break;
+    }
     default:
       res = gst_pad_query_default (pad, parent, query);
       break;
@@ -47,6 +47,7 @@ struct _GstY4mDec
   int frame_index;
   int header_size;
 
+  /* BYTES segment from upstream in push mode, TIME segment in pull mode */
   gboolean have_new_segment;
   GstSegment segment;
 
@@ -54,6 +55,12 @@ struct _GstY4mDec
   GstVideoInfo out_info;
   gboolean video_meta;
   GstBufferPool *pool;
+
+  /* pull mode */
+  guint64 offset;
+  /* buffers that frames are pulled into when no stride conversion is
+   * needed */
+  GstBufferPool *read_pool;
 };
 
 struct _GstY4mDecClass
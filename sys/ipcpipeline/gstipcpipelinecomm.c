@@ -41,6 +41,9 @@ GST_DEBUG_CATEGORY_STATIC (gst_ipc_pipeline_comm_debug);
 #define GST_CAT_DEFAULT gst_ipc_pipeline_comm_debug
 
 #define DEFAULT_ACK_TIME (10 * G_TIME_SPAN_SECOND)
+#define DEFAULT_MAX_BUFFERS_IN_FLIGHT 1
+
+#define PROTOCOL_QUERY_NAME "GstIpcPipelineProtocol"
 
 GQuark QUARK_ID;
 
@@ -68,6 +71,8 @@ typedef struct
   guint32 ret;
   GstQuery *query;
   CommRequestType type;
+  /* nobody waits on cond, the reply is accounted in the in-flight state */
+  gboolean async;
   GCond cond;
 } CommRequest;
 
@@ -88,6 +93,7 @@ comm_request_new (guint32 id, CommRequestType type, GstQuery * query)
   req->query = query;
   req->ret = comm_request_ret_get_failure_value (type);
   req->type = type;
+  req->async = FALSE;
 
   return req;
 }
@@ -192,6 +198,8 @@ gst_ipc_pipeline_comm_data_type_get_name (GstIpcPipelineCommDataType type)
       return "MESSAGE";
     case GST_IPC_PIPELINE_COMM_DATA_TYPE_GERROR_MESSAGE:
       return "GERROR_MESSAGE";
+    case GST_IPC_PIPELINE_COMM_DATA_TYPE_FLOW_ACK_BATCH:
+      return "FLOW_ACK_BATCH";
     default:
       return "UNKNOWN";
   }
@@ -218,6 +226,66 @@ gst_ipc_pipeline_comm_sync_fd (GstIpcPipelineComm * comm, guint32 id,
   return !comm_error;
 }
 
+/* must be called with the comm mutex held; the caller removes the request
+ * from waiting_ids afterwards */
+static void
+comm_request_complete_async (GstIpcPipelineComm * comm, CommRequest * req,
+    guint32 ret)
+{
+  g_assert (req->async);
+
+  GST_TRACE_OBJECT (comm->element, "Buffer %u completed: %s", req->id,
+      gst_flow_get_name (ret));
+  if (ret != GST_FLOW_OK && comm->in_flight_ret == GST_FLOW_OK)
+    comm->in_flight_ret = ret;
+  comm->buffers_in_flight--;
+  g_cond_broadcast (&comm->in_flight_cond);
+}
+
+static gboolean
+cancel_buffer_request (gpointer key, gpointer value, gpointer user_data)
+{
+  GstIpcPipelineComm *comm = (GstIpcPipelineComm *) user_data;
+  CommRequest *req = (CommRequest *) value;
+
+  if (!req->async)
+    return FALSE;
+
+  GST_TRACE_OBJECT (comm->element, "Cancelling buffer %u", req->id);
+  comm_request_complete_async (comm, req, GST_FLOW_COMM_ERROR);
+  return TRUE;
+}
+
+/* must be called with the comm mutex held; if no buffer in flight completes
+ * for ack-time, they are all cancelled and FALSE is returned */
+static gboolean
+wait_for_buffers_in_flight (GstIpcPipelineComm * comm, guint max)
+{
+  guint64 end_time = g_get_monotonic_time () + comm->ack_time;
+  guint in_flight = comm->buffers_in_flight;
+
+  while (comm->buffers_in_flight > max) {
+    if (comm->buffers_in_flight < in_flight) {
+      in_flight = comm->buffers_in_flight;
+      end_time = g_get_monotonic_time () + comm->ack_time;
+    }
+
+    GST_TRACE_OBJECT (comm->element, "Waiting for %u buffers in flight",
+        comm->buffers_in_flight - max);
+    if (!g_cond_wait_until (&comm->in_flight_cond, &comm->mutex, end_time)
+        && comm->buffers_in_flight >= in_flight) {
+      GST_ERROR_OBJECT (comm->element,
+          "Timeout waiting for replies to %u buffers in flight",
+          comm->buffers_in_flight);
+      g_hash_table_foreach_remove (comm->waiting_ids, cancel_buffer_request,
+          comm);
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
 static gboolean
 write_to_fd_raw (GstIpcPipelineComm * comm, const void *data, size_t size)
 {
@@ -262,18 +330,14 @@ write_byte_writer_to_fd (GstIpcPipelineComm * comm, GstByteWriter * bw)
   return ret;
 }
 
-static void
-gst_ipc_pipeline_comm_write_ack_to_fd (GstIpcPipelineComm * comm, guint32 id,
-    guint32 ret, CommRequestType type)
+/* must be called with the comm mutex held */
+static gboolean
+write_ack_to_fd_locked (GstIpcPipelineComm * comm, guint8 payload_type,
+    guint32 id, guint32 ret)
 {
-  const unsigned char payload_type = GST_IPC_PIPELINE_COMM_DATA_TYPE_ACK;
   guint32 size;
   GstByteWriter bw;
 
-  g_mutex_lock (&comm->mutex);
-
-  GST_TRACE_OBJECT (comm->element, "Writing ACK for %u: %s (%d)", id,
-      comm_request_ret_get_name (type, ret), ret);
   gst_byte_writer_init (&bw);
   if (!gst_byte_writer_put_uint8 (&bw, payload_type))
     goto write_failed;
@@ -288,15 +352,40 @@ gst_ipc_pipeline_comm_write_ack_to_fd (GstIpcPipelineComm * comm, guint32 id,
   if (!write_byte_writer_to_fd (comm, &bw))
     goto write_failed;
 
-done:
-  g_mutex_unlock (&comm->mutex);
-  gst_byte_writer_reset (&bw);
-  return;
+  return TRUE;
 
 write_failed:
+  gst_byte_writer_reset (&bw);
   GST_ELEMENT_ERROR (comm->element, RESOURCE, WRITE, (NULL),
       ("Failed to write to socket"));
-  goto done;
+  return FALSE;
+}
+
+/* must be called with the comm mutex held */
+static void
+flush_flow_acks_locked (GstIpcPipelineComm * comm)
+{
+  if (!comm->pending_acks)
+    return;
+
+  GST_TRACE_OBJECT (comm->element, "Writing batched ACK for %u buffers up "
+      "to %u", comm->pending_acks, comm->pending_ack_id);
+  write_ack_to_fd_locked (comm, GST_IPC_PIPELINE_COMM_DATA_TYPE_FLOW_ACK_BATCH,
+      comm->pending_ack_id, GST_FLOW_OK);
+  comm->pending_acks = 0;
+}
+
+static void
+gst_ipc_pipeline_comm_write_ack_to_fd (GstIpcPipelineComm * comm, guint32 id,
+    guint32 ret, CommRequestType type)
+{
+  g_mutex_lock (&comm->mutex);
+
+  GST_TRACE_OBJECT (comm->element, "Writing ACK for %u: %s (%d)", id,
+      comm_request_ret_get_name (type, ret), ret);
+  write_ack_to_fd_locked (comm, GST_IPC_PIPELINE_COMM_DATA_TYPE_ACK, id, ret);
+
+  g_mutex_unlock (&comm->mutex);
 }
 
 void
@@ -307,6 +396,40 @@ gst_ipc_pipeline_comm_write_flow_ack_to_fd (GstIpcPipelineComm * comm,
       COMM_REQUEST_TYPE_BUFFER);
 }
 
+/* Acknowledges a buffer. When the peer negotiated protocol version 2,
+ * successful flow returns are accumulated and sent as a single cumulative
+ * ACK once @more is FALSE (no further buffer is queued right behind this
+ * one) or the batch size agreed with the peer is reached. Failures are
+ * always sent right away, after any pending successes. */
+void
+gst_ipc_pipeline_comm_queue_flow_ack (GstIpcPipelineComm * comm, guint32 id,
+    GstFlowReturn ret, gboolean more)
+{
+  g_mutex_lock (&comm->mutex);
+
+  if (comm->ack_batch_size > 1 && ret == GST_FLOW_OK) {
+    comm->pending_ack_id = id;
+    comm->pending_acks++;
+    if (!more || comm->pending_acks >= comm->ack_batch_size)
+      flush_flow_acks_locked (comm);
+  } else {
+    flush_flow_acks_locked (comm);
+    GST_TRACE_OBJECT (comm->element, "Writing ACK for %u: %s (%d)", id,
+        gst_flow_get_name (ret), ret);
+    write_ack_to_fd_locked (comm, GST_IPC_PIPELINE_COMM_DATA_TYPE_ACK, id, ret);
+  }
+
+  g_mutex_unlock (&comm->mutex);
+}
+
+void
+gst_ipc_pipeline_comm_flush_flow_acks (GstIpcPipelineComm * comm)
+{
+  g_mutex_lock (&comm->mutex);
+  flush_flow_acks_locked (comm);
+  g_mutex_unlock (&comm->mutex);
+}
+
 void
 gst_ipc_pipeline_comm_write_boolean_ack_to_fd (GstIpcPipelineComm * comm,
     guint32 id, gboolean ret)
@@ -515,8 +638,22 @@ gst_ipc_pipeline_comm_write_buffer_to_fd (GstIpcPipelineComm * comm,
   GstFlowReturn ret;
   MetaListRepresentation repr = { comm, 0, 4, NULL };   /* starts a 4 for n_meta */
   GstByteWriter bw;
+  gboolean pipelined;
 
   g_mutex_lock (&comm->mutex);
+
+  /* With a version 2 peer, do not wait for each buffer's flow return: an
+   * error is reported on the first buffer pushed after it was received */
+  pipelined = comm->in_flight_window > 1 &&
+      comm->peer_protocol_version >= 2;
+  if (pipelined && comm->in_flight_ret != GST_FLOW_OK) {
+    ret = comm->in_flight_ret;
+    GST_DEBUG_OBJECT (comm->element, "Not writing buffer, previous flow "
+        "return was %s", gst_flow_get_name (ret));
+    g_mutex_unlock (&comm->mutex);
+    return ret;
+  }
+
   ++comm->send_id;
 
   GST_TRACE_OBJECT (comm->element, "Writing buffer %u: %" GST_PTR_FORMAT,
@@ -595,10 +732,23 @@ gst_ipc_pipeline_comm_write_buffer_to_fd (GstIpcPipelineComm * comm,
   if (!write_byte_writer_to_fd (comm, &bw))
     goto write_failed;
 
-  if (!gst_ipc_pipeline_comm_sync_fd (comm, comm->send_id, NULL, &ret32,
-          ACK_TYPE_BLOCKING, COMM_REQUEST_TYPE_BUFFER))
-    goto wait_failed;
-  ret = ret32;
+  if (pipelined) {
+    CommRequest *req;
+
+    req = comm_request_new (comm->send_id, COMM_REQUEST_TYPE_BUFFER, NULL);
+    req->async = TRUE;
+    g_hash_table_insert (comm->waiting_ids, GINT_TO_POINTER (comm->send_id),
+        req);
+    comm->buffers_in_flight++;
+    if (!wait_for_buffers_in_flight (comm, comm->in_flight_window - 1))
+      goto wait_failed;
+    ret = comm->in_flight_ret;
+  } else {
+    if (!gst_ipc_pipeline_comm_sync_fd (comm, comm->send_id, NULL, &ret32,
+            ACK_TYPE_BLOCKING, COMM_REQUEST_TYPE_BUFFER))
+      goto wait_failed;
+    ret = ret32;
+  }
 
 done:
   g_mutex_unlock (&comm->mutex);
@@ -744,13 +894,15 @@ gst_ipc_pipeline_comm_write_sink_message_event_to_fd (GstIpcPipelineComm * comm,
   g_return_val_if_fail (GST_EVENT_TYPE (event) == GST_EVENT_SINK_MESSAGE,
       FALSE);
 
+  gst_byte_writer_init (&bw);
   g_mutex_lock (&comm->mutex);
+  if (GST_EVENT_IS_SERIALIZED (event) && !wait_for_buffers_in_flight (comm, 0))
+    goto wait_failed;
   ++comm->send_id;
 
   GST_TRACE_OBJECT (comm->element,
       "Writing sink message event %u: %" GST_PTR_FORMAT, comm->send_id, event);
 
-  gst_byte_writer_init (&bw);
   if (!gst_byte_writer_put_uint8 (&bw, payload_type))
     goto write_failed;
   if (!gst_byte_writer_put_uint32_le (&bw, comm->send_id))
@@ -825,6 +977,12 @@ write_failed:
       ("Failed to write to socket"));
   ret = FALSE;
   goto done;
+
+wait_failed:
+  GST_ELEMENT_ERROR (comm->element, RESOURCE, WRITE, (NULL),
+      ("Failed to wait for reply on socket"));
+  ret = FALSE;
+  goto done;
 }
 
 static GstEvent *
@@ -914,13 +1072,17 @@ gst_ipc_pipeline_comm_write_event_to_fd (GstIpcPipelineComm * comm,
   if (GST_EVENT_TYPE (event) == GST_EVENT_SINK_MESSAGE)
     return gst_ipc_pipeline_comm_write_sink_message_event_to_fd (comm, event);
 
+  gst_byte_writer_init (&bw);
   g_mutex_lock (&comm->mutex);
+  /* serialized events are the synchronization points of pipelined buffers */
+  if (GST_EVENT_IS_SERIALIZED (event) && !upstream
+      && !wait_for_buffers_in_flight (comm, 0))
+    goto wait_failed;
   ++comm->send_id;
 
   GST_TRACE_OBJECT (comm->element, "Writing event %u: %" GST_PTR_FORMAT,
       comm->send_id, event);
 
-  gst_byte_writer_init (&bw);
   if (!gst_byte_writer_put_uint8 (&bw, payload_type))
     goto write_failed;
   if (!gst_byte_writer_put_uint32_le (&bw, comm->send_id))
@@ -976,6 +1138,10 @@ gst_ipc_pipeline_comm_write_event_to_fd (GstIpcPipelineComm * comm,
     goto write_failed;
   ret = ret32;
 
+  /* flow returns received during the flush are stale now */
+  if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP)
+    comm->in_flight_ret = GST_FLOW_OK;
+
 done:
   g_mutex_unlock (&comm->mutex);
   g_free (str);
@@ -987,6 +1153,12 @@ write_failed:
       ("Failed to write to socket"));
   ret = FALSE;
   goto done;
+
+wait_failed:
+  GST_ELEMENT_ERROR (comm->element, RESOURCE, WRITE, (NULL),
+      ("Failed to wait for reply on socket"));
+  ret = FALSE;
+  goto done;
 }
 
 static GstEvent *
@@ -1054,13 +1226,16 @@ gst_ipc_pipeline_comm_write_query_to_fd (GstIpcPipelineComm * comm,
   const GstStructure *structure;
   GstByteWriter bw;
 
+  gst_byte_writer_init (&bw);
   g_mutex_lock (&comm->mutex);
+  if (GST_QUERY_IS_SERIALIZED (query) && !upstream
+      && !wait_for_buffers_in_flight (comm, 0))
+    goto wait_failed;
   ++comm->send_id;
 
   GST_TRACE_OBJECT (comm->element, "Writing query %u: %" GST_PTR_FORMAT,
       comm->send_id, query);
 
-  gst_byte_writer_init (&bw);
   if (!gst_byte_writer_put_uint8 (&bw, payload_type))
     goto write_failed;
   if (!gst_byte_writer_put_uint32_le (&bw, comm->send_id))
@@ -1113,6 +1288,12 @@ write_failed:
       ("Failed to write to socket"));
   ret = FALSE;
   goto done;
+
+wait_failed:
+  GST_ELEMENT_ERROR (comm->element, RESOURCE, WRITE, (NULL),
+      ("Failed to wait for reply on socket"));
+  ret = FALSE;
+  goto done;
 }
 
 static GstQuery *
@@ -1601,6 +1782,90 @@ done:
   return message;
 }
 
+/* Protocol negotiation is done with a custom query, which version 1 peers
+ * will just forward to their pipeline. Only a peer that understands it
+ * fills in the peer-version field of the reply. */
+gboolean
+gst_ipc_pipeline_comm_negotiate_protocol (GstIpcPipelineComm * comm)
+{
+  GstQuery *query;
+  guint version = 1;
+  guint max_buffers_in_flight;
+
+  g_mutex_lock (&comm->mutex);
+  max_buffers_in_flight = comm->in_flight_window;
+  g_mutex_unlock (&comm->mutex);
+
+  query = gst_query_new_custom (GST_QUERY_CUSTOM,
+      gst_structure_new (PROTOCOL_QUERY_NAME,
+          "version", G_TYPE_UINT, GST_IPC_PIPELINE_COMM_PROTOCOL_VERSION,
+          "max-buffers-in-flight", G_TYPE_UINT, max_buffers_in_flight, NULL));
+
+  if (gst_ipc_pipeline_comm_write_query_to_fd (comm, FALSE, query)) {
+    if (!gst_structure_get_uint (gst_query_get_structure (query),
+            "peer-version", &version))
+      version = 1;
+  }
+  gst_query_unref (query);
+
+  version = MIN (version, GST_IPC_PIPELINE_COMM_PROTOCOL_VERSION);
+  GST_DEBUG_OBJECT (comm->element, "Negotiated protocol version %u", version);
+
+  g_mutex_lock (&comm->mutex);
+  comm->peer_protocol_version = version;
+  g_mutex_unlock (&comm->mutex);
+
+  return version >= 2;
+}
+
+gboolean
+gst_ipc_pipeline_comm_is_protocol_query (GstQuery * query)
+{
+  const GstStructure *structure;
+
+  if (GST_QUERY_TYPE (query) != GST_QUERY_CUSTOM)
+    return FALSE;
+  structure = gst_query_get_structure (query);
+  return structure && gst_structure_has_name (structure, PROTOCOL_QUERY_NAME);
+}
+
+void
+gst_ipc_pipeline_comm_answer_protocol_query (GstIpcPipelineComm * comm,
+    guint32 id, GstQuery * query)
+{
+  GstStructure *structure;
+  guint version = 1, max_buffers_in_flight = 1;
+
+  structure = gst_query_writable_structure (query);
+  gst_structure_get_uint (structure, "version", &version);
+  gst_structure_get_uint (structure, "max-buffers-in-flight",
+      &max_buffers_in_flight);
+  version = MIN (version, GST_IPC_PIPELINE_COMM_PROTOCOL_VERSION);
+
+  g_mutex_lock (&comm->mutex);
+  flush_flow_acks_locked (comm);
+  comm->peer_protocol_version = version;
+  /* ACK half a window at a time so the sender never runs dry */
+  comm->ack_batch_size = version >= 2 ? max_buffers_in_flight / 2 : 0;
+  GST_DEBUG_OBJECT (comm->element, "Peer uses protocol version %u, "
+      "batching up to %u flow ACKs", version, comm->ack_batch_size);
+  g_mutex_unlock (&comm->mutex);
+
+  gst_structure_set (structure, "peer-version", G_TYPE_UINT, version, NULL);
+  gst_ipc_pipeline_comm_write_query_result_to_fd (comm, id, TRUE, query);
+}
+
+/* Forget about flow returns received for pipelined buffers, and take the
+ * number of buffers in flight to use until the next call */
+void
+gst_ipc_pipeline_comm_reset_flow (GstIpcPipelineComm * comm)
+{
+  g_mutex_lock (&comm->mutex);
+  comm->in_flight_ret = GST_FLOW_OK;
+  comm->in_flight_window = comm->max_buffers_in_flight;
+  g_mutex_unlock (&comm->mutex);
+}
+
 void
 gst_ipc_pipeline_comm_init (GstIpcPipelineComm * comm, GstElement * element)
 {
@@ -1608,6 +1873,14 @@ gst_ipc_pipeline_comm_init (GstIpcPipelineComm * comm, GstElement * element)
   comm->element = element;
   comm->fdin = comm->fdout = -1;
   comm->ack_time = DEFAULT_ACK_TIME;
+  comm->peer_protocol_version = 1;
+  comm->max_buffers_in_flight = DEFAULT_MAX_BUFFERS_IN_FLIGHT;
+  comm->in_flight_window = 1;
+  comm->buffers_in_flight = 0;
+  comm->in_flight_ret = GST_FLOW_OK;
+  g_cond_init (&comm->in_flight_cond);
+  comm->ack_batch_size = 0;
+  comm->pending_acks = 0;
   comm->waiting_ids =
       g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
       (GDestroyNotify) comm_request_free);
@@ -1622,6 +1895,7 @@ gst_ipc_pipeline_comm_clear (GstIpcPipelineComm * comm)
   g_hash_table_destroy (comm->waiting_ids);
   gst_object_unref (comm->adapter);
   gst_poll_free (comm->poll);
+  g_cond_clear (&comm->in_flight_cond);
   g_mutex_clear (&comm->mutex);
 }
 
@@ -1640,20 +1914,29 @@ cancel_request (gpointer key, gpointer value, gpointer user_data,
   g_cond_signal (&req->cond);
 }
 
-static void
+static gboolean
 cancel_request_error (gpointer key, gpointer value, gpointer user_data)
 {
+  GstIpcPipelineComm *comm = (GstIpcPipelineComm *) user_data;
   CommRequest *req = (CommRequest *) value;
   GstFlowReturn fret = comm_request_ret_get_failure_value (req->type);
 
   cancel_request (key, value, user_data, fret);
+
+  /* synchronous requests are removed by their waiter */
+  if (req->async) {
+    comm_request_complete_async (comm, req, fret);
+    return TRUE;
+  }
+  return FALSE;
 }
 
 void
 gst_ipc_pipeline_comm_cancel (GstIpcPipelineComm * comm, gboolean cleanup)
 {
   g_mutex_lock (&comm->mutex);
-  g_hash_table_foreach (comm->waiting_ids, cancel_request_error, comm);
+  g_hash_table_foreach_remove (comm->waiting_ids, cancel_request_error, comm);
+  comm->pending_acks = 0;
   if (cleanup) {
     g_hash_table_unref (comm->waiting_ids);
     comm->waiting_ids =
@@ -1687,6 +1970,11 @@ gst_ipc_pipeline_comm_reply_request (GstIpcPipelineComm * comm, guint32 id,
 
   GST_TRACE_OBJECT (comm->element, "Got reply %d (%s) for request %u", ret,
       comm_request_ret_get_name (req->type, ret), req->id);
+  if (req->async) {
+    comm_request_complete_async (comm, req, ret);
+    g_hash_table_remove (comm->waiting_ids, GINT_TO_POINTER (id));
+    return TRUE;
+  }
   req->replied = TRUE;
   req->ret = ret;
   if (query) {
@@ -1706,6 +1994,41 @@ gst_ipc_pipeline_comm_reply_request (GstIpcPipelineComm * comm, guint32 id,
   return TRUE;
 }
 
+typedef struct
+{
+  GstIpcPipelineComm *comm;
+  guint32 id;
+  guint32 ret;
+} BatchReply;
+
+static gboolean
+reply_batched_request (gpointer key, gpointer value, gpointer user_data)
+{
+  BatchReply *batch = user_data;
+  CommRequest *req = (CommRequest *) value;
+
+  /* ids wrap around, so compare them as a signed distance */
+  if (!req->async || (gint32) (req->id - batch->id) > 0)
+    return FALSE;
+
+  comm_request_complete_async (batch->comm, req, batch->ret);
+  return TRUE;
+}
+
+/* A batched ACK completes all pipelined buffers up to and including @id */
+static void
+gst_ipc_pipeline_comm_reply_batch (GstIpcPipelineComm * comm, guint32 id,
+    guint32 ret)
+{
+  BatchReply batch = { comm, id, ret };
+  guint n;
+
+  n = g_hash_table_foreach_remove (comm->waiting_ids, reply_batched_request,
+      &batch);
+  GST_TRACE_OBJECT (comm->element, "Batched reply %s up to %u completed %u "
+      "buffers", gst_flow_get_name (ret), id, n);
+}
+
 static gint
 update_adapter (GstIpcPipelineComm * comm)
 {
@@ -1817,6 +2140,7 @@ read_many (GstIpcPipelineComm * comm)
           case GST_IPC_PIPELINE_COMM_DATA_TYPE_STATE_LOST:
           case GST_IPC_PIPELINE_COMM_DATA_TYPE_MESSAGE:
           case GST_IPC_PIPELINE_COMM_DATA_TYPE_GERROR_MESSAGE:
+          case GST_IPC_PIPELINE_COMM_DATA_TYPE_FLOW_ACK_BATCH:
             GST_TRACE_OBJECT (comm->element, "switching to state %s",
                 gst_ipc_pipeline_comm_data_type_get_name (type));
             comm->state = type;
@@ -1853,6 +2177,33 @@ read_many (GstIpcPipelineComm * comm)
         comm->state = GST_IPC_PIPELINE_COMM_STATE_TYPE;
         break;
       }
+      case GST_IPC_PIPELINE_COMM_DATA_TYPE_FLOW_ACK_BATCH:
+      {
+        const guint8 *rets;
+        guint32 ret32;
+
+        available = gst_adapter_available (comm->adapter);
+        if (available < comm->payload_length)
+          goto done;
+
+        if (available < sizeof (guint32))
+          goto ack_failed;
+
+        rets = gst_adapter_map (comm->adapter, sizeof (guint32));
+        memcpy (&ret32, rets, sizeof (ret32));
+        gst_adapter_unmap (comm->adapter);
+        gst_adapter_flush (comm->adapter, sizeof (guint32));
+        GST_TRACE_OBJECT (comm->element, "Got batched ACK %s up to id %u",
+            gst_flow_get_name (ret32), comm->id);
+
+        g_mutex_lock (&comm->mutex);
+        gst_ipc_pipeline_comm_reply_batch (comm, comm->id, ret32);
+        g_mutex_unlock (&comm->mutex);
+
+        GST_TRACE_OBJECT (comm->element, "switching to state TYPE");
+        comm->state = GST_IPC_PIPELINE_COMM_STATE_TYPE;
+        break;
+      }
       case GST_IPC_PIPELINE_COMM_DATA_TYPE_QUERY_RESULT:
       {
         GstQuery *query = NULL;
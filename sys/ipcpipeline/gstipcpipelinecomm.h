@@ -31,6 +31,11 @@ G_BEGIN_DECLS
 
 #define GST_FLOW_COMM_ERROR GST_FLOW_CUSTOM_ERROR_1
 
+/* Version 1 peers ACK every buffer individually and the sender waits for
+ * each ACK. Version 2 peers may have several buffers in flight and send
+ * cumulative flow ACKs (see protocol.txt). */
+#define GST_IPC_PIPELINE_COMM_PROTOCOL_VERSION 2
+
 extern GQuark QUARK_ID;
 
 typedef enum {
@@ -51,6 +56,8 @@ typedef enum {
   GST_IPC_PIPELINE_COMM_DATA_TYPE_STATE_LOST,
   GST_IPC_PIPELINE_COMM_DATA_TYPE_MESSAGE,
   GST_IPC_PIPELINE_COMM_DATA_TYPE_GERROR_MESSAGE,
+  /* reply types, protocol version 2 */
+  GST_IPC_PIPELINE_COMM_DATA_TYPE_FLOW_ACK_BATCH,
 } GstIpcPipelineCommDataType;
 
 typedef struct
@@ -76,6 +83,22 @@ typedef struct
   guint read_chunk_size;
   GstClockTime ack_time;
 
+  /* negotiated with the peer, 1 until negotiation succeeds */
+  guint32 peer_protocol_version;
+
+  /* sender side of pipelined buffers */
+  guint max_buffers_in_flight;
+  /* max_buffers_in_flight, latched at READY to PAUSED */
+  guint in_flight_window;
+  guint buffers_in_flight;
+  GstFlowReturn in_flight_ret;
+  GCond in_flight_cond;
+
+  /* receiver side of pipelined buffers */
+  guint ack_batch_size;
+  guint pending_acks;
+  guint32 pending_ack_id;
+
   void (*on_buffer) (guint32, GstBuffer *, gpointer);
   void (*on_event) (guint32, GstEvent *, gboolean, gpointer);
   void (*on_query) (guint32, GstQuery *, gboolean, gpointer);
@@ -95,6 +118,9 @@ void gst_ipc_pipeline_comm_cancel (GstIpcPipelineComm * comm,
 
 void gst_ipc_pipeline_comm_write_flow_ack_to_fd (GstIpcPipelineComm * comm,
     guint32 id, GstFlowReturn ret);
+void gst_ipc_pipeline_comm_queue_flow_ack (GstIpcPipelineComm * comm,
+    guint32 id, GstFlowReturn ret, gboolean more);
+void gst_ipc_pipeline_comm_flush_flow_acks (GstIpcPipelineComm * comm);
 void gst_ipc_pipeline_comm_write_boolean_ack_to_fd (GstIpcPipelineComm * comm,
     guint32 id, gboolean ret);
 void gst_ipc_pipeline_comm_write_state_change_ack_to_fd (
@@ -115,6 +141,12 @@ void gst_ipc_pipeline_comm_write_state_lost_to_fd (GstIpcPipelineComm * comm);
 gboolean gst_ipc_pipeline_comm_write_message_to_fd (GstIpcPipelineComm * comm,
     GstMessage *message);
 
+gboolean gst_ipc_pipeline_comm_negotiate_protocol (GstIpcPipelineComm * comm);
+gboolean gst_ipc_pipeline_comm_is_protocol_query (GstQuery * query);
+void gst_ipc_pipeline_comm_answer_protocol_query (GstIpcPipelineComm * comm,
+    guint32 id, GstQuery * query);
+void gst_ipc_pipeline_comm_reset_flow (GstIpcPipelineComm * comm);
+
 gboolean gst_ipc_pipeline_comm_start_reader_thread (GstIpcPipelineComm * comm,
     void (*on_buffer) (guint32, GstBuffer *, gpointer),
     void (*on_event) (guint32, GstEvent *, gboolean, gpointer),
@@ -67,6 +67,14 @@
  *
  * Buffers are transported by writing their content directly on the socket.
  * More efficient ways for memory sharing could be implemented in the future.
+ *
+ * By default, every buffer waits for the flow return of the slave pipeline
+ * before the next one is sent. Setting #GstIpcPipelineSink:max-buffers-in-flight
+ * above 1 lets that many buffers be sent ahead, with the slave acknowledging
+ * them in batches. A non-OK flow return is then reported on the next buffer
+ * pushed into ipcpipelinesink, and serialized events and queries wait for all
+ * buffers in flight to be acknowledged. This requires an ipcpipelinesrc that
+ * supports it; older ones are detected and fall back to one buffer at a time.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -98,11 +106,14 @@ enum
   PROP_FDOUT,
   PROP_READ_CHUNK_SIZE,
   PROP_ACK_TIME,
+  PROP_MAX_BUFFERS_IN_FLIGHT,
+  PROP_PROTOCOL_VERSION,
 };
 
 
 #define DEFAULT_READ_CHUNK_SIZE 4096
 #define DEFAULT_ACK_TIME (10 * G_TIME_SPAN_SECOND)
+#define DEFAULT_MAX_BUFFERS_IN_FLIGHT 1
 
 #define _do_init \
     GST_DEBUG_CATEGORY_INIT (gst_ipc_pipeline_sink_debug, "ipcpipelinesink", 0, "ipcpipelinesink element");
@@ -174,6 +185,36 @@ gst_ipc_pipeline_sink_class_init (GstIpcPipelineSinkClass * klass)
           "Maximum time to wait for a response to a message",
           0, G_MAXUINT64, DEFAULT_ACK_TIME,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstIpcPipelineSink:max-buffers-in-flight:
+   *
+   * Maximum number of buffers sent to the slave pipeline before waiting for
+   * their flow return. 1 waits for every buffer. Takes effect at the next
+   * READY to PAUSED state change.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_BUFFERS_IN_FLIGHT,
+      g_param_spec_uint ("max-buffers-in-flight", "Max buffers in flight",
+          "Maximum number of buffers sent without waiting for their flow "
+          "return (1 = synchronous)", 1, G_MAXUINT16,
+          DEFAULT_MAX_BUFFERS_IN_FLIGHT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstIpcPipelineSink:protocol-version:
+   *
+   * Version of the protocol negotiated with the ipcpipelinesrc element at
+   * the READY to PAUSED state change, if
+   * #GstIpcPipelineSink:max-buffers-in-flight is more than 1. Buffers are
+   * only sent without waiting for their flow return from version 2 on.
+   *
+   * Since: 1.18
+   */
+  g_object_class_install_property (gobject_class, PROP_PROTOCOL_VERSION,
+      g_param_spec_uint ("protocol-version", "Protocol version",
+          "Version of the protocol negotiated with the peer", 1,
+          GST_IPC_PIPELINE_COMM_PROTOCOL_VERSION, 1,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
   gst_ipc_pipeline_sink_signals[SIGNAL_DISCONNECT] =
       g_signal_new ("disconnect",
@@ -210,6 +251,7 @@ gst_ipc_pipeline_sink_init (GstIpcPipelineSink * sink)
   gst_ipc_pipeline_comm_init (&sink->comm, GST_ELEMENT (sink));
   sink->comm.read_chunk_size = DEFAULT_READ_CHUNK_SIZE;
   sink->comm.ack_time = DEFAULT_ACK_TIME;
+  sink->comm.max_buffers_in_flight = DEFAULT_MAX_BUFFERS_IN_FLIGHT;
   sink->comm.fdin = -1;
   sink->comm.fdout = -1;
   sink->threads = g_thread_pool_new (pusher, sink, -1, FALSE, NULL);
@@ -271,6 +313,11 @@ gst_ipc_pipeline_sink_set_property (GObject * object, guint prop_id,
     case PROP_ACK_TIME:
       sink->comm.ack_time = g_value_get_uint64 (value);
       break;
+    case PROP_MAX_BUFFERS_IN_FLIGHT:
+      g_mutex_lock (&sink->comm.mutex);
+      sink->comm.max_buffers_in_flight = g_value_get_uint (value);
+      g_mutex_unlock (&sink->comm.mutex);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -296,6 +343,16 @@ gst_ipc_pipeline_sink_get_property (GObject * object, guint prop_id,
     case PROP_ACK_TIME:
       g_value_set_uint64 (value, sink->comm.ack_time);
       break;
+    case PROP_MAX_BUFFERS_IN_FLIGHT:
+      g_mutex_lock (&sink->comm.mutex);
+      g_value_set_uint (value, sink->comm.max_buffers_in_flight);
+      g_mutex_unlock (&sink->comm.mutex);
+      break;
+    case PROP_PROTOCOL_VERSION:
+      g_mutex_lock (&sink->comm.mutex);
+      g_value_set_uint (value, sink->comm.peer_protocol_version);
+      g_mutex_unlock (&sink->comm.mutex);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -577,6 +634,7 @@ gst_ipc_pipeline_sink_disconnect (GstIpcPipelineSink * sink)
   sink->comm.fdin = -1;
   sink->comm.fdout = -1;
   gst_ipc_pipeline_comm_cancel (&sink->comm, FALSE);
+  sink->comm.peer_protocol_version = 1;
   gst_ipc_pipeline_sink_start_reader_thread (sink);
 }
 
@@ -642,6 +700,13 @@ gst_ipc_pipeline_sink_change_state (GstElement * element,
     GST_OBJECT_UNLOCK (sink);
   }
 
+  /* agree on the protocol version before any buffer gets sent */
+  if (transition == GST_STATE_CHANGE_READY_TO_PAUSED) {
+    gst_ipc_pipeline_comm_reset_flow (&sink->comm);
+    if (sink->comm.fdout >= 0 && sink->comm.in_flight_window > 1)
+      gst_ipc_pipeline_comm_negotiate_protocol (&sink->comm);
+  }
+
   /* change the state of the peer first */
   /* If the fd out is -1, we do not actually call the peer. This will happen
      when we explicitly disconnected, and in that case we want to be able
@@ -317,6 +317,8 @@ gst_ipc_pipeline_src_cancel_queued (GstIpcPipelineSrc * src)
   g_cond_broadcast (&src->create_cond);
   g_mutex_unlock (&src->comm.mutex);
 
+  gst_ipc_pipeline_comm_flush_flow_acks (&src->comm);
+
   while (queued) {
     void *object = queued->data;
 
@@ -456,7 +458,7 @@ gst_ipc_pipeline_src_loop (GstIpcPipelineSrc * src)
 {
   gpointer object;
   guint32 id;
-  gboolean ok;
+  gboolean ok, more;
   GstFlowReturn ret = GST_FLOW_OK;
 
   g_mutex_lock (&src->comm.mutex);
@@ -480,7 +482,11 @@ gst_ipc_pipeline_src_loop (GstIpcPipelineSrc * src)
     ret = gst_pad_push (src->srcpad, buf);
     GST_DEBUG_OBJECT (src, "pushed id %u, ret: %s", id,
         gst_flow_get_name (ret));
-    gst_ipc_pipeline_comm_write_flow_ack_to_fd (&src->comm, id, ret);
+    /* the ACK may be coalesced with the ones of the buffers queued behind */
+    g_mutex_lock (&src->comm.mutex);
+    more = src->queued && GST_IS_BUFFER (src->queued->data);
+    g_mutex_unlock (&src->comm.mutex);
+    gst_ipc_pipeline_comm_queue_flow_ack (&src->comm, id, ret, more);
   } else if (GST_IS_EVENT (object)) {
     GstEvent *event = GST_EVENT (object);
     GST_DEBUG_OBJECT (src, "Pushing queued event: %" GST_PTR_FORMAT, event);
@@ -774,6 +780,12 @@ on_query (guint32 id, GstQuery * query, gboolean upstream, gpointer user_data)
   GST_DEBUG_OBJECT (src, "Got query id %u, queueing: %" GST_PTR_FORMAT, id,
       query);
 
+  if (gst_ipc_pipeline_comm_is_protocol_query (query)) {
+    gst_ipc_pipeline_comm_answer_protocol_query (&src->comm, id, query);
+    gst_query_unref (query);
+    return;
+  }
+
   if (GST_QUERY_IS_SERIALIZED (query) && !upstream) {
     g_mutex_lock (&src->comm.mutex);
     src->queued = g_list_append (src->queued, query);   /* keep the ref */
@@ -919,6 +931,9 @@ gst_ipc_pipeline_src_disconnect (GstIpcPipelineSrc * src)
   src->comm.fdin = -1;
   src->comm.fdout = -1;
   gst_ipc_pipeline_comm_cancel (&src->comm, FALSE);
+  /* a new peer will negotiate again */
+  src->comm.peer_protocol_version = 1;
+  src->comm.ack_batch_size = 0;
   gst_ipc_pipeline_src_start_reader_thread (src);
 }
 
@@ -0,0 +1,379 @@
+/* GStreamer unit test for audiomixmatrix
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <math.h>
+
+#include <gst/check/gstcheck.h>
+#include <gst/audio/audio.h>
+
+static const GstAudioFormat formats[] = {
+  GST_AUDIO_FORMAT_S16,
+  GST_AUDIO_FORMAT_S32,
+  GST_AUDIO_FORMAT_F32,
+  GST_AUDIO_FORMAT_F64,
+};
+
+static void
+set_matrix (GstElement * element, const gdouble * matrix, guint in_channels,
+    guint out_channels)
+{
+  GValue v = G_VALUE_INIT;
+  guint in, out;
+
+  g_value_init (&v, GST_TYPE_ARRAY);
+  for (out = 0; out < out_channels; out++) {
+    GValue row = G_VALUE_INIT;
+
+    g_value_init (&row, GST_TYPE_ARRAY);
+    for (in = 0; in < in_channels; in++) {
+      GValue itm = G_VALUE_INIT;
+
+      g_value_init (&itm, G_TYPE_DOUBLE);
+      g_value_set_double (&itm, matrix[out * in_channels + in]);
+      gst_value_array_append_and_take_value (&row, &itm);
+    }
+    gst_value_array_append_and_take_value (&v, &row);
+  }
+  g_object_set_property (G_OBJECT (element), "matrix", &v);
+  g_value_unset (&v);
+}
+
+static GstHarness *
+setup_harness (const gdouble * matrix, guint in_channels, guint out_channels,
+    GstAudioFormat format)
+{
+  GstHarness *h;
+  GstCaps *caps;
+
+  h = gst_harness_new ("audiomixmatrix");
+  g_object_set (h->element, "in-channels", in_channels, "out-channels",
+      out_channels, NULL);
+  set_matrix (h->element, matrix, in_channels, out_channels);
+
+  caps = gst_caps_new_simple ("audio/x-raw",
+      "format", G_TYPE_STRING, gst_audio_format_to_string (format),
+      "layout", G_TYPE_STRING, "interleaved",
+      "rate", G_TYPE_INT, 48000,
+      "channels", G_TYPE_INT, in_channels,
+      "channel-mask", GST_TYPE_BITMASK, (guint64) 0, NULL);
+  gst_harness_set_src_caps (h, caps);
+
+  return h;
+}
+
+/* straightforward version of the mixing, using the same fixed point
+ * conversion for the integer formats as the element */
+static void
+reference_mix (const gdouble * matrix, guint in_channels, guint out_channels,
+    GstAudioFormat format, gconstpointer indata, gpointer outdata,
+    guint n_frames)
+{
+  guint sample, in, out;
+
+  for (sample = 0; sample < n_frames; sample++) {
+    for (out = 0; out < out_channels; out++) {
+      const gdouble *row = matrix + out * in_channels;
+
+      switch (format) {
+        case GST_AUDIO_FORMAT_S16:{
+          const gint16 *inarray = (const gint16 *) indata + sample * in_channels;
+          gint shift = 32 - 16 - 1 - ceil (log (in_channels) / log (2));
+          gint32 outval = 0;
+
+          for (in = 0; in < in_channels; in++)
+            outval += inarray[in] * (gint32) (row[in] * (1 << shift));
+          ((gint16 *) outdata)[sample * out_channels + out] = outval >> shift;
+          break;
+        }
+        case GST_AUDIO_FORMAT_S32:{
+          const gint32 *inarray = (const gint32 *) indata + sample * in_channels;
+          gint shift = 64 - 32 - 1 - (gint) (log (in_channels) / log (2));
+          gint64 outval = 0;
+
+          for (in = 0; in < in_channels; in++)
+            outval += inarray[in] * (gint64) (row[in] * ((gint64) 1 << shift));
+          ((gint32 *) outdata)[sample * out_channels + out] = outval >> shift;
+          break;
+        }
+        case GST_AUDIO_FORMAT_F32:{
+          const gfloat *inarray = (const gfloat *) indata + sample * in_channels;
+          gfloat outval = 0;
+
+          for (in = 0; in < in_channels; in++)
+            outval += inarray[in] * row[in];
+          ((gfloat *) outdata)[sample * out_channels + out] = outval;
+          break;
+        }
+        case GST_AUDIO_FORMAT_F64:{
+          const gdouble *inarray =
+              (const gdouble *) indata + sample * in_channels;
+          gdouble outval = 0;
+
+          for (in = 0; in < in_channels; in++)
+            outval += inarray[in] * row[in];
+          ((gdouble *) outdata)[sample * out_channels + out] = outval;
+          break;
+        }
+        default:
+          g_assert_not_reached ();
+      }
+    }
+  }
+}
+
+static GstBuffer *
+create_input_buffer (GstAudioFormat format, guint channels, guint n_frames)
+{
+  const GstAudioFormatInfo *finfo = gst_audio_format_get_info (format);
+  guint i, n = channels * n_frames;
+  GstBuffer *buffer;
+  GstMapInfo map;
+
+  buffer = gst_buffer_new_allocate (NULL, n * finfo->width / 8, NULL);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  for (i = 0; i < n; i++) {
+    switch (format) {
+      case GST_AUDIO_FORMAT_S16:
+        ((gint16 *) map.data)[i] = g_random_int ();
+        break;
+      case GST_AUDIO_FORMAT_S32:
+        ((gint32 *) map.data)[i] = g_random_int ();
+        break;
+      case GST_AUDIO_FORMAT_F32:
+        ((gfloat *) map.data)[i] = g_random_double_range (-1.0, 1.0);
+        break;
+      case GST_AUDIO_FORMAT_F64:
+        ((gdouble *) map.data)[i] = g_random_double_range (-1.0, 1.0);
+        break;
+      default:
+        g_assert_not_reached ();
+    }
+  }
+  gst_buffer_unmap (buffer, &map);
+
+  return buffer;
+}
+
+static void
+compare_output (GstAudioFormat format, const guint8 * data,
+    const guint8 * expected, guint n)
+{
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    switch (format) {
+      case GST_AUDIO_FORMAT_S16:
+        fail_unless_equals_int (((gint16 *) data)[i],
+            ((gint16 *) expected)[i]);
+        break;
+      case GST_AUDIO_FORMAT_S32:
+        fail_unless_equals_int (((gint32 *) data)[i],
+            ((gint32 *) expected)[i]);
+        break;
+      case GST_AUDIO_FORMAT_F32:
+        fail_unless (fabs (((gfloat *) data)[i] - ((gfloat *) expected)[i]) <
+            1e-5);
+        break;
+      case GST_AUDIO_FORMAT_F64:
+        fail_unless (fabs (((gdouble *) data)[i] - ((gdouble *) expected)[i]) <
+            1e-9);
+        break;
+      default:
+        g_assert_not_reached ();
+    }
+  }
+}
+
+/* Runs @n_buffers buffers through the element and checks the output against
+ * the reference loop. Returns the time spent in the element and in the
+ * reference loop, in microseconds. */
+static void
+check_matrix_format (const gdouble * matrix, guint in_channels,
+    guint out_channels, GstAudioFormat format, guint n_frames,
+    guint n_buffers, gint64 * element_time, gint64 * reference_time)
+{
+  GstHarness *h;
+  GstBuffer *inbuf, *outbuf;
+  GstMapInfo inmap, outmap;
+  guint bps = gst_audio_format_get_info (format)->width / 8;
+  guint8 *expected;
+  gint64 start;
+  guint i;
+
+  h = setup_harness (matrix, in_channels, out_channels, format);
+  inbuf = create_input_buffer (format, in_channels, n_frames);
+  expected = g_malloc (out_channels * n_frames * bps);
+
+  *element_time = *reference_time = 0;
+
+  for (i = 0; i < n_buffers; i++) {
+    start = g_get_monotonic_time ();
+    outbuf = gst_harness_push_and_pull (h, gst_buffer_ref (inbuf));
+    *element_time += g_get_monotonic_time () - start;
+    fail_unless (outbuf != NULL);
+
+    gst_buffer_map (inbuf, &inmap, GST_MAP_READ);
+    start = g_get_monotonic_time ();
+    reference_mix (matrix, in_channels, out_channels, format, inmap.data,
+        expected, n_frames);
+    *reference_time += g_get_monotonic_time () - start;
+    gst_buffer_unmap (inbuf, &inmap);
+
+    fail_unless_equals_int (gst_buffer_get_size (outbuf),
+        out_channels * n_frames * bps);
+    gst_buffer_map (outbuf, &outmap, GST_MAP_READ);
+    compare_output (format, outmap.data, expected, out_channels * n_frames);
+    gst_buffer_unmap (outbuf, &outmap);
+    gst_buffer_unref (outbuf);
+  }
+
+  g_free (expected);
+  gst_buffer_unref (inbuf);
+  gst_harness_teardown (h);
+}
+
+static void
+check_matrix (const gdouble * matrix, guint in_channels, guint out_channels)
+{
+  gint64 element_time, reference_time;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    check_matrix_format (matrix, in_channels, out_channels, formats[i], 1024,
+        1, &element_time, &reference_time);
+  }
+}
+
+GST_START_TEST (test_identity)
+{
+  gdouble matrix[8 * 8];
+  guint in, out;
+
+  for (out = 0; out < 8; out++)
+    for (in = 0; in < 8; in++)
+      matrix[out * 8 + in] = (in == out);
+
+  check_matrix (matrix, 8, 8);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_routing)
+{
+  gdouble matrix[4 * 8] = { 0, };
+
+  /* pick channels out of order, and leave one output silent */
+  matrix[0 * 8 + 6] = 1;
+  matrix[1 * 8 + 1] = 1;
+  matrix[3 * 8 + 1] = 1;
+
+  check_matrix (matrix, 8, 4);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_sparse)
+{
+  gdouble matrix[16 * 16] = { 0, };
+  guint out;
+
+  for (out = 0; out < 16; out++) {
+    matrix[out * 16 + out] = 0.5;
+    matrix[out * 16 + (out + 5) % 16] = -0.25;
+  }
+
+  check_matrix (matrix, 16, 16);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_dense)
+{
+  gdouble matrix[2 * 6];
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (matrix); i++)
+    matrix[i] = g_random_double_range (-0.5, 0.5);
+
+  check_matrix (matrix, 6, 2);
+}
+
+GST_END_TEST;
+
+/* not a pass/fail test, compares 64 channel routing matrices against the
+ * plain loop the element used to run and logs the timings */
+GST_START_TEST (test_benchmark)
+{
+  gdouble *matrix = g_new0 (gdouble, 64 * 64);
+  gint64 element_time, reference_time;
+  guint i, in, out, kind;
+  const gchar *kinds[] = { "identity", "routing", "sparse", "dense" };
+
+  for (kind = 0; kind < G_N_ELEMENTS (kinds); kind++) {
+    for (out = 0; out < 64; out++) {
+      for (in = 0; in < 64; in++) {
+        gdouble c = 0;
+
+        if (kind == 0)
+          c = (in == out);
+        else if (kind == 1)
+          c = (in == (out * 7) % 64);
+        else if (kind == 2)
+          c = (in == out || in == (out + 1) % 64) ? 0.5 : 0;
+        else
+          c = g_random_double_range (-1.0 / 64, 1.0 / 64);
+        matrix[out * 64 + in] = c;
+      }
+    }
+
+    for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+      check_matrix_format (matrix, 64, 64, formats[i], 4800, 10,
+          &element_time, &reference_time);
+      GST_INFO ("%s %s: element %" G_GINT64_FORMAT " us, plain loop %"
+          G_GINT64_FORMAT " us", kinds[kind],
+          gst_audio_format_to_string (formats[i]), element_time,
+          reference_time);
+    }
+  }
+
+  g_free (matrix);
+}
+
+GST_END_TEST;
+
+static Suite *
+audiomixmatrix_suite (void)
+{
+  Suite *s = suite_create ("audiomixmatrix");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_identity);
+  tcase_add_test (tc_chain, test_routing);
+  tcase_add_test (tc_chain, test_sparse);
+  tcase_add_test (tc_chain, test_dense);
+  tcase_add_test (tc_chain, test_benchmark);
+
+  return s;
+}
+
+GST_CHECK_MAIN (audiomixmatrix);
@@ -0,0 +1,201 @@
+/* GStreamer unit test for bayer2rgb
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/video/video.h>
+
+#define WIDTH 320
+#define HEIGHT 242
+
+static gint
+bayer_bits (const gchar * format)
+{
+  return strlen (format) > 4 ? atoi (format + 4) : 8;
+}
+
+static GstBuffer *
+create_bayer_buffer (const gchar * format, gboolean random, guint value)
+{
+  gint bits = bayer_bits (format);
+  gint bpp = bits > 8 ? 2 : 1;
+  gint stride = GST_ROUND_UP_4 (WIDTH) * bpp;
+  gboolean be = g_str_has_suffix (format, "be");
+  GstBuffer *buf;
+  GstMapInfo map;
+  gint x, y;
+
+  buf = gst_buffer_new_allocate (NULL, stride * HEIGHT, NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memset (map.data, 0, map.size);
+  for (y = 0; y < HEIGHT; y++) {
+    for (x = 0; x < WIDTH; x++) {
+      guint v = random ? g_random_int_range (0, 1 << bits) : value;
+      guint8 *p = map.data + y * stride + x * bpp;
+
+      if (bpp == 1)
+        *p = v;
+      else if (be)
+        GST_WRITE_UINT16_BE (p, v);
+      else
+        GST_WRITE_UINT16_LE (p, v);
+    }
+  }
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+static GstBuffer *
+convert (const gchar * in_format, const gchar * out_format, guint n_threads,
+    GstBuffer * inbuf)
+{
+  GstHarness *h;
+  GstBuffer *outbuf;
+  gchar *caps;
+
+  h = gst_harness_new ("bayer2rgb");
+  g_object_set (h->element, "n-threads", n_threads, NULL);
+
+  caps = g_strdup_printf ("video/x-bayer,format=%s,width=%d,height=%d,"
+      "framerate=30/1", in_format, WIDTH, HEIGHT);
+  gst_harness_set_src_caps_str (h, caps);
+  g_free (caps);
+  caps = g_strdup_printf ("video/x-raw,format=%s,width=%d,height=%d,"
+      "framerate=30/1", out_format, WIDTH, HEIGHT);
+  gst_harness_set_sink_caps_str (h, caps);
+  g_free (caps);
+
+  outbuf = gst_harness_push_and_pull (h, gst_buffer_ref (inbuf));
+  fail_unless (outbuf != NULL);
+
+  gst_harness_teardown (h);
+
+  return outbuf;
+}
+
+static void
+check_buffers_equal (GstBuffer * a, GstBuffer * b)
+{
+  GstMapInfo map_a, map_b;
+
+  gst_buffer_map (a, &map_a, GST_MAP_READ);
+  gst_buffer_map (b, &map_b, GST_MAP_READ);
+  fail_unless_equals_int (map_a.size, map_b.size);
+  fail_unless (memcmp (map_a.data, map_b.data, map_a.size) == 0);
+  gst_buffer_unmap (a, &map_a);
+  gst_buffer_unmap (b, &map_b);
+}
+
+static const gchar *in_formats[] = {
+  "bggr", "grbg", "gbrg", "rggb", "bggr10le", "rggb12be", "gbrg16le",
+};
+
+static const gchar *out_formats[] = {
+  "BGRA", "xRGB", "I420", "NV12",
+};
+
+GST_START_TEST (test_threads_match_single_thread)
+{
+  gint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (in_formats); i++) {
+    GstBuffer *inbuf = create_bayer_buffer (in_formats[i], TRUE, 0);
+
+    for (j = 0; j < G_N_ELEMENTS (out_formats); j++) {
+      GstBuffer *single, *threaded;
+
+      single = convert (in_formats[i], out_formats[j], 1, inbuf);
+      threaded = convert (in_formats[i], out_formats[j], 4, inbuf);
+      check_buffers_equal (single, threaded);
+      gst_buffer_unref (single);
+      gst_buffer_unref (threaded);
+    }
+    gst_buffer_unref (inbuf);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gray_to_yuv)
+{
+  gint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (in_formats); i++) {
+    gint bits = bayer_bits (in_formats[i]);
+    GstBuffer *inbuf = create_bayer_buffer (in_formats[i], FALSE,
+        128 << (bits - 8));
+
+    for (j = 2; j < G_N_ELEMENTS (out_formats); j++) {
+      GstBuffer *outbuf;
+      GstVideoInfo info;
+      GstVideoFrame frame;
+      gint x, y;
+
+      gst_video_info_set_format (&info,
+          gst_video_format_from_string (out_formats[j]), WIDTH, HEIGHT);
+      outbuf = convert (in_formats[i], out_formats[j], 0, inbuf);
+      fail_unless (gst_video_frame_map (&frame, &info, outbuf, GST_MAP_READ));
+
+      /* a flat mid gray gives limited range Y of 126 and neutral chroma */
+      for (y = 0; y < HEIGHT; y++) {
+        const guint8 *line = GST_VIDEO_FRAME_COMP_DATA (&frame, 0) +
+            y * GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
+
+        for (x = 0; x < WIDTH; x++)
+          fail_unless (ABS (line[x] - 126) <= 1);
+      }
+      for (y = 0; y < HEIGHT / 2; y++) {
+        const guint8 *u = GST_VIDEO_FRAME_COMP_DATA (&frame, 1) +
+            y * GST_VIDEO_FRAME_COMP_STRIDE (&frame, 1);
+        const guint8 *v = GST_VIDEO_FRAME_COMP_DATA (&frame, 2) +
+            y * GST_VIDEO_FRAME_COMP_STRIDE (&frame, 2);
+        gint pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (&frame, 1);
+
+        for (x = 0; x < WIDTH / 2; x++) {
+          fail_unless (ABS (u[x * pstride] - 128) <= 1);
+          fail_unless (ABS (v[x * pstride] - 128) <= 1);
+        }
+      }
+
+      gst_video_frame_unmap (&frame);
+      gst_buffer_unref (outbuf);
+    }
+    gst_buffer_unref (inbuf);
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+bayer2rgb_suite (void)
+{
+  Suite *s = suite_create ("bayer2rgb");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_threads_match_single_thread);
+  tcase_add_test (tc_chain, test_gray_to_yuv);
+
+  return s;
+}
+
+GST_CHECK_MAIN (bayer2rgb);
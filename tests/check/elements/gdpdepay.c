@@ -400,6 +400,84 @@ GST_START_TEST (test_streamheader)
 
 GST_END_TEST;
 
+GST_START_TEST (test_buffer_list)
+{
+  GstCaps *caps;
+  GstElement *gdpdepay;
+  GstBuffer *buffer, *inbuffer;
+  GstBufferList *list, *gdp_list;
+  GstEvent *event;
+  GstSegment segment;
+  GList *l;
+  guint i;
+
+  gdpdepay = setup_gdpdepay ();
+
+  fail_unless (gst_element_set_state (gdpdepay,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_new_empty_simple ("application/x-gdp");
+  gst_check_setup_events (mysrcpad, gdpdepay, caps, GST_FORMAT_BYTES);
+  gst_caps_unref (caps);
+
+  /* stream-start, caps and segment packets go first, all with CRCs */
+  event = gst_event_new_stream_start ("s-s-id-1234");
+  inbuffer = gst_dp_payload_event (event, GST_DP_HEADER_FLAG_CRC);
+  gst_event_unref (event);
+
+  caps = gst_caps_from_string (AUDIO_CAPS_STRING);
+  inbuffer = gst_buffer_append (inbuffer,
+      gst_dp_payload_caps (caps, GST_DP_HEADER_FLAG_CRC));
+  gst_caps_unref (caps);
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  event = gst_event_new_segment (&segment);
+  inbuffer = gst_buffer_append (inbuffer,
+      gst_dp_payload_event (event, GST_DP_HEADER_FLAG_CRC));
+  gst_event_unref (event);
+
+  fail_unless_equals_int (gst_pad_push (mysrcpad, inbuffer), GST_FLOW_OK);
+
+  /* payload a list of odd-sized buffers in one go */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 10; i++) {
+    buffer = gst_buffer_new_and_alloc (13);
+    gst_buffer_memset (buffer, 0, i, 13);
+    GST_BUFFER_TIMESTAMP (buffer) = i * GST_MSECOND;
+    gst_buffer_list_add (list, buffer);
+  }
+  gdp_list = gst_dp_payload_buffer_list (list, GST_DP_HEADER_FLAG_CRC);
+  gst_buffer_list_unref (list);
+  fail_unless_equals_int (gst_buffer_list_length (gdp_list), 10);
+
+  fail_unless_equals_int (gst_pad_push_list (mysrcpad, gdp_list),
+      GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), 10);
+  for (l = buffers, i = 0; l != NULL; l = l->next, i++) {
+    guint8 data[13];
+
+    buffer = GST_BUFFER_CAST (l->data);
+    fail_unless_equals_int (gst_buffer_get_size (buffer), 13);
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buffer), i * GST_MSECOND);
+    gst_buffer_extract (buffer, 0, data, 13);
+    fail_unless_equals_int (data[0], i);
+    fail_unless_equals_int (data[12], i);
+  }
+
+  fail_unless (gst_element_set_state (gdpdepay,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+  ASSERT_OBJECT_REFCOUNT (gdpdepay, "gdpdepay", 1);
+  cleanup_gdpdepay (gdpdepay);
+}
+
+GST_END_TEST;
+
 static Suite *
 gdpdepay_suite (void)
 {
@@ -410,6 +488,7 @@ gdpdepay_suite (void)
   tcase_add_test (tc_chain, test_audio_per_byte);
   tcase_add_test (tc_chain, test_audio_in_one_buffer);
   tcase_add_test (tc_chain, test_streamheader);
+  tcase_add_test (tc_chain, test_buffer_list);
 
   return s;
 }
@@ -0,0 +1,206 @@
+/* GStreamer unit test for the geometric transform elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/video/video.h>
+
+#include <math.h>
+
+/* RGBx, the stride of these sizes is the width times 4 */
+#define CAPS_TEMPLATE "video/x-raw,format=RGBx,width=%d,height=%d," \
+    "framerate=25/1"
+
+/* default scale of diffuse */
+#define DIFFUSE_SCALE 4.0
+
+typedef void (*MapFunc) (gint width, gint height, gint x, gint y,
+    gdouble * in_x, gdouble * in_y);
+
+static GstBuffer *
+create_pattern_buffer (gint width, gint height, guint frame)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  gint x, y;
+
+  buf = gst_buffer_new_allocate (NULL, width * height * 4, NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  for (y = 0; y < height; y++) {
+    for (x = 0; x < width; x++) {
+      guint8 *p = map.data + (y * width + x) * 4;
+
+      p[0] = x * 3 + frame;
+      p[1] = y * 5 + frame;
+      p[2] = x ^ y;
+      p[3] = 0;
+    }
+  }
+  gst_buffer_unmap (buf, &map);
+
+  GST_BUFFER_PTS (buf) = frame * GST_SECOND / 25;
+  GST_BUFFER_DURATION (buf) = GST_SECOND / 25;
+
+  return buf;
+}
+
+/* the per-pixel mapping of the elements before the sampling tables:
+ * truncate the source coordinate, leave the pixels off the edges black */
+static guint8 *
+reference_transform (const guint8 * in, gint width, gint height,
+    MapFunc map_func)
+{
+  guint8 *out = g_malloc0 (width * height * 4);
+  gint x, y;
+
+  for (y = 0; y < height; y++) {
+    for (x = 0; x < width; x++) {
+      gdouble in_x, in_y;
+      gint trunc_x, trunc_y;
+
+      map_func (width, height, x, y, &in_x, &in_y);
+      trunc_x = (gint) in_x;
+      trunc_y = (gint) in_y;
+
+      if (trunc_x >= 0 && trunc_x < width && trunc_y >= 0 && trunc_y < height)
+        memcpy (out + (y * width + x) * 4,
+            in + (trunc_y * width + trunc_x) * 4, 4);
+    }
+  }
+
+  return out;
+}
+
+/* mirror with the default left mode */
+static void
+mirror_map (gint width, gint height, gint x, gint y, gdouble * in_x,
+    gdouble * in_y)
+{
+  if (x > width / 2.0 - 1.0)
+    *in_x = width - 1.0 - x;
+  else
+    *in_x = x;
+  *in_y = y;
+}
+
+/* diffuse draws an angle and a distance for every pixel, with the seed
+ * reset before the element and the reference these are the same draws */
+static void
+diffuse_map (gint width, gint height, gint x, gint y, gdouble * in_x,
+    gdouble * in_y)
+{
+  gint angle = g_random_int_range (0, 256);
+  gdouble distance = g_random_double ();
+  gdouble a = (G_PI * 2 * angle) / 256.0;
+
+  *in_x = x + distance * DIFFUSE_SCALE * sin (a);
+  *in_y = y + distance * DIFFUSE_SCALE * cos (a);
+}
+
+static void
+check_frame (GstHarness * h, gint width, gint height, guint frame,
+    MapFunc map_func)
+{
+  GstBuffer *in_buf, *out_buf;
+  GstMapInfo in_map, out_map;
+  guint8 *expected;
+  guint32 seed = 0x5eed + frame;
+
+  in_buf = create_pattern_buffer (width, height, frame);
+
+  g_random_set_seed (seed);
+  fail_unless_equals_int (gst_harness_push (h, gst_buffer_ref (in_buf)),
+      GST_FLOW_OK);
+  out_buf = gst_harness_pull (h);
+  fail_unless (out_buf != NULL);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (out_buf),
+      GST_BUFFER_PTS (in_buf));
+
+  g_random_set_seed (seed);
+  gst_buffer_map (in_buf, &in_map, GST_MAP_READ);
+  expected = reference_transform (in_map.data, width, height, map_func);
+  gst_buffer_unmap (in_buf, &in_map);
+
+  gst_buffer_map (out_buf, &out_map, GST_MAP_READ);
+  fail_unless_equals_int (out_map.size, width * height * 4);
+  fail_unless (memcmp (out_map.data, expected, out_map.size) == 0,
+      "frame %u of %dx%d differs from the per-pixel transform", frame,
+      width, height);
+  gst_buffer_unmap (out_buf, &out_map);
+
+  g_free (expected);
+  gst_buffer_unref (out_buf);
+  gst_buffer_unref (in_buf);
+}
+
+static void
+check_element (const gchar * element, MapFunc map_func)
+{
+  GstHarness *h = gst_harness_new (element);
+  gchar *caps;
+  guint frame;
+
+  caps = g_strdup_printf (CAPS_TEMPLATE, 64, 48);
+  gst_harness_set_src_caps_str (h, caps);
+  g_free (caps);
+
+  for (frame = 0; frame < 3; frame++)
+    check_frame (h, 64, 48, frame, map_func);
+
+  /* a new size must not reuse the map and the tables of the old one */
+  caps = g_strdup_printf (CAPS_TEMPLATE, 40, 30);
+  gst_harness_set_src_caps_str (h, caps);
+  g_free (caps);
+
+  for (frame = 3; frame < 6; frame++)
+    check_frame (h, 40, 30, frame, map_func);
+
+  gst_harness_teardown (h);
+}
+
+GST_START_TEST (test_mirror_precalc_map)
+{
+  check_element ("mirror", mirror_map);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_diffuse_map_per_frame)
+{
+  check_element ("diffuse", diffuse_map);
+}
+
+GST_END_TEST;
+
+static Suite *
+geometrictransform_suite (void)
+{
+  Suite *s = suite_create ("geometrictransform");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_mirror_precalc_map);
+  tcase_add_test (tc_chain, test_diffuse_map_per_frame);
+
+  return s;
+}
+
+GST_CHECK_MAIN (geometrictransform);
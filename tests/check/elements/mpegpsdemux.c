@@ -0,0 +1,659 @@
+/* GStreamer unit tests for mpegpsdemux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/base/gstbytewriter.h>
+
+/* 40 ms in 90 kHz units, between the packs and between the pictures */
+#define FRAME_TICKS 3600
+/* PTS are ahead of the SCR by this much */
+#define PTS_DELAY 45000
+
+/* Largest PES_header_data_length of an MPEG-2 PES header */
+#define MAX_HEADER_DATA_LENGTH 255
+
+/* Packets starting with a sequence header, the demuxer indexes these */
+#define KEYFRAME_INTERVAL 10
+
+#define INDEX_HEADER_SIZE 24
+#define INDEX_ENTRY_SIZE 25
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC, GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/mpeg, mpegversion=(int)2, "
+        "systemstream=(boolean)true"));
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+typedef struct
+{
+  GstElement *demux;
+  GstPad *srcpad;
+  GstPad *sinkpad;
+  GList *buffers;
+
+  /* pull mode */
+  GstBuffer *stream;
+  GMutex lock;
+  GCond cond;
+  gboolean blocking;
+  gboolean flushing;
+  gboolean eos;
+} Demuxer;
+
+static GstFlowReturn
+sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  Demuxer *d = g_object_get_data (G_OBJECT (pad), "demuxer");
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  g_mutex_lock (&d->lock);
+  if (d->flushing) {
+    gst_buffer_unref (buffer);
+    ret = GST_FLOW_FLUSHING;
+    goto done;
+  }
+  d->buffers = g_list_append (d->buffers, buffer);
+  g_cond_broadcast (&d->cond);
+
+  /* holds the streaming thread until the next flush */
+  while (d->blocking && !d->flushing)
+    g_cond_wait (&d->cond, &d->lock);
+  if (d->flushing)
+    ret = GST_FLOW_FLUSHING;
+
+done:
+  g_mutex_unlock (&d->lock);
+
+  return ret;
+}
+
+static gboolean
+sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  Demuxer *d = g_object_get_data (G_OBJECT (pad), "demuxer");
+
+  g_mutex_lock (&d->lock);
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_FLUSH_START:
+      d->flushing = TRUE;
+      d->blocking = FALSE;
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      d->flushing = FALSE;
+      d->eos = FALSE;
+      g_list_free_full (d->buffers, (GDestroyNotify) gst_buffer_unref);
+      d->buffers = NULL;
+      break;
+    case GST_EVENT_EOS:
+      d->eos = TRUE;
+      break;
+    default:
+      break;
+  }
+  g_cond_broadcast (&d->cond);
+  g_mutex_unlock (&d->lock);
+
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+static GstFlowReturn
+src_getrange (GstPad * pad, GstObject * parent, guint64 offset, guint length,
+    GstBuffer ** buffer)
+{
+  Demuxer *d = g_object_get_data (G_OBJECT (pad), "demuxer");
+  gsize size = gst_buffer_get_size (d->stream);
+
+  if (offset >= size)
+    return GST_FLOW_EOS;
+
+  *buffer = gst_buffer_copy_region (d->stream, GST_BUFFER_COPY_ALL, offset,
+      MIN (length, size - offset));
+  GST_BUFFER_OFFSET (*buffer) = offset;
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  Demuxer *d = g_object_get_data (G_OBJECT (pad), "demuxer");
+  GstFormat format;
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_DURATION:
+      gst_query_parse_duration (query, &format, NULL);
+      if (format != GST_FORMAT_BYTES)
+        return FALSE;
+      gst_query_set_duration (query, format, gst_buffer_get_size (d->stream));
+      return TRUE;
+    case GST_QUERY_SCHEDULING:
+      gst_query_set_scheduling (query, GST_SCHEDULING_FLAG_SEEKABLE, 1, -1,
+          0);
+      gst_query_add_scheduling_mode (query, GST_PAD_MODE_PULL);
+      return TRUE;
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+static void
+pad_added_cb (GstElement * element, GstPad * pad, Demuxer * d)
+{
+  fail_unless_equals_string (GST_PAD_NAME (pad), "video_e0");
+  fail_unless (gst_pad_link (pad, d->sinkpad) == GST_PAD_LINK_OK);
+}
+
+static void
+demuxer_init (Demuxer * d)
+{
+  d->buffers = NULL;
+  d->stream = NULL;
+  g_mutex_init (&d->lock);
+  g_cond_init (&d->cond);
+  d->blocking = FALSE;
+  d->flushing = FALSE;
+  d->eos = FALSE;
+
+  d->demux = gst_check_setup_element ("mpegpsdemux");
+  d->srcpad = gst_check_setup_src_pad (d->demux, &src_template);
+  g_object_set_data (G_OBJECT (d->srcpad), "demuxer", d);
+
+  d->sinkpad = gst_pad_new_from_static_template (&sink_template, "sink");
+  g_object_set_data (G_OBJECT (d->sinkpad), "demuxer", d);
+  gst_pad_set_chain_function (d->sinkpad, sink_chain);
+  gst_pad_set_event_function (d->sinkpad, sink_event);
+  gst_pad_set_active (d->sinkpad, TRUE);
+  g_signal_connect (d->demux, "pad-added", G_CALLBACK (pad_added_cb), d);
+}
+
+static void
+demuxer_setup (Demuxer * d)
+{
+  GstCaps *caps;
+
+  demuxer_init (d);
+
+  gst_pad_set_active (d->srcpad, TRUE);
+  fail_unless_equals_int (gst_element_set_state (d->demux,
+          GST_STATE_PLAYING), GST_STATE_CHANGE_SUCCESS);
+
+  caps = gst_static_pad_template_get_caps (&src_template);
+  gst_check_setup_events (d->srcpad, d->demux, caps, GST_FORMAT_BYTES);
+  gst_caps_unref (caps);
+}
+
+/* Pulls from @stream with the index scan enabled. The streaming thread is
+ * held after the first buffer until a flushing seek */
+static void
+demuxer_setup_pull (Demuxer * d, GstBuffer * stream)
+{
+  demuxer_init (d);
+  d->stream = stream;
+  d->blocking = TRUE;
+  g_object_set (d->demux, "index-scan", TRUE, NULL);
+
+  gst_pad_set_getrange_function (d->srcpad, src_getrange);
+  gst_pad_set_query_function (d->srcpad, src_query);
+  gst_pad_set_active (d->srcpad, TRUE);
+  fail_unless_equals_int (gst_element_set_state (d->demux,
+          GST_STATE_PAUSED), GST_STATE_CHANGE_SUCCESS);
+
+  g_mutex_lock (&d->lock);
+  while (d->buffers == NULL)
+    g_cond_wait (&d->cond, &d->lock);
+  g_mutex_unlock (&d->lock);
+}
+
+static void
+demuxer_teardown (Demuxer * d)
+{
+  g_list_free_full (d->buffers, (GDestroyNotify) gst_buffer_unref);
+  d->buffers = NULL;
+
+  gst_element_set_state (d->demux, GST_STATE_NULL);
+  gst_pad_set_active (d->sinkpad, FALSE);
+  gst_object_unref (d->sinkpad);
+  gst_check_teardown_src_pad (d->demux);
+  gst_check_teardown_element (d->demux);
+
+  g_mutex_clear (&d->lock);
+  g_cond_clear (&d->cond);
+}
+
+static void
+put_timestamp (GstByteWriter * bw, guint8 prefix, guint64 ts)
+{
+  gst_byte_writer_put_uint8 (bw, prefix | ((ts >> 29) & 0x0e) | 0x01);
+  gst_byte_writer_put_uint16_be (bw, ((ts >> 14) & 0xfffe) | 0x01);
+  gst_byte_writer_put_uint16_be (bw, ((ts << 1) & 0xfffe) | 0x01);
+}
+
+/* MPEG-2 pack header with @scr, without system header and stuffing */
+static void
+put_pack_header (GstByteWriter * bw, guint64 scr)
+{
+  gst_byte_writer_put_uint32_be (bw, 0x000001ba);
+  gst_byte_writer_put_uint8 (bw, 0x44 | ((scr >> 27) & 0x38) |
+      ((scr >> 28) & 0x03));
+  gst_byte_writer_put_uint8 (bw, (scr >> 20) & 0xff);
+  gst_byte_writer_put_uint8 (bw, 0x04 | ((scr >> 12) & 0xf8) |
+      ((scr >> 13) & 0x03));
+  gst_byte_writer_put_uint8 (bw, (scr >> 5) & 0xff);
+  gst_byte_writer_put_uint8 (bw, 0x04 | ((scr << 3) & 0xf8));
+  gst_byte_writer_put_uint8 (bw, 0x01);
+  /* 10 Mbit/s mux rate, markers, reserved bits and no stuffing */
+  gst_byte_writer_put_uint24_be (bw, (25000 << 2) | 0x03);
+  gst_byte_writer_put_uint8 (bw, 0xf8);
+}
+
+/* Byte @i of the payload of packet @n. Every KEYFRAME_INTERVAL packets the
+ * payload starts with a sequence header start code, the other bytes are
+ * never 0 so that there are no other start codes in the payload */
+static guint8
+payload_byte (guint n, guint i)
+{
+  static const guint8 sequence_header[] = { 0x00, 0x00, 0x01, 0xb3 };
+
+  if (n % KEYFRAME_INTERVAL == 0 && i < sizeof (sequence_header))
+    return sequence_header[i];
+
+  return 0x10 + (n + i) % 0xe0;
+}
+
+/* A video PES packet with a PTS and @header_data_length bytes of header
+ * data, padded with stuffing bytes */
+static void
+put_pes_packet (GstByteWriter * bw, guint n, guint header_data_length,
+    guint payload_size)
+{
+  guint i;
+
+  gst_byte_writer_put_uint32_be (bw, 0x000001e0);
+  gst_byte_writer_put_uint16_be (bw, 3 + header_data_length + payload_size);
+  gst_byte_writer_put_uint8 (bw, 0x80);
+  /* PTS only */
+  gst_byte_writer_put_uint8 (bw, 0x80);
+  gst_byte_writer_put_uint8 (bw, header_data_length);
+  put_timestamp (bw, 0x20, PTS_DELAY + n * FRAME_TICKS);
+  gst_byte_writer_fill (bw, 0xff, header_data_length - 5);
+
+  for (i = 0; i < payload_size; i++)
+    gst_byte_writer_put_uint8 (bw, payload_byte (n, i));
+}
+
+/* @n_packets packs of one PES packet each. Every other packet has a
+ * header of the maximum length */
+static GstBuffer *
+create_stream (guint n_packets, guint payload_size)
+{
+  GstByteWriter bw;
+  guint n;
+
+  gst_byte_writer_init (&bw);
+  for (n = 0; n < n_packets; n++) {
+    put_pack_header (&bw, n * FRAME_TICKS);
+    put_pes_packet (&bw, n, n % 2 ? MAX_HEADER_DATA_LENGTH : 5,
+        payload_size);
+  }
+  gst_byte_writer_put_uint32_be (&bw, 0x000001b9);
+
+  return gst_byte_writer_reset_and_get_buffer (&bw);
+}
+
+/* Pushes @stream in chunks of @chunk_size bytes followed by EOS */
+static void
+push_chunked (Demuxer * d, GstBuffer * stream, gsize chunk_size)
+{
+  gsize offset, size = gst_buffer_get_size (stream);
+
+  for (offset = 0; offset < size; offset += chunk_size) {
+    GstBuffer *chunk = gst_buffer_copy_region (stream, GST_BUFFER_COPY_ALL,
+        offset, MIN (chunk_size, size - offset));
+
+    GST_BUFFER_OFFSET (chunk) = offset;
+    fail_unless_equals_int (gst_pad_push (d->srcpad, chunk), GST_FLOW_OK);
+  }
+  fail_unless (gst_pad_push_event (d->srcpad, gst_event_new_eos ()));
+}
+
+static void
+check_payload (GstBuffer * buffer, guint n, guint payload_size)
+{
+  GstMapInfo map;
+  guint i;
+
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, payload_size);
+  for (i = 0; i < payload_size; i++) {
+    if (map.data[i] != payload_byte (n, i))
+      fail ("packet %u differs at byte %u", n, i);
+  }
+  gst_buffer_unmap (buffer, &map);
+}
+
+static void
+check_payloads (Demuxer * d, guint n_packets, guint payload_size)
+{
+  GstClockTime first_pts = GST_CLOCK_TIME_NONE;
+  GList *l;
+  guint n = 0;
+
+  fail_unless_equals_int (g_list_length (d->buffers), n_packets);
+
+  for (l = d->buffers; l; l = l->next, n++) {
+    GstBuffer *buffer = l->data;
+
+    fail_unless (GST_BUFFER_PTS_IS_VALID (buffer));
+    if (n == 0)
+      first_pts = GST_BUFFER_PTS (buffer);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer) - first_pts,
+        n * 40 * GST_MSECOND);
+
+    check_payload (buffer, n, payload_size);
+  }
+}
+
+/* The PES headers, both short ones and ones of the maximum length, are
+ * split across input buffers at every possible position */
+GST_START_TEST (test_pes_header_split)
+{
+  static const gsize chunk_sizes[] = { 1, 2, 7, 13, 100, 263, 264, 265,
+    4096
+  };
+  GstBuffer *stream;
+  Demuxer d;
+  guint i;
+
+  stream = create_stream (8, 700);
+
+  for (i = 0; i < G_N_ELEMENTS (chunk_sizes); i++) {
+    GST_DEBUG ("pushing in chunks of %" G_GSIZE_FORMAT " bytes",
+        chunk_sizes[i]);
+
+    demuxer_setup (&d);
+    push_chunked (&d, stream, chunk_sizes[i]);
+    check_payloads (&d, 8, 700);
+    demuxer_teardown (&d);
+  }
+
+  gst_buffer_unref (stream);
+}
+
+GST_END_TEST;
+
+#define BENCHMARK_PACKETS 2000
+#define BENCHMARK_PAYLOAD 2000
+
+/* Input buffers smaller than the packets, so that every packet and most
+ * headers span several of them */
+GST_START_TEST (test_pes_split_benchmark)
+{
+  static const gsize chunk_sizes[] = { 188, 1024, 2048 };
+  GstBuffer *stream;
+  Demuxer d;
+  guint i;
+
+  stream = create_stream (BENCHMARK_PACKETS, BENCHMARK_PAYLOAD);
+
+  for (i = 0; i < G_N_ELEMENTS (chunk_sizes); i++) {
+    gint64 start, elapsed;
+
+    demuxer_setup (&d);
+
+    start = g_get_monotonic_time ();
+    push_chunked (&d, stream, chunk_sizes[i]);
+    elapsed = g_get_monotonic_time () - start;
+
+    GST_INFO ("chunks of %" G_GSIZE_FORMAT " bytes: %" G_GSIZE_FORMAT
+        " bytes in %" G_GINT64_FORMAT " us, %.1f MB/s", chunk_sizes[i],
+        gst_buffer_get_size (stream), elapsed,
+        gst_buffer_get_size (stream) / (gdouble) MAX (elapsed, 1));
+
+    fail_unless_equals_int (g_list_length (d.buffers), BENCHMARK_PACKETS);
+    demuxer_teardown (&d);
+  }
+
+  gst_buffer_unref (stream);
+}
+
+GST_END_TEST;
+
+#define INDEX_PACKETS 100
+#define INDEX_PAYLOAD 700
+
+/* An index in the format of the index property, with an entry for every
+ * offset in @offsets */
+static GBytes *
+create_index (const guint64 * offsets, guint n_entries, gboolean complete)
+{
+  GstByteWriter bw;
+  guint size, i;
+
+  gst_byte_writer_init (&bw);
+  gst_byte_writer_put_data (&bw, (const guint8 *) "PSIX", 4);
+  gst_byte_writer_put_uint32_be (&bw, 1);
+  gst_byte_writer_put_uint64_be (&bw, 0);
+  gst_byte_writer_put_uint32_be (&bw, complete ? 1 : 0);
+  gst_byte_writer_put_uint32_be (&bw, n_entries);
+  for (i = 0; i < n_entries; i++) {
+    gst_byte_writer_put_uint64_be (&bw, offsets[i]);
+    gst_byte_writer_put_uint64_be (&bw, i * 90000);
+    gst_byte_writer_put_uint64_be (&bw, PTS_DELAY + i * 90000);
+    gst_byte_writer_put_uint8 (&bw, 1);
+  }
+
+  size = gst_byte_writer_get_size (&bw);
+
+  return g_bytes_new_take (gst_byte_writer_reset_and_get_data (&bw), size);
+}
+
+static guint
+index_n_entries (GBytes * index)
+{
+  gsize size;
+  const guint8 *data = g_bytes_get_data (index, &size);
+
+  fail_unless (size >= INDEX_HEADER_SIZE);
+  fail_unless (memcmp (data, "PSIX", 4) == 0);
+  fail_unless_equals_int (GST_READ_UINT32_BE (data + 4), 1);
+  fail_unless_equals_int (size, INDEX_HEADER_SIZE +
+      GST_READ_UINT32_BE (data + 20) * INDEX_ENTRY_SIZE);
+
+  return GST_READ_UINT32_BE (data + 20);
+}
+
+/* Sets @index on a new demuxer and reads it back */
+static GBytes *
+import_export_index (GBytes * index)
+{
+  GstElement *demux = gst_element_factory_make ("mpegpsdemux", NULL);
+  GBytes *ret = NULL;
+
+  fail_unless (demux != NULL);
+  g_object_set (demux, "index", index, NULL);
+  g_object_get (demux, "index", &ret, NULL);
+  fail_unless (ret != NULL);
+  gst_object_unref (demux);
+
+  return ret;
+}
+
+/* The index built while demuxing has an entry for every keyframe, and can
+ * be set on another demuxer unchanged */
+GST_START_TEST (test_index_roundtrip)
+{
+  GstBuffer *stream;
+  GBytes *index, *copy;
+  const guint8 *data;
+  Demuxer d;
+  guint i;
+
+  stream = create_stream (INDEX_PACKETS, INDEX_PAYLOAD);
+
+  demuxer_setup (&d);
+  push_chunked (&d, stream, 4096);
+  check_payloads (&d, INDEX_PACKETS, INDEX_PAYLOAD);
+  g_object_get (d.demux, "index", &index, NULL);
+  demuxer_teardown (&d);
+
+  fail_unless (index != NULL);
+  fail_unless_equals_int (index_n_entries (index),
+      INDEX_PACKETS / KEYFRAME_INTERVAL);
+
+  data = g_bytes_get_data (index, NULL);
+  for (i = 0; i < INDEX_PACKETS / KEYFRAME_INTERVAL; i++) {
+    const guint8 *e = data + INDEX_HEADER_SIZE + i * INDEX_ENTRY_SIZE;
+    guint n = i * KEYFRAME_INTERVAL;
+    guint8 start_code[4];
+
+    /* the entries point at the packs of the keyframes */
+    fail_unless_equals_int (gst_buffer_extract (stream,
+            GST_READ_UINT64_BE (e), start_code, 4), 4);
+    fail_unless_equals_int (GST_READ_UINT32_BE (start_code), 0x000001ba);
+    fail_unless_equals_uint64 (GST_READ_UINT64_BE (e + 8), n * FRAME_TICKS);
+    fail_unless_equals_uint64 (GST_READ_UINT64_BE (e + 16),
+        PTS_DELAY + n * FRAME_TICKS);
+    fail_unless_equals_int (GST_READ_UINT8 (e + 24), 1);
+  }
+
+  copy = import_export_index (index);
+  fail_unless (g_bytes_equal (index, copy));
+  g_bytes_unref (copy);
+
+  g_bytes_unref (index);
+  gst_buffer_unref (stream);
+}
+
+GST_END_TEST;
+
+static void
+check_index_rejected (GBytes * index)
+{
+  GBytes *copy = import_export_index (index);
+
+  fail_unless_equals_int (index_n_entries (copy), 0);
+  fail_unless_equals_int (GST_READ_UINT32_BE ((const guint8 *)
+          g_bytes_get_data (copy, NULL) + 16), 0);
+  g_bytes_unref (copy);
+  g_bytes_unref (index);
+}
+
+GST_START_TEST (test_index_invalid)
+{
+  static const guint64 offsets[] = { 0, 7520, 15040 };
+  static const guint64 unsorted[] = { 0, 15040, 7520 };
+  GBytes *index, *copy;
+  guint8 *data;
+  gsize size;
+
+  /* a valid index, complete and with three entries */
+  index = create_index (offsets, 3, TRUE);
+  copy = import_export_index (index);
+  fail_unless (g_bytes_equal (index, copy));
+  g_bytes_unref (copy);
+
+  /* truncated header */
+  check_index_rejected (g_bytes_new_from_bytes (index, 0,
+          INDEX_HEADER_SIZE - 1));
+
+  /* truncated last entry */
+  check_index_rejected (g_bytes_new_from_bytes (index, 0,
+          g_bytes_get_size (index) - 1));
+
+  /* wrong magic */
+  data = g_bytes_unref_to_data (g_bytes_ref (index), &size);
+  data[0] = 'X';
+  check_index_rejected (g_bytes_new_take (data, size));
+
+  /* unknown version */
+  data = g_bytes_unref_to_data (g_bytes_ref (index), &size);
+  GST_WRITE_UINT32_BE (data + 4, 2);
+  check_index_rejected (g_bytes_new_take (data, size));
+
+  /* more entries than there is data for */
+  data = g_bytes_unref_to_data (g_bytes_ref (index), &size);
+  GST_WRITE_UINT32_BE (data + 20, 4);
+  check_index_rejected (g_bytes_new_take (data, size));
+
+  /* entries not sorted by offset */
+  check_index_rejected (create_index (unsorted, 3, TRUE));
+
+  g_bytes_unref (index);
+}
+
+GST_END_TEST;
+
+/* A seek beyond what was demuxed so far scans the stream for the index
+ * and starts at the keyframe before the target */
+GST_START_TEST (test_index_scan_seek)
+{
+  GstBuffer *stream;
+  Demuxer d;
+  guint n;
+
+  stream = create_stream (INDEX_PACKETS, INDEX_PAYLOAD);
+  demuxer_setup_pull (&d, stream);
+
+  /* packet 30 is the last keyframe presented before 2 s, at 1.7 s */
+  fail_unless (gst_element_seek (d.demux, 1.0, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT, GST_SEEK_TYPE_SET,
+          2 * GST_SECOND, GST_SEEK_TYPE_NONE, -1));
+
+  g_mutex_lock (&d.lock);
+  while (!d.eos)
+    g_cond_wait (&d.cond, &d.lock);
+  g_mutex_unlock (&d.lock);
+
+  n = 3 * KEYFRAME_INTERVAL;
+  fail_unless (d.buffers != NULL);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (d.buffers->data),
+      gst_util_uint64_scale (PTS_DELAY + n * FRAME_TICKS, GST_SECOND, 90000));
+  check_payload (d.buffers->data, n, INDEX_PAYLOAD);
+  fail_unless_equals_int (g_list_length (d.buffers), INDEX_PACKETS - n);
+
+  demuxer_teardown (&d);
+  gst_buffer_unref (stream);
+}
+
+GST_END_TEST;
+
+static Suite *
+mpegpsdemux_suite (void)
+{
+  Suite *s = suite_create ("mpegpsdemux");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_pes_header_split);
+  tcase_add_test (tc_chain, test_pes_split_benchmark);
+  tcase_add_test (tc_chain, test_index_roundtrip);
+  tcase_add_test (tc_chain, test_index_invalid);
+  tcase_add_test (tc_chain, test_index_scan_seek);
+
+  return s;
+}
+
+GST_CHECK_MAIN (mpegpsdemux);
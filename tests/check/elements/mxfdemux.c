@@ -21,6 +21,9 @@
  */
 
 #include <gst/check/gstcheck.h>
+#include <gst/app/gstappsrc.h>
+#include <gst/base/gstbytewriter.h>
+#include <glib/gstdio.h>
 #include <string.h>
 #include "mxfdemux.h"
 
@@ -29,6 +32,41 @@ static GMainLoop *loop = NULL;
 static gboolean have_eos = FALSE;
 static gboolean have_data = FALSE;
 
+/* Lets the sink pad block on buffers like a sink waiting for preroll */
+static GMutex block_lock;
+static GCond block_cond;
+static gboolean block_data = FALSE;
+static gboolean flushing = FALSE;
+static guint n_blocked = 0;
+
+/* What the source pad provides in pull mode */
+static const guint8 *src_data = mxf_file;
+static gint src_size = sizeof (mxf_file);
+
+/* What the sink pad expects, the audio track of mxf_file by default */
+static const gchar *sink_pad_name = "track_2";
+#define MXF_FILE_CAPS "audio/x-raw, rate=(int)11025, channels=(int)1, " \
+    "format=(string)U8, layout=(string)interleaved"
+static const gchar *sink_caps = MXF_FILE_CAPS;
+
+/* Buffers received by the seek tests since the last flush, and the first
+ * offset pulled after it */
+static GQueue received = G_QUEUE_INIT;
+static guint64 first_read_offset = -1;
+
+/* Offset of the only essence element in mxf_file, and of the footer
+ * partition after it. The footer has a CBR index table segment with a
+ * duration of 0 and is followed by the random index pack */
+#define MXF_ESSENCE_OFFSET 0x4e1b
+#define MXF_FOOTER_OFFSET 0x4e3f
+#define MXF_EDIT_UNIT_BYTE_COUNT_OFFSET (MXF_FOOTER_OFFSET + 140 + 80)
+
+/* Offsets of the durations in the structural metadata of mxf_file, all of
+ * them are one edit unit */
+static const guint mxf_duration_offsets[] = {
+  0x8c6, 0x941, 0xa2f, 0xa93, 0xcd1, 0xd4c, 0xe3a, 0xe9e, 0xf9d
+};
+
 static GstStaticPadTemplate mysrctemplate =
 GST_STATIC_PAD_TEMPLATE ("src", GST_PAD_SRC, GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("application/mxf"));
@@ -42,7 +80,8 @@ _pad_added (GstElement * element, GstPad * pad, gpointer user_data)
 {
   gchar *name = gst_pad_get_name (pad);
 
-  fail_unless_equals_string (name, "track_2");
+  if (sink_pad_name)
+    fail_unless_equals_string (name, sink_pad_name);
   fail_unless (gst_pad_link (pad, mysinkpad) == GST_PAD_LINK_OK);
 
   g_free (name);
@@ -51,12 +90,7 @@ _pad_added (GstElement * element, GstPad * pad, gpointer user_data)
 static void
 _sink_check_caps (GstPad * pad, GstCaps * caps)
 {
-  GstCaps *tcaps = gst_caps_new_simple ("audio/x-raw",
-      "rate", G_TYPE_INT, 11025,
-      "channels", G_TYPE_INT, 1,
-      "format", G_TYPE_STRING, "U8",
-      "layout", G_TYPE_STRING, "interleaved",
-      NULL);
+  GstCaps *tcaps = gst_caps_from_string (sink_caps);
 
   fail_unless (gst_caps_is_always_compatible (caps, tcaps));
   gst_caps_unref (tcaps);
@@ -78,6 +112,68 @@ _sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   return GST_FLOW_OK;
 }
 
+/* Waits until buffers are not blocked anymore, returns TRUE if flushing */
+static gboolean
+_block_buffer (void)
+{
+  gboolean flush;
+
+  g_mutex_lock (&block_lock);
+  n_blocked++;
+  g_cond_broadcast (&block_cond);
+  while (block_data && !flushing)
+    g_cond_wait (&block_cond, &block_lock);
+  flush = flushing;
+  g_mutex_unlock (&block_lock);
+
+  return flush;
+}
+
+static GstFlowReturn
+_sink_chain_blocking (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  if (_block_buffer ()) {
+    gst_buffer_unref (buffer);
+    return GST_FLOW_FLUSHING;
+  }
+
+  return _sink_chain (pad, parent, buffer);
+}
+
+static GstFlowReturn
+_sink_chain_collect (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  if (_block_buffer ()) {
+    gst_buffer_unref (buffer);
+    return GST_FLOW_FLUSHING;
+  }
+
+  g_mutex_lock (&block_lock);
+  g_queue_push_tail (&received, buffer);
+  g_mutex_unlock (&block_lock);
+
+  have_data = TRUE;
+  return GST_FLOW_OK;
+}
+
+static void
+_clear_received (void)
+{
+  GstBuffer *buffer;
+
+  while ((buffer = g_queue_pop_head (&received)))
+    gst_buffer_unref (buffer);
+}
+
+static void
+_wait_blocked (guint n)
+{
+  g_mutex_lock (&block_lock);
+  while (n_blocked < n)
+    g_cond_wait (&block_cond, &block_lock);
+  g_mutex_unlock (&block_lock);
+}
+
 static gboolean
 _sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
@@ -85,6 +181,19 @@ _sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       GST_EVENT_TYPE_NAME (event), event, event);
 
   switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_FLUSH_START:
+      g_mutex_lock (&block_lock);
+      flushing = TRUE;
+      g_cond_broadcast (&block_cond);
+      g_mutex_unlock (&block_lock);
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      g_mutex_lock (&block_lock);
+      flushing = FALSE;
+      first_read_offset = -1;
+      g_mutex_unlock (&block_lock);
+      _clear_received ();
+      break;
     case GST_EVENT_EOS:
       if (loop) {
         while (!g_main_loop_is_running (loop));
@@ -134,11 +243,16 @@ static GstFlowReturn
 _src_getrange (GstPad * pad, GstObject * parent, guint64 offset, guint length,
     GstBuffer ** buffer)
 {
-  if (offset + length > sizeof (mxf_file))
+  if (offset + length > g_atomic_int_get (&src_size))
     return GST_FLOW_EOS;
 
+  g_mutex_lock (&block_lock);
+  if (first_read_offset == -1)
+    first_read_offset = offset;
+  g_mutex_unlock (&block_lock);
+
   *buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
-      (guint8 *) (mxf_file + offset), length, 0, length, NULL, NULL);
+      (guint8 *) (src_data + offset), length, 0, length, NULL, NULL);
 
   return GST_FLOW_OK;
 }
@@ -156,7 +270,7 @@ _src_query (GstPad * pad, GstObject * parent, GstQuery * query)
       if (fmt != GST_FORMAT_BYTES)
         break;
 
-      gst_query_set_duration (query, fmt, sizeof (mxf_file));
+      gst_query_set_duration (query, fmt, g_atomic_int_get (&src_size));
       res = TRUE;
       break;
     }
@@ -184,9 +298,9 @@ _create_src_pad_pull (void)
   return mysrcpad;
 }
 
-GST_START_TEST (test_pull)
+static GstElement *
+setup_pull (gboolean fast_open, gboolean growing)
 {
-  GstStateChangeReturn sret;
   GstElement *mxfdemux;
   GstPad *sinkpad;
 
@@ -196,6 +310,8 @@ GST_START_TEST (test_pull)
 
   mxfdemux = gst_element_factory_make ("mxfdemux", NULL);
   fail_unless (mxfdemux != NULL);
+  g_object_set (mxfdemux, "fast-open", fast_open, "growing", growing,
+      "growing-poll-interval", 10 * GST_MSECOND, NULL);
   g_signal_connect (mxfdemux, "pad-added", G_CALLBACK (_pad_added), NULL);
   sinkpad = gst_element_get_static_pad (mxfdemux, "sink");
   fail_unless (sinkpad != NULL);
@@ -211,14 +327,12 @@ GST_START_TEST (test_pull)
   gst_pad_set_active (mysinkpad, TRUE);
   gst_pad_set_active (mysrcpad, TRUE);
 
-  GST_INFO ("Setting to PLAYING");
-  sret = gst_element_set_state (mxfdemux, GST_STATE_PLAYING);
-  fail_unless_equals_int (sret, GST_STATE_CHANGE_SUCCESS);
-
-  g_main_loop_run (loop);
-  fail_unless (have_eos == TRUE);
-  fail_unless (have_data == TRUE);
+  return mxfdemux;
+}
 
+static void
+teardown_pull (GstElement * mxfdemux)
+{
   gst_element_set_state (mxfdemux, GST_STATE_NULL);
   gst_pad_set_active (mysinkpad, FALSE);
   gst_pad_set_active (mysrcpad, FALSE);
@@ -230,6 +344,428 @@ GST_START_TEST (test_pull)
   loop = NULL;
 }
 
+static void
+run_pull (gboolean fast_open, gboolean growing)
+{
+  GstStateChangeReturn sret;
+  GstElement *mxfdemux;
+  GstStructure *structure;
+
+  mxfdemux = setup_pull (fast_open, growing);
+
+  GST_INFO ("Setting to PLAYING");
+  sret = gst_element_set_state (mxfdemux, GST_STATE_PLAYING);
+  fail_unless_equals_int (sret, GST_STATE_CHANGE_SUCCESS);
+
+  g_main_loop_run (loop);
+  fail_unless (have_eos == TRUE);
+  fail_unless (have_data == TRUE);
+
+  g_object_get (mxfdemux, "structure", &structure, NULL);
+  fail_unless (structure != NULL);
+  gst_structure_free (structure);
+
+  teardown_pull (mxfdemux);
+}
+
+GST_START_TEST (test_pull)
+{
+  run_pull (FALSE, FALSE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pull_fast_open)
+{
+  run_pull (TRUE, FALSE);
+}
+
+GST_END_TEST;
+
+/* The streaming thread holds the stream lock while it waits for preroll,
+ * neither reading the structure nor seeking may wait for it to finish */
+GST_START_TEST (test_pull_fast_open_seek_paused)
+{
+  GstElement *mxfdemux;
+  GstStructure *structure;
+  GstStateChangeReturn sret;
+
+  mxfdemux = setup_pull (TRUE, FALSE);
+  gst_pad_set_chain_function (mysinkpad, _sink_chain_blocking);
+  block_data = TRUE;
+  n_blocked = 0;
+
+  sret = gst_element_set_state (mxfdemux, GST_STATE_PAUSED);
+  fail_unless_equals_int (sret, GST_STATE_CHANGE_SUCCESS);
+  _wait_blocked (1);
+
+  g_object_get (mxfdemux, "structure", &structure, NULL);
+  fail_unless (structure != NULL);
+  gst_structure_free (structure);
+
+  /* loads the index from the stream lock and pushes from the start again */
+  fail_unless (gst_element_seek (mxfdemux, 1.0, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT, GST_SEEK_TYPE_SET, 0,
+          GST_SEEK_TYPE_NONE, -1));
+  _wait_blocked (2);
+
+  g_object_get (mxfdemux, "structure", &structure, NULL);
+  fail_unless (structure != NULL);
+  gst_structure_free (structure);
+
+  g_mutex_lock (&block_lock);
+  block_data = FALSE;
+  g_cond_broadcast (&block_cond);
+  g_mutex_unlock (&block_lock);
+
+  g_main_loop_run (loop);
+  fail_unless (have_eos == TRUE);
+  fail_unless (have_data == TRUE);
+
+  teardown_pull (mxfdemux);
+}
+
+GST_END_TEST;
+
+static gboolean
+_grow_file (gpointer user_data)
+{
+  g_atomic_int_set (&src_size, sizeof (mxf_file));
+
+  return G_SOURCE_REMOVE;
+}
+
+GST_START_TEST (test_pull_growing)
+{
+  guint8 *data = g_memdup (mxf_file, sizeof (mxf_file));
+
+  /* Make it look like a file that is still being written: open and
+   * incomplete header partition without footer partition offset, and
+   * nothing written after the metadata yet */
+  data[14] = 0x01;
+  memset (data + 44, 0, 8);
+  src_data = data;
+  src_size = MXF_ESSENCE_OFFSET;
+
+  /* Without growing mode this would be EOS without any data */
+  g_timeout_add (100, _grow_file, NULL);
+  run_pull (FALSE, TRUE);
+
+  src_data = mxf_file;
+  src_size = sizeof (mxf_file);
+  g_free (data);
+}
+
+GST_END_TEST;
+
+/* Prerolls on the first buffer and seeks to the key unit before @start.
+ * Returns the first offset that was pulled after the seek, the buffers
+ * pushed from there until EOS are in the received queue */
+static guint64
+run_pull_seek (gboolean fast_open, GstClockTime start)
+{
+  GstElement *mxfdemux;
+  GstStateChangeReturn sret;
+  guint64 offset;
+
+  mxfdemux = setup_pull (fast_open, FALSE);
+  gst_pad_set_chain_function (mysinkpad, _sink_chain_collect);
+  block_data = TRUE;
+  n_blocked = 0;
+
+  sret = gst_element_set_state (mxfdemux, GST_STATE_PAUSED);
+  fail_unless_equals_int (sret, GST_STATE_CHANGE_SUCCESS);
+  _wait_blocked (1);
+
+  fail_unless (gst_element_seek (mxfdemux, 1.0, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT |
+          GST_SEEK_FLAG_SNAP_BEFORE, GST_SEEK_TYPE_SET, start,
+          GST_SEEK_TYPE_NONE, -1));
+
+  g_mutex_lock (&block_lock);
+  block_data = FALSE;
+  g_cond_broadcast (&block_cond);
+  g_mutex_unlock (&block_lock);
+
+  g_main_loop_run (loop);
+  fail_unless (have_eos == TRUE);
+  fail_unless (have_data == TRUE);
+
+  g_mutex_lock (&block_lock);
+  offset = first_read_offset;
+  g_mutex_unlock (&block_lock);
+
+  teardown_pull (mxfdemux);
+
+  return offset;
+}
+
+#define CBR_EDIT_UNITS 10
+/* 200 ms of mono U8 audio at 11025 Hz */
+#define CBR_EDIT_UNIT_SIZE 2205
+#define CBR_ELEMENT_SIZE (16 + 4 + CBR_EDIT_UNIT_SIZE)
+
+/* mxf_file with CBR_EDIT_UNITS frame wrapped edit units. Every byte of the
+ * n-th edit unit is n + 1. The index table segment in the footer keeps its
+ * duration of 0, only its edit unit byte count is fixed */
+static guint8 *
+create_cbr_file (gsize * size)
+{
+  const gsize footer_size = sizeof (mxf_file) - MXF_FOOTER_OFFSET;
+  const guint64 footer =
+      MXF_ESSENCE_OFFSET + CBR_EDIT_UNITS * CBR_ELEMENT_SIZE;
+  guint8 *data, *p;
+  guint i;
+
+  *size = footer + footer_size;
+  data = g_malloc (*size);
+
+  memcpy (data, mxf_file, MXF_ESSENCE_OFFSET);
+  for (i = 0; i < G_N_ELEMENTS (mxf_duration_offsets); i++)
+    GST_WRITE_UINT64_BE (data + mxf_duration_offsets[i], CBR_EDIT_UNITS);
+
+  p = data + MXF_ESSENCE_OFFSET;
+  for (i = 0; i < CBR_EDIT_UNITS; i++) {
+    memcpy (p, mxf_file + MXF_ESSENCE_OFFSET, 16);
+    p[16] = 0x83;
+    GST_WRITE_UINT24_BE (p + 17, CBR_EDIT_UNIT_SIZE);
+    memset (p + 20, i + 1, CBR_EDIT_UNIT_SIZE);
+    p += CBR_ELEMENT_SIZE;
+  }
+
+  memcpy (p, mxf_file + MXF_FOOTER_OFFSET, footer_size);
+  GST_WRITE_UINT32_BE (data + footer - MXF_FOOTER_OFFSET +
+      MXF_EDIT_UNIT_BYTE_COUNT_OFFSET, CBR_ELEMENT_SIZE);
+
+  /* Footer partition offsets in the header and footer partition packs and
+   * in the last entry of the random index pack */
+  GST_WRITE_UINT64_BE (data + 44, footer);
+  GST_WRITE_UINT64_BE (data + footer + 28, footer);
+  GST_WRITE_UINT64_BE (data + footer + 44, footer);
+  GST_WRITE_UINT64_BE (data + *size - 4 - 8, footer);
+
+  return data;
+}
+
+static void
+check_cbr_seek (gboolean fast_open)
+{
+  GstBuffer *buffer;
+  guint8 *data;
+  gsize size;
+  guint64 offset;
+  guint8 first;
+
+  data = create_cbr_file (&size);
+  src_data = data;
+  src_size = size;
+
+  /* Edit unit 5 starts at exactly 1s */
+  offset = run_pull_seek (fast_open, GST_SECOND);
+  fail_unless_equals_uint64 (offset,
+      MXF_ESSENCE_OFFSET + 5 * CBR_ELEMENT_SIZE);
+
+  fail_unless_equals_int (g_queue_get_length (&received), CBR_EDIT_UNITS - 5);
+  buffer = g_queue_peek_head (&received);
+  fail_unless_equals_int (gst_buffer_get_size (buffer), CBR_EDIT_UNIT_SIZE);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), GST_SECOND);
+  fail_if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT));
+  gst_buffer_extract (buffer, 0, &first, 1);
+  fail_unless_equals_int (first, 6);
+  _clear_received ();
+
+  src_data = mxf_file;
+  src_size = sizeof (mxf_file);
+  g_free (data);
+}
+
+/* The CBR index table segment has a duration of 0 and covers the whole
+ * essence container */
+GST_START_TEST (test_pull_seek_cbr)
+{
+  check_cbr_seek (FALSE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pull_fast_open_seek_cbr)
+{
+  check_cbr_seek (TRUE);
+}
+
+GST_END_TEST;
+
+#define MPEG_FRAMES 50
+#define MPEG_GOP_SIZE 10
+#define MPEG_CAPS "video/mpeg, mpegversion=(int)2, systemstream=(boolean)false"
+
+/* A long-GOP MPEG-2 frame of varying size without reordering, the last byte
+ * is @n + 1 */
+static GstBuffer *
+create_mpeg2_frame (guint n)
+{
+  static const guint8 sequence_gop[] = {
+    0x00, 0x00, 0x01, 0xb3, 0x04, 0x00, 0x30, 0x13, 0xff, 0xff, 0xe0, 0x18,
+    0x00, 0x00, 0x01, 0xb8, 0x00, 0x08, 0x00, 0x00
+  };
+  gboolean keyframe = n % MPEG_GOP_SIZE == 0;
+  guint temporal_reference = n % MPEG_GOP_SIZE;
+  GstByteWriter bw;
+  GstBuffer *buffer;
+
+  gst_byte_writer_init (&bw);
+  if (keyframe)
+    gst_byte_writer_put_data (&bw, sequence_gop, sizeof (sequence_gop));
+
+  /* picture header and the start of the first slice */
+  gst_byte_writer_put_uint32_be (&bw, 0x00000100);
+  gst_byte_writer_put_uint8 (&bw, temporal_reference >> 2);
+  gst_byte_writer_put_uint8 (&bw, ((temporal_reference & 0x3) << 6) |
+      ((keyframe ? 1 : 2) << 3) | 0x07);
+  gst_byte_writer_put_uint16_be (&bw, 0xfff8);
+  gst_byte_writer_put_uint32_be (&bw, 0x00000101);
+  gst_byte_writer_fill (&bw, n + 1, 16 + (n % 7) * 8);
+
+  buffer = gst_byte_writer_reset_and_get_buffer (&bw);
+  GST_BUFFER_PTS (buffer) = GST_BUFFER_DTS (buffer) = n * GST_SECOND / 25;
+  GST_BUFFER_DURATION (buffer) = GST_SECOND / 25;
+  if (!keyframe)
+    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+
+  return buffer;
+}
+
+/* Muxes MPEG_FRAMES frames with mxfmux, which indexes them with one entry
+ * per edit unit */
+static guint8 *
+create_mpeg2_file (gsize * size)
+{
+  GstElement *pipeline, *appsrc;
+  GstMessage *msg;
+  GstBus *bus;
+  gchar *filename, *desc, *contents;
+  gint fd;
+  guint i;
+
+  fd = g_file_open_tmp ("mxfdemux-XXXXXX.mxf", &filename, NULL);
+  fail_unless (fd != -1);
+  g_close (fd, NULL);
+
+  desc = g_strdup_printf ("appsrc name=src format=time caps=\"" MPEG_CAPS
+      ", width=(int)64, height=(int)48, framerate=(fraction)25/1\" ! "
+      "mxfmux ! filesink location=\"%s\"", filename);
+  pipeline = gst_parse_launch (desc, NULL);
+  fail_unless (pipeline != NULL);
+  g_free (desc);
+
+  appsrc = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+  fail_unless (appsrc != NULL);
+  fail_unless_equals_int (gst_element_set_state (pipeline, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  for (i = 0; i < MPEG_FRAMES; i++)
+    fail_unless_equals_int (gst_app_src_push_buffer (GST_APP_SRC (appsrc),
+            create_mpeg2_frame (i)), GST_FLOW_OK);
+  fail_unless_equals_int (gst_app_src_end_of_stream (GST_APP_SRC (appsrc)),
+      GST_FLOW_OK);
+  gst_object_unref (appsrc);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  fail_unless (g_file_get_contents (filename, &contents, size, NULL));
+  g_remove (filename);
+  g_free (filename);
+
+  return (guint8 *) contents;
+}
+
+/* Returns the offset of the @n-th picture essence element of @data */
+static guint64
+find_picture_element (const guint8 * data, gsize size, guint n)
+{
+  static const guint8 gc_element[] = {
+    0x06, 0x0e, 0x2b, 0x34, 0x01, 0x02, 0x01, 0x01,
+    0x0d, 0x01, 0x03, 0x01, 0x15
+  };
+  gsize offset = 0;
+
+  while (offset + 17 <= size) {
+    guint64 length = data[offset + 16];
+    gsize header = 17;
+
+    if (length & 0x80) {
+      guint i, n_bytes = length & 0x7f;
+
+      fail_unless (offset + 17 + n_bytes <= size);
+      for (length = 0, i = 0; i < n_bytes; i++)
+        length = (length << 8) | data[offset + 17 + i];
+      header += n_bytes;
+    }
+
+    if (memcmp (data + offset, gc_element, sizeof (gc_element)) == 0
+        && n-- == 0)
+      return offset;
+
+    offset += header + length;
+  }
+
+  fail ("picture essence element not found");
+  return -1;
+}
+
+/* Seeks into the middle of a GOP of a VBR index with one entry per edit
+ * unit, playback must start at the keyframe before */
+GST_START_TEST (test_pull_seek_long_gop)
+{
+  GstBuffer *buffer;
+  guint8 *data;
+  gsize size;
+  guint64 offset;
+  guint8 last;
+
+  data = create_mpeg2_file (&size);
+  src_data = data;
+  src_size = size;
+  sink_pad_name = NULL;
+  sink_caps = MPEG_CAPS;
+
+  offset = run_pull_seek (FALSE, 1300 * GST_MSECOND);
+  fail_unless_equals_uint64 (offset, find_picture_element (data, size, 30));
+
+  fail_unless_equals_int (g_queue_get_length (&received), MPEG_FRAMES - 30);
+
+  buffer = g_queue_peek_nth (&received, 0);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), 1200 * GST_MSECOND);
+  fail_if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT));
+  gst_buffer_extract (buffer, gst_buffer_get_size (buffer) - 1, &last, 1);
+  fail_unless_equals_int (last, 31);
+
+  buffer = g_queue_peek_nth (&received, 1);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), 1240 * GST_MSECOND);
+  fail_unless (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT));
+  gst_buffer_extract (buffer, gst_buffer_get_size (buffer) - 1, &last, 1);
+  fail_unless_equals_int (last, 32);
+
+  buffer = g_queue_peek_nth (&received, 10);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), 1600 * GST_MSECOND);
+  fail_if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT));
+  _clear_received ();
+
+  src_data = mxf_file;
+  src_size = sizeof (mxf_file);
+  sink_pad_name = "track_2";
+  sink_caps = MXF_FILE_CAPS;
+  g_free (data);
+}
+
 GST_END_TEST;
 
 GST_START_TEST (test_push)
@@ -301,6 +837,12 @@ mxfdemux_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_set_timeout (tc_chain, 180);
   tcase_add_test (tc_chain, test_pull);
+  tcase_add_test (tc_chain, test_pull_fast_open);
+  tcase_add_test (tc_chain, test_pull_fast_open_seek_paused);
+  tcase_add_test (tc_chain, test_pull_growing);
+  tcase_add_test (tc_chain, test_pull_seek_cbr);
+  tcase_add_test (tc_chain, test_pull_fast_open_seek_cbr);
+  tcase_add_test (tc_chain, test_pull_seek_long_gop);
   tcase_add_test (tc_chain, test_push);
 
   return s;
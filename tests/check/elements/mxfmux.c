@@ -21,6 +21,7 @@
  */
 
 #include <gst/check/gstcheck.h>
+#include <glib/gstdio.h>
 #include <string.h>
 
 static const gchar *
@@ -142,6 +143,204 @@ GST_START_TEST (test_raw_video_raw_audio)
 
 GST_END_TEST;
 
+typedef struct
+{
+  guint64 offset;
+  /* 0x02 header, 0x03 body, 0x04 footer */
+  guint8 kind;
+  guint64 footer_partition;
+  guint64 index_byte_count;
+  guint32 body_sid;
+} Partition;
+
+typedef struct
+{
+  gint64 start;
+  gint64 duration;
+} IndexSegment;
+
+static const guint8 partition_pack_key[] = {
+  0x06, 0x0e, 0x2b, 0x34, 0x02, 0x05, 0x01, 0x01,
+  0x0d, 0x01, 0x02, 0x01, 0x01
+};
+
+static const guint8 index_segment_key[] = {
+  0x06, 0x0e, 0x2b, 0x34, 0x02, 0x53, 0x01, 0x01,
+  0x0d, 0x01, 0x02, 0x01, 0x01, 0x10, 0x01, 0x00
+};
+
+static const guint8 random_index_pack_key[] = {
+  0x06, 0x0e, 0x2b, 0x34, 0x02, 0x05, 0x01, 0x01,
+  0x0d, 0x01, 0x02, 0x01, 0x01, 0x11, 0x01, 0x00
+};
+
+/* Returns the size of the key and length of the KLV packet at @offset and
+ * its value length in @length */
+static gsize
+read_klv (const guint8 * data, gsize size, gsize offset, guint64 * length)
+{
+  gsize header = 17;
+
+  fail_unless (offset + 17 <= size);
+  *length = data[offset + 16];
+  if (*length & 0x80) {
+    guint i, n_bytes = *length & 0x7f;
+
+    fail_unless (n_bytes <= 8 && offset + 17 + n_bytes <= size);
+    for (*length = 0, i = 0; i < n_bytes; i++)
+      *length = (*length << 8) | data[offset + 17 + i];
+    header += n_bytes;
+  }
+  fail_unless (offset + header + *length <= size);
+
+  return header;
+}
+
+static void
+parse_index_segment (const guint8 * data, guint64 length, GArray * segments)
+{
+  IndexSegment segment = { -1, -1 };
+  guint64 pos = 0;
+
+  while (pos + 4 <= length) {
+    guint16 tag = GST_READ_UINT16_BE (data + pos);
+    guint16 tag_size = GST_READ_UINT16_BE (data + pos + 2);
+
+    fail_unless (pos + 4 + tag_size <= length);
+    if (tag == 0x3f0c && tag_size == 8)
+      segment.start = GST_READ_UINT64_BE (data + pos + 4);
+    else if (tag == 0x3f0d && tag_size == 8)
+      segment.duration = GST_READ_UINT64_BE (data + pos + 4);
+    pos += 4 + tag_size;
+  }
+
+  fail_unless (segment.start >= 0 && segment.duration > 0);
+  g_array_append_val (segments, segment);
+}
+
+/* Checks the partitions, the random index pack and the index table
+ * segments of a file with @n_body body partitions of @edit_units each */
+static void
+check_partitions (const guint8 * data, gsize size, guint n_body,
+    guint edit_units)
+{
+  GArray *partitions = g_array_new (FALSE, FALSE, sizeof (Partition));
+  GArray *segments = g_array_new (FALSE, FALSE, sizeof (IndexSegment));
+  const Partition *footer;
+  guint64 length, rip_offset, offset = 0;
+  gint64 position = 0;
+  gsize header;
+  guint i;
+
+  while (offset < size) {
+    header = read_klv (data, size, offset, &length);
+
+    if (memcmp (data + offset, partition_pack_key,
+            sizeof (partition_pack_key)) == 0 &&
+        data[offset + 13] >= 0x02 && data[offset + 13] <= 0x04) {
+      const guint8 *pack = data + offset + header;
+      Partition p;
+
+      fail_unless (length >= 64);
+      p.offset = offset;
+      p.kind = data[offset + 13];
+      fail_unless_equals_uint64 (GST_READ_UINT64_BE (pack + 8), offset);
+      p.footer_partition = GST_READ_UINT64_BE (pack + 24);
+      p.index_byte_count = GST_READ_UINT64_BE (pack + 40);
+      p.body_sid = GST_READ_UINT32_BE (pack + 60);
+      g_array_append_val (partitions, p);
+    } else if (memcmp (data + offset, index_segment_key,
+            sizeof (index_segment_key)) == 0) {
+      parse_index_segment (data + offset + header, length, segments);
+    }
+
+    offset += header + length;
+  }
+
+  /* header, body partitions and footer */
+  fail_unless_equals_int (partitions->len, n_body + 2);
+  footer = &g_array_index (partitions, Partition, partitions->len - 1);
+  fail_unless_equals_int (footer->kind, 0x04);
+  fail_unless (footer->index_byte_count > 0);
+  for (i = 0; i < partitions->len; i++) {
+    const Partition *p = &g_array_index (partitions, Partition, i);
+
+    if (i == 0)
+      fail_unless_equals_int (p->kind, 0x02);
+    else if (i < partitions->len - 1)
+      fail_unless_equals_int (p->kind, 0x03);
+
+    /* all partition packs were rewritten to point at the footer */
+    fail_unless_equals_uint64 (p->footer_partition, footer->offset);
+
+    /* every body partition but the first one carries the index of the
+     * previous one */
+    if (i > 1 && i < partitions->len - 1)
+      fail_unless (p->index_byte_count > 0);
+  }
+
+  /* one index table segment per body partition, without gaps */
+  fail_unless_equals_int (segments->len, n_body);
+  for (i = 0; i < segments->len; i++) {
+    const IndexSegment *segment = &g_array_index (segments, IndexSegment, i);
+
+    fail_unless_equals_int64 (segment->start, position);
+    fail_unless_equals_int64 (segment->duration, edit_units);
+    position += segment->duration;
+  }
+
+  /* the random index pack lists all partitions */
+  rip_offset = size - GST_READ_UINT32_BE (data + size - 4);
+  fail_unless (memcmp (data + rip_offset, random_index_pack_key,
+          sizeof (random_index_pack_key)) == 0);
+  header = read_klv (data, size, rip_offset, &length);
+  fail_unless_equals_uint64 (rip_offset + header + length, size);
+  fail_unless_equals_uint64 ((length - 4) / 12, partitions->len);
+  for (i = 0; i < partitions->len; i++) {
+    const Partition *p = &g_array_index (partitions, Partition, i);
+    const guint8 *entry = data + rip_offset + header + i * 12;
+
+    fail_unless_equals_int (GST_READ_UINT32_BE (entry), p->body_sid);
+    fail_unless_equals_uint64 (GST_READ_UINT64_BE (entry + 4), p->offset);
+  }
+
+  g_array_free (partitions, TRUE);
+  g_array_free (segments, TRUE);
+}
+
+GST_START_TEST (test_raw_video_raw_audio_partitions)
+{
+  gchar *pipeline, *filename, *contents;
+  gsize size;
+  gint fd;
+
+  fd = g_file_open_tmp ("mxfmux-XXXXXX.mxf", &filename, NULL);
+  fail_unless (fd != -1);
+  g_close (fd, NULL);
+
+  /* 10 seconds of video with a new body partition every second, written
+   * to a seekable sink so that the partition packs are rewritten */
+  pipeline = g_strdup_printf ("videotestsrc num-buffers=250 ! "
+      "video/x-raw,format=(string)v308,width=320,height=240,framerate=25/1 ! "
+      "mxfmux name=mux partition-interval=1000000000 ! "
+      "filesink location=\"%s\"  "
+      "audiotestsrc num-buffers=250 ! "
+      "audioconvert ! " "audio/x-raw,rate=48000,channels=2 ! " "mux. ",
+      filename);
+
+  run_test (pipeline);
+  g_free (pipeline);
+
+  fail_unless (g_file_get_contents (filename, &contents, &size, NULL));
+  check_partitions ((const guint8 *) contents, size, 10, 25);
+
+  g_free (contents);
+  g_remove (filename);
+  g_free (filename);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_raw_video_stride_transform)
 {
   gchar *pipeline;
@@ -276,6 +475,7 @@ mxfmux_suite (void)
 
   tcase_add_test (tc_chain, test_mpeg2);
   tcase_add_test (tc_chain, test_raw_video_raw_audio);
+  tcase_add_test (tc_chain, test_raw_video_raw_audio_partitions);
   tcase_add_test (tc_chain, test_raw_video_stride_transform);
   tcase_add_test (tc_chain, test_jpeg2000_alaw);
   tcase_add_test (tc_chain, test_dnxhd_mp3);
@@ -115,6 +115,418 @@ GST_START_TEST (test_parse_zerosize_frames)
 
 GST_END_TEST;
 
+#define UDP_FRAME_SIZE(payload_size) (14 + 20 + 8 + (payload_size))
+
+/* Records with this payload are bigger than the 64 KiB blocks pcapparse
+ * pulls, and the payload still fits in an IPv4 packet */
+#define LARGE_PAYLOAD_SIZE 65500
+
+/* Every third packet of a large file has a large payload */
+#define PAYLOAD_SIZE(i, large) \
+    ((large) && (i) % 3 == 1 ? LARGE_PAYLOAD_SIZE : 4)
+
+/* Ethernet, IPv4 and UDP headers from zerosize_data, with @payload_size
+ * bytes of @payload */
+static void
+create_udp_frame (guint8 * frame, guint16 dst_port, guint8 payload,
+    guint payload_size)
+{
+  memcpy (frame, zerosize_data + 24 + 16, 14 + 20 + 8);
+  GST_WRITE_UINT16_BE (frame + 14 + 2, 20 + 8 + payload_size);
+  GST_WRITE_UINT16_BE (frame + 14 + 20 + 2, dst_port);
+  GST_WRITE_UINT16_BE (frame + 14 + 20 + 4, 8 + payload_size);
+  memset (frame + 14 + 20 + 8, payload, payload_size);
+}
+
+static void
+append_pcapng_block (GByteArray * array, guint32 type, const guint8 * body,
+    guint body_size)
+{
+  guint8 header[8], padding[3] = { 0, };
+  guint32 total = 12 + GST_ROUND_UP_4 (body_size);
+
+  GST_WRITE_UINT32_LE (header, type);
+  GST_WRITE_UINT32_LE (header + 4, total);
+  g_byte_array_append (array, header, 8);
+  g_byte_array_append (array, body, body_size);
+  g_byte_array_append (array, padding, GST_ROUND_UP_4 (body_size) - body_size);
+  g_byte_array_append (array, header + 4, 4);
+}
+
+/* Creates a pcapng file with nanosecond timestamps, 1 s + 1 ms per packet.
+ * Packet i goes to port 5000 + 2 * (i % n_flows), and has PAYLOAD_SIZE
+ * bytes of payload */
+static GstBuffer *
+create_pcapng (guint n_packets, guint n_flows, gboolean large)
+{
+  GByteArray *array = g_byte_array_new ();
+  guint8 shb[16], idb[20];
+  gsize size;
+  guint i;
+
+  GST_WRITE_UINT32_LE (shb, 0x1a2b3c4d);
+  GST_WRITE_UINT16_LE (shb + 4, 1);
+  GST_WRITE_UINT16_LE (shb + 6, 0);
+  memset (shb + 8, 0xff, 8);
+  append_pcapng_block (array, 0x0a0d0d0a, shb, sizeof (shb));
+
+  /* Ethernet, with if_tsresol of 10^-9 */
+  memset (idb, 0, sizeof (idb));
+  GST_WRITE_UINT16_LE (idb, 1);
+  GST_WRITE_UINT16_LE (idb + 8, 9);
+  GST_WRITE_UINT16_LE (idb + 10, 1);
+  GST_WRITE_UINT8 (idb + 12, 9);
+  append_pcapng_block (array, 0x00000001, idb, sizeof (idb));
+
+  for (i = 0; i < n_packets; i++) {
+    guint64 ts = GST_SECOND + i * GST_MSECOND;
+    guint frame_size = UDP_FRAME_SIZE (PAYLOAD_SIZE (i, large));
+    guint8 *epb = g_malloc (20 + frame_size);
+
+    GST_WRITE_UINT32_LE (epb, 0);
+    GST_WRITE_UINT32_LE (epb + 4, ts >> 32);
+    GST_WRITE_UINT32_LE (epb + 8, ts & 0xffffffff);
+    GST_WRITE_UINT32_LE (epb + 12, frame_size);
+    GST_WRITE_UINT32_LE (epb + 16, frame_size);
+    create_udp_frame (epb + 20, 5000 + 2 * (i % n_flows), i,
+        PAYLOAD_SIZE (i, large));
+    append_pcapng_block (array, 0x00000006, epb, 20 + frame_size);
+    g_free (epb);
+  }
+
+  size = array->len;
+  return gst_buffer_new_wrapped (g_byte_array_free (array, FALSE), size);
+}
+
+/* Creates a pcap file with microsecond timestamps and the same packets as
+ * create_pcapng() with a single flow */
+static GstBuffer *
+create_pcap (guint n_packets, gboolean large)
+{
+  GByteArray *array = g_byte_array_new ();
+  gsize size;
+  guint i;
+
+  g_byte_array_append (array, pcap_header, sizeof (pcap_header));
+
+  for (i = 0; i < n_packets; i++) {
+    guint frame_size = UDP_FRAME_SIZE (PAYLOAD_SIZE (i, large));
+    guint8 *rec = g_malloc (16 + frame_size);
+
+    GST_WRITE_UINT32_LE (rec, 1);
+    GST_WRITE_UINT32_LE (rec + 4, i * 1000);
+    GST_WRITE_UINT32_LE (rec + 8, frame_size);
+    GST_WRITE_UINT32_LE (rec + 12, frame_size);
+    create_udp_frame (rec + 16, 5000, i, PAYLOAD_SIZE (i, large));
+    g_byte_array_append (array, rec, 16 + frame_size);
+    g_free (rec);
+  }
+
+  size = array->len;
+  return gst_buffer_new_wrapped (g_byte_array_free (array, FALSE), size);
+}
+
+GST_START_TEST (test_parse_pcapng)
+{
+  GstBuffer *out_buf;
+  GstHarness *h;
+  guint8 payload[4];
+  guint i;
+
+  h = gst_harness_new ("pcapparse");
+  gst_harness_set_src_caps_str (h, "raw/x-pcap");
+  gst_harness_play (h);
+
+  gst_harness_push (h, create_pcapng (3, 1, FALSE));
+  gst_harness_push_event (h, gst_event_new_eos ());
+
+  for (i = 0; i < 3; i++) {
+    out_buf = gst_harness_pull (h);
+    fail_unless_equals_int (gst_buffer_get_size (out_buf), 4);
+    gst_buffer_extract (out_buf, 0, payload, 4);
+    fail_unless_equals_int (payload[0], i);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (out_buf),
+        GST_SECOND + i * GST_MSECOND);
+    gst_buffer_unref (out_buf);
+  }
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+typedef struct
+{
+  GstPad *pads[2];
+  gchar *stream_ids[2];
+  guint n_buffers[2];
+  guint n_pads;
+} FlowPads;
+
+static GstPadProbeReturn
+flow_buffer_probe (GstPad * pad, GstPadProbeInfo * info, guint * n_buffers)
+{
+  /* the packets parsed from one input buffer are pushed as a list */
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER_LIST)
+    *n_buffers +=
+        gst_buffer_list_length (GST_PAD_PROBE_INFO_BUFFER_LIST (info));
+  else
+    (*n_buffers)++;
+
+  /* nothing is linked, pretend it was consumed */
+  return GST_PAD_PROBE_DROP;
+}
+
+static void
+flow_pad_added_cb (GstElement * element, GstPad * pad, FlowPads * flows)
+{
+  guint i = flows->n_pads++;
+
+  fail_unless (i < 2);
+  flows->pads[i] = pad;
+  flows->stream_ids[i] = gst_pad_get_stream_id (pad);
+  gst_pad_add_probe (pad,
+      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      (GstPadProbeCallback) flow_buffer_probe, &flows->n_buffers[i], NULL);
+}
+
+GST_START_TEST (test_parse_split_flows)
+{
+  FlowPads flows = { {NULL,}, };
+  GstHarness *h;
+  guint i;
+
+  h = gst_harness_new ("pcapparse");
+  g_object_set (h->element, "split-flows", TRUE, NULL);
+  g_signal_connect (h->element, "pad-added", G_CALLBACK (flow_pad_added_cb),
+      &flows);
+  gst_harness_set_src_caps_str (h, "raw/x-pcap");
+  gst_harness_play (h);
+
+  gst_harness_push (h, create_pcapng (6, 2, FALSE));
+
+  fail_unless_equals_int (flows.n_pads, 2);
+  for (i = 0; i < 2; i++) {
+    gchar *flow = g_strdup_printf ("/udp/127.0.0.1:53923/127.0.0.1:%u",
+        5000 + 2 * i);
+
+    fail_unless_equals_string (GST_PAD_NAME (flows.pads[i]),
+        i == 0 ? "src_0" : "src_1");
+    fail_unless (g_str_has_suffix (flows.stream_ids[i], flow));
+    fail_unless_equals_int (flows.n_buffers[i], 3);
+    g_free (flows.stream_ids[i]);
+    g_free (flow);
+  }
+
+  /* nothing on the always pad */
+  fail_unless_equals_int (gst_harness_buffers_received (h), 0);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static GstBuffer *pull_stream;
+static gboolean pull_eos;
+
+static GstFlowReturn
+pull_getrange (GstPad * pad, GstObject * parent, guint64 offset,
+    guint length, GstBuffer ** buffer)
+{
+  gsize size = gst_buffer_get_size (pull_stream);
+
+  if (offset >= size)
+    return GST_FLOW_EOS;
+
+  *buffer = gst_buffer_copy_region (pull_stream, GST_BUFFER_COPY_ALL, offset,
+      MIN (length, size - offset));
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+pull_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) != GST_QUERY_SCHEDULING)
+    return gst_pad_query_default (pad, parent, query);
+
+  gst_query_set_scheduling (query, GST_SCHEDULING_FLAG_SEEKABLE, 1, -1, 0);
+  gst_query_add_scheduling_mode (query, GST_PAD_MODE_PULL);
+
+  return TRUE;
+}
+
+static GstPadProbeReturn
+pull_eos_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  if (GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) == GST_EVENT_EOS) {
+    g_mutex_lock (&check_mutex);
+    pull_eos = TRUE;
+    g_cond_broadcast (&check_cond);
+    g_mutex_unlock (&check_mutex);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* Lets pcapparse pull @stream up to EOS and checks that it outputs the
+ * first @n_packets packets of a large file, and posts an error or not */
+static void
+check_pull (GstBuffer * stream, guint n_packets, gboolean error)
+{
+  GstElement *element;
+  GstPad *srcpad, *sinkpad;
+  GstBus *bus;
+  GstMessage *msg;
+  GList *l;
+  guint i;
+
+  pull_stream = stream;
+  pull_eos = FALSE;
+
+  element = setup_element (NULL);
+  bus = gst_bus_new ();
+  gst_element_set_bus (element, bus);
+
+  srcpad = gst_check_setup_src_pad (element, &srctemplate);
+  gst_pad_set_getrange_function (srcpad, pull_getrange);
+  gst_pad_set_query_function (srcpad, pull_query);
+  sinkpad = gst_check_setup_sink_pad (element, &sinktemplate_rtp);
+  gst_pad_add_probe (sinkpad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      pull_eos_probe, NULL, NULL);
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_pad_set_active (srcpad, TRUE);
+
+  fail_unless_equals_int (gst_element_set_state (element, GST_STATE_PAUSED),
+      GST_STATE_CHANGE_SUCCESS);
+
+  g_mutex_lock (&check_mutex);
+  while (!pull_eos)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_ERROR);
+  if (error) {
+    fail_unless (msg != NULL, "pcapparse posted no error");
+    gst_message_unref (msg);
+  } else {
+    fail_unless (msg == NULL, "pcapparse posted an error");
+  }
+
+  fail_unless_equals_int (g_list_length (buffers), n_packets);
+  for (l = buffers, i = 0; l; l = l->next, i++) {
+    GstBuffer *buf = l->data;
+    guint size = PAYLOAD_SIZE (i, TRUE);
+    guint8 first, last;
+
+    fail_unless_equals_int (gst_buffer_get_size (buf), size);
+    gst_buffer_extract (buf, 0, &first, 1);
+    gst_buffer_extract (buf, size - 1, &last, 1);
+    fail_unless_equals_int (first, i);
+    fail_unless_equals_int (last, i);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buf),
+        GST_SECOND + i * GST_MSECOND);
+  }
+
+  gst_element_set_state (element, GST_STATE_NULL);
+  gst_check_drop_buffers ();
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_check_teardown_src_pad (element);
+  gst_check_teardown_sink_pad (element);
+  gst_element_set_bus (element, NULL);
+  gst_object_unref (bus);
+  gst_check_teardown_element (element);
+  pull_stream = NULL;
+}
+
+/* The last of the packets is cut short, pcapparse stops at the end of the
+ * previous one */
+static GstBuffer *
+truncate_last_packet (GstBuffer * stream)
+{
+  GstBuffer *truncated;
+
+  truncated = gst_buffer_copy_region (stream, GST_BUFFER_COPY_ALL, 0,
+      gst_buffer_get_size (stream) - 1000);
+  gst_buffer_unref (stream);
+
+  return truncated;
+}
+
+#define PULL_PACKETS 7
+
+GST_START_TEST (test_parse_pull_pcap)
+{
+  GstBuffer *stream;
+
+  stream = create_pcap (PULL_PACKETS, TRUE);
+  check_pull (stream, PULL_PACKETS, FALSE);
+  gst_buffer_unref (stream);
+
+  /* the last packet is a large one */
+  stream = truncate_last_packet (create_pcap (PULL_PACKETS + 1, TRUE));
+  check_pull (stream, PULL_PACKETS, FALSE);
+  gst_buffer_unref (stream);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_parse_pull_pcapng)
+{
+  GstBuffer *stream;
+
+  stream = create_pcapng (PULL_PACKETS, 1, TRUE);
+  check_pull (stream, PULL_PACKETS, FALSE);
+  gst_buffer_unref (stream);
+
+  stream = truncate_last_packet (create_pcapng (PULL_PACKETS + 1, 1, TRUE));
+  check_pull (stream, PULL_PACKETS, FALSE);
+  gst_buffer_unref (stream);
+}
+
+GST_END_TEST;
+
+/* A pcap file of 3 small packets where the second record claims to capture
+ * @incl_len bytes */
+static GstBuffer *
+create_corrupt_pcap (guint32 incl_len)
+{
+  GstBuffer *stream = create_pcap (3, FALSE);
+  GstMapInfo map;
+
+  gst_buffer_map (stream, &map, GST_MAP_WRITE);
+  GST_WRITE_UINT32_LE (map.data + 24 + 16 + UDP_FRAME_SIZE (4) + 8, incl_len);
+  gst_buffer_unmap (stream, &map);
+
+  return stream;
+}
+
+/* The record size must neither wrap around, which made pcapparse read past
+ * the record or never move on, nor make it wait for gigabytes of data */
+GST_START_TEST (test_parse_corrupt_record_length)
+{
+  static const guint32 lengths[] = { 0xfffffff0, 0xffffffff, 0x10000000 };
+  GstHarness *h;
+  GstBuffer *stream;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (lengths); i++) {
+    h = gst_harness_new ("pcapparse");
+    gst_harness_set_src_caps_str (h, "raw/x-pcap");
+    fail_unless_equals_int (gst_harness_push (h,
+            create_corrupt_pcap (lengths[i])), GST_FLOW_ERROR);
+    fail_unless_equals_int (gst_harness_buffers_received (h), 0);
+    gst_harness_teardown (h);
+
+    stream = create_corrupt_pcap (lengths[i]);
+    check_pull (stream, 0, TRUE);
+    gst_buffer_unref (stream);
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 pcapparse_suite (void)
 {
@@ -133,6 +545,11 @@ pcapparse_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_parse_frames_with_eth_padding);
   tcase_add_test (tc_chain, test_parse_zerosize_frames);
+  tcase_add_test (tc_chain, test_parse_pcapng);
+  tcase_add_test (tc_chain, test_parse_split_flows);
+  tcase_add_test (tc_chain, test_parse_pull_pcap);
+  tcase_add_test (tc_chain, test_parse_pull_pcapng);
+  tcase_add_test (tc_chain, test_parse_corrupt_record_length);
 
   return s;
 }
@@ -0,0 +1,302 @@
+/* GStreamer unit tests for the ristdispatcher element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* using GValueArray, which has not replacement */
+#define GLIB_DISABLE_DEPRECATION_WARNINGS
+
+#include <gst/check/check.h>
+#include <gst/rtp/rtp.h>
+
+typedef struct
+{
+  GstHarness *link[2];
+  guint16 seqnum;
+} Dispatcher;
+
+static void
+dispatcher_setup (Dispatcher * d)
+{
+  d->link[0] = gst_harness_new_with_padnames ("ristdispatcher", "sink",
+      "src_0");
+  d->link[1] = gst_harness_new_with_element (d->link[0]->element, NULL,
+      "src_1");
+  gst_harness_set_src_caps_str (d->link[0], "application/x-rtp");
+  d->seqnum = 0;
+}
+
+static void
+dispatcher_teardown (Dispatcher * d)
+{
+  gst_harness_teardown (d->link[1]);
+  gst_harness_teardown (d->link[0]);
+}
+
+static void
+push_packets (Dispatcher * d, guint n)
+{
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    GstBuffer *buf = gst_rtp_buffer_new_allocate (100, 0, 0);
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+
+    gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp);
+    gst_rtp_buffer_set_seq (&rtp, d->seqnum++);
+    gst_rtp_buffer_unmap (&rtp);
+
+    fail_unless_equals_int (gst_harness_push (d->link[0], buf), GST_FLOW_OK);
+  }
+}
+
+/* Pulls everything sent on @link, dropping every @drop_every packet if
+ * set and reporting the dropped packets as lost */
+static guint
+pull_packets (Dispatcher * d, guint link, guint drop_every)
+{
+  GstBuffer *buf;
+  guint n = 0;
+
+  while ((buf = gst_harness_try_pull (d->link[link]))) {
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+    guint seqnum;
+
+    gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp);
+    seqnum = gst_rtp_buffer_get_seq (&rtp);
+    gst_rtp_buffer_unmap (&rtp);
+    gst_buffer_unref (buf);
+    n++;
+
+    if (drop_every && n % drop_every == 0)
+      g_signal_emit_by_name (d->link[0]->element, "report-lost", seqnum);
+  }
+
+  return n;
+}
+
+static void
+update_links (Dispatcher * d, GstClockTime rtt0, GstClockTime rtt1)
+{
+  g_signal_emit_by_name (d->link[0]->element, "update-link", 0, rtt0);
+  g_signal_emit_by_name (d->link[0]->element, "update-link", 1, rtt1);
+}
+
+static GstStructure *
+get_link_stats (Dispatcher * d, guint link)
+{
+  GstStructure *stats, *ret;
+  const GValueArray *links;
+  const GstStructure *s;
+  guint id;
+
+  g_object_get (d->link[0]->element, "stats", &stats, NULL);
+  links = g_value_get_boxed (gst_structure_get_value (stats, "link-stats"));
+  fail_unless_equals_int (links->n_values, 2);
+
+  s = g_value_get_boxed (g_value_array_get_nth ((GValueArray *) links, link));
+  fail_unless (gst_structure_get_uint (s, "link-id", &id));
+  fail_unless_equals_int (id, link);
+  ret = gst_structure_copy (s);
+  gst_structure_free (stats);
+
+  return ret;
+}
+
+static gdouble
+get_weight (Dispatcher * d, guint link)
+{
+  GstStructure *s = get_link_stats (d, link);
+  gdouble weight;
+
+  fail_unless (gst_structure_get_double (s, "weight", &weight));
+  gst_structure_free (s);
+
+  return weight;
+}
+
+static guint64
+get_lost_packets (Dispatcher * d, guint link)
+{
+  GstStructure *s = get_link_stats (d, link);
+  guint64 lost;
+
+  fail_unless (gst_structure_get_uint64 (s, "lost-packets", &lost));
+  gst_structure_free (s);
+
+  return lost;
+}
+
+GST_START_TEST (test_equal_links)
+{
+  Dispatcher d;
+
+  dispatcher_setup (&d);
+  update_links (&d, 20 * GST_MSECOND, 20 * GST_MSECOND);
+
+  push_packets (&d, 1000);
+  fail_unless_equals_int (pull_packets (&d, 0, 0), 500);
+  fail_unless_equals_int (pull_packets (&d, 1, 0), 500);
+  fail_unless (ABS (get_weight (&d, 0) - 0.5) < 0.001);
+
+  dispatcher_teardown (&d);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtt_weighting)
+{
+  Dispatcher d;
+  guint n0, n1;
+
+  dispatcher_setup (&d);
+  g_object_set (d.link[0]->element, "min-weight", 0.0, NULL);
+  update_links (&d, 10 * GST_MSECOND, 40 * GST_MSECOND);
+
+  /* the score is inversely proportional to the RTT */
+  push_packets (&d, 1000);
+  n0 = pull_packets (&d, 0, 0);
+  n1 = pull_packets (&d, 1, 0);
+  fail_unless_equals_int (n0, 800);
+  fail_unless_equals_int (n1, 200);
+
+  dispatcher_teardown (&d);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_lossy_link)
+{
+  Dispatcher d;
+  guint i, n0 = 0, n1 = 0;
+  gdouble weight;
+
+  dispatcher_setup (&d);
+  update_links (&d, 20 * GST_MSECOND, 20 * GST_MSECOND);
+
+  /* every round is one RTCP interval, link 1 loses a third of the packets */
+  for (i = 0; i < 6; i++) {
+    push_packets (&d, 200);
+    n0 = pull_packets (&d, 0, 0);
+    n1 = pull_packets (&d, 1, 3);
+    update_links (&d, 20 * GST_MSECOND, 20 * GST_MSECOND);
+    GST_INFO ("round %u: link 0 %u packets, link 1 %u packets", i, n0, n1);
+  }
+
+  /* after a few reports most of the traffic left the lossy link */
+  weight = get_weight (&d, 1);
+  GST_INFO ("lossy link weight %f", weight);
+  fail_unless (weight < 0.3);
+  fail_unless (n1 < n0 / 2);
+
+  /* but comes back progressively once the losses stopped */
+  for (i = 0; i < 20; i++) {
+    push_packets (&d, 200);
+    pull_packets (&d, 0, 0);
+    pull_packets (&d, 1, 0);
+    update_links (&d, 20 * GST_MSECOND, 20 * GST_MSECOND);
+  }
+  fail_unless (get_weight (&d, 1) > 0.45);
+
+  dispatcher_teardown (&d);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_min_weight)
+{
+  Dispatcher d;
+  guint i;
+
+  dispatcher_setup (&d);
+  g_object_set (d.link[0]->element, "min-weight", 0.1, NULL);
+
+  /* losing everything on link 1 still keeps it probed */
+  for (i = 0; i < 10; i++) {
+    GstBuffer *buf;
+
+    push_packets (&d, 100);
+    pull_packets (&d, 0, 0);
+    while ((buf = gst_harness_try_pull (d.link[1]))) {
+      GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+      guint seqnum;
+
+      gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp);
+      seqnum = gst_rtp_buffer_get_seq (&rtp);
+      gst_rtp_buffer_unmap (&rtp);
+      gst_buffer_unref (buf);
+
+      g_signal_emit_by_name (d.link[0]->element, "report-lost", seqnum);
+    }
+    update_links (&d, 20 * GST_MSECOND, 20 * GST_MSECOND);
+  }
+
+  fail_unless (ABS (get_weight (&d, 1) - 0.1) < 0.001);
+
+  push_packets (&d, 100);
+  fail_unless_equals_int (pull_packets (&d, 1, 0), 10);
+
+  dispatcher_teardown (&d);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_release_link)
+{
+  Dispatcher d;
+  guint i;
+
+  dispatcher_setup (&d);
+  update_links (&d, 20 * GST_MSECOND, 20 * GST_MSECOND);
+
+  push_packets (&d, 100);
+  fail_unless_equals_int (pull_packets (&d, 0, 0), 50);
+  fail_unless_equals_int (pull_packets (&d, 1, 0), 50);
+
+  /* a new link with the same id must not be blamed for the packets sent on
+   * the released one */
+  gst_harness_teardown (d.link[1]);
+  d.link[1] = gst_harness_new_with_element (d.link[0]->element, NULL,
+      "src_1");
+
+  for (i = 0; i < 100; i++)
+    g_signal_emit_by_name (d.link[0]->element, "report-lost", i);
+
+  fail_unless_equals_uint64 (get_lost_packets (&d, 0), 50);
+  fail_unless_equals_uint64 (get_lost_packets (&d, 1), 0);
+
+  dispatcher_teardown (&d);
+}
+
+GST_END_TEST;
+
+static Suite *
+ristdispatcher_suite (void)
+{
+  Suite *s = suite_create ("ristdispatcher");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_equal_links);
+  tcase_add_test (tc_chain, test_rtt_weighting);
+  tcase_add_test (tc_chain, test_lossy_link);
+  tcase_add_test (tc_chain, test_min_weight);
+  tcase_add_test (tc_chain, test_release_link);
+
+  return s;
+}
+
+GST_CHECK_MAIN (ristdispatcher);
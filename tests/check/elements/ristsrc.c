@@ -0,0 +1,510 @@
+/* GStreamer unit tests for the ristsrc bonding
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* using GValueArray, which has not replacement */
+#define GLIB_DISABLE_DEPRECATION_WARNINGS
+
+#include <gst/check/check.h>
+#include <gst/rtp/rtp.h>
+#include <gio/gio.h>
+
+#define SSRC 0x12345678
+#define PT 33
+#define PAYLOAD_SIZE 188
+
+/* one sender per bond, sending RTP and receiving RTCP like a ristsink */
+typedef struct
+{
+  guint port;
+  GSocket *rtp;
+  GSocket *rtcp;
+  GSocketAddress *rtp_dest;
+  GSocketAddress *rtcp_dest;
+} Link;
+
+typedef struct
+{
+  GstHarness *h;
+  Link link[2];
+} Bonding;
+
+static GSocket *
+bind_socket (guint port)
+{
+  GSocket *socket;
+  GInetAddress *iaddr;
+  GSocketAddress *addr;
+  gboolean ret;
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+  fail_unless (socket != NULL);
+
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (iaddr, port);
+  ret = g_socket_bind (socket, addr, FALSE, NULL);
+  g_object_unref (addr);
+  g_object_unref (iaddr);
+
+  if (!ret) {
+    g_object_unref (socket);
+    return NULL;
+  }
+
+  return socket;
+}
+
+static guint
+socket_port (GSocket * socket)
+{
+  GSocketAddress *addr = g_socket_get_local_address (socket, NULL);
+  guint port;
+
+  port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (addr));
+  g_object_unref (addr);
+
+  return port;
+}
+
+/* RIST needs an even port for RTP and the next one for RTCP */
+static guint
+find_free_ports (void)
+{
+  while (TRUE) {
+    GSocket *rtp = bind_socket (0), *rtcp;
+    guint port = socket_port (rtp);
+
+    if (port & 1 || port >= G_MAXUINT16) {
+      g_object_unref (rtp);
+      continue;
+    }
+
+    rtcp = bind_socket (port + 1);
+    g_object_unref (rtp);
+    if (rtcp) {
+      g_object_unref (rtcp);
+      return port;
+    }
+  }
+}
+
+static GSocketAddress *
+loopback_address (guint port)
+{
+  GInetAddress *iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  GSocketAddress *addr = g_inet_socket_address_new (iaddr, port);
+
+  g_object_unref (iaddr);
+  return addr;
+}
+
+static void
+send_rtp_ssrc (Link * link, guint32 ssrc, guint16 seqnum)
+{
+  guint8 data[12 + PAYLOAD_SIZE] = { 0, };
+
+  data[0] = 0x80;
+  data[1] = PT;
+  GST_WRITE_UINT16_BE (data + 2, seqnum);
+  GST_WRITE_UINT32_BE (data + 4, seqnum * 3600);
+  GST_WRITE_UINT32_BE (data + 8, ssrc);
+  memset (data + 12, seqnum & 0xff, PAYLOAD_SIZE);
+
+  fail_unless_equals_int (g_socket_send_to (link->rtp, link->rtp_dest,
+          (const gchar *) data, sizeof (data), NULL, NULL), sizeof (data));
+}
+
+static void
+send_rtp (Link * link, guint16 seqnum, gboolean retransmission)
+{
+  /* RIST retransmissions use the SSRC with the lowest bit set */
+  send_rtp_ssrc (link, retransmission ? SSRC | 1 : SSRC, seqnum);
+}
+
+/* ristsrc sends its RTCP back to where it received RTCP from */
+static void
+send_sender_report (Link * link)
+{
+  GstBuffer *buf = gst_rtcp_buffer_new (1000);
+  GstRTCPBuffer rtcp = GST_RTCP_BUFFER_INIT;
+  GstRTCPPacket packet;
+  GstMapInfo map;
+
+  gst_rtcp_buffer_map (buf, GST_MAP_READWRITE, &rtcp);
+  fail_unless (gst_rtcp_buffer_add_packet (&rtcp, GST_RTCP_TYPE_SR, &packet));
+  gst_rtcp_packet_sr_set_sender_info (&packet, SSRC, 0, 0, 0, 0);
+  fail_unless (gst_rtcp_buffer_add_packet (&rtcp, GST_RTCP_TYPE_SDES,
+          &packet));
+  gst_rtcp_packet_sdes_add_item (&packet, SSRC);
+  gst_rtcp_packet_sdes_add_entry (&packet, GST_RTCP_SDES_CNAME, 6,
+      (const guint8 *) "sender");
+  gst_rtcp_buffer_unmap (&rtcp);
+
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  fail_unless_equals_int (g_socket_send_to (link->rtcp, link->rtcp_dest,
+          (const gchar *) map.data, map.size, NULL, NULL), map.size);
+  gst_buffer_unmap (buf, &map);
+  gst_buffer_unref (buf);
+}
+
+/* Returns TRUE if @data holds a generic or a RIST range NACK for @seqnum */
+static gboolean
+rtcp_has_nack (const guint8 * data, gsize size, guint16 seqnum)
+{
+  GstBuffer *buf = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+      (gpointer) data, size, 0, size, NULL, NULL);
+  GstRTCPBuffer rtcp = GST_RTCP_BUFFER_INIT;
+  GstRTCPPacket packet;
+  gboolean ret = FALSE;
+
+  if (!gst_rtcp_buffer_validate_reduced (buf)) {
+    gst_buffer_unref (buf);
+    return FALSE;
+  }
+
+  gst_rtcp_buffer_map (buf, GST_MAP_READ, &rtcp);
+  if (gst_rtcp_buffer_get_first_packet (&rtcp, &packet)) {
+    do {
+      GstRTCPType type = gst_rtcp_packet_get_type (&packet);
+      guint8 *fci;
+      guint i, len;
+
+      if (type == GST_RTCP_TYPE_RTPFB &&
+          gst_rtcp_packet_fb_get_type (&packet) == GST_RTCP_RTPFB_TYPE_NACK) {
+        fci = gst_rtcp_packet_fb_get_fci (&packet);
+        len = gst_rtcp_packet_fb_get_fci_length (&packet);
+        for (i = 0; i < len; i++) {
+          guint16 pid = GST_READ_UINT16_BE (fci + i * 4);
+          guint16 blp = GST_READ_UINT16_BE (fci + i * 4 + 2);
+
+          if (pid == seqnum || (((guint16) (seqnum - pid - 1)) < 16 &&
+                  (blp & (1 << (guint16) (seqnum - pid - 1)))))
+            ret = TRUE;
+        }
+      } else if (type == GST_RTCP_TYPE_APP &&
+          !strncmp (gst_rtcp_packet_app_get_name (&packet), "RIST", 4)) {
+        fci = gst_rtcp_packet_app_get_data (&packet);
+        len = gst_rtcp_packet_app_get_data_length (&packet);
+        for (i = 0; i < len; i++) {
+          guint16 start = GST_READ_UINT16_BE (fci + i * 4);
+          guint16 extra = GST_READ_UINT16_BE (fci + i * 4 + 2);
+
+          if ((guint16) (seqnum - start) <= extra)
+            ret = TRUE;
+        }
+      }
+    } while (gst_rtcp_packet_move_to_next (&packet));
+  }
+  gst_rtcp_buffer_unmap (&rtcp);
+  gst_buffer_unref (buf);
+
+  return ret;
+}
+
+/* Waits up to @timeout for a NACK of @seqnum on any link, returns the
+ * index of the link or -1 */
+static gint
+wait_nack (Bonding * b, guint16 seqnum, GstClockTime timeout)
+{
+  gint64 end = g_get_monotonic_time () + timeout / GST_USECOND;
+  guint i;
+
+  while (g_get_monotonic_time () < end) {
+    for (i = 0; i < 2; i++) {
+      GSocket *socket = b->link[i].rtcp;
+      guint8 data[1500];
+      gssize size;
+
+      if (!g_socket_condition_timed_wait (socket, G_IO_IN,
+              10 * G_TIME_SPAN_MILLISECOND, NULL, NULL))
+        continue;
+
+      size = g_socket_receive (socket, (gchar *) data, sizeof (data), NULL,
+          NULL);
+      if (size > 0 && rtcp_has_nack (data, size, seqnum))
+        return i;
+    }
+  }
+
+  return -1;
+}
+
+static void
+bonding_setup (Bonding * b)
+{
+  gchar *addresses;
+  guint i;
+
+  for (i = 0; i < 2; i++) {
+    Link *link = &b->link[i];
+
+    do {
+      link->port = find_free_ports ();
+    } while (i > 0 && link->port == b->link[0].port);
+    link->rtp = bind_socket (0);
+    link->rtcp = bind_socket (0);
+    link->rtp_dest = loopback_address (link->port);
+    link->rtcp_dest = loopback_address (link->port + 1);
+  }
+
+  b->h = gst_harness_new_with_padnames ("ristsrc", NULL, "src");
+  addresses = g_strdup_printf ("127.0.0.1:%u,127.0.0.1:%u", b->link[0].port,
+      b->link[1].port);
+  /* a single retransmission request per packet, and a buffer long enough
+   * for the test to answer it */
+  g_object_set (b->h->element, "bonding-addresses", addresses,
+      "receiver-buffer", 2000, "max-rtx-retries", 1, NULL);
+  g_free (addresses);
+
+  gst_harness_play (b->h);
+}
+
+static void
+bonding_teardown (Bonding * b)
+{
+  guint i;
+
+  gst_harness_teardown (b->h);
+
+  for (i = 0; i < 2; i++) {
+    Link *link = &b->link[i];
+
+    g_object_unref (link->rtp);
+    g_object_unref (link->rtcp);
+    g_object_unref (link->rtp_dest);
+    g_object_unref (link->rtcp_dest);
+  }
+}
+
+static void
+pull_seqnums (Bonding * b, guint16 first, guint16 last)
+{
+  guint16 seqnum;
+
+  for (seqnum = first; seqnum <= last; seqnum++) {
+    GstBuffer *buf = gst_harness_pull (b->h);
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+
+    fail_unless (buf != NULL);
+    fail_unless (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+    fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtp), seqnum);
+    fail_unless_equals_int (gst_rtp_buffer_get_ssrc (&rtp), SSRC);
+    gst_rtp_buffer_unmap (&rtp);
+    gst_buffer_unref (buf);
+  }
+}
+
+static GstStructure *
+get_stats (Bonding * b)
+{
+  GstStructure *stats;
+
+  g_object_get (b->h->element, "stats", &stats, NULL);
+  fail_unless (stats != NULL);
+
+  return stats;
+}
+
+static const GstStructure *
+get_session_stats (const GstStructure * stats, guint session)
+{
+  const GValueArray *sessions;
+  const GstStructure *s;
+  gint id;
+
+  sessions = g_value_get_boxed (gst_structure_get_value (stats,
+          "session-stats"));
+  fail_unless_equals_int (sessions->n_values, 2);
+
+  s = g_value_get_boxed (g_value_array_get_nth ((GValueArray *) sessions,
+          session));
+  fail_unless (gst_structure_get_int (s, "session-id", &id));
+  fail_unless_equals_int (id, session);
+
+  return s;
+}
+
+static guint64
+get_uint64 (const GstStructure * s, const gchar * field)
+{
+  guint64 val;
+
+  fail_unless (gst_structure_get_uint64 (s, field, &val), "no %s", field);
+
+  return val;
+}
+
+GST_START_TEST (test_bonding_duplicates)
+{
+  Bonding b;
+  GstStructure *stats;
+  guint16 seqnum;
+  guint i;
+
+  bonding_setup (&b);
+
+  /* every packet is sent on both links, only one copy gets out */
+  for (seqnum = 0; seqnum < 20; seqnum++) {
+    send_rtp (&b.link[0], seqnum, FALSE);
+    send_rtp (&b.link[1], seqnum, FALSE);
+    g_usleep (5 * G_TIME_SPAN_MILLISECOND);
+  }
+  pull_seqnums (&b, 0, 19);
+
+  stats = get_stats (&b);
+  fail_unless_equals_uint64 (get_uint64 (stats, "bonding-duplicates"), 20);
+  fail_unless_equals_uint64 (get_uint64 (get_session_stats (stats, 0),
+          "duplicates") + get_uint64 (get_session_stats (stats, 1),
+          "duplicates"), 20);
+  for (i = 0; i < 2; i++) {
+    fail_unless (get_uint64 (get_session_stats (stats, i), "bitrate") > 0);
+    fail_unless_equals_uint64 (get_uint64 (get_session_stats (stats, i),
+            "recovered"), 0);
+  }
+  gst_structure_free (stats);
+
+  fail_unless_equals_int (gst_harness_buffers_in_queue (b.h), 0);
+
+  bonding_teardown (&b);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_bonding_retransmission)
+{
+  Bonding b;
+  GstStructure *stats;
+  const GstStructure *asked, *other;
+  gdouble rtx_loss;
+  guint16 seqnum;
+  gint nacked;
+  guint i;
+
+  bonding_setup (&b);
+
+  for (i = 0; i < 2; i++)
+    send_sender_report (&b.link[i]);
+
+  /* both links are alive */
+  for (seqnum = 0; seqnum < 10; seqnum++) {
+    send_rtp (&b.link[seqnum % 2], seqnum, FALSE);
+    g_usleep (5 * G_TIME_SPAN_MILLISECOND);
+  }
+  pull_seqnums (&b, 0, 9);
+
+  /* 10 is lost on both links and must only be requested on one of them */
+  send_rtp (&b.link[0], 11, FALSE);
+  send_rtp (&b.link[1], 12, FALSE);
+
+  nacked = wait_nack (&b, 10, 2 * GST_SECOND);
+  fail_unless (nacked >= 0, "the retransmission request was not sent");
+  fail_unless_equals_int (wait_nack (&b, 10, 300 * GST_MSECOND), -1);
+
+  /* the original packet shows up late on the other link before the
+   * retransmission, which still answers the request */
+  send_rtp (&b.link[1 - nacked], 10, FALSE);
+  send_rtp (&b.link[nacked], 10, TRUE);
+  pull_seqnums (&b, 10, 12);
+
+  /* let the retransmission reach the probe before reading the stats */
+  g_usleep (50 * G_TIME_SPAN_MILLISECOND);
+
+  stats = get_stats (&b);
+  asked = get_session_stats (stats, nacked);
+  other = get_session_stats (stats, 1 - nacked);
+
+  fail_unless_equals_uint64 (get_uint64 (asked,
+          "retransmission-requests-sent"), 1);
+  fail_unless_equals_uint64 (get_uint64 (other,
+          "retransmission-requests-sent"), 0);
+  fail_unless (get_uint64 (asked, "round-trip-time") > 0);
+  fail_unless (gst_structure_get_double (asked, "rtx-loss-fraction",
+          &rtx_loss));
+  fail_unless_equals_float (rtx_loss, 0.0);
+  /* the retransmission was a duplicate of the late packet */
+  fail_unless_equals_uint64 (get_uint64 (asked, "duplicates"), 1);
+  fail_unless_equals_uint64 (get_uint64 (asked, "recovered"), 0);
+  fail_unless_equals_uint64 (get_uint64 (stats, "bonding-duplicates"), 1);
+  gst_structure_free (stats);
+
+  bonding_teardown (&b);
+}
+
+GST_END_TEST;
+
+/* The most SSRCs ristsrc keeps duplicate suppression state for */
+#define MAX_SSRCS 16
+
+GST_START_TEST (test_bonding_stray_ssrcs)
+{
+  Bonding b;
+  GstStructure *stats;
+  guint16 seqnum;
+  guint ssrcs, i;
+
+  bonding_setup (&b);
+
+  for (seqnum = 0; seqnum < 10; seqnum++) {
+    send_rtp (&b.link[0], seqnum, FALSE);
+    send_rtp (&b.link[1], seqnum, FALSE);
+    g_usleep (5 * G_TIME_SPAN_MILLISECOND);
+  }
+  pull_seqnums (&b, 0, 9);
+
+  /* single packets of other senders are held back by the RTP session
+   * probation, but each of them was seen on the link */
+  for (i = 0; i < 4 * MAX_SSRCS; i++)
+    send_rtp_ssrc (&b.link[0], 0x10000000 + 2 * i, 0);
+
+  /* the state of the stream was dropped for the strays, duplicates are
+   * still suppressed with the new one */
+  for (seqnum = 10; seqnum < 20; seqnum++) {
+    send_rtp (&b.link[0], seqnum, FALSE);
+    send_rtp (&b.link[1], seqnum, FALSE);
+    g_usleep (5 * G_TIME_SPAN_MILLISECOND);
+  }
+  pull_seqnums (&b, 10, 19);
+
+  stats = get_stats (&b);
+  fail_unless (gst_structure_get_uint (stats, "bonding-ssrcs", &ssrcs));
+  fail_unless (ssrcs > 0 && ssrcs <= MAX_SSRCS, "%u SSRCs tracked", ssrcs);
+  fail_unless_equals_uint64 (get_uint64 (stats, "bonding-duplicates"), 20);
+  gst_structure_free (stats);
+
+  fail_unless_equals_int (gst_harness_buffers_in_queue (b.h), 0);
+
+  bonding_teardown (&b);
+}
+
+GST_END_TEST;
+
+static Suite *
+ristsrc_suite (void)
+{
+  Suite *s = suite_create ("ristsrc");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_bonding_duplicates);
+  tcase_add_test (tc_chain, test_bonding_retransmission);
+  tcase_add_test (tc_chain, test_bonding_stray_ssrcs);
+
+  return s;
+}
+
+GST_CHECK_MAIN (ristsrc);
@@ -0,0 +1,371 @@
+/* GStreamer unit tests for the rtmp2 elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <string.h>
+
+#define AUDIO_PAYLOAD_SIZE 64
+#define NUM_TAGS 20
+
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  gchar *stream_id;
+  GList *buffers;
+  guint num_buffers;
+  gboolean eos;
+  /* blocks the streaming thread before the first buffer */
+  gboolean hold, held;
+} Received;
+
+typedef struct
+{
+  GMutex lock;
+  Received received[2];
+  guint num_pads;
+} Server;
+
+static GstPadProbeReturn
+received_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  Received *r = user_data;
+
+  g_mutex_lock (&r->lock);
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER) {
+    while (r->hold) {
+      r->held = TRUE;
+      g_cond_broadcast (&r->cond);
+      g_cond_wait (&r->cond, &r->lock);
+    }
+
+    r->buffers = g_list_append (r->buffers,
+        gst_buffer_ref (GST_PAD_PROBE_INFO_BUFFER (info)));
+    r->num_buffers++;
+  } else if (GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) == GST_EVENT_EOS) {
+    r->eos = TRUE;
+  }
+
+  g_cond_signal (&r->cond);
+  g_mutex_unlock (&r->lock);
+
+  /* nothing is linked, so pretend everything was consumed */
+  return GST_PAD_PROBE_DROP;
+}
+
+static void
+pad_added_cb (GstElement * element, GstPad * pad, Server * s)
+{
+  guint index;
+
+  g_mutex_lock (&s->lock);
+  index = s->num_pads++;
+  g_mutex_unlock (&s->lock);
+
+  fail_unless (index < G_N_ELEMENTS (s->received));
+
+  /* stream-start was stored before the pad was added */
+  s->received[index].stream_id = gst_pad_get_stream_id (pad);
+
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+      GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, received_probe,
+      &s->received[index], NULL);
+}
+
+static GstElement *
+server_start (Server * s, guint * port)
+{
+  GstElement *server = gst_element_factory_make ("rtmp2serversrc", NULL);
+  guint i;
+
+  memset (s, 0, sizeof (Server));
+  g_mutex_init (&s->lock);
+  for (i = 0; i < G_N_ELEMENTS (s->received); i++) {
+    g_mutex_init (&s->received[i].lock);
+    g_cond_init (&s->received[i].cond);
+  }
+
+  fail_unless (server != NULL);
+  g_object_set (server, "host", "127.0.0.1", "port", 0, NULL);
+  g_signal_connect (server, "pad-added", G_CALLBACK (pad_added_cb), s);
+
+  fail_unless (gst_element_set_state (server, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+  g_object_get (server, "current-port", port, NULL);
+  fail_unless (*port != 0);
+
+  return server;
+}
+
+static void
+server_stop (Server * s, GstElement * server)
+{
+  guint i;
+
+  fail_unless_equals_int (gst_element_set_state (server, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+  gst_object_unref (server);
+
+  for (i = 0; i < G_N_ELEMENTS (s->received); i++) {
+    g_list_free_full (s->received[i].buffers,
+        (GDestroyNotify) gst_buffer_unref);
+    g_free (s->received[i].stream_id);
+    g_mutex_clear (&s->received[i].lock);
+    g_cond_clear (&s->received[i].cond);
+  }
+  g_mutex_clear (&s->lock);
+}
+
+static GstHarness *
+publisher_new (guint port, const gchar * stream)
+{
+  GstHarness *h = gst_harness_new ("rtmp2sink");
+  gchar *location;
+
+  location = g_strdup_printf ("rtmp://127.0.0.1:%u/live/%s", port, stream);
+  g_object_set (h->element, "location", location, "async-connect", FALSE,
+      "sync", FALSE, NULL);
+  g_free (location);
+
+  gst_harness_set_src_caps_str (h, "video/x-flv");
+
+  return h;
+}
+
+/* What flvmux would produce for a small linear PCM audio frame */
+static GstBuffer *
+create_audio_tag (guint32 timestamp)
+{
+  GstBuffer *buf = gst_buffer_new_allocate (NULL,
+      11 + AUDIO_PAYLOAD_SIZE + 4, NULL);
+  GstMapInfo map;
+
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memset (map.data, 0, map.size);
+  GST_WRITE_UINT8 (map.data, 8);
+  GST_WRITE_UINT24_BE (map.data + 1, AUDIO_PAYLOAD_SIZE);
+  GST_WRITE_UINT24_BE (map.data + 4, timestamp);
+  /* linear PCM, 44 kHz, 16 bits, mono */
+  GST_WRITE_UINT8 (map.data + 11, 0x3e);
+  GST_WRITE_UINT8 (map.data + 12, timestamp & 0xff);
+  GST_WRITE_UINT32_BE (map.data + 11 + AUDIO_PAYLOAD_SIZE,
+      11 + AUDIO_PAYLOAD_SIZE);
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+static void
+publish_tags (GstHarness * h, guint n)
+{
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    fail_unless_equals_int (gst_harness_push (h, create_audio_tag (i * 10)),
+        GST_FLOW_OK);
+  }
+}
+
+static void
+wait_for_buffers (Received * r, guint n)
+{
+  gint64 deadline = g_get_monotonic_time () + 10 * G_TIME_SPAN_SECOND;
+
+  g_mutex_lock (&r->lock);
+  while (r->num_buffers < n) {
+    fail_unless (g_cond_wait_until (&r->cond, &r->lock, deadline));
+  }
+  g_mutex_unlock (&r->lock);
+}
+
+static void
+wait_for_eos (Received * r)
+{
+  gint64 deadline = g_get_monotonic_time () + 10 * G_TIME_SPAN_SECOND;
+
+  g_mutex_lock (&r->lock);
+  while (!r->eos) {
+    fail_unless (g_cond_wait_until (&r->cond, &r->lock, deadline));
+  }
+  g_mutex_unlock (&r->lock);
+}
+
+static void
+check_received (Received * r, const gchar * stream)
+{
+  GList *l;
+  guint i;
+
+  fail_unless (r->stream_id != NULL);
+  fail_unless (g_str_has_suffix (r->stream_id, stream));
+  fail_unless_equals_int (r->num_buffers, NUM_TAGS);
+
+  for (l = r->buffers, i = 0; l; l = l->next, i++) {
+    GstBuffer *buf = l->data;
+    GstMapInfo map;
+    guint8 *tag;
+
+    gst_buffer_map (buf, &map, GST_MAP_READ);
+    tag = map.data;
+
+    /* the FLV header only precedes the first tag */
+    if (i == 0) {
+      fail_unless_equals_int (map.size, 13 + 11 + AUDIO_PAYLOAD_SIZE + 4);
+      fail_unless (memcmp (map.data, "FLV", 3) == 0);
+      tag += 13;
+    } else {
+      fail_unless_equals_int (map.size, 11 + AUDIO_PAYLOAD_SIZE + 4);
+    }
+
+    fail_unless_equals_int (GST_READ_UINT8 (tag), 8);
+    fail_unless_equals_int (GST_READ_UINT24_BE (tag + 1), AUDIO_PAYLOAD_SIZE);
+    fail_unless_equals_int (GST_READ_UINT24_BE (tag + 4), i * 10);
+    fail_unless_equals_int (GST_READ_UINT8 (tag + 12), (i * 10) & 0xff);
+    gst_buffer_unmap (buf, &map);
+  }
+}
+
+GST_START_TEST (test_server_single_publisher)
+{
+  GstElement *server;
+  GstHarness *h;
+  Server s;
+  guint port;
+
+  server = server_start (&s, &port);
+
+  h = publisher_new (port, "test");
+  publish_tags (h, NUM_TAGS);
+  wait_for_buffers (&s.received[0], NUM_TAGS);
+
+  /* closing the connection ends the stream */
+  gst_harness_teardown (h);
+  wait_for_eos (&s.received[0]);
+
+  check_received (&s.received[0], "live/test");
+  fail_unless_equals_int (s.num_pads, 1);
+
+  server_stop (&s, server);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_server_concurrent_publishers)
+{
+  GstElement *server;
+  GstHarness *h1, *h2;
+  Server s;
+  guint port, i;
+
+  server = server_start (&s, &port);
+
+  h1 = publisher_new (port, "first");
+  publish_tags (h1, 1);
+  wait_for_buffers (&s.received[0], 1);
+
+  h2 = publisher_new (port, "second");
+
+  /* interleave both streams over the same server */
+  publish_tags (h2, 1);
+  for (i = 1; i < NUM_TAGS; i++) {
+    fail_unless_equals_int (gst_harness_push (h1, create_audio_tag (i * 10)),
+        GST_FLOW_OK);
+    fail_unless_equals_int (gst_harness_push (h2, create_audio_tag (i * 10)),
+        GST_FLOW_OK);
+  }
+  wait_for_buffers (&s.received[0], NUM_TAGS);
+  wait_for_buffers (&s.received[1], NUM_TAGS);
+
+  gst_harness_teardown (h1);
+  wait_for_eos (&s.received[0]);
+
+  gst_harness_teardown (h2);
+  wait_for_eos (&s.received[1]);
+
+  fail_unless_equals_int (s.num_pads, 2);
+  check_received (&s.received[0], "live/first");
+  check_received (&s.received[1], "live/second");
+
+  server_stop (&s, server);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_server_queue_limit)
+{
+  GstElement *server;
+  GstHarness *h;
+  Server s;
+  guint port;
+
+  server = server_start (&s, &port);
+
+  /* less than the tags published, the server has to stop reading from the
+   * publisher and resume once downstream takes buffers again */
+  g_object_set (server, "max-queue-bytes", 1024, NULL);
+  s.received[0].hold = TRUE;
+
+  h = publisher_new (port, "test");
+  publish_tags (h, NUM_TAGS);
+
+  /* give the server some time to fill the queue behind the held buffer */
+  g_mutex_lock (&s.received[0].lock);
+  while (!s.received[0].held)
+    g_cond_wait (&s.received[0].cond, &s.received[0].lock);
+  g_mutex_unlock (&s.received[0].lock);
+  g_usleep (100 * G_TIME_SPAN_MILLISECOND);
+
+  g_mutex_lock (&s.received[0].lock);
+  s.received[0].hold = FALSE;
+  g_cond_broadcast (&s.received[0].cond);
+  g_mutex_unlock (&s.received[0].lock);
+
+  /* nothing was dropped */
+  wait_for_buffers (&s.received[0], NUM_TAGS);
+
+  gst_harness_teardown (h);
+  wait_for_eos (&s.received[0]);
+
+  check_received (&s.received[0], "live/test");
+
+  server_stop (&s, server);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtmp2_suite (void)
+{
+  Suite *s = suite_create ("rtmp2");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_set_timeout (tc_chain, 60);
+  tcase_add_test (tc_chain, test_server_single_publisher);
+  tcase_add_test (tc_chain, test_server_concurrent_publishers);
+  tcase_add_test (tc_chain, test_server_queue_limit);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtmp2);
@@ -0,0 +1,511 @@
+/* GStreamer unit tests for the rtpbatch and rtpbatchsrc elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <gio/gio.h>
+#include <gst/check/gstcheck.h>
+#include <gst/rtp/rtp.h>
+
+#define PACKET_SIZE 1200
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+static GstPadProbeReturn
+count_lists_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  GArray *lengths = user_data;
+  guint len = 1;
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER_LIST)
+    len = gst_buffer_list_length (GST_PAD_PROBE_INFO_BUFFER_LIST (info));
+
+  g_array_append_val (lengths, len);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GArray *
+add_count_probe (GstElement * element)
+{
+  GArray *lengths = g_array_new (FALSE, FALSE, sizeof (guint));
+  GstPad *pad = gst_element_get_static_pad (element, "src");
+
+  gst_pad_add_probe (pad,
+      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      count_lists_probe, lengths, NULL);
+  gst_object_unref (pad);
+
+  return lengths;
+}
+
+static void
+pull_and_check (GstHarness * h, guint n)
+{
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    GstBuffer *buf = gst_harness_pull (h);
+
+    fail_unless (buf != NULL);
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), i);
+    gst_buffer_unref (buf);
+  }
+}
+
+static GstBuffer *
+create_packet (guint64 offset)
+{
+  GstBuffer *buf = gst_buffer_new_allocate (NULL, PACKET_SIZE, NULL);
+
+  GST_BUFFER_OFFSET (buf) = offset;
+
+  return buf;
+}
+
+GST_START_TEST (test_batch_max_packets)
+{
+  GstHarness *h = gst_harness_new ("rtpbatch");
+  GArray *lengths;
+  guint i;
+
+  g_object_set (h->element, "max-packets", 4, "max-latency", 10 * GST_SECOND,
+      NULL);
+  lengths = add_count_probe (h->element);
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+
+  for (i = 0; i < 8; i++)
+    fail_unless_equals_int (gst_harness_push (h, create_packet (i)),
+        GST_FLOW_OK);
+
+  pull_and_check (h, 8);
+  fail_unless_equals_int (lengths->len, 2);
+  fail_unless_equals_int (g_array_index (lengths, guint, 0), 4);
+  fail_unless_equals_int (g_array_index (lengths, guint, 1), 4);
+
+  g_array_unref (lengths);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_batch_max_latency)
+{
+  GstHarness *h = gst_harness_new ("rtpbatch");
+  GArray *lengths;
+
+  g_object_set (h->element, "max-packets", 32, "max-latency", 5 * GST_MSECOND,
+      NULL);
+  lengths = add_count_probe (h->element);
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+
+  /* an incomplete batch is still sent once its latency expired */
+  fail_unless_equals_int (gst_harness_push (h, create_packet (0)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_push (h, create_packet (1)),
+      GST_FLOW_OK);
+  pull_and_check (h, 2);
+  fail_unless_equals_int (lengths->len, 1);
+  fail_unless_equals_int (g_array_index (lengths, guint, 0), 2);
+
+  g_array_unref (lengths);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_batch_eos_drains)
+{
+  GstHarness *h = gst_harness_new ("rtpbatch");
+  GstEvent *event;
+
+  g_object_set (h->element, "max-packets", 32, "max-latency", 10 * GST_SECOND,
+      NULL);
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+
+  fail_unless_equals_int (gst_harness_push (h, create_packet (0)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_push (h, create_packet (1)),
+      GST_FLOW_OK);
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+
+  pull_and_check (h, 2);
+
+  /* stream-start, caps and segment come first */
+  while ((event = gst_harness_pull_event (h))) {
+    GstEventType type = GST_EVENT_TYPE (event);
+
+    gst_event_unref (event);
+    if (type == GST_EVENT_EOS)
+      break;
+  }
+  fail_unless (event != NULL);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static GSocket *
+create_loopback_socket (GSocketAddress ** bound_addr)
+{
+  GInetAddress *iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  GSocketAddress *addr = g_inet_socket_address_new (iaddr, 0);
+  GSocket *socket;
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+  fail_unless (socket != NULL);
+  fail_unless (g_socket_bind (socket, addr, FALSE, NULL));
+
+  if (bound_addr)
+    *bound_addr = g_socket_get_local_address (socket, NULL);
+
+  g_object_unref (addr);
+  g_object_unref (iaddr);
+
+  return socket;
+}
+
+static void
+send_packets (GSocket * socket, GSocketAddress * dest, guint64 first, guint n)
+{
+  guint8 data[PACKET_SIZE] = { 0, };
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    GST_WRITE_UINT64_BE (data, first + i);
+    fail_unless_equals_int (g_socket_send_to (socket, dest, (gchar *) data,
+            sizeof (data), NULL, NULL), sizeof (data));
+  }
+}
+
+static GstHarness *
+create_batch_src (GSocket * socket, guint max_packets)
+{
+  GstElement *element = gst_element_factory_make ("rtpbatchsrc", NULL);
+  GstHarness *h;
+
+  g_object_set (element, "socket", socket, "max-packets", max_packets, NULL);
+  h = gst_harness_new_full (element, NULL, NULL, &sink_template, "src");
+  gst_object_unref (element);
+
+  return h;
+}
+
+static void
+pull_packets (GstHarness * h, guint64 first, guint n)
+{
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    GstBuffer *buf = gst_harness_pull (h);
+    GstMapInfo map;
+
+    fail_unless (buf != NULL);
+    gst_buffer_map (buf, &map, GST_MAP_READ);
+    fail_unless_equals_int (map.size, PACKET_SIZE);
+    fail_unless_equals_uint64 (GST_READ_UINT64_BE (map.data), first + i);
+    gst_buffer_unmap (buf, &map);
+    gst_buffer_unref (buf);
+  }
+}
+
+GST_START_TEST (test_batch_src_receives_pending)
+{
+  GSocketAddress *dest;
+  GSocket *receiver, *sender;
+  GstHarness *h;
+  GArray *lengths;
+
+  receiver = create_loopback_socket (&dest);
+  sender = create_loopback_socket (NULL);
+
+  h = create_batch_src (receiver, 32);
+  lengths = add_count_probe (h->element);
+
+  /* everything already queued on the socket comes out as a single list */
+  send_packets (sender, dest, 0, 16);
+  gst_harness_play (h);
+  pull_packets (h, 0, 16);
+
+  fail_unless_equals_int (lengths->len, 1);
+  fail_unless_equals_int (g_array_index (lengths, guint, 0), 16);
+
+  g_array_unref (lengths);
+  gst_harness_teardown (h);
+  g_object_unref (dest);
+  g_object_unref (receiver);
+  g_object_unref (sender);
+}
+
+GST_END_TEST;
+
+#define BENCHMARK_PACKETS 5000
+#define BENCHMARK_BURST 64
+
+GST_START_TEST (test_batch_src_loopback_benchmark)
+{
+  static const guint batch_sizes[] = { 1, 8, 32, 64 };
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (batch_sizes); i++) {
+    GSocketAddress *dest;
+    GSocket *receiver, *sender;
+    GstHarness *h;
+    GArray *lengths;
+    gint64 start, elapsed;
+    guint64 sent;
+
+    receiver = create_loopback_socket (&dest);
+    sender = create_loopback_socket (NULL);
+
+    h = create_batch_src (receiver, batch_sizes[i]);
+    lengths = add_count_probe (h->element);
+    gst_harness_play (h);
+
+    /* bursts are pulled before the next one is sent so that the socket
+     * receive buffer never overflows */
+    start = g_get_monotonic_time ();
+    for (sent = 0; sent < BENCHMARK_PACKETS; sent += BENCHMARK_BURST) {
+      send_packets (sender, dest, sent, BENCHMARK_BURST);
+      pull_packets (h, sent, BENCHMARK_BURST);
+    }
+    elapsed = g_get_monotonic_time () - start;
+
+    GST_INFO ("batch size %u: %" G_GUINT64_FORMAT " packets in %u pushes, %"
+        G_GINT64_FORMAT " us, %.0f packets/s", batch_sizes[i], sent,
+        lengths->len, elapsed, sent * 1e6 / MAX (elapsed, 1));
+
+    if (batch_sizes[i] == 1)
+      fail_unless_equals_int (lengths->len, sent);
+
+    g_array_unref (lengths);
+    gst_harness_teardown (h);
+    g_object_unref (dest);
+    g_object_unref (receiver);
+    g_object_unref (sender);
+  }
+}
+
+GST_END_TEST;
+
+/* The same stream sent with rtpsink to rtpsrc, or with ristsink to ristsrc,
+ * with batching on both ends */
+
+#define LOOPBACK_SSRC 0x12345678
+#define LOOPBACK_PT 33
+#define LOOPBACK_PAYLOAD_SIZE 188
+#define LOOPBACK_PACKETS 120
+#define LOOPBACK_BATCH_SIZE 8
+/* not a multiple of the batch size, so that some batches only leave once
+ * their latency expired */
+#define LOOPBACK_BURST 12
+#define LOOPBACK_CAPS "application/x-rtp, media=(string)video, " \
+    "clock-rate=(int)90000, encoding-name=(string)MP2T, payload=(int)33"
+
+/* the receivers need an even port for RTP and the next one for RTCP */
+static guint
+find_free_ports (void)
+{
+  GInetAddress *iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  guint port = 0;
+
+  while (port == 0) {
+    GSocketAddress *addr;
+    GSocket *rtp, *rtcp;
+
+    rtp = create_loopback_socket (&addr);
+    port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (addr));
+    g_object_unref (addr);
+
+    if ((port & 1) == 0 && port < G_MAXUINT16) {
+      rtcp = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+          G_SOCKET_PROTOCOL_UDP, NULL);
+      fail_unless (rtcp != NULL);
+      addr = g_inet_socket_address_new (iaddr, port + 1);
+      if (!g_socket_bind (rtcp, addr, FALSE, NULL))
+        port = 0;
+      g_object_unref (addr);
+      g_object_unref (rtcp);
+    } else {
+      port = 0;
+    }
+
+    g_object_unref (rtp);
+  }
+
+  g_object_unref (iaddr);
+
+  return port;
+}
+
+static GstBuffer *
+create_rtp_packet (guint16 seqnum)
+{
+  GstBuffer *buf = gst_rtp_buffer_new_allocate (LOOPBACK_PAYLOAD_SIZE, 0, 0);
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+
+  fail_unless (gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp));
+  gst_rtp_buffer_set_payload_type (&rtp, LOOPBACK_PT);
+  gst_rtp_buffer_set_seq (&rtp, seqnum);
+  gst_rtp_buffer_set_timestamp (&rtp, seqnum * 3600);
+  gst_rtp_buffer_set_ssrc (&rtp, LOOPBACK_SSRC);
+  memset (gst_rtp_buffer_get_payload (&rtp), seqnum & 0xff,
+      LOOPBACK_PAYLOAD_SIZE);
+  gst_rtp_buffer_unmap (&rtp);
+
+  return buf;
+}
+
+static void
+pull_rtp_packet (GstHarness * h, guint16 seqnum)
+{
+  GstBuffer *buf = gst_harness_pull (h);
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint8 *payload;
+
+  fail_unless (buf != NULL, "packet %u not received", seqnum);
+  fail_unless (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+  fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtp), seqnum);
+  fail_unless_equals_int (gst_rtp_buffer_get_ssrc (&rtp), LOOPBACK_SSRC);
+  fail_unless_equals_int (gst_rtp_buffer_get_payload_len (&rtp),
+      LOOPBACK_PAYLOAD_SIZE);
+  payload = gst_rtp_buffer_get_payload (&rtp);
+  fail_unless_equals_int (payload[0], seqnum & 0xff);
+  fail_unless_equals_int (payload[LOOPBACK_PAYLOAD_SIZE - 1], seqnum & 0xff);
+  gst_rtp_buffer_unmap (&rtp);
+  gst_buffer_unref (buf);
+}
+
+static void
+check_batch_child (GstHarness * h, const gchar * name)
+{
+  GstElement *child = gst_bin_get_by_name (GST_BIN (h->element), name);
+
+  fail_unless (child != NULL, "%s not used by %s", name,
+      GST_ELEMENT_NAME (h->element));
+  gst_object_unref (child);
+}
+
+/* Every packet must arrive, in order, through the batching elements. The
+ * bursts are pulled before the next one is sent so that the socket receive
+ * buffer never overflows. */
+static void
+run_loopback (GstHarness * sender, GstHarness * receiver)
+{
+  guint16 seqnum;
+  guint i;
+
+  gst_harness_play (receiver);
+  gst_harness_set_src_caps_str (sender, LOOPBACK_CAPS);
+  gst_harness_play (sender);
+
+  for (seqnum = 0; seqnum < LOOPBACK_PACKETS; seqnum += LOOPBACK_BURST) {
+    for (i = 0; i < LOOPBACK_BURST; i++)
+      fail_unless_equals_int (gst_harness_push (sender,
+              create_rtp_packet (seqnum + i)), GST_FLOW_OK);
+    for (i = 0; i < LOOPBACK_BURST; i++)
+      pull_rtp_packet (receiver, seqnum + i);
+  }
+}
+
+static void
+rtp_src_pad_added_cb (GstElement * element, GstPad * pad, GstHarness * h)
+{
+  gst_harness_add_element_src_pad (h, pad);
+}
+
+GST_START_TEST (test_rtp_sink_to_rtp_src_batched)
+{
+  GstHarness *sender, *receiver;
+  GstElement *rtpsrc;
+  gchar *uri;
+
+  uri = g_strdup_printf ("rtp://127.0.0.1:%u", find_free_ports ());
+
+  /* rtpsrc only adds its source pad once the stream arrives */
+  rtpsrc = gst_element_factory_make ("rtpsrc", NULL);
+  g_object_set (rtpsrc, "uri", uri, "encoding-name", "MP2T", "batch-size",
+      LOOPBACK_BATCH_SIZE, NULL);
+  receiver = gst_harness_new_with_element (rtpsrc, NULL, NULL);
+  g_signal_connect (rtpsrc, "pad-added", G_CALLBACK (rtp_src_pad_added_cb),
+      receiver);
+  gst_object_unref (rtpsrc);
+
+  sender = gst_harness_new_with_padnames ("rtpsink", "sink_%u", NULL);
+  g_object_set (sender->element, "uri", uri, "batch-size",
+      LOOPBACK_BATCH_SIZE, "batch-latency", 5 * GST_MSECOND, NULL);
+
+  run_loopback (sender, receiver);
+  check_batch_child (sender, "rtp_rtp_batch0");
+  check_batch_child (receiver, "rtp_rtp_batchsrc0");
+
+  gst_harness_teardown (sender);
+  gst_harness_teardown (receiver);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rist_sink_to_rist_src_batched)
+{
+  GstHarness *sender, *receiver;
+  guint port = find_free_ports ();
+
+  receiver = gst_harness_new_with_padnames ("ristsrc", NULL, "src");
+  g_object_set (receiver->element, "address", "127.0.0.1", "port", port,
+      "batch-size", LOOPBACK_BATCH_SIZE, NULL);
+
+  sender = gst_harness_new_with_padnames ("ristsink", "sink", NULL);
+  g_object_set (sender->element, "address", "127.0.0.1", "port", port,
+      "batch-size", LOOPBACK_BATCH_SIZE, "batch-latency", 5 * GST_MSECOND,
+      NULL);
+
+  run_loopback (sender, receiver);
+  check_batch_child (sender, "rist_rtp_batch0");
+  check_batch_child (receiver, "rist_rtp_batchsrc0");
+
+  gst_harness_teardown (sender);
+  gst_harness_teardown (receiver);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtpbatch_suite (void)
+{
+  Suite *s = suite_create ("rtpbatch");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_batch_max_packets);
+  tcase_add_test (tc_chain, test_batch_max_latency);
+  tcase_add_test (tc_chain, test_batch_eos_drains);
+  tcase_add_test (tc_chain, test_batch_src_receives_pending);
+  tcase_add_test (tc_chain, test_batch_src_loopback_benchmark);
+  tcase_add_test (tc_chain, test_rtp_sink_to_rtp_src_batched);
+  tcase_add_test (tc_chain, test_rist_sink_to_rist_src_batched);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtpbatch);
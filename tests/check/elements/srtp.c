@@ -30,6 +30,7 @@
 #include <gst/check/gstcheck.h>
 
 #include <gst/check/gstharness.h>
+#include <gst/rtp/gstrtpbuffer.h>
 
 GST_START_TEST (test_create_and_unref)
 {
@@ -207,6 +208,250 @@ GST_START_TEST (test_roc)
 
 GST_END_TEST;
 
+#define N_LIST_PACKETS 48
+#define N_LIST_SSRCS 3
+
+static GstBufferList *
+create_rtp_list (guint32 ssrc_base, guint16 seq_base)
+{
+  GstBufferList *list = gst_buffer_list_new ();
+  gint i;
+
+  for (i = 0; i < N_LIST_PACKETS; i++) {
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+    GstBuffer *buf = gst_rtp_buffer_new_allocate (160, 0, 0);
+
+    gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp);
+    gst_rtp_buffer_set_payload_type (&rtp, 8);
+    gst_rtp_buffer_set_ssrc (&rtp, ssrc_base + i % N_LIST_SSRCS);
+    gst_rtp_buffer_set_seq (&rtp, seq_base + i / N_LIST_SSRCS);
+    gst_rtp_buffer_set_timestamp (&rtp, 160 * (i / N_LIST_SSRCS));
+    memset (gst_rtp_buffer_get_payload (&rtp), i, 160);
+    gst_rtp_buffer_unmap (&rtp);
+
+    gst_buffer_list_add (list, buf);
+  }
+
+  return list;
+}
+
+#define RTP_LIST_CAPS "application/x-rtp, payload=(int)8, " \
+    "media=(string)audio, clock-rate=(int)8000, encoding-name=(string)PCMA"
+
+static GstHarness *
+create_list_harness (guint n_threads)
+{
+  GstHarness *h;
+  GstBuffer *key;
+  guint8 key_data[30];
+  gint i;
+
+  for (i = 0; i < sizeof (key_data); i++)
+    key_data[i] = i;
+  key = gst_buffer_new_wrapped (g_memdup (key_data, sizeof (key_data)),
+      sizeof (key_data));
+
+  h = gst_harness_new_with_padnames ("srtpenc", "rtp_sink_0", "rtp_src_0");
+  g_object_set (h->element, "key", key, "n-threads", n_threads, NULL);
+  gst_buffer_unref (key);
+  gst_harness_set_src_caps_str (h, RTP_LIST_CAPS);
+
+  return h;
+}
+
+static GstBufferList *
+pull_list (GstHarness * h)
+{
+  GstBufferList *out = gst_buffer_list_new ();
+  gint i;
+
+  for (i = 0; i < N_LIST_PACKETS; i++) {
+    GstBuffer *buf = gst_harness_pull (h);
+
+    fail_unless (buf != NULL);
+    gst_buffer_list_add (out, buf);
+  }
+
+  return out;
+}
+
+static GstBufferList *
+protect_list (guint n_threads)
+{
+  GstHarness *h = create_list_harness (n_threads);
+  GstBufferList *out;
+
+  fail_unless_equals_int (gst_pad_push_list (h->srcpad,
+          create_rtp_list (0x1000, 100)), GST_FLOW_OK);
+  out = pull_list (h);
+
+  gst_harness_teardown (h);
+
+  return out;
+}
+
+static void
+check_lists_equal (GstBufferList * a, GstBufferList * b)
+{
+  gint i;
+
+  fail_unless_equals_int (gst_buffer_list_length (a),
+      gst_buffer_list_length (b));
+
+  for (i = 0; i < gst_buffer_list_length (a); i++) {
+    GstBuffer *buf_a = gst_buffer_list_get (a, i);
+    GstBuffer *buf_b = gst_buffer_list_get (b, i);
+    GstMapInfo map;
+
+    fail_unless_equals_int (gst_buffer_get_size (buf_a),
+        gst_buffer_get_size (buf_b));
+    gst_buffer_map (buf_b, &map, GST_MAP_READ);
+    fail_unless (gst_buffer_memcmp (buf_a, 0, map.data, map.size) == 0,
+        "packet %d differs", i);
+    gst_buffer_unmap (buf_b, &map);
+  }
+}
+
+GST_START_TEST (test_threaded_buffer_list)
+{
+  GstBufferList *single, *threaded;
+  gint i;
+
+  single = protect_list (1);
+  threaded = protect_list (4);
+
+  /* Packets of each SSRC are protected by their own session, so the output
+   * must not depend on how the list was split across threads */
+  for (i = 0; i < N_LIST_PACKETS; i++) {
+    GstBuffer *a = gst_buffer_list_get (single, i);
+    GstBuffer *b = gst_buffer_list_get (threaded, i);
+    GstMapInfo map;
+
+    fail_unless_equals_int (gst_buffer_get_size (a), 12 + 160 + 10);
+    fail_unless_equals_int (gst_buffer_get_size (a), gst_buffer_get_size (b));
+    gst_buffer_map (b, &map, GST_MAP_READ);
+    fail_unless (gst_buffer_memcmp (a, 0, map.data, map.size) == 0);
+    fail_unless_equals_int (GST_READ_UINT32_BE (map.data + 8),
+        0x1000 + i % N_LIST_SSRCS);
+    gst_buffer_unmap (b, &map);
+  }
+
+  gst_buffer_list_unref (single);
+  gst_buffer_list_unref (threaded);
+}
+
+GST_END_TEST;
+
+#define N_PAD_LISTS 50
+
+typedef struct
+{
+  GstHarness *h;
+  guint32 ssrc_base;
+} PadPusher;
+
+static gpointer
+push_pad_lists (PadPusher * pusher)
+{
+  gint i;
+
+  for (i = 0; i < N_PAD_LISTS; i++) {
+    GstBufferList *list = create_rtp_list (pusher->ssrc_base,
+        i * N_LIST_PACKETS / N_LIST_SSRCS);
+
+    fail_unless_equals_int (gst_pad_push_list (pusher->h->srcpad, list),
+        GST_FLOW_OK);
+  }
+
+  return NULL;
+}
+
+/* Each pad has its own streaming thread, the lists of both pads are
+ * protected at the same time and must not wait for each other's jobs */
+GST_START_TEST (test_threaded_buffer_list_two_pads)
+{
+  PadPusher pushers[2];
+  GThread *threads[2];
+  gint i, p;
+
+  pushers[0].h = create_list_harness (4);
+  pushers[0].ssrc_base = 0x1000;
+  pushers[1].h = gst_harness_new_with_element (pushers[0].h->element,
+      "rtp_sink_1", "rtp_src_1");
+  gst_harness_set_src_caps_str (pushers[1].h, RTP_LIST_CAPS);
+  pushers[1].ssrc_base = 0x2000;
+
+  for (p = 0; p < 2; p++)
+    threads[p] = g_thread_new ("srtpenc-pad", (GThreadFunc) push_pad_lists,
+        &pushers[p]);
+  for (p = 0; p < 2; p++)
+    g_thread_join (threads[p]);
+
+  for (p = 0; p < 2; p++) {
+    guint16 next_seq[N_LIST_SSRCS] = { 0, };
+
+    fail_unless_equals_int (gst_harness_buffers_in_queue (pushers[p].h),
+        N_PAD_LISTS * N_LIST_PACKETS);
+
+    for (i = 0; i < N_PAD_LISTS * N_LIST_PACKETS; i++) {
+      GstBuffer *buf = gst_harness_pull (pushers[p].h);
+      GstMapInfo map;
+      guint32 ssrc;
+
+      gst_buffer_map (buf, &map, GST_MAP_READ);
+      fail_unless_equals_int (map.size, 12 + 160 + 10);
+      ssrc = GST_READ_UINT32_BE (map.data + 8);
+      fail_unless (ssrc >= pushers[p].ssrc_base &&
+          ssrc < pushers[p].ssrc_base + N_LIST_SSRCS);
+      /* the packets of every SSRC come out in order */
+      fail_unless_equals_int (GST_READ_UINT16_BE (map.data + 2),
+          next_seq[ssrc - pushers[p].ssrc_base]++);
+      gst_buffer_unmap (buf, &map);
+      gst_buffer_unref (buf);
+    }
+  }
+
+  gst_harness_teardown (pushers[1].h);
+  gst_harness_teardown (pushers[0].h);
+}
+
+GST_END_TEST;
+
+/* A list pushed to two branches is shared, its buffers must not be
+ * protected in place even if each of them is only held by the list */
+GST_START_TEST (test_shared_buffer_list)
+{
+  GstHarness *h1, *h2;
+  GstBufferList *list, *orig, *out1, *out2;
+
+  h1 = create_list_harness (1);
+  h2 = create_list_harness (1);
+  list = create_rtp_list (0x1000, 100);
+  orig = gst_buffer_list_copy_deep (list);
+
+  fail_unless_equals_int (gst_pad_push_list (h1->srcpad,
+          gst_buffer_list_ref (list)), GST_FLOW_OK);
+  check_lists_equal (list, orig);
+
+  fail_unless_equals_int (gst_pad_push_list (h2->srcpad,
+          gst_buffer_list_ref (list)), GST_FLOW_OK);
+  check_lists_equal (list, orig);
+
+  /* same key, same packets */
+  out1 = pull_list (h1);
+  out2 = pull_list (h2);
+  check_lists_equal (out1, out2);
+
+  gst_buffer_list_unref (out1);
+  gst_buffer_list_unref (out2);
+  gst_buffer_list_unref (orig);
+  gst_buffer_list_unref (list);
+  gst_harness_teardown (h1);
+  gst_harness_teardown (h2);
+}
+
+GST_END_TEST;
+
 #ifdef HAVE_SRTP2
 
 GST_START_TEST (test_simple_mki)
@@ -352,6 +597,9 @@ srtp_suite (void)
   tcase_add_test (tc_chain, test_create_and_unref);
   tcase_add_test (tc_chain, test_play);
   tcase_add_test (tc_chain, test_roc);
+  tcase_add_test (tc_chain, test_threaded_buffer_list);
+  tcase_add_test (tc_chain, test_threaded_buffer_list_two_pads);
+  tcase_add_test (tc_chain, test_shared_buffer_list);
 #ifdef HAVE_SRTP2
   tcase_add_test (tc_chain, test_simple_mki);
   tcase_add_test (tc_chain, test_srtpdec_multiple_mki);
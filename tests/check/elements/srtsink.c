@@ -0,0 +1,458 @@
+/* GStreamer unit tests for the srtsink listener send queues
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* using GValueArray, which has not replacement */
+#define GLIB_DISABLE_DEPRECATION_WARNINGS
+
+#include <gst/check/gstcheck.h>
+#include <gst/app/app.h>
+#include <gio/gio.h>
+
+#include <srt/srt.h>
+#include <string.h>
+
+/* one SRT message per buffer */
+#define MSG_SIZE 1316
+
+/* enough to fill the SRT send buffer of a caller that doesn't read, and
+ * then its queue */
+#define MAX_BUFFERS 40000
+
+/* An SRT caller connected to the sink. Callers that read check that they
+ * get every buffer in order. */
+typedef struct
+{
+  SRTSOCKET sock;
+  GThread *thread;
+  GMutex lock;
+  GCond cond;
+  gboolean stopping;
+  guint received;
+  gboolean out_of_order;
+} Caller;
+
+typedef struct
+{
+  GstElement *pipeline;
+  GstElement *src;
+  GstElement *sink;
+  guint port;
+
+  GMutex lock;
+  GCond cond;
+  guint callers_added;
+  guint callers_removed;
+} Sender;
+
+static guint
+find_free_port (void)
+{
+  GInetAddress *iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  GSocketAddress *addr = g_inet_socket_address_new (iaddr, 0), *bound;
+  GSocket *socket;
+  guint port;
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+  fail_unless (g_socket_bind (socket, addr, FALSE, NULL));
+  bound = g_socket_get_local_address (socket, NULL);
+  port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (bound));
+
+  g_object_unref (bound);
+  g_object_unref (socket);
+  g_object_unref (addr);
+  g_object_unref (iaddr);
+
+  return port;
+}
+
+static void
+caller_added_cb (GstElement * sink, gint sock, GSocketAddress * addr,
+    Sender * s)
+{
+  g_mutex_lock (&s->lock);
+  s->callers_added++;
+  g_cond_broadcast (&s->cond);
+  g_mutex_unlock (&s->lock);
+}
+
+static void
+caller_removed_cb (GstElement * sink, gint sock, GSocketAddress * addr,
+    Sender * s)
+{
+  g_mutex_lock (&s->lock);
+  s->callers_removed++;
+  g_cond_broadcast (&s->cond);
+  g_mutex_unlock (&s->lock);
+}
+
+static void
+sender_setup (Sender * s, guint queue_size, const gchar * policy)
+{
+  gchar *desc;
+
+  g_mutex_init (&s->lock);
+  g_cond_init (&s->cond);
+  s->callers_added = s->callers_removed = 0;
+  s->port = find_free_port ();
+
+  desc = g_strdup_printf ("appsrc name=src ! srtsink name=sink "
+      "uri=srt://127.0.0.1:%u?mode=listener wait-for-connection=true "
+      "caller-queue-size=%u slow-caller-policy=%s", s->port, queue_size,
+      policy);
+  s->pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_unless (s->pipeline != NULL);
+
+  s->src = gst_bin_get_by_name (GST_BIN (s->pipeline), "src");
+  s->sink = gst_bin_get_by_name (GST_BIN (s->pipeline), "sink");
+  g_signal_connect (s->sink, "caller-added", G_CALLBACK (caller_added_cb), s);
+  g_signal_connect (s->sink, "caller-removed",
+      G_CALLBACK (caller_removed_cb), s);
+
+  /* the listener socket is bound when the sink starts */
+  fail_if (gst_element_set_state (s->pipeline, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE);
+}
+
+static void
+sender_teardown (Sender * s)
+{
+  gst_element_set_state (s->pipeline, GST_STATE_NULL);
+  gst_object_unref (s->src);
+  gst_object_unref (s->sink);
+  gst_object_unref (s->pipeline);
+  g_mutex_clear (&s->lock);
+  g_cond_clear (&s->cond);
+}
+
+static void
+sender_wait_callers (Sender * s, guint n)
+{
+  gint64 end_time = g_get_monotonic_time () + 5 * G_TIME_SPAN_SECOND;
+
+  g_mutex_lock (&s->lock);
+  while (s->callers_added < n)
+    fail_unless (g_cond_wait_until (&s->cond, &s->lock, end_time),
+        "callers did not connect");
+  g_mutex_unlock (&s->lock);
+}
+
+static guint
+sender_callers_removed (Sender * s)
+{
+  guint ret;
+
+  g_mutex_lock (&s->lock);
+  ret = s->callers_removed;
+  g_mutex_unlock (&s->lock);
+
+  return ret;
+}
+
+static void
+sender_push (Sender * s, guint index)
+{
+  GstBuffer *buf = gst_buffer_new_allocate (NULL, MSG_SIZE, NULL);
+  GstMapInfo map;
+
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  memset (map.data, index & 0xff, MSG_SIZE);
+  GST_WRITE_UINT32_BE (map.data, index);
+  gst_buffer_unmap (buf, &map);
+
+  fail_unless_equals_int (gst_app_src_push_buffer (GST_APP_SRC (s->src), buf),
+      GST_FLOW_OK);
+}
+
+/* EOS only reaches the bus once the queues were sent */
+static void
+sender_finish (Sender * s)
+{
+  GstBus *bus = gst_element_get_bus (s->pipeline);
+  GstMessage *msg;
+
+  fail_unless_equals_int (gst_app_src_end_of_stream (GST_APP_SRC (s->src)),
+      GST_FLOW_OK);
+
+  msg = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (msg != NULL, "no EOS");
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+}
+
+/* Returns the number of callers that had buffers dropped */
+static guint
+sender_callers_dropping (Sender * s)
+{
+  GstStructure *stats;
+  const GValue *v;
+  guint i, ret = 0;
+
+  g_object_get (s->sink, "stats", &stats, NULL);
+  v = gst_structure_get_value (stats, "callers");
+  if (v) {
+    GValueArray *callers = g_value_get_boxed (v);
+
+    for (i = 0; i < callers->n_values; i++) {
+      const GstStructure *c =
+          g_value_get_boxed (g_value_array_get_nth (callers, i));
+      guint64 dropped;
+
+      fail_unless (gst_structure_get_uint64 (c, "buffers-dropped", &dropped));
+      if (dropped > 0)
+        ret++;
+    }
+  }
+  gst_structure_free (stats);
+
+  return ret;
+}
+
+static gpointer
+caller_read_func (Caller * c)
+{
+  gchar buf[1500];
+
+  while (TRUE) {
+    gint len = srt_recvmsg (c->sock, buf, sizeof (buf));
+
+    if (len < 0) {
+      gint err = srt_getlasterror (NULL);
+      gboolean stopping;
+
+      g_mutex_lock (&c->lock);
+      stopping = c->stopping;
+      g_mutex_unlock (&c->lock);
+
+      if (!stopping && (err == SRT_EASYNCRCV || err == SRT_ETIMEOUT))
+        continue;
+      break;
+    }
+
+    g_mutex_lock (&c->lock);
+    if (len != MSG_SIZE || GST_READ_UINT32_BE (buf) != c->received)
+      c->out_of_order = TRUE;
+    c->received++;
+    g_cond_broadcast (&c->cond);
+    g_mutex_unlock (&c->lock);
+  }
+
+  return NULL;
+}
+
+static void
+caller_connect (Caller * c, guint port, gboolean read)
+{
+  struct sockaddr_in sa = { 0, };
+  gint no = 0, timeout = 100;
+
+  memset (c, 0, sizeof (Caller));
+  g_mutex_init (&c->lock);
+  g_cond_init (&c->cond);
+
+  c->sock = srt_socket (AF_INET, SOCK_DGRAM, 0);
+  fail_unless (c->sock != SRT_INVALID_SOCK);
+
+  /* nothing may be dropped for being late, and packets are delivered as
+   * soon as they are received */
+  fail_if (srt_setsockopt (c->sock, 0, SRTO_TLPKTDROP, &no, sizeof (no)));
+  fail_if (srt_setsockopt (c->sock, 0, SRTO_TSBPDMODE, &no, sizeof (no)));
+  fail_if (srt_setsockopt (c->sock, 0, SRTO_RCVTIMEO, &timeout,
+          sizeof (timeout)));
+
+  sa.sin_family = AF_INET;
+  sa.sin_port = g_htons (port);
+  sa.sin_addr.s_addr = g_htonl (INADDR_LOOPBACK);
+  fail_if (srt_connect (c->sock, (struct sockaddr *) &sa, sizeof (sa)),
+      "%s", srt_getlasterror_str ());
+
+  /* a caller that doesn't read fills its receive buffer, then the send
+   * buffer of the sink */
+  if (read)
+    c->thread = g_thread_new ("srt-caller", (GThreadFunc) caller_read_func,
+        c);
+}
+
+static void
+caller_wait_received (Caller * c, guint n)
+{
+  gint64 end_time = g_get_monotonic_time () + 10 * G_TIME_SPAN_SECOND;
+
+  g_mutex_lock (&c->lock);
+  while (c->received < n && g_cond_wait_until (&c->cond, &c->lock, end_time));
+  fail_unless_equals_int (c->received, n);
+  fail_if (c->out_of_order);
+  g_mutex_unlock (&c->lock);
+}
+
+static void
+caller_close (Caller * c)
+{
+  if (c->thread) {
+    g_mutex_lock (&c->lock);
+    c->stopping = TRUE;
+    g_mutex_unlock (&c->lock);
+    g_thread_join (c->thread);
+  }
+
+  srt_close (c->sock);
+  g_mutex_clear (&c->lock);
+  g_cond_clear (&c->cond);
+}
+
+GST_START_TEST (test_drain_at_eos)
+{
+  Sender s;
+  Caller c;
+  guint i;
+
+  srt_startup ();
+
+  sender_setup (&s, 0, "drop-oldest");
+  caller_connect (&c, s.port, TRUE);
+  sender_wait_callers (&s, 1);
+
+  /* everything is queued at once, EOS waits for the caller to get it all */
+  for (i = 0; i < 2000; i++)
+    sender_push (&s, i);
+  sender_finish (&s);
+
+  /* closing the sink right away must not lose anything */
+  gst_element_set_state (s.pipeline, GST_STATE_NULL);
+  caller_wait_received (&c, 2000);
+
+  caller_close (&c);
+  sender_teardown (&s);
+
+  srt_cleanup ();
+}
+
+GST_END_TEST;
+
+/* Pushes buffers until @done returns TRUE, paced so that a caller that
+ * reads can keep up. Returns the number of buffers pushed. */
+static guint
+push_until (Sender * s, gboolean (*done) (Sender * s))
+{
+  guint i;
+
+  for (i = 0; i < MAX_BUFFERS; i++) {
+    sender_push (s, i);
+
+    if (i % 50 == 49) {
+      if (done (s))
+        return i + 1;
+      g_usleep (G_TIME_SPAN_MILLISECOND);
+    }
+  }
+
+  fail ("the slow caller was never handled");
+  return i;
+}
+
+static gboolean
+slow_caller_disconnected (Sender * s)
+{
+  return sender_callers_removed (s) > 0;
+}
+
+static gboolean
+slow_caller_dropping (Sender * s)
+{
+  return sender_callers_dropping (s) > 0;
+}
+
+GST_START_TEST (test_slow_caller_disconnect)
+{
+  Sender s;
+  Caller fast, slow;
+  guint n;
+
+  srt_startup ();
+
+  sender_setup (&s, 100, "disconnect");
+  caller_connect (&fast, s.port, TRUE);
+  caller_connect (&slow, s.port, FALSE);
+  sender_wait_callers (&s, 2);
+
+  /* the slow caller gets disconnected, the other one gets everything */
+  n = push_until (&s, slow_caller_disconnected);
+  sender_finish (&s);
+
+  fail_unless_equals_int (sender_callers_removed (&s), 1);
+  caller_wait_received (&fast, n);
+
+  caller_close (&slow);
+  caller_close (&fast);
+  sender_teardown (&s);
+
+  srt_cleanup ();
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_slow_caller_drop_oldest)
+{
+  Sender s;
+  Caller fast, slow;
+  guint n;
+
+  srt_startup ();
+
+  sender_setup (&s, 100, "drop-oldest");
+  caller_connect (&fast, s.port, TRUE);
+  caller_connect (&slow, s.port, FALSE);
+  sender_wait_callers (&s, 2);
+
+  /* the slow caller stays connected and loses buffers, only its own */
+  n = push_until (&s, slow_caller_dropping);
+  fail_unless_equals_int (sender_callers_dropping (&s), 1);
+  fail_unless_equals_int (sender_callers_removed (&s), 0);
+
+  /* EOS gives up on the slow caller after a while */
+  sender_finish (&s);
+  caller_wait_received (&fast, n);
+
+  caller_close (&slow);
+  caller_close (&fast);
+  sender_teardown (&s);
+
+  srt_cleanup ();
+}
+
+GST_END_TEST;
+
+static Suite *
+srtsink_suite (void)
+{
+  Suite *s = suite_create ("srtsink");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_set_timeout (tc_chain, 60);
+  tcase_add_test (tc_chain, test_drain_at_eos);
+  tcase_add_test (tc_chain, test_slow_caller_disconnect);
+  tcase_add_test (tc_chain, test_slow_caller_drop_oldest);
+
+  return s;
+}
+
+GST_CHECK_MAIN (srtsink);
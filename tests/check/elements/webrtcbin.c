@@ -868,6 +868,86 @@ GST_START_TEST (test_audio)
 
 GST_END_TEST;
 
+static guint
+_count_queues (GstBin * bin, guint expected_max_size_bytes)
+{
+  GList *l;
+  guint n = 0;
+
+  GST_OBJECT_LOCK (bin);
+  for (l = GST_BIN_CHILDREN (bin); l; l = l->next) {
+    GstElementFactory *factory = gst_element_get_factory (l->data);
+    guint max_size_bytes;
+
+    if (!factory || g_strcmp0 (GST_OBJECT_NAME (factory), "queue") != 0)
+      continue;
+
+    g_object_get (l->data, "max-size-bytes", &max_size_bytes, NULL);
+    fail_unless_equals_int (max_size_bytes, expected_max_size_bytes);
+    n++;
+  }
+  GST_OBJECT_UNLOCK (bin);
+
+  return n;
+}
+
+/* the transport bins are internal to webrtcbin, look them up by type name */
+static void
+_check_transport_queues (GstElement * webrtc, guint send_queues,
+    guint receive_queue_size)
+{
+  GList *l;
+  guint n_send = 0, n_receive = 0;
+
+  GST_OBJECT_LOCK (webrtc);
+  for (l = GST_BIN_CHILDREN (webrtc); l; l = l->next) {
+    const gchar *type_name = G_OBJECT_TYPE_NAME (l->data);
+
+    if (g_strcmp0 (type_name, "TransportSendBin") == 0) {
+      /* one for RTP and one for RTCP */
+      fail_unless_equals_int (_count_queues (l->data, 5 * 1024 * 1024),
+          send_queues);
+      n_send++;
+    } else if (g_strcmp0 (type_name, "TransportReceiveBin") == 0) {
+      fail_unless_equals_int (_count_queues (l->data, receive_queue_size),
+          2);
+      n_receive++;
+    }
+  }
+  GST_OBJECT_UNLOCK (webrtc);
+
+  fail_unless (n_send > 0);
+  fail_unless_equals_int (n_receive, n_send);
+}
+
+GST_START_TEST (test_audio_transport_threads)
+{
+  struct test_webrtc *t = create_audio_test ();
+  VAL_SDP_INIT (offer, _count_num_sdp_media, GUINT_TO_POINTER (1), NULL);
+  VAL_SDP_INIT (answer, _count_num_sdp_media, GUINT_TO_POINTER (1), NULL);
+  gboolean send_thread;
+  guint queue_size;
+
+  /* transports are only created during negotiation */
+  g_object_set (t->webrtc1, "transport-send-thread", TRUE,
+      "transport-receive-queue-size", 64 * 1024, NULL);
+  g_object_set (t->webrtc2, "transport-send-thread", TRUE, NULL);
+
+  g_object_get (t->webrtc1, "transport-send-thread", &send_thread,
+      "transport-receive-queue-size", &queue_size, NULL);
+  fail_unless (send_thread);
+  fail_unless_equals_int (queue_size, 64 * 1024);
+
+  test_validate_sdp (t, &offer, &answer);
+
+  _check_transport_queues (t->webrtc1, 2, 64 * 1024);
+  _check_transport_queues (t->webrtc2, 2, 5 * 1024 * 1024);
+
+  test_webrtc_free (t);
+}
+
+GST_END_TEST;
+
 static struct test_webrtc *
 create_audio_video_test (void)
 {
@@ -1381,6 +1461,83 @@ GST_START_TEST (test_session_stats)
 
 GST_END_TEST;
 
+static GstStructure *
+get_stats_sync (GstElement * webrtc, GstWebRTCStatsType type)
+{
+  GstPromise *p = gst_promise_new ();
+  GstStructure *stats;
+
+  if (type)
+    g_signal_emit_by_name (webrtc, "get-stats-by-type", type, p);
+  else
+    g_signal_emit_by_name (webrtc, "get-stats", NULL, p);
+
+  fail_unless_equals_int (gst_promise_wait (p), GST_PROMISE_RESULT_REPLIED);
+  stats = gst_structure_copy (gst_promise_get_reply (p));
+  gst_promise_unref (p);
+
+  validate_stats (stats);
+
+  return stats;
+}
+
+static double
+get_peer_connection_stats_timestamp (const GstStructure * stats)
+{
+  const GstStructure *pc;
+  double ts;
+
+  fail_unless (gst_structure_get (stats, "peer-connection-stats",
+          GST_TYPE_STRUCTURE, &pc, NULL));
+  fail_unless (gst_structure_get_double (pc, "timestamp", &ts));
+  gst_structure_free ((GstStructure *) pc);
+
+  return ts;
+}
+
+GST_START_TEST (test_session_stats_cache)
+{
+  struct test_webrtc *t = test_webrtc_new ();
+  GstStructure *stats, *cached;
+  double ts;
+
+  t->on_negotiation_needed = NULL;
+  test_validate_sdp (t, NULL, NULL);
+
+  /* only the requested type is returned */
+  stats = get_stats_sync (t->webrtc1, GST_WEBRTC_STATS_PEER_CONNECTION);
+  fail_unless_equals_int (gst_structure_n_fields (stats), 1);
+  ts = get_peer_connection_stats_timestamp (stats);
+  gst_structure_free (stats);
+
+  stats = get_stats_sync (t->webrtc1, GST_WEBRTC_STATS_CANDIDATE_PAIR);
+  fail_unless_equals_int (gst_structure_n_fields (stats), 0);
+  gst_structure_free (stats);
+
+  /* without a max age, every request refreshes the statistics */
+  g_usleep (2000);
+  stats = get_stats_sync (t->webrtc1, 0);
+  fail_unless (get_peer_connection_stats_timestamp (stats) > ts);
+  ts = get_peer_connection_stats_timestamp (stats);
+  gst_structure_free (stats);
+
+  /* while the snapshot is recent enough it is returned as is */
+  g_object_set (t->webrtc1, "stats-max-age", 60 * 1000, NULL);
+  g_usleep (2000);
+  cached = get_stats_sync (t->webrtc1, 0);
+  fail_unless_equals_float (get_peer_connection_stats_timestamp (cached), ts);
+  gst_structure_free (cached);
+
+  cached = get_stats_sync (t->webrtc1, GST_WEBRTC_STATS_PEER_CONNECTION);
+  fail_unless_equals_int (gst_structure_n_fields (cached), 1);
+  fail_unless_equals_float (get_peer_connection_stats_timestamp (cached), ts);
+  gst_structure_free (cached);
+
+  test_webrtc_free (t);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_add_transceiver)
 {
   struct test_webrtc *t = test_webrtc_new ();
@@ -1885,6 +2042,109 @@ GST_START_TEST (test_data_channel_low_threshold)
 
 GST_END_TEST;
 
+#define BURST_MESSAGES 5000
+
+static struct
+{
+  guint received;
+  gboolean high_emitted;
+  gint64 start_time;
+} burst;
+
+static void
+on_burst_message_string (GObject * channel, const gchar * str,
+    struct test_webrtc *t)
+{
+  gchar *expected = g_strdup_printf ("message %u", burst.received);
+
+  /* messages of a reliable channel arrive complete and in order */
+  g_assert_cmpstr (expected, ==, str);
+  g_free (expected);
+
+  if (++burst.received == BURST_MESSAGES) {
+    gint64 elapsed = g_get_monotonic_time () - burst.start_time;
+
+    GST_INFO ("Received %u messages in %" G_GINT64_FORMAT " us, %.0f msg/s",
+        burst.received, elapsed,
+        (gdouble) burst.received * G_USEC_PER_SEC / MAX (elapsed, 1));
+    test_webrtc_signal_state (t, STATE_CUSTOM);
+  }
+}
+
+static void
+on_buffered_amount_high_emitted (GObject * channel, struct test_webrtc *t)
+{
+  burst.high_emitted = TRUE;
+}
+
+static void
+have_data_channel_send_burst (struct test_webrtc *t, GstElement * element,
+    GObject * our, gpointer user_data)
+{
+  GObject *other = user_data;
+  guint i;
+
+  g_signal_connect (our, "on-message-string",
+      G_CALLBACK (on_burst_message_string), t);
+
+  g_signal_connect (other, "on-error",
+      G_CALLBACK (on_channel_error_not_reached), NULL);
+  g_signal_connect (other, "on-buffered-amount-high",
+      G_CALLBACK (on_buffered_amount_high_emitted), t);
+  g_object_set (other, "buffered-amount-high-threshold", (guint64) 1, NULL);
+
+  burst.start_time = g_get_monotonic_time ();
+  for (i = 0; i < BURST_MESSAGES; i++) {
+    gchar *str = g_strdup_printf ("message %u", i);
+
+    g_signal_emit_by_name (other, "send-string", str);
+    g_free (str);
+  }
+}
+
+/* Sends many small messages back to back over a loopback webrtcbin pair.
+ * Run with GST_DEBUG=check:5 to see the achieved message rate */
+GST_START_TEST (test_data_channel_send_burst)
+{
+  struct test_webrtc *t = test_webrtc_new ();
+  GObject *channel = NULL;
+  VAL_SDP_INIT (offer, on_sdp_has_datachannel, NULL, NULL);
+  VAL_SDP_INIT (answer, on_sdp_has_datachannel, NULL, NULL);
+
+  memset (&burst, 0, sizeof (burst));
+
+  t->on_negotiation_needed = NULL;
+  t->on_ice_candidate = NULL;
+  t->on_data_channel = have_data_channel_send_burst;
+
+  fail_if (gst_element_set_state (t->webrtc1,
+          GST_STATE_READY) == GST_STATE_CHANGE_FAILURE);
+  fail_if (gst_element_set_state (t->webrtc2,
+          GST_STATE_READY) == GST_STATE_CHANGE_FAILURE);
+
+  g_signal_emit_by_name (t->webrtc1, "create-data-channel", "label", NULL,
+      &channel);
+  g_assert_nonnull (channel);
+  t->data_channel_data = channel;
+  g_signal_connect (channel, "on-error",
+      G_CALLBACK (on_channel_error_not_reached), NULL);
+
+  fail_if (gst_element_set_state (t->webrtc1,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+  fail_if (gst_element_set_state (t->webrtc2,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+
+  test_validate_sdp_full (t, &offer, &answer, 1 << STATE_CUSTOM, FALSE);
+
+  fail_unless_equals_int (burst.received, BURST_MESSAGES);
+  fail_unless (burst.high_emitted);
+
+  g_object_unref (channel);
+  test_webrtc_free (t);
+}
+
+GST_END_TEST;
+
 static void
 on_channel_error (GObject * channel, GError * error, struct test_webrtc *t)
 {
@@ -2764,7 +3024,9 @@ webrtcbin_suite (void)
   if (nicesrc && nicesink && dtlssrtpenc && dtlssrtpdec) {
     tcase_add_test (tc, test_sdp_no_media);
     tcase_add_test (tc, test_session_stats);
+    tcase_add_test (tc, test_session_stats_cache);
     tcase_add_test (tc, test_audio);
+    tcase_add_test (tc, test_audio_transport_threads);
     tcase_add_test (tc, test_audio_video);
     tcase_add_test (tc, test_media_direction);
     tcase_add_test (tc, test_media_setup);
@@ -2789,6 +3051,7 @@ webrtcbin_suite (void)
       tcase_add_test (tc, test_data_channel_transfer_data);
       tcase_add_test (tc, test_data_channel_create_after_negotiate);
       tcase_add_test (tc, test_data_channel_low_threshold);
+      tcase_add_test (tc, test_data_channel_send_burst);
       tcase_add_test (tc, test_data_channel_max_message_size);
       tcase_add_test (tc, test_data_channel_pre_negotiated);
       tcase_add_test (tc, test_bundle_audio_video_data);
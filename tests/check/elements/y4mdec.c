@@ -0,0 +1,277 @@
+/* GStreamer unit tests for y4mdec
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/base/gstbytewriter.h>
+#include <string.h>
+
+#define WIDTH 16
+#define HEIGHT 16
+/* I420 */
+#define FRAME_SIZE (WIDTH * HEIGHT * 3 / 2)
+#define N_FRAMES 10
+
+/* 29.97 fps, the frame timestamps are rounded */
+#define FPS_N 30000
+#define FPS_D 1001
+
+#define FRAME_TS(n) gst_util_uint64_scale (n, GST_SECOND * FPS_D, FPS_N)
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC, GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-yuv4mpeg, y4mversion=(int)2"));
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS ("video/x-raw"));
+
+static GstPad *mysrcpad, *mysinkpad;
+static GstBuffer *stream;
+static gboolean have_eos;
+
+/* Byte @i of frame @n */
+#define FRAME_BYTE(n, i) (((n) * 16 + (i)) & 0xff)
+
+static GstBuffer *
+create_stream (void)
+{
+  static const gchar header[] =
+      "YUV4MPEG2 W16 H16 F30000:1001 Ip A1:1 C420\n";
+  GstByteWriter bw;
+  guint n, i;
+
+  gst_byte_writer_init (&bw);
+  gst_byte_writer_put_data (&bw, (const guint8 *) header, strlen (header));
+
+  for (n = 0; n < N_FRAMES; n++) {
+    gst_byte_writer_put_data (&bw, (const guint8 *) "FRAME\n", 6);
+    for (i = 0; i < FRAME_SIZE; i++)
+      gst_byte_writer_put_uint8 (&bw, FRAME_BYTE (n, i));
+  }
+
+  return gst_byte_writer_reset_and_get_buffer (&bw);
+}
+
+static GstFlowReturn
+src_getrange (GstPad * pad, GstObject * parent, guint64 offset, guint length,
+    GstBuffer ** buffer)
+{
+  gsize size = gst_buffer_get_size (stream);
+
+  if (offset >= size)
+    return GST_FLOW_EOS;
+
+  length = MIN (length, size - offset);
+
+  /* y4mdec passes buffers from its pool to be filled */
+  if (*buffer) {
+    GstMapInfo map;
+
+    gst_buffer_set_size (*buffer, length);
+    gst_buffer_map (*buffer, &map, GST_MAP_WRITE);
+    gst_buffer_extract (stream, offset, map.data, length);
+    gst_buffer_unmap (*buffer, &map);
+  } else {
+    *buffer = gst_buffer_copy_region (stream, GST_BUFFER_COPY_ALL, offset,
+        length);
+  }
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstFormat format;
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_DURATION:
+      gst_query_parse_duration (query, &format, NULL);
+      if (format != GST_FORMAT_BYTES)
+        return FALSE;
+      gst_query_set_duration (query, format, gst_buffer_get_size (stream));
+      return TRUE;
+    case GST_QUERY_SCHEDULING:
+      gst_query_set_scheduling (query, GST_SCHEDULING_FLAG_SEEKABLE, 1, -1,
+          0);
+      gst_query_add_scheduling_mode (query, GST_PAD_MODE_PULL);
+      return TRUE;
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+static GstPadProbeReturn
+eos_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  if (GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) == GST_EVENT_EOS) {
+    g_mutex_lock (&check_mutex);
+    have_eos = TRUE;
+    g_cond_broadcast (&check_cond);
+    g_mutex_unlock (&check_mutex);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+wait_eos (void)
+{
+  g_mutex_lock (&check_mutex);
+  while (!have_eos)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+}
+
+static GstElement *
+setup_pull (void)
+{
+  GstElement *y4mdec;
+
+  stream = create_stream ();
+  have_eos = FALSE;
+
+  y4mdec = gst_check_setup_element ("y4mdec");
+  mysrcpad = gst_check_setup_src_pad (y4mdec, &src_template);
+  gst_pad_set_getrange_function (mysrcpad, src_getrange);
+  gst_pad_set_query_function (mysrcpad, src_query);
+  mysinkpad = gst_check_setup_sink_pad (y4mdec, &sink_template);
+  gst_pad_add_probe (mysinkpad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      eos_probe, NULL, NULL);
+  gst_pad_set_active (mysinkpad, TRUE);
+  gst_pad_set_active (mysrcpad, TRUE);
+
+  fail_unless_equals_int (gst_element_set_state (y4mdec, GST_STATE_PAUSED),
+      GST_STATE_CHANGE_SUCCESS);
+
+  return y4mdec;
+}
+
+static void
+teardown_pull (GstElement * y4mdec)
+{
+  gst_element_set_state (y4mdec, GST_STATE_NULL);
+  gst_check_drop_buffers ();
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (y4mdec);
+  gst_check_teardown_sink_pad (y4mdec);
+  gst_check_teardown_element (y4mdec);
+  gst_buffer_unref (stream);
+  stream = NULL;
+}
+
+/* Checks that the received buffers are frames @first to @last */
+static void
+check_frames (guint first, guint last)
+{
+  GList *l;
+  guint n;
+
+  fail_unless_equals_int (g_list_length (buffers), last - first + 1);
+
+  for (l = buffers, n = first; l; l = l->next, n++) {
+    GstBuffer *buffer = l->data;
+    GstMapInfo map;
+    guint i;
+
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), FRAME_TS (n));
+    fail_unless_equals_uint64 (GST_BUFFER_DURATION (buffer),
+        FRAME_TS (n + 1) - FRAME_TS (n));
+
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    fail_unless_equals_int (map.size, FRAME_SIZE);
+    for (i = 0; i < FRAME_SIZE; i++) {
+      if (map.data[i] != FRAME_BYTE (n, i))
+        fail ("frame %u differs at byte %u", n, i);
+    }
+    gst_buffer_unmap (buffer, &map);
+  }
+}
+
+static void
+seek_and_wait (GstElement * y4mdec, GstClockTime start, GstClockTime stop)
+{
+  gst_check_drop_buffers ();
+  g_mutex_lock (&check_mutex);
+  have_eos = FALSE;
+  g_mutex_unlock (&check_mutex);
+
+  fail_unless (gst_element_seek (y4mdec, 1.0, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE, GST_SEEK_TYPE_SET,
+          start, stop == GST_CLOCK_TIME_NONE ? GST_SEEK_TYPE_NONE :
+          GST_SEEK_TYPE_SET, stop));
+
+  wait_eos ();
+}
+
+GST_START_TEST (test_pull)
+{
+  GstElement *y4mdec = setup_pull ();
+
+  wait_eos ();
+  check_frames (0, N_FRAMES - 1);
+
+  teardown_pull (y4mdec);
+}
+
+GST_END_TEST;
+
+/* Seeks start on the frame shown at the seek position, also when that is
+ * the rounded timestamp of the frame itself */
+GST_START_TEST (test_pull_seek)
+{
+  GstElement *y4mdec = setup_pull ();
+
+  wait_eos ();
+
+  seek_and_wait (y4mdec, FRAME_TS (7), GST_CLOCK_TIME_NONE);
+  check_frames (7, N_FRAMES - 1);
+
+  seek_and_wait (y4mdec, FRAME_TS (3) + 1, GST_CLOCK_TIME_NONE);
+  check_frames (3, N_FRAMES - 1);
+
+  seek_and_wait (y4mdec, FRAME_TS (4) - 1, GST_CLOCK_TIME_NONE);
+  check_frames (3, N_FRAMES - 1);
+
+  /* the frame at the stop position is not output */
+  seek_and_wait (y4mdec, FRAME_TS (2), FRAME_TS (5));
+  check_frames (2, 4);
+
+  teardown_pull (y4mdec);
+}
+
+GST_END_TEST;
+
+static Suite *
+y4mdec_suite (void)
+{
+  Suite *s = suite_create ("y4mdec");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_pull);
+  tcase_add_test (tc_chain, test_pull_seek);
+
+  return s;
+}
+
+GST_CHECK_MAIN (y4mdec);
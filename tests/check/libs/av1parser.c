@@ -259,6 +259,14 @@ GST_START_TEST (test_av1_parse_aom_testdata_av1_1_b8_01_size_16x16)
   assert_equals_int (frame.frame_header.tx_mode_select, 0);
   assert_equals_int (frame.frame_header.reduced_tx_set, 0);
 
+  /* the only tile takes the rest of the OBU after the frame header */
+  assert_equals_int (frame.tile_group.num_tiles, 1);
+  assert_equals_int (frame.tile_group.tg_start, 0);
+  assert_equals_int (frame.tile_group.tg_end, 0);
+  fail_unless (frame.tile_group.entry[0].tile_offset > 0);
+  assert_equals_int (frame.tile_group.entry[0].tile_offset +
+      frame.tile_group.entry[0].tile_size, obu.obu_size);
+
   /* 4th OBU should be OBU_TEMPORAL_DELIMITER */
   ret = gst_av1_parser_identify_one_obu (parser, data_ptr, data_sz,
       &obu, &consumed);
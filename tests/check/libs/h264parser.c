@@ -655,6 +655,72 @@ GST_START_TEST (test_h264_create_sei)
 
 GST_END_TEST;
 
+/* SPS with 6 bits frame_num and pic_order_cnt_type 2, PPS, IDR I slice */
+static guint8 h264_idr_picture[] = {
+  0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0xc0, 0x1e, 0xb6, 0x89, 0x64,
+  0x00, 0x00, 0x00, 0x01, 0x68, 0xce, 0x3c, 0x80,
+  0x00, 0x00, 0x00, 0x01, 0x65, 0x88, 0x80, 0x60, 0xea, 0x95, 0x6a
+};
+
+GST_START_TEST (test_h264_nal_parser_copy)
+{
+  GstH264ParserResult res;
+  GstH264NalUnit nalu;
+  GstH264NalParser *parser, *copy;
+  GstH264SliceHdr slice;
+  GstH264SPS sps;
+  GstH264PPS pps;
+  guint offset = 0;
+  gsize size = sizeof (h264_idr_picture);
+
+  parser = gst_h264_nal_parser_new ();
+
+  res = gst_h264_parser_identify_nalu (parser, h264_idr_picture, offset,
+      size, &nalu);
+  assert_equals_int (res, GST_H264_PARSER_OK);
+  assert_equals_int (nalu.type, GST_H264_NAL_SPS);
+  offset = nalu.offset + nalu.size;
+  res = gst_h264_parser_parse_sps (parser, &nalu, &sps);
+  assert_equals_int (res, GST_H264_PARSER_OK);
+
+  res = gst_h264_parser_identify_nalu (parser, h264_idr_picture, offset,
+      size, &nalu);
+  assert_equals_int (res, GST_H264_PARSER_OK);
+  assert_equals_int (nalu.type, GST_H264_NAL_PPS);
+  offset = nalu.offset + nalu.size;
+  res = gst_h264_parser_parse_pps (parser, &nalu, &pps);
+  assert_equals_int (res, GST_H264_PARSER_OK);
+
+  copy = gst_h264_nal_parser_copy (parser);
+  gst_h264_nal_parser_free (parser);
+
+  /* the slice header can only be parsed with the SPS and PPS of the copy */
+  res = gst_h264_parser_identify_nalu (copy, h264_idr_picture, offset,
+      size, &nalu);
+  assert_equals_int (res, GST_H264_PARSER_NO_NAL_END);
+  assert_equals_int (nalu.type, GST_H264_NAL_SLICE_IDR);
+  res = gst_h264_parser_parse_slice_hdr (copy, &nalu, &slice, FALSE, FALSE);
+  assert_equals_int (res, GST_H264_PARSER_OK);
+
+  fail_unless (slice.pps == &copy->pps[0]);
+  fail_unless (slice.pps->sequence == &copy->sps[0]);
+  fail_unless (copy->last_pps == &copy->pps[0]);
+  fail_unless (GST_H264_IS_I_SLICE (&slice));
+  assert_equals_int (slice.first_mb_in_slice, 0);
+  assert_equals_int (slice.frame_num, 0);
+  assert_equals_int (slice.idr_pic_id, 5);
+  assert_equals_int (slice.slice_qp_delta, -3);
+  assert_equals_int (slice.disable_deblocking_filter_idc, 1);
+  assert_equals_int (slice.pps->sequence->width, 32);
+  assert_equals_int (slice.pps->sequence->height, 32);
+
+  gst_h264_sps_clear (&sps);
+  gst_h264_pps_clear (&pps);
+  gst_h264_nal_parser_free (copy);
+}
+
+GST_END_TEST;
+
 static Suite *
 h264parser_suite (void)
 {
@@ -668,6 +734,7 @@ h264parser_suite (void)
   tcase_add_test (tc_chain, test_h264_parse_slice_5bytes);
   tcase_add_test (tc_chain, test_h264_parse_invalid_sei);
   tcase_add_test (tc_chain, test_h264_create_sei);
+  tcase_add_test (tc_chain, test_h264_nal_parser_copy);
 
   return s;
 }
@@ -746,6 +746,56 @@ GST_START_TEST (test_h265_parse_scc)
 
 GST_END_TEST;
 
+GST_START_TEST (test_h265_parser_copy)
+{
+  GstH265Parser *parser, *copy;
+  GstH265NalUnit nalu;
+  GstH265ParserResult res;
+  GstH265VPS vps;
+  GstH265PPS pps;
+  GstH265SPS sps;
+  guint offset = 0;
+  gsize size = sizeof (h265_with_scc_extension);
+
+  parser = gst_h265_parser_new ();
+
+  res = gst_h265_parser_identify_nalu_unchecked (parser,
+      h265_with_scc_extension, offset, size, &nalu);
+  assert_equals_int (res, GST_H265_PARSER_OK);
+  offset = nalu.offset;
+  res = gst_h265_parser_parse_vps (parser, &nalu, &vps);
+  assert_equals_int (res, GST_H265_PARSER_OK);
+
+  res = gst_h265_parser_identify_nalu_unchecked (parser,
+      h265_with_scc_extension, offset, size, &nalu);
+  assert_equals_int (res, GST_H265_PARSER_OK);
+  offset = nalu.offset;
+  res = gst_h265_parser_parse_sps (parser, &nalu, &sps, FALSE);
+  assert_equals_int (res, GST_H265_PARSER_OK);
+
+  res = gst_h265_parser_identify_nalu_unchecked (parser,
+      h265_with_scc_extension, offset, size, &nalu);
+  assert_equals_int (res, GST_H265_PARSER_OK);
+  res = gst_h265_parser_parse_pps (parser, &nalu, &pps);
+  assert_equals_int (res, GST_H265_PARSER_OK);
+
+  copy = gst_h265_parser_copy (parser);
+  gst_h265_parser_free (parser);
+
+  /* the parameter sets of the copy only refer to each other */
+  fail_unless (copy->vps[vps.id].valid);
+  fail_unless (copy->sps[sps.id].valid);
+  fail_unless (copy->pps[pps.id].valid);
+  fail_unless (copy->sps[sps.id].vps == &copy->vps[vps.id]);
+  fail_unless (copy->pps[pps.id].sps == &copy->sps[sps.id]);
+  fail_unless (copy->last_pps == &copy->pps[pps.id]);
+  assert_equals_int (copy->pps[pps.id].pps_scc_extension_flag, 1);
+
+  gst_h265_parser_free (copy);
+}
+
+GST_END_TEST;
+
 typedef struct
 {
   GstH265NalUnitType type;
@@ -1108,6 +1158,7 @@ h265parser_suite (void)
   tcase_add_test (tc_chain, test_h265_parse_vps);
   tcase_add_test (tc_chain, test_h265_parse_pps);
   tcase_add_test (tc_chain, test_h265_parse_scc);
+  tcase_add_test (tc_chain, test_h265_parser_copy);
   tcase_add_test (tc_chain, test_h265_nal_type_classification);
   tcase_add_test (tc_chain, test_h265_sei_registered_user_data);
   tcase_add_test (tc_chain, test_h265_create_sei);
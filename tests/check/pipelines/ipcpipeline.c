@@ -29,6 +29,7 @@
 #define _GNU_SOURCE             /* See feature_test_macros(7) */
 #include <unistd.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <fcntl.h>
 #include <sys/wait.h>
 #include <sys/file.h>
@@ -5804,6 +5805,114 @@ GST_START_TEST (test_wavparse_master_process_crash)
 
 GST_END_TEST;
 
+/**** pipelined buffers throughput test ****/
+
+/* This one does not use test_base: both pipelines live in this process, the
+ * point is to compare how many buffers per second go through ipcpipelinesink
+ * when it waits for each flow return and when it has several in flight. */
+
+#define THROUGHPUT_NUM_BUFFERS 5000
+#define THROUGHPUT_BUFFER_SIZE 1024
+
+static GstPadProbeReturn
+throughput_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  guint *received = user_data;
+
+  ++*received;
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+run_throughput (guint max_buffers_in_flight, guint * received,
+    gint64 * elapsed, guint * version)
+{
+  GstElement *master, *fakesrc, *ipcpipelinesink;
+  GstElement *slave, *ipcpipelinesrc, *fakesink;
+  GstStateChangeReturn ret;
+  GstMessage *msg;
+  GstPad *pad;
+  int fwd[2], bwd[2];
+  gint64 start;
+
+  FAIL_IF (pipe2 (fwd, O_NONBLOCK) < 0);
+  FAIL_IF (pipe2 (bwd, O_NONBLOCK) < 0);
+
+  slave = gst_element_factory_make ("ipcslavepipeline", NULL);
+  ipcpipelinesrc = gst_element_factory_make ("ipcpipelinesrc", NULL);
+  g_object_set (ipcpipelinesrc, "fdin", fwd[0], "fdout", bwd[1], NULL);
+  fakesink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (fakesink, "sync", FALSE, NULL);
+  gst_bin_add_many (GST_BIN (slave), ipcpipelinesrc, fakesink, NULL);
+  FAIL_UNLESS (gst_element_link (ipcpipelinesrc, fakesink));
+  pad = gst_element_get_static_pad (fakesink, "sink");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER, throughput_probe,
+      received, NULL);
+  gst_object_unref (pad);
+
+  master = gst_pipeline_new (NULL);
+  fakesrc = gst_element_factory_make ("fakesrc", NULL);
+  gst_util_set_object_arg (G_OBJECT (fakesrc), "sizetype", "fixed");
+  g_object_set (fakesrc, "num-buffers", THROUGHPUT_NUM_BUFFERS, "sizemax",
+      THROUGHPUT_BUFFER_SIZE, NULL);
+  ipcpipelinesink = gst_element_factory_make ("ipcpipelinesink", NULL);
+  g_object_set (ipcpipelinesink, "fdin", bwd[0], "fdout", fwd[1],
+      "max-buffers-in-flight", max_buffers_in_flight, NULL);
+  gst_bin_add_many (GST_BIN (master), fakesrc, ipcpipelinesink, NULL);
+  FAIL_UNLESS (gst_element_link (fakesrc, ipcpipelinesink));
+
+  start = g_get_monotonic_time ();
+  ret = gst_element_set_state (master, GST_STATE_PLAYING);
+  FAIL_IF (ret == GST_STATE_CHANGE_FAILURE);
+
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (master), 60 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  FAIL_UNLESS (msg);
+  FAIL_UNLESS_EQUALS_INT (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  *elapsed = g_get_monotonic_time () - start;
+
+  g_object_get (ipcpipelinesink, "protocol-version", version, NULL);
+
+  ret = gst_element_set_state (master, GST_STATE_NULL);
+  FAIL_UNLESS (ret == GST_STATE_CHANGE_SUCCESS);
+  ret = gst_element_set_state (slave, GST_STATE_NULL);
+  FAIL_UNLESS (ret == GST_STATE_CHANGE_SUCCESS);
+  gst_object_unref (master);
+  gst_object_unref (slave);
+
+  close (fwd[0]);
+  close (fwd[1]);
+  close (bwd[0]);
+  close (bwd[1]);
+}
+
+GST_START_TEST (test_pipelined_buffers_throughput)
+{
+  guint received_sync = 0, received_pipelined = 0;
+  gint64 elapsed_sync = 0, elapsed_pipelined = 0;
+  guint version_sync, version_pipelined;
+
+  run_throughput (1, &received_sync, &elapsed_sync, &version_sync);
+  run_throughput (64, &received_pipelined, &elapsed_pipelined,
+      &version_pipelined);
+
+  GST_INFO ("%u buffers of %u bytes: %" G_GINT64_FORMAT " us synchronous, %"
+      G_GINT64_FORMAT " us with 64 buffers in flight\n",
+      THROUGHPUT_NUM_BUFFERS, THROUGHPUT_BUFFER_SIZE, elapsed_sync,
+      elapsed_pipelined);
+
+  /* the synchronous run does not even ask for pipelining */
+  FAIL_UNLESS_EQUALS_INT (version_sync, 1);
+  FAIL_UNLESS_EQUALS_INT (version_pipelined, 2);
+
+  /* every buffer must make it through, whatever the ack scheme */
+  FAIL_UNLESS_EQUALS_INT (received_sync, THROUGHPUT_NUM_BUFFERS);
+  FAIL_UNLESS_EQUALS_INT (received_pipelined, THROUGHPUT_NUM_BUFFERS);
+}
+
+GST_END_TEST;
+
 static Suite *
 ipcpipeline_suite (void)
 {
@@ -6061,6 +6170,10 @@ ipcpipeline_suite (void)
      with the master pipeline. */
   tcase_add_test (tc_chain, test_wavparse_master_process_crash);
 
+  /* pipelined_buffers tests check that buffers sent without waiting for
+     each flow return all arrive, and report the throughput gain. */
+  tcase_add_test (tc_chain, test_pipelined_buffers_throughput);
+
   return s;
 }
 
@@ -0,0 +1,326 @@
+/* GStreamer AV1 tile group parser test utility
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Locates the tiles of an AV1 file in the low overhead bitstream format
+ * and prints the time it took in two ways:
+ *
+ * The per-OBU way parses every OBU in turn with the same parser.
+ *
+ * The tile group way collects the tile group OBUs of every frame, parses
+ * all but the last one concurrently with a thread pool and the same parser,
+ * then parses the last one, which ends the frame.
+ *
+ * Both ways must find the same frames and tiles. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+#include <gst/codecparsers/gstav1parser.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+  guint n_obus;
+  guint n_frames;
+  guint n_tile_groups;
+  guint n_tiles;
+  guint64 tile_bytes;
+  guint n_errors;
+} Stats;
+
+typedef struct
+{
+  GstAV1OBU obu;
+  GstAV1TileGroupOBU tile_group;
+  GstAV1ParserResult res;
+} TileGroupJob;
+
+typedef struct
+{
+  GstAV1Parser *parser;
+  /* NULL for the per-OBU way */
+  GThreadPool *pool;
+
+  /* the tile group OBUs of the current frame, the jobs are reused */
+  GPtrArray *jobs;
+  guint n_jobs;
+
+  GMutex lock;
+  GCond cond;
+  guint n_pending;
+
+  Stats stats;
+} Context;
+
+/* Counts the tiles of @tile_group and updates the references if it is the
+ * last tile group of the frame of @frame_header */
+static void
+tile_group_done (Context * ctx, GstAV1TileGroupOBU * tile_group,
+    GstAV1FrameHeaderOBU * frame_header)
+{
+  guint i;
+
+  ctx->stats.n_tile_groups++;
+  for (i = tile_group->tg_start; i <= tile_group->tg_end; i++) {
+    ctx->stats.n_tiles++;
+    ctx->stats.tile_bytes += tile_group->entry[i].tile_size;
+  }
+
+  if (tile_group->tg_end != tile_group->num_tiles - 1)
+    return;
+
+  ctx->stats.n_frames++;
+  if (gst_av1_parser_reference_frame_update (ctx->parser,
+          frame_header) != GST_AV1_PARSER_OK)
+    ctx->stats.n_errors++;
+}
+
+static void
+parse_tile_group_func (TileGroupJob * job, Context * ctx)
+{
+  job->res = gst_av1_parser_parse_tile_group_obu (ctx->parser, &job->obu,
+      &job->tile_group);
+
+  g_mutex_lock (&ctx->lock);
+  if (--ctx->n_pending == 0)
+    g_cond_signal (&ctx->cond);
+  g_mutex_unlock (&ctx->lock);
+}
+
+static void
+queue_tile_group (Context * ctx, GstAV1OBU * obu)
+{
+  TileGroupJob *job;
+
+  if (ctx->n_jobs == ctx->jobs->len)
+    g_ptr_array_add (ctx->jobs, g_new0 (TileGroupJob, 1));
+
+  job = g_ptr_array_index (ctx->jobs, ctx->n_jobs);
+  job->obu = *obu;
+  ctx->n_jobs++;
+}
+
+/* Parses all the queued tile groups but the last one in the pool, then the
+ * last one once the others are done */
+static void
+flush_tile_groups (Context * ctx, GstAV1FrameHeaderOBU * frame_header)
+{
+  TileGroupJob *job;
+  guint i;
+
+  if (ctx->n_jobs == 0)
+    return;
+
+  ctx->n_pending = ctx->n_jobs - 1;
+  for (i = 0; i < ctx->n_jobs - 1; i++)
+    g_thread_pool_push (ctx->pool, g_ptr_array_index (ctx->jobs, i), NULL);
+
+  g_mutex_lock (&ctx->lock);
+  while (ctx->n_pending > 0)
+    g_cond_wait (&ctx->cond, &ctx->lock);
+  g_mutex_unlock (&ctx->lock);
+
+  job = g_ptr_array_index (ctx->jobs, ctx->n_jobs - 1);
+  job->res = gst_av1_parser_parse_tile_group_obu (ctx->parser, &job->obu,
+      &job->tile_group);
+
+  for (i = 0; i < ctx->n_jobs; i++) {
+    job = g_ptr_array_index (ctx->jobs, i);
+    if (job->res == GST_AV1_PARSER_OK)
+      tile_group_done (ctx, &job->tile_group, frame_header);
+    else
+      ctx->stats.n_errors++;
+  }
+
+  ctx->n_jobs = 0;
+}
+
+static void
+parse_obus (Context * ctx, const guint8 * data, gsize size)
+{
+  GstAV1OBU obu;
+  GstAV1SequenceHeaderOBU seq_header;
+  GstAV1FrameHeaderOBU frame_header;
+  GstAV1FrameOBU frame;
+  GstAV1ParserResult res;
+  guint32 consumed;
+  gsize offset = 0;
+
+  memset (&frame_header, 0, sizeof (frame_header));
+
+  while (offset < size) {
+    res = gst_av1_parser_identify_one_obu (ctx->parser, data + offset,
+        MIN (size - offset, G_MAXUINT32), &obu, &consumed);
+    if (res == GST_AV1_PARSER_DROP) {
+      offset += consumed;
+      continue;
+    }
+    if (res != GST_AV1_PARSER_OK) {
+      ctx->stats.n_errors++;
+      break;
+    }
+
+    offset += consumed;
+    ctx->stats.n_obus++;
+
+    /* the tile group OBUs of a frame follow each other */
+    if (ctx->pool && obu.obu_type != GST_AV1_OBU_TILE_GROUP)
+      flush_tile_groups (ctx, &frame_header);
+
+    switch (obu.obu_type) {
+      case GST_AV1_OBU_SEQUENCE_HEADER:
+        res = gst_av1_parser_parse_sequence_header_obu (ctx->parser, &obu,
+            &seq_header);
+        break;
+      case GST_AV1_OBU_TEMPORAL_DELIMITER:
+        res = gst_av1_parser_parse_temporal_delimiter_obu (ctx->parser, &obu);
+        break;
+      case GST_AV1_OBU_FRAME_HEADER:
+        res = gst_av1_parser_parse_frame_header_obu (ctx->parser, &obu,
+            &frame_header);
+        if (res != GST_AV1_PARSER_OK || !frame_header.show_existing_frame)
+          break;
+
+        /* a key frame shown again refreshes all the references */
+        ctx->stats.n_frames++;
+        res = gst_av1_parser_reference_frame_loading (ctx->parser,
+            &frame_header);
+        if (res == GST_AV1_PARSER_OK)
+          res = gst_av1_parser_reference_frame_update (ctx->parser,
+              &frame_header);
+        break;
+      case GST_AV1_OBU_FRAME:
+        res = gst_av1_parser_parse_frame_obu (ctx->parser, &obu, &frame);
+        if (res == GST_AV1_PARSER_OK)
+          tile_group_done (ctx, &frame.tile_group, &frame.frame_header);
+        break;
+      case GST_AV1_OBU_TILE_GROUP:
+        if (ctx->pool) {
+          queue_tile_group (ctx, &obu);
+          break;
+        }
+
+        res = gst_av1_parser_parse_tile_group_obu (ctx->parser, &obu,
+            &frame.tile_group);
+        if (res == GST_AV1_PARSER_OK)
+          tile_group_done (ctx, &frame.tile_group, &frame_header);
+        break;
+      default:
+        break;
+    }
+
+    if (res != GST_AV1_PARSER_OK)
+      ctx->stats.n_errors++;
+  }
+
+  if (ctx->pool)
+    flush_tile_groups (ctx, &frame_header);
+}
+
+/* Parses the whole file @repeat times with a new parser each time, and
+ * returns the time it took in microseconds */
+static gint64
+run (Context * ctx, const guint8 * data, gsize size, guint repeat)
+{
+  gint64 start;
+  guint i;
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < repeat; i++) {
+    memset (&ctx->stats, 0, sizeof (ctx->stats));
+    ctx->parser = gst_av1_parser_new ();
+    parse_obus (ctx, data, size);
+    gst_av1_parser_free (ctx->parser);
+    ctx->parser = NULL;
+  }
+
+  return g_get_monotonic_time () - start;
+}
+
+static void
+print_stats (const gchar * name, Stats * stats, gint64 time, guint repeat)
+{
+  g_print ("%s: %u OBUs, %u frames, %u tile groups, %u tiles, %"
+      G_GUINT64_FORMAT " tile bytes, %u errors, %" G_GINT64_FORMAT
+      " us per run\n", name, stats->n_obus, stats->n_frames,
+      stats->n_tile_groups, stats->n_tiles, stats->tile_bytes,
+      stats->n_errors, time / repeat);
+}
+
+int
+main (int argc, gchar ** argv)
+{
+  GMappedFile *file;
+  GError *err = NULL;
+  Context per_obu = { 0, };
+  Context tile_groups = { 0, };
+  const guint8 *data;
+  gsize size;
+  guint n_threads, repeat;
+  gint64 per_obu_time, tile_groups_time;
+
+  if (argc < 2) {
+    g_printerr ("Usage: %s FILE.obu [N-THREADS] [REPEAT]\n", argv[0]);
+    return -1;
+  }
+
+  gst_init (&argc, &argv);
+
+  n_threads = argc > 2 ? atoi (argv[2]) : g_get_num_processors ();
+  n_threads = MAX (n_threads, 1);
+  repeat = argc > 3 ? atoi (argv[3]) : 10;
+  repeat = MAX (repeat, 1);
+
+  file = g_mapped_file_new (argv[1], FALSE, &err);
+  if (file == NULL) {
+    g_printerr ("Could not read file %s: %s\n", argv[1], err->message);
+    g_clear_error (&err);
+    return -1;
+  }
+  data = (const guint8 *) g_mapped_file_get_contents (file);
+  size = g_mapped_file_get_length (file);
+
+  per_obu_time = run (&per_obu, data, size, repeat);
+
+  g_mutex_init (&tile_groups.lock);
+  g_cond_init (&tile_groups.cond);
+  tile_groups.jobs = g_ptr_array_new_with_free_func (g_free);
+  tile_groups.pool = g_thread_pool_new ((GFunc) parse_tile_group_func,
+      &tile_groups, n_threads, TRUE, NULL);
+
+  tile_groups_time = run (&tile_groups, data, size, repeat);
+
+  print_stats ("per OBU", &per_obu.stats, per_obu_time, repeat);
+  print_stats ("tile groups", &tile_groups.stats, tile_groups_time, repeat);
+  g_print ("%u threads, %u runs\n", n_threads, repeat);
+
+  if (memcmp (&per_obu.stats, &tile_groups.stats, sizeof (Stats)) != 0)
+    g_printerr ("The tile groups were not parsed the same in both ways\n");
+
+  g_thread_pool_free (tile_groups.pool, FALSE, TRUE);
+  g_ptr_array_free (tile_groups.jobs, TRUE);
+  g_cond_clear (&tile_groups.cond);
+  g_mutex_clear (&tile_groups.lock);
+  g_mapped_file_unref (file);
+
+  return 0;
+}
@@ -0,0 +1,235 @@
+/* GStreamer H.264 parallel parser test utility
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Parses the slice headers of an H.264 byte-stream file with several
+ * threads and prints the picture statistics of the whole file.
+ *
+ * A first pass only looks for start codes and parses the parameter sets.
+ * It splits the file into segments starting at IDR pictures and takes a
+ * copy of the parser at the start of every segment, so that each segment
+ * can then be parsed on its own with the parameter sets that were active
+ * there. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+#include <gst/codecparsers/gsth264parser.h>
+
+#include <stdlib.h>
+
+typedef struct
+{
+  const guint8 *data;
+  gsize start;
+  gsize end;
+  GstH264NalParser *parser;
+
+  guint n_nals;
+  guint n_slices;
+  guint n_pictures;
+  guint n_idr;
+  guint n_i, n_p, n_b;
+  guint n_errors;
+} Segment;
+
+static GstH264ParserResult
+next_nal (GstH264NalParser * parser, const guint8 * data, gsize offset,
+    gsize size, GstH264NalUnit * nalu)
+{
+  GstH264ParserResult res;
+
+  res = gst_h264_parser_identify_nalu (parser, data, offset, size, nalu);
+
+  /* the last NAL unit runs until the end of the data */
+  if (res == GST_H264_PARSER_NO_NAL_END)
+    res = GST_H264_PARSER_OK;
+
+  return res;
+}
+
+static gpointer
+parse_segment (Segment * seg)
+{
+  GstH264NalUnit nalu;
+  GstH264SliceHdr slice;
+  gsize offset = seg->start;
+
+  while (next_nal (seg->parser, seg->data, offset, seg->end,
+          &nalu) == GST_H264_PARSER_OK) {
+    offset = nalu.offset + nalu.size;
+    seg->n_nals++;
+
+    switch (nalu.type) {
+      case GST_H264_NAL_SLICE:
+      case GST_H264_NAL_SLICE_IDR:
+        if (gst_h264_parser_parse_slice_hdr (seg->parser, &nalu, &slice,
+                FALSE, FALSE) != GST_H264_PARSER_OK) {
+          seg->n_errors++;
+          break;
+        }
+
+        seg->n_slices++;
+        if (slice.first_mb_in_slice != 0)
+          break;
+
+        seg->n_pictures++;
+        if (nalu.idr_pic_flag)
+          seg->n_idr++;
+        if (GST_H264_IS_I_SLICE (&slice) || GST_H264_IS_SI_SLICE (&slice))
+          seg->n_i++;
+        else if (GST_H264_IS_B_SLICE (&slice))
+          seg->n_b++;
+        else
+          seg->n_p++;
+        break;
+      case GST_H264_NAL_SPS:
+      case GST_H264_NAL_PPS:
+        if (gst_h264_parser_parse_nal (seg->parser, &nalu) !=
+            GST_H264_PARSER_OK)
+          seg->n_errors++;
+        break;
+      default:
+        break;
+    }
+  }
+
+  return NULL;
+}
+
+/* Only parses the parameter sets, and starts a new segment with a copy of
+ * the parser at the first IDR picture after every @segment_size bytes */
+static GArray *
+split_segments (const guint8 * data, gsize size, gsize segment_size)
+{
+  GstH264NalParser *parser = gst_h264_nal_parser_new ();
+  GArray *segments = g_array_new (FALSE, TRUE, sizeof (Segment));
+  GstH264NalUnit nalu;
+  Segment seg = { 0, };
+  gsize offset = 0;
+
+  seg.data = data;
+  seg.parser = gst_h264_nal_parser_copy (parser);
+
+  while (next_nal (parser, data, offset, size, &nalu) == GST_H264_PARSER_OK) {
+    offset = nalu.offset + nalu.size;
+
+    if (nalu.type == GST_H264_NAL_SPS || nalu.type == GST_H264_NAL_PPS) {
+      gst_h264_parser_parse_nal (parser, &nalu);
+    } else if (nalu.type == GST_H264_NAL_SLICE_IDR &&
+        nalu.sc_offset >= seg.start + segment_size &&
+        nalu.size > nalu.header_bytes &&
+        (nalu.data[nalu.offset + nalu.header_bytes] & 0x80)) {
+      /* first_mb_in_slice is 0, the picture starts here */
+      seg.end = nalu.sc_offset;
+      g_array_append_val (segments, seg);
+
+      seg.start = nalu.sc_offset;
+      seg.parser = gst_h264_nal_parser_copy (parser);
+    }
+  }
+
+  seg.end = size;
+  g_array_append_val (segments, seg);
+
+  gst_h264_nal_parser_free (parser);
+
+  return segments;
+}
+
+int
+main (int argc, gchar ** argv)
+{
+  GMappedFile *file;
+  GError *err = NULL;
+  GArray *segments;
+  GThread **threads;
+  Segment total = { 0, };
+  const guint8 *data;
+  gsize size;
+  guint n_threads, i;
+  gint64 start, split, end;
+
+  if (argc < 2) {
+    g_printerr ("Usage: %s FILE.h264 [N-THREADS]\n", argv[0]);
+    return -1;
+  }
+
+  gst_init (&argc, &argv);
+
+  n_threads = argc > 2 ? atoi (argv[2]) : g_get_num_processors ();
+  n_threads = MAX (n_threads, 1);
+
+  file = g_mapped_file_new (argv[1], FALSE, &err);
+  if (file == NULL) {
+    g_printerr ("Could not read file %s: %s\n", argv[1], err->message);
+    g_clear_error (&err);
+    return -1;
+  }
+  data = (const guint8 *) g_mapped_file_get_contents (file);
+  size = g_mapped_file_get_length (file);
+
+  start = g_get_monotonic_time ();
+  segments = split_segments (data, size, size / n_threads);
+  split = g_get_monotonic_time ();
+
+  /* One thread per segment, there are about as many as threads asked for,
+   * and fewer if there are not enough IDR pictures */
+  threads = g_new0 (GThread *, segments->len);
+  for (i = 0; i < segments->len; i++) {
+    threads[i] = g_thread_new ("h264-segment",
+        (GThreadFunc) parse_segment, &g_array_index (segments, Segment, i));
+  }
+  for (i = 0; i < segments->len; i++)
+    g_thread_join (threads[i]);
+  end = g_get_monotonic_time ();
+
+  for (i = 0; i < segments->len; i++) {
+    Segment *seg = &g_array_index (segments, Segment, i);
+
+    g_print ("segment %u: bytes %" G_GSIZE_FORMAT "-%" G_GSIZE_FORMAT
+        ", %u pictures (%u IDR), %u slices, %u errors\n", i, seg->start,
+        seg->end, seg->n_pictures, seg->n_idr, seg->n_slices, seg->n_errors);
+
+    total.n_nals += seg->n_nals;
+    total.n_slices += seg->n_slices;
+    total.n_pictures += seg->n_pictures;
+    total.n_idr += seg->n_idr;
+    total.n_i += seg->n_i;
+    total.n_p += seg->n_p;
+    total.n_b += seg->n_b;
+    total.n_errors += seg->n_errors;
+
+    gst_h264_nal_parser_free (seg->parser);
+  }
+
+  g_print ("\n%u NAL units, %u slices, %u errors\n", total.n_nals,
+      total.n_slices, total.n_errors);
+  g_print ("%u pictures: %u IDR, %u I, %u P, %u B\n", total.n_pictures,
+      total.n_idr, total.n_i, total.n_p, total.n_b);
+  g_print ("split in %u segments in %" G_GINT64_FORMAT " ms, parsed in %"
+      G_GINT64_FORMAT " ms\n", segments->len, (split - start) / 1000,
+      (end - split) / 1000);
+
+  g_free (threads);
+  g_array_free (segments, TRUE);
+  g_mapped_file_unref (file);
+
+  return 0;
+}